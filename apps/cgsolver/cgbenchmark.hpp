@@ -0,0 +1,283 @@
+/* Copyright 2015 Stanford University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef cgbenchmark_hpp
+#define cgbenchmark_hpp
+
+#include <iostream>
+#include <cstdio>
+#include <cassert>
+#include <cstdlib>
+#include <vector>
+#include "legion.h"
+
+#include "params.hpp"
+#include "legionvector.hpp"
+#include "ell_sparsematrix.hpp"
+#include "cgoperators.hpp"
+
+using namespace LegionRuntime::HighLevel;
+
+// Benchmark mode for the CG operators.  A synthetic 3D Poisson matrix is
+// generated for each configuration and each operator is launched a fixed
+// number of times.  Results are printed one per line, prefixed with "BENCH",
+// so that they can be picked up by scripts:
+//
+//   BENCH <sweep> nx=.. rows=.. nnz=.. pieces=.. op=<name> time_us=.. gflops=.. gbps=..
+//
+// spmv is timed with both 64-bit (spmv_i64) and 32-bit (spmv_i32) column
+// indices, and "spmv+dot" (separate launches) is compared with the fused
+// "spmv_dot" task used by the solver.
+//
+// For the "launch" operator an empty index launch over the same pieces is
+// timed instead, and time_us is the runtime overhead per launch.
+
+enum BenchTaskIDs{
+	NOOP_TASK_ID = 15,
+};
+
+void noop_task(const Task *task,
+               const std::vector<PhysicalRegion> &regions,
+               Context ctx, HighLevelRuntime *runtime){
+
+	return;
+}
+
+void RegisterBenchmarkTasks(void){
+
+	HighLevelRuntime::register_legion_task<noop_task>(NOOP_TASK_ID,
+	Processor::LOC_PROC, true/*single*/, true/*index*/,
+	AUTO_GENERATE_ID, TaskConfigOptions(true/*leaf*/), "noop");
+
+	return;
+}
+
+template<typename T>
+class CGBenchmark{
+
+	private:
+	int nx;
+	int max_pieces;
+	int iters;
+
+	public:
+	CGBenchmark(int nx, int max_pieces, int iters);
+
+	// fixed problem size, increasing piece count
+	void StrongScaling(Context ctx, HighLevelRuntime *runtime);
+
+	// fixed rows per piece (the grid grows along z)
+	void WeakScaling(Context ctx, HighLevelRuntime *runtime);
+
+	private:
+	void RunConfig(const char *sweep, int nz, int nparts,
+		       Context ctx, HighLevelRuntime *runtime);
+
+	void Report(const char *sweep, const Params<T> &params, int nparts,
+		    const char *op, double elapsed, double flops, double bytes);
+
+	std::vector<int> PieceCounts(void);
+};
+
+template<typename T>
+CGBenchmark<T>::CGBenchmark(int nx, int max_pieces, int iters){
+
+	this-> nx = nx;
+	this-> max_pieces = max_pieces;
+	this-> iters = iters;
+}
+
+template<typename T>
+std::vector<int> CGBenchmark<T>::PieceCounts(void){
+
+	// powers of two, plus the maximum if it isn't one
+	std::vector<int> counts;
+	int p = 1;
+	for(; p < max_pieces; p *= 2)
+		counts.push_back(p);
+	counts.push_back(max_pieces);
+
+	return(counts);
+}
+
+template<typename T>
+void CGBenchmark<T>::StrongScaling(Context ctx, HighLevelRuntime *runtime){
+
+	std::vector<int> counts = PieceCounts();
+	for(unsigned i=0; i < counts.size(); i++)
+		RunConfig("strong", nx, counts[i], ctx, runtime);
+}
+
+template<typename T>
+void CGBenchmark<T>::WeakScaling(Context ctx, HighLevelRuntime *runtime){
+
+	std::vector<int> counts = PieceCounts();
+	for(unsigned i=0; i < counts.size(); i++)
+		RunConfig("weak", nx * counts[i], counts[i], ctx, runtime);
+}
+
+template<typename T>
+void CGBenchmark<T>::Report(const char *sweep, const Params<T> &params, int nparts,
+			    const char *op, double elapsed, double flops, double bytes){
+
+	double t = elapsed / iters;
+
+	printf("BENCH %s nx=%d rows=%d nnz=%d pieces=%d op=%s time_us=%.3f gflops=%.3f gbps=%.3f\n",
+	       sweep, params.nx, params.nrows, params.nonzeros, nparts, op,
+	       t * 1e6, flops / t * 1e-9, bytes / t * 1e-9);
+	fflush(stdout);
+}
+
+template<typename T>
+void CGBenchmark<T>::RunConfig(const char *sweep, int nz, int nparts,
+			       Context ctx, HighLevelRuntime *runtime){
+
+	Params<T> params;
+	params.InitPoisson3D(nx, nx, nz);
+
+	SpMatrix A(params.nrows, nparts, params.nonzeros, params.max_nzeros, ctx, runtime);
+	A.BuildMatrix(params.vals, params.col_ind, params.nzeros_per_row, ctx, runtime);
+
+	Array<T> x(params.nrows, nparts, ctx, runtime);
+	x.Initialize(params.rhs, ctx, runtime);
+
+	Array<T> y(params.nrows, nparts, ctx, runtime);
+	y.Initialize(params.rhs, ctx, runtime);
+
+	Predicate pred = Predicate::TRUE_PRED;
+	Future beta = Future::from_value<T>(runtime, T(0.5));
+
+	const double n = params.nrows;
+	const double nnz = params.nonzeros;
+
+	// warm up once so instance creation and mapping are not timed
+	spmv(A, x, y, pred, ctx, runtime).wait_all_results();
+	dot(x, y, pred, Future(), ctx, runtime).get_void_result();
+	axpy_inplace(x, y, beta, pred, ctx, runtime).wait_all_results();
+
+	// y = A * x: each nonzero reads a value and a column index, each row
+	//  reads its length and writes one result (x is assumed to hit in cache)
+	//  - run with both 64-bit and (if available) 32-bit column indices
+	const double row_bytes = n * (sizeof(int64_t) + 2 * sizeof(T));
+	const bool has_col32 = A.has_col32;
+	for(int pass = 0; pass < (has_col32 ? 2 : 1); pass++) {
+		A.use_col32 = (pass == 1);
+		spmv(A, x, y, pred, ctx, runtime).wait_all_results();
+
+		double t_start = Realm::Clock::current_time();
+		FutureMap fm;
+		for(int i=0; i < iters; i++)
+			fm = spmv(A, x, y, pred, ctx, runtime);
+		fm.wait_all_results();
+		double t_end = Realm::Clock::current_time();
+
+		Report(sweep, params, nparts, (A.use_col32 ? "spmv_i32" : "spmv_i64"),
+		       t_end - t_start, 2.0 * nnz,
+		       nnz * (sizeof(T) + (A.use_col32 ? sizeof(int32_t) : sizeof(int64_t))) +
+		       row_bytes);
+	}
+	A.use_col32 = has_col32;
+
+	const double spmv_bytes = nnz * (sizeof(T) + (has_col32 ? sizeof(int32_t) : sizeof(int64_t))) +
+		row_bytes;
+
+	// y = A * x followed by x' * y, as separate launches
+	{
+		double t_start = Realm::Clock::current_time();
+		std::vector<Future> results;
+		for(int i=0; i < iters; i++) {
+			spmv(A, x, y, pred, ctx, runtime);
+			results.push_back(dot(x, y, pred, Future(), ctx, runtime));
+		}
+		for(unsigned i=0; i < results.size(); i++)
+			results[i].get_void_result();
+		double t_end = Realm::Clock::current_time();
+
+		Report(sweep, params, nparts, "spmv+dot", t_end - t_start, 2.0 * nnz + 2.0 * n,
+		       spmv_bytes + 2.0 * n * sizeof(T));
+	}
+
+	// the same with the fused task, which doesn't read y back
+	{
+		// check it against the separate launches while warming up
+		spmv(A, x, y, pred, ctx, runtime);
+		T separate = dot(x, y, pred, Future(), ctx, runtime).template get_result<T>();
+		T fused = spmv_dot(A, x, y, pred, Future(), ctx, runtime).template get_result<T>();
+		if(fabs(fused - separate) > (1e-10 * fabs(separate)))
+			printf("WARNING: fused spmv_dot result %g does not match spmv+dot result %g\n",
+			       (double)fused, (double)separate);
+
+		double t_start = Realm::Clock::current_time();
+		std::vector<Future> results;
+		for(int i=0; i < iters; i++)
+			results.push_back(spmv_dot(A, x, y, pred, Future(), ctx, runtime));
+		for(unsigned i=0; i < results.size(); i++)
+			results[i].get_void_result();
+		double t_end = Realm::Clock::current_time();
+
+		Report(sweep, params, nparts, "spmv_dot", t_end - t_start, 2.0 * nnz + 2.0 * n,
+		       spmv_bytes);
+	}
+
+	// x' * y
+	{
+		double t_start = Realm::Clock::current_time();
+		std::vector<Future> results;
+		for(int i=0; i < iters; i++)
+			results.push_back(dot(x, y, pred, Future(), ctx, runtime));
+		for(unsigned i=0; i < results.size(); i++)
+			results[i].get_void_result();
+		double t_end = Realm::Clock::current_time();
+
+		Report(sweep, params, nparts, "dot", t_end - t_start, 2.0 * n,
+		       2.0 * n * sizeof(T));
+	}
+
+	// y = x + beta * y
+	{
+		double t_start = Realm::Clock::current_time();
+		FutureMap fm;
+		for(int i=0; i < iters; i++)
+			fm = axpy_inplace(x, y, beta, pred, ctx, runtime);
+		fm.wait_all_results();
+		double t_end = Realm::Clock::current_time();
+
+		Report(sweep, params, nparts, "axpy", t_end - t_start, 2.0 * n,
+		       3.0 * n * sizeof(T));
+	}
+
+	// empty index launches over the same pieces measure runtime overhead
+	{
+		ArgumentMap arg_map;
+		IndexLauncher noop_launcher(NOOP_TASK_ID, x.color_domain,
+					    TaskArgument(NULL, 0), arg_map);
+
+		double t_start = Realm::Clock::current_time();
+		std::vector<FutureMap> results;
+		for(int i=0; i < iters; i++)
+			results.push_back(runtime->execute_index_space(ctx, noop_launcher));
+		for(unsigned i=0; i < results.size(); i++)
+			results[i].wait_all_results();
+		double t_end = Realm::Clock::current_time();
+
+		Report(sweep, params, nparts, "launch", t_end - t_start, 0.0, 0.0);
+	}
+
+	x.DestroyArray(ctx, runtime);
+	y.DestroyArray(ctx, runtime);
+	A.DestroySpMatrix(ctx, runtime);
+}
+
+#endif /*cgbenchmark_hpp*/
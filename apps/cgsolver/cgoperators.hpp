@@ -88,6 +88,7 @@ enum TaksIDs{
 	L2NORM_TASK_ID = 11,
 	DIVIDE_TASK_ID = 12,
         CONVERGENCE_TASK_ID = 13,
+        SPMV_DOT_TASK_ID = 14,
 };
 
 enum OpIDs{
@@ -104,13 +105,15 @@ class TaskArgs1{
 	FieldID A_val_fid;
 	FieldID x_fid;
 	FieldID Ax_fid;
+	bool col32;
 
 	TaskArgs1(void){};
 	TaskArgs1(const SpMatrix &A, const Array<T> &x, Array<T> &Ax, int64_t scalar){
 		
 		this-> scalar = scalar;
 		this-> A_row_fid = A.row_fid;
-		this-> A_col_fid = A.col_fid;
+		this-> col32 = (A.has_col32 && A.use_col32);
+		this-> A_col_fid = (col32 ? A.col32_fid : A.col_fid);
 		this-> A_val_fid = A.val_fid;
 		this-> x_fid = x.fid;
 		this-> Ax_fid = Ax.fid;
@@ -199,208 +202,197 @@ void FutureSum::fold<false>(RHS &rhs1, RHS rhs2)
   } while (!__sync_bool_compare_and_swap(target, oldval.as_int, newval.as_int));
 }
 
-// A_x = A * x
+// region requirements shared by spmv and spmv_dot
 template<typename T>
-void spmv(const SpMatrix &A, const Array<T> &x, Array<T> &A_x, 
-          const Predicate &pred, Context ctx,  HighLevelRuntime *runtime){
-	
-	
-	ArgumentMap arg_map;
-
-	TaskArgs1<T> spmv_args(A, x, A_x, A.max_nzeros);
-
-	IndexLauncher spmv_launcher(SPMV_TASK_ID, x.color_domain,
-				    TaskArgument(&spmv_args, sizeof(spmv_args)), 
-                                    arg_map, pred);
+static void add_spmv_requirements(IndexLauncher &launcher, const SpMatrix &A,
+                                  const Array<T> &x, Array<T> &A_x){
 
-	spmv_launcher.add_region_requirement(
+	launcher.add_region_requirement(
 			RegionRequirement(A.row_lp, 0, READ_ONLY, EXCLUSIVE, A.row_lr));
-	spmv_launcher.region_requirements[0].add_field(A.row_fid);
+	launcher.region_requirements[0].add_field(A.row_fid);
 
-	spmv_launcher.add_region_requirement(
+	launcher.add_region_requirement(
                         RegionRequirement(A.elem_lp, 0, READ_ONLY, EXCLUSIVE, A.elem_lr));
-	spmv_launcher.region_requirements[1].add_field(A.val_fid);
-	spmv_launcher.region_requirements[1].add_field(A.col_fid); 
+	launcher.region_requirements[1].add_field(A.val_fid);
+	launcher.region_requirements[1].add_field((A.has_col32 && A.use_col32) ? 
+						  A.col32_fid : A.col_fid); 
 
 	// Note: all elements of vector x is given to each process
-	spmv_launcher.add_region_requirement(
+	launcher.add_region_requirement(
                         RegionRequirement(x.lr, 0, READ_ONLY, EXCLUSIVE, x.lr));
-        spmv_launcher.region_requirements[2].add_field(x.fid);
+        launcher.region_requirements[2].add_field(x.fid);
 
-	spmv_launcher.add_region_requirement(
+	launcher.add_region_requirement(
                         RegionRequirement(A_x.lp, 0, WRITE_DISCARD, EXCLUSIVE, A_x.lr));
-        spmv_launcher.region_requirements[3].add_field(A_x.fid);
-
-	runtime->execute_index_space(ctx, spmv_launcher);
-	
-	return;
+        launcher.region_requirements[3].add_field(A_x.fid);
 }
 
+// A_x = A * x
 template<typename T>
-void spmv_task(const Task *task,
-	       const std::vector<PhysicalRegion> &regions,
-	       Context ctx, HighLevelRuntime *runtime){
-
-	assert(regions.size() == 4);
-        assert(task->regions.size() == 4);
-
-        const  TaskArgs1<T> task_args = *((const TaskArgs1<T>*)task->args);
-
-	int max_nzeros = task_args.scalar;
-
-        RegionAccessor<AccessorType::Generic, int64_t> acc_num_nzeros =
-        regions[0].get_field_accessor(task_args.A_row_fid).template typeify<int64_t>();
+FutureMap spmv(const SpMatrix &A, const Array<T> &x, Array<T> &A_x, 
+               const Predicate &pred, Context ctx,  HighLevelRuntime *runtime){
+	
+	
+	ArgumentMap arg_map;
 
-        RegionAccessor<AccessorType::Generic, int64_t> acc_col =
-        regions[1].get_field_accessor(task_args.A_col_fid).template typeify<int64_t>();
+	TaskArgs1<T> spmv_args(A, x, A_x, A.max_nzeros);
 
-        RegionAccessor<AccessorType::Generic, T> acc_vals =
-        regions[1].get_field_accessor(task_args.A_val_fid).template typeify<T>();
+	IndexLauncher spmv_launcher(SPMV_TASK_ID, x.color_domain,
+				    TaskArgument(&spmv_args, sizeof(spmv_args)), 
+                                    arg_map, pred);
 
-	RegionAccessor<AccessorType::Generic, T> acc_x =
-        regions[2].get_field_accessor(task_args.x_fid).template typeify<T>();
+	add_spmv_requirements(spmv_launcher, A, x, A_x);
 
-	RegionAccessor<AccessorType::Generic, T> acc_Ax =
-        regions[3].get_field_accessor(task_args.Ax_fid).template typeify<T>();
+	FutureMap result = runtime->execute_index_space(ctx, spmv_launcher);
+	
+	return(result);
+}
 
-        Domain row_dom = runtime->get_index_space_domain(ctx,
-                         task->regions[0].region.get_index_space());
-        Rect<1> row_rect = row_dom.get_rect<1>();
+// A_x = A * x, returning x' * A_x
+template<typename T>
+Future spmv_dot(const SpMatrix &A, const Array<T> &x, Array<T> &A_x, 
+                const Predicate &pred, const Future &false_result,
+                Context ctx,  HighLevelRuntime *runtime){
+	
+	ArgumentMap arg_map;
 
-        Domain elem_dom = runtime->get_index_space_domain(ctx,
-                          task->regions[1].region.get_index_space());
-        Rect<1> elem_rect = elem_dom.get_rect<1>();
+	TaskArgs1<T> spmv_args(A, x, A_x, A.max_nzeros);
 
-	// apply matrix vector multiplication
-	{
-		T sum;	
-		DomainPoint pir;
-		pir.dim = 1;
+	IndexLauncher spmv_launcher(SPMV_DOT_TASK_ID, x.color_domain,
+				    TaskArgument(&spmv_args, sizeof(spmv_args)), 
+                                    arg_map, pred);
 
-		GenericPointInRectIterator<1> itr1(row_rect);
-		GenericPointInRectIterator<1> itr2(elem_rect);
+	add_spmv_requirements(spmv_launcher, A, x, A_x);
 
-		for(int i=0; i < row_rect.volume(); i++){
+        spmv_launcher.set_predicate_false_future(false_result);
 
-			sum = 0.0;
-			int limit = acc_num_nzeros.read(DomainPoint::from_point<1>(itr1.p));
+	Future result = runtime->execute_index_space(ctx, spmv_launcher, REDUCE_ID);
+	
+	return(result);
+}
 
-			for(int counter=0; counter < limit; counter++){
+// one row of an ELL matrix times x
+template<typename T, typename IT>
+static inline T spmv_row(const T *vals, const IT *cols, int limit, const T *x)
+{
+  T sum = 0.0;
+  for (int j = 0; j < limit; j++)
+    sum += vals[j] * x[cols[j]];
+  return sum;
+}
 
-				int ind = acc_col.read(DomainPoint::from_point<1>(itr2.p));
-				pir.point_data[0] = ind;
-			
-				sum += acc_vals.read(DomainPoint::from_point<1>(itr2.p)) * acc_x.read(pir);
-				itr2++;
-			}
-			
-			acc_Ax.write(DomainPoint::from_point<1>(itr1.p), sum);
-			itr1++;
-			itr2.p.x[0] = itr2.p.x[0] + (max_nzeros - limit);
-		}
-	}
-	
-	return;
+#if defined(__AVX2__)
+// 32-bit indices let us gather four x values at a time - the tail of the
+//  row is done with masked loads so we never read past the end of the row
+static inline double spmv_row(const double *vals, const int32_t *cols, int limit, const double *x)
+{
+  __m256d temp = _mm256_setzero_pd();
+  int j = 0;
+  for (; (j + 4) <= limit; j += 4) {
+    __m128i idx = _mm_loadu_si128((const __m128i *)(cols + j));
+    __m256d v = _mm256_loadu_pd(vals + j);
+    __m256d xv = _mm256_i32gather_pd(x, idx, 8);
+    temp = _mm256_add_pd(temp, _mm256_mul_pd(v, xv));
+  }
+  if (j < limit) {
+    __m128i mask32 = _mm_cmpgt_epi32(_mm_set1_epi32(limit - j),
+                                     _mm_setr_epi32(0, 1, 2, 3));
+    __m256i mask64 = _mm256_cvtepi32_epi64(mask32);
+    __m128i idx = _mm_maskload_epi32((const int *)(cols + j), mask32);
+    __m256d v = _mm256_maskload_pd(vals + j, mask64);
+    __m256d xv = _mm256_mask_i32gather_pd(_mm256_setzero_pd(), x, idx,
+                                          _mm256_castsi256_pd(mask64), 8);
+    temp = _mm256_add_pd(temp, _mm256_mul_pd(v, xv));
+  }
+  __m128d lower = _mm256_castpd256_pd128(temp);
+  __m128d upper = _mm256_extractf128_pd(temp, 1);
+  __m128d pair = _mm_add_pd(lower, upper);
+  return _mm_cvtsd_f64(_mm_add_sd(pair, _mm_unpackhi_pd(pair, pair)));
 }
+#endif
 
+// raw pointer version of spmv - returns false if the layout isn't dense, and
+//  accumulates x' * A_x into dot_result if it is non-null
+template<typename T, typename IT>
 static bool dense_spmv(int max_nzeros, const Rect<1> &subgrid_bounds, 
-		       		   const Rect<1> &elem_bounds,
-		               const Rect<1> &vec_bounds,
+		       const Rect<1> &elem_bounds,
+		       const Rect<1> &vec_bounds,
 		       RegionAccessor<AccessorType::Generic,int64_t> &fa_nzero,
-                       RegionAccessor<AccessorType::Generic,int64_t> &fa_col,
-                       RegionAccessor<AccessorType::Generic,double> &fa_val,
-                       RegionAccessor<AccessorType::Generic,double> &fa_x,
-                       RegionAccessor<AccessorType::Generic,double> &fa_ax)
+                       RegionAccessor<AccessorType::Generic,IT> &fa_col,
+                       RegionAccessor<AccessorType::Generic,T> &fa_val,
+                       RegionAccessor<AccessorType::Generic,T> &fa_x,
+                       RegionAccessor<AccessorType::Generic,T> &fa_ax,
+                       T *dot_result)
 {
   Rect<1> subrect;
   ByteOffset in_offsets[1], offsets[1];
 
-  const int64_t *in_nzero_ptr = fa_nzero.raw_rect_ptr<1>(subgrid_bounds, subrect, in_offsets);
+  const int64_t *in_nzero_ptr = fa_nzero.template raw_rect_ptr<1>(subgrid_bounds, subrect, in_offsets);
   if (!in_nzero_ptr || (subrect != subgrid_bounds) ||
       !offsets_are_dense<1,int64_t>(subgrid_bounds, in_offsets)) return false;
 
-  const int64_t *in_col_ptr = fa_col.raw_rect_ptr<1>(elem_bounds, subrect, in_offsets);
+  const IT *in_col_ptr = fa_col.template raw_rect_ptr<1>(elem_bounds, subrect, in_offsets);
   if (!in_col_ptr || (subrect != elem_bounds) ||
-      !offsets_are_dense<1,int64_t>(elem_bounds, in_offsets)) return false;
+      !offsets_are_dense<1,IT>(elem_bounds, in_offsets)) return false;
 
-  const double *in_val_ptr = fa_val.raw_rect_ptr<1>(elem_bounds, subrect, offsets);
+  const T *in_val_ptr = fa_val.template raw_rect_ptr<1>(elem_bounds, subrect, offsets);
   if (!in_val_ptr || (subrect != elem_bounds) || 
-      offset_mismatch(1, in_offsets, offsets)) return false;
+      !offsets_are_dense<1,T>(elem_bounds, offsets)) return false;
 
-  const double *in_x_ptr = fa_x.raw_rect_ptr<1>(vec_bounds, subrect, offsets);
+  const T *in_x_ptr = fa_x.template raw_rect_ptr<1>(vec_bounds, subrect, offsets);
   if (!in_x_ptr || (subrect != vec_bounds) ||
-      !offsets_are_dense<1,double>(vec_bounds, offsets)) return false;
+      !offsets_are_dense<1,T>(vec_bounds, offsets)) return false;
 
   // No offset check here
-  double *out_ax_ptr = fa_ax.raw_rect_ptr<1>(subgrid_bounds, subrect, offsets);
+  T *out_ax_ptr = fa_ax.template raw_rect_ptr<1>(subgrid_bounds, subrect, offsets);
   if (!out_ax_ptr || (subrect != subgrid_bounds) ||
-      !offsets_are_dense<1,double>(subgrid_bounds, offsets)) return false;
-
-  int n_rows = subgrid_bounds.volume();
-#define STRIP_SIZE 256
-  while (n_rows > 0) {
-    if (n_rows>= STRIP_SIZE) {
-      for (int i = 0; i < STRIP_SIZE; i++) {
-        double sum = 0.0;
-        int limit = in_nzero_ptr[i];
-        for (int j = 0; j < limit; j++) {
-          int index = in_col_ptr[i*max_nzeros+j];
-          double val = in_val_ptr[i*max_nzeros+j];
-          double xval = in_x_ptr[index];
-          sum += (val * xval);
-        }
-        out_ax_ptr[i] = sum;
-      }
-      n_rows -= STRIP_SIZE;
-      in_nzero_ptr += STRIP_SIZE;
-      in_col_ptr += (max_nzeros*STRIP_SIZE);
-      in_val_ptr += (max_nzeros*STRIP_SIZE);
-      out_ax_ptr += STRIP_SIZE;
-    } else {
-      for (int i = 0; i < n_rows; i++) {
-        double sum = 0.0;
-	int limit = in_nzero_ptr[i];
-        for (int j = 0; j < limit; j++) {
-          int index = in_col_ptr[i*max_nzeros+j]; 
-          double val = in_val_ptr[i*max_nzeros+j];
-          double xval = in_x_ptr[index];
-          sum += (val * xval);         
-        }
-        out_ax_ptr[i] = sum;
-      }
-      n_rows = 0;
-    }
+      !offsets_are_dense<1,T>(subgrid_bounds, offsets)) return false;
+
+  // x covers the whole vector, so our rows start partway through it
+  const T *in_xrow_ptr = in_x_ptr + (subgrid_bounds.lo.x[0] - vec_bounds.lo.x[0]);
+
+  const int n_rows = subgrid_bounds.volume();
+  T dot = 0.0;
+  for (int i = 0; i < n_rows; i++) {
+    T sum = spmv_row(in_val_ptr + i*max_nzeros, in_col_ptr + i*max_nzeros,
+                     (int)in_nzero_ptr[i], in_x_ptr);
+    out_ax_ptr[i] = sum;
+    if (dot_result)
+      dot += in_xrow_ptr[i] * sum;
   }
-#undef STRIP_SIZE
+#if defined(__AVX2__)
+  _mm256_zeroupper();
+#endif
+  if (dot_result)
+    *dot_result = dot;
   return true;
 }
 
-template<>
-void spmv_task<double>(const Task *task,
-                       const std::vector<PhysicalRegion> &regions,
-                       Context ctx, HighLevelRuntime *runtime) 
+// does the spmv for one piece, using either 32-bit or 64-bit column indices,
+//  and returns x' * A_x for the piece if fused_dot is set
+template<typename T, typename IT>
+static T spmv_piece(const Task *task,
+                    const std::vector<PhysicalRegion> &regions,
+                    Context ctx, HighLevelRuntime *runtime, bool fused_dot)
 {
-  assert(regions.size() == 4);
-  assert(task->regions.size() == 4);
-
-  const  TaskArgs1<double> task_args = *((const TaskArgs1<double>*)task->args);
+  const TaskArgs1<T> task_args = *((const TaskArgs1<T>*)task->args);
 
   const int max_nzeros = task_args.scalar;
 
   RegionAccessor<AccessorType::Generic, int64_t> acc_num_nzeros =
-  regions[0].get_field_accessor(task_args.A_row_fid).typeify<int64_t>();
+  regions[0].get_field_accessor(task_args.A_row_fid).template typeify<int64_t>();
 
-  RegionAccessor<AccessorType::Generic, int64_t> acc_col =
-  regions[1].get_field_accessor(task_args.A_col_fid).typeify<int64_t>();
+  RegionAccessor<AccessorType::Generic, IT> acc_col =
+  regions[1].get_field_accessor(task_args.A_col_fid).template typeify<IT>();
 
-  RegionAccessor<AccessorType::Generic, double> acc_vals =
-  regions[1].get_field_accessor(task_args.A_val_fid).typeify<double>();
+  RegionAccessor<AccessorType::Generic, T> acc_vals =
+  regions[1].get_field_accessor(task_args.A_val_fid).template typeify<T>();
 
-  RegionAccessor<AccessorType::Generic, double> acc_x =
-  regions[2].get_field_accessor(task_args.x_fid).typeify<double>();
+  RegionAccessor<AccessorType::Generic, T> acc_x =
+  regions[2].get_field_accessor(task_args.x_fid).template typeify<T>();
 
-  RegionAccessor<AccessorType::Generic, double> acc_Ax =
-  regions[3].get_field_accessor(task_args.Ax_fid).typeify<double>();
+  RegionAccessor<AccessorType::Generic, T> acc_Ax =
+  regions[3].get_field_accessor(task_args.Ax_fid).template typeify<T>();
 
   Domain elem_dom = runtime->get_index_space_domain(ctx,
                     task->regions[1].region.get_index_space());
@@ -414,38 +406,68 @@ void spmv_task<double>(const Task *task,
                    task->regions[3].region.get_index_space());
   Rect<1> row_rect = row_dom.get_rect<1>();
 
-  
-  if(dense_spmv(max_nzeros, row_rect, elem_rect, vec_rect, acc_num_nzeros, acc_col, acc_vals, acc_x, acc_Ax)){
-    return;
-  }  
-  else{
-
-  	// Otherwise we fall back
-  	GenericPointInRectIterator<1> itr1(row_rect);
-  	GenericPointInRectIterator<1> itr2(elem_rect);
-  	const int volume = row_rect.volume();
-  	DomainPoint pir;
-  	pir.dim = 1;
-  	for (int i = 0; i < volume; i++) {
-    		double sum = 0.0;
-		int limit = acc_num_nzeros.read(DomainPoint::from_point<1>(itr1.p));
-
-    		for (int j = 0; j < limit; j++) {
-
-			int ind = acc_col.read(DomainPoint::from_point<1>(itr2.p));
-                                pir.point_data[0] = ind;
-
-                                sum += acc_vals.read(DomainPoint::from_point<1>(itr2.p)) * acc_x.read(pir);
-                                itr2++;
-                        }
-
-                        acc_Ax.write(DomainPoint::from_point<1>(itr1.p), sum);
-                        itr1++;
-                        itr2.p.x[0] = itr2.p.x[0] + (max_nzeros - limit);
-  	}
+  T dot = 0.0;
+  if (dense_spmv<T,IT>(max_nzeros, row_rect, elem_rect, vec_rect, acc_num_nzeros, 
+                       acc_col, acc_vals, acc_x, acc_Ax, (fused_dot ? &dot : 0)))
+    return dot;
+
+  // Otherwise we fall back
+  GenericPointInRectIterator<1> itr1(row_rect);
+  GenericPointInRectIterator<1> itr2(elem_rect);
+  const int volume = row_rect.volume();
+  DomainPoint pir;
+  pir.dim = 1;
+  for (int i = 0; i < volume; i++) {
+    T sum = 0.0;
+    int limit = acc_num_nzeros.read(DomainPoint::from_point<1>(itr1.p));
+
+    for (int j = 0; j < limit; j++) {
+      pir.point_data[0] = acc_col.read(DomainPoint::from_point<1>(itr2.p));
+      sum += acc_vals.read(DomainPoint::from_point<1>(itr2.p)) * acc_x.read(pir);
+      itr2++;
+    }
+
+    acc_Ax.write(DomainPoint::from_point<1>(itr1.p), sum);
+    if (fused_dot)
+      dot += acc_x.read(DomainPoint::from_point<1>(itr1.p)) * sum;
+    itr1++;
+    itr2.p.x[0] = itr2.p.x[0] + (max_nzeros - limit);
   }
- 
- return;
+  return dot;
+}
+
+template<typename T>
+void spmv_task(const Task *task,
+	       const std::vector<PhysicalRegion> &regions,
+	       Context ctx, HighLevelRuntime *runtime){
+
+	assert(regions.size() == 4);
+        assert(task->regions.size() == 4);
+
+        const  TaskArgs1<T> task_args = *((const TaskArgs1<T>*)task->args);
+
+	if(task_args.col32)
+		spmv_piece<T,int32_t>(task, regions, ctx, runtime, false);
+	else
+		spmv_piece<T,int64_t>(task, regions, ctx, runtime, false);
+	
+	return;
+}
+
+template<typename T>
+T spmv_dot_task(const Task *task,
+	        const std::vector<PhysicalRegion> &regions,
+	        Context ctx, HighLevelRuntime *runtime){
+
+	assert(regions.size() == 4);
+        assert(task->regions.size() == 4);
+
+        const  TaskArgs1<T> task_args = *((const TaskArgs1<T>*)task->args);
+
+	if(task_args.col32)
+		return spmv_piece<T,int32_t>(task, regions, ctx, runtime, true);
+	else
+		return spmv_piece<T,int64_t>(task, regions, ctx, runtime, true);
 }
 
 // b -= Ax
@@ -1355,8 +1377,8 @@ void add_inplace_task<double>(const Task *task,
 }
 
 template<typename T>
-void axpy_inplace(const Array<T> &x, Array<T> &y, Future coef, 
-                  const Predicate &pred, Context ctx, HighLevelRuntime *runtime){
+FutureMap axpy_inplace(const Array<T> &x, Array<T> &y, Future coef, 
+                       const Predicate &pred, Context ctx, HighLevelRuntime *runtime){
         ArgumentMap arg_map;
 
 	TaskArgs2<T> add_args(x, y);
@@ -1375,9 +1397,9 @@ void axpy_inplace(const Array<T> &x, Array<T> &y, Future coef,
                         RegionRequirement(y.lp, 0, READ_WRITE, EXCLUSIVE, y.lr));
         add_launcher.region_requirements[1].add_field(y.fid);
 
-        runtime->execute_index_space(ctx, add_launcher);
+        FutureMap result = runtime->execute_index_space(ctx, add_launcher);
 
-	return;
+	return(result);
 
 }
 
@@ -1606,6 +1628,10 @@ static void RegisterOperatorTasks(void) {
 	Processor::LOC_PROC, true/*single*/, true/*index*/,
 	AUTO_GENERATE_ID, TaskConfigOptions(true/*leaf*/), "spmv");
 
+	HighLevelRuntime::register_legion_task<T, spmv_dot_task<T> >(SPMV_DOT_TASK_ID, 
+	Processor::LOC_PROC, true/*single*/, true/*index*/,
+	AUTO_GENERATE_ID, TaskConfigOptions(true/*leaf*/), "spmv_dot");
+
 	HighLevelRuntime::register_legion_task<subtract_task<T> >(SUBTRACT_TASK_ID,
         Processor::LOC_PROC, true/*single*/, true/*index*/,
         AUTO_GENERATE_ID, TaskConfigOptions(true/*leaf*/), "subtract");
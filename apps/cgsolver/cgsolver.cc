@@ -27,6 +27,7 @@
 #include "cgoperators.hpp"
 #include "cgsolver.hpp"
 #include "cgmapper.hpp"
+#include "cgbenchmark.hpp"
 
 using namespace LegionRuntime::HighLevel;
 
@@ -45,6 +46,10 @@ void top_level_task(const Task *task,
     std::string rhs_file;
     bool inputmat = false;
     bool inputrhs = false;
+    int bench_nx = 0;
+    int bench_iters = 20;
+    std::string bench_sweep = "both";
+    int64_t max_pieces = 0;
     const InputArgs &command_args = HighLevelRuntime::get_input_args();
     
         // Parse command line arguments
@@ -74,10 +79,51 @@ void top_level_task(const Task *task,
             assert(iter_max >= 0);
             continue;
           }
+          if (!strcmp(command_args.argv[i], "-bench"))
+          {
+            bench_nx = atoi(command_args.argv[++i]);
+            assert(bench_nx > 0);
+            continue;
+          }
+          if (!strcmp(command_args.argv[i], "-bench_iters"))
+          {
+            bench_iters = atoi(command_args.argv[++i]);
+            assert(bench_iters > 0);
+            continue;
+          }
+          if (!strcmp(command_args.argv[i], "-sweep"))
+          {
+            bench_sweep = command_args.argv[++i];
+            assert((bench_sweep == "strong") || (bench_sweep == "weak") ||
+                   (bench_sweep == "both"));
+            continue;
+          }
+          if (!strcmp(command_args.argv[i], "-pieces"))
+          {
+            max_pieces = atoi(command_args.argv[++i]);
+            assert(max_pieces > 0);
+            continue;
+          }
         }
    	
-	// get naprts from the custom mapper
-	nparts = runtime->get_tunable_value(ctx, SUBREGION_TUNABLE, 0);
+	// get naprts from the custom mapper, unless given on the command line
+	if(max_pieces > 0)
+		nparts = max_pieces;
+	else
+		nparts = runtime->get_tunable_value(ctx, SUBREGION_TUNABLE, 0);
+
+	// benchmark mode replaces the solve entirely
+	if(bench_nx > 0) {
+		std::cout<<"Benchmarking CG operators on a "<<bench_nx<<"^3 Poisson problem, "
+		         <<"up to "<<nparts<<" pieces, "<<bench_iters<<" launches per operator"<<std::endl;
+
+		CGBenchmark<double> bench(bench_nx, nparts, bench_iters);
+		if((bench_sweep == "strong") || (bench_sweep == "both"))
+			bench.StrongScaling(ctx, runtime);
+		if((bench_sweep == "weak") || (bench_sweep == "both"))
+			bench.WeakScaling(ctx, runtime);
+		return;
+	}
 	
 	Params<double> params;
 	if(!inputmat && !inputrhs) {
@@ -189,6 +235,8 @@ int main(int argc, char **argv){
 	RegisterVectorTask<double>();
 
 	RegisterOperatorTasks<double>();	
+
+	RegisterBenchmarkTasks();
  
   return HighLevelRuntime::start(argc, argv);
 }
@@ -101,15 +101,12 @@ bool CGSolver<T>::Solve(const SpMatrix &A,
 		std::cout<<niter<<"            "<<L2normr<<std::endl;
 		niter++;
 
-		// Ap = A * p
-		spmv(A, p, A_p, loop_pred, ctx, runtime);
+		// Ap = A * p, pAp = p' * A * p
+		pAp = spmv_dot(A, p, A_p, loop_pred, pAp, ctx, runtime);
 
 		// r2 = r' * r
 		r2_old = dot(r_old, r_old, loop_pred, r2_old, ctx, runtime);
 
-		// pAp = p' * A * p
-		pAp = dot(p, A_p, loop_pred, pAp, ctx, runtime);	
-
 		// alpha = r2 / pAp
 		alpha = compute_scalar<T>(r2_old, pAp, loop_pred, alpha, ctx, runtime);	
 	
@@ -20,6 +20,8 @@
 #include <cstdio>
 #include <cassert>
 #include <cstdlib>
+#include <climits>
+#include <stdint.h>
 #include "legion.h"
 
 using namespace LegionRuntime::HighLevel;
@@ -55,6 +57,7 @@ enum SPFieldIDs{
 	FID_Vals = 0,
 	FID_Col_Ind = 1,
 	FID_NZEROS_PER_ROW = 2,
+	FID_Col_Ind32 = 3,
 };
 
 void BuildMatrix_Task(const Task *task,
@@ -126,6 +129,11 @@ class SpMatrix{
 	FieldID row_fid;
 	FieldID val_fid;
 	FieldID col_fid;
+	FieldID col32_fid;
+	// 32-bit copy of the column indices, allocated if they all fit
+	bool has_col32;
+	// whether the spmv kernels should use it (the benchmark turns it off)
+	bool use_col32;
 	Domain color_domain;
 	Rect<1> row_rect;
 	Rect<1> elem_rect;
@@ -152,6 +160,9 @@ SpMatrix::SpMatrix(int64_t n, int64_t nparts, int64_t nonzeros, int64_t max_nzer
 	this-> row_fid = FID_NZEROS_PER_ROW;	
 	this-> val_fid = FID_Vals;
 	this-> col_fid = FID_Col_Ind;
+	this-> col32_fid = FID_Col_Ind32;
+	this-> has_col32 = ((n - 1) <= INT_MAX);
+	this-> use_col32 = has_col32;
 	this-> nrows = n;
 	this-> ncols = n;
 	this-> nonzeros = nonzeros;
@@ -178,6 +189,8 @@ SpMatrix::SpMatrix(int64_t n, int64_t nparts, int64_t nonzeros, int64_t max_nzer
 		FieldAllocator allocator = runtime->create_field_allocator(ctx, elem_fs);
 		allocator.allocate_field(sizeof(double), FID_Vals);
 		allocator.allocate_field(sizeof(int64_t), FID_Col_Ind);
+		if(has_col32)
+			allocator.allocate_field(sizeof(int32_t), FID_Col_Ind32);
 	}
 	elem_lr = runtime->create_logical_region(ctx, elem_is, elem_fs);
 
@@ -238,6 +251,8 @@ void SpMatrix::BuildMatrix(double *vals, int *col_ind, int *nzeros_per_row,
         RegionRequirement req2(elem_lr, WRITE_DISCARD, EXCLUSIVE, elem_lr);
         req2.add_field(FID_Col_Ind);
         req2.add_field(FID_Vals);
+        if(has_col32)
+          req2.add_field(FID_Col_Ind32);
 
 
 	InlineLauncher init_launcher1(req1);
@@ -307,6 +322,29 @@ void SpMatrix::BuildMatrix(double *vals, int *col_ind, int *nzeros_per_row,
           }
         }
 
+        // 32-bit column indices
+        if(has_col32) {
+          RegionAccessor<AccessorType::Generic, int32_t> acc_col32 =
+          init_region2.get_field_accessor(FID_Col_Ind32).typeify<int32_t>();
+
+          int32_t *col32_ptr = acc_col32.raw_rect_ptr<1>(elem_rect, subrect, offsets);
+          if (!col32_ptr || (subrect != elem_rect) ||
+              !offsets_are_dense<1,int32_t>(elem_rect, offsets))
+          {
+                  GenericPointInRectIterator<1> itr(elem_rect);
+
+                  for(int i=0; i<nrows * max_nzeros; i++){
+                          acc_col32.write(DomainPoint::from_point<1>(itr.p), col_ind[i]);
+                          itr++;
+                  }
+          }
+          else
+          {
+            for (int i = 0; i < (nrows * max_nzeros); i++)
+              col32_ptr[i] = col_ind[i];
+          }
+        }
+
 	runtime->unmap_region(ctx, init_region1);
 	runtime->unmap_region(ctx, init_region2);
 
@@ -43,6 +43,7 @@ class Params{
 	
 	Params(void){};
 	void Init(int nx);
+	void InitPoisson3D(int nx, int ny, int nz);
 	void InitMat(std::string matrix_file);
 	void InitRhs(std::string rhs_file);
 	~Params(void);
@@ -64,6 +65,82 @@ void Params<T>::Init(int nx) {
 		exact = new T[nrows];
 }
 
+// 7-point finite difference Laplacian on an nx*ny*nz grid with homogeneous
+// Dirichlet boundaries, scaled so the matrix is SPD with unit off-diagonals.
+// Used by the benchmark mode, so the right hand side is simply all ones.
+template<typename T>
+void Params<T>::InitPoisson3D(int nx, int ny, int nz) {
+
+	this-> nx = nx;
+	nrows = nx * ny * nz;
+	max_nzeros = 7;
+	nonzeros = 0;
+
+	vals = new T[nrows*max_nzeros];
+	rhs = new T[nrows];
+	col_ind = new int[nrows*max_nzeros];
+	nzeros_per_row = new int[nrows];
+	exact = NULL;
+
+	for(int k=0; k < nz; k++) {
+		for(int j=0; j < ny; j++) {
+			for(int i=0; i < nx; i++) {
+
+				int idx = (k*ny + j)*nx + i;
+				int n = 0;
+
+				// neighbors in increasing column order
+				if(k > 0) {
+					col_ind[idx*max_nzeros+n] = idx - nx*ny;
+					vals[idx*max_nzeros+n] = -1.0;
+					n++;
+				}
+				if(j > 0) {
+					col_ind[idx*max_nzeros+n] = idx - nx;
+					vals[idx*max_nzeros+n] = -1.0;
+					n++;
+				}
+				if(i > 0) {
+					col_ind[idx*max_nzeros+n] = idx - 1;
+					vals[idx*max_nzeros+n] = -1.0;
+					n++;
+				}
+
+				col_ind[idx*max_nzeros+n] = idx;
+				vals[idx*max_nzeros+n] = 6.0;
+				n++;
+
+				if(i < nx-1) {
+					col_ind[idx*max_nzeros+n] = idx + 1;
+					vals[idx*max_nzeros+n] = -1.0;
+					n++;
+				}
+				if(j < ny-1) {
+					col_ind[idx*max_nzeros+n] = idx + nx;
+					vals[idx*max_nzeros+n] = -1.0;
+					n++;
+				}
+				if(k < nz-1) {
+					col_ind[idx*max_nzeros+n] = idx + nx*ny;
+					vals[idx*max_nzeros+n] = -1.0;
+					n++;
+				}
+
+				nzeros_per_row[idx] = n;
+				nonzeros += n;
+
+				// pad the rest of the row
+				for(; n < max_nzeros; n++) {
+					col_ind[idx*max_nzeros+n] = 0;
+					vals[idx*max_nzeros+n] = 0.0;
+				}
+
+				rhs[idx] = 1.0;
+			}
+		}
+	}
+}
+
 template<typename T>
 void Params<T>::InitMat(std::string matrix_file) {
 
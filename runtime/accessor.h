@@ -139,6 +139,7 @@ namespace LegionRuntime {
       template <size_t STRIDE> struct AOS;
       template <size_t STRIDE> struct SOA;
       template <size_t STRIDE, size_t BLOCK_SIZE, size_t BLOCK_STRIDE> struct HybridSOA;
+      template <int DIM> struct Affine;
 
       template <typename REDOP> struct ReductionFold;
       template <typename REDOP> struct ReductionList;
@@ -211,6 +212,11 @@ namespace LegionRuntime {
 	  void read_untyped(const Realm::DomainPoint& dp, void *dst, size_t bytes, off_t offset = 0) const;
 	  void write_untyped(const Realm::DomainPoint& dp, const void *src, size_t bytes, off_t offset = 0) const;
 
+	  template <unsigned DIM>
+	  void read_untyped(const Point<DIM>& p, void *dst, size_t bytes, off_t offset = 0) const;
+	  template <unsigned DIM>
+	  void write_untyped(const Point<DIM>& p, const void *src, size_t bytes, off_t offset = 0) const;
+
 	  RegionAccessor<Generic, void, void> get_untyped_field_accessor(off_t _field_offset, size_t _field_size)
 	  {
 	    return RegionAccessor<Generic, void, void>(Untyped(internal, field_offset + _field_offset));
@@ -253,6 +259,14 @@ namespace LegionRuntime {
 					 size_t& block_size, size_t& block_stride) const;
 	  bool get_redfold_parameters(void *& base) const;
 	  bool get_redlist_parameters(void *& base, ptr_t *& next_ptr) const;
+	  // succeeds if every point in bounds is at base + sum(p[i] * strides[i])
+	  template <int DIM>
+	  bool get_affine_parameters(const Rect<DIM>& bounds, void *& base, ByteOffset *strides) const;
+	  // same, but for the piece of bounds starting at bounds.lo that is
+	  //  affine (e.g. one tile of a tiled instance)
+	  template <int DIM>
+	  bool get_affine_parameters(const Rect<DIM>& bounds, Rect<DIM>& subrect,
+				     void *& base, ByteOffset *strides) const;
 	};
 
 	// empty class that will have stuff put in it later if T is a struct
@@ -298,6 +312,19 @@ namespace LegionRuntime {
             write_untyped(ptr, &newval, sizeof(newval)); 
           }
 
+	  // privileges and bounds are checked by read_untyped/write_untyped
+	  template <unsigned DIM>
+	  inline T read(const Point<DIM>& p) const
+	  {
+	    T val; read_untyped(p, &val, sizeof(val)); return val;
+	  }
+
+	  template <unsigned DIM>
+	  inline void write(const Point<DIM>& p, const T& newval) const
+	  {
+	    write_untyped(p, &newval, sizeof(newval));
+	  }
+
 	  T *raw_span_ptr(ptr_t ptr, size_t req_count, size_t& act_count, ByteOffset& offset)
 	  { return (T*)(Untyped::raw_span_ptr(ptr, req_count, act_count, offset)); }
 
@@ -328,6 +355,14 @@ namespace LegionRuntime {
 	    write(ptr, val);
 	  }
 
+	  template<typename REDOP, unsigned DIM>
+	  inline void reduce(const Point<DIM>& p, typename REDOP::RHS newval) const
+	  {
+	    T val = read(p);
+	    REDOP::template apply<true>(val, newval);
+	    write(p, val);
+	  }
+
 	  typedef AOS<sizeof(PT)> AOS_TYPE;
 
 	  template <typename AT>
@@ -340,6 +375,38 @@ namespace LegionRuntime {
 	    return convert_helper<AT>(static_cast<AT *>(0));
 	  }
 
+	  // affine accessors are only valid over the bounds they were made
+	  //  for, so they don't go through can_convert/convert
+	  template <int DIM>
+	  bool can_convert_affine(const Rect<DIM>& bounds) const {
+	    void *affine_base = 0;
+	    ByteOffset affine_strides[DIM];
+	    return get_affine_parameters<DIM>(bounds, affine_base, affine_strides);
+	  }
+
+	  template <int DIM>
+	  RegionAccessor<Affine<DIM>, T> convert_affine(const Rect<DIM>& bounds) const {
+	    void *affine_base = 0;
+	    ByteOffset affine_strides[DIM];
+#ifndef NDEBUG
+	    bool ok = 
+#endif
+              get_affine_parameters<DIM>(bounds, affine_base, affine_strides);
+	    assert(ok);
+	    typename Affine<DIM>::template Typed<T, T> t(affine_base, affine_strides);
+            RegionAccessor<Affine<DIM>, T> result(t);
+#ifdef BOUNDS_CHECKS
+            result.set_bounds(bounds);
+#endif
+#if defined(PRIVILEGE_CHECKS) || defined(BOUNDS_CHECKS)
+            result.set_region(region);
+#endif
+#ifdef PRIVILEGE_CHECKS
+            result.set_privileges(priv);
+#endif
+            return result;
+	  }
+
 	  template <typename AT, size_t STRIDE>
 	  bool can_convert_helper(AOS<STRIDE> *dummy) const {
 	    //printf("in aos(%zd) converter\n", STRIDE);
@@ -845,6 +912,129 @@ namespace LegionRuntime {
 	};
       };
 
+      // An element's address is a base plus a byte stride for each
+      //  dimension, which covers AOS, SOA and dense 1-3D instances but not
+      //  HybridSOA, and tiled instances one tile at a time.  Get one from
+      //  Generic::Typed::convert_affine for the bounds a task will touch (or
+      //  use dispatch_accessor below), after which every access is a few
+      //  multiply-adds with no calls.
+      template <int DIM>
+      struct Affine {
+	struct Untyped {
+          CUDAPREFIX
+	  Untyped() : base(0)
+	  {
+	    for(int i = 0; i < DIM; i++) strides[i] = 0;
+	  }
+          CUDAPREFIX
+	  Untyped(void *_base, const ByteOffset *_strides) : base((char *)_base)
+	  {
+	    for(int i = 0; i < DIM; i++) strides[i] = _strides[i].offset;
+	  }
+
+          CUDAPREFIX
+	  inline char *elem_ptr(const Point<DIM>& p) const
+	  {
+#ifdef BOUNDS_CHECKS 
+            assert(bounds.contains(p));
+#endif
+	    char *ptr = base;
+	    for(int i = 0; i < DIM; i++)
+	      ptr += p.x[i] * strides[i];
+	    return ptr;
+	  }
+
+	  // only meaningful for 1-D instances
+          CUDAPREFIX
+	  inline char *elem_ptr(ptr_t ptr) const
+	  {
+#ifdef BOUNDS_CHECKS 
+            check_bounds(region, ptr);
+#endif
+	    return(base + (ptr.value * strides[0]));
+	  }
+
+	  char *base;
+	  off_t strides[DIM];
+#ifdef BOUNDS_CHECKS
+        protected:
+          Rect<DIM> bounds;
+#endif
+#if defined(PRIVILEGE_CHECKS) || defined(BOUNDS_CHECKS)
+        protected:
+          void *region;
+        public:
+          inline void set_region_untyped(void *r) { region = r; }
+#endif
+#ifdef PRIVILEGE_CHECKS
+        protected:
+          AccessorPrivilege priv;
+        public:
+          inline void set_privileges_untyped(AccessorPrivilege p) { priv = p; }
+#endif
+	};
+
+	template <typename T, typename PT>
+	struct Typed : protected Untyped {
+          CUDAPREFIX
+	  Typed() : Untyped() {}
+          CUDAPREFIX
+	  Typed(void *_base, const ByteOffset *_strides) : Untyped(_base, _strides) {}
+
+#ifdef BOUNDS_CHECKS
+          inline void set_bounds(const Rect<DIM>& r) { this->bounds = r; }
+#endif
+#if defined(PRIVILEGE_CHECKS) || defined(BOUNDS_CHECKS) 
+          inline void set_region(void *r) { this->region = r; }
+#endif
+#ifdef PRIVILEGE_CHECKS
+          inline void set_privileges(AccessorPrivilege p) { this->priv = p; }
+#endif
+
+	  // PTRTYPE is either a Point<DIM> or (for 1-D) a ptr_t
+	  template <typename PTRTYPE> CUDAPREFIX
+	  inline T read(const PTRTYPE& ptr) const 
+          { 
+#ifdef PRIVILEGE_CHECKS
+            check_privileges<ACCESSOR_READ>(this->priv, this->region);
+#endif
+            return *(const T *)(Untyped::elem_ptr(ptr)); 
+          }
+	  template <typename PTRTYPE> CUDAPREFIX
+	  inline void write(const PTRTYPE& ptr, const T& newval) const 
+          { 
+#ifdef PRIVILEGE_CHECKS
+            check_privileges<ACCESSOR_WRITE>(this->priv, this->region);
+#endif
+            *(T *)(Untyped::elem_ptr(ptr)) = newval; 
+          }
+	  template <typename PTRTYPE> CUDAPREFIX
+	  inline T *ptr(const PTRTYPE& ptr) const 
+          { 
+            return (T *)Untyped::elem_ptr(ptr); 
+          }
+	  template <typename PTRTYPE> CUDAPREFIX
+          inline T& ref(const PTRTYPE& ptr) const 
+          { 
+            return *((T*)Untyped::elem_ptr(ptr)); 
+          }
+
+	  template<typename REDOP, typename PTRTYPE> CUDAPREFIX
+	  inline void reduce(const PTRTYPE& ptr, typename REDOP::RHS newval) const
+	  {
+#ifdef PRIVILEGE_CHECKS
+            check_privileges<ACCESSOR_REDUCE>(this->priv, this->region);
+#endif
+	    REDOP::template apply<false>(*(T *)Untyped::elem_ptr(ptr), newval);
+	  }
+
+	  // byte stride between neighbors in dimension 'dim', for callers
+	  //  that want to walk a row themselves
+          CUDAPREFIX
+	  inline ByteOffset stride(int dim) const { return ByteOffset(Untyped::strides[dim]); }
+	};
+      };
+
       template <typename REDOP>
       struct ReductionFold {
 	struct Untyped {
@@ -1016,6 +1206,59 @@ namespace LegionRuntime {
 	//FieldAccessor(const typename AT::template Inner<ET, PT>::template Field<FT>& to_copy) {}
       };
     };
+
+    // Resolves the layout of a Generic accessor once and calls f(accessor)
+    //  with an Affine accessor if the instance is affine over bounds, or
+    //  with the Generic accessor if not.  F's operator() should be a
+    //  template on the accessor type, so the loop inside is compiled once
+    //  for each layout and the affine version has no calls or branches:
+    //
+    //    struct Scale {
+    //      Rect<2> r; double alpha;
+    //      template <typename ACC> void operator()(const ACC& acc) {
+    //        for(GenericPointInRectIterator<2> pir(r); pir; pir++)
+    //          acc.write(pir.p, alpha * acc.read(pir.p));
+    //      }
+    //    };
+    //    dispatch_accessor(generic_acc, r, scale);
+    template <unsigned DIM, typename T, typename F>
+    inline void dispatch_accessor(const RegionAccessor<AccessorType::Generic, T>& acc,
+				  const Rect<DIM>& bounds, F& f)
+    {
+      if(acc.template can_convert_affine<DIM>(bounds))
+	f(acc.template convert_affine<DIM>(bounds));
+      else
+	f(acc);
+    }
+
+    // Like dispatch_accessor, for instances that are only affine in pieces
+    //  (e.g. tiled layouts, which are affine within each tile).  Calls
+    //  f(accessor, subrect) with an Affine accessor for each piece of
+    //  bounds, or f(accessor, bounds) once with the Generic accessor if the
+    //  instance isn't affine at all.
+    template <unsigned DIM, typename T, typename F>
+    inline void dispatch_accessor_subrects(const RegionAccessor<AccessorType::Generic, T>& acc,
+					   const Rect<DIM>& bounds, F& f)
+    {
+      Rect<DIM> rest = bounds, subrect;
+      void *base = 0;
+      ByteOffset strides[DIM];
+      if(!acc.template get_affine_parameters<DIM>(rest, subrect, base, strides)) {
+	f(acc, bounds);
+	return;
+      }
+      while(true) {
+	f(acc.template convert_affine<DIM>(subrect), subrect);
+	unsigned seam_idx;
+	if(!next_subrect_remainder(bounds, subrect, rest, seam_idx))
+	  break;
+#ifndef NDEBUG
+	bool ok =
+#endif
+	  acc.template get_affine_parameters<DIM>(rest, subrect, base, strides);
+	assert(ok);
+      }
+    }
   };
 };
 
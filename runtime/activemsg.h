@@ -59,6 +59,10 @@
       METADATA_RESPONSE_MSGID, // should really be a reply
       METADATA_INVALIDATE_MSGID,
       METADATA_INVALIDATE_ACK_MSGID,
+      METADATA_BULK_REQUEST_MSGID,
+      METADATA_BULK_RESPONSE_MSGID,
+      METADATA_BULK_INVALIDATE_MSGID,
+      METADATA_BULK_INVALIDATE_ACK_MSGID,
     };
 
 
@@ -79,6 +83,24 @@ namespace Realm {
   class CoreReservationSet;
 };
 
+// abstract class for incoming messages - actual messages are
+//  templated on their argument types and handler
+class IncomingMessage {
+ public:
+  IncomingMessage(void)
+    : next_msg(0)
+  {}
+  virtual ~IncomingMessage(void) {}
+
+  virtual void run_handler(void) = 0;
+
+  virtual int get_peer(void) = 0;
+  virtual int get_msgid(void) = 0;
+  virtual size_t get_msgsize(void) = 0;
+
+  IncomingMessage *next_msg;
+};
+
 // if USE_GASNET isn't defined, then we replace all the good stuff with 
 //  single-node-only stubs
 #ifdef USE_GASNET
@@ -293,24 +315,6 @@ class ActiveMsgProfilingHelper {
 };
 #endif
 
-// abstract class for incoming messages - actual messages are
-//  templated on their argument types and handler
-class IncomingMessage {
- public:
-  IncomingMessage(void)
-    : next_msg(0)
-  {}
-  virtual ~IncomingMessage(void) {}
-
-  virtual void run_handler(void) = 0;
-
-  virtual int get_peer(void) = 0;
-  virtual int get_msgid(void) = 0;
-  virtual size_t get_msgsize(void) = 0;
-
-  IncomingMessage *next_msg;
-};
-
 template <class MSGTYPE, int MSGID,
           void (*SHORT_HNDL_PTR)(MSGTYPE),
           void (*MED_HNDL_PTR)(MSGTYPE, const void *, size_t),
@@ -656,8 +660,15 @@ class ActiveMessageMediumNoReply {
 #define CHECK_GASNET(cmd) cmd
 
 typedef unsigned gasnet_node_t;
+#ifdef USE_SHM_AM
+// node count and ID are set up by gasnet_init (see shm_activemsg.cc)
+extern gasnet_node_t shm_my_node, shm_num_nodes;
+#define gasnet_mynode() (shm_my_node)
+#define gasnet_nodes()  (shm_num_nodes)
+#else
 #define gasnet_mynode() ((gasnet_node_t)0)
 #define gasnet_nodes()  ((gasnet_node_t)1)
+#endif
 
 #include <pthread.h>
 
@@ -739,8 +750,13 @@ protected:
 
  // barriers
 #define GASNET_BARRIERFLAG_ANONYMOUS 0
+#ifdef USE_SHM_AM
+extern void gasnet_barrier_notify(int, int);
+extern void gasnet_barrier_wait(int, int);
+#else
 inline void gasnet_barrier_notify(int, int) {}
 inline void gasnet_barrier_wait(int, int) {}
+#endif
 
 // threadkeys
 class ThreadKey {
@@ -771,6 +787,237 @@ inline void gasnett_threadkey_set(ThreadKey& key, void *newval) { key.set(newval
 
 #endif
 
+#ifdef USE_SHM_AM
+// shared memory transport - each node is a process on this host (forked by
+//  gasnet_init), every pair of nodes has a ring for messages in one shared
+//  mapping, and that mapping also holds each node's segment (the "gasnet"
+//  and registered memory)
+
+#include <stdio.h>
+#include <string.h>
+
+typedef struct {
+  int index;
+  void (*fnptr)();
+  const char *description;
+} gasnet_handlerentry_t;
+typedef int gasnet_handle_t;
+typedef struct {
+  void *addr;
+  size_t size;
+} gasnet_seginfo_t;
+
+extern void gasnet_init(int *argc, char ***argv);
+extern void gasnet_getSegmentInfo(gasnet_seginfo_t *seginfos, gasnet_node_t count);
+extern void gasnet_exit(int code);
+
+// segments are mapped at the same address in every process, so one-sided
+//  transfers are just copies
+inline void gasnet_get(void *dst, int node, void *src, size_t size) { memcpy(dst, src, size); }
+inline void gasnet_get_nbi(void *dst, int node, void *src, size_t size) { memcpy(dst, src, size); }
+inline void gasnet_put(int node, void *dst, void *src, size_t size) { memcpy(dst, src, size); }
+inline void gasnet_put_nbi(int node, void *dst, void *src, size_t size) { memcpy(dst, src, size); }
+inline void gasnet_wait_syncnbi_gets(void) {}
+inline void gasnet_wait_syncnb(gasnet_handle_t) {}
+inline void gasnet_begin_nbi_accessregion(void) {}
+inline gasnet_handle_t gasnet_end_nbi_accessregion(void) { return 0; }
+
+class BaseMedium { public: void *srcptr; };
+class BaseReply {};
+
+extern void enqueue_message(gasnet_node_t target, int msgid,
+			    const void *args, size_t arg_size,
+			    const void *payload, size_t payload_size,
+			    int payload_mode, void *dstptr = 0);
+
+extern void enqueue_message(gasnet_node_t target, int msgid,
+			    const void *args, size_t arg_size,
+			    const void *payload, size_t line_size,
+			    off_t line_stride, size_t line_count,
+			    int payload_mode, void *dstptr = 0);
+
+extern void enqueue_message(gasnet_node_t target, int msgid,
+			    const void *args, size_t arg_size,
+			    const SpanList& spans, size_t payload_size,
+			    int payload_mode, void *dstptr = 0);
+
+// frees a payload the transport copied out of a ring (payloads that were
+//  written directly to their destination are left alone)
+extern void shm_release_payload(void *payload);
+
+// the polling thread copies each message out of its ring and hands it to
+//  the factory registered for its message ID, which is one of these
+typedef IncomingMessage *(*ShmMessageFactory)(gasnet_node_t sender,
+					      const void *args, size_t arglen,
+					      void *payload, size_t payload_len);
+
+template <class MSGTYPE, int MSGID, void (*FNPTR)(MSGTYPE)>
+class ShmIncomingShortMessage : public IncomingMessage {
+ public:
+  ShmIncomingShortMessage(gasnet_node_t _sender)
+    : sender(_sender)
+  {}
+
+  static IncomingMessage *create(gasnet_node_t sender,
+				 const void *args, size_t arglen,
+				 void *payload, size_t payload_len)
+  {
+    assert(arglen == sizeof(MSGTYPE));
+    ShmIncomingShortMessage *msg = new ShmIncomingShortMessage(sender);
+    memcpy(&(msg->args), args, sizeof(MSGTYPE));
+    return msg;
+  }
+
+  virtual void run_handler(void) { (*FNPTR)(args); }
+
+  virtual int get_peer(void) { return sender; }
+  virtual int get_msgid(void) { return MSGID; }
+  virtual size_t get_msgsize(void) { return sizeof(MSGTYPE); }
+
+  gasnet_node_t sender;
+  MSGTYPE args;
+};
+
+template <class MSGTYPE, int MSGID, void (*FNPTR)(MSGTYPE, const void *, size_t)>
+class ShmIncomingMediumMessage : public IncomingMessage {
+ public:
+  ShmIncomingMediumMessage(gasnet_node_t _sender, void *_payload, size_t _payload_len)
+    : sender(_sender), payload(_payload), payload_len(_payload_len)
+  {}
+
+  static IncomingMessage *create(gasnet_node_t sender,
+				 const void *args, size_t arglen,
+				 void *payload, size_t payload_len)
+  {
+    assert(arglen == sizeof(MSGTYPE));
+    ShmIncomingMediumMessage *msg = new ShmIncomingMediumMessage(sender, payload, payload_len);
+    memcpy(&(msg->args), args, sizeof(MSGTYPE));
+    return msg;
+  }
+
+  virtual void run_handler(void)
+  {
+    (*FNPTR)(args, payload, payload_len);
+    shm_release_payload(payload);
+  }
+
+  virtual int get_peer(void) { return sender; }
+  virtual int get_msgid(void) { return MSGID; }
+  virtual size_t get_msgsize(void) { return sizeof(MSGTYPE) + payload_len; }
+
+  gasnet_node_t sender;
+  void *payload;
+  size_t payload_len;
+  MSGTYPE args;
+};
+
+template <int MSGID, class MSGTYPE, void (*FNPTR)(MSGTYPE)>
+class ActiveMessageShortNoReply {
+ public:
+  static void request(gasnet_node_t dest, MSGTYPE args)
+  {
+    enqueue_message(dest, MSGID, &args, sizeof(MSGTYPE),
+		    0, 0, PAYLOAD_NONE);
+  }
+
+  static int add_handler_entries(gasnet_handlerentry_t *entries, const char *description)
+  {
+    entries[0].index = MSGID;
+    entries[0].fnptr = (void (*)()) (ShmIncomingShortMessage<MSGTYPE,MSGID,FNPTR>::create);
+    entries[0].description = description;
+    return 1;
+  }
+};
+
+template <int MSGID, class MSGTYPE, void (*FNPTR)(MSGTYPE, const void *, size_t)>
+class ActiveMessageMediumNoReply {
+ public:
+  static void request(gasnet_node_t dest, /*const*/ MSGTYPE &args, 
+                      const void *data, size_t datalen,
+		      int payload_mode, void *dstptr = 0)
+  {
+    enqueue_message(dest, MSGID, &args, sizeof(MSGTYPE),
+		    data, datalen, payload_mode, dstptr);
+  }
+
+  static void request(gasnet_node_t dest, /*const*/ MSGTYPE &args, 
+                      const void *data, size_t line_len,
+		      off_t line_stride, size_t line_count,
+		      int payload_mode, void *dstptr = 0)
+  {
+    enqueue_message(dest, MSGID, &args, sizeof(MSGTYPE),
+		    data, line_len, line_stride, line_count, payload_mode, dstptr);
+  }
+
+  static void request(gasnet_node_t dest, /*const*/ MSGTYPE &args, 
+                      const SpanList& spans, size_t datalen,
+		      int payload_mode, void *dstptr = 0)
+  {
+    enqueue_message(dest, MSGID, &args, sizeof(MSGTYPE),
+		    spans, datalen, payload_mode, dstptr);
+  }
+
+  static int add_handler_entries(gasnet_handlerentry_t *entries, const char *description)
+  {
+    entries[0].index = MSGID;
+    entries[0].fnptr = (void (*)()) (ShmIncomingMediumMessage<MSGTYPE,MSGID,FNPTR>::create);
+    entries[0].description = description;
+    return 1;
+  }
+};
+
+template <class T> struct HandlerReplyFuture {
+  HandlerReplyFuture(void)
+    : condvar(mutex), valid(false)
+  {}
+
+  void set(T newval)
+  {
+    mutex.lock();
+    valid = true;
+    value = newval;
+    condvar.broadcast();
+    mutex.unlock();
+  }
+
+  bool is_set(void) const { return valid; }
+
+  void wait(void)
+  {
+    if(valid) return; // early out
+    mutex.lock();
+    while(!valid) condvar.wait();
+    mutex.unlock();
+  }
+
+  T get(void) const { return value; }
+
+  GASNetHSL mutex;
+  GASNetCondVar condvar;
+  volatile bool valid;
+  T value;
+};
+
+extern void init_endpoints(gasnet_handlerentry_t *handlers, int hcount,
+			   int gasnet_mem_size_in_mb,
+			   int registered_mem_size_in_mb,
+			   Realm::CoreReservationSet& crs,
+			   int argc, const char *argv[]);
+extern void start_polling_threads(int count);
+extern void start_handler_threads(int count, Realm::CoreReservationSet& crs, size_t stacksize);
+extern void stop_activemsg_threads(void);
+// per-message-type counts, latencies and bandwidths seen by this node
+extern void report_activemsg_status(FILE *f);
+
+// returns the largest payload that can be sent to a node (to a non-pinned
+//   address) in one piece
+extern size_t get_lmb_size(int target_node);
+
+// the polling thread does all the work, so this just gives it a chance to run
+extern void do_some_polling(void);
+
+#else // ifdef USE_SHM_AM
+
 // active message placeholders
 
 typedef int gasnet_handlerentry_t;
@@ -879,6 +1126,8 @@ inline void stop_activemsg_threads(void)
 inline void do_some_polling(void) {}
 inline size_t get_lmb_size(int target_node) { return 0; }
 
+#endif // ifdef USE_SHM_AM
+
 #endif // ifdef USE_GASNET
 
     template <typename LT>
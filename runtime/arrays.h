@@ -380,7 +380,7 @@ namespace LegionRuntime {
         return (hi.x[dim] - lo.x[dim] + 1);
       }
 
-      Rect<DIM> intersection(const Rect<DIM>& other)
+      Rect<DIM> intersection(const Rect<DIM>& other) const
       {
 	return Rect<DIM>(Point<DIM>::max(lo, other.lo),
 			 Point<DIM>::min(hi, other.hi));
@@ -603,6 +603,38 @@ namespace LegionRuntime {
       }
     };
   
+    // Subrect iterators cover a rectangle with pieces that each start at
+    //  the lo corner of a rectangle that's still left to do.  Given the
+    //  original rectangle and the last piece, this finds that next
+    //  rectangle, splitting along the "seam" - the first dimension whose
+    //  last piece didn't reach the edge of the original rectangle.
+    //  Returns false once the whole rectangle is covered.
+    template <unsigned DIM>
+    inline bool next_subrect_remainder(const Rect<DIM>& orig_rect, const Rect<DIM>& subrect,
+				       Rect<DIM>& newrect, unsigned& seam_idx)
+    {
+      seam_idx = 0;
+      while(subrect.hi.x[seam_idx] == orig_rect.hi.x[seam_idx]) {
+	seam_idx++;
+	if(seam_idx >= DIM)
+	  return false;
+      }
+      // dimensions below the seam use the original rectangle bounds
+      for(unsigned i = 0; i < seam_idx; i++) {
+	newrect.lo.x[i] = orig_rect.lo.x[i];
+	newrect.hi.x[i] = orig_rect.hi.x[i];
+      }
+      // the seam continues where we left off
+      newrect.lo.x[seam_idx] = subrect.hi.x[seam_idx] + 1;
+      newrect.hi.x[seam_idx] = orig_rect.hi.x[seam_idx];
+      // above the seam tries to use the same cross section
+      for(unsigned i = seam_idx + 1; i < DIM; i++) {
+	newrect.lo.x[i] = subrect.lo.x[i];
+	newrect.hi.x[i] = subrect.hi.x[i];
+      }
+      return true;
+    }
+
     template <typename T>
     class GenericDenseSubrectIterator {
     public:
@@ -621,30 +653,12 @@ namespace LegionRuntime {
       
       bool step(void)
       {
-	// to make a step, find the "seam" along which we split last time - first dimension whose
-	//  subrect.hi isn't the edge of the original rect
-	unsigned seam_idx = 0;
-	while(subrect.hi.x[seam_idx] == orig_rect.hi.x[seam_idx]) {
-	  seam_idx++;
-          if(seam_idx >= T::IDIM) {
-            any_left = false;
-            return false;
-          }
-	}
 	// ask for the rest of the original rect along the current split
 	Rect<T::IDIM> newrect;
-	// dimensions below the seam use the original rectangle bounds
-	for(unsigned i = 0; i < seam_idx; i++) {
-	  newrect.lo.x[i] = orig_rect.lo.x[i];
-	  newrect.hi.x[i] = orig_rect.hi.x[i];
-	}
-	// the seam continues where we left off
-	newrect.lo.x[seam_idx] = subrect.hi.x[seam_idx] + 1;
-	newrect.hi.x[seam_idx] = orig_rect.hi.x[seam_idx];
-	// above the seam tries to use the same cross section
-	for(unsigned i = seam_idx + 1; i < T::IDIM; i++) {
-	  newrect.lo.x[i] = subrect.lo.x[i];
-	  newrect.hi.x[i] = subrect.hi.x[i];
+	unsigned seam_idx;
+	if(!next_subrect_remainder(orig_rect, subrect, newrect, seam_idx)) {
+	  any_left = false;
+	  return false;
 	}
 
 	image = mapping.image_dense_subrect(newrect, subrect);
@@ -681,9 +695,24 @@ namespace LegionRuntime {
       
       bool step(void)
       {
-	assert(subrect == orig_rect);
-	any_left = false;
-	return false;
+	// most mappings are linear over the whole rectangle, but tiled ones
+	//  are only linear within a tile
+	Rect<T::IDIM> newrect;
+	unsigned seam_idx;
+	if(!next_subrect_remainder(orig_rect, subrect, newrect, seam_idx)) {
+	  any_left = false;
+	  return false;
+	}
+
+	image_lo = mapping.image_linear_subrect(newrect, subrect, strides);
+
+	// sanity check that dimensions above the current seam didn't further split
+	for(unsigned i = seam_idx + 1; i < T::IDIM; i++) {
+	  assert(newrect.lo.x[i] == subrect.lo.x[i]);
+	  assert(newrect.hi.x[i] == subrect.hi.x[i]);
+	}
+
+	return true;
       }
 
       operator bool(void) const { return any_left; }
@@ -858,6 +887,166 @@ namespace LegionRuntime {
       }
     };
 
+    // Stores each tile_size-shaped tile of a rectangle contiguously, with
+    //  points column-major within a tile.  Tiles are numbered column-major,
+    //  or along a Z-order curve if 'morton' is set, so neighbors in every
+    //  dimension stay close in memory.  Edge tiles are padded to full size,
+    //  so the image of the rectangle can have holes in it.  The mapping is
+    //  only linear (and dense) within a tile, so subrects are clipped to the
+    //  tile holding r.lo.
+    template <unsigned DIM>
+    class TiledLinearization {
+    public:
+      enum { IDIM = DIM, ODIM = 1 };
+      typedef GenericDenseSubrectIterator<TiledLinearization<DIM> > DenseSubrectIterator;
+      typedef GenericLinearSubrectIterator<TiledLinearization<DIM> > LinearSubrectIterator;
+      typedef GenericPointInRectIterator<IDIM> PointInInputRectIterator;
+      typedef GenericPointInRectIterator<ODIM> PointInOutputRectIterator;
+
+      TiledLinearization(void) {}
+      TiledLinearization(Rect<DIM> bounds, Point<DIM> _tile_size,
+			 bool _morton = false, int first_index = 0)
+	: origin(bounds.lo), tile_size(_tile_size), offset(first_index), morton(_morton)
+      {
+	for(unsigned i = 0; i < DIM; i++) {
+	  assert(tile_size.x[i] > 0);
+	  num_tiles.x[i] = ((bounds.hi.x[i] - bounds.lo.x[i] + tile_size.x[i]) /
+			    tile_size.x[i]);
+	}
+      }
+
+      Point<1> image(const Point<IDIM> p) const
+      {
+	Point<DIM> tile, within;
+	for(unsigned i = 0; i < DIM; i++) {
+	  tile.x[i] = (p.x[i] - origin.x[i]) / tile_size.x[i];
+	  within.x[i] = (p.x[i] - origin.x[i]) - (tile.x[i] * tile_size.x[i]);
+	}
+	int index = 0;
+	for(int i = int(DIM) - 1; i >= 0; i--)
+	  index = (index * tile_size.x[i]) + within.x[i];
+	return offset + (tile_index(tile) * tile_volume()) + index;
+      }
+
+      // both tile orders and the order within a tile increase with each
+      //  coordinate, so the corners bound the image
+      Rect<1> image_convex(const Rect<IDIM> r) const
+      {
+	return Rect<1>(image(r.lo), image(r.hi));
+      }
+
+      bool image_is_dense(const Rect<IDIM> r) const
+      {
+	Rect<1> convex = image_convex(r);
+	return (size_t)(convex.hi[0] - convex.lo[0] + 1) == r.volume();
+      }
+
+      Rect<ODIM> image_dense_subrect(const Rect<IDIM> r, Rect<IDIM>& subrect) const
+      {
+	Rect<IDIM> tile = tile_rect(r.lo);
+	Rect<IDIM> s(r.lo, r.lo);
+	if(tile.contains(r)) {
+	  // the next dimension can only be added if the ones below it cover
+	  //  the tile's whole extent
+	  for(unsigned i = 0; i < IDIM; i++) {
+	    s.hi.x[i] = r.hi.x[i];
+	    if((r.lo.x[i] != tile.lo.x[i]) || (r.hi.x[i] != tile.hi.x[i]))
+	      break;
+	  }
+	} else {
+	  // only take a run in the first dimension so that every subrect of
+	  //  a multi-tile rectangle has the same cross section
+	  s.hi.x[0] = ((r.hi.x[0] < tile.hi.x[0]) ? r.hi.x[0] : tile.hi.x[0]);
+	}
+	subrect = s;
+	return image_convex(s);
+      }
+
+      Point<ODIM> image_linear_subrect(const Rect<IDIM> r, Rect<IDIM>& subrect, Point<ODIM> strides[IDIM]) const
+      {
+	subrect = r.intersection(tile_rect(r.lo));
+	int stride = 1;
+	for(unsigned i = 0; i < IDIM; i++) {
+	  strides[i] = stride;
+	  stride *= tile_size.x[i];
+	}
+	return image(r.lo);
+      }
+
+      Rect<IDIM> preimage(const Point<ODIM> p) const
+      {
+	assert(0);
+	return Rect<IDIM>();
+      }
+
+      bool preimage_is_dense(const Point<ODIM> p) const
+      {
+	return true;
+      }
+
+    protected:
+      int tile_volume(void) const
+      {
+	int volume = 1;
+	for(unsigned i = 0; i < DIM; i++)
+	  volume *= tile_size.x[i];
+	return volume;
+      }
+
+      // the tile containing p
+      Rect<DIM> tile_rect(const Point<DIM> p) const
+      {
+	Rect<DIM> r;
+	for(unsigned i = 0; i < DIM; i++) {
+	  r.lo.x[i] = origin.x[i] + (((p.x[i] - origin.x[i]) / tile_size.x[i]) * tile_size.x[i]);
+	  r.hi.x[i] = r.lo.x[i] + tile_size.x[i] - 1;
+	}
+	return r;
+      }
+
+      int tile_index(const Point<DIM> tile) const
+      {
+	if(!morton) {
+	  int index = 0;
+	  for(int i = int(DIM) - 1; i >= 0; i--)
+	    index = (index * num_tiles.x[i]) + tile.x[i];
+	  return index;
+	}
+
+	// interleave the bits of the tile coordinates, skipping a dimension
+	//  once it runs out of bits so that narrow rectangles don't get
+	//  padded out to a cube
+	int index = 0;
+	int out_bit = 0;
+	bool any_left = true;
+	for(int bit = 0; any_left; bit++) {
+	  any_left = false;
+	  for(unsigned i = 0; i < DIM; i++) {
+	    if((num_tiles.x[i] - 1) >> bit) {
+	      index |= ((tile.x[i] >> bit) & 1) << out_bit;
+	      out_bit++;
+	      any_left = true;
+	    }
+	  }
+	}
+	return index;
+      }
+
+      // everything else is computed from these so that they all fit in a
+      //  serialized linearization
+      Point<DIM> origin, tile_size, num_tiles;
+      int offset;
+      bool morton;
+    };
+
+    template <unsigned DIM>
+    class MortonLinearization : public TiledLinearization<DIM> {
+    public:
+      MortonLinearization(void) {}
+      MortonLinearization(Rect<DIM> bounds, Point<DIM> _tile_size, int first_index = 0)
+	: TiledLinearization<DIM>(bounds, _tile_size, true /*morton*/, first_index) {}
+    };
+
     template <unsigned DIM>
     class Blockify {
     public:
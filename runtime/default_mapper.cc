@@ -76,7 +76,7 @@ namespace LegionRuntime {
         war_enabled(STATIC_WAR_ENABLED),
         stealing_enabled(STATIC_STEALING_ENABLED),
         max_schedule_count(STATIC_MAX_SCHEDULE_COUNT),
-        max_failed_mappings(STATIC_MAX_FAILED_MAPPINGS),
+        max_failed_mappings(STATIC_MAX_FAILED_MAPPINGS), machine_shape(0),
         machine_interface(MappingUtilities::MachineQueryInterface(m))
     //--------------------------------------------------------------------------
     {
@@ -110,11 +110,32 @@ namespace LegionRuntime {
           INT_ARG("-dm:sched", max_schedule_count);
           INT_ARG("-dm:prof",num_profiling_samples);
           INT_ARG("-dm:fail",max_failed_mappings);
+          if (!strcmp(argv[i], "-dm:cache") && ((i+1) < argc))
+          {
+            cache_file = argv[++i];
+            continue;
+          }
 #undef BOOL_ARG
 #undef INT_ARG
         }
         profiler.set_needed_profiling_samples(num_profiling_samples);
       }
+      // If we have a mapping cache, each processor keeps its own file
+      // so that mappers never race with each other on the same file
+      if (!cache_file.empty())
+      {
+        char suffix[32];
+        snprintf(suffix, 32, "." IDFMT, local_proc.id);
+        cache_file += suffix;
+        machine_shape = MappingCache::compute_machine_shape(machine);
+        if (mapping_cache.load(cache_file.c_str(), machine_shape))
+          log_mapper.info("Loaded mapping cache %s for processor " IDFMT "",
+                          cache_file.c_str(), local_proc.id);
+        else
+          log_mapper.info("No usable mapping cache %s for processor " IDFMT
+                          ", profiling from scratch", 
+                          cache_file.c_str(), local_proc.id);
+      }
     }
 
     //--------------------------------------------------------------------------
@@ -134,6 +155,17 @@ namespace LegionRuntime {
     {
       log_mapper.spew("Deleting default mapper for processor " IDFMT "",
                   local_proc.id);
+      if (!cache_file.empty() && mapping_cache.is_dirty())
+      {
+        // Other mappers on this processor may share the file
+        // so merge our results with whatever is there now
+        MappingCache merged;
+        merged.load(cache_file.c_str(), machine_shape);
+        merged.merge(mapping_cache);
+        if (!merged.save(cache_file.c_str(), machine_shape))
+          log_mapper.warning("Unable to save mapping cache %s for processor "
+                             IDFMT "", cache_file.c_str(), local_proc.id);
+      }
     }
 
     //--------------------------------------------------------------------------
@@ -154,13 +186,21 @@ namespace LegionRuntime {
       task->inline_task = false;
       task->spawn_task = stealing_enabled;
       task->map_locally = false; 
-      task->profile_task = !profiler.profiling_complete(task);
       task->task_priority = 0; // No prioritization
+      // If a previous run already profiled this task on this machine
+      // then skip straight to the best processor kind it found
+      Processor::Kind cached_kind;
+      const bool cached = 
+        mapping_cache.recall_processor_kind(task->variants->name, cached_kind)
+        && task->variants->has_variant(cached_kind, !(task->is_index_space),
+                                       task->is_index_space);
+      task->profile_task = !cached && !profiler.profiling_complete(task);
       // For selecting a target processor see if we have finished profiling
       // the given task otherwise send it to a processor of the right kind
-      if (profiler.profiling_complete(task))
+      if (cached || profiler.profiling_complete(task))
       {
-        Processor::Kind best_kind = profiler.best_processor_kind(task);
+        Processor::Kind best_kind = cached ? cached_kind :
+                                    profiler.best_processor_kind(task);
         // If our local processor is the right kind then do that
         if (best_kind == local_kind)
           task->target_proc = local_proc;
@@ -377,11 +417,17 @@ namespace LegionRuntime {
                             task->variants->name, 
                             task->get_unique_task_id(), local_proc.id);
 
+      // Prefer the processor kind found by a previous run if we have one
       Processor::Kind best_kind;
-      if (profiler.profiling_complete(task))
-        best_kind = profiler.best_processor_kind(task);
-      else
-        best_kind = profiler.next_processor_kind(task);
+      if (!mapping_cache.recall_processor_kind(task->variants->name, best_kind)
+          || !task->variants->has_variant(best_kind, false/*single*/, 
+                                          true/*index space*/))
+      {
+        if (profiler.profiling_complete(task))
+          best_kind = profiler.best_processor_kind(task);
+        else
+          best_kind = profiler.next_processor_kind(task);
+      }
       std::set<Processor> all_procs;
       machine.get_all_processors(all_procs);
       machine_interface.filter_processors(machine, best_kind, all_procs);
@@ -479,11 +525,32 @@ namespace LegionRuntime {
       Processor::Kind target_kind = task->target_proc.kind();
       for (unsigned idx = 0; idx < task->regions.size(); idx++)
       {
+        task->regions[idx].virtual_map = false;
+        task->regions[idx].enable_WAR_optimization = war_enabled;
+        task->regions[idx].reduction_list = false;
+        task->regions[idx].make_persistent = false;
+        if (target_kind == Processor::LOC_PROC)
+          // Elliott needs SOA for the compiler.
+          task->regions[idx].blocking_factor = // 1;
+            task->regions[idx].max_blocking_factor;
+        else
+          task->regions[idx].blocking_factor = 
+            task->regions[idx].max_blocking_factor;
         // See if this instance is restricted
         if (!task->regions[idx].restricted)
         {
+          size_t cached_blocking;
+          // Check to see if a previous run left us a mapping to use
+          if (mapping_cache.recall_mapping(task->variants->name, 
+                task->target_proc, idx, task->regions[idx].target_ranking,
+                cached_blocking))
+          {
+            if ((cached_blocking > 0) && 
+                (cached_blocking <= task->regions[idx].max_blocking_factor))
+              task->regions[idx].blocking_factor = cached_blocking;
+          }
           // Check to see if our memoizer already has mapping for us to use
-          if (memoizer.has_mapping(task->target_proc, task, idx))
+          else if (memoizer.has_mapping(task->target_proc, task, idx))
           {
             memoizer.recall_mapping(task->target_proc, task, idx,
                                     task->regions[idx].target_ranking);
@@ -504,17 +571,6 @@ namespace LegionRuntime {
           Memory target = (task->regions[idx].current_instances.begin())->first;
           task->regions[idx].target_ranking.push_back(target);
         }
-        task->regions[idx].virtual_map = false;
-        task->regions[idx].enable_WAR_optimization = war_enabled;
-        task->regions[idx].reduction_list = false;
-        task->regions[idx].make_persistent = false;
-        if (target_kind == Processor::LOC_PROC)
-          // Elliott needs SOA for the compiler.
-          task->regions[idx].blocking_factor = // 1;
-            task->regions[idx].max_blocking_factor;
-        else
-          task->regions[idx].blocking_factor = 
-            task->regions[idx].max_blocking_factor;
       }
       return true;
     }
@@ -796,6 +852,23 @@ namespace LegionRuntime {
       sample.index_point = task->index_point;
 
       profiler.add_profiling_sample(task->task_id, sample);
+      if (!cache_file.empty())
+      {
+        if (profiler.profiling_complete(task))
+          mapping_cache.record_processor_kind(task->variants->name,
+                                          profiler.best_processor_kind(task));
+        // Remember the rankings that were just committed by the memoizer
+        for (unsigned idx = 0; idx < task->regions.size(); idx++)
+        {
+          if (task->regions[idx].restricted)
+            continue;
+          std::vector<Memory> ranking;
+          if (memoizer.recall_mapping(task->target_proc, task, idx, ranking))
+            mapping_cache.record_mapping(task->variants->name, 
+                                         task->target_proc, idx, ranking,
+                                         task->regions[idx].blocking_factor);
+        }
+      }
       if (profiler.get_profiling_option(task->task_id).gather_in_orig_proc &&
           task->target_proc != task->orig_proc)
       {
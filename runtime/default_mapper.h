@@ -132,10 +132,16 @@ namespace LegionRuntime {
       // Maximum number of failed mappings for a task before error
       unsigned max_failed_mappings;
       std::map<UniqueID,unsigned> failed_mappings;
+      // File for persisting profiling and mapping results across runs,
+      // empty if the mapping cache is disabled
+      // Controlled by -dm:cache
+      std::string cache_file;
+      unsigned long long machine_shape;
       // Utilities for use within the default mapper 
       MappingUtilities::MachineQueryInterface machine_interface;
       MappingUtilities::MappingMemoizer memoizer;
       MappingUtilities::MappingProfiler profiler;
+      MappingUtilities::MappingCache mapping_cache;
     };
 
   };
@@ -18,6 +18,9 @@
 #define __LEGION_FIELD_TREE_H__
 
 #include "legion_types.h"
+#include "legion_allocation.h"
+
+#include <algorithm>
 
 namespace LegionRuntime {
   namespace HighLevel {
@@ -34,9 +37,20 @@ namespace LegionRuntime {
      * It must also be instantiated with an
      * analysis type AT which supports a method
      * analyze on user type UT.
+     *
+     * Each node keeps its users in flat vectors
+     * grouped by field mask so that one independence
+     * test covers every user with the same fields
+     * and the masks themselves are scanned from a
+     * contiguous array. Users that the analyzer
+     * removes are compacted out during the same
+     * pass, and groups left empty are removed once
+     * they make up half of a node's groups.
      */
     template<typename UT>
     class FieldTree {
+    public:
+      static const AllocationType alloc_type = FIELD_TREE_ALLOC;
     public:
       FieldTree(const FieldMask &mask, bool merge_node = false);
       FieldTree(const FieldTree<UT> &rhs);
@@ -58,30 +72,26 @@ namespace LegionRuntime {
       template<typename AT>
       void analyze_single(unsigned index, AT &analyzer);
     private:
-      template<typename AT>
-      inline void analyze_precise(AT &analyzer);
-      template<typename AT, bool CHECK>
-      inline void analyze_imprecise(const FieldMask &mask, AT &analyzer);
       template<typename AT, bool CHECK>
-      inline void analyze_single(const FieldMask &mask, AT &analyzer);
+      inline void analyze_users(const FieldMask &mask, AT &analyzer);
       template<typename AT>
-      inline void analyze_single_precise(unsigned index, AT &analyzer);
+      inline void analyze_single_users(unsigned index, AT &analyzer);
       template<typename AT>
-      inline void analyze_single_imprecise(unsigned index, AT &analyzer);
-      template<typename AT>
-      inline void analyze_single_single(unsigned index, AT &analyzer);
+      inline void analyze_group(unsigned group, AT &analyzer);
+      inline void compact_groups(void);
     private:
       void insert_recurse(const UT &user);
       void insert_single(unsigned index, const UT &user);
     private:
       inline FieldTree<UT>* merge_dominators(
-          const std::set<FieldTree<UT>*> &dominators,
+          const std::vector<FieldTree<UT>*> &dominators,
           const FieldMask &dominator_mask);
       inline void subsume_node(FieldTree<UT> *dominator_node);
     private:
-      inline void add_user(const UT &user, bool precise);
-      inline void add_single_user(unsigned index, const UT &user);
+      inline void add_user(const UT &user);
+      inline void add_group(const FieldMask &mask, typename LegionVector<UT>::aligned &users);
       inline void add_child(FieldTree<UT> *child_node);
+      inline void remove_child(FieldTree<UT> *child_node);
       void check_state(void);
     public:
       // Not constant so we can mutate it when packing/unpacking
@@ -91,12 +101,14 @@ namespace LegionRuntime {
       // If a single node then this is the index of the set field
       const unsigned single_index;
     private:
-      std::set<FieldTree<UT>*> children;
-      std::set<FieldTree<UT>*> single_children;
+      std::vector<FieldTree<UT>*> children;
+      std::vector<FieldTree<UT>*> single_children;
     private:
-      std::list<UT> precise_users;
-      std::list<UT> imprecise_users;
-      std::list<std::pair<UT,unsigned> > single_users;
+      // Users grouped by field mask, group_users[i] all have the
+      // mask group_masks[i]
+      typename LegionVector<FieldMask>::aligned group_masks;
+      std::vector<typename LegionVector<UT>::aligned> group_users;
+      unsigned empty_groups;
     };
 
     // Since the field tree class is templated we have to put the 
@@ -108,7 +120,8 @@ namespace LegionRuntime {
     FieldTree<UT>::FieldTree(const FieldMask &mask, bool merge/* = false*/)
       : local_mask(mask), merge_node(merge),
         single_node(FieldMask::pop_count(mask) == 1), 
-        single_index(single_node ? mask.find_first_set() : 0)
+        single_index(single_node ? mask.find_first_set() : 0),
+        empty_groups(0)
     //--------------------------------------------------------------------------
     {
     }
@@ -117,7 +130,7 @@ namespace LegionRuntime {
     template<typename UT>
     FieldTree<UT>::FieldTree(const FieldTree<UT> &rhs)
       : local_mask(FieldMask()), merge_node(false), single_node(false), 
-        single_index(0)
+        single_index(0), empty_groups(0)
     //--------------------------------------------------------------------------
     {
       // should never be called
@@ -132,16 +145,16 @@ namespace LegionRuntime {
       // If we're a single node, then there is nothing to do
       if (single_node)
         return;
-      for (typename std::set<FieldTree<UT>*>::const_iterator it = 
+      for (typename std::vector<FieldTree<UT>*>::const_iterator it = 
             children.begin(); it != children.end(); it++)
       {
-        delete (*it);
+        legion_delete(*it);
       }
       children.clear();
-      for (typename std::set<FieldTree<UT>*>::const_iterator it =
+      for (typename std::vector<FieldTree<UT>*>::const_iterator it =
             single_children.begin(); it != single_children.end(); it++)
       {
-        delete (*it);
+        legion_delete(*it);
       }
       single_children.clear();
     }
@@ -175,21 +188,12 @@ namespace LegionRuntime {
     void FieldTree<UT>::insert(const UT &user, bool recurse/*=true*/)
     //--------------------------------------------------------------------------
     {
-      if (FieldMask::pop_count(user.field_mask) == 1)
-      {
-        unsigned index = user.field_mask.find_first_set();
-        if (recurse)
-          insert_single(index, user);
-        else
-          add_single_user(index, user);
-      }
+      if (!recurse)
+        add_user(user);
+      else if (FieldMask::pop_count(user.field_mask) == 1)
+        insert_single(user.field_mask.find_first_set(), user);
       else
-      {
-        if (recurse)
-          insert_recurse(user);
-        else
-          add_user(user, (local_mask == user.field_mask));
-      }
+        insert_recurse(user);
     }
 
     //--------------------------------------------------------------------------
@@ -200,34 +204,28 @@ namespace LegionRuntime {
       {
         RezCheck z(rez);
         // Pack the users of this node
-        size_t num_users = precise_users.size() + imprecise_users.size() + 
-                            single_users.size();
+        size_t num_users = 0;
+        for (unsigned idx = 0; idx < group_users.size(); idx++)
+          num_users += group_users[idx].size();
         rez.serialize(num_users);
-        for (typename std::list<UT>::const_iterator it = precise_users.begin();
-              it != precise_users.end(); it++)
-        {
-          rez.serialize(*it);
-        }
-        for (typename std::list<UT>::const_iterator it = 
-              imprecise_users.begin(); it != imprecise_users.end(); it++)
-        {
-          rez.serialize(*it);
-        }
-        for (typename std::list<std::pair<UT,unsigned> >::const_iterator it =
-              single_users.begin(); it != single_users.end(); it++)
+        for (unsigned idx = 0; idx < group_users.size(); idx++)
         {
-          rez.serialize(it->first);
+          for (typename LegionVector<UT>::aligned::const_iterator it = 
+                group_users[idx].begin(); it != group_users[idx].end(); it++)
+          {
+            rez.serialize(*it);
+          }
         }
         // Then pack what is necessary to make all of the child nodes
         size_t num_children = children.size() + single_children.size(); 
         rez.serialize(num_children);
-        for (typename std::set<FieldTree<UT>*>::const_iterator it = 
+        for (typename std::vector<FieldTree<UT>*>::const_iterator it = 
               children.begin(); it != children.end(); it++)
         {
           rez.serialize((*it)->local_mask);
           rez.serialize((*it)->merge_node);
         }
-        for (typename std::set<FieldTree<UT>*>::const_iterator it = 
+        for (typename std::vector<FieldTree<UT>*>::const_iterator it = 
               single_children.begin(); it != single_children.end(); it++)
         {
           rez.serialize((*it)->local_mask);
@@ -235,12 +233,12 @@ namespace LegionRuntime {
         }
       }
       // Finally pack each of the children
-      for (typename std::set<FieldTree<UT>*>::const_iterator it = 
+      for (typename std::vector<FieldTree<UT>*>::const_iterator it = 
             children.begin(); it != children.end(); it++)
       {
         (*it)->pack_field_tree(rez);
       }
-      for (typename std::set<FieldTree<UT>*>::const_iterator it = 
+      for (typename std::vector<FieldTree<UT>*>::const_iterator it = 
             single_children.begin(); it != single_children.end(); it++)
       {
         (*it)->pack_field_tree(rez);
@@ -263,12 +261,7 @@ namespace LegionRuntime {
         {
           UT user;
           derez.deserialize(user);
-          if (FieldMask::pop_count(user.field_mask) == 1)
-            add_single_user(user.field_mask.find_first_set(), user);
-          else if (user.field_mask == local_mask)
-            add_user(user, true/*precise*/);
-          else
-            add_user(user, false/*precise*/);
+          add_user(user);
         }
         // Unpack and make child nodes
         size_t num_children;
@@ -280,7 +273,7 @@ namespace LegionRuntime {
           derez.deserialize(child_mask);
           bool merge;
           derez.deserialize(merge);
-          FieldTree<UT> *child = new FieldTree<UT>(child_mask, merge);
+          FieldTree<UT> *child = legion_new<FieldTree<UT> >(child_mask, merge);
           unpacked_children[idx] = child;
           add_child(child);
         }
@@ -299,18 +292,13 @@ namespace LegionRuntime {
     {
       analyzer.begin_node(this);
       const bool local_dominated = !(local_mask - mask);
-      analyze_precise<AT>(analyzer);
       if (local_dominated)
       {
         // Local dominated so no need to do any checks
-        analyze_imprecise<AT,false/*checks*/>(mask, analyzer);
-        analyze_single<AT,false/*checks*/>(mask, analyzer);
+        analyze_users<AT,false/*checks*/>(mask, analyzer);
       }
       else
-      {
-        analyze_imprecise<AT,true/*checks*/>(mask, analyzer);
-        analyze_single<AT,true/*checks*/>(mask, analyzer);
-      }
+        analyze_users<AT,true/*checks*/>(mask, analyzer);
       // If we're a single node, then we know that we don't have any children
       if (single_node)
       {
@@ -321,12 +309,12 @@ namespace LegionRuntime {
       {
         // Once we are local dominated, then everyone below us is
         // also local dominated
-        for (typename std::set<FieldTree<UT>*>::const_iterator it =
+        for (typename std::vector<FieldTree<UT>*>::const_iterator it =
               children.begin(); it != children.end(); it++)
         {
           (*it)->analyze_no_checks(analyzer);
         }
-        for (typename std::set<FieldTree<UT>*>::const_iterator it =
+        for (typename std::vector<FieldTree<UT>*>::const_iterator it =
               single_children.begin(); it != single_children.end(); it++)
         {
           (*it)->analyze_no_checks(analyzer);
@@ -335,7 +323,7 @@ namespace LegionRuntime {
       else
       {
         // Now figure out which of our children we need to traverse
-        for (typename std::set<FieldTree<UT>*>::const_iterator it = 
+        for (typename std::vector<FieldTree<UT>*>::const_iterator it = 
               children.begin(); it != children.end(); it++)
         {
           // Skip any children with disjoint fields
@@ -343,7 +331,7 @@ namespace LegionRuntime {
             continue;
           (*it)->analyze_recurse(mask, analyzer);
         }
-        for (typename std::set<FieldTree<UT>*>::const_iterator it =
+        for (typename std::vector<FieldTree<UT>*>::const_iterator it =
               single_children.begin(); it != single_children.end(); it++)
         {
           if (!mask.is_set((*it)->single_index))
@@ -362,34 +350,18 @@ namespace LegionRuntime {
       analyzer.begin_node(this);
       // We already know we need to compare against everyone so
       // there is no need to do any checks
-      analyze_precise<AT>(analyzer);
-      for (typename std::list<UT>::iterator it = imprecise_users.begin();
-            it != imprecise_users.end(); /*nothing*/)
-      {
-        if (analyzer.analyze(*it))
-          it++;
-        else
-          it = imprecise_users.erase(it);
-      }
-      for (typename std::list<std::pair<UT,unsigned> >::iterator it = 
-            single_users.begin(); it != single_users.end(); /*nothing*/)
-      {
-        if (analyzer.analyze(it->first))
-          it++;
-        else
-          it = single_users.erase(it);
-      }
+      analyze_users<AT,false/*checks*/>(local_mask, analyzer);
       if (single_node)
       {
         analyzer.end_node(this);
         return;
       }
-      for (typename std::set<FieldTree<UT>*>::const_iterator it =
+      for (typename std::vector<FieldTree<UT>*>::const_iterator it =
             children.begin(); it != children.end(); it++)
       {
         (*it)->analyze_no_checks(analyzer);
       }
-      for (typename std::set<FieldTree<UT>*>::const_iterator it =
+      for (typename std::vector<FieldTree<UT>*>::const_iterator it =
             single_children.begin(); it != single_children.end(); it++)
       {
         (*it)->analyze_no_checks(analyzer);
@@ -403,13 +375,7 @@ namespace LegionRuntime {
     //--------------------------------------------------------------------------
     {
       analyzer.begin_node(this);
-      // only need to analyze these if we are not a single node
-      if (!single_node)
-      {
-        analyze_single_precise<AT>(index, analyzer);
-        analyze_single_imprecise<AT>(index, analyzer);
-      }
-      analyze_single_single<AT>(index, analyzer);
+      analyze_single_users<AT>(index, analyzer);
       // If we're a single node, then we know that we don't have any children
       if (single_node)
       {
@@ -417,7 +383,7 @@ namespace LegionRuntime {
         return;
       }
       // Now figure out which of our children we need to traverse
-      for (typename std::set<FieldTree<UT>*>::const_iterator it = 
+      for (typename std::vector<FieldTree<UT>*>::const_iterator it = 
             children.begin(); it != children.end(); it++)
       {
         // Skip any children with disjoint fields
@@ -425,7 +391,7 @@ namespace LegionRuntime {
           continue;
         (*it)->analyze_single(index, analyzer);
       }
-      for (typename std::set<FieldTree<UT>*>::const_iterator it =
+      for (typename std::vector<FieldTree<UT>*>::const_iterator it =
             single_children.begin(); it != single_children.end(); it++)
       {
         if ((*it)->single_index != index)
@@ -435,152 +401,90 @@ namespace LegionRuntime {
       analyzer.end_node(this);
     }
 
-    //--------------------------------------------------------------------------
-    template<typename UT> template<typename AT>
-    inline void FieldTree<UT>::analyze_precise(AT &analyzer)
-    //--------------------------------------------------------------------------
-    {
-      for (typename std::list<UT>::iterator it = precise_users.begin();
-            it != precise_users.end(); /*nothing*/)
-      {
-        if (analyzer.analyze(*it))
-          it++;
-        else
-          it = precise_users.erase(it);
-      }
-    }
-
-    //--------------------------------------------------------------------------
-    template<typename UT> template<typename AT, bool CHECK>
-    inline void FieldTree<UT>::analyze_imprecise(const FieldMask &mask, 
-                                                 AT &analyzer)
-    //--------------------------------------------------------------------------
-    {
-      if (CHECK)
-      {
-        for (typename std::list<UT>::iterator it = imprecise_users.begin();
-              it != imprecise_users.end(); /*nothing*/)
-        {
-          if (mask * it->field_mask)
-          {
-            it++;
-            continue;
-          }
-          if (analyzer.analyze(*it))
-            it++;
-          else
-            it = imprecise_users.erase(it);
-        }
-      }
-      else
-      {
-        for (typename std::list<UT>::iterator it = imprecise_users.begin();
-              it != imprecise_users.end(); /*nothing*/)
-        {
-          if (analyzer.analyze(*it))
-            it++;
-          else
-            it = imprecise_users.erase(it);
-        }
-      }
-    }
-
     //--------------------------------------------------------------------------
     template<typename UT> template<typename AT, bool CHECK>
-    inline void FieldTree<UT>::analyze_single(const FieldMask &mask, 
-                                              AT &analyzer)
+    inline void FieldTree<UT>::analyze_users(const FieldMask &mask, 
+                                             AT &analyzer)
     //--------------------------------------------------------------------------
     {
-      if (CHECK)
+      const unsigned num_groups = group_masks.size();
+      for (unsigned idx = 0; idx < num_groups; idx++)
       {
-        for (typename std::list<std::pair<UT,unsigned> >::iterator it = 
-              single_users.begin(); it != single_users.end(); /*nothing*/)
-        {
-          if (!mask.is_set(it->second))
-          {
-            it++;
-            continue;
-          }
-          if (analyzer.analyze(it->first))
-            it++;
-          else
-            it = single_users.erase(it);
-        }
-      }
-      else
-      {
-        for (typename std::list<std::pair<UT,unsigned> >::iterator it = 
-              single_users.begin(); it != single_users.end(); /*nothing*/)
-        {
-          if (analyzer.analyze(it->first))
-            it++;
-          else
-            it = single_users.erase(it);
-        }
+        // One test for the whole group of users with these fields
+        if (CHECK && (group_masks[idx] * mask))
+          continue;
+        analyze_group<AT>(idx, analyzer);
       }
+      compact_groups();
     }
 
     //--------------------------------------------------------------------------
     template<typename UT> template<typename AT>
-    inline void FieldTree<UT>::analyze_single_precise(unsigned index, 
-                                                      AT &analyzer)
+    inline void FieldTree<UT>::analyze_single_users(unsigned index,
+                                                    AT &analyzer)
     //--------------------------------------------------------------------------
     {
-      for (typename std::list<UT>::iterator it = precise_users.begin();
-            it != precise_users.end(); /*nothing*/)
+      const unsigned num_groups = group_masks.size();
+      for (unsigned idx = 0; idx < num_groups; idx++)
       {
-        if (!it->field_mask.is_set(index))
-        {
-          it++;
+        if (!group_masks[idx].is_set(index))
           continue;
-        }
-        if (analyzer.analyze(*it))
-          it++;
-        else
-          it = precise_users.erase(it);
+        analyze_group<AT>(idx, analyzer);
       }
+      compact_groups();
     }
 
     //--------------------------------------------------------------------------
     template<typename UT> template<typename AT>
-    inline void FieldTree<UT>::analyze_single_imprecise(unsigned index,
-                                                        AT &analyzer)
+    inline void FieldTree<UT>::analyze_group(unsigned group, AT &analyzer)
     //--------------------------------------------------------------------------
     {
-      for (typename std::list<UT>::iterator it = imprecise_users.begin();
-            it != imprecise_users.end(); /*nothing*/)
+      typename LegionVector<UT>::aligned &users = group_users[group];
+      if (users.empty())
+        return;
+      // Slide the users the analyzer keeps down over the ones it
+      // drops so the group stays dense and in order
+      unsigned live = 0;
+      for (unsigned idx = 0; idx < users.size(); idx++)
       {
-        if (!it->field_mask.is_set(index))
-        {
-          it++;
+        if (!analyzer.analyze(users[idx]))
           continue;
-        }
-        if (analyzer.analyze(*it))
-          it++;
-        else
-          it = imprecise_users.erase(it);
+        if (live != idx)
+          users[live] = users[idx];
+        live++;
+      }
+      if (live < users.size())
+      {
+        users.erase(users.begin() + live, users.end());
+        if (live == 0)
+          empty_groups++;
       }
     }
 
     //--------------------------------------------------------------------------
-    template<typename UT> template<typename AT>
-    inline void FieldTree<UT>::analyze_single_single(unsigned index,
-                                                     AT &analyzer)
+    template<typename UT>
+    inline void FieldTree<UT>::compact_groups(void)
     //--------------------------------------------------------------------------
     {
-      for (typename std::list<std::pair<UT,unsigned> >::iterator it = 
-            single_users.begin(); it != single_users.end(); /*nothing*/)
+      // Empty groups are cheap to skip and likely to be refilled
+      // so only remove them once they are half of the groups
+      if ((2 * empty_groups) < group_masks.size())
+        return;
+      unsigned next = 0;
+      for (unsigned idx = 0; idx < group_masks.size(); idx++)
       {
-        if (index != it->second)
-        {
-          it++;
+        if (group_users[idx].empty())
           continue;
+        if (next != idx)
+        {
+          group_masks[next] = group_masks[idx];
+          group_users[next].swap(group_users[idx]);
         }
-        if (analyzer.analyze(it->first))
-          it++;
-        else
-          it = single_users.erase(it);
+        next++;
       }
+      group_masks.resize(next);
+      group_users.resize(next);
+      empty_groups = 0;
     }
 
     //--------------------------------------------------------------------------
@@ -592,7 +496,7 @@ namespace LegionRuntime {
       {
         // Base case: if we've arrived at a node with our field mask
         // then we are done
-        add_user(user, true/*precise*/);
+        add_user(user);
       }
       else
       {
@@ -601,27 +505,27 @@ namespace LegionRuntime {
         //      children that we may traverse
         //  - Dominators which places a lower bound on the 
         //      children that we may traverse
-        typename std::map<FieldTree<UT>*,bool/*single*/> overlaps;
-        typename std::set<FieldTree<UT>*> dominators;
-        for (typename std::set<FieldTree*>::const_iterator it = 
+        typename std::vector<FieldTree<UT>*> overlaps;
+        typename std::vector<FieldTree<UT>*> dominators;
+        for (typename std::vector<FieldTree<UT>*>::const_iterator it = 
               children.begin(); it != children.end(); it++)
         {
           if ((*it)->local_mask * user.field_mask)
             continue;
-          overlaps[*it] = false;
+          overlaps.push_back(*it);
           if (!(user.field_mask - (*it)->local_mask))
-            dominators.insert(*it);
+            dominators.push_back(*it);
         }
-        for (typename std::set<FieldTree<UT>*>::const_iterator it =
+        for (typename std::vector<FieldTree<UT>*>::const_iterator it =
               single_children.begin(); it != single_children.end(); it++)
         {
           if (!user.field_mask.is_set((*it)->single_index))
             continue;
-          overlaps[*it] = true;
+          overlaps.push_back(*it);
           FieldMask copy = user.field_mask;
           copy.unset_bit((*it)->single_index);
           if (!copy)
-            dominators.insert(*it);
+            dominators.push_back(*it);
         }
         // There are three scenarios here:
         //  - No overlaps: make a new node and add it to the children
@@ -630,8 +534,8 @@ namespace LegionRuntime {
         //  - Many overlaps: complicated, see more comments below
         if (overlaps.empty())
         {
-          FieldTree<UT> *child_node = new FieldTree<UT>(user.field_mask);
-          child_node->add_user(user, true/*precise*/);
+          FieldTree<UT> *child_node = legion_new<FieldTree<UT> >(user.field_mask);
+          child_node->add_user(user);
           // Add the child to this node
           add_child(child_node);
         }
@@ -645,32 +549,28 @@ namespace LegionRuntime {
           //    child node
           // - Neither dominates: make a new node for the child
           //    and add it to this node
-          typename std::map<FieldTree<UT>*,bool>::const_iterator next = 
-            overlaps.begin();
+          FieldTree<UT> *next = overlaps.front();
           if (!dominators.empty())
           {
             // Old node dominates the new user, continue the traversal
-            next->first->insert(user);
+            next->insert(user);
           }
-          else if (!(next->first->local_mask - user.field_mask))
+          else if (!(next->local_mask - user.field_mask))
           {
             // New user dominates the old user
-            FieldTree<UT> *child_node = new FieldTree<UT>(user.field_mask);
-            child_node->add_user(user, true/*precise*/);
-            child_node->add_child(next->first);
+            FieldTree<UT> *child_node = legion_new<FieldTree<UT> >(user.field_mask);
+            child_node->add_user(user);
+            child_node->add_child(next);
             // Remove the old child and add it to the new child
-            if (next->second)
-              single_children.erase(next->first);
-            else
-              children.erase(next->first);
+            remove_child(next);
             // Now add the new child to this node
             add_child(child_node);
           }
           else
           {
             // Neither one dominates, so make a new node and add it
-            FieldTree<UT> *child_node = new FieldTree<UT>(user.field_mask);
-            child_node->add_user(user, true/*precise*/);
+            FieldTree<UT> *child_node = legion_new<FieldTree<UT> >(user.field_mask);
+            child_node->add_user(user);
             add_child(child_node);
           }
         }
@@ -688,26 +588,23 @@ namespace LegionRuntime {
           //    likely be imprecise.
           if (dominators.empty())
           {
-            FieldTree<UT> *child_node = new FieldTree<UT>(user.field_mask);
-            child_node->add_user(user, true/*precise*/);
+            FieldTree<UT> *child_node = legion_new<FieldTree<UT> >(user.field_mask);
+            child_node->add_user(user);
             // Pull in any other children that the new node dominates.
-            for (typename std::map<FieldTree<UT>*,bool>::const_iterator
+            for (typename std::vector<FieldTree<UT>*>::const_iterator
                   it = overlaps.begin(); it != overlaps.end(); it++)
             {
               // Skip anything we don't dominate
-              if (!!(it->first->local_mask - user.field_mask))
+              if (!!((*it)->local_mask - user.field_mask))
                 continue;
-              if (it->second)
-                single_children.erase(it->first);
-              else
-                children.erase(it->first);
-              child_node->add_child(it->first);
+              remove_child(*it);
+              child_node->add_child(*it);
             }
             add_child(child_node);
           }
           else if (dominators.size() == 1)
           {
-            FieldTree<UT> *dominator = *(dominators.begin());
+            FieldTree<UT> *dominator = dominators.front();
             dominator->insert(user);
           }
           else
@@ -716,7 +613,7 @@ namespace LegionRuntime {
             // already are a merge node.
             if (merge_node)
             {
-              add_user(user, false/*precise*/);
+              add_user(user);
             }
             else
             {
@@ -724,7 +621,7 @@ namespace LegionRuntime {
               // place the user in it.  Then move all the dominators
               // inside of that node.
               FieldMask dominator_mask;
-              for (typename std::set<FieldTree<UT>*>::const_iterator it =
+              for (typename std::vector<FieldTree<UT>*>::const_iterator it =
                     dominators.begin(); it != dominators.end(); it++)
               {
                 dominator_mask |= (*it)->local_mask;
@@ -734,14 +631,13 @@ namespace LegionRuntime {
               // know we are not equal to the local mask.
               if (dominator_mask == local_mask)
               {
-                add_user(user, false/*precise*/);
+                add_user(user);
               }
               else
               {
                 FieldTree<UT> *dominator_node = merge_dominators(dominators,
                                                             dominator_mask);
-                dominator_node->add_user(user, 
-                    (dominator_mask==user.field_mask));
+                dominator_node->add_user(user);
                 // Finally add the dominator node to this node
                 add_child(dominator_node);
               }
@@ -760,12 +656,12 @@ namespace LegionRuntime {
       if (single_node)
       {
         // Only here if the indexes match
-        add_single_user(index, user);
+        add_user(user);
         return;
       }
       // Now check the single users to see if we find the node
       // we're looking for.  If we do then we're done.
-      for (typename std::set<FieldTree<UT>*>::const_iterator it = 
+      for (typename std::vector<FieldTree<UT>*>::const_iterator it = 
             single_children.begin(); it != single_children.end(); it++)
       {
         if ((*it)->single_index == index)
@@ -776,26 +672,26 @@ namespace LegionRuntime {
       }
       // Now find overlaps/dominators.  Since we are a single field
       // mask we know that any overlap by definition dominates us.
-      typename std::set<FieldTree<UT>*> dominators;
-      for (typename std::set<FieldTree<UT>*>::const_iterator it = 
+      typename std::vector<FieldTree<UT>*> dominators;
+      for (typename std::vector<FieldTree<UT>*>::const_iterator it = 
             children.begin(); it != children.end(); it++)
       {
         if ((*it)->local_mask.is_set(index))
-          dominators.insert(*it);
+          dominators.push_back(*it);
       }
       // See how many dominators we had
       if (dominators.empty())
       {
         // Make a new single node and add it
-        FieldTree<UT> *child = new FieldTree<UT>(user.field_mask);
-        child->add_single_user(index, user);
+        FieldTree<UT> *child = legion_new<FieldTree<UT> >(user.field_mask);
+        child->add_user(user);
         // Add the child to this node
         add_child(child);
       }
       else if (dominators.size() == 1)
       {
         // Continue the traversal
-        FieldTree<UT> *dominator = *(dominators.begin());
+        FieldTree<UT> *dominator = dominators.front();
         dominator->insert_single(index, user);
       }
       else
@@ -804,26 +700,26 @@ namespace LegionRuntime {
         // we already are a merge node.
         if (merge_node)
         {
-          add_single_user(index, user);
+          add_user(user);
         }
         else
         {
           // Multiple dominators
           FieldMask dominator_mask;
-          for (typename std::set<FieldTree<UT>*>::const_iterator it =
+          for (typename std::vector<FieldTree<UT>*>::const_iterator it =
                 dominators.begin(); it != dominators.end(); it++)
           {
             dominator_mask |= (*it)->local_mask;
           }
           if (dominator_mask == local_mask)
           {
-            add_single_user(index, user);
+            add_user(user);
           }
           else
           {
             FieldTree<UT> *dominator = merge_dominators(dominators, 
                                                     dominator_mask);
-            dominator->add_single_user(index, user);
+            dominator->add_user(user);
             add_child(dominator);
           }
         }
@@ -833,11 +729,13 @@ namespace LegionRuntime {
     //--------------------------------------------------------------------------
     template<typename UT>
     inline FieldTree<UT>* FieldTree<UT>::merge_dominators(
-        const std::set<FieldTree<UT>*> &dominators, const FieldMask &dom_mask)
+        const std::vector<FieldTree<UT>*> &dominators, 
+        const FieldMask &dom_mask)
     //--------------------------------------------------------------------------
     {
-      FieldTree<UT> *dominator_node = new FieldTree<UT>(dom_mask, true/*dom*/);
-      for (typename std::set<FieldTree<UT>*>::const_iterator it = 
+      FieldTree<UT> *dominator_node = 
+        legion_new<FieldTree<UT> >(dom_mask, true/*dom*/);
+      for (typename std::vector<FieldTree<UT>*>::const_iterator it = 
             dominators.begin(); it != dominators.end(); it++)
       {
         // We know that all dominators have more then one field
@@ -847,7 +745,7 @@ namespace LegionRuntime {
         // only one field would be dominated by all the other 
         // dominators which violates the invariant that no child
         // dominates any others which is always maintained.
-        children.erase(*it);
+        remove_child(*it);
         // If the dominator is precise then add it, otherwise flatten
         // it into this node.
         if (!(*it)->merge_node)
@@ -856,7 +754,7 @@ namespace LegionRuntime {
         {
           (*it)->subsume_node(dominator_node);
           // Now delete the node
-          delete (*it);
+          legion_delete(*it);
         }
       }
 #ifdef DEBUG_HIGH_LEVEL
@@ -870,34 +768,25 @@ namespace LegionRuntime {
     inline void FieldTree<UT>::subsume_node(FieldTree<UT> *dominator_node)
     //--------------------------------------------------------------------------
     {
-      // First copy up the users
-      for (typename std::list<UT>::const_iterator it = precise_users.begin();
-            it != precise_users.end(); it++)
-      {
-        dominator_node->add_user(*it, false/*precise*/);
-      }
-      precise_users.clear();
-      for (typename std::list<UT>::const_iterator it = imprecise_users.begin();
-            it != imprecise_users.end(); it++)
+      // First move up the user groups
+      for (unsigned idx = 0; idx < group_masks.size(); idx++)
       {
-        dominator_node->add_user(*it, false/*precise*/);
-      }
-      imprecise_users.clear();
-      for (typename std::list<std::pair<UT,unsigned> >::const_iterator it = 
-            single_users.begin(); it != single_users.end(); it++)
-      {
-        dominator_node->add_single_user(it->second, it->first);
+        if (group_users[idx].empty())
+          continue;
+        dominator_node->add_group(group_masks[idx], group_users[idx]);
       }
-      single_users.clear();
+      group_masks.clear();
+      group_users.clear();
+      empty_groups = 0;
       // Copy up the single children
-      for (typename std::set<FieldTree<UT>*>::const_iterator it =
+      for (typename std::vector<FieldTree<UT>*>::const_iterator it =
             single_children.begin(); it != single_children.end(); it++)
       {
         dominator_node->add_child(*it);
       }
       // Clear them so we don't delete them when we delete the node
       single_children.clear();
-      for (typename std::set<FieldTree<UT>*>::const_iterator it = 
+      for (typename std::vector<FieldTree<UT>*>::const_iterator it = 
             children.begin(); it != children.end(); it++)
       {
         dominator_node->add_child(*it);
@@ -908,21 +797,43 @@ namespace LegionRuntime {
 
     //--------------------------------------------------------------------------
     template<typename UT>
-    inline void FieldTree<UT>::add_user(const UT &user, bool precise)
+    inline void FieldTree<UT>::add_user(const UT &user)
     //--------------------------------------------------------------------------
     {
-      if (precise)
-        precise_users.push_back(user);
-      else
-        imprecise_users.push_back(user);
+      for (unsigned idx = 0; idx < group_masks.size(); idx++)
+      {
+        if (group_masks[idx] != user.field_mask)
+          continue;
+        if (group_users[idx].empty())
+          empty_groups--;
+        group_users[idx].push_back(user);
+        return;
+      }
+      group_masks.push_back(user.field_mask);
+      group_users.resize(group_users.size() + 1);
+      group_users.back().push_back(user);
     }
 
     //--------------------------------------------------------------------------
     template<typename UT>
-    inline void FieldTree<UT>::add_single_user(unsigned index, const UT &user)
+    inline void FieldTree<UT>::add_group(const FieldMask &mask,
+                                         typename LegionVector<UT>::aligned &users)
     //--------------------------------------------------------------------------
     {
-      single_users.push_back(std::pair<UT,unsigned>(user,index));
+      for (unsigned idx = 0; idx < group_masks.size(); idx++)
+      {
+        if (group_masks[idx] != mask)
+          continue;
+        if (group_users[idx].empty())
+          empty_groups--;
+        group_users[idx].insert(group_users[idx].end(), 
+                                users.begin(), users.end());
+        users.clear();
+        return;
+      }
+      group_masks.push_back(mask);
+      group_users.resize(group_users.size() + 1);
+      group_users.back().swap(users);
     }
 
     //--------------------------------------------------------------------------
@@ -937,7 +848,7 @@ namespace LegionRuntime {
         assert(child->local_mask != local_mask);
         assert(!(child->local_mask - local_mask));
 #endif
-        single_children.insert(child);
+        single_children.push_back(child);
       }
       else
       {
@@ -946,40 +857,64 @@ namespace LegionRuntime {
         assert(child->local_mask != local_mask);
         assert(!(child->local_mask - local_mask));
 #endif
-        children.insert(child);
+        children.push_back(child);
       }
     }
 
+    //--------------------------------------------------------------------------
+    template<typename UT>
+    inline void FieldTree<UT>::remove_child(FieldTree<UT> *child)
+    //--------------------------------------------------------------------------
+    {
+      std::vector<FieldTree<UT>*> &list = 
+        child->single_node ? single_children : children;
+      typename std::vector<FieldTree<UT>*>::iterator finder = 
+        std::find(list.begin(), list.end(), child);
+#ifdef DEBUG_HIGH_LEVEL
+      assert(finder != list.end());
+#endif
+      list.erase(finder);
+    }
+
     //--------------------------------------------------------------------------
     template<typename UT>
     void FieldTree<UT>::check_state(void)
     //--------------------------------------------------------------------------
     {
       // Check to make sure that all the children are non-overlapping
-      for (typename std::set<FieldTree<UT>*>::const_iterator it1 = 
+      for (typename std::vector<FieldTree<UT>*>::const_iterator it1 = 
             children.begin(); it1 != children.end(); it1++)
       {
-        for (typename std::set<FieldTree<UT>*>::const_iterator it2 = 
+        for (typename std::vector<FieldTree<UT>*>::const_iterator it2 = 
               children.begin(); it2 != it1; it2++)
         {
           assert(!!((*it1)->local_mask - (*it2)->local_mask));
           assert(!!((*it2)->local_mask - (*it1)->local_mask));
         }
       }
-      for (typename std::set<FieldTree<UT>*>::const_iterator sit = 
+      for (typename std::vector<FieldTree<UT>*>::const_iterator sit = 
             single_children.begin(); sit != single_children.end(); sit++)
       {
-        for (typename std::set<FieldTree<UT>*>::const_iterator cit = 
+        for (typename std::vector<FieldTree<UT>*>::const_iterator cit = 
               children.begin(); cit != children.end(); cit++)
         {
           assert(!((*cit)->local_mask.is_set((*sit)->single_index)));
         }
-        for (typename std::set<FieldTree<UT>*>::const_iterator cit = 
+        for (typename std::vector<FieldTree<UT>*>::const_iterator cit = 
               single_children.begin(); cit != sit; cit++)
         {
           assert((*sit)->single_index != (*cit)->single_index);
         }
       }
+      // Every group holds users with exactly its mask
+      for (unsigned idx = 0; idx < group_masks.size(); idx++)
+      {
+        for (typename LegionVector<UT>::aligned::const_iterator it = 
+              group_users[idx].begin(); it != group_users[idx].end(); it++)
+        {
+          assert(it->field_mask == group_masks[idx]);
+        }
+      }
     }
     
   };
@@ -24,6 +24,13 @@
 namespace LegionRuntime {
   namespace HighLevel {
 
+#ifdef LEGION_GC_STATS
+#define RECORD_REFERENCE_PATH(kind, fast) \
+    __sync_fetch_and_add(&path_counts[kind][(fast) ? 0 : 1], 1)
+#else
+#define RECORD_REFERENCE_PATH(kind, fast)
+#endif
+
     /////////////////////////////////////////////////////////////
     // CollectableState 
     /////////////////////////////////////////////////////////////
@@ -356,6 +363,12 @@ namespace LegionRuntime {
     void DistributedCollectable::add_gc_reference(unsigned cnt /*=1*/)
     //--------------------------------------------------------------------------
     {
+      if (try_fast_add(gc_references, cnt))
+      {
+        RECORD_REFERENCE_PATH(GC_REF_KIND, true/*fast*/);
+        return;
+      }
+      RECORD_REFERENCE_PATH(GC_REF_KIND, false/*fast*/);
       bool need_activate = false;
       bool need_validate = false;
       bool need_invalidate = false;
@@ -376,7 +389,7 @@ namespace LegionRuntime {
         AutoLock gc(gc_lock);
         if (first)
         {
-          gc_references += cnt;
+          __sync_fetch_and_add(&gc_references, cnt);
           first = false;
         }
         done = update_state((gc_references > 0),
@@ -401,6 +414,13 @@ namespace LegionRuntime {
     bool DistributedCollectable::remove_gc_reference(unsigned cnt /*=1*/)
     //--------------------------------------------------------------------------
     {
+      if (try_fast_remove(gc_references, cnt))
+      {
+        RECORD_REFERENCE_PATH(GC_REF_KIND, true/*fast*/);
+        // Still have references so nothing can be deleted
+        return false;
+      }
+      RECORD_REFERENCE_PATH(GC_REF_KIND, false/*fast*/);
       bool need_activate = false;
       bool need_validate = false;
       bool need_invalidate = false;
@@ -424,7 +444,7 @@ namespace LegionRuntime {
 #ifdef DEBUG_HIGH_LEVEL
           assert(gc_references >= cnt);
 #endif
-          gc_references -= cnt;
+          __sync_fetch_and_sub(&gc_references, cnt);
           first = false;
         }
         done = update_state((gc_references > 0),
@@ -443,6 +463,12 @@ namespace LegionRuntime {
     void DistributedCollectable::add_valid_reference(unsigned cnt /*=1*/)
     //--------------------------------------------------------------------------
     {
+      if (try_fast_add(valid_references, cnt))
+      {
+        RECORD_REFERENCE_PATH(VALID_REF_KIND, true/*fast*/);
+        return;
+      }
+      RECORD_REFERENCE_PATH(VALID_REF_KIND, false/*fast*/);
       bool need_activate = false;
       bool need_validate = false;
       bool need_invalidate = false;
@@ -463,7 +489,7 @@ namespace LegionRuntime {
         AutoLock gc(gc_lock);
         if (first)
         {
-          valid_references += cnt;
+          __sync_fetch_and_add(&valid_references, cnt);
           first = false;
         }
         done = update_state((gc_references > 0),
@@ -487,6 +513,13 @@ namespace LegionRuntime {
     bool DistributedCollectable::remove_valid_reference(unsigned cnt /*=1*/)
     //--------------------------------------------------------------------------
     {
+      if (try_fast_remove(valid_references, cnt))
+      {
+        RECORD_REFERENCE_PATH(VALID_REF_KIND, true/*fast*/);
+        // Still have references so nothing can be deleted
+        return false;
+      }
+      RECORD_REFERENCE_PATH(VALID_REF_KIND, false/*fast*/);
       bool need_activate = false;
       bool need_validate = false;
       bool need_invalidate = false;
@@ -510,7 +543,7 @@ namespace LegionRuntime {
 #ifdef DEBUG_HIGH_LEVEL
           assert(valid_references >= cnt);
 #endif
-          valid_references -= cnt;
+          __sync_fetch_and_sub(&valid_references, cnt);
           first = false;
         }
         done = update_state((gc_references > 0),
@@ -529,19 +562,32 @@ namespace LegionRuntime {
     void DistributedCollectable::add_resource_reference(unsigned cnt /*=1*/)
     //--------------------------------------------------------------------------
     {
+      if (try_fast_add(resource_references, cnt))
+      {
+        RECORD_REFERENCE_PATH(RESOURCE_REF_KIND, true/*fast*/);
+        return;
+      }
+      RECORD_REFERENCE_PATH(RESOURCE_REF_KIND, false/*fast*/);
       AutoLock gc(gc_lock);
-      resource_references += cnt;
+      __sync_fetch_and_add(&resource_references, cnt);
     }
 
     //--------------------------------------------------------------------------
     bool DistributedCollectable::remove_resource_reference(unsigned cnt /*=1*/)
     //--------------------------------------------------------------------------
     {
+      if (try_fast_remove(resource_references, cnt))
+      {
+        RECORD_REFERENCE_PATH(RESOURCE_REF_KIND, true/*fast*/);
+        // Still have references so nothing can be deleted
+        return false;
+      }
+      RECORD_REFERENCE_PATH(RESOURCE_REF_KIND, false/*fast*/);
       AutoLock gc(gc_lock);
 #ifdef DEBUG_HIGH_LEVEL
       assert(resource_references >= cnt);
 #endif
-      resource_references -= cnt;
+      __sync_fetch_and_sub(&resource_references, cnt);
       return can_delete((gc_references > 0),
                         (owner && !remote_references.empty()),
                         (valid_references > 0),
@@ -556,6 +602,9 @@ namespace LegionRuntime {
 #ifdef DEBUG_HIGH_LEVEL
       assert(owner);
 #endif
+      // Remote references are tracked per address space
+      // so they always have to take the lock
+      RECORD_REFERENCE_PATH(REMOTE_REF_KIND, false/*fast*/);
       bool need_activate = false;
       bool need_validate = false;
       bool need_invalidate = false;
@@ -607,6 +656,9 @@ namespace LegionRuntime {
 #ifdef DEBUG_HIGH_LEVEL
       assert(owner);
 #endif
+      // Remote references are tracked per address space
+      // so they always have to take the lock
+      RECORD_REFERENCE_PATH(REMOTE_REF_KIND, false/*fast*/);
       bool need_activate = false;
       bool need_validate = false;
       bool need_invalidate = false;
@@ -773,10 +825,44 @@ namespace LegionRuntime {
         delete target;
     }
 
+#ifdef LEGION_GC_STATS
+    /*static*/ unsigned long long 
+      DistributedCollectable::path_counts[LAST_REF_KIND][2];
+
+    //--------------------------------------------------------------------------
+    /*static*/ void DistributedCollectable::report_reference_statistics(void)
+    //--------------------------------------------------------------------------
+    {
+      const char *const kind_names[LAST_REF_KIND] = {
+        "GC", "Valid", "Remote", "Resource" };
+      for (unsigned idx = 0; idx < LAST_REF_KIND; idx++)
+        log_garbage.print("Distributed Collectable %s References: "
+                          "fast=%llu locked=%llu", kind_names[idx],
+                          path_counts[idx][0], path_counts[idx][1]);
+    }
+#endif
+
     /////////////////////////////////////////////////////////////
     // HierarchicalCollectable 
     /////////////////////////////////////////////////////////////
 
+#ifdef LEGION_GC_STATS
+    /*static*/ unsigned long long 
+      HierarchicalCollectable::path_counts[LAST_REF_KIND][2];
+
+    //--------------------------------------------------------------------------
+    /*static*/ void HierarchicalCollectable::report_reference_statistics(void)
+    //--------------------------------------------------------------------------
+    {
+      const char *const kind_names[LAST_REF_KIND] = {
+        "GC", "Valid", "Remote", "Resource" };
+      for (unsigned idx = 0; idx < LAST_REF_KIND; idx++)
+        log_garbage.print("Hierarchical Collectable %s References: "
+                          "fast=%llu locked=%llu", kind_names[idx],
+                          path_counts[idx][0], path_counts[idx][1]);
+    }
+#endif
+
     //--------------------------------------------------------------------------
     HierarchicalCollectable::HierarchicalCollectable(Runtime *rt, 
                                                      DistributedID d,
@@ -838,6 +924,12 @@ namespace LegionRuntime {
     void HierarchicalCollectable::add_gc_reference(unsigned cnt /*=1*/)
     //--------------------------------------------------------------------------
     {
+      if (try_fast_add(gc_references, cnt))
+      {
+        RECORD_REFERENCE_PATH(GC_REF_KIND, true/*fast*/);
+        return;
+      }
+      RECORD_REFERENCE_PATH(GC_REF_KIND, false/*fast*/);
       bool need_activate = false;
       bool need_validate = false;
       bool need_invalidate = false;
@@ -858,7 +950,7 @@ namespace LegionRuntime {
         AutoLock gc(gc_lock);
         if (first)
         {
-          gc_references += cnt;
+          __sync_fetch_and_add(&gc_references, cnt);
           first = false;
         }
         done = update_state((gc_references > 0),
@@ -883,6 +975,13 @@ namespace LegionRuntime {
     bool HierarchicalCollectable::remove_gc_reference(unsigned cnt /*=1*/)
     //--------------------------------------------------------------------------
     {
+      if (try_fast_remove(gc_references, cnt))
+      {
+        RECORD_REFERENCE_PATH(GC_REF_KIND, true/*fast*/);
+        // Still have references so nothing can be deleted
+        return false;
+      }
+      RECORD_REFERENCE_PATH(GC_REF_KIND, false/*fast*/);
       bool need_activate = false;
       bool need_validate = false;
       bool need_invalidate = false;
@@ -906,7 +1005,7 @@ namespace LegionRuntime {
 #ifdef DEBUG_HIGH_LEVEL
           assert(gc_references >= cnt);
 #endif
-          gc_references -= cnt;
+          __sync_fetch_and_sub(&gc_references, cnt);
           first = false;
         }
         done = update_state((gc_references > 0),
@@ -925,6 +1024,12 @@ namespace LegionRuntime {
     void HierarchicalCollectable::add_valid_reference(unsigned cnt /*=1*/)
     //--------------------------------------------------------------------------
     {
+      if (try_fast_add(valid_references, cnt))
+      {
+        RECORD_REFERENCE_PATH(VALID_REF_KIND, true/*fast*/);
+        return;
+      }
+      RECORD_REFERENCE_PATH(VALID_REF_KIND, false/*fast*/);
       bool need_activate = false;
       bool need_validate = false;
       bool need_invalidate = false;
@@ -945,7 +1050,7 @@ namespace LegionRuntime {
         AutoLock gc(gc_lock);
         if (first)
         {
-          valid_references += cnt;
+          __sync_fetch_and_add(&valid_references, cnt);
           first = false;
         }
         done = update_state((gc_references > 0),
@@ -969,6 +1074,13 @@ namespace LegionRuntime {
     bool HierarchicalCollectable::remove_valid_reference(unsigned cnt /*=1*/)
     //--------------------------------------------------------------------------
     {
+      if (try_fast_remove(valid_references, cnt))
+      {
+        RECORD_REFERENCE_PATH(VALID_REF_KIND, true/*fast*/);
+        // Still have references so nothing can be deleted
+        return false;
+      }
+      RECORD_REFERENCE_PATH(VALID_REF_KIND, false/*fast*/);
       bool need_activate = false;
       bool need_validate = false;
       bool need_invalidate = false;
@@ -992,7 +1104,7 @@ namespace LegionRuntime {
 #ifdef DEBUG_HIGH_LEVEL
           assert(valid_references >= cnt);
 #endif
-          valid_references -= cnt;
+          __sync_fetch_and_sub(&valid_references, cnt);
           first = false;
         }
         done = update_state((gc_references > 0),
@@ -1011,19 +1123,32 @@ namespace LegionRuntime {
     void HierarchicalCollectable::add_resource_reference(unsigned cnt /*=1*/)
     //--------------------------------------------------------------------------
     {
+      if (try_fast_add(resource_references, cnt))
+      {
+        RECORD_REFERENCE_PATH(RESOURCE_REF_KIND, true/*fast*/);
+        return;
+      }
+      RECORD_REFERENCE_PATH(RESOURCE_REF_KIND, false/*fast*/);
       AutoLock gc(gc_lock);
-      resource_references += cnt;
+      __sync_fetch_and_add(&resource_references, cnt);
     }
 
     //--------------------------------------------------------------------------
     bool HierarchicalCollectable::remove_resource_reference(unsigned cnt /*=1*/)
     //--------------------------------------------------------------------------
     {
+      if (try_fast_remove(resource_references, cnt))
+      {
+        RECORD_REFERENCE_PATH(RESOURCE_REF_KIND, true/*fast*/);
+        // Still have references so nothing can be deleted
+        return false;
+      }
+      RECORD_REFERENCE_PATH(RESOURCE_REF_KIND, false/*fast*/);
       AutoLock gc(gc_lock);
 #ifdef DEBUG_HIGH_LEVEL
       assert(resource_references >= cnt);
 #endif
-      resource_references -= cnt;
+      __sync_fetch_and_sub(&resource_references, cnt);
       return can_delete((gc_references > 0),
                         (remote_references > 0),
                         (valid_references > 0),
@@ -1034,6 +1159,12 @@ namespace LegionRuntime {
     void HierarchicalCollectable::add_remote_reference(unsigned cnt /*=1*/)
     //--------------------------------------------------------------------------
     {
+      if (try_fast_add(remote_references, cnt))
+      {
+        RECORD_REFERENCE_PATH(REMOTE_REF_KIND, true/*fast*/);
+        return;
+      }
+      RECORD_REFERENCE_PATH(REMOTE_REF_KIND, false/*fast*/);
       bool need_activate = false;
       bool need_validate = false;
       bool need_invalidate = false;
@@ -1054,7 +1185,7 @@ namespace LegionRuntime {
         AutoLock gc(gc_lock);
         if (first)
         {
-          remote_references += cnt;
+          __sync_fetch_and_add(&remote_references, cnt);
           first = false;
         }
         done = update_state((gc_references > 0),
@@ -1078,6 +1209,13 @@ namespace LegionRuntime {
     bool HierarchicalCollectable::remove_remote_reference(unsigned cnt /*=1*/)
     //--------------------------------------------------------------------------
     {
+      if (try_fast_remove(remote_references, cnt))
+      {
+        RECORD_REFERENCE_PATH(REMOTE_REF_KIND, true/*fast*/);
+        // Still have references so nothing can be deleted
+        return false;
+      }
+      RECORD_REFERENCE_PATH(REMOTE_REF_KIND, false/*fast*/);
       bool need_activate = false;
       bool need_validate = false;
       bool need_invalidate = false;
@@ -1101,7 +1239,7 @@ namespace LegionRuntime {
 #ifdef DEBUG_HIGH_LEVEL
           assert(remote_references >= cnt);
 #endif
-          remote_references -= cnt;
+          __sync_fetch_and_sub(&remote_references, cnt);
           first = false;
         }
         done = update_state((gc_references > 0),
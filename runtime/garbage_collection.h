@@ -47,6 +47,7 @@ namespace LegionRuntime {
       VALID_REF_KIND,
       REMOTE_REF_KIND,
       RESOURCE_REF_KIND,
+      LAST_REF_KIND,
     };
 
 #define REFERENCE_NAMES_ARRAY(names)                \
@@ -148,6 +149,16 @@ namespace LegionRuntime {
                       bool has_remote_references,
                       bool has_valid_references,
                       bool has_resource_references);
+    protected:
+      // Atomically update a reference count without the gc lock.
+      // These only succeed when the count is non-zero both before
+      // and after the update, in which case none of the inputs to
+      // update_state change and there is no need to run it.  All
+      // other updates to the count must still be made atomically
+      // (but while holding the gc lock) so that they do not race
+      // with updates made on the fast path.
+      static inline bool try_fast_add(unsigned &count, unsigned cnt);
+      static inline bool try_fast_remove(unsigned &count, unsigned cnt);
     protected:
       State current_state;
     };
@@ -246,6 +257,14 @@ namespace LegionRuntime {
                                                   Deserializer &derez);
       static void process_add_remote_reference(Runtime *rt,
                                                Deserializer &derez);
+#ifdef LEGION_GC_STATS
+    public:
+      static void report_reference_statistics(void);
+    protected:
+      // Number of reference updates handled without [0] and with [1]
+      // taking the gc lock, for each kind of reference
+      static unsigned long long path_counts[LAST_REF_KIND][2];
+#endif
     public:
       Runtime *const runtime;
       const DistributedID did;
@@ -365,6 +384,14 @@ namespace LegionRuntime {
                                                     Deserializer &derez);
       static void process_remove_remote_reference(Runtime *rt,
                                                   Deserializer &derez);
+#ifdef LEGION_GC_STATS
+    public:
+      static void report_reference_statistics(void);
+    protected:
+      // Number of reference updates handled without [0] and with [1]
+      // taking the gc lock, for each kind of reference
+      static unsigned long long path_counts[LAST_REF_KIND][2];
+#endif
     public:
       Runtime *const runtime;
       const DistributedID did;
@@ -439,6 +466,42 @@ namespace LegionRuntime {
       return (prev == cnt);
     }
 
+    //--------------------------------------------------------------------------
+    /*static*/ inline bool CollectableState::try_fast_add(unsigned &count,
+                                                          unsigned cnt)
+    //--------------------------------------------------------------------------
+    {
+      unsigned current = *((volatile unsigned*)&count);
+      // Going from zero to non-zero is a state change so take the lock
+      while (current > 0)
+      {
+        unsigned prev = 
+          __sync_val_compare_and_swap(&count, current, current + cnt);
+        if (prev == current)
+          return true;
+        current = prev;
+      }
+      return false;
+    }
+
+    //--------------------------------------------------------------------------
+    /*static*/ inline bool CollectableState::try_fast_remove(unsigned &count,
+                                                             unsigned cnt)
+    //--------------------------------------------------------------------------
+    {
+      unsigned current = *((volatile unsigned*)&count);
+      // Going to zero is a state change so take the lock
+      while (current > cnt)
+      {
+        unsigned prev = 
+          __sync_val_compare_and_swap(&count, current, current - cnt);
+        if (prev == current)
+          return true;
+        current = prev;
+      }
+      return false;
+    }
+
     //--------------------------------------------------------------------------
     inline void DistributedCollectable::add_base_gc_ref(ReferenceSource source,
                                                         unsigned cnt /*=1*/)
@@ -17,6 +17,10 @@
 #ifndef __LEGION_INTERVAL_TREE_H__
 #define __LEGION_INTERVAL_TREE_H__
 
+#include <vector>
+#include <utility>
+#include <algorithm>
+
 #include <cassert>
 #include <cstdlib>
 
@@ -24,42 +28,31 @@ namespace LegionRuntime {
   namespace HighLevel {
 
     /**
-     * \class IntervalTreeNode
-     * A class for representing nodes in an interval
-     * tree. If it is an intermediate node then it 
-     * represents a whole in the tree, otherwise if
-     * it is a leaf then it represents an actual interval.
+     * \struct IntervalTreeNode
+     * A node in an interval tree. Nodes live in a pool
+     * owned by the tree and refer to their children by
+     * their index in the pool.
      */
-    template<typename T, bool DISCRETE>
-    class IntervalTreeNode {
-    public:
-      IntervalTreeNode(T left, T right);
-      IntervalTreeNode(const IntervalTreeNode &rhs);
-      ~IntervalTreeNode(void);
-    public:
-      IntervalTreeNode& operator=(const IntervalTreeNode &rhs);
-    public:
-      IntervalTreeNode<T,DISCRETE>* insert(T left, T right);
-      IntervalTreeNode<T,DISCRETE>* insert_local(T left, T right);
-      bool intersects(T left, T right) const;
-      bool dominates(T left, T right) const;
-      int count(void) const;
-      IntervalTreeNode<T,DISCRETE>* merge(void);
-      IntervalTreeNode<T,DISCRETE>* reinsert(
-                            IntervalTreeNode<T,DISCRETE> *target);
+    template<typename T>
+    struct IntervalTreeNode {
     public:
-      void sanity_check(void);
-    private:
       T left_bound, right_bound;
-      IntervalTreeNode<T, DISCRETE> *left_node, *right_node;
+      unsigned priority;
+      int left_node, right_node; // -1 if there is no child
     };
-    
-    /** 
+
+    /**
      * \class IntervalTree
      * A slightly modified version of interval tree
      * that collapses intervals that overlap into single
      * intervals to help with testing for intersection
-     * and domination.
+     * and domination. Since the stored intervals are
+     * disjoint they are kept sorted in a treap, which
+     * stays balanced in expectation whatever order the
+     * intervals are inserted in, so all of the queries
+     * are logarithmic. The tree can also be built in
+     * linear time from a sorted list of intervals such
+     * as the runs of an ElementMask.
      */
     template<typename T, bool DISCRETE>
     class IntervalTree {
@@ -71,477 +64,517 @@ namespace LegionRuntime {
       IntervalTree& operator=(const IntervalTree &rhs);
     public:
       void insert(T left, T right);
+      // Replace the contents of the tree with the given intervals,
+      // this is linear if the intervals are already sorted
+      void build(const std::vector<std::pair<T,T> > &intervals);
+      // Replace the contents of the tree with the runs from an
+      // enumerator, e.g. an ElementMask::Enumerator
+      template<typename ENUMERATOR>
+      void build_from_runs(ENUMERATOR *enumerator);
+      void clear(void);
+    public:
       bool intersects(T left, T right) const;
       bool dominates(T left, T right) const;
+      bool contains(T point) const;
+      // Get the stored intervals that overlap [left,right] in order
+      void find_overlaps(T left, T right,
+                         std::vector<std::pair<T,T> > &overlaps) const;
+      inline size_t size(void) const { return num_intervals; }
+      inline bool empty(void) const { return (num_intervals == 0); }
+    public:
+      void sanity_check(void) const;
+    protected:
+      int allocate_node(T left, T right);
+      void free_subtree(int node);
+      // Split into nodes with left_bound < key (or <= key if inclusive)
+      // and everything else
+      void split(int node, T key, bool inclusive, int &lower, int &upper);
+      int merge(int lower, int upper);
+      int remove_leftmost(int node, T &left, T &right);
+      int remove_rightmost(int node, T &left, T &right);
+      // The node with the greatest left_bound <= key or -1 if none
+      int find_floor(T key) const;
+      void find_overlaps(int node, T left, T right,
+                         std::vector<std::pair<T,T> > &overlaps) const;
+      void build_sorted(const std::vector<std::pair<T,T> > &intervals);
+      unsigned next_priority(void);
+      static inline bool touches(T lower_right, T upper_left);
+      T sanity_check(int node, T lower, bool has_lower) const;
     private:
-      IntervalTreeNode<T, DISCRETE> *root;
+      std::vector<IntervalTreeNode<T> > nodes;
+      std::vector<int> free_nodes;
+      int root;
+      size_t num_intervals;
+      unsigned seed;
     };
 
     /////////////////////////////////////////////////////////////
-    // Interval Tree Node 
+    // Interval Tree
     /////////////////////////////////////////////////////////////
 
     //--------------------------------------------------------------------------
     template<typename T, bool DISCRETE>
-    IntervalTreeNode<T,DISCRETE>::IntervalTreeNode(T left, T right)
-      : left_bound(left), right_bound(right), left_node(NULL), right_node(NULL)
+    IntervalTree<T,DISCRETE>::IntervalTree(void)
+      : root(-1), num_intervals(0), seed(0x9e3779b9)
     //--------------------------------------------------------------------------
     {
     }
 
     //--------------------------------------------------------------------------
     template<typename T, bool DISCRETE>
-    IntervalTreeNode<T,DISCRETE>::IntervalTreeNode(const IntervalTreeNode &rhs)
+    IntervalTree<T,DISCRETE>::IntervalTree(const IntervalTree &rhs)
+      : nodes(rhs.nodes), free_nodes(rhs.free_nodes), root(rhs.root),
+        num_intervals(rhs.num_intervals), seed(rhs.seed)
     //--------------------------------------------------------------------------
     {
-      // should never be called
-      assert(false);
     }
 
     //--------------------------------------------------------------------------
     template<typename T, bool DISCRETE>
-    IntervalTreeNode<T,DISCRETE>::~IntervalTreeNode(void)
+    IntervalTree<T,DISCRETE>::~IntervalTree(void)
     //--------------------------------------------------------------------------
     {
-      if (left_node != NULL)
-        delete left_node;
-      if (right_node != NULL)
-        delete right_node;
-      left_node = NULL;
-      right_node = NULL;
     }
 
     //--------------------------------------------------------------------------
     template<typename T, bool DISCRETE>
-    IntervalTreeNode<T,DISCRETE>& IntervalTreeNode<T,DISCRETE>::operator=(
-                                                    const IntervalTreeNode &rhs)
+    IntervalTree<T,DISCRETE>& IntervalTree<T,DISCRETE>::operator=(
+                                                        const IntervalTree &rhs)
     //--------------------------------------------------------------------------
     {
-      // should never be called
-      assert(false);
+      nodes = rhs.nodes;
+      free_nodes = rhs.free_nodes;
+      root = rhs.root;
+      num_intervals = rhs.num_intervals;
+      seed = rhs.seed;
       return *this;
     }
 
     //--------------------------------------------------------------------------
     template<typename T, bool DISCRETE>
-    IntervalTreeNode<T,DISCRETE>* IntervalTreeNode<T,DISCRETE>::insert(
-                                                                T left, T right)
+    void IntervalTree<T,DISCRETE>::insert(T left, T right)
     //--------------------------------------------------------------------------
     {
-      // Six cases here
-      // 1. Dominates
-      // 2. Contained within
-      // 3. Overlap to the left
-      // 4. Overlap to the right
-      // 5. All to the left
-      // 6. All to the right
-      if ((left_bound <= left) && (right <= right_bound))
-      {
-        if (left_node != NULL)
-        {
-          // Insert in the side with fewer segments
 #ifdef DEBUG_HIGH_LEVEL
-          assert(right_node != NULL);
+      assert(left <= right);
 #endif
-          return insert_local(left, right);
-        }
-        // Otherwise we are a base segment and since we
-        // dominate then we are done
-      }
-      else if ((left <= left_bound) && (right_bound <= right))
+      // Pull out everything before the new interval and merge
+      // with the last of those intervals if they touch
+      int lower, upper;
+      split(root, left, false/*inclusive*/, lower, upper);
+      if (lower >= 0)
       {
-        // No need to keep sub-segments anymore, we can delete them
-        if (left_node != NULL)
-        {
-          delete left_node;
-          left_node = NULL;
-        }
-        if (right_node != NULL)
+        int last = lower;
+        while (nodes[last].right_node >= 0)
+          last = nodes[last].right_node;
+        if (touches(nodes[last].right_bound, left))
         {
-          delete right_node;
-          right_node = NULL;
+          T last_left, last_right;
+          lower = remove_rightmost(lower, last_left, last_right);
+          left = last_left;
+          if (right < last_right)
+            right = last_right;
         }
-        left_bound = left;
-        right_bound = right;
       }
-      else if ((left_bound <= right) && (right <= right_bound))
+      // Then absorb all the intervals that start within the new one
+      int absorbed, rest;
+      split(upper, right, true/*inclusive*/, absorbed, rest);
+      if (absorbed >= 0)
       {
-        left_bound = left;
-        if (left_node != NULL)
-        {
-#ifdef DEBUG_HIGH_LEVEL
-          assert(right_node != NULL);
-#endif
-          return insert_local(left, right);
-        }
+        int last = absorbed;
+        while (nodes[last].right_node >= 0)
+          last = nodes[last].right_node;
+        if (right < nodes[last].right_bound)
+          right = nodes[last].right_bound;
+        free_subtree(absorbed);
       }
-      else if ((left_bound <= left) && (left <= right_bound))
+      // And the next one if it starts right after the new one
+      if (DISCRETE && (rest >= 0))
       {
-        right_bound = right;
-        if (left_node != NULL)
+        int first = rest;
+        while (nodes[first].left_node >= 0)
+          first = nodes[first].left_node;
+        if (touches(right, nodes[first].left_bound))
         {
-#ifdef DEBUG_HIGH_LEVEL
-          assert(right_node != NULL);
-#endif
-          return insert_local(left, right);
+          T first_left, first_right;
+          rest = remove_leftmost(rest, first_left, first_right);
+          right = first_right;
         }
       }
-      else if (DISCRETE && (left == (right_bound+1)))
-      {
-        if (right_node != NULL)
-          right_node = right_node->insert(left, right);
-        right_bound = right;
-      }
-      else if (DISCRETE && ((right+1) == left_bound))
-      {
-        if (left_node != NULL)
-          left_node = left_node->insert(left, right);
-        left_bound = left;
-      }
-      else if (left > right_bound)
+      const int node = allocate_node(left, right);
+      root = merge(merge(lower, node), rest);
+    }
+
+    //--------------------------------------------------------------------------
+    template<typename T, bool DISCRETE>
+    void IntervalTree<T,DISCRETE>::build(
+                                const std::vector<std::pair<T,T> > &intervals)
+    //--------------------------------------------------------------------------
+    {
+      bool sorted = true;
+      for (unsigned idx = 1; idx < intervals.size(); idx++)
       {
-        if (right_node != NULL)
-        {
-          right_node = right_node->insert(left, right);
-        }
-        else
+        if (intervals[idx].first < intervals[idx-1].first)
         {
-          // Otherwise make ourselves a new intermedite node
-          left_node = 
-            new IntervalTreeNode<T,DISCRETE>(left_bound, right_bound);
-          right_node = 
-            new IntervalTreeNode<T,DISCRETE>(left, right);
+          sorted = false;
+          break;
         }
-        right_bound = right;
       }
-      else if (right < left_bound)
+      if (sorted)
+        build_sorted(intervals);
+      else
       {
-        if (left_node != NULL)
-        {
-          left_node = left_node->insert(left, right);
-        }
-        else
-        {
-          left_node = 
-            new IntervalTreeNode<T,DISCRETE>(left, right);
-          right_node = 
-            new IntervalTreeNode<T,DISCRETE>(left_bound, right_bound);
-        }
-        left_bound = left;
+        std::vector<std::pair<T,T> > copy(intervals);
+        std::sort(copy.begin(), copy.end());
+        build_sorted(copy);
       }
-      else
-        assert(false); // should never hit this case
-#ifdef DEBUG_HIGH_LEVEL
-      sanity_check();
-#endif
-      return this;
+    }
+
+    //--------------------------------------------------------------------------
+    template<typename T, bool DISCRETE> template<typename ENUMERATOR>
+    void IntervalTree<T,DISCRETE>::build_from_runs(ENUMERATOR *enumerator)
+    //--------------------------------------------------------------------------
+    {
+      std::vector<std::pair<T,T> > runs;
+      int position, length;
+      while (enumerator->get_next(position, length))
+        runs.push_back(std::pair<T,T>(position, position + length - 1));
+      build_sorted(runs);
     }
 
     //--------------------------------------------------------------------------
     template<typename T, bool DISCRETE>
-    IntervalTreeNode<T,DISCRETE>* IntervalTreeNode<T,DISCRETE>::insert_local(
-                                                                T left, T right)
+    void IntervalTree<T,DISCRETE>::clear(void)
     //--------------------------------------------------------------------------
     {
-#ifdef DEBUG_HIGH_LEVEL
-      assert(left_node != NULL);
-      assert(right_node != NULL);
-#endif
-      bool intersect_left = left_node->intersects(left, right);
-      bool intersect_right = right_node->intersects(left, right);
-      if (intersect_left && intersect_right)
-      {
-        left_node = left_node->insert(left, right);
-        IntervalTreeNode<T,DISCRETE> *result = right_node->reinsert(left_node);
-        // make sure we don't delete the new tree
-        left_node = NULL;
-        delete this;
-#ifdef DEBUG_HIGH_LEVEL
-        result->sanity_check();
-#endif
-        return result;
-      }
-      else if (intersect_left)
-        left_node = left_node->insert(left, right);
-      else if (intersect_right)
-        right_node = right_node->insert(left, right);
-      else
-      {
-        int count_left = left_node->count();
-        int count_right = right_node->count();
-        if (count_left <= count_right)
-          left_node = left_node->insert(left, right);
-        else
-          right_node = right_node->insert(left, right);
-      }
-#ifdef DEBUG_HIGH_LEVEL
-      sanity_check();
-#endif
-      return this;
+      nodes.clear();
+      free_nodes.clear();
+      root = -1;
+      num_intervals = 0;
     }
 
     //--------------------------------------------------------------------------
     template<typename T, bool DISCRETE>
-    bool IntervalTreeNode<T,DISCRETE>::intersects(T left, T right) const
+    bool IntervalTree<T,DISCRETE>::intersects(T left, T right) const
     //--------------------------------------------------------------------------
     {
-      if (right < left_bound)
-        return false;
-      if (left > right_bound)
-        return false;
-      if (left_node != NULL)
-      {
 #ifdef DEBUG_HIGH_LEVEL
-        assert(right_node != NULL);
+      assert(left <= right);
 #endif
-        if (left_node->intersects(left, right))
-          return true;
-        if (right_node->intersects(left, right))
-          return true;
+      // The only candidate is the last interval starting before right
+      const int node = find_floor(right);
+      if (node < 0)
         return false;
-      }
-      else
-      {
-        if ((left <= left_bound) && (right >= right_bound))
-          return true;
-        if ((left_bound <= left) && (left <= right_bound))
-          return true;
-        if ((left_bound <= right) && (right <= right_bound))
-          return true;
+      return (left <= nodes[node].right_bound);
+    }
+
+    //--------------------------------------------------------------------------
+    template<typename T, bool DISCRETE>
+    bool IntervalTree<T,DISCRETE>::dominates(T left, T right) const
+    //--------------------------------------------------------------------------
+    {
+      // Intervals are coalesced so only a single one can dominate
+      const int node = find_floor(left);
+      if (node < 0)
         return false;
-      }
+      return (right <= nodes[node].right_bound);
     }
 
     //--------------------------------------------------------------------------
     template<typename T, bool DISCRETE>
-    bool IntervalTreeNode<T,DISCRETE>::dominates(T left, T right) const
+    bool IntervalTree<T,DISCRETE>::contains(T point) const
+    //--------------------------------------------------------------------------
+    {
+      return dominates(point, point);
+    }
+
+    //--------------------------------------------------------------------------
+    template<typename T, bool DISCRETE>
+    void IntervalTree<T,DISCRETE>::find_overlaps(T left, T right,
+                                 std::vector<std::pair<T,T> > &overlaps) const
     //--------------------------------------------------------------------------
     {
-      // See if we dominate it
-      if ((left_bound <= left) && (right <= right_bound))
-      {
-        // If we are an intermediate node, we need to see
-        // if any of our children dominate it
-        if (left_node != NULL)
-        {
 #ifdef DEBUG_HIGH_LEVEL
-          assert(right_node != NULL);
+      assert(left <= right);
 #endif
-          if (left_node->dominates(left, right))
-            return true;
-          if (right_node->dominates(left, right))
-            return true;
-        }
-        else
-          return true;
-      }
-      return false;
+      find_overlaps(root, left, right, overlaps);
     }
 
     //--------------------------------------------------------------------------
     template<typename T, bool DISCRETE>
-    int IntervalTreeNode<T,DISCRETE>::count(void) const
+    void IntervalTree<T,DISCRETE>::sanity_check(void) const
     //--------------------------------------------------------------------------
     {
-      int result = 1;
-      if (left_node != NULL)
-        result += left_node->count();
-      if (right_node != NULL)
-        result += right_node->count();
-      return result;
+      sanity_check(root, T(), false/*has lower*/);
     }
 
     //--------------------------------------------------------------------------
     template<typename T, bool DISCRETE>
-    IntervalTreeNode<T,DISCRETE>* IntervalTreeNode<T,DISCRETE>::merge(void)
+    int IntervalTree<T,DISCRETE>::allocate_node(T left, T right)
     //--------------------------------------------------------------------------
     {
-#ifdef DEBUG_HIGH_LEVEL
-      assert(((left_node == NULL) && (right_node == NULL)) ||
-             ((left_node != NULL) && (right_node != NULL)));
-#endif
-      if (left_node == NULL)
-        return this;
-      if (DISCRETE)
+      int index;
+      if (!free_nodes.empty())
       {
-        if ((left_node->right_bound+1) == right_node->left_bound)
-        {
-          IntervalTreeNode<T,DISCRETE> *result = 
-                              right_node->reinsert(left_node);
-          left_node = NULL;
-          delete this;
-#ifdef DEBUG_HIGH_LEVEL
-          result->sanity_check();
-#endif
-          return result;
-        }
-        else
-        {
-          left_node = left_node->merge();
-          right_node = right_node->merge();
-          // Check again
-          if ((left_node->right_bound+1) == right_node->left_bound)
-          {
-            IntervalTreeNode<T,DISCRETE> *result = 
-              right_node->reinsert(left_node);
-            left_node = NULL;
-            delete this;
-#ifdef DEBUG_HIGH_LEVEL
-            result->sanity_check();
-#endif
-            return result;
-          }
-        }
+        index = free_nodes.back();
+        free_nodes.pop_back();
       }
       else
       {
-        if (left_node->right_bound == right_node->left_bound)  
-        {
-          IntervalTreeNode<T,DISCRETE> *result = 
-                              right_node->reinsert(left_node);
-          left_node = NULL;
-          delete this;
-#ifdef DEBUG_HIGH_LEVEL
-          result->sanity_check();
-#endif
-          return result;
-        }
-        else
-        {
-          left_node = left_node->merge();
-          right_node = right_node->merge();
-          // Check again
-          if (left_node->right_bound == right_node->left_bound)
-          {
-            IntervalTreeNode<T,DISCRETE> *result = 
-                              right_node->reinsert(left_node);
-            left_node = NULL;
-            delete this;
-#ifdef DEBUG_HIGH_LEVEL
-            result->sanity_check();
-#endif
-            return result;
-          }
-        }
+        index = nodes.size();
+        nodes.resize(index+1);
       }
-      return this;
+      IntervalTreeNode<T> &node = nodes[index];
+      node.left_bound = left;
+      node.right_bound = right;
+      node.priority = next_priority();
+      node.left_node = -1;
+      node.right_node = -1;
+      num_intervals++;
+      return index;
+    }
+
+    //--------------------------------------------------------------------------
+    template<typename T, bool DISCRETE>
+    void IntervalTree<T,DISCRETE>::free_subtree(int node)
+    //--------------------------------------------------------------------------
+    {
+      if (node < 0)
+        return;
+      free_subtree(nodes[node].left_node);
+      free_subtree(nodes[node].right_node);
+      free_nodes.push_back(node);
+      num_intervals--;
     }
 
     //--------------------------------------------------------------------------
     template<typename T, bool DISCRETE>
-    IntervalTreeNode<T,DISCRETE>* IntervalTreeNode<T,DISCRETE>::reinsert(
-                                           IntervalTreeNode<T,DISCRETE> *target)
+    void IntervalTree<T,DISCRETE>::split(int node, T key, bool inclusive,
+                                         int &lower, int &upper)
     //--------------------------------------------------------------------------
     {
-      if (left_node != NULL)
+      if (node < 0)
       {
-#ifdef DEBUG_HIGH_LEVEL
-        assert(right_node != NULL);
-#endif
-        target = left_node->reinsert(target);
-        target = right_node->reinsert(target);
-        return target;
+        lower = -1;
+        upper = -1;
+        return;
+      }
+      IntervalTreeNode<T> &n = nodes[node];
+      if ((n.left_bound < key) || (inclusive && (n.left_bound == key)))
+      {
+        split(n.right_node, key, inclusive, nodes[node].right_node, upper);
+        lower = node;
       }
       else
       {
-        return target->insert(left_bound, right_bound);
+        split(n.left_node, key, inclusive, lower, nodes[node].left_node);
+        upper = node;
       }
     }
 
     //--------------------------------------------------------------------------
     template<typename T, bool DISCRETE>
-    void IntervalTreeNode<T,DISCRETE>::sanity_check(void)
+    int IntervalTree<T,DISCRETE>::merge(int lower, int upper)
     //--------------------------------------------------------------------------
     {
-      if (left_node != NULL)
+      if (lower < 0)
+        return upper;
+      if (upper < 0)
+        return lower;
+      if (nodes[lower].priority > nodes[upper].priority)
+      {
+        const int right = merge(nodes[lower].right_node, upper);
+        nodes[lower].right_node = right;
+        return lower;
+      }
+      else
       {
-        assert(right_node != NULL);
-        assert(left_node->right_bound < right_bound);
-        assert(right_node->left_bound > left_bound);
-        assert(left_node->right_bound <= left_node->right_bound);
+        const int left = merge(lower, nodes[upper].left_node);
+        nodes[upper].left_node = left;
+        return upper;
       }
     }
 
-    /////////////////////////////////////////////////////////////
-    // Interval Tree 
-    /////////////////////////////////////////////////////////////
-
     //--------------------------------------------------------------------------
     template<typename T, bool DISCRETE>
-    IntervalTree<T,DISCRETE>::IntervalTree(void)
-      : root(NULL)
+    int IntervalTree<T,DISCRETE>::remove_leftmost(int node, T &left, T &right)
     //--------------------------------------------------------------------------
     {
+      if (nodes[node].left_node < 0)
+      {
+        left = nodes[node].left_bound;
+        right = nodes[node].right_bound;
+        const int result = nodes[node].right_node;
+        free_nodes.push_back(node);
+        num_intervals--;
+        return result;
+      }
+      const int result = remove_leftmost(nodes[node].left_node, left, right);
+      nodes[node].left_node = result;
+      return node;
     }
 
     //--------------------------------------------------------------------------
     template<typename T, bool DISCRETE>
-    IntervalTree<T,DISCRETE>::IntervalTree(const IntervalTree &rhs)
+    int IntervalTree<T,DISCRETE>::remove_rightmost(int node, T &left, T &right)
     //--------------------------------------------------------------------------
     {
-      // should never be called
-      assert(false);
+      if (nodes[node].right_node < 0)
+      {
+        left = nodes[node].left_bound;
+        right = nodes[node].right_bound;
+        const int result = nodes[node].left_node;
+        free_nodes.push_back(node);
+        num_intervals--;
+        return result;
+      }
+      const int result = remove_rightmost(nodes[node].right_node, left, right);
+      nodes[node].right_node = result;
+      return node;
     }
 
     //--------------------------------------------------------------------------
     template<typename T, bool DISCRETE>
-    IntervalTree<T,DISCRETE>::~IntervalTree(void)
+    int IntervalTree<T,DISCRETE>::find_floor(T key) const
     //--------------------------------------------------------------------------
     {
-      if (root != NULL)
-        delete root;
-      root = NULL;
+      int result = -1;
+      int node = root;
+      while (node >= 0)
+      {
+        if (nodes[node].left_bound <= key)
+        {
+          result = node;
+          node = nodes[node].right_node;
+        }
+        else
+          node = nodes[node].left_node;
+      }
+      return result;
     }
 
     //--------------------------------------------------------------------------
     template<typename T, bool DISCRETE>
-    IntervalTree<T,DISCRETE>& IntervalTree<T,DISCRETE>::operator=(
-                                                        const IntervalTree &rhs)
+    void IntervalTree<T,DISCRETE>::find_overlaps(int node, T left, T right,
+                                 std::vector<std::pair<T,T> > &overlaps) const
     //--------------------------------------------------------------------------
     {
-      // should never be called
-      assert(false);
-      return *this;
+      while (node >= 0)
+      {
+        const IntervalTreeNode<T> &n = nodes[node];
+        // Intervals are sorted by both bounds so at most
+        // one side of the tree can be skipped at each node
+        if (right < n.left_bound)
+          node = n.left_node;
+        else if (n.right_bound < left)
+          node = n.right_node;
+        else
+        {
+          find_overlaps(n.left_node, left, right, overlaps);
+          overlaps.push_back(std::pair<T,T>(n.left_bound, n.right_bound));
+          node = n.right_node;
+        }
+      }
     }
 
     //--------------------------------------------------------------------------
     template<typename T, bool DISCRETE>
-    void IntervalTree<T,DISCRETE>::insert(T left, T right)
+    void IntervalTree<T,DISCRETE>::build_sorted(
+                                const std::vector<std::pair<T,T> > &intervals)
     //--------------------------------------------------------------------------
     {
+      clear();
+      if (intervals.empty())
+        return;
+      nodes.reserve(intervals.size());
+      // Build the treap as a cartesian tree on the priorities, keeping
+      // a stack of the nodes on the right spine of the tree so far
+      std::vector<int> spine;
+      for (unsigned idx = 0; idx < intervals.size(); idx++)
+      {
 #ifdef DEBUG_HIGH_LEVEL
-      assert(left <= right);
+        assert(intervals[idx].first <= intervals[idx].second);
 #endif
-      if (root == NULL)
-        root = new IntervalTreeNode<T,DISCRETE>(left, right);
-      else
-      {
-        root = root->insert(left, right);
-        root = root->merge();
+        if (!spine.empty())
+        {
+          // Coalesce with the previous interval if they touch
+          IntervalTreeNode<T> &prev = nodes[spine.back()];
+          if (touches(prev.right_bound, intervals[idx].first))
+          {
+            if (prev.right_bound < intervals[idx].second)
+              prev.right_bound = intervals[idx].second;
+            continue;
+          }
+        }
+        const int node = allocate_node(intervals[idx].first,
+                                       intervals[idx].second);
+        int last = -1;
+        while (!spine.empty() &&
+               (nodes[spine.back()].priority < nodes[node].priority))
+        {
+          last = spine.back();
+          spine.pop_back();
+        }
+        nodes[node].left_node = last;
+        if (!spine.empty())
+          nodes[spine.back()].right_node = node;
+        spine.push_back(node);
       }
+      root = spine.front();
+#ifdef DEBUG_HIGH_LEVEL
+      sanity_check();
+#endif
     }
 
     //--------------------------------------------------------------------------
     template<typename T, bool DISCRETE>
-    bool IntervalTree<T,DISCRETE>::intersects(T left, T right) const
+    unsigned IntervalTree<T,DISCRETE>::next_priority(void)
     //--------------------------------------------------------------------------
     {
-#ifdef DEBUG_HIGH_LEVEL
-      assert(left <= right);
-#endif
-      if (root == NULL)
-        return false;
-      return root->intersects(left, right);
+      // xorshift keeps the shape of the tree reproducible
+      seed ^= (seed << 13);
+      seed ^= (seed >> 17);
+      seed ^= (seed << 5);
+      return seed;
     }
 
     //--------------------------------------------------------------------------
     template<typename T, bool DISCRETE>
-    bool IntervalTree<T,DISCRETE>::dominates(T left, T right) const
+    /*static*/ inline bool IntervalTree<T,DISCRETE>::touches(T lower_right,
+                                                             T upper_left)
     //--------------------------------------------------------------------------
     {
-      if (root == NULL)
-        return false;
-      return root->dominates(left, right);
+      // Check the overlap first so that adding one can't overflow
+      if (upper_left <= lower_right)
+        return true;
+      return (DISCRETE && ((lower_right + 1) == upper_left));
+    }
+
+    //--------------------------------------------------------------------------
+    template<typename T, bool DISCRETE>
+    T IntervalTree<T,DISCRETE>::sanity_check(int node, T lower,
+                                             bool has_lower) const
+    //--------------------------------------------------------------------------
+    {
+      if (node < 0)
+        return lower;
+      const IntervalTreeNode<T> &n = nodes[node];
+      assert(n.left_bound <= n.right_bound);
+      if (n.left_node >= 0)
+      {
+        assert(nodes[n.left_node].priority <= n.priority);
+        lower = sanity_check(n.left_node, lower, has_lower);
+        has_lower = true;
+      }
+      // Intervals must be sorted, disjoint, and not touching
+      if (has_lower)
+        assert(!touches(lower, n.left_bound));
+      if (n.right_node >= 0)
+      {
+        assert(nodes[n.right_node].priority <= n.priority);
+        return sanity_check(n.right_node, n.right_bound, true/*has lower*/);
+      }
+      return n.right_bound;
     }
 
   };
@@ -36,11 +36,9 @@ namespace LegionRuntime {
     Logger::Category log_directory("directory");
     Logger::Category log_prof("legion_prof");
     Logger::Category log_garbage("legion_gc");
-#ifdef LEGION_SPY
     namespace LegionSpy {
       Logger::Category log_spy("legion_spy");
     };
-#endif
 
 #ifdef LEGION_LOGGING
     namespace LegionLogging {
@@ -1244,6 +1242,7 @@ namespace LegionRuntime {
       reduction_list = false;
       make_persistent = false;
       blocking_factor = 1;
+      instance_order = InstanceOrder();
       target_ranking.clear();
       additional_fields.clear();
       mapping_failed = false;
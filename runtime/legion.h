@@ -851,6 +851,7 @@ namespace LegionRuntime {
       bool reduction_list;
       bool make_persistent;
       size_t blocking_factor;
+      InstanceOrder instance_order;
       // TODO: hardness factor
       std::vector<Memory> target_ranking;
       std::set<FieldID> additional_fields;
@@ -2203,6 +2204,18 @@ namespace LegionRuntime {
        * double-precision AVX vector loads, and 16 and 8 for 
        * single- and double-precision vector loads on the Xeon Phi.
        *
+       * For regions with structured (1-3D) index spaces the mapper
+       * can also set the 'instance_order' field to control the order
+       * of the points within the instance.  The default is a linear
+       * column-major order.  Tiled orders keep each tile of
+       * 'tile_size' points together, numbering the tiles column-major
+       * (TILED) or along a Z-order curve (MORTON), which cuts cache
+       * and TLB misses for stencils over large 2D and 3D regions.
+       * Only instances with the same order are reused for a region
+       * requirement.  Tasks using raw pointers must handle the
+       * per-tile subrectangles that raw_rect_ptr returns for tiled
+       * instances, or use dispatch_accessor_subrects.
+       *
        * For reduction instances, instead of selecting the layout of
        * the instance by providing a blocking factor, the mapper can
        * control whether to use a reduction-fold instance or a
@@ -132,6 +132,7 @@ namespace LegionRuntime {
       DENSE_INDEX_ALLOC,
       LOGICAL_STATE_ALLOC,
       PHYSICAL_STATE_ALLOC,
+      FIELD_TREE_ALLOC,
       LAST_ALLOC, // must be last
     };
 
@@ -110,6 +110,29 @@
 #ifndef DEFAULT_GC_EPOCH_SIZE
 #define DEFAULT_GC_EPOCH_SIZE           64
 #endif
+// Number of views collected by each garbage collection
+// meta-task in an epoch
+#ifndef DEFAULT_GC_BATCH_SIZE
+#define DEFAULT_GC_BATCH_SIZE           16
+#endif
+// Time in microseconds that a garbage collection meta-task
+// can run before it defers the rest of its views to a new
+// meta-task so that other utility work can be scheduled
+#ifndef DEFAULT_GC_STEP_BUDGET
+#define DEFAULT_GC_STEP_BUDGET          250
+#endif
+// Future results up to this size in bytes are stored
+// inline in the future instead of in a separate heap
+// allocation.  The default of one cache line covers
+// all the common scalar return types.
+#ifndef LEGION_MAX_INLINE_FUTURE_SIZE
+#define LEGION_MAX_INLINE_FUTURE_SIZE   64
+#endif
+// Fan-out of the tree used for broadcasting the
+// result of a future to remote address spaces
+#ifndef LEGION_FUTURE_BROADCAST_RADIX
+#define LEGION_FUTURE_BROADCAST_RADIX   4
+#endif
 
 // Used for debugging memory leaks
 // How often tracing information is dumped
@@ -296,6 +319,7 @@ typedef enum legion_error_t {
   ERROR_ILLEGAL_ALLOCATOR_REQUEST = 129,
   ERROR_ILLEGAL_DETACH_OPERATION = 130,
   ERROR_NO_PROCESSORS = 131,
+  ERROR_INVALID_SPY_FILE = 132,
 }  legion_error_t;
 
 // enum and namepsaces don't really get along well
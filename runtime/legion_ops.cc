@@ -1597,7 +1597,6 @@ namespace LegionRuntime {
                                          requirement.redop,
                                          requirement.privilege_fields);
 #endif
-#ifdef LEGION_SPY
       LegionSpy::log_mapping_operation(parent_ctx->get_unique_task_id(),
                                        unique_op_id);
       LegionSpy::log_logical_requirement(unique_op_id,0/*index*/,
@@ -1610,7 +1609,6 @@ namespace LegionRuntime {
                                          requirement.redop);
       LegionSpy::log_requirement_fields(unique_op_id, 0/*index*/,
                                         requirement.privilege_fields);
-#endif
       return region;
     }
 
@@ -1661,7 +1659,6 @@ namespace LegionRuntime {
                                          requirement.redop,
                                          requirement.privilege_fields);
 #endif
-#ifdef LEGION_SPY
       LegionSpy::log_mapping_operation(parent_ctx->get_unique_task_id(),
                                        unique_op_id);
       LegionSpy::log_logical_requirement(unique_op_id,0/*index*/,
@@ -1674,7 +1671,6 @@ namespace LegionRuntime {
                                          requirement.redop);
       LegionSpy::log_requirement_fields(unique_op_id, 0/*index*/,
                                         requirement.privilege_fields);
-#endif
       return region;
     }
 
@@ -1715,7 +1711,6 @@ namespace LegionRuntime {
                                          requirement.redop,
                                          requirement.privilege_fields);
 #endif
-#ifdef LEGION_SPY
       LegionSpy::log_mapping_operation(parent_ctx->get_unique_task_id(), 
                                        unique_op_id);
       LegionSpy::log_logical_requirement(unique_op_id,0/*index*/,
@@ -1728,7 +1723,6 @@ namespace LegionRuntime {
                                          requirement.redop);
       LegionSpy::log_requirement_fields(unique_op_id, 0/*index*/,
                                         requirement.privilege_fields);
-#endif
     }
 
     //--------------------------------------------------------------------------
@@ -1936,22 +1930,23 @@ namespace LegionRuntime {
           result.get_handle().get_view()->get_manager()->get_instance(),
           unique_op_id, 0/*idx*/);
 #endif
-#ifdef LEGION_SPY
-      // Log an implicit dependence on the parent's start event
-      LegionSpy::log_implicit_dependence(parent_ctx->get_start_event(),
-                                         result.get_ready_event());
-      LegionSpy::log_op_events(unique_op_id, result.get_ready_event(),
-                                termination_event);
-      // Log an implicit dependence on the parent's term event
-      LegionSpy::log_implicit_dependence(termination_event, 
-                                         parent_ctx->get_task_completion());
-      LegionSpy::log_op_user(unique_op_id, 0/*idx*/, 
-          result.get_handle().get_view()->get_manager()->get_instance().id);
+      if (LegionSpy::spy_logging)
       {
-        Processor proc = Processor::get_executing_processor();
-        LegionSpy::log_op_proc_user(unique_op_id, proc.id);
+        // Log an implicit dependence on the parent's start event
+        LegionSpy::log_implicit_dependence(parent_ctx->get_start_event(),
+                                           result.get_ready_event());
+        LegionSpy::log_op_events(unique_op_id, result.get_ready_event(),
+                                  termination_event);
+        // Log an implicit dependence on the parent's term event
+        LegionSpy::log_implicit_dependence(termination_event, 
+                                           parent_ctx->get_task_completion());
+        LegionSpy::log_op_user(unique_op_id, 0/*idx*/, 
+            result.get_handle().get_view()->get_manager()->get_instance().id);
+        {
+          Processor proc = Processor::get_executing_processor();
+          LegionSpy::log_op_proc_user(unique_op_id, proc.id);
+        }
       }
-#endif
       // Have to do this before triggering the mapped event
       region.impl->reset_reference(result, termination_event);
       // Now we can trigger the mapping event and indicate
@@ -2323,10 +2318,8 @@ namespace LegionRuntime {
             Processor::get_executing_processor(),
             it->phase_barrier, arrive_barriers.back().phase_barrier);
 #endif
-#ifdef LEGION_SPY
         LegionSpy::log_event_dependence(it->phase_barrier,
                                 arrive_barriers.back().phase_barrier);
-#endif
       }
       map_id = launcher.map_id;
       tag = launcher.tag;
@@ -2514,37 +2507,38 @@ namespace LegionRuntime {
                                         req.privilege_fields);
       }
 #endif
-#ifdef LEGION_SPY
-      LegionSpy::log_copy_operation(parent_ctx->get_unique_task_id(),
-                                    unique_op_id);
-      for (unsigned idx = 0; idx < src_requirements.size(); idx++)
-      {
-        const RegionRequirement &req = src_requirements[idx];
-        LegionSpy::log_logical_requirement(unique_op_id, idx, true/*region*/,
-                                           req.region.index_space.id,
-                                           req.region.field_space.id,
-                                           req.region.tree_id,
-                                           req.privilege,
-                                           req.prop, req.redop);
-        LegionSpy::log_requirement_fields(unique_op_id, idx, 
-                                          req.privilege_fields);
-      }
-      for (unsigned idx = 0; idx < dst_requirements.size(); idx++)
+      if (LegionSpy::spy_logging)
       {
-        const RegionRequirement &req = dst_requirements[idx];
-        LegionSpy::log_logical_requirement(unique_op_id, 
-                                           src_requirements.size()+idx, 
-                                           true/*region*/,
-                                           req.region.index_space.id,
-                                           req.region.field_space.id,
-                                           req.region.tree_id,
-                                           req.privilege,
-                                           req.prop, req.redop);
-        LegionSpy::log_requirement_fields(unique_op_id, 
-                                          src_requirements.size()+idx, 
-                                          req.privilege_fields);
+        LegionSpy::log_copy_operation(parent_ctx->get_unique_task_id(),
+                                      unique_op_id);
+        for (unsigned idx = 0; idx < src_requirements.size(); idx++)
+        {
+          const RegionRequirement &req = src_requirements[idx];
+          LegionSpy::log_logical_requirement(unique_op_id, idx, true/*region*/,
+                                             req.region.index_space.id,
+                                             req.region.field_space.id,
+                                             req.region.tree_id,
+                                             req.privilege,
+                                             req.prop, req.redop);
+          LegionSpy::log_requirement_fields(unique_op_id, idx, 
+                                            req.privilege_fields);
+        }
+        for (unsigned idx = 0; idx < dst_requirements.size(); idx++)
+        {
+          const RegionRequirement &req = dst_requirements[idx];
+          LegionSpy::log_logical_requirement(unique_op_id, 
+                                             src_requirements.size()+idx, 
+                                             true/*region*/,
+                                             req.region.index_space.id,
+                                             req.region.field_space.id,
+                                             req.region.tree_id,
+                                             req.privilege,
+                                             req.prop, req.redop);
+          LegionSpy::log_requirement_fields(unique_op_id, 
+                                            src_requirements.size()+idx, 
+                                            req.privilege_fields);
+        }
       }
-#endif
     }
 
     //--------------------------------------------------------------------------
@@ -2853,15 +2847,12 @@ namespace LegionRuntime {
               Processor::get_executing_processor(), preconditions,
                                               sync_precondition);
 #endif
-#ifdef LEGION_SPY
           LegionSpy::log_event_dependences(preconditions,
                                            sync_precondition);
-#endif
         }
-#ifdef LEGION_SPY
         std::set<Event> start_events;
-        start_events.insert(sync_precondition);
-#endif
+        if (LegionSpy::spy_logging)
+          start_events.insert(sync_precondition);
         std::set<Event> copy_complete_events;
         for (unsigned idx = 0; idx < src_requirements.size(); idx++)
         {
@@ -2887,11 +2878,12 @@ namespace LegionRuntime {
             dst_requirements[idx].mapping_failed = false;
             dst_requirements[idx].selected_memory = dst_ref.get_memory();
           }
-#ifdef LEGION_SPY
-          start_events.insert(dst_ref.get_ready_event());
-          LegionSpy::log_op_user(unique_op_id, src_requirements.size()+idx,
-             dst_ref.get_handle().get_view()->get_manager()->get_instance().id);
-#endif
+          if (LegionSpy::spy_logging)
+          {
+            start_events.insert(dst_ref.get_ready_event());
+            LegionSpy::log_op_user(unique_op_id, src_requirements.size()+idx,
+               dst_ref.get_handle().get_view()->get_manager()->get_instance().id);
+          }
           if (!src_mapping_refs[idx].has_ref())
           {
             // In this case, there is no source instance so we need
@@ -2953,11 +2945,12 @@ namespace LegionRuntime {
                                           src_requirements[idx],
                                           dst_requirements[idx],
                                           src_ref, dst_ref, sync_precondition));
-#ifdef LEGION_SPY
-            start_events.insert(src_ref.get_ready_event());
-            LegionSpy::log_op_user(unique_op_id, idx,
-             src_ref.get_handle().get_view()->get_manager()->get_instance().id);
-#endif
+            if (LegionSpy::spy_logging)
+            {
+              start_events.insert(src_ref.get_ready_event());
+              LegionSpy::log_op_user(unique_op_id, idx,
+               src_ref.get_handle().get_view()->get_manager()->get_instance().id);
+            }
           }
         }
 #ifdef LEGION_LOGGING
@@ -2980,26 +2973,27 @@ namespace LegionRuntime {
                                     Processor::get_executing_processor(),
                                     copy_complete_events, copy_complete_event);
 #endif
-#ifdef LEGION_SPY
-        Event start_event = Event::merge_events(start_events);
-        if (!start_event.exists())
-        {
-          UserEvent new_start_event = UserEvent::create_user_event();
-          new_start_event.trigger();
-          start_event = new_start_event;
-        }
-        LegionSpy::log_event_dependences(start_events, start_event);
-        LegionSpy::log_op_events(unique_op_id, start_event,
-                                 completion_event);
-        LegionSpy::log_event_dependences(copy_complete_events, 
-                                         copy_complete_event);
-        LegionSpy::log_event_dependence(copy_complete_event,
-                                        completion_event);
+        if (LegionSpy::spy_logging)
         {
-          Processor proc = Processor::get_executing_processor();
-          LegionSpy::log_op_proc_user(unique_op_id, proc.id);
+          Event start_event = Event::merge_events(start_events);
+          if (!start_event.exists())
+          {
+            UserEvent new_start_event = UserEvent::create_user_event();
+            new_start_event.trigger();
+            start_event = new_start_event;
+          }
+          LegionSpy::log_event_dependences(start_events, start_event);
+          LegionSpy::log_op_events(unique_op_id, start_event,
+                                   completion_event);
+          LegionSpy::log_event_dependences(copy_complete_events, 
+                                           copy_complete_event);
+          LegionSpy::log_event_dependence(copy_complete_event,
+                                          completion_event);
+          {
+            Processor proc = Processor::get_executing_processor();
+            LegionSpy::log_op_proc_user(unique_op_id, proc.id);
+          }
         }
-#endif
         // Chain all the unlock and barrier arrivals off of the
         // copy complete event
         if (!arrive_barriers.empty())
@@ -3013,10 +3007,8 @@ namespace LegionRuntime {
                 Processor::get_executing_processor(),       
                 copy_complete_event, it->phase_barrier);
 #endif
-#ifdef LEGION_SPY
             LegionSpy::log_event_dependence(completion_event, 
                                             it->phase_barrier);
-#endif
           }
         }
 
@@ -3032,10 +3024,8 @@ namespace LegionRuntime {
                                         copy_complete_event,
                                         completion_event);
 #endif
-#ifdef LEGION_SPY
         LegionSpy::log_event_dependence(copy_complete_event,
                                         completion_event);
-#endif
         // Handle the case for marking when the copy completes
         if (!copy_complete_event.has_triggered())
         {
@@ -3427,10 +3417,8 @@ namespace LegionRuntime {
                                          parent_ctx->get_unique_op_id(),
                                          unique_op_id);
 #endif
-#ifdef LEGION_SPY
       LegionSpy::log_fence_operation(parent_ctx->get_unique_task_id(),
                                      unique_op_id);
-#endif
     }
 
     //--------------------------------------------------------------------------
@@ -3709,10 +3697,8 @@ namespace LegionRuntime {
           parent_ctx->get_executing_processor(),
           parent_ctx->get_unique_op_id(), unique_op_id);
 #endif
-#ifdef LEGION_SPY
       LegionSpy::log_deletion_operation(parent_ctx->get_unique_task_id(),
                                         unique_op_id);
-#endif
     }
 
     //--------------------------------------------------------------------------
@@ -3728,10 +3714,8 @@ namespace LegionRuntime {
           parent_ctx->get_executing_processor(),
           parent_ctx->get_unique_op_id(), unique_op_id);
 #endif
-#ifdef LEGION_SPY
       LegionSpy::log_deletion_operation(parent_ctx->get_unique_task_id(),
                                         unique_op_id);
-#endif
     }
 
     //--------------------------------------------------------------------------
@@ -3747,10 +3731,8 @@ namespace LegionRuntime {
           parent_ctx->get_executing_processor(),
           parent_ctx->get_unique_op_id(), unique_op_id);
 #endif
-#ifdef LEGION_SPY
       LegionSpy::log_deletion_operation(parent_ctx->get_unique_task_id(),
                                         unique_op_id);
-#endif
     }
 
     //--------------------------------------------------------------------------
@@ -3767,10 +3749,8 @@ namespace LegionRuntime {
           parent_ctx->get_executing_processor(),
           parent_ctx->get_unique_op_id(), unique_op_id);
 #endif
-#ifdef LEGION_SPY
       LegionSpy::log_deletion_operation(parent_ctx->get_unique_task_id(),
                                         unique_op_id);
-#endif
     }
 
     //--------------------------------------------------------------------------
@@ -3787,10 +3767,8 @@ namespace LegionRuntime {
           parent_ctx->get_executing_processor(),
           parent_ctx->get_unique_op_id(), unique_op_id);
 #endif
-#ifdef LEGION_SPY
       LegionSpy::log_deletion_operation(parent_ctx->get_unique_task_id(),
                                         unique_op_id);
-#endif
     }
 
     //--------------------------------------------------------------------------
@@ -3806,10 +3784,8 @@ namespace LegionRuntime {
           parent_ctx->get_executing_processor(),
           parent_ctx->get_unique_op_id(), unique_op_id);
 #endif
-#ifdef LEGION_SPY
       LegionSpy::log_deletion_operation(parent_ctx->get_unique_task_id(),
                                         unique_op_id);
-#endif
     }
 
     //--------------------------------------------------------------------------
@@ -3825,10 +3801,8 @@ namespace LegionRuntime {
           parent_ctx->get_executing_processor(),
           parent_ctx->get_unique_op_id(), unique_op_id);
 #endif
-#ifdef LEGION_SPY
       LegionSpy::log_deletion_operation(parent_ctx->get_unique_task_id(),
                                         unique_op_id);
-#endif
     }
 
     //--------------------------------------------------------------------------
@@ -4044,31 +4018,32 @@ namespace LegionRuntime {
                                          requirement.redop,
                                          requirement.privilege_fields);
 #endif
-#ifdef LEGION_SPY
-      LegionSpy::log_close_operation(parent_ctx->get_unique_task_id(),
-                                     unique_op_id,
-                                     is_inter_close_op);
-      if (requirement.handle_type == PART_PROJECTION)
-        LegionSpy::log_logical_requirement(unique_op_id, 0/*idx*/,
-                                  false/*region*/,
-                                  requirement.partition.index_partition.id,
-                                  requirement.partition.field_space.id,
-                                  requirement.partition.tree_id,
-                                  requirement.privilege,
-                                  requirement.prop,
-                                  requirement.redop);
-      else
-        LegionSpy::log_logical_requirement(unique_op_id, 0/*idx*/,
-                                  true/*region*/,
-                                  requirement.region.index_space.id,
-                                  requirement.region.field_space.id,
-                                  requirement.region.tree_id,
-                                  requirement.privilege,
-                                  requirement.prop,
-                                  requirement.redop);
-      LegionSpy::log_requirement_fields(unique_op_id, 0/*idx*/,
-                                requirement.privilege_fields);
-#endif
+      if (LegionSpy::spy_logging)
+      {
+        LegionSpy::log_close_operation(parent_ctx->get_unique_task_id(),
+                                       unique_op_id,
+                                       is_inter_close_op);
+        if (requirement.handle_type == PART_PROJECTION)
+          LegionSpy::log_logical_requirement(unique_op_id, 0/*idx*/,
+                                    false/*region*/,
+                                    requirement.partition.index_partition.id,
+                                    requirement.partition.field_space.id,
+                                    requirement.partition.tree_id,
+                                    requirement.privilege,
+                                    requirement.prop,
+                                    requirement.redop);
+        else
+          LegionSpy::log_logical_requirement(unique_op_id, 0/*idx*/,
+                                    true/*region*/,
+                                    requirement.region.index_space.id,
+                                    requirement.region.field_space.id,
+                                    requirement.region.tree_id,
+                                    requirement.privilege,
+                                    requirement.prop,
+                                    requirement.redop);
+        LegionSpy::log_requirement_fields(unique_op_id, 0/*idx*/,
+                                  requirement.privilege_fields);
+      }
     } 
 
     //--------------------------------------------------------------------------
@@ -4329,15 +4304,16 @@ namespace LegionRuntime {
           reference.get_handle().get_view()->get_manager()->get_instance(),
           unique_op_id, 0/*idx*/);
 #endif
-#ifdef LEGION_SPY
-      if (target.has_ref())
-        LegionSpy::log_op_user(unique_op_id, 0/*idx*/, 
-          target.get_view()->get_manager()->get_instance().id);
+      if (LegionSpy::spy_logging)
       {
-        Processor proc = Processor::get_executing_processor();
-        LegionSpy::log_op_proc_user(unique_op_id, proc.id);
+        if (target.has_ref())
+          LegionSpy::log_op_user(unique_op_id, 0/*idx*/, 
+            target.get_view()->get_manager()->get_instance().id);
+        {
+          Processor proc = Processor::get_executing_processor();
+          LegionSpy::log_op_proc_user(unique_op_id, proc.id);
+        }
       }
-#endif
       complete_mapping();
 #ifdef LEGION_LOGGING
       LegionLogging::log_event_dependence(Processor::get_executing_processor(),
@@ -4530,21 +4506,22 @@ namespace LegionRuntime {
           reference.get_handle().get_view()->get_manager()->get_instance(),
           unique_op_id, 0/*idx*/);
 #endif
-#ifdef LEGION_SPY
-      // Log an implicit dependence on the parent's start event
-      LegionSpy::log_implicit_dependence(parent_ctx->get_start_event(), 
-                                         close_event);
-      // Note this gives us a dependence to the parent's termination event
-      // We log this only when close operations are used for closing contexts
-      LegionSpy::log_op_events(unique_op_id, close_event, 
-                             parent_ctx->get_task_completion());
-      LegionSpy::log_op_user(unique_op_id, 0/*idx*/, 
-          reference.get_handle().get_view()->get_manager()->get_instance().id);
+      if (LegionSpy::spy_logging)
       {
-        Processor proc = Processor::get_executing_processor();
-        LegionSpy::log_op_proc_user(unique_op_id, proc.id);
+        // Log an implicit dependence on the parent's start event
+        LegionSpy::log_implicit_dependence(parent_ctx->get_start_event(), 
+                                           close_event);
+        // Note this gives us a dependence to the parent's termination event
+        // We log this only when close operations are used for closing contexts
+        LegionSpy::log_op_events(unique_op_id, close_event, 
+                               parent_ctx->get_task_completion());
+        LegionSpy::log_op_user(unique_op_id, 0/*idx*/, 
+            reference.get_handle().get_view()->get_manager()->get_instance().id);
+        {
+          Processor proc = Processor::get_executing_processor();
+          LegionSpy::log_op_proc_user(unique_op_id, proc.id);
+        }
       }
-#endif
       complete_mapping();
 #ifdef LEGION_LOGGING
       LegionLogging::log_event_dependence(Processor::get_executing_processor(),
@@ -4688,10 +4665,8 @@ namespace LegionRuntime {
             launcher.arrive_barriers.end(); it++)
       {
         arrive_barriers.push_back(*it);
-#ifdef LEGION_SPY
         LegionSpy::log_event_dependence(it->phase_barrier,
                                 arrive_barriers.back().phase_barrier);
-#endif
       }
       map_id = launcher.map_id;
       tag = launcher.tag;
@@ -4701,7 +4676,6 @@ namespace LegionRuntime {
 #ifdef DEBUG_HIGH_LEVEL
       initialize_mapping_path(mapping_path, requirement, requirement.region);
 #endif
-#ifdef LEGION_SPY
       LegionSpy::log_acquire_operation(parent_ctx->get_unique_task_id(),
                                        unique_op_id);
       LegionSpy::log_logical_requirement(unique_op_id,0/*index*/,
@@ -4714,7 +4688,6 @@ namespace LegionRuntime {
                                          requirement.redop);
       LegionSpy::log_requirement_fields(unique_op_id, 0/*index*/,
                                         requirement.privilege_fields);
-#endif
     }
 
     //--------------------------------------------------------------------------
@@ -4867,9 +4840,7 @@ namespace LegionRuntime {
       // Get all the events that need to happen before we can consider
       // ourselves acquired: reference ready and all synchronization
       std::set<Event> acquire_preconditions;
-#ifdef LEGION_SPY
       std::set<Event> acquire_preconditions_spy;
-#endif
       acquire_preconditions.insert(result.get_ready_event());
       if (!wait_barriers.empty())
       {
@@ -4878,9 +4849,8 @@ namespace LegionRuntime {
         {
           Event e = it->phase_barrier.get_previous_phase();
           acquire_preconditions.insert(e);
-#ifdef LEGION_SPY
-          acquire_preconditions_spy.insert(it->phase_barrier.get_previous_phase());
-#endif
+          if (LegionSpy::spy_logging)
+            acquire_preconditions_spy.insert(it->phase_barrier.get_previous_phase());
         }
       }
       if (!grants.empty())
@@ -4890,35 +4860,35 @@ namespace LegionRuntime {
         {
           Event e = it->impl->acquire_grant();
           acquire_preconditions.insert(e);
-#ifdef LEGION_SPY
-          acquire_preconditions_spy.insert(e);
-#endif
+          if (LegionSpy::spy_logging)
+            acquire_preconditions_spy.insert(e);
         }
       }
       Event acquire_complete = Event::merge_events(acquire_preconditions);
-#ifdef LEGION_SPY
-      if (!acquire_complete.exists())
-      {
-        UserEvent new_acquire_complete = UserEvent::create_user_event();
-        new_acquire_complete.trigger();
-        acquire_complete = new_acquire_complete;
-      }
-      LegionSpy::log_event_dependences(acquire_preconditions_spy,
-          acquire_complete);
-      LegionSpy::log_implicit_dependence(parent_ctx->get_start_event(),
-          acquire_complete);
-      LegionSpy::log_op_events(unique_op_id, acquire_complete,
-          completion_event);
-      LegionSpy::log_implicit_dependence(acquire_complete,
-          parent_ctx->get_task_completion());
-      LegionSpy::log_op_user(unique_op_id, 0,
-          result.get_handle().get_view()->get_manager()->get_instance().id);
-      LegionSpy::log_event_dependence(acquire_complete, completion_event);
+      if (LegionSpy::spy_logging)
       {
-        Processor proc = Processor::get_executing_processor();
-        LegionSpy::log_op_proc_user(unique_op_id, proc.id);
+        if (!acquire_complete.exists())
+        {
+          UserEvent new_acquire_complete = UserEvent::create_user_event();
+          new_acquire_complete.trigger();
+          acquire_complete = new_acquire_complete;
+        }
+        LegionSpy::log_event_dependences(acquire_preconditions_spy,
+            acquire_complete);
+        LegionSpy::log_implicit_dependence(parent_ctx->get_start_event(),
+            acquire_complete);
+        LegionSpy::log_op_events(unique_op_id, acquire_complete,
+            completion_event);
+        LegionSpy::log_implicit_dependence(acquire_complete,
+            parent_ctx->get_task_completion());
+        LegionSpy::log_op_user(unique_op_id, 0,
+            result.get_handle().get_view()->get_manager()->get_instance().id);
+        LegionSpy::log_event_dependence(acquire_complete, completion_event);
+        {
+          Processor proc = Processor::get_executing_processor();
+          LegionSpy::log_op_proc_user(unique_op_id, proc.id);
+        }
       }
-#endif
       // Chain any arrival barriers
       if (!arrive_barriers.empty())
       {
@@ -4926,10 +4896,8 @@ namespace LegionRuntime {
               arrive_barriers.begin(); it != arrive_barriers.end(); it++)
         {
           it->phase_barrier.arrive(1/*count*/, acquire_complete);
-#ifdef LEGION_SPY
           LegionSpy::log_event_dependence(completion_event,
               it->phase_barrier);
-#endif
         }
       }
       
@@ -5257,10 +5225,8 @@ namespace LegionRuntime {
             launcher.arrive_barriers.end(); it++)
       {
         arrive_barriers.push_back(*it);
-#ifdef LEGION_SPY
         LegionSpy::log_event_dependence(it->phase_barrier,
                                 arrive_barriers.back().phase_barrier);
-#endif
       }
       map_id = launcher.map_id;
       tag = launcher.tag;
@@ -5270,7 +5236,6 @@ namespace LegionRuntime {
 #ifdef DEBUG_HIGH_LEVEL
       initialize_mapping_path(mapping_path, requirement, requirement.region);
 #endif
-#ifdef LEGION_SPY
       LegionSpy::log_release_operation(parent_ctx->get_unique_task_id(),
                                        unique_op_id);
       LegionSpy::log_logical_requirement(unique_op_id,0/*index*/,
@@ -5283,7 +5248,6 @@ namespace LegionRuntime {
                                          requirement.redop);
       LegionSpy::log_requirement_fields(unique_op_id, 0/*index*/,
                                         requirement.privilege_fields);
-#endif
     }
 
     //--------------------------------------------------------------------------
@@ -5402,14 +5366,13 @@ namespace LegionRuntime {
       // If we couldn't premap, then we need to try again later
       if (!requirement.premapped)
         return false;
-#ifdef LEGION_SPY
-      LegionSpy::IDType inst_id;
+      LegionSpy::IDType inst_id = 0;
+      if (LegionSpy::spy_logging)
       {
         const InstanceRef& ref = region.impl->get_reference();
         inst_id =
           ref.get_handle().get_view()->get_manager()->get_instance().id;
       }
-#endif
       // Map this is a restricted region and then register it. The process
       // of registering it will close up any open children to this instance.
       MappingRef map_ref = runtime->forest->remap_physical_region(physical_ctx,
@@ -5441,10 +5404,9 @@ namespace LegionRuntime {
       Event release_event = result.get_ready_event();
       std::set<Event> release_preconditions;
       release_preconditions.insert(release_event);
-#ifdef LEGION_SPY
       std::set<Event> release_preconditions_spy;
-      release_preconditions_spy.insert(release_event);
-#endif
+      if (LegionSpy::spy_logging)
+        release_preconditions_spy.insert(release_event);
       if (!wait_barriers.empty())
       {
         for (std::vector<PhaseBarrier>::const_iterator it = 
@@ -5452,9 +5414,8 @@ namespace LegionRuntime {
         {
           Event e = it->phase_barrier.get_previous_phase();
           release_preconditions.insert(e);
-#ifdef LEGION_SPY
-          release_preconditions_spy.insert(it->phase_barrier.get_previous_phase());
-#endif
+          if (LegionSpy::spy_logging)
+            release_preconditions_spy.insert(it->phase_barrier.get_previous_phase());
         }
       }
       if (!grants.empty())
@@ -5464,44 +5425,42 @@ namespace LegionRuntime {
         {
           Event e = it->impl->acquire_grant();
           release_preconditions.insert(e);
-#ifdef LEGION_SPY
-          release_preconditions_spy.insert(e);
-#endif
+          if (LegionSpy::spy_logging)
+            release_preconditions_spy.insert(e);
         }
       }
       Event release_complete = Event::merge_events(release_preconditions);
-#ifdef LEGION_SPY
-      if (!release_complete.exists())
-      {
-        UserEvent new_release_complete = UserEvent::create_user_event();
-        new_release_complete.trigger();
-        release_complete = new_release_complete;
-      }
-      LegionSpy::log_event_dependences(release_preconditions_spy,
-          release_complete);
-      LegionSpy::log_implicit_dependence(parent_ctx->get_start_event(),
-          release_complete);
-      LegionSpy::log_op_events(unique_op_id, release_complete,
-          completion_event);
-      LegionSpy::log_op_user(unique_op_id, 0, inst_id);
-      LegionSpy::log_implicit_dependence(release_complete,
-          parent_ctx->get_task_completion());
-      LegionSpy::log_event_dependence(release_complete, completion_event);
+      if (LegionSpy::spy_logging)
       {
-        Processor proc = Processor::get_executing_processor();
-        LegionSpy::log_op_proc_user(unique_op_id, proc.id);
+        if (!release_complete.exists())
+        {
+          UserEvent new_release_complete = UserEvent::create_user_event();
+          new_release_complete.trigger();
+          release_complete = new_release_complete;
+        }
+        LegionSpy::log_event_dependences(release_preconditions_spy,
+            release_complete);
+        LegionSpy::log_implicit_dependence(parent_ctx->get_start_event(),
+            release_complete);
+        LegionSpy::log_op_events(unique_op_id, release_complete,
+            completion_event);
+        LegionSpy::log_op_user(unique_op_id, 0, inst_id);
+        LegionSpy::log_implicit_dependence(release_complete,
+            parent_ctx->get_task_completion());
+        LegionSpy::log_event_dependence(release_complete, completion_event);
+        {
+          Processor proc = Processor::get_executing_processor();
+          LegionSpy::log_op_proc_user(unique_op_id, proc.id);
+        }
       }
-#endif
       // Chain any arrival barriers
       if (!arrive_barriers.empty())
       {
         for (std::vector<PhaseBarrier>::const_iterator it = 
               arrive_barriers.begin(); it != arrive_barriers.end(); it++)
         {
-#ifdef LEGION_SPY
           LegionSpy::log_event_dependence(completion_event,
               it->phase_barrier);
-#endif
           it->phase_barrier.arrive(1/*count*/, release_complete);
         }
       }
@@ -7579,9 +7538,8 @@ namespace LegionRuntime {
       assert(thunk == NULL);
 #endif
       thunk = new EqualPartitionThunk(pid, granularity);
-#ifdef LEGION_SPY
-      perform_logging();
-#endif
+      if (LegionSpy::spy_logging)
+        perform_logging();
     }
 
     //--------------------------------------------------------------------------
@@ -7596,9 +7554,8 @@ namespace LegionRuntime {
       assert(thunk == NULL);
 #endif
       thunk = new WeightedPartitionThunk(pid, granularity, weights);
-#ifdef LEGION_SPY
-      perform_logging();
-#endif
+      if (LegionSpy::spy_logging)
+        perform_logging();
     }
 
     //--------------------------------------------------------------------------
@@ -7613,9 +7570,8 @@ namespace LegionRuntime {
       assert(thunk == NULL);
 #endif
       thunk = new UnionPartitionThunk(pid, h1, h2);
-#ifdef LEGION_SPY
-      perform_logging();
-#endif
+      if (LegionSpy::spy_logging)
+        perform_logging();
     }
 
     //--------------------------------------------------------------------------
@@ -7630,9 +7586,8 @@ namespace LegionRuntime {
       assert(thunk == NULL);
 #endif
       thunk = new IntersectionPartitionThunk(pid, h1, h2);
-#ifdef LEGION_SPY
-      perform_logging();
-#endif
+      if (LegionSpy::spy_logging)
+        perform_logging();
     }
 
     //--------------------------------------------------------------------------
@@ -7647,9 +7602,8 @@ namespace LegionRuntime {
       assert(thunk == NULL);
 #endif
       thunk = new DifferencePartitionThunk(pid, h1, h2);
-#ifdef LEGION_SPY
-      perform_logging();
-#endif
+      if (LegionSpy::spy_logging)
+        perform_logging();
     }
 
     //--------------------------------------------------------------------------
@@ -7664,9 +7618,8 @@ namespace LegionRuntime {
       assert(thunk == NULL);
 #endif
       thunk = new CrossProductThunk(base, source, handles);
-#ifdef LEGION_SPY
-      perform_logging();
-#endif
+      if (LegionSpy::spy_logging)
+        perform_logging();
     }
 
     //--------------------------------------------------------------------------
@@ -7680,9 +7633,8 @@ namespace LegionRuntime {
       assert(thunk == NULL);
 #endif
       thunk = new ComputePendingSpace(target, true/*union*/, handles);
-#ifdef LEGION_SPY
-      perform_logging();
-#endif
+      if (LegionSpy::spy_logging)
+        perform_logging();
     }
 
     //--------------------------------------------------------------------------
@@ -7696,9 +7648,8 @@ namespace LegionRuntime {
       assert(thunk == NULL);
 #endif
       thunk = new ComputePendingSpace(target, true/*union*/, handle);
-#ifdef LEGION_SPY
-      perform_logging();
-#endif
+      if (LegionSpy::spy_logging)
+        perform_logging();
     }
 
     //--------------------------------------------------------------------------
@@ -7711,9 +7662,8 @@ namespace LegionRuntime {
       assert(thunk == NULL);
 #endif
       thunk = new ComputePendingSpace(target, false/*union*/, handles);
-#ifdef LEGION_SPY
-      perform_logging();
-#endif
+      if (LegionSpy::spy_logging)
+        perform_logging();
     }
 
     //--------------------------------------------------------------------------
@@ -7726,9 +7676,8 @@ namespace LegionRuntime {
       assert(thunk == NULL);
 #endif
       thunk = new ComputePendingSpace(target, false/*union*/, handle);
-#ifdef LEGION_SPY
-      perform_logging();
-#endif
+      if (LegionSpy::spy_logging)
+        perform_logging();
     }
 
     //--------------------------------------------------------------------------
@@ -7742,21 +7691,21 @@ namespace LegionRuntime {
       assert(thunk == NULL);
 #endif
       thunk = new ComputePendingDifference(target, initial, handles);
-#ifdef LEGION_SPY
-      perform_logging();
-#endif
+      if (LegionSpy::spy_logging)
+        perform_logging();
     }
 
     //--------------------------------------------------------------------------
     void PendingPartitionOp::perform_logging()
     //--------------------------------------------------------------------------
     {
-#ifdef LEGION_SPY
-      LegionSpy::log_pending_partition_operation(
-          parent_ctx->get_unique_task_id(),
-          unique_op_id);
-      thunk->perform_logging(this);
-#endif
+      if (LegionSpy::spy_logging)
+      {
+        LegionSpy::log_pending_partition_operation(
+            parent_ctx->get_unique_task_id(),
+            unique_op_id);
+        thunk->perform_logging(this);
+      }
     }
 
     //--------------------------------------------------------------------------
@@ -7767,20 +7716,21 @@ namespace LegionRuntime {
       Event ready_event = thunk->perform(runtime->forest);
       // We can trigger the handle ready event now
       handle_ready.trigger();
-#ifdef LEGION_SPY
-      LegionSpy::log_implicit_dependence(parent_ctx->get_start_event(),
-          ready_event);
-      LegionSpy::log_op_events(unique_op_id, ready_event,
-          completion_event);
-      LegionSpy::log_implicit_dependence(completion_event,
-          parent_ctx->get_task_completion());
-      LegionSpy::log_event_dependence(handle_ready, ready_event);
-      LegionSpy::log_event_dependence(ready_event, completion_event);
-      {
-        Processor local_proc = Processor::get_executing_processor();
-        LegionSpy::log_op_proc_user(unique_op_id, local_proc.id);
+      if (LegionSpy::spy_logging)
+      {
+        LegionSpy::log_implicit_dependence(parent_ctx->get_start_event(),
+            ready_event);
+        LegionSpy::log_op_events(unique_op_id, ready_event,
+            completion_event);
+        LegionSpy::log_implicit_dependence(completion_event,
+            parent_ctx->get_task_completion());
+        LegionSpy::log_event_dependence(handle_ready, ready_event);
+        LegionSpy::log_event_dependence(ready_event, completion_event);
+        {
+          Processor local_proc = Processor::get_executing_processor();
+          LegionSpy::log_op_proc_user(unique_op_id, local_proc.id);
+        }
       }
-#endif
       complete_mapping();
       // Now see if we need to defer our completion
       if (!ready_event.has_triggered())
@@ -7893,9 +7843,8 @@ namespace LegionRuntime {
       requirement.initialize_mapping_fields();
       partition_handle = pid;
       color_space = space;
-#ifdef LEGION_SPY
-      perform_logging();
-#endif
+      if (LegionSpy::spy_logging)
+        perform_logging();
     }
 
     //--------------------------------------------------------------------------
@@ -7914,9 +7863,8 @@ namespace LegionRuntime {
       requirement.initialize_mapping_fields();
       partition_handle = pid;
       color_space = space;
-#ifdef LEGION_SPY
-      perform_logging();
-#endif
+      if (LegionSpy::spy_logging)
+        perform_logging();
     }
 
     //--------------------------------------------------------------------------
@@ -7934,42 +7882,42 @@ namespace LegionRuntime {
       partition_handle = pid;
       color_space = space;
       projection = proj;
-#ifdef LEGION_SPY
-      perform_logging();
-#endif
+      if (LegionSpy::spy_logging)
+        perform_logging();
     }
 
     //--------------------------------------------------------------------------
     void DependentPartitionOp::perform_logging()
     //--------------------------------------------------------------------------
     {
-#ifdef LEGION_SPY
-      LegionSpy::log_dependent_partition_operation(
-          parent_ctx->get_unique_task_id(),
-          unique_op_id,
-          partition_handle.id,
-          partition_kind);
-      if (requirement.handle_type == PART_PROJECTION)
-        LegionSpy::log_logical_requirement(unique_op_id, 0/*idx*/,
-                                  false/*region*/,
-                                  requirement.partition.index_partition.id,
-                                  requirement.partition.field_space.id,
-                                  requirement.partition.tree_id,
-                                  requirement.privilege,
-                                  requirement.prop,
-                                  requirement.redop);
-      else
-        LegionSpy::log_logical_requirement(unique_op_id, 0/*idx*/,
-                                  true/*region*/,
-                                  requirement.region.index_space.id,
-                                  requirement.region.field_space.id,
-                                  requirement.region.tree_id,
-                                  requirement.privilege,
-                                  requirement.prop,
-                                  requirement.redop);
-      LegionSpy::log_requirement_fields(unique_op_id, 0/*index*/,
-                                        requirement.privilege_fields);
-#endif
+      if (LegionSpy::spy_logging)
+      {
+        LegionSpy::log_dependent_partition_operation(
+            parent_ctx->get_unique_task_id(),
+            unique_op_id,
+            partition_handle.id,
+            partition_kind);
+        if (requirement.handle_type == PART_PROJECTION)
+          LegionSpy::log_logical_requirement(unique_op_id, 0/*idx*/,
+                                    false/*region*/,
+                                    requirement.partition.index_partition.id,
+                                    requirement.partition.field_space.id,
+                                    requirement.partition.tree_id,
+                                    requirement.privilege,
+                                    requirement.prop,
+                                    requirement.redop);
+        else
+          LegionSpy::log_logical_requirement(unique_op_id, 0/*idx*/,
+                                    true/*region*/,
+                                    requirement.region.index_space.id,
+                                    requirement.region.field_space.id,
+                                    requirement.region.tree_id,
+                                    requirement.privilege,
+                                    requirement.prop,
+                                    requirement.redop);
+        LegionSpy::log_requirement_fields(unique_op_id, 0/*index*/,
+                                          requirement.privilege_fields);
+      }
     }
 
     //--------------------------------------------------------------------------
@@ -8061,7 +8009,6 @@ namespace LegionRuntime {
       assert(handle_ready.exists() && !handle_ready.has_triggered());
 #endif
       handle_ready.trigger();
-#ifdef LEGION_SPY
       LegionSpy::log_implicit_dependence(parent_ctx->get_start_event(),
           ready_event);
       LegionSpy::log_op_events(unique_op_id, ready_event,
@@ -8071,7 +8018,6 @@ namespace LegionRuntime {
       LegionSpy::log_op_proc_user(unique_op_id, local_proc.id);
       LegionSpy::log_event_dependence(handle_ready, ready_event);
       LegionSpy::log_event_dependence(ready_event, completion_event);
-#endif
       complete_mapping();
 
       if (!ready_event.has_triggered())
@@ -8173,7 +8119,6 @@ namespace LegionRuntime {
     }
 
 
-#ifdef LEGION_SPY
     enum PendingPartitionKind
     {
       EQUAL_PARTITION = 0,
@@ -8248,7 +8193,6 @@ namespace LegionRuntime {
     {
     }
 
-#endif
     ///////////////////////////////////////////////////////////// 
     // Fill Op 
     /////////////////////////////////////////////////////////////
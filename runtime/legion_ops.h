@@ -1329,9 +1329,7 @@ namespace LegionRuntime {
         virtual ~PendingPartitionThunk(void) { }
       public:
         virtual Event perform(RegionTreeForest *forest) = 0;
-#ifdef LEGION_SPY
         virtual void perform_logging(PendingPartitionOp* op) = 0;
-#endif
       };
       class EqualPartitionThunk : public PendingPartitionThunk {
       public:
@@ -1341,9 +1339,7 @@ namespace LegionRuntime {
       public:
         virtual Event perform(RegionTreeForest *forest)
         { return forest->create_equal_partition(pid, granularity); }
-#ifdef LEGION_SPY
         virtual void perform_logging(PendingPartitionOp* op);
-#endif
       protected:
         IndexPartition pid;
         size_t granularity;
@@ -1357,9 +1353,7 @@ namespace LegionRuntime {
       public:
         virtual Event perform(RegionTreeForest *forest)
         { return forest->create_weighted_partition(pid, granularity, weights); }
-#ifdef LEGION_SPY
         virtual void perform_logging(PendingPartitionOp* op);
-#endif
       protected:
         IndexPartition pid;
         std::map<DomainPoint,int> weights;
@@ -1374,9 +1368,7 @@ namespace LegionRuntime {
       public:
         virtual Event perform(RegionTreeForest *forest)
         { return forest->create_partition_by_union(pid, handle1, handle2); }
-#ifdef LEGION_SPY
         virtual void perform_logging(PendingPartitionOp* op);
-#endif
       protected:
         IndexPartition pid;
         IndexPartition handle1;
@@ -1392,9 +1384,7 @@ namespace LegionRuntime {
         virtual Event perform(RegionTreeForest *forest)
         { return forest->create_partition_by_intersection(pid, handle1, 
                                                           handle2); }
-#ifdef LEGION_SPY
         virtual void perform_logging(PendingPartitionOp* op);
-#endif
       protected:
         IndexPartition pid;
         IndexPartition handle1;
@@ -1410,9 +1400,7 @@ namespace LegionRuntime {
         virtual Event perform(RegionTreeForest *forest)
         { return forest->create_partition_by_difference(pid, handle1, 
                                                         handle2); }
-#ifdef LEGION_SPY
         virtual void perform_logging(PendingPartitionOp* op);
-#endif
       protected:
         IndexPartition pid;
         IndexPartition handle1;
@@ -1428,9 +1416,7 @@ namespace LegionRuntime {
         virtual Event perform(RegionTreeForest *forest)
         { return forest->create_cross_product_partitions(base, source, 
                                                          handles); }
-#ifdef LEGION_SPY
         virtual void perform_logging(PendingPartitionOp* op);
-#endif
       protected:
         IndexPartition base;
         IndexPartition source;
@@ -1450,9 +1436,7 @@ namespace LegionRuntime {
             return forest->compute_pending_space(target, handle, is_union);
           else
             return forest->compute_pending_space(target, handles, is_union); }
-#ifdef LEGION_SPY
         virtual void perform_logging(PendingPartitionOp* op);
-#endif
       protected:
         bool is_union, is_partition;
         IndexSpace target;
@@ -1468,9 +1452,7 @@ namespace LegionRuntime {
       public:
         virtual Event perform(RegionTreeForest *forest)
         { return forest->compute_pending_space(target, initial, handles); }
-#ifdef LEGION_SPY
         virtual void perform_logging(PendingPartitionOp* op);
-#endif
       protected:
         IndexSpace target, initial;
         std::vector<IndexSpace> handles;
@@ -199,6 +199,21 @@ namespace LegionRuntime {
       info.destroy = timeline->delete_time;
     }
 
+    //--------------------------------------------------------------------------
+    void LegionProfInstance::record_gc_batch(Processor proc, unsigned num_views,
+                      unsigned long long create, unsigned long long start,
+                      unsigned long long stop)
+    //--------------------------------------------------------------------------
+    {
+      gc_infos.push_back(GCInfo());
+      GCInfo &info = gc_infos.back();
+      info.proc = proc;
+      info.num_views = num_views;
+      info.create = create;
+      info.start = start;
+      info.stop = stop;
+    }
+
     //--------------------------------------------------------------------------
     void LegionProfInstance::dump_state(void)
     //--------------------------------------------------------------------------
@@ -260,6 +275,13 @@ namespace LegionRuntime {
                       it->op_id, it->inst.id, it->mem.id, it->total_bytes,
                       it->create, it->destroy);
       }
+      for (std::deque<GCInfo>::const_iterator it = gc_infos.begin();
+            it != gc_infos.end(); it++)
+      {
+        log_prof.info("Prof GC Info " IDFMT " %u %llu %llu %llu",
+                      it->proc.id, it->num_views, 
+                      it->create, it->start, it->stop);
+      }
       task_kinds.clear();
       task_variants.clear();
       operation_instances.clear();
@@ -268,6 +290,7 @@ namespace LegionRuntime {
       meta_infos.clear();
       copy_infos.clear();
       inst_infos.clear();
+      gc_infos.clear();
     }
 
     //--------------------------------------------------------------------------
@@ -608,6 +631,23 @@ namespace LegionRuntime {
       }
     }
 
+    //--------------------------------------------------------------------------
+    void LegionProfiler::record_gc_batch(unsigned num_views,
+                      unsigned long long create, unsigned long long start,
+                      unsigned long long stop)
+    //--------------------------------------------------------------------------
+    {
+      Processor current = Processor::get_executing_processor();
+      size_t local_id = current.local_id(); 
+#ifdef DEBUG_HIGH_LEVEL
+      assert(local_id < MAX_NUM_PROCS);
+#endif
+      if (instances[local_id] == NULL)
+        instances[local_id] = new LegionProfInstance(this);
+      instances[local_id]->record_gc_batch(current, num_views, 
+                                           create, start, stop);
+    }
+
     //--------------------------------------------------------------------------
     void LegionProfiler::finalize(void)
     //--------------------------------------------------------------------------
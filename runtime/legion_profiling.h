@@ -85,6 +85,13 @@ namespace LegionRuntime {
         size_t total_bytes;
         unsigned long long create, destroy;
       };
+      struct GCInfo {
+      public:
+        Processor proc;
+        unsigned num_views;
+        // create is when the epoch was launched
+        unsigned long long create, start, stop;
+      };
     public:
       LegionProfInstance(LegionProfiler *owner);
       LegionProfInstance(const LegionProfInstance &rhs);
@@ -113,6 +120,9 @@ namespace LegionRuntime {
       void process_inst(UniqueID op_id,
                   Realm::ProfilingMeasurements::InstanceTimeline *timeline,
                   Realm::ProfilingMeasurements::InstanceMemoryUsage *usage);
+      void record_gc_batch(Processor proc, unsigned num_views,
+                           unsigned long long create, unsigned long long start,
+                           unsigned long long stop);
     public:
       void dump_state(void);
     private:
@@ -127,6 +137,7 @@ namespace LegionRuntime {
       std::deque<CopyInfo> copy_infos;
       std::deque<FillInfo> fill_infos;
       std::deque<InstInfo> inst_infos;
+      std::deque<GCInfo> gc_infos;
     };
 
     class LegionProfiler {
@@ -183,6 +194,10 @@ namespace LegionRuntime {
     public:
       // Process low-level runtime profiling results
       void process_results(Processor p, const void *buffer, size_t size);
+      // Record the latency of collecting a batch of views in a
+      // garbage collection epoch
+      void record_gc_batch(unsigned num_views, unsigned long long create,
+                           unsigned long long start, unsigned long long stop);
     public:
       // Dump all the results
       void finalize(void);
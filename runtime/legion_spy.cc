@@ -22,6 +22,83 @@
 namespace LegionRuntime {
   namespace HighLevel {
 
+    namespace LegionSpy {
+#ifdef LEGION_SPY
+      bool spy_logging = true;
+#else
+      bool spy_logging = false;
+#endif
+      bool spy_binary = false;
+      std::list<SpyBuffer*> spy_buffers;
+      pthread_key_t spy_buffer_key;
+      pthread_mutex_t spy_mutex = PTHREAD_MUTEX_INITIALIZER;
+      static FILE *spy_file = NULL;
+
+      //------------------------------------------------------------------------
+      void initialize_spy_stream(const char *prefix, AddressSpaceID sid)
+      //------------------------------------------------------------------------
+      {
+        pthread_mutex_lock(&spy_mutex);
+        // With separate runtime instances we only make one stream
+        if (spy_file == NULL)
+        {
+          pthread_key_create(&spy_buffer_key, NULL);
+          char file_name[1024];
+          snprintf(file_name, 1024, "%s_%x.spy", prefix, sid);
+          spy_file = fopen(file_name, "wb");
+          if (spy_file == NULL)
+          {
+            log_spy.error("Unable to open Legion Spy stream file %s",
+                          file_name);
+            exit(ERROR_INVALID_SPY_FILE);
+          }
+          // Header: magic, format version, and the address space
+          const char magic[8] = { 'L','G','N','S','P','Y','B','N' };
+          const unsigned header[2] = { 1/*version*/, sid };
+          fwrite(magic, sizeof(magic), 1, spy_file);
+          fwrite(header, sizeof(header), 1, spy_file);
+          spy_binary = true;
+          spy_logging = true;
+        }
+        pthread_mutex_unlock(&spy_mutex);
+      }
+
+      //------------------------------------------------------------------------
+      void finalize_spy_stream(void)
+      //------------------------------------------------------------------------
+      {
+        pthread_mutex_lock(&spy_mutex);
+        if (spy_file != NULL)
+        {
+          // Nobody should be logging anymore so we can
+          // write out all the remaining buffers
+          for (std::list<SpyBuffer*>::const_iterator it =
+                spy_buffers.begin(); it != spy_buffers.end(); it++)
+          {
+            if ((*it)->used > 0)
+              fwrite((*it)->data, 1, (*it)->used, spy_file);
+            (*it)->used = 0;
+          }
+          fclose(spy_file);
+          spy_file = NULL;
+          spy_logging = false;
+          spy_binary = false;
+        }
+        pthread_mutex_unlock(&spy_mutex);
+      }
+
+      //------------------------------------------------------------------------
+      void flush_spy_buffer(SpyBuffer *buffer)
+      //------------------------------------------------------------------------
+      {
+        pthread_mutex_lock(&spy_mutex);
+        if (spy_file != NULL)
+          fwrite(buffer->data, 1, buffer->used, spy_file);
+        buffer->used = 0;
+        pthread_mutex_unlock(&spy_mutex);
+      }
+    };
+
     //--------------------------------------------------------------------------
     TreeStateLogger::TreeStateLogger(void)
       : verbose(false), logical_only(false), physical_only(false),
@@ -22,6 +22,10 @@
 #include "legion_types.h"
 #include "legion_utilities.h"
 
+#include <list>
+#include <cstring>
+#include <pthread.h>
+
 /**
  * This file contains calls for logging that are consumed by 
  * the legion_spy tool in the tools directory.
@@ -36,123 +40,427 @@ namespace LegionRuntime {
 
       extern Logger::Category log_spy;
 
+      // Legion Spy logging is always compiled in and turned on at
+      // runtime with -hl:spy (text lines through log_spy) or with
+      // -hl:spy_file <prefix> (binary records, one file per address
+      // space).  Builds with LEGION_SPY defined have text logging on
+      // by default.  Every logger call below checks spy_logging first
+      // so the cost when it is disabled is a load and a branch.
+      extern bool spy_logging;
+      extern bool spy_binary;
+
+      // Record kinds for the binary stream.  Each record is a one byte
+      // kind followed by its fields packed in little-endian order with
+      // no padding: ids are 8 bytes, unique ids are signed 8 bytes,
+      // other integers are 4 bytes, booleans are 1 byte, events are an
+      // 8 byte id and a 4 byte generation, points are 4 ints (dim and
+      // 3 coordinates) and strings are a 2 byte length followed by the
+      // characters.  The reader in tools/spy_parser.py has to be kept
+      // in sync with these.
+      enum SpyRecordKind {
+        SPY_UTILITY_PROCESSOR = 1,
+        SPY_PROCESSOR,
+        SPY_MEMORY,
+        SPY_PROC_MEM_AFFINITY,
+        SPY_MEM_MEM_AFFINITY,
+        SPY_TOP_INDEX_SPACE,
+        SPY_INDEX_SPACE_NAME,
+        SPY_INDEX_PARTITION,
+        SPY_INDEX_PARTITION_NAME,
+        SPY_INDEX_SUBSPACE,
+        SPY_FIELD_SPACE,
+        SPY_FIELD_SPACE_NAME,
+        SPY_FIELD_CREATION,
+        SPY_FIELD_NAME,
+        SPY_TOP_REGION,
+        SPY_LOGICAL_REGION_NAME,
+        SPY_LOGICAL_PARTITION_NAME,
+        SPY_TOP_LEVEL_TASK,
+        SPY_INDIVIDUAL_TASK,
+        SPY_INDEX_TASK,
+        SPY_MAPPING_OPERATION,
+        SPY_CLOSE_OPERATION,
+        SPY_FENCE_OPERATION,
+        SPY_COPY_OPERATION,
+        SPY_ACQUIRE_OPERATION,
+        SPY_RELEASE_OPERATION,
+        SPY_DELETION_OPERATION,
+        SPY_DEPENDENT_PARTITION_OPERATION,
+        SPY_PENDING_PARTITION_OPERATION,
+        SPY_PENDING_PARTITION_TARGET,
+        SPY_INDEX_SLICE,
+        SPY_SLICE_SLICE,
+        SPY_SLICE_POINT,
+        SPY_POINT_POINT,
+        SPY_LOGICAL_REQUIREMENT,
+        SPY_REQUIREMENT_FIELD,
+        SPY_MAPPING_DEPENDENCE,
+        SPY_TASK_INSTANCE_REQUIREMENT,
+        SPY_EVENT_DEPENDENCE,
+        SPY_IMPLICIT_DEPENDENCE,
+        SPY_OP_EVENTS,
+        SPY_COPY_EVENTS,
+        SPY_COPY_FIELD,
+        SPY_PHYSICAL_INSTANCE,
+        SPY_REDUCTION_INSTANCE,
+        SPY_INSTANCE_FIELD,
+        SPY_OP_INSTANCE_USER,
+        SPY_PHASE_BARRIER,
+        SPY_OP_PROC_USER,
+      };
+
+      // Records are appended to a per-thread buffer which is written
+      // out to the stream file whenever it fills up
+      struct SpyBuffer {
+      public:
+        static const size_t capacity = 1 << 16;
+      public:
+        size_t used;
+        char data[capacity];
+      };
+
+      extern std::list<SpyBuffer*> spy_buffers;
+      extern pthread_key_t spy_buffer_key;
+      extern pthread_mutex_t spy_mutex;
+
+      // Implementations in legion_spy.cc
+      void initialize_spy_stream(const char *prefix, AddressSpaceID sid);
+      void finalize_spy_stream(void);
+      void flush_spy_buffer(SpyBuffer *buffer);
+
+      static inline SpyBuffer* get_spy_buffer(void)
+      {
+        SpyBuffer *buffer = (SpyBuffer*)pthread_getspecific(spy_buffer_key);
+        if (buffer == NULL)
+        {
+          buffer = new SpyBuffer();
+          buffer->used = 0;
+          pthread_setspecific(spy_buffer_key, buffer);
+          pthread_mutex_lock(&spy_mutex);
+          // keep a list of all the buffers so we can flush them
+          spy_buffers.push_back(buffer);
+          pthread_mutex_unlock(&spy_mutex);
+        }
+        return buffer;
+      }
+
+      // Records are built up on the stack and then copied into the
+      // thread's buffer in one piece so they never get split
+      class SpyRecord {
+      public:
+        static const size_t max_size = 512;
+      public:
+        SpyRecord(SpyRecordKind kind)
+          : size(0) { add<unsigned char>(kind); }
+        ~SpyRecord(void)
+        {
+          SpyBuffer *buffer = get_spy_buffer();
+          if ((buffer->used + size) > SpyBuffer::capacity)
+            flush_spy_buffer(buffer);
+          memcpy(buffer->data + buffer->used, data, size);
+          buffer->used += size;
+        }
+      public:
+        inline void add_id(IDType id) { add<unsigned long long>(id); }
+        inline void add_uid(UniqueID uid) { add<long long>(uid); }
+        inline void add_uint(unsigned value) { add<unsigned>(value); }
+        inline void add_int(int value) { add<int>(value); }
+        inline void add_bool(bool value) { add<unsigned char>(value); }
+        inline void add_event(Event e) 
+          { add<unsigned long long>(e.id); add<unsigned>(e.gen); }
+        inline void add_point(const DomainPoint &point)
+        {
+          add<int>(point.dim);
+          for (int i = 0; i < 3; i++)
+            add<int>(point.point_data[i]);
+        }
+        inline void add_string(const char *str)
+        {
+          // Names that don't fit in the record get truncated
+          size_t length = (str == NULL) ? 0 : strlen(str);
+          if (length > (max_size - size - sizeof(unsigned short)))
+            length = max_size - size - sizeof(unsigned short);
+          add<unsigned short>(length);
+          memcpy(data + size, str, length);
+          size += length;
+        }
+      protected:
+        template<typename T>
+        inline void add(T value)
+        {
+          memcpy(data + size, &value, sizeof(T));
+          size += sizeof(T);
+        }
+      protected:
+        size_t size;
+        char data[max_size];
+      };
+
       // Logger calls for the machine architecture
       static inline void log_utility_processor(IDType unique_id)
       {
-        log_spy.info("Utility " IDFMT "", 
-                unique_id);
+        if (!spy_logging) return;
+        if (spy_binary)
+        {
+          SpyRecord record(SPY_UTILITY_PROCESSOR);
+          record.add_id(unique_id);
+        }
+        else
+          log_spy.info("Utility " IDFMT "", 
+                  unique_id);
       }
 
       static inline void log_processor(IDType unique_id, unsigned kind)
       {
-        log_spy.info("Processor " IDFMT " %u", 
-                unique_id, kind);
+        if (!spy_logging) return;
+        if (spy_binary)
+        {
+          SpyRecord record(SPY_PROCESSOR);
+          record.add_id(unique_id);
+          record.add_uint(kind);
+        }
+        else
+          log_spy.info("Processor " IDFMT " %u", 
+                  unique_id, kind);
       }
 
       static inline void log_memory(IDType unique_id, size_t capacity)
       {
-        log_spy.info("Memory " IDFMT " %lu", 
-                unique_id, capacity);
+        if (!spy_logging) return;
+        if (spy_binary)
+        {
+          SpyRecord record(SPY_MEMORY);
+          record.add_id(unique_id);
+          record.add_id(capacity);
+        }
+        else
+          log_spy.info("Memory " IDFMT " %lu", 
+                  unique_id, capacity);
       }
 
       static inline void log_proc_mem_affinity(IDType proc_id, 
             IDType mem_id, unsigned bandwidth, unsigned latency)
       {
-        log_spy.info("Processor Memory " IDFMT " " IDFMT " %u %u", 
-                  proc_id, mem_id, bandwidth, latency);
+        if (!spy_logging) return;
+        if (spy_binary)
+        {
+          SpyRecord record(SPY_PROC_MEM_AFFINITY);
+          record.add_id(proc_id);
+          record.add_id(mem_id);
+          record.add_uint(bandwidth);
+          record.add_uint(latency);
+        }
+        else
+          log_spy.info("Processor Memory " IDFMT " " IDFMT " %u %u", 
+                    proc_id, mem_id, bandwidth, latency);
       }
 
       static inline void log_mem_mem_affinity(IDType mem1, 
           IDType mem2, unsigned bandwidth, unsigned latency)
       {
-        log_spy.info("Memory Memory " IDFMT " " IDFMT " %u %u", 
-                          mem1, mem2, bandwidth, latency);
+        if (!spy_logging) return;
+        if (spy_binary)
+        {
+          SpyRecord record(SPY_MEM_MEM_AFFINITY);
+          record.add_id(mem1);
+          record.add_id(mem2);
+          record.add_uint(bandwidth);
+          record.add_uint(latency);
+        }
+        else
+          log_spy.info("Memory Memory " IDFMT " " IDFMT " %u %u", 
+                            mem1, mem2, bandwidth, latency);
       }
 
       // Logger calls for the shape of region trees
       static inline void log_top_index_space(IDType unique_id)
       {
-        log_spy.info("Index Space " IDFMT "", unique_id);
+        if (!spy_logging) return;
+        if (spy_binary)
+        {
+          SpyRecord record(SPY_TOP_INDEX_SPACE);
+          record.add_id(unique_id);
+        }
+        else
+          log_spy.info("Index Space " IDFMT "", unique_id);
       }
 
       static inline void log_index_space_name(IDType unique_id,
                                               const char* name)
       {
-        log_spy.info("Index Space Name " IDFMT " %s",
-            unique_id, name);
+        if (!spy_logging) return;
+        if (spy_binary)
+        {
+          SpyRecord record(SPY_INDEX_SPACE_NAME);
+          record.add_id(unique_id);
+          record.add_string(name);
+        }
+        else
+          log_spy.info("Index Space Name " IDFMT " %s",
+              unique_id, name);
       }
 
       static inline void log_index_partition(IDType parent_id, 
                 IDType unique_id, bool disjoint, const DomainPoint& point)
       {
-        log_spy.info("Index Partition " IDFMT " " IDFMT " %u %u %u %u %u",
-                    parent_id, unique_id, disjoint, point.dim, point.point_data[0],
-                    point.point_data[1], point.point_data[2]);
+        if (!spy_logging) return;
+        if (spy_binary)
+        {
+          SpyRecord record(SPY_INDEX_PARTITION);
+          record.add_id(parent_id);
+          record.add_id(unique_id);
+          record.add_bool(disjoint);
+          record.add_point(point);
+        }
+        else
+          log_spy.info("Index Partition " IDFMT " " IDFMT " %u %u %u %u %u",
+                      parent_id, unique_id, disjoint, point.dim, 
+                      point.point_data[0], point.point_data[1], 
+                      point.point_data[2]);
       }
 
       static inline void log_index_partition_name(IDType unique_id,
                                                   const char* name)
       {
-        log_spy.info("Index Partition Name " IDFMT " %s",
-            unique_id, name);
+        if (!spy_logging) return;
+        if (spy_binary)
+        {
+          SpyRecord record(SPY_INDEX_PARTITION_NAME);
+          record.add_id(unique_id);
+          record.add_string(name);
+        }
+        else
+          log_spy.info("Index Partition Name " IDFMT " %s",
+              unique_id, name);
       }
 
       static inline void log_index_subspace(IDType parent_id, 
                               IDType unique_id, const DomainPoint& point)
       {
-        log_spy.info("Index Subspace " IDFMT " " IDFMT " %u %u %u %u",
-                          parent_id, unique_id, point.dim, point.point_data[0],
-                          point.point_data[1], point.point_data[2]);
+        if (!spy_logging) return;
+        if (spy_binary)
+        {
+          SpyRecord record(SPY_INDEX_SUBSPACE);
+          record.add_id(parent_id);
+          record.add_id(unique_id);
+          record.add_point(point);
+        }
+        else
+          log_spy.info("Index Subspace " IDFMT " " IDFMT " %u %u %u %u",
+                            parent_id, unique_id, point.dim, 
+                            point.point_data[0], point.point_data[1], 
+                            point.point_data[2]);
       }
 
       static inline void log_field_space(unsigned unique_id)
       {
-        log_spy.info("Field Space %u", unique_id);
+        if (!spy_logging) return;
+        if (spy_binary)
+        {
+          SpyRecord record(SPY_FIELD_SPACE);
+          record.add_uint(unique_id);
+        }
+        else
+          log_spy.info("Field Space %u", unique_id);
       }
 
       static inline void log_field_space_name(unsigned unique_id,
                                               const char* name)
       {
-        log_spy.info("Field Space Name %u %s",
-            unique_id, name);
+        if (!spy_logging) return;
+        if (spy_binary)
+        {
+          SpyRecord record(SPY_FIELD_SPACE_NAME);
+          record.add_uint(unique_id);
+          record.add_string(name);
+        }
+        else
+          log_spy.info("Field Space Name %u %s",
+              unique_id, name);
       }
 
       static inline void log_field_creation(unsigned unique_id, 
                                             unsigned field_id)
       {
-        log_spy.info("Field Creation %u %u", 
-                            unique_id, field_id);
+        if (!spy_logging) return;
+        if (spy_binary)
+        {
+          SpyRecord record(SPY_FIELD_CREATION);
+          record.add_uint(unique_id);
+          record.add_uint(field_id);
+        }
+        else
+          log_spy.info("Field Creation %u %u", 
+                              unique_id, field_id);
       }
 
       static inline void log_field_name(unsigned unique_id,
                                         unsigned field_id,
                                         const char* name)
       {
-        log_spy.info("Field Name %u %u %s",
-            unique_id, field_id, name);
+        if (!spy_logging) return;
+        if (spy_binary)
+        {
+          SpyRecord record(SPY_FIELD_NAME);
+          record.add_uint(unique_id);
+          record.add_uint(field_id);
+          record.add_string(name);
+        }
+        else
+          log_spy.info("Field Name %u %u %s",
+              unique_id, field_id, name);
       }
 
       static inline void log_top_region(IDType index_space, 
                       unsigned field_space, unsigned tree_id)
       {
-        log_spy.info("Region " IDFMT " %u %u", 
-              index_space, field_space, tree_id);
+        if (!spy_logging) return;
+        if (spy_binary)
+        {
+          SpyRecord record(SPY_TOP_REGION);
+          record.add_id(index_space);
+          record.add_uint(field_space);
+          record.add_uint(tree_id);
+        }
+        else
+          log_spy.info("Region " IDFMT " %u %u", 
+                index_space, field_space, tree_id);
       }
 
       static inline void log_logical_region_name(IDType index_space, 
                       unsigned field_space, unsigned tree_id,
                       const char* name)
       {
-        log_spy.info("Logical Region Name " IDFMT " %u %u %s", 
-              index_space, field_space, tree_id, name);
+        if (!spy_logging) return;
+        if (spy_binary)
+        {
+          SpyRecord record(SPY_LOGICAL_REGION_NAME);
+          record.add_id(index_space);
+          record.add_uint(field_space);
+          record.add_uint(tree_id);
+          record.add_string(name);
+        }
+        else
+          log_spy.info("Logical Region Name " IDFMT " %u %u %s", 
+                index_space, field_space, tree_id, name);
       }
 
       static inline void log_logical_partition_name(IDType index_partition,
                       unsigned field_space, unsigned tree_id,
                       const char* name)
       {
-        log_spy.info("Logical Partition Name " IDFMT " %u %u %s", 
-              index_partition, field_space, tree_id, name);
+        if (!spy_logging) return;
+        if (spy_binary)
+        {
+          SpyRecord record(SPY_LOGICAL_PARTITION_NAME);
+          record.add_id(index_partition);
+          record.add_uint(field_space);
+          record.add_uint(tree_id);
+          record.add_string(name);
+        }
+        else
+          log_spy.info("Logical Partition Name " IDFMT " %u %u %s", 
+                index_partition, field_space, tree_id, name);
       }
 
       // Logger calls for operations 
@@ -160,8 +468,17 @@ namespace LegionRuntime {
                                             UniqueID unique_id,
                                             const char *name)
       {
-        log_spy.info("Top Task %u %llu %s", 
-            task_id, unique_id, name);
+        if (!spy_logging) return;
+        if (spy_binary)
+        {
+          SpyRecord record(SPY_TOP_LEVEL_TASK);
+          record.add_uint(task_id);
+          record.add_uid(unique_id);
+          record.add_string(name);
+        }
+        else
+          log_spy.info("Top Task %u %llu %s", 
+              task_id, unique_id, name);
       }
 
       static inline void log_individual_task(UniqueID context,
@@ -169,8 +486,18 @@ namespace LegionRuntime {
                                              Processor::TaskFuncID task_id,
                                              const char *name)
       {
-        log_spy.info("Individual Task %llu %u %llu %s", 
-            context, task_id, unique_id, name);
+        if (!spy_logging) return;
+        if (spy_binary)
+        {
+          SpyRecord record(SPY_INDIVIDUAL_TASK);
+          record.add_uid(context);
+          record.add_uint(task_id);
+          record.add_uid(unique_id);
+          record.add_string(name);
+        }
+        else
+          log_spy.info("Individual Task %llu %u %llu %s", 
+              context, task_id, unique_id, name);
       }
 
       static inline void log_index_task(UniqueID context,
@@ -178,58 +505,87 @@ namespace LegionRuntime {
                                         Processor::TaskFuncID task_id,
                                         const char *name)
       {
-        log_spy.info("Index Task %llu %u %llu %s",
-            context, task_id, unique_id, name);
+        if (!spy_logging) return;
+        if (spy_binary)
+        {
+          SpyRecord record(SPY_INDEX_TASK);
+          record.add_uid(context);
+          record.add_uint(task_id);
+          record.add_uid(unique_id);
+          record.add_string(name);
+        }
+        else
+          log_spy.info("Index Task %llu %u %llu %s",
+              context, task_id, unique_id, name);
+      }
+
+      // Most operations are just logged with their context and ID
+      static inline void log_operation(SpyRecordKind kind, const char *name,
+                                       UniqueID context, UniqueID unique_id)
+      {
+        if (!spy_logging) return;
+        if (spy_binary)
+        {
+          SpyRecord record(kind);
+          record.add_uid(context);
+          record.add_uid(unique_id);
+        }
+        else
+          log_spy.info("%s Operation %llu %llu",
+              name, context, unique_id);
       }
 
       static inline void log_mapping_operation(UniqueID context,
                                                UniqueID unique_id)
       {
-        log_spy.info("Mapping Operation %llu %llu",
-            context, unique_id);
+        log_operation(SPY_MAPPING_OPERATION, "Mapping", context, unique_id);
       }
 
       static inline void log_close_operation(UniqueID context,
                                              UniqueID unique_id,
                                              unsigned is_inter_close_op)
       {
-        log_spy.info("Close Operation %llu %llu %u",
-            context, unique_id, is_inter_close_op);
+        if (!spy_logging) return;
+        if (spy_binary)
+        {
+          SpyRecord record(SPY_CLOSE_OPERATION);
+          record.add_uid(context);
+          record.add_uid(unique_id);
+          record.add_uint(is_inter_close_op);
+        }
+        else
+          log_spy.info("Close Operation %llu %llu %u",
+              context, unique_id, is_inter_close_op);
       }
 
       static inline void log_fence_operation(UniqueID context,
                                              UniqueID unique_id)
       {
-        log_spy.info("Fence Operation %llu %llu",
-            context, unique_id);
+        log_operation(SPY_FENCE_OPERATION, "Fence", context, unique_id);
       }
 
       static inline void log_copy_operation(UniqueID context,
                                             UniqueID unique_id)
       {
-        log_spy.info("Copy Operation %llu %llu",
-            context, unique_id);
+        log_operation(SPY_COPY_OPERATION, "Copy", context, unique_id);
       }
 
       static inline void log_acquire_operation(UniqueID context,
                                                UniqueID unique_id)
       {
-        log_spy.info("Acquire Operation %llu %llu",
-            context, unique_id);
+        log_operation(SPY_ACQUIRE_OPERATION, "Acquire", context, unique_id);
       }
 
       static inline void log_release_operation(UniqueID context,
                                                UniqueID unique_id)
       {
-        log_spy.info("Release Operation %llu %llu",
-            context, unique_id);
+        log_operation(SPY_RELEASE_OPERATION, "Release", context, unique_id);
       }
 
       static inline void log_deletion_operation(UniqueID context,
                                                 UniqueID deletion)
       {
-        log_spy.info("Deletion Operation %llu %llu",
-            context, deletion);
+        log_operation(SPY_DELETION_OPERATION, "Deletion", context, deletion);
       }
 
       static inline void log_dependent_partition_operation(UniqueID context,
@@ -237,47 +593,99 @@ namespace LegionRuntime {
                                                            IDType pid,
                                                            int kind)
       {
-        log_spy.info("Dependent Partition Operation %llu %llu " IDFMT " %d",
-            context, unique_id, pid, kind);
+        if (!spy_logging) return;
+        if (spy_binary)
+        {
+          SpyRecord record(SPY_DEPENDENT_PARTITION_OPERATION);
+          record.add_uid(context);
+          record.add_uid(unique_id);
+          record.add_id(pid);
+          record.add_int(kind);
+        }
+        else
+          log_spy.info("Dependent Partition Operation %llu %llu " IDFMT " %d",
+              context, unique_id, pid, kind);
       }
 
       static inline void log_pending_partition_operation(UniqueID context,
                                                          UniqueID unique_id)
       {
-        log_spy.info("Pending Partition Operation %llu %llu",
-            context, unique_id);
+        log_operation(SPY_PENDING_PARTITION_OPERATION, "Pending Partition",
+                      context, unique_id);
       }
 
       static inline void log_target_pending_partition(UniqueID unique_id,
                                                       IDType pid,
                                                       int kind)
       {
-        log_spy.info("Pending Partition Target %llu " IDFMT " %d", unique_id,
-            pid, kind);
+        if (!spy_logging) return;
+        if (spy_binary)
+        {
+          SpyRecord record(SPY_PENDING_PARTITION_TARGET);
+          record.add_uid(unique_id);
+          record.add_id(pid);
+          record.add_int(kind);
+        }
+        else
+          log_spy.info("Pending Partition Target %llu " IDFMT " %d", 
+              unique_id, pid, kind);
       }
 
       static inline void log_index_slice(UniqueID index_id, UniqueID slice_id)
       {
-        log_spy.info("Index Slice %llu %llu", index_id, slice_id);
+        if (!spy_logging) return;
+        if (spy_binary)
+        {
+          SpyRecord record(SPY_INDEX_SLICE);
+          record.add_uid(index_id);
+          record.add_uid(slice_id);
+        }
+        else
+          log_spy.info("Index Slice %llu %llu", index_id, slice_id);
       }
 
       static inline void log_slice_slice(UniqueID slice_one, UniqueID slice_two)
       {
-        log_spy.info("Slice Slice %llu %llu", slice_one, slice_two);
+        if (!spy_logging) return;
+        if (spy_binary)
+        {
+          SpyRecord record(SPY_SLICE_SLICE);
+          record.add_uid(slice_one);
+          record.add_uid(slice_two);
+        }
+        else
+          log_spy.info("Slice Slice %llu %llu", slice_one, slice_two);
       }
 
       static inline void log_slice_point(UniqueID slice_id, UniqueID point_id,
                                          const DomainPoint &point)
       {
-        log_spy.info("Slice Point %llu %llu %u %u %u %u", 
-            slice_id, point_id,
-            point.dim, point.point_data[0],
-            point.point_data[1], point.point_data[2]);
+        if (!spy_logging) return;
+        if (spy_binary)
+        {
+          SpyRecord record(SPY_SLICE_POINT);
+          record.add_uid(slice_id);
+          record.add_uid(point_id);
+          record.add_point(point);
+        }
+        else
+          log_spy.info("Slice Point %llu %llu %u %u %u %u", 
+              slice_id, point_id,
+              point.dim, point.point_data[0],
+              point.point_data[1], point.point_data[2]);
       }
 
       static inline void log_point_point(UniqueID p1, UniqueID p2)
       {
-        log_spy.info("Point Point %llu %llu", p1, p2);
+        if (!spy_logging) return;
+        if (spy_binary)
+        {
+          SpyRecord record(SPY_POINT_POINT);
+          record.add_uid(p1);
+          record.add_uid(p2);
+        }
+        else
+          log_spy.info("Point Point %llu %llu", p1, p2);
       }
 
       // Logger calls for mapping dependence analysis 
@@ -286,19 +694,44 @@ namespace LegionRuntime {
           unsigned field_component, unsigned tree_id, unsigned privilege, 
           unsigned coherence, unsigned redop)
       {
-        log_spy.info("Logical Requirement %llu %u %u " IDFMT " %u %u %u %u %u", 
-            unique_id, index, region, index_component,
-            field_component, tree_id, privilege, coherence, redop);
+        if (!spy_logging) return;
+        if (spy_binary)
+        {
+          SpyRecord record(SPY_LOGICAL_REQUIREMENT);
+          record.add_uid(unique_id);
+          record.add_uint(index);
+          record.add_bool(region);
+          record.add_id(index_component);
+          record.add_uint(field_component);
+          record.add_uint(tree_id);
+          record.add_uint(privilege);
+          record.add_uint(coherence);
+          record.add_uint(redop);
+        }
+        else
+          log_spy.info("Logical Requirement %llu %u %u " IDFMT 
+                       " %u %u %u %u %u", unique_id, index, region, 
+                       index_component, field_component, tree_id, 
+                       privilege, coherence, redop);
       }
 
       static inline void log_requirement_fields(UniqueID unique_id, 
           unsigned index, const std::set<unsigned> &logical_fields)
       {
+        if (!spy_logging) return;
         for (std::set<unsigned>::const_iterator it = logical_fields.begin();
               it != logical_fields.end(); it++)
         {
-          log_spy.info("Logical Requirement Field %llu %u %u", 
-                              unique_id, index, *it);
+          if (spy_binary)
+          {
+            SpyRecord record(SPY_REQUIREMENT_FIELD);
+            record.add_uid(unique_id);
+            record.add_uint(index);
+            record.add_uint(*it);
+          }
+          else
+            log_spy.info("Logical Requirement Field %llu %u %u", 
+                                unique_id, index, *it);
         }
       }
 
@@ -306,22 +739,51 @@ namespace LegionRuntime {
                 UniqueID prev_id, unsigned prev_idx, UniqueID next_id, 
                 unsigned next_idx, unsigned dep_type)
       {
-        log_spy.info("Mapping Dependence %llu %llu %u %llu %u %d", 
-            context, prev_id, prev_idx, next_id, next_idx, dep_type);
+        if (!spy_logging) return;
+        if (spy_binary)
+        {
+          SpyRecord record(SPY_MAPPING_DEPENDENCE);
+          record.add_uid(context);
+          record.add_uid(prev_id);
+          record.add_uint(prev_idx);
+          record.add_uid(next_id);
+          record.add_uint(next_idx);
+          record.add_uint(dep_type);
+        }
+        else
+          log_spy.info("Mapping Dependence %llu %llu %u %llu %u %d", 
+              context, prev_id, prev_idx, next_id, next_idx, dep_type);
       }
 
       // Logger calls for physical dependence analysis
       static inline void log_task_instance_requirement(UniqueID unique_id, 
                                   unsigned idx, unsigned index)
       {
-        log_spy.info("Task Instance Requirement %llu %u %u", 
-                            unique_id, idx, index);
+        if (!spy_logging) return;
+        if (spy_binary)
+        {
+          SpyRecord record(SPY_TASK_INSTANCE_REQUIREMENT);
+          record.add_uid(unique_id);
+          record.add_uint(idx);
+          record.add_uint(index);
+        }
+        else
+          log_spy.info("Task Instance Requirement %llu %u %u", 
+                              unique_id, idx, index);
       }
 
       // Logger calls for events
       static inline void log_event_dependence(Event one, Event two)
       {
-        if (one != two)
+        if (!spy_logging) return;
+        if (one == two) return;
+        if (spy_binary)
+        {
+          SpyRecord record(SPY_EVENT_DEPENDENCE);
+          record.add_event(one);
+          record.add_event(two);
+        }
+        else
           log_spy.info("Event Event " IDFMT " %u " IDFMT " %u", 
                           one.id, one.gen, two.id, two.gen);
       }
@@ -329,18 +791,23 @@ namespace LegionRuntime {
       static inline void log_event_dependences(
           const std::set<Event> &preconditions, Event result)
       {
+        if (!spy_logging) return;
         for (std::set<Event>::const_iterator it = preconditions.begin();
               it != preconditions.end(); it++)
-        {
-          if (*it != result)
-            log_spy.info("Event Event " IDFMT " %u " IDFMT " %u", 
-                    it->id, it->gen, result.id, result.gen);
-        }
+          log_event_dependence(*it, result);
       }
 
       static inline void log_implicit_dependence(Event one, Event two)
       {
-        if (one != two)
+        if (!spy_logging) return;
+        if (one == two) return;
+        if (spy_binary)
+        {
+          SpyRecord record(SPY_IMPLICIT_DEPENDENCE);
+          record.add_event(one);
+          record.add_event(two);
+        }
+        else
           log_spy.info("Implicit Event " IDFMT " %u " IDFMT " %u",
               one.id, one.gen, two.id, two.gen);
       }
@@ -348,9 +815,18 @@ namespace LegionRuntime {
       static inline void log_op_events(UniqueID uid, Event start_event,
                                        Event term_event)
       {
-        log_spy.info("Op Events %llu " IDFMT " %u " IDFMT " %u",
-            uid, start_event.id, start_event.gen, 
-            term_event.id, term_event.gen);
+        if (!spy_logging) return;
+        if (spy_binary)
+        {
+          SpyRecord record(SPY_OP_EVENTS);
+          record.add_uid(uid);
+          record.add_event(start_event);
+          record.add_event(term_event);
+        }
+        else
+          log_spy.info("Op Events %llu " IDFMT " %u " IDFMT " %u",
+              uid, start_event.id, start_event.gen, 
+              term_event.id, term_event.gen);
       }
 
       static inline void log_copy_operation(IDType src_inst,
@@ -361,15 +837,38 @@ namespace LegionRuntime {
                                             Event start_event,
                                             Event term_event,
                                             unsigned redop,
-                                            std::set<FieldID> fields)
-                                            //const char *mask)
+                                            const std::set<FieldID> &fields)
       {
+        if (!spy_logging) return;
+        if (spy_binary)
+        {
+          {
+            SpyRecord record(SPY_COPY_EVENTS);
+            record.add_id(src_inst);
+            record.add_id(dst_inst);
+            record.add_id(index_handle);
+            record.add_uint(field_handle);
+            record.add_uint(tree_id);
+            record.add_event(start_event);
+            record.add_event(term_event);
+            record.add_uint(redop);
+          }
+          for (std::set<FieldID>::const_iterator it = fields.begin();
+               it != fields.end(); ++it)
+          {
+            SpyRecord record(SPY_COPY_FIELD);
+            record.add_event(start_event);
+            record.add_event(term_event);
+            record.add_uint(*it);
+          }
+          return;
+        }
         log_spy.info("Copy Events " IDFMT " " IDFMT " " IDFMT 
                            " %u %u " IDFMT " %u " IDFMT " %u %u",
             src_inst, dst_inst, index_handle, field_handle,
             tree_id, start_event.id, start_event.gen, term_event.id,
             term_event.gen, redop);
-        for (std::set<FieldID>::iterator it = fields.begin();
+        for (std::set<FieldID>::const_iterator it = fields.begin();
              it != fields.end(); ++it)
           log_spy.info("Copy Field " IDFMT " %u " IDFMT " %u %u",
               start_event.id, start_event.gen, term_event.id, term_event.gen, *it);
@@ -380,24 +879,56 @@ namespace LegionRuntime {
                          IDType mem_id, IDType index_handle, 
                          unsigned field_handle, unsigned tree_id)
       {
-        log_spy.info("Physical Instance " IDFMT " " IDFMT " " 
-                            IDFMT " %u %u", 
-            inst_id, mem_id, index_handle, field_handle, tree_id);
+        if (!spy_logging) return;
+        if (spy_binary)
+        {
+          SpyRecord record(SPY_PHYSICAL_INSTANCE);
+          record.add_id(inst_id);
+          record.add_id(mem_id);
+          record.add_id(index_handle);
+          record.add_uint(field_handle);
+          record.add_uint(tree_id);
+        }
+        else
+          log_spy.info("Physical Instance " IDFMT " " IDFMT " " 
+                              IDFMT " %u %u", 
+              inst_id, mem_id, index_handle, field_handle, tree_id);
       }
 
       static inline void log_physical_reduction(IDType inst_id, 
           IDType mem_id, IDType index_handle, unsigned field_handle, 
           unsigned tree_id, bool fold, unsigned indirect_id = 0)
       {
-        log_spy.info("Reduction Instance " IDFMT " " IDFMT " " 
-                            IDFMT " %u %u %u %u", 
-                             inst_id, mem_id, index_handle, field_handle, 
-                             tree_id, fold, indirect_id);
+        if (!spy_logging) return;
+        if (spy_binary)
+        {
+          SpyRecord record(SPY_REDUCTION_INSTANCE);
+          record.add_id(inst_id);
+          record.add_id(mem_id);
+          record.add_id(index_handle);
+          record.add_uint(field_handle);
+          record.add_uint(tree_id);
+          record.add_bool(fold);
+          record.add_uint(indirect_id);
+        }
+        else
+          log_spy.info("Reduction Instance " IDFMT " " IDFMT " " 
+                              IDFMT " %u %u %u %u", 
+                               inst_id, mem_id, index_handle, field_handle, 
+                               tree_id, fold, indirect_id);
       }
 
       static inline void log_instance_field(IDType inst_id, FieldID field_id)
       {
-        log_spy.info("Instance Field " IDFMT " %u", inst_id, field_id);
+        if (!spy_logging) return;
+        if (spy_binary)
+        {
+          SpyRecord record(SPY_INSTANCE_FIELD);
+          record.add_id(inst_id);
+          record.add_uint(field_id);
+        }
+        else
+          log_spy.info("Instance Field " IDFMT " %u", inst_id, field_id);
       }
 
 
@@ -405,20 +936,44 @@ namespace LegionRuntime {
                                      unsigned idx, 
                                      IDType inst_id)
       {
-        log_spy.info("Op Instance User %llu %u " IDFMT "", 
-                              user, idx, inst_id);
+        if (!spy_logging) return;
+        if (spy_binary)
+        {
+          SpyRecord record(SPY_OP_INSTANCE_USER);
+          record.add_uid(user);
+          record.add_uint(idx);
+          record.add_id(inst_id);
+        }
+        else
+          log_spy.info("Op Instance User %llu %u " IDFMT "", 
+                                user, idx, inst_id);
       }
 
       static inline void log_phase_barrier(Barrier barrier)
       {
-        log_spy.info("Phase Barrier " IDFMT, barrier.id);
+        if (!spy_logging) return;
+        if (spy_binary)
+        {
+          SpyRecord record(SPY_PHASE_BARRIER);
+          record.add_id(barrier.id);
+        }
+        else
+          log_spy.info("Phase Barrier " IDFMT, barrier.id);
       }
 
       static inline void log_op_proc_user(UniqueID user,
                                           IDType proc_id)
       {
-        log_spy.info("Op Processor User %llu " IDFMT "",
-                              user, proc_id);
+        if (!spy_logging) return;
+        if (spy_binary)
+        {
+          SpyRecord record(SPY_OP_PROC_USER);
+          record.add_uid(user);
+          record.add_id(proc_id);
+        }
+        else
+          log_spy.info("Op Processor User %llu " IDFMT "",
+                                user, proc_id);
       }
 
     };
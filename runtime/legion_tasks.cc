@@ -1490,12 +1490,10 @@ namespace LegionRuntime {
             Processor::get_executing_processor(),
             get_task_completion(), arrive_barriers.back().phase_barrier);
 #endif
-#ifdef LEGION_SPY
         LegionSpy::log_event_dependence(it->phase_barrier,
                                         arrive_barriers.back().phase_barrier); 
         LegionSpy::log_event_dependence(get_task_completion(),
                                         arrive_barriers.back().phase_barrier);
-#endif
       }
     }
 
@@ -1823,6 +1821,8 @@ namespace LegionRuntime {
         rez.serialize(it->second);
       }
       rez.serialize(req.max_blocking_factor);
+      rez.serialize(req.instance_order.kind);
+      rez.serialize(req.instance_order.tile_size);
       rez.serialize(req.must_early_map);
       rez.serialize(req.restricted);
       rez.serialize(req.selected_memory);
@@ -1871,6 +1871,8 @@ namespace LegionRuntime {
         req.current_instances[mem] = full;
       }
       derez.deserialize(req.max_blocking_factor);
+      derez.deserialize(req.instance_order.kind);
+      derez.deserialize(req.instance_order.tile_size);
       derez.deserialize(req.must_early_map);
       derez.deserialize(req.restricted);
       derez.deserialize(req.selected_memory);
@@ -1946,10 +1948,8 @@ namespace LegionRuntime {
                                             const RegionRequirement &req)
     //--------------------------------------------------------------------------
     {
-#if defined(LEGION_LOGGING) || defined(LEGION_SPY)
       const bool reg = (req.handle_type == SINGULAR) ||
                  (req.handle_type == REG_PROJECTION);
-#endif
 #ifdef LEGION_LOGGING
       LegionLogging::log_logical_requirement(Processor::get_executing_processor(),
                                            uid, idx, reg,
@@ -1962,8 +1962,6 @@ namespace LegionRuntime {
                                            req.privilege, req.prop, req.redop,
                                            req.privilege_fields);
 #endif
-#ifdef LEGION_SPY
-      
       LegionSpy::log_logical_requirement(uid, idx, reg,
           reg ? req.region.index_space.id :
                 req.partition.index_partition.id,
@@ -1973,7 +1971,6 @@ namespace LegionRuntime {
                 req.partition.tree_id,
           req.privilege, req.prop, req.redop);
       LegionSpy::log_requirement_fields(uid, idx, req.privilege_fields);
-#endif
     }
 
     /////////////////////////////////////////////////////////////
@@ -2458,10 +2455,9 @@ namespace LegionRuntime {
       rez.serialize(num_local);
       for (unsigned idx = 0; idx < locals.size(); idx++)
         rez.serialize(locals[idx]);
-#if defined(LEGION_LOGGING) || defined(LEGION_SPY)
+      // Legion Spy is enabled at runtime so always send these
       rez.serialize(legion_spy_start);
       rez.serialize(get_task_completion());
-#endif
     }
 
     //--------------------------------------------------------------------------
@@ -4524,9 +4520,7 @@ namespace LegionRuntime {
       LegionLogging::log_event_dependences(
           Processor::get_executing_processor(), wait_on_events, start_condition);
 #endif
-#ifdef LEGION_SPY
       LegionSpy::log_event_dependences(wait_on_events, start_condition);
-#endif
       // Take all the locks in order in the proper way
       if (!atomic_locks.empty())
       {
@@ -4552,9 +4546,7 @@ namespace LegionRuntime {
           LegionLogging::log_event_dependence(
               Processor::get_executing_processor(), start_condition, next);
 #endif
-#ifdef LEGION_SPY
           LegionSpy::log_event_dependence(start_condition, next);
-#endif
           start_condition = next;
         }
       }
@@ -4731,10 +4723,8 @@ namespace LegionRuntime {
                                  get_unique_task_id(), idx, 
                                  regions[idx].region.get_index_space());
 #endif
-#ifdef LEGION_SPY
         LegionSpy::log_task_instance_requirement(get_unique_task_id(), idx,
                                  regions[idx].region.get_index_space().id);
-#endif
       }
       {
         std::set<Event> unmap_set;
@@ -4758,13 +4748,11 @@ namespace LegionRuntime {
                                   get_unique_task_id(),
                                   start_condition, get_task_completion());
 #endif
-#ifdef LEGION_SPY
         // Log an implicit dependence on the parent's start event
         LegionSpy::log_implicit_dependence(parent_ctx->get_start_event(),
                                            start_condition);
         LegionSpy::log_op_events(get_unique_task_id(), 
                                  start_condition, all_unmap_event);
-#endif
         this->legion_spy_start = start_condition; 
         // Record the start
         for (unsigned idx = 0; idx < regions.size(); idx++)
@@ -4779,12 +4767,10 @@ namespace LegionRuntime {
                                   Processor::get_executing_processor(),
                                   unmap_events[idx], get_task_completion());
 #endif
-#ifdef LEGION_SPY
             LegionSpy::log_event_dependence(all_unmap_event, unmap_events[idx]);
             // Log an implicit dependence on the parent's start event
             LegionSpy::log_event_dependence(unmap_events[idx],
                                                get_task_completion());
-#endif
           }
         }
 #ifdef LEGION_LOGGING
@@ -4792,10 +4778,8 @@ namespace LegionRuntime {
         // completion events of task/subtask, because
         // log_individual_task and log_index_space_task log this relationship
 #endif
-#ifdef LEGION_SPY
         LegionSpy::log_implicit_dependence(get_task_completion(),
                                            parent_ctx->get_task_completion());
-#endif
       }
 #endif
       // Mark that we have an outstanding task in this context 
@@ -4881,21 +4865,22 @@ namespace LegionRuntime {
         }
       }
 #endif
-#ifdef LEGION_SPY
-      for (unsigned idx = 0; idx < physical_instances.size(); idx++)
+      if (LegionSpy::spy_logging)
       {
-        if (physical_instances[idx].has_ref())
+        for (unsigned idx = 0; idx < physical_instances.size(); idx++)
         {
-          LegionSpy::log_op_user(unique_op_id, idx, 
-           physical_instances[idx].get_handle().get_view()->
-                                get_manager()->get_instance().id);
+          if (physical_instances[idx].has_ref())
+          {
+            LegionSpy::log_op_user(unique_op_id, idx, 
+             physical_instances[idx].get_handle().get_view()->
+                                  get_manager()->get_instance().id);
+          }
+        }
+        {
+          Processor proc = Processor::get_executing_processor();
+          LegionSpy::log_op_proc_user(unique_op_id, proc.id);
         }
       }
-      {
-        Processor proc = Processor::get_executing_processor();
-        LegionSpy::log_op_proc_user(unique_op_id, proc.id);
-      }
-#endif
 #ifdef LEGION_LOGGING
       LegionLogging::log_timing_event(Processor::get_executing_processor(),
                                       get_unique_task_id(),
@@ -5777,12 +5762,10 @@ namespace LegionRuntime {
                                          parent_ctx->get_unique_task_id(),
                                          unique_op_id, task_id, tag);
 #endif
-#ifdef LEGION_SPY
       LegionSpy::log_individual_task(parent_ctx->get_unique_task_id(),
                                      unique_op_id,
                                      task_id,
                                      variants->name);
-#endif
 #if defined(LEGION_LOGGING) || defined(LEGION_SPY)
       for (unsigned idx = 0; idx < regions.size(); idx++)
       {
@@ -5841,12 +5824,10 @@ namespace LegionRuntime {
                                          parent_ctx->get_unique_task_id(),
                                          unique_op_id, task_id, tag);
 #endif
-#ifdef LEGION_SPY
       LegionSpy::log_individual_task(parent_ctx->get_unique_task_id(),
                                      unique_op_id,
                                      task_id,
                                      variants->name);
-#endif
 #if defined(LEGION_LOGGING) || defined(LEGION_SPY)
       for (unsigned idx = 0; idx < regions.size(); idx++)
       {
@@ -6459,9 +6440,7 @@ namespace LegionRuntime {
                                      remote_unique_id,
                                      get_unique_task_id());
 #endif
-#ifdef LEGION_SPY
       LegionSpy::log_point_point(remote_unique_id, get_unique_task_id());
-#endif
       // Return true to add ourselves to the ready queue
       return true;
     }
@@ -7445,10 +7424,8 @@ namespace LegionRuntime {
         derez.deserialize(temp_local[idx]);
         allocate_local_field(temp_local[idx]);
       }
-#if defined(LEGION_LOGGING) || defined(LEGION_SPY)
       derez.deserialize(legion_spy_start);
       derez.deserialize(remote_legion_spy_completion);
-#endif
       // Now put them on the local fields list, hold the lock
       // while modifying the data structure
       AutoLock o_lock(op_lock);
@@ -7475,13 +7452,7 @@ namespace LegionRuntime {
     Event RemoteTask::get_task_completion(void) const
     //--------------------------------------------------------------------------
     {
-#if !defined(LEGION_LOGGING) && !defined(LEGION_SPY)
-      // should never be called
-      assert(false);
-      return Event::NO_EVENT;
-#else
       return remote_legion_spy_completion;
-#endif
     }
 
     //--------------------------------------------------------------------------
@@ -7787,12 +7758,13 @@ namespace LegionRuntime {
         args = arg_manager->get_allocation();
         memcpy(args, launcher.global_arg.get_ptr(), arglen);
       }
-      argument_map = ArgumentMap(launcher.argument_map.impl->freeze());
       map_id = launcher.map_id;
       tag = launcher.tag;
       is_index_space = true;
       must_parallelism = launcher.must_parallelism;
       index_domain = launcher.launch_domain;
+      argument_map = 
+        ArgumentMap(launcher.argument_map.impl->freeze(index_domain));
       initialize_base_task(ctx, track, launcher.predicate, task_id);
       if (launcher.predicate != Predicate::TRUE_PRED)
         initialize_predicate(launcher.predicate_false_future,
@@ -7801,7 +7773,8 @@ namespace LegionRuntime {
         perform_privilege_checks();
       initialize_paths();
       annotate_early_mapped_regions();
-      future_map = FutureMap(legion_new<FutureMap::Impl>(ctx, this, runtime));
+      future_map = FutureMap(legion_new<FutureMap::Impl>(ctx, this, 
+                                          index_domain, runtime));
 #ifdef DEBUG_HIGH_LEVEL
       future_map.impl->add_valid_domain(index_domain);
 #endif
@@ -7811,11 +7784,9 @@ namespace LegionRuntime {
                                           parent_ctx->get_unique_task_id(),
                                           unique_op_id, task_id, tag);
 #endif
-#ifdef LEGION_SPY
       LegionSpy::log_index_task(parent_ctx->get_unique_task_id(),
                                 unique_op_id, task_id,
                                 variants->name);
-#endif
 #if defined(LEGION_LOGGING) || defined(LEGION_SPY)
       for (unsigned idx = 0; idx < regions.size(); idx++)
       {
@@ -7858,12 +7829,13 @@ namespace LegionRuntime {
         args = arg_manager->get_allocation();
         memcpy(args, launcher.global_arg.get_ptr(), arglen);
       }
-      argument_map = ArgumentMap(launcher.argument_map.impl->freeze());
       map_id = launcher.map_id;
       tag = launcher.tag;
       is_index_space = true;
       must_parallelism = launcher.must_parallelism;
       index_domain = launcher.launch_domain;
+      argument_map = 
+        ArgumentMap(launcher.argument_map.impl->freeze(index_domain));
       redop = redop_id;
       reduction_op = Runtime::get_reduction_op(redop);
       if (!reduction_op->is_foldable)
@@ -7895,11 +7867,9 @@ namespace LegionRuntime {
                                           parent_ctx->get_unique_task_id(),
                                           unique_op_id, task_id, tag);
 #endif
-#ifdef LEGION_SPY
       LegionSpy::log_index_task(parent_ctx->get_unique_task_id(),
                                 unique_op_id, task_id,
                                 variants->name);
-#endif
 #if defined(LEGION_LOGGING) || defined(LEGION_SPY)
       for (unsigned idx = 0; idx < regions.size(); idx++)
       {
@@ -7943,18 +7913,19 @@ namespace LegionRuntime {
         args = arg_manager->get_allocation();
         memcpy(args, global_arg.get_ptr(), arglen);
       }
-      argument_map = ArgumentMap(arg_map.impl->freeze());
       map_id = mid;
       tag = t;
       is_index_space = true;
       must_parallelism = must;
       index_domain = domain;
+      argument_map = ArgumentMap(arg_map.impl->freeze(index_domain));
       initialize_base_task(ctx, true/*track*/, pred, task_id);
       if (check_privileges)
         perform_privilege_checks();
       initialize_paths();
       annotate_early_mapped_regions();
-      future_map = FutureMap(legion_new<FutureMap::Impl>(ctx, this, runtime));
+      future_map = FutureMap(legion_new<FutureMap::Impl>(ctx, this, 
+                                          index_domain, runtime));
 #ifdef DEBUG_HIGH_LEVEL
       future_map.impl->add_valid_domain(index_domain);
 #endif
@@ -7964,11 +7935,9 @@ namespace LegionRuntime {
                                           parent_ctx->get_unique_task_id(),
                                           unique_op_id, task_id, tag);
 #endif
-#ifdef LEGION_SPY
       LegionSpy::log_index_task(parent_ctx->get_unique_task_id(),
                                 unique_op_id, task_id,
                                 variants->name);
-#endif
 #if defined(LEGION_LOGGING) || defined(LEGION_SPY)
       for (unsigned idx = 0; idx < regions.size(); idx++)
       {
@@ -8014,12 +7983,12 @@ namespace LegionRuntime {
         args = arg_manager->get_allocation();
         memcpy(args, global_arg.get_ptr(), arglen);
       }
-      argument_map = ArgumentMap(arg_map.impl->freeze());
       map_id = mid;
       tag = t;
       is_index_space = true;
       must_parallelism = must;
       index_domain = domain;
+      argument_map = ArgumentMap(arg_map.impl->freeze(index_domain));
       redop = redop_id;
       reduction_op = Runtime::get_reduction_op(redop);
       if (!reduction_op->is_foldable)
@@ -8048,11 +8017,9 @@ namespace LegionRuntime {
                                           parent_ctx->get_unique_task_id(),
                                           unique_op_id, task_id, tag);
 #endif
-#ifdef LEGION_SPY
       LegionSpy::log_index_task(parent_ctx->get_unique_task_id(),
                                 unique_op_id, task_id,
                                 variants->name);
-#endif
 #if defined(LEGION_LOGGING) || defined(LEGION_SPY)
       for (unsigned idx = 0; idx < regions.size(); idx++)
       {
@@ -8529,9 +8496,13 @@ namespace LegionRuntime {
       if (redop != 0)
       {
         if (speculation_state != RESOLVE_FALSE_STATE)
+        {
+          // The future copies the reduction state, which was made with
+          // legion_malloc so we keep it and free it on deactivation
           reduction_future.impl->set_result(reduction_state,
                                             reduction_state_size, 
                                             false/*owner*/);
+        }
         reduction_future.impl->complete_future();
       }
       else
@@ -8682,10 +8653,8 @@ namespace LegionRuntime {
       LegionLogging::log_index_slice(Processor::get_executing_processor(),
                                      unique_op_id, result->get_unique_op_id());
 #endif
-#ifdef LEGION_SPY
       LegionSpy::log_index_slice(get_unique_task_id(), 
                                  result->get_unique_task_id());
-#endif
       return result;
     }
 
@@ -9492,9 +9461,7 @@ namespace LegionRuntime {
       LegionLogging::log_slice_slice(Processor::get_executing_processor(),
                                      remote_unique_id, get_unique_task_id());
 #endif
-#ifdef LEGION_SPY
       LegionSpy::log_slice_slice(remote_unique_id, get_unique_task_id());
-#endif
       num_unmapped_points = num_points;
       num_uncomplete_points = num_points;
       num_uncommitted_points = num_points;
@@ -9512,11 +9479,9 @@ namespace LegionRuntime {
                                        point->get_unique_task_id(),
                                        point->index_point);
 #endif
-#ifdef LEGION_SPY
         LegionSpy::log_slice_point(get_unique_task_id(), 
                                    point->get_unique_task_id(),
                                    point->index_point);
-#endif
       }
       // Return true to add this to the ready queue
       return true;
@@ -9552,10 +9517,8 @@ namespace LegionRuntime {
       LegionLogging::log_slice_slice(Processor::get_executing_processor(),
                                      unique_op_id, result->get_unique_op_id());
 #endif
-#ifdef LEGION_SPY
       LegionSpy::log_slice_slice(get_unique_task_id(), 
                                  result->get_unique_task_id());
-#endif
       return result;
     }
 
@@ -9648,11 +9611,9 @@ namespace LegionRuntime {
                                      result->get_unique_op_id(),
                                      result->index_point);
 #endif
-#ifdef LEGION_SPY
       LegionSpy::log_slice_point(get_unique_task_id(), 
                                  result->get_unique_task_id(),
                                  result->index_point);
-#endif
       return result;
     }
 
@@ -549,12 +549,10 @@ namespace LegionRuntime {
       // region trees or different fields to premap in parallel.
       std::map<RegionTreeID,
                LegionMap<Event,FieldMask>::aligned > premapping_events;
-#if defined(LEGION_LOGGING) || defined(LEGION_SPY)
     protected:
       Event legion_spy_start;
     public:
       inline Event get_start_event(void) { return legion_spy_start; }
-#endif
     };
 
     /**
@@ -904,10 +902,8 @@ namespace LegionRuntime {
       void add_top_region(LogicalRegion handle);
     protected:
       std::set<LogicalRegion> top_level_regions;
-#if defined(LEGION_LOGGING) || defined(LEGION_SPY)
     protected:
       Event remote_legion_spy_completion;
-#endif
     };
 
     /**
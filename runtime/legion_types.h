@@ -370,6 +370,7 @@ namespace LegionRuntime {
     typedef LowLevel::Machine Machine;
     typedef LowLevel::Domain Domain;
     typedef LowLevel::DomainPoint DomainPoint;
+    typedef LowLevel::InstanceOrder InstanceOrder;
     typedef LowLevel::IndexSpaceAllocator IndexSpaceAllocator;
     typedef LowLevel::RegionInstance PhysicalInstance;
     typedef LowLevel::Memory Memory;
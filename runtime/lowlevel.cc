@@ -137,20 +137,22 @@ namespace LegionRuntime {
             continue;
           BarrierImpl *b = n->barriers.lookup_entry(j, i/*node*/); 
           AutoHSLLock a2(b->mutex);
+          std::vector<BarrierImpl::Generation*> gens;
+          b->get_tracked_generations(gens);
           // skip any barriers with no waiters
-          if (b->generations.empty())
+          if (gens.empty())
             continue;
 
           fprintf(f,"Barrier " IDFMT ": gen=%d subscr=%d\n",
                   b->me.id(), b->generation, b->gen_subscribed);
-          for (std::map<Event::gen_t, BarrierImpl::Generation*>::const_iterator git = 
-                b->generations.begin(); git != b->generations.end(); git++)
+          for (std::vector<BarrierImpl::Generation*>::const_iterator git = 
+                gens.begin(); git != gens.end(); git++)
           {
-            const std::vector<EventWaiter*> &waiters = git->second->local_waiters;
+            const std::vector<EventWaiter*> &waiters = (*git)->local_waiters;
             for (std::vector<EventWaiter*>::const_iterator it = 
                   waiters.begin(); it != waiters.end(); it++)
             {
-              fprintf(f, "  [%d] L:%p ", git->first, *it);
+              fprintf(f, "  [%d] L:%p ", (*git)->gen, *it);
               (*it)->print_info(f);
             }
           }
@@ -1795,6 +1797,66 @@ namespace LegionRuntime {
     template void *AccessorType::Generic::Untyped::raw_dense_ptr<1>(const Rect<1>& r, Rect<1>& subrect, ByteOffset &elem_stride);
     template void *AccessorType::Generic::Untyped::raw_dense_ptr<2>(const Rect<2>& r, Rect<2>& subrect, ByteOffset &elem_stride);
     template void *AccessorType::Generic::Untyped::raw_dense_ptr<3>(const Rect<3>& r, Rect<3>& subrect, ByteOffset &elem_stride);
+
+    template <unsigned DIM>
+    void AccessorType::Generic::Untyped::read_untyped(const Point<DIM>& p, void *dst, size_t bytes, off_t offset) const
+    {
+      read_untyped(DomainPoint::from_point<DIM>(p), dst, bytes, offset);
+    }
+
+    template <unsigned DIM>
+    void AccessorType::Generic::Untyped::write_untyped(const Point<DIM>& p, const void *src, size_t bytes, off_t offset) const
+    {
+      write_untyped(DomainPoint::from_point<DIM>(p), src, bytes, offset);
+    }
+
+    template <int DIM>
+    bool AccessorType::Generic::Untyped::get_affine_parameters(const Rect<DIM>& bounds, void *&base, ByteOffset *strides) const
+    {
+      Rect<DIM> subrect;
+      return(get_affine_parameters<DIM>(bounds, subrect, base, strides) && (subrect == bounds));
+    }
+
+    template <int DIM>
+    bool AccessorType::Generic::Untyped::get_affine_parameters(const Rect<DIM>& bounds, Rect<DIM>& subrect,
+							       void *&base, ByteOffset *strides) const
+    {
+      RegionInstanceImpl *impl = (RegionInstanceImpl *) internal;
+
+      // must have valid data by now - block if we have to
+      impl->metadata.await_data();
+
+      if(impl->metadata.linearization.get_dim() != DIM) return false;
+      // reduction lists aren't indexed by point at all
+      if((impl->metadata.redopid != 0) && (impl->metadata.red_list_size > 0)) return false;
+      // hybrid SOA changes stride at every block boundary, which raw_rect_ptr
+      //  doesn't trim for
+      if((impl->metadata.block_size > 1) &&
+	 ((impl->metadata.block_size * impl->metadata.elmt_size) < impl->metadata.size))
+	return false;
+
+      char *ptr = (char *)(const_cast<Untyped *>(this)->raw_rect_ptr<DIM>(bounds, subrect, strides));
+      if(!ptr) return false;
+
+      // move the base to where point 0 would be so callers can use points as is
+      for(int i = 0; i < DIM; i++)
+	ptr -= bounds.lo.x[i] * strides[i].offset;
+      base = ptr;
+      return true;
+    }
+
+    template void AccessorType::Generic::Untyped::read_untyped<1>(const Point<1>& p, void *dst, size_t bytes, off_t offset) const;
+    template void AccessorType::Generic::Untyped::read_untyped<2>(const Point<2>& p, void *dst, size_t bytes, off_t offset) const;
+    template void AccessorType::Generic::Untyped::read_untyped<3>(const Point<3>& p, void *dst, size_t bytes, off_t offset) const;
+    template void AccessorType::Generic::Untyped::write_untyped<1>(const Point<1>& p, const void *src, size_t bytes, off_t offset) const;
+    template void AccessorType::Generic::Untyped::write_untyped<2>(const Point<2>& p, const void *src, size_t bytes, off_t offset) const;
+    template void AccessorType::Generic::Untyped::write_untyped<3>(const Point<3>& p, const void *src, size_t bytes, off_t offset) const;
+    template bool AccessorType::Generic::Untyped::get_affine_parameters<1>(const Rect<1>& bounds, void *&base, ByteOffset *strides) const;
+    template bool AccessorType::Generic::Untyped::get_affine_parameters<2>(const Rect<2>& bounds, void *&base, ByteOffset *strides) const;
+    template bool AccessorType::Generic::Untyped::get_affine_parameters<3>(const Rect<3>& bounds, void *&base, ByteOffset *strides) const;
+    template bool AccessorType::Generic::Untyped::get_affine_parameters<1>(const Rect<1>& bounds, Rect<1>& subrect, void *&base, ByteOffset *strides) const;
+    template bool AccessorType::Generic::Untyped::get_affine_parameters<2>(const Rect<2>& bounds, Rect<2>& subrect, void *&base, ByteOffset *strides) const;
+    template bool AccessorType::Generic::Untyped::get_affine_parameters<3>(const Rect<3>& bounds, Rect<3>& subrect, void *&base, ByteOffset *strides) const;
   };
 
   namespace Arrays {
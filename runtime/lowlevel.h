@@ -53,6 +53,7 @@ namespace LegionRuntime {
     typedef Realm::ElementMask ElementMask;
     typedef Realm::Domain Domain;
     typedef Realm::DomainPoint DomainPoint;
+    typedef Realm::InstanceOrder InstanceOrder;
     typedef Realm::DomainLinearization DomainLinearization;
     typedef Realm::Machine Machine;
     typedef Realm::Runtime Runtime;
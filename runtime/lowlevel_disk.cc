@@ -61,9 +61,10 @@ namespace Realm {
     }
 
     void DiskMemory::destroy_instance(RegionInstance i,
-				     bool local_destroy)
+				     bool local_destroy,
+				     MetadataInvalidationBatch *batch)
     {
-      destroy_instance_local(i, local_destroy);
+      destroy_instance_local(i, local_destroy, batch);
     }
 
     off_t DiskMemory::alloc_bytes(size_t size)
@@ -206,7 +207,8 @@ namespace Realm {
     }
 
     void HDFMemory::destroy_instance(RegionInstance i,
-				     bool local_destroy)
+				     bool local_destroy,
+				     MetadataInvalidationBatch *batch)
     {
       HDFMetadata* new_hdf = hdf_metadata[i.id];
       assert(new_hdf->dataset_ids.size() == new_hdf->datatype_ids.size());
@@ -218,7 +220,7 @@ namespace Realm {
       new_hdf->dataset_ids.clear();
       new_hdf->datatype_ids.clear();
       delete new_hdf;
-      destroy_instance_local(i, local_destroy);
+      destroy_instance_local(i, local_destroy, batch);
     }
 
     off_t HDFMemory::alloc_bytes(size_t size)
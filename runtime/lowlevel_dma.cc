@@ -21,6 +21,11 @@
 #include "realm/threads.h"
 #include <errno.h>
 #include <aio.h>
+#include <unistd.h>
+#include <stdint.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 #include <queue>
 
@@ -89,6 +94,8 @@ namespace LegionRuntime {
 
       void start_workers(int count);
 
+      int num_workers(void) const { return worker_threads.size(); }
+
       void worker_thread_loop(void);
 
     protected:
@@ -263,9 +270,11 @@ namespace LegionRuntime {
       virtual bool handler_safe(void) { return(false); }
 
       template<int DIM>
-      void perform_dma_rect(MemoryImpl *mem_impl);
+      void perform_dma_rect(void);
 
-      size_t optimize_fill_buffer(RegionInstanceImpl *impl, int &fill_elmts);
+      void fill_elements(int dst_index, int elem_count);
+
+      void build_batch_buffer(size_t max_batch_bytes);
 
       Domain domain;
       Domain::CopySrcDstField dst;
@@ -273,6 +282,16 @@ namespace LegionRuntime {
       size_t fill_size;
       Event before_fill;
       Waiter waiter;
+
+      // set up by perform_dma for the target instance
+      MemoryImpl *mem_impl;
+      RegionInstanceImpl *inst_impl;
+      off_t field_start;
+      int field_size;
+      char *direct_base;  // memories we can write directly, or 0
+      bool streaming;     // use non-temporal stores for direct writes
+      void *batch_buffer; // fill value repeated batch_elmts times
+      int batch_elmts;
     };
 
     DmaRequestQueue::DmaRequestQueue(Realm::CoreReservationSet& crs)
@@ -599,6 +618,27 @@ namespace LegionRuntime {
           }
 	}
 
+	// request metadata for all the instances at once so that each owner
+	//  node sees a single request
+	{
+	  std::vector<ID::IDType> inst_ids;
+	  for(OASByInst::iterator it = oas_by_inst->begin(); it != oas_by_inst->end(); it++) {
+	    inst_ids.push_back(it->first.first.id);
+	    inst_ids.push_back(it->first.second.id);
+	  }
+
+	  Event e = MetadataBase::request_data_bulk(inst_ids);
+	  if(!e.has_triggered()) {
+	    if(just_check) {
+	      log_dma.info("dma request %p - no instance metadata yet", this);
+	      return false;
+	    }
+	    log_dma.info("request %p - instance metadata invalid - sleeping on event " IDFMT "/%d", this, e.id, e.gen);
+	    waiter.sleep_on_event(e);
+	    return false;
+	  }
+	}
+
 	// now go through all instance pairs
 	for(OASByInst::iterator it = oas_by_inst->begin(); it != oas_by_inst->end(); it++) {
 	  RegionInstanceImpl *src_impl = get_runtime()->get_instance_impl(it->first.first);
@@ -3302,6 +3342,28 @@ namespace LegionRuntime {
           }
 	}
 
+	// request metadata for all the instances at once so that each owner
+	//  node sees a single request
+	{
+	  std::vector<ID::IDType> inst_ids;
+	  for(std::vector<Domain::CopySrcDstField>::iterator it = srcs.begin();
+	      it != srcs.end();
+	      it++)
+	    inst_ids.push_back(it->inst.id);
+	  inst_ids.push_back(dst.inst.id);
+
+	  Event e = MetadataBase::request_data_bulk(inst_ids);
+	  if(!e.has_triggered()) {
+	    if(just_check) {
+	      log_dma.info("dma request %p - no instance metadata yet", this);
+	      return false;
+	    }
+	    log_dma.info("request %p - instance metadata invalid - sleeping on event " IDFMT "/%d", this, e.id, e.gen);
+	    waiter.sleep_on_event(e);
+	    return false;
+	  }
+	}
+
 	// now go through all source instance pairs
 	for(std::vector<Domain::CopySrcDstField>::iterator it = srcs.begin();
 	    it != srcs.end();
@@ -3769,7 +3831,8 @@ namespace LegionRuntime {
                              unsigned offset, unsigned size,
                              Event _before_fill, Event _after_fill,
                              int _priority)
-      : DmaRequest(_priority, _after_fill), before_fill(_before_fill)
+      : DmaRequest(_priority, _after_fill), before_fill(_before_fill),
+        batch_buffer(0)
     {
       dst.inst = inst;
       dst.offset = offset;
@@ -3801,7 +3864,7 @@ namespace LegionRuntime {
                              Event _before_fill, Event _after_fill, int _priority,
                              const Realm::ProfilingRequestSet &reqs)
       : DmaRequest(_priority, _after_fill, reqs), domain(d), dst(_dst),
-        before_fill(_before_fill)
+        before_fill(_before_fill), batch_buffer(0)
     {
       fill_size = _fill_size;
       fill_buffer = malloc(fill_size);
@@ -3812,6 +3875,7 @@ namespace LegionRuntime {
     {
       // clean up our mess
       free(fill_buffer);
+      free(batch_buffer);
     }
 
     size_t FillRequest::compute_size(void)
@@ -3922,85 +3986,175 @@ namespace LegionRuntime {
       return false;
     }
 
+    // fills larger than the last level cache use non-temporal stores so
+    //  they don't evict everything else on the way through
+    static size_t nontemporal_fill_threshold(void)
+    {
+      static size_t threshold = 0;
+      if(threshold == 0) {
+	size_t llc_size = 8 << 20;
+#ifdef _SC_LEVEL3_CACHE_SIZE
+	long l3 = sysconf(_SC_LEVEL3_CACHE_SIZE);
+	if(l3 > 0)
+	  llc_size = l3;
+#endif
+	threshold = llc_size;
+      }
+      return threshold;
+    }
+
+    static inline void fill_pattern_bytes(char *dst, const char *pattern,
+					  size_t pattern_size, size_t phase,
+					  size_t bytes)
+    {
+      for(size_t i = 0; i < bytes; i++)
+	dst[i] = pattern[(phase + i) % pattern_size];
+    }
+
+    // writes 'count' back-to-back copies of a pattern to 'dst'
+    static void fill_pattern(char *dst, const void *pattern, size_t pattern_size,
+			     size_t count, bool streaming)
+    {
+      const char *p = (const char *)pattern;
+      size_t bytes = pattern_size * count;
+      if(bytes == 0) return;
+
+      // patterns made of a single repeated byte (e.g. zero) are memsets
+      {
+	bool same = true;
+	for(size_t i = 1; same && (i < pattern_size); i++)
+	  same = (p[i] == p[0]);
+	if(same) {
+	  memset(dst, p[0], bytes);
+	  return;
+	}
+      }
+
+#ifdef __SSE2__
+      // big fills bypass the cache with aligned 16B non-temporal stores of
+      //  a precomputed period of the pattern (lcm(pattern_size, 16) bytes) -
+      //  patterns with too large a period use ordinary copies
+      static const size_t MAX_PERIOD = 256;
+      size_t period = 16;
+      while((period % pattern_size) != 0)
+	period += 16;
+      if(streaming && (period <= MAX_PERIOD) && (bytes >= 2 * period)) {
+	size_t head = (16 - (((uintptr_t)dst) & 15)) & 15;
+	fill_pattern_bytes(dst, p, pattern_size, 0, head);
+
+	char period_buffer[MAX_PERIOD] __attribute__((aligned(16)));
+	fill_pattern_bytes(period_buffer, p, pattern_size, head, period);
+	const size_t nvec = period / 16;
+	__m128i vec[MAX_PERIOD / 16];
+	for(size_t i = 0; i < nvec; i++)
+	  vec[i] = _mm_load_si128((const __m128i *)(period_buffer + 16 * i));
+
+	size_t body = ((bytes - head) / period) * period;
+	__m128i *out = (__m128i *)(dst + head);
+	__m128i *out_end = (__m128i *)(dst + head + body);
+	if(nvec == 1) {
+	  while(out < out_end)
+	    _mm_stream_si128(out++, vec[0]);
+	} else {
+	  while(out < out_end)
+	    for(size_t i = 0; i < nvec; i++)
+	      _mm_stream_si128(out++, vec[i]);
+	}
+
+	size_t done = head + body;
+	fill_pattern_bytes(dst + done, p, pattern_size, done % pattern_size,
+			   bytes - done);
+	return;
+      }
+#endif
+
+      // otherwise double the filled region each time
+      memcpy(dst, p, pattern_size);
+      size_t filled = pattern_size;
+      while(filled < bytes) {
+	size_t todo = ((bytes - filled) < filled) ? (bytes - filled) : filled;
+	memcpy(dst + filled, dst, todo);
+	filled += todo;
+      }
+    }
+
     void FillRequest::perform_dma(void)
     {
-      // First switch on the memory type
-      MemoryImpl *mem_impl = get_runtime()->get_memory_impl(dst.inst.get_location());
+      mem_impl = get_runtime()->get_memory_impl(dst.inst.get_location());
+      inst_impl = get_runtime()->get_instance_impl(dst.inst);
+      find_field_start(inst_impl->metadata.field_sizes, dst.offset,
+                       dst.size, field_start, field_size);
+      assert(field_size <= int(fill_size));
 
+      // CPU-visible memories are written in place (copying from a buffer
+      //  that stays in the L1, or with non-temporal stores for big fills),
+      //  everything else goes through put_bytes, in batches that are as
+      //  large as possible
       MemoryImpl::MemoryKind mem_kind = mem_impl->kind;
       if ((mem_kind == MemoryImpl::MKIND_SYSMEM) ||
-          (mem_kind == MemoryImpl::MKIND_ZEROCOPY) ||
-          (mem_kind == MemoryImpl::MKIND_RDMA))
+          (mem_kind == MemoryImpl::MKIND_ZEROCOPY))
       {
-        switch (domain.get_dim()) {
-          case 0:
-            {
-              // Iterate over all the points and get the 
-              IndexSpaceImpl *ispace = get_runtime()->get_index_space_impl(domain.get_index_space());
-              assert(ispace->valid_mask_complete);
-              RegionInstanceImpl *inst_impl = get_runtime()->get_instance_impl(dst.inst);
-              off_t field_start; int field_size;
-              find_field_start(inst_impl->metadata.field_sizes, dst.offset,
-                               dst.size, field_start, field_size);
-              assert(field_size <= int(fill_size));
-              int fill_elmts = 1;
-              // Optimize our buffer for the target instance
-              size_t fill_elmts_size = optimize_fill_buffer(inst_impl, fill_elmts);
-              Arrays::Mapping<1, 1> *dst_linearization = 
-                inst_impl->metadata.linearization.get_mapping<1>();
-              ElementMask::Enumerator *e = ispace->valid_mask->enumerate_enabled();
-              int rstart, elem_count;
-              while(e->get_next(rstart, elem_count)) {
-                int dst_index = dst_linearization->image(rstart); 
-                int done = 0;
-                while (done < elem_count) {
-                  int dst_in_this_block = inst_impl->metadata.block_size - 
-                              ((dst_index + done) % inst_impl->metadata.block_size);
-                  int todo = min(elem_count, dst_in_this_block);
-                  off_t dst_start = calc_mem_loc(inst_impl->metadata.alloc_offset,
-                                                 field_start, field_size, 
-                                                 inst_impl->metadata.elmt_size,
-                                                 inst_impl->metadata.block_size,
-                                                 dst_index + done);
-                  // Record how many we've done
-                  done += todo;
-                  // Now do as many bulk transfers as we can
-                  while (todo >= fill_elmts) {
-                    mem_impl->put_bytes(dst_start, fill_buffer, fill_elmts_size);
-                    dst_start += fill_elmts_size;
-                    todo -= fill_elmts;
-                  }
-                  // Handle any remainder elemts
-                  if (todo > 0) {
-                    mem_impl->put_bytes(dst_start, fill_buffer, todo*fill_size);
-                  }
-                }
-              }
-              delete e;
-              break;
-            }
-          case 1:
-            {
-              perform_dma_rect<1>(mem_impl);
-              break;
-            }
-          case 2:
-            {
-              perform_dma_rect<2>(mem_impl); 
-              break;
-            }
-          case 3:
-            {
-              perform_dma_rect<3>(mem_impl); 
-              break;
-            }
-          default:
-            assert(false);
-        }
+        direct_base = ((char *)(mem_impl->get_direct_ptr(inst_impl->metadata.alloc_offset,
+                                                         inst_impl->metadata.size)) -
+                       inst_impl->metadata.alloc_offset);
+        streaming = ((domain.get_volume() * fill_size) >= nontemporal_fill_threshold());
+        build_batch_buffer(4 << 10);
       } else {
-        // TODO: Implement GASNet, Disk, and Framebuffer
+        direct_base = 0;
+        streaming = false;
+#ifdef USE_HDF
+        // HDF instances can only be written a point at a time
+        if (mem_kind == MemoryImpl::MKIND_HDF)
+        {
+          log_dma.warning("fill of instance " IDFMT " in HDF memory " IDFMT " not supported",
+                          dst.inst.id, dst.inst.get_location().id);
+          return;
+        }
+#endif
+        build_batch_buffer(1 << 20);
       }
 
+      switch (domain.get_dim()) {
+        case 0:
+          {
+            // Iterate over all the points and get the 
+            IndexSpaceImpl *ispace = get_runtime()->get_index_space_impl(domain.get_index_space());
+            assert(ispace->valid_mask_complete);
+            Arrays::Mapping<1, 1> *dst_linearization = 
+              inst_impl->metadata.linearization.get_mapping<1>();
+            ElementMask::Enumerator *e = ispace->valid_mask->enumerate_enabled();
+            int rstart, elem_count;
+            while(e->get_next(rstart, elem_count))
+              fill_elements(dst_linearization->image(rstart), elem_count);
+            delete e;
+            break;
+          }
+        case 1:
+          {
+            perform_dma_rect<1>();
+            break;
+          }
+        case 2:
+          {
+            perform_dma_rect<2>(); 
+            break;
+          }
+        case 3:
+          {
+            perform_dma_rect<3>(); 
+            break;
+          }
+        default:
+          assert(false);
+      }
+
+#ifdef __SSE2__
+      // non-temporal stores have to be visible before anybody is told
+      //  the fill is done
+      if (streaming)
+        _mm_sfence();
+#endif
+
       if(measurements.wants_measurement<Realm::ProfilingMeasurements::OperationMemoryUsage>()) {
         Realm::ProfilingMeasurements::OperationMemoryUsage usage;
         usage.source = Memory::NO_MEMORY;
@@ -4010,76 +4164,94 @@ namespace LegionRuntime {
     }
 
     template<int DIM>
-    void FillRequest::perform_dma_rect(MemoryImpl *mem_impl)
+    void FillRequest::perform_dma_rect(void)
     {
-      RegionInstanceImpl *inst_impl = get_runtime()->get_instance_impl(dst.inst);
-      off_t field_start; int field_size;
-      find_field_start(inst_impl->metadata.field_sizes, dst.offset,
-                       dst.size, field_start, field_size);
-      assert(field_size <= (int)fill_size);
       typename Arrays::Mapping<DIM, 1> *dst_linearization = 
         inst_impl->metadata.linearization.get_mapping<DIM>();
       typename Arrays::Rect<DIM> rect = domain.get_rect<DIM>();
-      int fill_elmts = 1;
-      // Optimize our buffer for the target instance
-      size_t fill_elmts_size = optimize_fill_buffer(inst_impl, fill_elmts);
+      // a linear subrect is only contiguous if its strides line up (e.g.
+      //  not for a partial tile of a tiled instance), so fill dense pieces
       for (typename Arrays::Mapping<DIM, 1>::LinearSubrectIterator lso(rect, 
             *dst_linearization); lso; lso++) {
-        int dst_index = lso.image_lo[0];
-        int elem_count = lso.subrect.volume();
-        int done = 0; 
-        while (done < elem_count) {
-          int dst_in_this_block = inst_impl->metadata.block_size - 
-                      ((dst_index + done) % inst_impl->metadata.block_size);
-          int todo = min(elem_count, dst_in_this_block);
-          off_t dst_start = calc_mem_loc(inst_impl->metadata.alloc_offset,
-                                         field_start, field_size, 
-                                         inst_impl->metadata.elmt_size,
-                                         inst_impl->metadata.block_size,
-                                         dst_index + done);
-          // Record how many we've done
-          done += todo;
-          // Now do as many bulk transfers as we can
-          while (todo >= fill_elmts) {
-            mem_impl->put_bytes(dst_start, fill_buffer, fill_elmts_size); 
-            dst_start += fill_elmts_size;
-            todo -= fill_elmts;
-          }
-          // Handle any remainder elemts
-          if (todo > 0) {
-            mem_impl->put_bytes(dst_start, fill_buffer, todo*fill_size);
-          }
-        }
+        for (typename Arrays::Mapping<DIM, 1>::DenseSubrectIterator dso(
+              lso.subrect, *dst_linearization); dso; dso++)
+          fill_elements(dso.image.lo[0], dso.subrect.volume());
       }
     }
 
-    size_t FillRequest::optimize_fill_buffer(RegionInstanceImpl *inst_impl, int &fill_elmts)
+    // fills elem_count elements of the field starting at linearized index
+    //  dst_index
+    void FillRequest::fill_elements(int dst_index, int elem_count)
     {
-      const size_t max_size = 1024; 
-      // Only do this optimization for "small" fields
-      // which are less than half a page
-      if (fill_size <= max_size)
+      const int block_size = inst_impl->metadata.block_size;
+      const size_t elmt_size = inst_impl->metadata.elmt_size;
+      // AOS instances interleave the fields, so the elements are strided
+      if ((block_size == 1) && (direct_base != 0))
       {
-        // If we have a single-field instance or we have a set 
-        // of contiguous elmts then make a bulk buffer to use
-        if ((inst_impl->metadata.elmt_size == fill_size) ||
-            (inst_impl->metadata.block_size > 1)) 
+        char *dst_ptr = direct_base + calc_mem_loc(inst_impl->metadata.alloc_offset,
+                                                   field_start, field_size, 
+                                                   elmt_size, block_size,
+                                                   dst_index);
+        switch (fill_size) {
+          case 4:
+            for (int i = 0; i < elem_count; i++, dst_ptr += elmt_size)
+              *(uint32_t *)dst_ptr = *(const uint32_t *)fill_buffer;
+            break;
+          case 8:
+            for (int i = 0; i < elem_count; i++, dst_ptr += elmt_size)
+              *(uint64_t *)dst_ptr = *(const uint64_t *)fill_buffer;
+            break;
+          default:
+            for (int i = 0; i < elem_count; i++, dst_ptr += elmt_size)
+              memcpy(dst_ptr, fill_buffer, fill_size);
+        }
+        return;
+      }
+      int done = 0;
+      while (done < elem_count) {
+        int dst_in_this_block = block_size - ((dst_index + done) % block_size);
+        int todo = min(elem_count - done, dst_in_this_block);
+        off_t dst_start = calc_mem_loc(inst_impl->metadata.alloc_offset,
+                                       field_start, field_size, 
+                                       elmt_size, block_size,
+                                       dst_index + done);
+        // Record how many we've done
+        done += todo;
+        // non-temporal stores only pay off for runs of whole cache lines
+        if (streaming && ((todo * fill_size) >= 4096))
         {
-          fill_elmts = min(inst_impl->metadata.block_size,2*max_size/fill_size);
-          size_t fill_elmts_size = fill_elmts * fill_size;
-          char *next_buffer = (char*)malloc(fill_elmts_size);
-          char *next_ptr = next_buffer;
-          for (int idx = 0; idx < fill_elmts; idx++) {
-            memcpy(next_ptr, fill_buffer, fill_size);
-            next_ptr += fill_size;
-          }
-          // Free the old buffer and replace it
-          free(fill_buffer);
-          fill_buffer = next_buffer;
-          return fill_elmts_size;
+          fill_pattern(direct_base + dst_start, fill_buffer, fill_size,
+                       todo, true/*streaming*/);
+          continue;
+        }
+        // Now do as many bulk transfers as we can
+        while (todo > 0) {
+          int count = min(todo, batch_elmts);
+          if (direct_base != 0)
+            memcpy(direct_base + dst_start, batch_buffer, count * fill_size);
+          else
+            mem_impl->put_bytes(dst_start, batch_buffer, count * fill_size);
+          dst_start += count * fill_size;
+          todo -= count;
         }
       }
-      return fill_size;
+    }
+
+    // builds a buffer of repeated fill values to copy from - memories
+    //  without direct pointers (disk, GASNet, framebuffer, ...) use a big
+    //  one so they see a few large put_bytes calls instead of many small ones
+    void FillRequest::build_batch_buffer(size_t max_batch_bytes)
+    {
+      size_t elmts = max_batch_bytes / fill_size;
+      if (elmts > inst_impl->metadata.block_size)
+        elmts = inst_impl->metadata.block_size;
+      if (elmts > domain.get_volume())
+        elmts = domain.get_volume();
+      if (elmts < 1)
+        elmts = 1;
+      batch_elmts = elmts;
+      batch_buffer = malloc(elmts * fill_size);
+      fill_pattern((char *)batch_buffer, fill_buffer, fill_size, elmts, false);
     }
 
 #if 0
@@ -4164,6 +4336,25 @@ namespace LegionRuntime {
       dma_queue = 0;
     }
 
+    // splits a rectangle into (up to) 'pieces' slabs along its last
+    //  dimension
+    template <int DIM>
+    static void split_fill_domain(const Domain& d, size_t pieces,
+				  std::vector<Domain>& subdomains)
+    {
+      Arrays::Rect<DIM> r = d.get_rect<DIM>();
+      int lo = r.lo.x[DIM - 1];
+      size_t extent = r.hi.x[DIM - 1] - lo + 1;
+      if(pieces > extent)
+	pieces = extent;
+      for(size_t i = 0; i < pieces; i++) {
+	Arrays::Rect<DIM> subrect = r;
+	subrect.lo.x[DIM - 1] = lo + (extent * i) / pieces;
+	subrect.hi.x[DIM - 1] = lo + (extent * (i + 1)) / pieces - 1;
+	subdomains.push_back(Domain::from_rect<DIM>(subrect));
+      }
+    }
+
   };
 };
 
@@ -4184,35 +4375,59 @@ namespace Realm {
                        const void *fill_value, size_t fill_value_size,
                        Event wait_on /*= Event::NO_EVENT*/) const
     {
+      // large rectangular fills are split into one piece per DMA worker
+      //  (but not below a few MB each) so the workers can share them - this
+      //  isn't done when profiling is requested, as each piece would report
+      //  separately
+      const size_t min_fill_piece_bytes = 4 << 20;
       std::set<Event> finish_events; 
       for (std::vector<CopySrcDstField>::const_iterator it = dsts.begin();
             it != dsts.end(); it++)
       {
-        Event ev = GenEventImpl::create_genevent()->current_event();
-        FillRequest *r = new FillRequest(*this, *it, fill_value,
-                                         fill_value_size, wait_on,
-                                         ev, 0/*priority*/, requests);
-        Memory mem = it->inst.get_location();
-        int node = ID(mem).node();
-        if (((unsigned)node) == gasnet_mynode()) {
-          r->check_readiness(false, dma_queue);
-        } else {
-          RemoteFillArgs args;
-          args.inst = it->inst;
-          args.offset = it->offset;
-          args.size = it->size;
-          args.before_fill = wait_on;
-          args.after_fill = ev;
-          //args.priority = 0;
+        std::vector<Domain> pieces;
+        size_t max_pieces = (get_volume() * it->size) / min_fill_piece_bytes;
+        if (max_pieces > (size_t)dma_queue->num_workers())
+          max_pieces = dma_queue->num_workers();
+        if ((get_dim() > 0) && (max_pieces > 1) && requests.empty())
+        {
+          switch (get_dim()) {
+            case 1: split_fill_domain<1>(*this, max_pieces, pieces); break;
+            case 2: split_fill_domain<2>(*this, max_pieces, pieces); break;
+            case 3: split_fill_domain<3>(*this, max_pieces, pieces); break;
+            default: assert(false);
+          }
+        }
+        else
+          pieces.push_back(*this);
+        for (std::vector<Domain>::const_iterator pit = pieces.begin();
+              pit != pieces.end(); pit++)
+        {
+          Event ev = GenEventImpl::create_genevent()->current_event();
+          FillRequest *r = new FillRequest(*pit, *it, fill_value,
+                                           fill_value_size, wait_on,
+                                           ev, 0/*priority*/, requests);
+          Memory mem = it->inst.get_location();
+          int node = ID(mem).node();
+          if (((unsigned)node) == gasnet_mynode()) {
+            r->check_readiness(false, dma_queue);
+          } else {
+            RemoteFillArgs args;
+            args.inst = it->inst;
+            args.offset = it->offset;
+            args.size = it->size;
+            args.before_fill = wait_on;
+            args.after_fill = ev;
+            //args.priority = 0;
 
-          size_t msglen = r->compute_size();
-          void *msgdata = malloc(msglen);
+            size_t msglen = r->compute_size();
+            void *msgdata = malloc(msglen);
 
-          r->serialize(msgdata);
+            r->serialize(msgdata);
 
-          RemoteFillMessage::request(node, args, msgdata, msglen, PAYLOAD_FREE);
+            RemoteFillMessage::request(node, args, msgdata, msglen, PAYLOAD_FREE);
+          }
+          finish_events.insert(ev);
         }
-        finish_events.insert(ev);
       }
       return GenEventImpl::merge_events(finish_events);
     }
@@ -4394,6 +4609,7 @@ namespace Realm {
                                 enclosing.id, enclosing.gen,
                                 src_mem.id, dst_mem.id);
 #endif
+	  EventGraphRecorder::record(EventGraphRecorder::REC_COPY, ev, wait_on);
 
 	  int priority = 0;
 #ifdef USE_CUDA
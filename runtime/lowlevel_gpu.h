@@ -548,9 +548,10 @@ namespace LegionRuntime {
       }
 
       virtual void destroy_instance(RegionInstance i, 
-				    bool local_destroy)
+				    bool local_destroy,
+				    MetadataInvalidationBatch *batch)
       {
-	destroy_instance_local(i, local_destroy);
+	destroy_instance_local(i, local_destroy, batch);
       }
 
       virtual off_t alloc_bytes(size_t size)
@@ -605,9 +606,10 @@ namespace LegionRuntime {
       }
 
       virtual void destroy_instance(RegionInstance i, 
-				    bool local_destroy)
+				    bool local_destroy,
+				    MetadataInvalidationBatch *batch)
       {
-	destroy_instance_local(i, local_destroy);
+	destroy_instance_local(i, local_destroy, batch);
       }
 
       virtual off_t alloc_bytes(size_t size)
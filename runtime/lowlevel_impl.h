@@ -83,6 +83,7 @@ namespace LegionRuntime {
     typedef Realm::HDFMemory HDFMemory;
 #endif
     typedef Realm::MetadataBase MetadataBase;
+    typedef Realm::MetadataInvalidationBatch MetadataInvalidationBatch;
     typedef Realm::RegionInstanceImpl RegionInstanceImpl;
     typedef Realm::IndexSpaceImpl IndexSpaceImpl;
     typedef Realm::Node Node;
@@ -16,6 +16,7 @@
 
 #include "mapping_utilities.h"
 
+#include <cstdio>
 #include <algorithm>
 #include <limits>
 
@@ -1060,9 +1061,295 @@ namespace LegionRuntime {
       //------------------------------------------------------------------------
       {
       }
+
+      /************************
+       * Mapping Cache
+       ************************/
+
+      //------------------------------------------------------------------------
+      MappingCache::MappingCache(void)
+        : dirty(false)
+      //------------------------------------------------------------------------
+      {
+      }
+
+      // FNV-1a hash step for building machine fingerprints
+      static inline unsigned long long hash_value(unsigned long long hash,
+                                                  unsigned long long value)
+      {
+        for (unsigned idx = 0; idx < sizeof(value); idx++)
+        {
+          hash ^= (value >> (8*idx)) & 0xFF;
+          hash *= 0x100000001b3ULL;
+        }
+        return hash;
+      }
+
+      //------------------------------------------------------------------------
+      /*static*/ unsigned long long MappingCache::compute_machine_shape(
+                                                                Machine machine)
+      //------------------------------------------------------------------------
+      {
+        unsigned long long hash = 0xcbf29ce484222325ULL;
+        std::set<Processor> all_procs;
+        machine.get_all_processors(all_procs);
+        hash = hash_value(hash, all_procs.size());
+        for (std::set<Processor>::const_iterator it = all_procs.begin();
+              it != all_procs.end(); it++)
+        {
+          hash = hash_value(hash, it->id);
+          hash = hash_value(hash, it->kind());
+        }
+        std::set<Memory> all_mems;
+        machine.get_all_memories(all_mems);
+        hash = hash_value(hash, all_mems.size());
+        for (std::set<Memory>::const_iterator it = all_mems.begin();
+              it != all_mems.end(); it++)
+        {
+          hash = hash_value(hash, it->id);
+          hash = hash_value(hash, it->kind());
+          hash = hash_value(hash, it->capacity());
+        }
+        return hash;
+      }
+
+      //------------------------------------------------------------------------
+      bool MappingCache::load(const char *filename,
+                              unsigned long long machine_shape)
+      //------------------------------------------------------------------------
+      {
+        FILE *f = fopen(filename, "r");
+        if (f == NULL)
+          return false;
+        unsigned version = 0;
+        unsigned long long shape = 0;
+        if ((fscanf(f, "legion_mapping_cache %u %llx", &version, &shape) != 2)
+            || (version != CACHE_VERSION) || (shape != machine_shape))
+        {
+          fclose(f);
+          return false;
+        }
+        std::map<std::string,CachedTask> loaded;
+        bool success = true;
+        char tag[16];
+        while (success && (fscanf(f, "%15s", tag) == 1))
+        {
+          // Task names are length prefixed so they can contain anything
+          size_t name_len;
+          if ((strcmp(tag, "task") != 0) || 
+              (fscanf(f, "%zu", &name_len) != 1) || (fgetc(f) != ' '))
+          {
+            success = false;
+            break;
+          }
+          std::string name(name_len, '\0');
+          if ((name_len > 0) && (fread(&name[0], 1, name_len, f) != name_len))
+          {
+            success = false;
+            break;
+          }
+          CachedTask &entry = loaded[name];
+          int has_kind, kind;
+          size_t num_targets;
+          if (fscanf(f, "%d %d %zu", &has_kind, &kind, &num_targets) != 3)
+          {
+            success = false;
+            break;
+          }
+          entry.has_kind = (has_kind != 0);
+          entry.best_kind = (Processor::Kind)kind;
+          for (unsigned t = 0; success && (t < num_targets); t++)
+          {
+            unsigned long long target_id;
+            size_t num_regions;
+            if (fscanf(f, "%llx %zu", &target_id, &num_regions) != 2)
+            {
+              success = false;
+              break;
+            }
+            Processor target;
+            target.id = target_id;
+            std::vector<CachedRegion> &regions = entry.mappings[target];
+            regions.resize(num_regions);
+            for (unsigned idx = 0; idx < num_regions; idx++)
+            {
+              size_t num_mems;
+              if (fscanf(f, "%zu %zu", &regions[idx].blocking_factor,
+                         &num_mems) != 2)
+              {
+                success = false;
+                break;
+              }
+              regions[idx].ranking.resize(num_mems);
+              for (unsigned m = 0; m < num_mems; m++)
+              {
+                unsigned long long mem_id;
+                if (fscanf(f, "%llx", &mem_id) != 1)
+                {
+                  success = false;
+                  break;
+                }
+                regions[idx].ranking[m].id = mem_id;
+              }
+              if (!success)
+                break;
+            }
+          }
+        }
+        fclose(f);
+        if (!success)
+          return false;
+        cached_tasks.swap(loaded);
+        dirty = false;
+        return true;
+      }
+
+      //------------------------------------------------------------------------
+      bool MappingCache::save(const char *filename,
+                              unsigned long long machine_shape) const
+      //------------------------------------------------------------------------
+      {
+        // Write to a temporary file and rename it into place so that a
+        // crash in the middle of writing never leaves a truncated cache
+        std::string temp_name(filename);
+        temp_name += ".tmp";
+        FILE *f = fopen(temp_name.c_str(), "w");
+        if (f == NULL)
+          return false;
+        fprintf(f, "legion_mapping_cache %u %llx\n", CACHE_VERSION, 
+                machine_shape);
+        for (std::map<std::string,CachedTask>::const_iterator it = 
+              cached_tasks.begin(); it != cached_tasks.end(); it++)
+        {
+          fprintf(f, "task %zu ", it->first.size());
+          fwrite(it->first.data(), 1, it->first.size(), f);
+          fprintf(f, " %d %d %zu\n", (it->second.has_kind ? 1 : 0),
+                  (int)it->second.best_kind, it->second.mappings.size());
+          for (std::map<Processor,std::vector<CachedRegion> >::const_iterator
+                pit = it->second.mappings.begin(); 
+                pit != it->second.mappings.end(); pit++)
+          {
+            fprintf(f, "  %llx %zu\n", 
+                    (unsigned long long)pit->first.id, pit->second.size());
+            for (unsigned idx = 0; idx < pit->second.size(); idx++)
+            {
+              const CachedRegion &region = pit->second[idx];
+              fprintf(f, "    %zu %zu", region.blocking_factor,
+                      region.ranking.size());
+              for (unsigned m = 0; m < region.ranking.size(); m++)
+                fprintf(f, " %llx", (unsigned long long)region.ranking[m].id);
+              fprintf(f, "\n");
+            }
+          }
+        }
+        bool success = (fclose(f) == 0);
+        if (success)
+          success = (rename(temp_name.c_str(), filename) == 0);
+        else
+          remove(temp_name.c_str());
+        return success;
+      }
+
+      //------------------------------------------------------------------------
+      void MappingCache::merge(const MappingCache &rhs)
+      //------------------------------------------------------------------------
+      {
+        for (std::map<std::string,CachedTask>::const_iterator it = 
+              rhs.cached_tasks.begin(); it != rhs.cached_tasks.end(); it++)
+        {
+          CachedTask &entry = cached_tasks[it->first];
+          if (it->second.has_kind)
+          {
+            entry.has_kind = true;
+            entry.best_kind = it->second.best_kind;
+          }
+          for (std::map<Processor,std::vector<CachedRegion> >::const_iterator
+                pit = it->second.mappings.begin(); 
+                pit != it->second.mappings.end(); pit++)
+            entry.mappings[pit->first] = pit->second;
+        }
+        dirty = true;
+      }
+
+      //------------------------------------------------------------------------
+      bool MappingCache::recall_processor_kind(const char *task_name,
+                                               Processor::Kind &kind) const
+      //------------------------------------------------------------------------
+      {
+        if (task_name == NULL)
+          return false;
+        std::map<std::string,CachedTask>::const_iterator finder = 
+          cached_tasks.find(task_name);
+        if ((finder == cached_tasks.end()) || !finder->second.has_kind)
+          return false;
+        kind = finder->second.best_kind;
+        return true;
+      }
+
+      //------------------------------------------------------------------------
+      void MappingCache::record_processor_kind(const char *task_name,
+                                               Processor::Kind kind)
+      //------------------------------------------------------------------------
+      {
+        if (task_name == NULL)
+          return;
+        CachedTask &entry = cached_tasks[task_name];
+        if (entry.has_kind && (entry.best_kind == kind))
+          return;
+        entry.has_kind = true;
+        entry.best_kind = kind;
+        dirty = true;
+      }
+
+      //------------------------------------------------------------------------
+      bool MappingCache::recall_mapping(const char *task_name, 
+                                        Processor target, unsigned index,
+                                        std::vector<Memory> &ranking,
+                                        size_t &blocking_factor) const
+      //------------------------------------------------------------------------
+      {
+        if (task_name == NULL)
+          return false;
+        std::map<std::string,CachedTask>::const_iterator finder = 
+          cached_tasks.find(task_name);
+        if (finder == cached_tasks.end())
+          return false;
+        std::map<Processor,std::vector<CachedRegion> >::const_iterator 
+          target_finder = finder->second.mappings.find(target);
+        if ((target_finder == finder->second.mappings.end()) ||
+            (index >= target_finder->second.size()))
+          return false;
+        const CachedRegion &region = target_finder->second[index];
+        if (region.ranking.empty())
+          return false;
+        ranking = region.ranking;
+        blocking_factor = region.blocking_factor;
+        return true;
+      }
+
+      //------------------------------------------------------------------------
+      void MappingCache::record_mapping(const char *task_name, 
+                                        Processor target, unsigned index,
+                                        const std::vector<Memory> &ranking,
+                                        size_t blocking_factor)
+      //------------------------------------------------------------------------
+      {
+        if ((task_name == NULL) || ranking.empty())
+          return;
+        std::vector<CachedRegion> &regions = 
+          cached_tasks[task_name].mappings[target];
+        if (index >= regions.size())
+          regions.resize(index+1);
+        CachedRegion &region = regions[index];
+        if ((region.blocking_factor == blocking_factor) &&
+            (region.ranking == ranking))
+          return;
+        region.ranking = ranking;
+        region.blocking_factor = blocking_factor;
+        dirty = true;
+      }
     };
   };
 };
 
 // EOF
-
@@ -21,6 +21,7 @@
 
 #include <cstdlib>
 #include <cassert>
+#include <string>
 
 namespace LegionRuntime {
   namespace HighLevel {
@@ -288,6 +289,88 @@ namespace LegionRuntime {
         OptionMap profiling_options;
       };
 
+      /**
+       * The Mapping Cache persists the results of profiling and
+       * memoization across runs of the same application.  Entries
+       * are keyed by task name (task IDs are not guaranteed to be
+       * stable across runs) and the whole cache is tagged with a
+       * fingerprint of the machine shape so that a cache recorded
+       * on one machine configuration is never applied to another.
+       * The on-disk format is a versioned text file; files with a
+       * different version or machine shape are ignored on load.
+       */
+      class MappingCache {
+      public:
+        static const unsigned CACHE_VERSION = 1;
+      public:
+        MappingCache(void);
+      public:
+        /**
+         * Compute a fingerprint of the processors and memories
+         * (including their kinds and capacities) of the machine.
+         */
+        static unsigned long long compute_machine_shape(Machine machine);
+        /**
+         * Load the cache from a file.  Returns false if the file
+         * does not exist, is malformed, or was recorded with a
+         * different version or machine shape.
+         */
+        bool load(const char *filename, unsigned long long machine_shape);
+        /**
+         * Save the cache to a file.  Returns true on success.
+         */
+        bool save(const char *filename,
+                  unsigned long long machine_shape) const;
+        /**
+         * Check whether anything has been recorded since the last
+         * load or save.
+         */
+        bool is_dirty(void) const { return dirty; }
+        /**
+         * Merge the entries of another cache into this one.  Entries
+         * in the other cache take precedence over existing ones.
+         */
+        void merge(const MappingCache &rhs);
+      public:
+        /**
+         * Look up the best processor kind for the named task.
+         */
+        bool recall_processor_kind(const char *task_name,
+                                   Processor::Kind &kind) const;
+        void record_processor_kind(const char *task_name,
+                                   Processor::Kind kind);
+        /**
+         * Look up the memory ranking and blocking factor used for
+         * the index-th region requirement of the named task when
+         * it was mapped onto the target processor.
+         */
+        bool recall_mapping(const char *task_name, Processor target,
+                            unsigned index, std::vector<Memory> &ranking,
+                            size_t &blocking_factor) const;
+        void record_mapping(const char *task_name, Processor target,
+                            unsigned index, const std::vector<Memory> &ranking,
+                            size_t blocking_factor);
+      protected:
+        struct CachedRegion {
+        public:
+          CachedRegion(void) : blocking_factor(0) { }
+        public:
+          std::vector<Memory> ranking;
+          size_t blocking_factor;
+        };
+        struct CachedTask {
+        public:
+          CachedTask(void) : has_kind(false), best_kind(Processor::LOC_PROC) { }
+        public:
+          bool has_kind;
+          Processor::Kind best_kind;
+          std::map<Processor,std::vector<CachedRegion> > mappings;
+        };
+      protected:
+        std::map<std::string,CachedTask> cached_tasks;
+        bool dirty;
+      };
+
     };
   };
 };
@@ -0,0 +1,47 @@
+/* Copyright 2015 Stanford University, NVIDIA Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// asynchronous file I/O for Realm tasks
+
+#ifndef REALM_ASYNC_IO_H
+#define REALM_ASYNC_IO_H
+
+#include "lowlevel_config.h"
+
+#include "event.h"
+
+#include <sys/types.h>
+
+namespace Realm {
+
+    class AsyncIO {
+    public:
+      // reads or writes 'bytes' bytes at 'offset' in an open file - when called
+      //  from a task on an IO processor running in async mode (-ll:async_io),
+      //  the request is queued for that processor's I/O threads and the
+      //  returned event triggers when it's done, so a task can have many
+      //  requests in flight and only wait on events; anywhere else the request
+      //  is performed before returning and the event is NO_EVENT
+      // if 'result' is given, the number of bytes transferred (short only at
+      //  end of file) or -errno is stored there before the event triggers
+      static Event read(int fd, void *buffer, size_t bytes, off_t offset,
+			ssize_t *result = 0);
+      static Event write(int fd, const void *buffer, size_t bytes, off_t offset,
+			 ssize_t *result = 0);
+    };
+
+}; // namespace Realm
+
+#endif // ifndef REALM_ASYNC_IO_H
@@ -15,6 +15,8 @@
 
 // a little helper class for storing a dynamically allocated byte array
 //  an accessing it in various ways
+// small arrays (e.g. most task arguments) are stored inline, avoiding the
+//  trip through malloc/free
 
 #ifndef REALM_BYTEARRAY_H
 #define REALM_BYTEARRAY_H
@@ -25,6 +27,9 @@ namespace Realm {
 
   class ByteArray {
   public:
+    // arrays up to this size are held inline
+    static const size_t INLINE_CAPACITY = 64;
+
     inline ByteArray(void);
     inline ByteArray(const void *copy_from, size_t copy_size);
     inline ByteArray(const ByteArray& copy_from);
@@ -65,8 +70,22 @@ namespace Realm {
     const T& at(size_t offset) const;
 
   protected:
+    inline bool is_inline(void) const;
+
+    // takes the contents of 'from' (which is left empty) - we must be empty
+    inline void move_from(ByteArray& from);
+
+    // points array_base at enough storage for 'size' bytes - must be empty
+    inline void allocate(size_t size);
+
     void *array_base;
     size_t array_size;
+    union {
+      char bytes[INLINE_CAPACITY];
+      double align_double;
+      void *align_ptr;
+      long long align_ll;
+    } inline_data;
   };
 
   // support for realm-style serialization
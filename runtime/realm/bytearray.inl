@@ -40,10 +40,8 @@ namespace Realm {
     : array_base(0), array_size(0)
   {
     if(copy_size) {
-      array_base = malloc(copy_size);
-      assert(array_base != 0);
+      allocate(copy_size);
       memcpy(array_base, copy_from, copy_size);
-      array_size = copy_size;
     }
   }
 
@@ -51,28 +49,55 @@ namespace Realm {
     : array_base(0), array_size(0)
   {
     if(copy_from.size()) {
-      array_base = malloc(copy_from.size());
-      assert(array_base != 0);
+      allocate(copy_from.size());
       memcpy(array_base, copy_from.base(), copy_from.size());
-      array_size = copy_from.size();
     }
   }
 
   ByteArray::~ByteArray(void)
   {
-    if(array_size)
+    if(array_size && !is_inline())
       free(array_base);
   }
 
+  bool ByteArray::is_inline(void) const
+  {
+    return (array_base == inline_data.bytes);
+  }
+
+  void ByteArray::allocate(size_t size)
+  {
+    assert(array_size == 0);
+    if(size <= INLINE_CAPACITY) {
+      array_base = inline_data.bytes;
+    } else {
+      array_base = malloc(size);
+      assert(array_base != 0);
+    }
+    array_size = size;
+  }
+
+  void ByteArray::move_from(ByteArray& from)
+  {
+    assert(array_size == 0);
+    if(from.is_inline()) {
+      array_base = inline_data.bytes;
+      memcpy(inline_data.bytes, from.inline_data.bytes, from.array_size);
+    } else
+      array_base = from.array_base;
+    array_size = from.array_size;
+    from.array_base = 0;
+    from.array_size = 0;
+  }
+
   // copies the contents of the rhs ByteArray
   ByteArray& ByteArray::operator=(const ByteArray& copy_from)
   {
+    if(&copy_from == this) return *this;
     clear();  // throw away any data we had before
     if(copy_from.size()) {
-      array_base = malloc(copy_from.size());
-      assert(array_base != 0);
+      allocate(copy_from.size());
       memcpy(array_base, copy_from.base(), copy_from.size());
-      array_size = copy_from.size();
     }
     return *this;
   }
@@ -82,8 +107,17 @@ namespace Realm {
   //   ByteArray().swap(old_array)
   ByteArray& ByteArray::swap(ByteArray& swap_with)
   {
-    std::swap(array_base, swap_with.array_base);
-    std::swap(array_size, swap_with.array_size);
+    if(!is_inline() && !swap_with.is_inline()) {
+      // both on the heap (or empty) - just trade pointers
+      std::swap(array_base, swap_with.array_base);
+      std::swap(array_size, swap_with.array_size);
+    } else {
+      // inline data has to actually move
+      ByteArray tmp;
+      tmp.move_from(*this);
+      move_from(swap_with);
+      swap_with.move_from(tmp);
+    }
     return *this;
   }
 
@@ -92,10 +126,8 @@ namespace Realm {
   {
     clear();  // throw away any data we had before
     if(copy_size) {
-      array_base = malloc(copy_size);
-      assert(array_base != 0);
+      allocate(copy_size);
       memcpy(array_base, copy_from, copy_size);
-      array_size = copy_size;
     }
     return *this;
   }
@@ -153,7 +185,8 @@ namespace Realm {
   void ByteArray::clear(void)
   {
     if(array_size) {
-      free(array_base);
+      if(!is_inline())
+	free(array_base);
       array_base = 0;
       array_size = 0;
     }
@@ -164,6 +197,12 @@ namespace Realm {
   {
     if(array_size) {
       void *retval = array_base;
+      // the caller expects something it can free()
+      if(is_inline()) {
+	retval = malloc(array_size);
+	assert(retval != 0);
+	memcpy(retval, array_base, array_size);
+      }
       array_base = 0;
       array_size = 0;
       return retval;
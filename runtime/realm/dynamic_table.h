@@ -21,7 +21,12 @@
 namespace Realm {
 
     // we have a base type that's element-type agnostic
-    template <typename LT, typename IT>
+    //
+    // nodes are never modified once they have been published in the tree,
+    //  with the exception of the child pointers of inner nodes, which go from
+    //  null to non-null exactly once (via compare-and-swap), so lookups never
+    //  need to take a lock
+    template <typename IT>
     struct DynamicTableNodeBase {
     public:
       DynamicTableNodeBase(int _level, IT _first_index, IT _last_index);
@@ -29,11 +34,10 @@ namespace Realm {
 
       int level;
       IT first_index, last_index;
-      LT lock;
     };
 
-    template <typename ET, size_t _SIZE, typename LT, typename IT>
-      struct DynamicTableNode : public DynamicTableNodeBase<LT, IT> {
+    template <typename ET, size_t _SIZE, typename IT>
+      struct DynamicTableNode : public DynamicTableNodeBase<IT> {
     public:
       static const size_t SIZE = _SIZE;
 
@@ -51,7 +55,7 @@ namespace Realm {
       typedef typename ALLOCATOR::IT IT;
       typedef typename ALLOCATOR::ET ET;
       typedef typename ALLOCATOR::LT LT;
-      typedef DynamicTableNodeBase<LT, IT> NodeBase;
+      typedef DynamicTableNodeBase<IT> NodeBase;
 
       DynamicTable(void);
       ~DynamicTable(void);
@@ -61,31 +65,57 @@ namespace Realm {
       ET *lookup_entry(IT index, int owner, typename ALLOCATOR::FreeList *free_list = 0);
 
     protected:
-      NodeBase *new_tree_node(int level, IT first_index, IT last_index,
-			      int owner, typename ALLOCATOR::FreeList *free_list);
+      NodeBase *new_tree_node(int level, IT first_index, IT last_index, int owner);
 
-      // lock protects _changes_ to 'root', but not access to it
-      LT lock;
+      // tries to install 'node' at '*slot', which must currently hold
+      //  'expected' - if we lose the race, 'node' is destroyed and false is
+      //  returned, otherwise any new leaf entries are given to 'free_list'
+      bool publish_node(NodeBase * volatile *slot, NodeBase *expected,
+			NodeBase *node, typename ALLOCATOR::FreeList *free_list);
+
+      // 'root' only ever changes via compare-and-swap
       NodeBase * volatile root;
     };
 
+    // entries are handed out from a small per-thread cache, which is refilled
+    //  (and drained, if too many entries are freed to it) in batches from a
+    //  shared list that is protected by 'lock'
     template <typename ALLOCATOR>
     class DynamicTableFreeList {
     public:
       typedef typename ALLOCATOR::IT IT;
       typedef typename ALLOCATOR::ET ET;
       typedef typename ALLOCATOR::LT LT;
+      typedef typename ALLOCATOR::LEAF_TYPE LEAF_TYPE;
+
+      static const int BATCH_SIZE = 32;
 
       DynamicTableFreeList(DynamicTable<ALLOCATOR>& _table, int _owner);
 
       ET *alloc_entry(void);
       void free_entry(ET *entry);
 
+      // adds all the entries of a newly created leaf to the shared list
+      void add_leaf_entries(LEAF_TYPE *leaf);
+
       DynamicTable<ALLOCATOR>& table;
       int owner;
       LT lock;
       ET * volatile first_free;
       IT volatile next_alloc;
+
+    protected:
+      struct ThreadCache {
+	DynamicTableFreeList<ALLOCATOR> *list;
+	ET *first_free;
+	int count;
+      };
+
+      ThreadCache& thread_cache(void);
+      void refill_cache(ThreadCache& cache);
+      void drain_cache(ThreadCache& cache, int to_keep);
+
+      static __thread ThreadCache local_cache;
     };
 	
 }; // namespace Realm
@@ -22,31 +22,31 @@ namespace Realm {
 
   ////////////////////////////////////////////////////////////////////////
   //
-  // class DynamicTableNodeBase<LT, IT>
+  // class DynamicTableNodeBase<IT>
   //
 
-  template <typename LT, typename IT>
-  DynamicTableNodeBase<LT, IT>::DynamicTableNodeBase(int _level, IT _first_index, IT _last_index)
+  template <typename IT>
+  DynamicTableNodeBase<IT>::DynamicTableNodeBase(int _level, IT _first_index, IT _last_index)
     : level(_level), first_index(_first_index), last_index(_last_index)
   {}
 
-  template <typename LT, typename IT>
-  DynamicTableNodeBase<LT, IT>::~DynamicTableNodeBase(void)
+  template <typename IT>
+  DynamicTableNodeBase<IT>::~DynamicTableNodeBase(void)
   {}
 
 
   ////////////////////////////////////////////////////////////////////////
   //
-  // class DynamicTableNode<ET, SIZE, LT,  IT>
+  // class DynamicTableNode<ET, SIZE, IT>
   //
 
-  template <typename ET, size_t _SIZE, typename LT, typename IT>
-  DynamicTableNode<ET, _SIZE, LT, IT>::DynamicTableNode(int _level, IT _first_index, IT _last_index)
-    : DynamicTableNodeBase<LT, IT>(_level, _first_index, _last_index)
+  template <typename ET, size_t _SIZE, typename IT>
+  DynamicTableNode<ET, _SIZE, IT>::DynamicTableNode(int _level, IT _first_index, IT _last_index)
+    : DynamicTableNodeBase<IT>(_level, _first_index, _last_index)
   {}
 
-  template <typename ET, size_t _SIZE, typename LT, typename IT>
-  DynamicTableNode<ET, _SIZE, LT, IT>::~DynamicTableNode(void)
+  template <typename ET, size_t _SIZE, typename IT>
+  DynamicTableNode<ET, _SIZE, IT>::~DynamicTableNode(void)
   {}
 
 
@@ -67,7 +67,7 @@ namespace Realm {
   }
 
   template <typename ALLOCATOR>
-  typename DynamicTable<ALLOCATOR>::NodeBase *DynamicTable<ALLOCATOR>::new_tree_node(int level, IT first_index, IT last_index, int owner, typename ALLOCATOR::FreeList *free_list /*= 0*/)
+  typename DynamicTable<ALLOCATOR>::NodeBase *DynamicTable<ALLOCATOR>::new_tree_node(int level, IT first_index, IT last_index, int owner)
   {
     if(level > 0) {
       // an inner node - we can create that ourselves
@@ -76,10 +76,31 @@ namespace Realm {
 	inner->elems[i] = 0;
       return inner;
     } else {
-      return ALLOCATOR::new_leaf_node(first_index, last_index, owner, free_list);
+      return ALLOCATOR::new_leaf_node(first_index, last_index, owner);
     }
   }
 
+  template <typename ALLOCATOR>
+  bool DynamicTable<ALLOCATOR>::publish_node(NodeBase * volatile *slot, NodeBase *expected,
+					     NodeBase *node, typename ALLOCATOR::FreeList *free_list)
+  {
+    // the compare-and-swap is a full barrier, so the node's contents are
+    //  visible to anybody who sees the new pointer
+    if(!__sync_bool_compare_and_swap(slot, expected, node)) {
+      // somebody else got there first - nobody else has seen our node, so
+      //  just throw it away (a new root may point at the old one, but nodes
+      //  do not delete their children)
+      delete node;
+      return false;
+    }
+
+    // entries in a new leaf only become allocatable once the leaf is
+    //  reachable, and only by the thread that won the race
+    if((node->level == 0) && free_list)
+      free_list->add_leaf_entries(static_cast<typename ALLOCATOR::LEAF_TYPE *>(node));
+    return true;
+  }
+
   template<typename ALLOCATOR>
   size_t DynamicTable<ALLOCATOR>::max_entries(void) const
   {
@@ -144,32 +165,23 @@ namespace Realm {
       elems_addressable <<= ALLOCATOR::INNER_BITS;
     }
 
-    // in the common case, we won't need to add levels to the tree - grab the root (no lock)
+    // in the common case, we won't need to add levels to the tree - grab the root
     // and see if it covers the range that includes our index
     NodeBase *n = root;
-    if(!n || (n->level < level_needed)) {
-      // root doesn't appear to be high enough - take lock and fix it if it's really
-      //  not high enough
-      lock.lock();
-
-      if(!root) {
-	// simple case - just create a root node at the level we want
-	root = new_tree_node(level_needed, 0, elems_addressable - 1, owner, free_list);
+    while(!n || (n->level < level_needed)) {
+      // root isn't high enough - build either a root at the level we want or
+      //  a single new layer on top of the existing root, and try to install
+      //  it - whether or not we win, go around again with the current root
+      NodeBase *new_root;
+      if(!n) {
+	new_root = new_tree_node(level_needed, 0, elems_addressable - 1, owner);
       } else {
-	// some of the tree already exists - add new layers on top
-	while(root->level < level_needed) {
-	  int parent_level = root->level + 1;
-	  IT parent_first = 0;
-	  IT parent_last = (((root->last_index + 1) << ALLOCATOR::INNER_BITS) - 1);
-	  NodeBase *parent = new_tree_node(parent_level, parent_first, parent_last, owner, free_list);
-	  typename ALLOCATOR::INNER_TYPE *inner = static_cast<typename ALLOCATOR::INNER_TYPE *>(parent);
-	  inner->elems[0] = root;
-	  root = parent;
-	}
+	IT parent_last = (((n->last_index + 1) << ALLOCATOR::INNER_BITS) - 1);
+	new_root = new_tree_node(n->level + 1, 0, parent_last, owner);
+	static_cast<typename ALLOCATOR::INNER_TYPE *>(new_root)->elems[0] = n;
       }
+      publish_node(&root, n, new_root, free_list);
       n = root;
-
-      lock.unlock();
     }
     // when we get here, root is high enough
     assert((level_needed <= n->level) &&
@@ -185,25 +197,19 @@ namespace Realm {
 	      ((((IT)1) << ALLOCATOR::INNER_BITS) - 1));
       assert((i >= 0) && (((size_t)i) < ALLOCATOR::INNER_TYPE::SIZE));
 
-      NodeBase *child = inner->elems[i];
+      NodeBase * volatile *slot = &(inner->elems[i]);
+      NodeBase *child = *slot;
       if(child == 0) {
-	// need to populate subtree
-
-	// take lock on inner node
-	inner->lock.lock();
-
-	// now that lock is held, see if we really need to make new node
-	if(inner->elems[i] == 0) {
-	  int child_level = inner->level - 1;
-	  int child_shift = (ALLOCATOR::LEAF_BITS + child_level * ALLOCATOR::INNER_BITS);
-	  IT child_first = inner->first_index + (i << child_shift);
-	  IT child_last = inner->first_index + ((i + 1) << child_shift) - 1;
-
-	  inner->elems[i] = new_tree_node(child_level, child_first, child_last, owner, free_list);
-	}
-	child = inner->elems[i];
-
-	inner->lock.unlock();
+	// need to populate subtree - build the child and try to install it,
+	//  using whichever one ended up in the tree
+	int child_level = inner->level - 1;
+	int child_shift = (ALLOCATOR::LEAF_BITS + child_level * ALLOCATOR::INNER_BITS);
+	IT child_first = inner->first_index + (i << child_shift);
+	IT child_last = inner->first_index + ((i + 1) << child_shift) - 1;
+
+	publish_node(slot, 0, new_tree_node(child_level, child_first, child_last, owner),
+		     free_list);
+	child = *slot;
       }
       assert((child != 0) &&
 	     (child->level == (n->level - 1)) &&
@@ -224,18 +230,34 @@ namespace Realm {
   // class DynamicTableFreeList<ALLOCATOR>
   //
 
+  template <typename ALLOCATOR>
+  /*static*/ __thread typename DynamicTableFreeList<ALLOCATOR>::ThreadCache DynamicTableFreeList<ALLOCATOR>::local_cache;
+
   template <typename ALLOCATOR>
   DynamicTableFreeList<ALLOCATOR>::DynamicTableFreeList(DynamicTable<ALLOCATOR>& _table, int _owner)
     : table(_table), owner(_owner), first_free(0), next_alloc(0)
   {}
 
   template <typename ALLOCATOR>
-  typename DynamicTableFreeList<ALLOCATOR>::ET *DynamicTableFreeList<ALLOCATOR>::alloc_entry(void)
+  inline typename DynamicTableFreeList<ALLOCATOR>::ThreadCache& DynamicTableFreeList<ALLOCATOR>::thread_cache(void)
+  {
+    ThreadCache& cache = local_cache;
+    // the cache is per element type, so claim it if this is the first time
+    //  this thread has used it (there's only one free list per type)
+    if(cache.list != this) {
+      cache.list = this;
+      cache.first_free = 0;
+      cache.count = 0;
+    }
+    return cache;
+  }
+
+  template <typename ALLOCATOR>
+  void DynamicTableFreeList<ALLOCATOR>::refill_cache(ThreadCache& cache)
   {
-    // take the lock first, since we're messing with the free list
     lock.lock();
 
-    // if the free list is empty, we can fill it up by referencing the next entry to be allocated -
+    // if the shared list is empty, we can fill it up by referencing the next entry to be allocated -
     // this uses the existing dynamic-filling code to avoid race conditions
     while(!first_free) {
       IT to_lookup = next_alloc;
@@ -248,20 +270,86 @@ namespace Realm {
       lock.lock();
     }
 
-    typename DynamicTable<ALLOCATOR>::ET *entry = first_free;
-    first_free = entry->next_free;
+    // take a batch off the front of the shared list
+    ET *first = first_free;
+    ET *last = first;
+    int count = 1;
+    while((count < BATCH_SIZE) && last->next_free) {
+      last = last->next_free;
+      count++;
+    }
+    first_free = last->next_free;
+
     lock.unlock();
 
+    last->next_free = cache.first_free;
+    cache.first_free = first;
+    cache.count += count;
+  }
+
+  template <typename ALLOCATOR>
+  void DynamicTableFreeList<ALLOCATOR>::drain_cache(ThreadCache& cache, int to_keep)
+  {
+    // chain up the entries beyond the ones we're keeping before taking the lock
+    ET *keep_last = 0;
+    ET *first = cache.first_free;
+    for(int i = 0; i < to_keep; i++) {
+      keep_last = first;
+      first = first->next_free;
+    }
+    ET *last = first;
+    while(last->next_free)
+      last = last->next_free;
+
+    if(keep_last)
+      keep_last->next_free = 0;
+    else
+      cache.first_free = 0;
+    cache.count = to_keep;
+
+    lock.lock();
+    last->next_free = first_free;
+    first_free = first;
+    lock.unlock();
+  }
+
+  template <typename ALLOCATOR>
+  typename DynamicTableFreeList<ALLOCATOR>::ET *DynamicTableFreeList<ALLOCATOR>::alloc_entry(void)
+  {
+    ThreadCache& cache = thread_cache();
+    if(!cache.first_free)
+      refill_cache(cache);
+
+    ET *entry = cache.first_free;
+    cache.first_free = entry->next_free;
+    cache.count--;
     return entry;
   }
 
   template <typename ALLOCATOR>
   void DynamicTableFreeList<ALLOCATOR>::free_entry(ET *entry)
   {
-    // just stick ourselves on front of free list
+    // entries go back to this thread's cache - if it gets too big (e.g. this
+    //  thread frees entries allocated by others), give a batch back
+    ThreadCache& cache = thread_cache();
+    entry->next_free = cache.first_free;
+    cache.first_free = entry;
+    if(++cache.count > (2 * BATCH_SIZE))
+      drain_cache(cache, BATCH_SIZE);
+  }
+
+  template <typename ALLOCATOR>
+  void DynamicTableFreeList<ALLOCATOR>::add_leaf_entries(LEAF_TYPE *leaf)
+  {
+    // stitch all the new elements into the shared list (element 0 of the
+    //  first leaf is never handed out, since index 0 is used for NO_* IDs)
+    IT last_ofs = (((IT)1) << ALLOCATOR::LEAF_BITS) - 1;
+    for(IT i = 0; i < last_ofs; i++)
+      leaf->elems[i].next_free = &(leaf->elems[i+1]);
+
     lock.lock();
-    entry->next_free = first_free;
-    first_free = entry;
+    leaf->elems[last_ofs].next_free = first_free;
+    first_free = &(leaf->elems[leaf->first_index ? 0 : 1]);
     lock.unlock();
   }
 
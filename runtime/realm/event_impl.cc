@@ -19,6 +19,13 @@
 #include "runtime_impl.h"
 #include "logging.h"
 #include "threads.h"
+#include "timers.h"
+
+#include <set>
+
+#include <signal.h>
+#include <semaphore.h>
+#include <time.h>
 
 #ifdef USE_CUDA
 GASNETT_THREADKEY_DECLARE(gpu_thread_ptr);
@@ -104,7 +111,7 @@ namespace Realm {
 
   void EventTriggeredCondition::Callback::print_info(FILE *f)
   {
-    fprintf(f, "EventTriggeredCondition (thread unknown)");
+    fprintf(f, "EventTriggeredCondition (thread unknown)\n");
   }  
 
   void Event::wait(void) const
@@ -161,6 +168,7 @@ namespace Realm {
     u.id = e.id;
     u.gen = e.gen;
     log_event.info("user event created: event=" IDFMT "/%d", e.id, e.gen);
+    EventGraphRecorder::record(EventGraphRecorder::REC_USER, u);
     return u;
   }
 
@@ -176,6 +184,8 @@ namespace Realm {
 			 id, gen, wait_on.id, wait_on.gen,
 			 enclosing.id, enclosing.gen);
 #endif
+    if(wait_on.exists())
+      EventGraphRecorder::record(EventGraphRecorder::REC_USER, *this, wait_on);
     e->trigger(gen, gasnet_mynode(), wait_on);
   }
 
@@ -255,6 +265,7 @@ namespace Realm {
 			 id, gen, wait_on.id, wait_on.gen,
 			 enclosing.id, enclosing.gen, count);
 #endif
+    EventGraphRecorder::record(EventGraphRecorder::REC_ARRIVAL, *this, wait_on);
     // arrival uses the timestamp stored in this barrier object
     BarrierImpl *impl = get_runtime()->get_barrier_impl(*this);
     impl->adjust_arrival(gen, -count, timestamp, wait_on,
@@ -403,6 +414,7 @@ namespace Realm {
 	log_event.info("merged event " IDFMT "/%d waiting for " IDFMT "/%d",
 		  e.id, e.gen, (*it).id, (*it).gen);
 	m->add_event(*it);
+	EventGraphRecorder::record(EventGraphRecorder::REC_MERGE, e, *it);
 #ifdef EVENT_GRAPH_TRACE
         log_event_graph.info("Event Precondition: (" IDFMT ",%d) (" IDFMT ",%d)",
                              e.id, e.gen,
@@ -473,6 +485,13 @@ namespace Realm {
       m->add_event(ev5);
       m->add_event(ev6);
 
+      if(EventGraphRecorder::enabled) {
+	Event inputs[6] = { ev1, ev2, ev3, ev4, ev5, ev6 };
+	for(int i = 0; i < 6; i++)
+	  if(inputs[i].exists())
+	    EventGraphRecorder::record(EventGraphRecorder::REC_MERGE, e, inputs[i]);
+      }
+
 #ifdef EVENT_GRAPH_TRACE
       log_event_graph.info("Event Merge: (" IDFMT ",%d) %d",
                finish_event->me.id(), finish_event->generation, existential_count);
@@ -843,6 +862,12 @@ namespace Realm {
 
         generation = gen_triggered;
 
+	{
+	  Event triggered = me.convert<Event>();
+	  triggered.gen = gen_triggered;
+	  EventGraphRecorder::record(EventGraphRecorder::REC_TRIGGER, triggered);
+	}
+
 	// grab whole list of local waiters - we'll trigger them once we let go of the lock
 	//printf("[%d] LOCAL WAITERS: %zd\n", gasnet_mynode(), local_waiters.size());
 	to_wake.swap(local_waiters);
@@ -952,6 +977,7 @@ namespace Realm {
       next_free = 0;
       remote_subscribe_gens.clear();
       remote_trigger_gens.clear();
+      arrivals_flushing = false;
       base_arrival_count = 0;
       redop = 0;
       initial_value = 0;
@@ -969,6 +995,7 @@ namespace Realm {
       next_free = 0;
       remote_subscribe_gens.clear();
       remote_trigger_gens.clear();
+      arrivals_flushing = false;
       base_arrival_count = 0;
       redop = 0;
       initial_value = 0;
@@ -1069,13 +1096,22 @@ static void *bytedup(const void *data, size_t datalen)
       size_t datalen;
     };
 
-    BarrierImpl::Generation::Generation(void) : unguarded_delta(0) {}
-    BarrierImpl::Generation::~Generation(void)
+    BarrierImpl::Generation::Generation(void) : gen(0), unguarded_delta(0) {}
+
+    void BarrierImpl::Generation::reset(void)
       {
-        for(std::map<int, PerNodeUpdates *>::iterator it = pernode.begin();
-            it != pernode.end();
-            it++)
-          delete (it->second);
+	gen = 0;
+	unguarded_delta = 0;
+	local_waiters.clear();
+	pernode.clear();
+      }
+
+    void BarrierImpl::Generation::swap(Generation& other)
+      {
+	std::swap(gen, other.gen);
+	std::swap(unguarded_delta, other.unguarded_delta);
+	local_waiters.swap(other.local_waiters);
+	pernode.swap(other.pernode);
       }
 
     void BarrierImpl::Generation::handle_adjustment(Barrier::timestamp_t ts, int delta)
@@ -1087,13 +1123,19 @@ static void *bytedup(const void *data, size_t datalen)
 	}
 
         int node = ts >> BARRIER_TIMESTAMP_NODEID_SHIFT;
-        PerNodeUpdates *pn;
-        std::map<int, PerNodeUpdates *>::iterator it = pernode.find(node);
-        if(it != pernode.end()) {
-          pn = it->second;
-        } else {
-          pn = new PerNodeUpdates;
-          pernode[node] = pn;
+        // only a few nodes ever alter a given generation's count, so a linear
+        //  search beats a map here
+        PerNodeUpdates *pn = 0;
+        for(size_t i = 0; i < pernode.size(); i++)
+          if(pernode[i].node == node) {
+            pn = &pernode[i];
+            break;
+          }
+        if(!pn) {
+          pernode.resize(pernode.size() + 1);
+          pn = &pernode.back();
+          pn->node = node;
+          pn->last_ts = 0;
         }
         if(delta > 0) {
           // TODO: really need two timestamps to properly order increments
@@ -1120,6 +1162,108 @@ static void *bytedup(const void *data, size_t datalen)
         }
       }
 
+    BarrierImpl::Generation *BarrierImpl::find_generation(Event::gen_t gen, bool create)
+    {
+      assert(gen > generation);
+      if(gen <= (generation + GENERATION_RING_SIZE)) {
+	Generation& g = gen_ring[gen % GENERATION_RING_SIZE];
+	if(g.gen == gen)
+	  return &g;
+	if(!create)
+	  return 0;
+	// the ring only ever holds generations in the window, so a slot that
+	//  isn't ours must be free
+	assert(g.gen == 0);
+	g.gen = gen;
+	return &g;
+      }
+
+      std::map<Event::gen_t, Generation *>::iterator it = future_generations.find(gen);
+      if(it != future_generations.end())
+	return it->second;
+      if(!create)
+	return 0;
+      Generation *g = new Generation;
+      g->gen = gen;
+      future_generations[gen] = g;
+      log_barrier.info("added overflow tracker for barrier " IDFMT ", generation %d",
+		       me.id(), gen);
+      return g;
+    }
+
+    void BarrierImpl::retire_generations(Event::gen_t upto, std::vector<EventWaiter *>& waiters)
+    {
+      for(unsigned i = 0; i < GENERATION_RING_SIZE; i++) {
+	Generation& g = gen_ring[i];
+	if((g.gen != 0) && (g.gen <= upto)) {
+	  waiters.insert(waiters.end(), g.local_waiters.begin(), g.local_waiters.end());
+	  g.reset();
+	}
+      }
+
+      // overflow generations either triggered too or may now fit in the ring
+      while(!future_generations.empty()) {
+	std::map<Event::gen_t, Generation *>::iterator it = future_generations.begin();
+	if(it->first <= upto) {
+	  waiters.insert(waiters.end(), it->second->local_waiters.begin(),
+			 it->second->local_waiters.end());
+	} else {
+	  if(it->first > (generation + GENERATION_RING_SIZE)) break;
+	  Generation& g = gen_ring[it->first % GENERATION_RING_SIZE];
+	  assert(g.gen == 0);
+	  g.swap(*(it->second));
+	}
+	delete it->second;
+	future_generations.erase(it);
+      }
+    }
+
+    void BarrierImpl::get_tracked_generations(std::vector<Generation *>& gens)
+    {
+      for(unsigned i = 1; i <= GENERATION_RING_SIZE; i++) {
+	Generation& g = gen_ring[(generation + i) % GENERATION_RING_SIZE];
+	if(g.gen != 0)
+	  gens.push_back(&g);
+      }
+      for(std::map<Event::gen_t, Generation *>::const_iterator it = future_generations.begin();
+	  it != future_generations.end();
+	  it++)
+	gens.push_back(it->second);
+    }
+
+    void BarrierImpl::flush_pending_arrivals(void)
+    {
+      // whoever set arrivals_flushing keeps sending until it finds nothing left,
+      //  so an arrival that got combined is never stranded
+      std::vector<PendingArrival> to_send;
+      while(true) {
+	{
+	  AutoHSLLock a(mutex);
+	  assert(arrivals_flushing);
+	  if(pending_arrivals.empty()) {
+	    arrivals_flushing = false;
+	    return;
+	  }
+	  to_send.swap(pending_arrivals);
+	}
+
+	for(std::vector<PendingArrival>::const_iterator it = to_send.begin();
+	    it != to_send.end();
+	    it++) {
+	  Barrier b = me.convert<Barrier>();
+	  b.gen = it->gen;
+	  b.timestamp = 0;
+	  log_barrier.info("sending combined barrier arrival: " IDFMT "/%d delta=%d",
+			   b.id, b.gen, it->delta);
+	  BarrierAdjustMessage::send_request(owner, b, it->delta, Event::NO_EVENT,
+					     it->value, it->value_size);
+	  if(it->value)
+	    free(it->value);
+	}
+	to_send.clear();
+      }
+    }
+
     struct RemoteNotification {
       unsigned node;
       Event::gen_t trigger_gen, previous_gen;
@@ -1170,7 +1314,55 @@ static void *bytedup(const void *data, size_t datalen)
 #endif
 
       if(owner != gasnet_mynode()) {
-	// all adjustments handled by owner node
+	// all adjustments handled by owner node - plain arrivals are combined
+	//  with any others from this node that haven't been sent yet, but
+	//  timestamped adjustments must stay separate, and reduction values
+	//  can only be combined once we know the (foldable) reduction op
+	bool combine = (timestamp == 0) && (delta < 0);
+	bool start_flush = false;
+	if(combine) {
+	  AutoHSLLock a(mutex);
+
+	  if((reduce_value_size > 0) && !(redop && redop->is_foldable)) {
+	    combine = false;
+	  } else {
+	    PendingArrival *pa = 0;
+	    for(size_t i = 0; i < pending_arrivals.size(); i++)
+	      if(pending_arrivals[i].gen == barrier_gen) {
+		pa = &pending_arrivals[i];
+		break;
+	      }
+	    if(!pa) {
+	      pending_arrivals.resize(pending_arrivals.size() + 1);
+	      pa = &pending_arrivals.back();
+	      pa->gen = barrier_gen;
+	      pa->delta = 0;
+	      pa->value = 0;
+	      pa->value_size = 0;
+	    }
+	    pa->delta += delta;
+	    if(reduce_value_size > 0) {
+	      assert(reduce_value_size == redop->sizeof_rhs);
+	      if(pa->value) {
+		redop->fold(pa->value, reduce_value, 1, true);
+	      } else {
+		pa->value = bytedup(reduce_value, reduce_value_size);
+		pa->value_size = reduce_value_size;
+	      }
+	    }
+
+	    // if another thread is already sending, it'll pick this one up too
+	    if(!arrivals_flushing)
+	      start_flush = arrivals_flushing = true;
+	  }
+	}
+
+	if(combine) {
+	  if(start_flush)
+	    flush_pending_arrivals();
+	  return;
+	}
+
 	Barrier b = me.convert<Barrier>();
 	b.gen = barrier_gen;
 	b.timestamp = timestamp;
@@ -1195,34 +1387,25 @@ static void *bytedup(const void *data, size_t datalen)
 	// update whatever generation we're told to
 	{
 	  assert(barrier_gen > generation);
-	  Generation *g;
-	  std::map<Event::gen_t, Generation *>::iterator it = generations.find(barrier_gen);
-	  if(it != generations.end()) {
-	    g = it->second;
-	  } else {
-	    g = new Generation;
-	    generations[barrier_gen] = g;
-	    log_barrier.info("added tracker for barrier " IDFMT ", generation %d",
-			     me.id(), barrier_gen);
-	  }
-
+	  Generation *g = find_generation(barrier_gen, true);
 	  g->handle_adjustment(timestamp, delta);
 	}
 
 	// if the update was to the next generation, it may cause one or more generations
 	//  to trigger
 	if(barrier_gen == (generation + 1)) {
-	  std::map<Event::gen_t, Generation *>::iterator it = generations.begin();
-	  while((it != generations.end()) &&
-		(it->first == (generation + 1)) &&
-		((base_arrival_count + it->second->unguarded_delta) == 0)) {
+	  while(true) {
+	    Generation *g = find_generation(generation + 1, false);
+	    if(!g || ((base_arrival_count + g->unguarded_delta) != 0))
+	      break;
+	    trigger_gen = generation = g->gen;
+	    if(EventGraphRecorder::enabled) {
+	      Event triggered = me.convert<Event>();
+	      triggered.gen = trigger_gen;
+	      EventGraphRecorder::record(EventGraphRecorder::REC_TRIGGER, triggered);
+	    }
 	    // keep the list of local waiters to wake up once we release the lock
-	    local_notifications.insert(local_notifications.end(), 
-				       it->second->local_waiters.begin(), it->second->local_waiters.end());
-	    trigger_gen = generation = it->first;
-	    delete it->second;
-	    generations.erase(it);
-	    it = generations.begin();
+	    retire_generations(generation, local_notifications);
 	  }
 
 	  // if any triggers occurred, figure out which remote nodes need notifications
@@ -1367,16 +1550,7 @@ static void *bytedup(const void *data, size_t datalen)
 	AutoHSLLock a(mutex);
 
 	if(needed_gen > generation) {
-	  Generation *g;
-	  std::map<Event::gen_t, Generation *>::iterator it = generations.find(needed_gen);
-	  if(it != generations.end()) {
-	    g = it->second;
-	  } else {
-	    g = new Generation;
-	    generations[needed_gen] = g;
-	    log_barrier.info("added tracker for barrier " IDFMT ", generation %d",
-			     me.id(), needed_gen);
-	  }
+	  Generation *g = find_generation(needed_gen, true);
 	  g->local_waiters.push_back(waiter);
 
 	  // a call to has_triggered should have already handled the necessary subscription
@@ -1503,20 +1677,18 @@ static void *bytedup(const void *data, size_t datalen)
 	    impl->held_triggers.erase(it);
 	  }
 
+	  if(EventGraphRecorder::enabled) {
+	    for(Event::gen_t g = impl->generation + 1; g <= args.trigger_gen; g++) {
+	      Event triggered = impl->me.convert<Event>();
+	      triggered.gen = g;
+	      EventGraphRecorder::record(EventGraphRecorder::REC_TRIGGER, triggered);
+	    }
+	  }
 	  impl->generation = args.trigger_gen;
 
-	  // now iterate through any generations up to and including the latest triggered
+	  // now retire any generations up to and including the latest triggered
 	  //  generation, and accumulate local waiters to notify
-	  while(!impl->generations.empty()) {
-	    std::map<Event::gen_t, BarrierImpl::Generation *>::iterator it = impl->generations.begin();
-	    if(it->first > args.trigger_gen) break;
-
-	    local_notifications.insert(local_notifications.end(),
-				       it->second->local_waiters.begin(),
-				       it->second->local_waiters.end());
-	    delete it->second;
-	    impl->generations.erase(it);
-	  }
+	  impl->retire_generations(args.trigger_gen, local_notifications);
 	} else {
 	  // hold this trigger until we get messages for the earlier generation(s)
 	  log_barrier.info("holding future trigger: " IDFMT "/%d (%d -> %d)",
@@ -1577,4 +1749,322 @@ static void *bytedup(const void *data, size_t datalen)
       return true;
     }
 
+  ////////////////////////////////////////////////////////////////////////
+  //
+  // class EventGraphRecorder
+  //
+
+    /*static*/ bool EventGraphRecorder::enabled = false;
+
+    // the history is a ring of fixed-size records - writers claim a slot with
+    //  an atomic increment and publish it by writing the sequence number last,
+    //  so a dump can run concurrently and just skips slots that are in flux
+    static EventGraphRecorder::Record *graph_records = 0;
+    static size_t graph_capacity = 0;
+    static unsigned long long graph_next = 0;
+    static size_t graph_path_length = 20;
+    static int graph_timeout = 0;
+    static char *graph_prefix = 0;
+    static pthread_t graph_watchdog;
+    static sem_t graph_dump_sem;
+    static volatile bool graph_stopping = false;
+    static GASNetHSL graph_dump_mutex;
+
+    static const char *graph_kind_names[] = { "trigger", "merge", "task", "copy",
+					      "user event", "barrier arrival",
+					      "waiter" };
+
+    /*static*/ void EventGraphRecorder::configure(size_t capacity, int timeout_secs,
+						  size_t path_length, const char *file_prefix)
+    {
+      graph_capacity = 1;
+      while(graph_capacity < capacity) graph_capacity <<= 1;
+      graph_records = (Record *)calloc(graph_capacity, sizeof(Record));
+      assert(graph_records != 0);
+      graph_path_length = path_length;
+      graph_timeout = timeout_secs;
+      if(file_prefix)
+	graph_prefix = strdup(file_prefix);
+
+      sem_init(&graph_dump_sem, 0, 0);
+      signal(SIGUSR1, handle_signal);
+      int ret = pthread_create(&graph_watchdog, 0, watchdog_loop, 0);
+      assert(ret == 0);
+
+      enabled = true;
+    }
+
+    /*static*/ void EventGraphRecorder::shutdown(void)
+    {
+      if(!enabled) return;
+      graph_stopping = true;
+      sem_post(&graph_dump_sem);
+      pthread_join(graph_watchdog, 0);
+      enabled = false;
+      signal(SIGUSR1, SIG_DFL);
+      sem_destroy(&graph_dump_sem);
+      // the ring itself is left allocated until the process exits - a thread
+      //  that saw 'enabled' just before we cleared it may still be writing
+      //  its record
+      if(graph_prefix) {
+	free(graph_prefix);
+	graph_prefix = 0;
+      }
+    }
+
+    /*static*/ void EventGraphRecorder::add_record(RecordKind kind, Event event, Event other)
+    {
+      unsigned long long seq = __sync_add_and_fetch(&graph_next, 1);
+      Record& r = graph_records[(seq - 1) & (graph_capacity - 1)];
+      r.seq = 0;
+      __sync_synchronize();
+      r.time_ns = Clock::current_time_in_nanoseconds();
+      r.event_id = event.id;
+      r.event_gen = event.gen;
+      r.other_id = other.id;
+      r.other_gen = other.gen;
+      r.kind = kind;
+      r.node = gasnet_mynode();
+      __sync_synchronize();
+      r.seq = seq;
+    }
+
+    /*static*/ void EventGraphRecorder::handle_signal(int sig)
+    {
+      // only async-signal-safe work here - the watchdog does the dump
+      sem_post(&graph_dump_sem);
+    }
+
+    /*static*/ void *EventGraphRecorder::watchdog_loop(void *)
+    {
+      unsigned long long last_seen = 0;
+      int idle_secs = 0;
+      bool reported = false;
+      while(true) {
+	struct timespec deadline;
+	clock_gettime(CLOCK_REALTIME, &deadline);
+	deadline.tv_sec += 1;
+	int ret = sem_timedwait(&graph_dump_sem, &deadline);
+	if(graph_stopping) break;
+	if(ret == 0) {
+	  dump("signal");
+	  continue;
+	}
+	if(graph_timeout <= 0) continue;
+	// any new record counts as progress - report a stall once, and then
+	//  again only after things have moved in between
+	unsigned long long seen = graph_next;
+	if(seen != last_seen) {
+	  last_seen = seen;
+	  idle_secs = 0;
+	  reported = false;
+	} else if(!reported && (++idle_secs >= graph_timeout)) {
+	  dump("no progress");
+	  reported = true;
+	}
+      }
+      return 0;
+    }
+
+    typedef std::pair<Event::id_t, Event::gen_t> GraphKey;
+
+    static bool graph_event_triggered(const std::map<GraphKey, long long>& trigger_times,
+				      const GraphKey& key)
+    {
+      if(trigger_times.count(key) > 0) return true;
+      Event e;
+      e.id = key.first;
+      e.gen = key.second;
+      return get_runtime()->get_event_impl(e)->has_triggered(e.gen);
+    }
+
+    static void print_waiters(FILE *f, const std::vector<EventWaiter *>& waiters,
+			      std::vector<GraphKey>& pending, Event::id_t id, Event::gen_t gen,
+			      const char *what)
+    {
+      if(waiters.empty()) return;
+      fprintf(f, "  %s " IDFMT "/%d: %zd local waiter(s)\n", what, id, gen, waiters.size());
+      for(std::vector<EventWaiter *>::const_iterator it = waiters.begin();
+	  it != waiters.end();
+	  it++) {
+	fprintf(f, "    ");
+	(*it)->print_info(f);
+      }
+      pending.push_back(GraphKey(id, gen));
+    }
+
+    /*static*/ void EventGraphRecorder::dump(const char *reason)
+    {
+      AutoHSLLock al(graph_dump_mutex);
+
+      // snapshot the valid part of the ring so writers can keep going
+      std::vector<Record> records;
+      unsigned long long end = graph_next;
+      unsigned long long start = ((end > graph_capacity) ? (end - graph_capacity) : 0);
+      records.reserve(end - start);
+      for(unsigned long long s = start + 1; s <= end; s++) {
+	const Record& slot = graph_records[(s - 1) & (graph_capacity - 1)];
+	Record r = slot;
+	__sync_synchronize();
+	// skip slots that were being (re)written while we copied them
+	if((r.seq != s) || (slot.seq != s)) continue;
+	records.push_back(r);
+      }
+
+      FILE *f = stderr;
+      if(graph_prefix) {
+	char filename[1024];
+	snprintf(filename, 1024, "%s_%d.txt", graph_prefix, gasnet_mynode());
+	f = fopen(filename, "a");
+	if(!f) {
+	  log_event.error("unable to open event graph report file %s", filename);
+	  f = stderr;
+	}
+      }
+
+      fprintf(f, "EVENT GRAPH REPORT (node %d, %s): %llu records seen, %zd kept\n",
+	      gasnet_mynode(), reason, end, records.size());
+
+      std::map<GraphKey, long long> trigger_times;
+      std::multimap<GraphKey, std::pair<GraphKey, unsigned> > preds;
+      const Record *last_trigger = 0;
+      for(std::vector<Record>::const_iterator it = records.begin();
+	  it != records.end();
+	  it++) {
+	GraphKey key(it->event_id, it->event_gen);
+	if(it->kind == REC_TRIGGER) {
+	  trigger_times[key] = it->time_ns;
+	  last_trigger = &*it;
+	} else
+	  preds.insert(std::make_pair(key, std::make_pair(GraphKey(it->other_id, it->other_gen),
+							  it->kind)));
+      }
+
+      // critical path: walk back from the most recent trigger, always through
+      //  the precondition that triggered last
+      if(last_trigger) {
+	fprintf(f, "CRITICAL PATH (most recent first):\n");
+	GraphKey cur(last_trigger->event_id, last_trigger->event_gen);
+	long long cur_time = last_trigger->time_ns;
+	for(size_t step = 0; step < graph_path_length; step++) {
+	  GraphKey best;
+	  long long best_time = -1;
+	  unsigned kind = REC_TRIGGER;
+	  typedef std::multimap<GraphKey, std::pair<GraphKey, unsigned> >::const_iterator PI;
+	  std::pair<PI, PI> range = preds.equal_range(cur);
+	  for(PI it = range.first; it != range.second; it++) {
+	    kind = it->second.second;
+	    std::map<GraphKey, long long>::const_iterator it2 = trigger_times.find(it->second.first);
+	    if((it2 != trigger_times.end()) && (it2->second > best_time)) {
+	      best = it->second.first;
+	      best_time = it2->second;
+	    }
+	  }
+	  if(best_time < 0) {
+	    fprintf(f, "  " IDFMT "/%d (%s) triggered at %lld ns\n",
+		    cur.first, cur.second, graph_kind_names[kind], cur_time);
+	    break;
+	  }
+	  fprintf(f, "  " IDFMT "/%d (%s) triggered at %lld ns, %lld ns after " IDFMT "/%d\n",
+		  cur.first, cur.second, graph_kind_names[kind], cur_time,
+		  cur_time - best_time, best.first, best.second);
+	  cur = best;
+	  cur_time = best_time;
+	}
+      }
+
+      // everything that still has local waiters, and (as far as the history
+      //  goes) the untriggered events at the root of what each one waits on
+      std::vector<GraphKey> pending;
+      fprintf(f, "PENDING EVENTS WITH LOCAL WAITERS:\n");
+      for(unsigned i = 0; i < gasnet_nodes(); i++) {
+	Node *n = &get_runtime()->nodes[i];
+	for(unsigned long j = 0; j < n->events.max_entries(); j++) {
+	  if(!n->events.has_entry(j))
+	    continue;
+	  GenEventImpl *e = n->events.lookup_entry(j, i/*node*/);
+	  AutoHSLLock a2(e->mutex);
+	  print_waiters(f, e->local_waiters, pending, e->me.id(), e->generation + 1, "event");
+	}
+	for(unsigned long j = 0; j < n->barriers.max_entries(); j++) {
+	  if(!n->barriers.has_entry(j))
+	    continue;
+	  BarrierImpl *b = n->barriers.lookup_entry(j, i/*node*/);
+	  AutoHSLLock a2(b->mutex);
+	  std::vector<BarrierImpl::Generation *> gens;
+	  b->get_tracked_generations(gens);
+	  for(size_t k = 0; k < gens.size(); k++)
+	    print_waiters(f, gens[k]->local_waiters, pending, b->me.id(), gens[k]->gen, "barrier");
+	}
+      }
+
+      if(!pending.empty()) {
+	fprintf(f, "ROOT BLOCKERS:\n");
+	std::map<GraphKey, unsigned> roots;
+	std::set<GraphKey> visited;
+	std::vector<GraphKey> worklist(pending);
+	while(!worklist.empty()) {
+	  GraphKey key = worklist.back();
+	  worklist.pop_back();
+	  if(!visited.insert(key).second) continue;
+	  bool has_untriggered_pred = false;
+	  unsigned kind = REC_WAITER;
+	  typedef std::multimap<GraphKey, std::pair<GraphKey, unsigned> >::const_iterator PI;
+	  std::pair<PI, PI> range = preds.equal_range(key);
+	  for(PI it = range.first; it != range.second; it++) {
+	    kind = it->second.second;
+	    if((it->second.first.first == 0) ||
+	       graph_event_triggered(trigger_times, it->second.first))
+	      continue;
+	    has_untriggered_pred = true;
+	    worklist.push_back(it->second.first);
+	  }
+	  if(!has_untriggered_pred)
+	    roots[key] = kind;
+	}
+	for(std::map<GraphKey, unsigned>::const_iterator it = roots.begin();
+	    it != roots.end();
+	    it++)
+	  fprintf(f, "  " IDFMT "/%d (%s)\n", it->first.first, it->first.second,
+		  ((it->second == REC_WAITER) ? "no recorded preconditions" :
+		                                graph_kind_names[it->second]));
+      }
+      fprintf(f, "DONE\n");
+      fflush(f);
+      if(f != stderr)
+	fclose(f);
+
+      // raw records (plus a record per waited-on event) for offline analysis
+      if(graph_prefix) {
+	char filename[1024];
+	snprintf(filename, 1024, "%s_%d.evg", graph_prefix, gasnet_mynode());
+	FILE *bf = fopen(filename, "wb");
+	if(!bf) {
+	  log_event.error("unable to open event graph file %s", filename);
+	  return;
+	}
+	for(std::vector<GraphKey>::const_iterator it = pending.begin();
+	    it != pending.end();
+	    it++) {
+	  Record r;
+	  memset(&r, 0, sizeof(r));
+	  r.seq = end + 1 + (it - pending.begin());
+	  r.event_id = it->first;
+	  r.event_gen = it->second;
+	  r.kind = REC_WAITER;
+	  r.node = gasnet_mynode();
+	  records.push_back(r);
+	}
+	const char magic[8] = { 'R','E','V','N','T','G','R','F' };
+	const unsigned header[2] = { 1/*version*/, gasnet_mynode() };
+	unsigned long long count = records.size();
+	fwrite(magic, sizeof(magic), 1, bf);
+	fwrite(header, sizeof(header), 1, bf);
+	fwrite(&count, sizeof(count), 1, bf);
+	if(count > 0)
+	  fwrite(&records[0], sizeof(Record), count, bf);
+	fclose(bf);
+      }
+    }
+
 }; // namespace Realm
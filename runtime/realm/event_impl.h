@@ -44,6 +44,54 @@ namespace Realm {
     };
 #endif
 
+    // Keeps a bounded history of event triggers and dependences (enabled at
+    //  run time with -ll:eventgraph) so that the critical path into the most
+    //  recent triggers and the root causes of hung waiters can be reported,
+    //  either on SIGUSR1 or when no events have triggered for a while
+    class EventGraphRecorder {
+    public:
+      enum RecordKind {
+	REC_TRIGGER = 0,  // event was triggered
+	REC_MERGE = 1,    // event is a merge with 'other' as an input
+	REC_TASK = 2,     // event is a task's finish event, task waits on 'other'
+	REC_COPY = 3,     // event is a copy's finish event, copy waits on 'other'
+	REC_USER = 4,     // user event trigger deferred until 'other'
+	REC_ARRIVAL = 5,  // barrier arrival deferred until 'other'
+	REC_WAITER = 6,   // event has local waiters (only written in dumps)
+      };
+
+      // the binary dump layout is shared with tools/detect_loops.cc
+      struct Record {
+	unsigned long long seq;  // 0 == slot not (yet) valid
+	long long time_ns;
+	unsigned long long event_id, other_id;  // fixed width whatever the size of id_t
+	unsigned event_gen, other_gen;
+	unsigned kind, node;
+      };
+
+      static bool enabled;
+
+      // capacity is rounded up to a power of two, and a timeout of 0 disables
+      //  the stall watchdog - with a file prefix the report is appended to
+      //  <prefix>_<node>.txt and the records are written to <prefix>_<node>.evg
+      static void configure(size_t capacity, int timeout_secs,
+			    size_t path_length, const char *file_prefix);
+      static void shutdown(void);
+
+      static void record(RecordKind kind, Event event, Event other = Event::NO_EVENT)
+      {
+	if(enabled) add_record(kind, event, other);
+      }
+
+      // writes a report (and the raw records) for the current history
+      static void dump(const char *reason);
+
+    protected:
+      static void add_record(RecordKind kind, Event event, Event other);
+      static void *watchdog_loop(void *);
+      static void handle_signal(int sig);
+    };
+
     class EventWaiter {
     public:
       virtual ~EventWaiter(void) {}
@@ -144,35 +192,75 @@ namespace Realm {
 
       bool get_result(Event::gen_t result_gen, void *value, size_t value_size);
 
-    public: //protected:
-      ID me;
-      unsigned owner;
-      Event::gen_t generation, gen_subscribed;
-      Event::gen_t first_generation, free_generation;
-      BarrierImpl *next_free;
-
-      GASNetHSL mutex; // controls which local thread has access to internal data (not runtime-visible event)
-
       // class to track per-generation status
       class Generation {
       public:
 	struct PerNodeUpdates {
+	  int node;
 	  Barrier::timestamp_t last_ts;
 	  std::map<Barrier::timestamp_t, int> pending;
 	};
 
+	Event::gen_t gen;  // 0 if this slot isn't tracking a generation
 	int unguarded_delta;
 	std::vector<EventWaiter *> local_waiters;
-	std::map<int, PerNodeUpdates *> pernode;
-      
+	std::vector<PerNodeUpdates> pernode;  // only nodes that sent timestamped adjustments
 	
 	Generation(void);
-	~Generation(void);
 
 	void handle_adjustment(Barrier::timestamp_t ts, int delta);
+
+	// clears the slot for reuse, keeping the waiter list's storage
+	void reset(void);
+
+	void swap(Generation& other);
       };
 
-      std::map<Event::gen_t, Generation *> generations;
+      // finds the tracker for a generation that hasn't triggered yet, creating it
+      //  if requested (returns 0 otherwise) - must hold the mutex
+      Generation *find_generation(Event::gen_t gen, bool create);
+
+      // moves every tracked generation up to and including 'upto' out of the ring
+      //  and overflow map, collecting their waiters - must hold the mutex, and
+      //  'generation' must already be at least 'upto'
+      void retire_generations(Event::gen_t upto, std::vector<EventWaiter *>& waiters);
+
+      // lists every tracked generation, in order - must hold the mutex
+      void get_tracked_generations(std::vector<Generation *>& gens);
+
+    protected:
+      // sends this node's combined arrivals to the owner until no more show up
+      void flush_pending_arrivals(void);
+
+    public: //protected:
+      ID me;
+      unsigned owner;
+      Event::gen_t generation, gen_subscribed;
+      Event::gen_t first_generation, free_generation;
+      BarrierImpl *next_free;
+
+      GASNetHSL mutex; // controls which local thread has access to internal data (not runtime-visible event)
+
+      // generations (generation, generation + GENERATION_RING_SIZE] are tracked in a
+      //  ring indexed by gen % GENERATION_RING_SIZE, so the usual arrivals and waits
+      //  never allocate - anything further ahead waits in the overflow map until
+      //  the ring catches up
+      static const unsigned GENERATION_RING_SIZE = 8;
+      Generation gen_ring[GENERATION_RING_SIZE];
+      std::map<Event::gen_t, Generation *> future_generations;
+
+      // on non-owner nodes, arrivals that show up while another thread is sending
+      //  are combined (counts summed, reduction values folded) into a single
+      //  adjustment per generation, so the owner sees one message per burst
+      //  instead of one per arrival
+      struct PendingArrival {
+	Event::gen_t gen;
+	int delta;
+	void *value;  // folded reduction value, if any
+	size_t value_size;
+      };
+      std::vector<PendingArrival> pending_arrivals;
+      bool arrivals_flushing;
 
       // a list of remote waiters and the latest generation they're interested in
       // also the latest generation that each node (that has ever subscribed) has been told about
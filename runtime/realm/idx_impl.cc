@@ -335,6 +335,42 @@ namespace Realm {
 					   size_t block_size,
                                            const ProfilingRequestSet &reqs,
 					   ReductionOpID redop_id) const
+    {
+      return create_instance(memory, field_sizes, block_size, InstanceOrder(), reqs, redop_id);
+    }
+
+    // builds the linearization for a rectangular instance in the requested
+    //  order and returns the range of indices it uses
+    template <int DIM>
+    static LegionRuntime::Arrays::Rect<1> linearize_rect(const LegionRuntime::Arrays::Rect<DIM>& bounds,
+							 const InstanceOrder &order,
+							 int *linearization_bits)
+    {
+      LegionRuntime::Arrays::Mapping<DIM, 1> *mapping;
+      if(order.kind == InstanceOrder::LINEAR) {
+	LegionRuntime::Arrays::FortranArrayLinearization<DIM> cl(bounds, 0);
+	mapping = LegionRuntime::Arrays::Mapping<DIM, 1>::new_dynamic_mapping(cl);
+      } else {
+	LegionRuntime::Arrays::Point<DIM> tile_size = order.tile_size.get_point<DIM>();
+	if(order.kind == InstanceOrder::MORTON) {
+	  LegionRuntime::Arrays::MortonLinearization<DIM> ml(bounds, tile_size, 0);
+	  mapping = LegionRuntime::Arrays::Mapping<DIM, 1>::new_dynamic_mapping(ml);
+	} else {
+	  LegionRuntime::Arrays::TiledLinearization<DIM> tl(bounds, tile_size, false /*!morton*/, 0);
+	  mapping = LegionRuntime::Arrays::Mapping<DIM, 1>::new_dynamic_mapping(tl);
+	}
+      }
+      DomainLinearization dl = DomainLinearization::from_mapping<DIM>(mapping);
+      dl.serialize(linearization_bits);
+      return mapping->image_convex(bounds);
+    }
+
+    RegionInstance Domain::create_instance(Memory memory,
+					   const std::vector<size_t> &field_sizes,
+					   size_t block_size,
+					   const InstanceOrder &order,
+                                           const ProfilingRequestSet &reqs,
+					   ReductionOpID redop_id) const
     {
       DetailedTimer::ScopedPush sp(TIME_LOW_LEVEL);      
       ID id(memory);
@@ -352,39 +388,21 @@ namespace Realm {
       if(get_dim() > 0) {
 	// we have a rectangle - figure out its volume and create based on that
 	LegionRuntime::Arrays::Rect<1> inst_extent;
+	if(order.kind != InstanceOrder::LINEAR)
+	  assert(order.tile_size.get_dim() == get_dim());
 	switch(get_dim()) {
-	case 1:
-	  {
-	    LegionRuntime::Arrays::FortranArrayLinearization<1> cl(get_rect<1>(), 0);
-	    DomainLinearization dl = DomainLinearization::from_mapping<1>(LegionRuntime::Arrays::Mapping<1, 1>::new_dynamic_mapping(cl));
-	    inst_extent = cl.image_convex(get_rect<1>());
-	    dl.serialize(linearization_bits);
-	    break;
-	  }
-
-	case 2:
-	  {
-	    LegionRuntime::Arrays::FortranArrayLinearization<2> cl(get_rect<2>(), 0);
-	    DomainLinearization dl = DomainLinearization::from_mapping<2>(LegionRuntime::Arrays::Mapping<2, 1>::new_dynamic_mapping(cl));
-	    inst_extent = cl.image_convex(get_rect<2>());
-	    dl.serialize(linearization_bits);
-	    break;
-	  }
-
-	case 3:
-	  {
-	    LegionRuntime::Arrays::FortranArrayLinearization<3> cl(get_rect<3>(), 0);
-	    DomainLinearization dl = DomainLinearization::from_mapping<3>(LegionRuntime::Arrays::Mapping<3, 1>::new_dynamic_mapping(cl));
-	    inst_extent = cl.image_convex(get_rect<3>());
-	    dl.serialize(linearization_bits);
-	    break;
-	  }
-
+	case 1: inst_extent = linearize_rect<1>(get_rect<1>(), order, linearization_bits); break;
+	case 2: inst_extent = linearize_rect<2>(get_rect<2>(), order, linearization_bits); break;
+	case 3: inst_extent = linearize_rect<3>(get_rect<3>(), order, linearization_bits); break;
 	default: assert(0);
 	}
 
 	num_elements = inst_extent.volume();
 	//printf("num_elements = %zd\n", num_elements);
+	// tiled orders pad out to whole tiles, so a block size that covered
+	//  the domain (i.e. SOA) has to grow to cover the padding too
+	if((order.kind != InstanceOrder::LINEAR) && (block_size >= get_volume()))
+	  block_size = num_elements;
       } else {
 	IndexSpaceImpl *r = get_runtime()->get_index_space_impl(get_index_space());
 
@@ -399,6 +399,40 @@ namespace Realm {
       int point_data[MAX_POINT_DIM];
     };
 
+    // The order the points of a rectangular instance are stored in.  LINEAR
+    //  is column-major over the whole rectangle.  The tiled orders store
+    //  each tile_size-shaped tile contiguously (column-major within the
+    //  tile) and number the tiles column-major (TILED) or along a Z-order
+    //  curve (MORTON), which keeps stencil neighbors in all dimensions close
+    //  together.  Unstructured index spaces always use LINEAR.
+    class InstanceOrder {
+    public:
+      enum Kind {
+	LINEAR,
+	TILED,
+	MORTON,
+      };
+
+      InstanceOrder(void) : kind(LINEAR) {}
+      InstanceOrder(Kind _kind, const DomainPoint& _tile_size)
+	: kind(_kind), tile_size(_tile_size) {}
+
+      bool operator==(const InstanceOrder& rhs) const
+      {
+	if(kind != rhs.kind) return false;
+	// tile size is a don't care for linear instances
+	return((kind == LINEAR) || (tile_size == rhs.tile_size));
+      }
+
+      bool operator!=(const InstanceOrder& rhs) const
+      {
+	return !((*this) == rhs);
+      }
+
+      Kind kind;
+      DomainPoint tile_size;
+    };
+
     class DomainLinearization {
     public:
       DomainLinearization(void) : dim(-1), lptr(0) {}
@@ -910,6 +944,13 @@ namespace Realm {
                                      const ProfilingRequestSet &reqs,
 				     ReductionOpID redop_id = 0) const;
 
+      RegionInstance create_instance(Memory memory,
+				     const std::vector<size_t> &field_sizes,
+				     size_t block_size,
+				     const InstanceOrder &order,
+                                     const ProfilingRequestSet &reqs,
+				     ReductionOpID redop_id = 0) const;
+
       RegionInstance create_hdf5_instance(const char *file_name,
                                           const std::vector<size_t> &field_sizes,
                                           const std::vector<const char*> &field_files,
@@ -50,6 +50,42 @@ namespace Realm {
       RegionInstanceImpl *impl;
     };
 
+    static void destroy_instances_now(const std::vector<RegionInstance>& instances)
+    {
+      MetadataInvalidationBatch batch;
+
+      for(std::vector<RegionInstance>::const_iterator it = instances.begin();
+	  it != instances.end();
+	  it++) {
+	RegionInstanceImpl *i_impl = get_runtime()->get_instance_impl(*it);
+	log_inst.info("instance destroyed: space=" IDFMT " id=" IDFMT "",
+		      i_impl->metadata.is.id, it->id);
+	get_runtime()->get_memory_impl(i_impl->memory)->destroy_instance(*it, true, &batch);
+      }
+
+      batch.flush();
+    }
+
+    class DeferredInstBatchDestroy : public EventWaiter {
+    public:
+      DeferredInstBatchDestroy(const std::vector<RegionInstance>& _instances)
+	: instances(_instances) { }
+      virtual ~DeferredInstBatchDestroy(void) { }
+    public:
+      virtual bool event_triggered(void)
+      {
+	destroy_instances_now(instances);
+	return true;
+      }
+
+      virtual void print_info(FILE *f)
+      {
+	fprintf(f,"deferred destruction of %zd instances\n", instances.size());
+      }
+    protected:
+      std::vector<RegionInstance> instances;
+    };
+
   
   ////////////////////////////////////////////////////////////////////////
   //
@@ -87,6 +123,19 @@ namespace Realm {
       get_runtime()->get_memory_impl(i_impl->memory)->destroy_instance(*this, true);
     }
 
+    /*static*/ void RegionInstance::destroy_instances(const std::vector<RegionInstance>& instances,
+						      Event wait_on /*= Event::NO_EVENT*/)
+    {
+      DetailedTimer::ScopedPush sp(TIME_LOW_LEVEL);
+      if (!wait_on.has_triggered())
+      {
+	EventImpl::add_waiter(wait_on, new DeferredInstBatchDestroy(instances));
+        return;
+      }
+
+      destroy_instances_now(instances);
+    }
+
     /*static*/ const RegionInstance RegionInstance::NO_INST = { 0 };
 
     // a generic accessor just holds a pointer to the impl and passes all 
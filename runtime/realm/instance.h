@@ -23,6 +23,8 @@
 #include "event.h"
 #include "memory.h"
 
+#include <vector>
+
 #include "accessor.h"
 
 namespace Realm {
@@ -43,6 +45,11 @@ namespace Realm {
 
       void destroy(Event wait_on = Event::NO_EVENT) const;
 
+      // destroys a group of instances - invalidations of remote copies of
+      //  their metadata are combined into one message per node
+      static void destroy_instances(const std::vector<RegionInstance>& instances,
+				    Event wait_on = Event::NO_EVENT);
+
       AddressSpace address_space(void) const;
       id_t local_id(void) const;
 
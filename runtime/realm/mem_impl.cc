@@ -391,7 +391,8 @@ namespace Realm {
     }
 
     void MemoryImpl::destroy_instance_local(RegionInstance i, 
-					      bool local_destroy)
+					      bool local_destroy,
+					      MetadataInvalidationBatch *batch)
     {
       log_inst.info("destroying local instance: mem=" IDFMT " inst=" IDFMT "", me.id, i.id);
 
@@ -407,7 +408,7 @@ namespace Realm {
 	free_bytes(iimpl->metadata.count_offset, sizeof(size_t));
 
       // begin recovery of metadata
-      if(iimpl->metadata.initiate_cleanup(i.id)) {
+      if(iimpl->metadata.initiate_cleanup(i.id, batch)) {
 	// no remote copies exist, so we can reclaim instance immediately
 	//log_metadata.info("no remote copies of metadata for " IDFMT, i.id);
 	// TODO
@@ -423,7 +424,8 @@ namespace Realm {
     }
 
     void MemoryImpl::destroy_instance_remote(RegionInstance i, 
-					       bool local_destroy)
+					       bool local_destroy,
+					       MetadataInvalidationBatch *batch)
     {
       // if we're the original destroyer of the instance, tell the owner
       if(local_destroy) {
@@ -504,9 +506,10 @@ namespace Realm {
   }
 
   void LocalCPUMemory::destroy_instance(RegionInstance i, 
-					bool local_destroy)
+					bool local_destroy,
+					MetadataInvalidationBatch *batch)
   {
-    destroy_instance_local(i, local_destroy);
+    destroy_instance_local(i, local_destroy, batch);
   }
 
   off_t LocalCPUMemory::alloc_bytes(size_t size)
@@ -571,9 +574,10 @@ namespace Realm {
     }
 
     void RemoteMemory::destroy_instance(RegionInstance i, 
-					bool local_destroy)
+					bool local_destroy,
+					MetadataInvalidationBatch *batch)
     {
-      destroy_instance_remote(i, local_destroy);
+      destroy_instance_remote(i, local_destroy, batch);
     }
 
     off_t RemoteMemory::alloc_bytes(size_t size)
@@ -601,7 +605,7 @@ namespace Realm {
     void RemoteMemory::get_bytes(off_t offset, void *dst, size_t size)
     {
       // this better be an RDMA-able memory
-#ifdef USE_GASNET
+#if defined(USE_GASNET) || defined(USE_SHM_AM)
       assert(kind == MemoryImpl::MKIND_RDMA);
       void *srcptr = ((char *)regbase) + offset;
       gasnet_get(dst, ID(me).node(), srcptr, size);
@@ -671,12 +675,13 @@ namespace Realm {
     }
 
     void GASNetMemory::destroy_instance(RegionInstance i, 
-					bool local_destroy)
+					bool local_destroy,
+					MetadataInvalidationBatch *batch)
     {
       if(gasnet_mynode() == 0) {
-	destroy_instance_local(i, local_destroy);
+	destroy_instance_local(i, local_destroy, batch);
       } else {
-	destroy_instance_remote(i, local_destroy);
+	destroy_instance_remote(i, local_destroy, batch);
       }
     }
 
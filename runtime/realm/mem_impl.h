@@ -42,6 +42,7 @@ namespace Realm {
 namespace Realm {
 
   class RegionInstanceImpl;
+  class MetadataInvalidationBatch;
   
     class MemoryImpl {
     public:
@@ -101,11 +102,14 @@ namespace Realm {
                                              const ProfilingRequestSet &reqs,
 					     RegionInstance parent_inst) = 0;
 
-      void destroy_instance_local(RegionInstance i, bool local_destroy);
-      void destroy_instance_remote(RegionInstance i, bool local_destroy);
+      void destroy_instance_local(RegionInstance i, bool local_destroy,
+				  MetadataInvalidationBatch *batch = 0);
+      void destroy_instance_remote(RegionInstance i, bool local_destroy,
+				   MetadataInvalidationBatch *batch = 0);
 
       virtual void destroy_instance(RegionInstance i, 
-				    bool local_destroy) = 0;
+				    bool local_destroy,
+				    MetadataInvalidationBatch *batch = 0) = 0;
 
       off_t alloc_bytes_local(size_t size);
       void free_bytes_local(off_t offset, size_t size);
@@ -170,7 +174,8 @@ namespace Realm {
                                              const ProfilingRequestSet &reqs,
 					     RegionInstance parent_inst);
       virtual void destroy_instance(RegionInstance i, 
-				    bool local_destroy);
+				    bool local_destroy,
+				    MetadataInvalidationBatch *batch);
       virtual off_t alloc_bytes(size_t size);
       virtual void free_bytes(off_t offset, size_t size);
       virtual void get_bytes(off_t offset, void *dst, size_t size);
@@ -203,7 +208,8 @@ namespace Realm {
 					     RegionInstance parent_inst);
 
       virtual void destroy_instance(RegionInstance i, 
-				    bool local_destroy);
+				    bool local_destroy,
+				    MetadataInvalidationBatch *batch);
 
       virtual off_t alloc_bytes(size_t size);
 
@@ -254,7 +260,8 @@ namespace Realm {
                                             RegionInstance parent_inst);
 
       virtual void destroy_instance(RegionInstance i,
-                                    bool local_destroy);
+                                    bool local_destroy,
+                                    MetadataInvalidationBatch *batch);
 
       virtual off_t alloc_bytes(size_t size);
 
@@ -311,7 +318,8 @@ namespace Realm {
                                      bool read_only);
 
       virtual void destroy_instance(RegionInstance i,
-                                    bool local_destroy);
+                                    bool local_destroy,
+                                    MetadataInvalidationBatch *batch);
 
       virtual off_t alloc_bytes(size_t size);
 
@@ -359,7 +367,8 @@ namespace Realm {
                                              const ProfilingRequestSet &reqs,
 					     RegionInstance parent_inst);
       virtual void destroy_instance(RegionInstance i, 
-				    bool local_destroy);
+				    bool local_destroy,
+				    MetadataInvalidationBatch *batch);
       virtual off_t alloc_bytes(size_t size);
       virtual void free_bytes(off_t offset, size_t size);
       virtual void get_bytes(off_t offset, void *dst, size_t size);
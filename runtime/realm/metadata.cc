@@ -21,6 +21,9 @@
 #include "inst_impl.h"
 #include "runtime_impl.h"
 
+#include <cstring>
+#include <cstdlib>
+
 namespace Realm {
 
   Logger log_metadata("metadata");
@@ -80,6 +83,48 @@ namespace Realm {
 	to_trigger->trigger_current();
     }
 
+    bool MetadataBase::prepare_request(Event& e)
+    {
+      bool issue_request = false;
+
+      AutoHSLLock a(mutex);
+
+      switch(state) {
+      case STATE_VALID:
+	{
+	  // possible if the data came in between the caller's early out check
+	  // and our taking of the lock - nothing more to do
+	  break;
+	}
+
+      case STATE_INVALID: 
+	{
+	  // if the current state is invalid, we'll need to issue a request
+	  state = STATE_REQUESTED;
+	  valid_event_impl = GenEventImpl::create_genevent();
+	  e = valid_event_impl->current_event();
+	  issue_request = true;
+	  break;
+	}
+
+      case STATE_REQUESTED:
+	{
+	  // request has already been issued, but return the event again
+	  assert(valid_event_impl);
+	  e = valid_event_impl->current_event();
+	  break;
+	}
+
+      case STATE_INVALIDATE:
+	assert(0 && "requesting metadata we've been told is invalid!");
+
+      case STATE_CLEANUP:
+	assert(0 && "requesting metadata in CLEANUP state!");
+      }
+
+      return issue_request;
+    }
+
     Event MetadataBase::request_data(int owner, ID::IDType id)
     {
       // early out - valid data need not be re-requested
@@ -90,48 +135,63 @@ namespace Realm {
       assert(((unsigned)owner) != gasnet_mynode());
 
       Event e = Event::NO_EVENT;
-      bool issue_request = false;
-      {
-	AutoHSLLock a(mutex);
-
-	switch(state) {
-	case STATE_VALID:
-	  {
-	    // possible if the data came in between our early out check
-	    // above and our taking of the lock - nothing more to do
-	    break;
-	  }
+      if(prepare_request(e))
+	MetadataRequestMessage::send_request(owner, id);
 
-	case STATE_INVALID: 
-	  {
-	    // if the current state is invalid, we'll need to issue a request
-	    state = STATE_REQUESTED;
-	    valid_event_impl = GenEventImpl::create_genevent();
-            e = valid_event_impl->current_event();
-	    issue_request = true;
-	    break;
-	  }
+      return e;
+    }
 
-	case STATE_REQUESTED:
-	  {
-	    // request has already been issued, but return the event again
-	    assert(valid_event_impl);
-            e = valid_event_impl->current_event();
-	    break;
-	  }
+    // finds the metadata for an object with the given ID - only instances
+    //  have metadata for now
+    static MetadataBase *find_metadata(ID::IDType id)
+    {
+      switch(ID(id).type()) {
+      case ID::ID_INSTANCE:
+	return &(get_runtime()->get_instance_impl(id)->metadata);
 
-	case STATE_INVALIDATE:
-	  assert(0 && "requesting metadata we've been told is invalid!");
+      default:
+	assert(0);
+      }
+      return 0;
+    }
 
-	case STATE_CLEANUP:
-	  assert(0 && "requesting metadata in CLEANUP state!");
-	}
+    /*static*/ Event MetadataBase::request_data_bulk(const std::vector<ID::IDType>& ids)
+    {
+      std::set<Event> wait_for;
+      std::map<gasnet_node_t, std::vector<ID::IDType> > to_request;
+
+      for(std::vector<ID::IDType>::const_iterator it = ids.begin();
+	  it != ids.end();
+	  it++) {
+	// the owner's copy is always valid
+	gasnet_node_t owner = ID(*it).node();
+	if(owner == gasnet_mynode())
+	  continue;
+
+	MetadataBase *md = find_metadata(*it);
+	if(md->state == STATE_VALID)
+	  continue;
+
+	Event e = Event::NO_EVENT;
+	if(md->prepare_request(e))
+	  to_request[owner].push_back(*it);
+	if(e.exists())
+	  wait_for.insert(e);
       }
 
-      if(issue_request)
-	MetadataRequestMessage::send_request(owner, id);
+      // now send one request per owner
+      for(std::map<gasnet_node_t, std::vector<ID::IDType> >::const_iterator it = to_request.begin();
+	  it != to_request.end();
+	  it++) {
+	log_metadata.info("requesting metadata for %zd objects from node %d",
+			  it->second.size(), it->first);
+	if(it->second.size() == 1)
+	  MetadataRequestMessage::send_request(it->first, it->second[0]);
+	else
+	  MetadataBulkRequestMessage::send_request(it->first, it->second);
+      }
 
-      return e;
+      return Event::merge_events(wait_for);
     }
 
     void MetadataBase::await_data(bool block /*= true*/)
@@ -154,7 +214,8 @@ namespace Realm {
         e.wait(); // FIXME
     }
 
-    bool MetadataBase::initiate_cleanup(ID::IDType id)
+    bool MetadataBase::initiate_cleanup(ID::IDType id,
+					MetadataInvalidationBatch *batch /*= 0*/)
     {
       NodeSet invals_to_send;
       {
@@ -174,7 +235,10 @@ namespace Realm {
       if(invals_to_send.empty())
 	return true;
 
-      MetadataInvalidateMessage::broadcast_request(invals_to_send, id);
+      if(batch)
+	batch->add(invals_to_send, id);
+      else
+	MetadataInvalidateMessage::broadcast_request(invals_to_send, id);
 
       // can't free object until we receive all the acks
       return false;
@@ -218,6 +282,46 @@ namespace Realm {
       return last_copy;
     }
 
+
+  ////////////////////////////////////////////////////////////////////////
+  //
+  // class MetadataInvalidationBatch
+  //
+
+    MetadataInvalidationBatch::MetadataInvalidationBatch(void)
+      : cur_id(0)
+    {}
+
+    MetadataInvalidationBatch::~MetadataInvalidationBatch(void)
+    {
+      // must be flushed before it goes away
+      assert(ids_by_node.empty());
+    }
+
+    void MetadataInvalidationBatch::add(const NodeSet& targets, ID::IDType id)
+    {
+      cur_id = id;
+      targets.map(*this);
+    }
+
+    void MetadataInvalidationBatch::apply(gasnet_node_t target)
+    {
+      ids_by_node[target].push_back(cur_id);
+    }
+
+    void MetadataInvalidationBatch::flush(void)
+    {
+      for(std::map<gasnet_node_t, std::vector<ID::IDType> >::const_iterator it = ids_by_node.begin();
+	  it != ids_by_node.end();
+	  it++) {
+	if(it->second.size() == 1)
+	  MetadataInvalidateMessage::send_request(it->first, it->second[0]);
+	else
+	  MetadataBulkInvalidateMessage::send_request(it->first, it->second);
+      }
+      ids_by_node.clear();
+    }
+
   
   ////////////////////////////////////////////////////////////////////////
   //
@@ -395,6 +499,216 @@ namespace Realm {
     args.id = id;
     Message::request(target, args);
   }
+
+  
+  ////////////////////////////////////////////////////////////////////////
+  //
+  // class MetadataBulkRequestMessage
+  //
+
+  // each record in a bulk response is a header followed by the serialized
+  //  data, padded to keep the next header aligned
+  struct BulkResponseHeader {
+    ID::IDType id;
+    size_t datalen;
+  };
+
+  static inline size_t bulk_record_size(size_t datalen)
+  {
+    return sizeof(BulkResponseHeader) + ((datalen + 7) & ~(size_t)7);
+  }
+
+  /*static*/ void MetadataBulkRequestMessage::handle_request(RequestArgs args,
+							     const void *data,
+							     size_t datalen)
+  {
+    const ID::IDType *ids = (const ID::IDType *)data;
+    size_t num_ids = datalen / sizeof(ID::IDType);
+    assert((num_ids * sizeof(ID::IDType)) == datalen);
+
+    log_metadata.info("metadata for %zd objects requested by %d",
+		      num_ids, args.node);
+
+    // responses are packed into as few messages as the transport allows
+    size_t max_size = get_lmb_size(args.node);
+    std::vector<char> buffer;
+    int count = 0;
+
+    for(size_t i = 0; i < num_ids; i++) {
+      void *md_data = 0;
+      size_t md_datalen = 0;
+
+      // switch on different types of objects that can have metadata
+      switch(ID(ids[i]).type()) {
+      case ID::ID_INSTANCE:
+	{
+	  RegionInstanceImpl *impl = get_runtime()->get_instance_impl(ids[i]);
+	  impl->metadata.handle_request(args.node);
+	  md_data = impl->metadata.serialize(md_datalen);
+	  break;
+	}
+
+      default:
+	assert(0);
+      }
+
+      size_t rec_size = bulk_record_size(md_datalen);
+
+      // a record that can't share a message is sent on its own
+      if(rec_size > max_size) {
+	MetadataResponseMessage::send_request(args.node, ids[i],
+					      md_data, md_datalen, PAYLOAD_FREE);
+	continue;
+      }
+
+      if((buffer.size() + rec_size) > max_size) {
+	MetadataBulkResponseMessage::send_request(args.node, count,
+						  &buffer[0], buffer.size(),
+						  PAYLOAD_COPY);
+	buffer.clear();
+	count = 0;
+      }
+
+      size_t offset = buffer.size();
+      buffer.resize(offset + rec_size, 0);
+      BulkResponseHeader *hdr = (BulkResponseHeader *)&buffer[offset];
+      hdr->id = ids[i];
+      hdr->datalen = md_datalen;
+      if(md_datalen > 0)
+	memcpy(&buffer[offset + sizeof(BulkResponseHeader)], md_data, md_datalen);
+      free(md_data);
+      count++;
+    }
+
+    if(count > 0)
+      MetadataBulkResponseMessage::send_request(args.node, count,
+						&buffer[0], buffer.size(),
+						PAYLOAD_COPY);
+  }
+
+  /*static*/ void MetadataBulkRequestMessage::send_request(gasnet_node_t target,
+							   const std::vector<ID::IDType>& ids)
+  {
+    RequestArgs args;
+
+    args.node = gasnet_mynode();
+    Message::request(target, args, &ids[0], ids.size() * sizeof(ID::IDType),
+		     PAYLOAD_COPY);
+  }
+
+  
+  ////////////////////////////////////////////////////////////////////////
+  //
+  // class MetadataBulkResponseMessage
+  //
+
+  /*static*/ void MetadataBulkResponseMessage::handle_request(RequestArgs args,
+							      const void *data,
+							      size_t datalen)
+  {
+    log_metadata.info("metadata for %d objects received - %zd bytes",
+		      args.count, datalen);
+
+    const char *pos = (const char *)data;
+    for(int i = 0; i < args.count; i++) {
+      const BulkResponseHeader *hdr = (const BulkResponseHeader *)pos;
+      const void *md_data = pos + sizeof(BulkResponseHeader);
+
+      // switch on different types of objects that can have metadata
+      switch(ID(hdr->id).type()) {
+      case ID::ID_INSTANCE:
+	{
+	  RegionInstanceImpl *impl = get_runtime()->get_instance_impl(hdr->id);
+	  impl->metadata.deserialize(md_data, hdr->datalen);
+	  impl->metadata.handle_response();
+	  break;
+	}
+
+      default:
+	assert(0);
+      }
+
+      pos += bulk_record_size(hdr->datalen);
+    }
+    assert(pos == ((const char *)data + datalen));
+  }
+
+  /*static*/ void MetadataBulkResponseMessage::send_request(gasnet_node_t target,
+							    int count,
+							    const void *data,
+							    size_t datalen,
+							    int payload_mode)
+  {
+    RequestArgs args;
+
+    args.count = count;
+    Message::request(target, args, data, datalen, payload_mode);
+  }
+
+  
+  ////////////////////////////////////////////////////////////////////////
+  //
+  // class MetadataBulkInvalidateMessage
+  //
+
+  /*static*/ void MetadataBulkInvalidateMessage::handle_request(RequestArgs args,
+								const void *data,
+								size_t datalen)
+  {
+    const ID::IDType *ids = (const ID::IDType *)data;
+    size_t num_ids = datalen / sizeof(ID::IDType);
+    assert((num_ids * sizeof(ID::IDType)) == datalen);
+
+    log_metadata.info("received invalidate request for %zd objects", num_ids);
+
+    for(size_t i = 0; i < num_ids; i++)
+      find_metadata(ids[i])->handle_invalidate();
+
+    // ack all of them at once
+    std::vector<ID::IDType> acks(ids, ids + num_ids);
+    MetadataBulkInvalidateAckMessage::send_request(args.owner, acks);
+  }
+
+  /*static*/ void MetadataBulkInvalidateMessage::send_request(gasnet_node_t target,
+							      const std::vector<ID::IDType>& ids)
+  {
+    RequestArgs args;
+
+    args.owner = gasnet_mynode();
+    Message::request(target, args, &ids[0], ids.size() * sizeof(ID::IDType),
+		     PAYLOAD_COPY);
+  }
+
+  
+  ////////////////////////////////////////////////////////////////////////
+  //
+  // class MetadataBulkInvalidateAckMessage
+  //
+
+  /*static*/ void MetadataBulkInvalidateAckMessage::handle_request(RequestArgs args,
+								   const void *data,
+								   size_t datalen)
+  {
+    const ID::IDType *ids = (const ID::IDType *)data;
+    size_t num_ids = datalen / sizeof(ID::IDType);
+    assert((num_ids * sizeof(ID::IDType)) == datalen);
+
+    log_metadata.info("received invalidate ack for %zd objects", num_ids);
+
+    for(size_t i = 0; i < num_ids; i++)
+      if(find_metadata(ids[i])->handle_inval_ack(args.node))
+	log_metadata.info("last inval ack received for " IDFMT, ids[i]);
+  }
+
+  /*static*/ void MetadataBulkInvalidateAckMessage::send_request(gasnet_node_t target,
+								 const std::vector<ID::IDType>& ids)
+  {
+    RequestArgs args;
+
+    args.node = gasnet_mynode();
+    Message::request(target, args, &ids[0], ids.size() * sizeof(ID::IDType),
+		     PAYLOAD_COPY);
+  }
   
 
 }; // namespace Realm
@@ -24,9 +24,13 @@
 
 #include "activemsg.h"
 
+#include <vector>
+#include <map>
+
 namespace Realm {
 
   class GenEventImpl;
+  class MetadataInvalidationBatch;
 
     class MetadataBase {
     public:
@@ -50,17 +54,46 @@ namespace Realm {
       void handle_response(void);
       void handle_invalidate(void);
 
-      // these return true once all remote copies have been invalidated
-      bool initiate_cleanup(ID::IDType id);
+      // requests data for a number of objects at once - requests to the same
+      //  owner are combined into a single message, and the returned Event
+      //  triggers once all of the data is valid
+      static Event request_data_bulk(const std::vector<ID::IDType>& ids);
+
+      // these return true once all remote copies have been invalidated - if
+      //  a batch is supplied, invalidations are added to it rather than sent
+      bool initiate_cleanup(ID::IDType id,
+			    MetadataInvalidationBatch *batch = 0);
       bool handle_inval_ack(int sender);
 
     protected:
+      // does the state transition for a request - returns true if the caller
+      //  is responsible for sending a request to the owner
+      bool prepare_request(Event& e);
+
       GASNetHSL mutex;
       State state;  // current state
       GenEventImpl *valid_event_impl; // event to track receipt of in-flight request (if any)
       NodeSet remote_copies;
     };
 
+    // collects invalidations for several objects so that each remote node
+    //  receives at most one message per batch
+    class MetadataInvalidationBatch {
+    public:
+      MetadataInvalidationBatch(void);
+      ~MetadataInvalidationBatch(void);
+
+      void add(const NodeSet& targets, ID::IDType id);
+      void flush(void);
+
+      // called by NodeSet::map
+      void apply(gasnet_node_t target);
+
+    protected:
+      ID::IDType cur_id;
+      std::map<gasnet_node_t, std::vector<ID::IDType> > ids_by_node;
+    };
+
     // active messages
     
     struct MetadataRequestMessage {
@@ -123,6 +156,69 @@ namespace Realm {
 
       static void send_request(gasnet_node_t target, ID::IDType id);
     };
+
+    // bulk versions of the above - payloads are arrays of IDs (or, for the
+    //  response, a sequence of (id, length, data) records)
+
+    struct MetadataBulkRequestMessage {
+      struct RequestArgs : public BaseMedium {
+	int node;
+      };
+
+      static void handle_request(RequestArgs args, const void *data, size_t datalen);
+
+      typedef ActiveMessageMediumNoReply<METADATA_BULK_REQUEST_MSGID,
+					 RequestArgs,
+					 handle_request> Message;
+
+      static void send_request(gasnet_node_t target,
+			       const std::vector<ID::IDType>& ids);
+    };
+
+    struct MetadataBulkResponseMessage {
+      struct RequestArgs : public BaseMedium {
+	int count;
+      };
+
+      static void handle_request(RequestArgs args, const void *data, size_t datalen);
+
+      typedef ActiveMessageMediumNoReply<METADATA_BULK_RESPONSE_MSGID,
+					 RequestArgs,
+					 handle_request> Message;
+
+      static void send_request(gasnet_node_t target, int count,
+			       const void *data, size_t datalen, int payload_mode);
+    };
+
+    struct MetadataBulkInvalidateMessage {
+      struct RequestArgs : public BaseMedium {
+	int owner;
+      };
+
+      static void handle_request(RequestArgs args, const void *data, size_t datalen);
+
+      typedef ActiveMessageMediumNoReply<METADATA_BULK_INVALIDATE_MSGID,
+					 RequestArgs,
+					 handle_request> Message;
+
+      static void send_request(gasnet_node_t target,
+			       const std::vector<ID::IDType>& ids);
+    };
+
+    struct MetadataBulkInvalidateAckMessage {
+      struct RequestArgs : public BaseMedium {
+	gasnet_node_t node;
+      };
+
+      static void handle_request(RequestArgs args, const void *data, size_t datalen);
+
+      typedef ActiveMessageMediumNoReply<METADATA_BULK_INVALIDATE_ACK_MSGID,
+					 RequestArgs,
+					 handle_request> Message;
+
+      static void send_request(gasnet_node_t target,
+			       const std::vector<ID::IDType>& ids);
+    };
     
 }; // namespace Realm
 
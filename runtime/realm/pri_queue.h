@@ -63,6 +63,10 @@ namespace Realm {
     // this call is lock-free (and is again of questionable utility with multiple readers)
     bool empty(priority_t higher_than = PRI_NEG_INF) const;
 
+    // the number of items in the queue - also lock-free, so only an estimate
+    //  if other threads are adding or removing items
+    size_t size(void) const;
+
     // it is possible to subscribe to queue updates - notifications are sent when
     //  a new item arrives at a higher priority level than what is already available
     //  and offers the item for immediate retrieval - if a callback returns true, the
@@ -87,6 +91,9 @@ namespace Realm {
     // 'highest_priority' may be read without the lock held, but only written with the lock
     priority_t highest_priority;
 
+    // also written only with the lock held
+    volatile size_t item_count;
+
     // this lock protects everything else
     mutable LT lock;
 
@@ -27,6 +27,7 @@ namespace Realm {
   template <typename T, typename LT>
   inline PriorityQueue<T, LT>::PriorityQueue(void)
     : highest_priority (PRI_NEG_INF)
+    , item_count (0)
   {
   }
 
@@ -78,6 +79,7 @@ namespace Realm {
       dq.push_back(item);
     else
       dq.push_front(item);
+    item_count++;
 
     // all done
     lock.unlock();
@@ -111,6 +113,7 @@ namespace Realm {
     // take item off front
     T item = it->second.front();
     it->second.pop_front();
+    item_count--;
 
     // if list is now empty, remove from the queue and adjust highest_priority
     if(it->second.empty()) {
@@ -171,6 +174,12 @@ namespace Realm {
     return(highest_priority <= higher_than);
   }
 
+  template <typename T, typename LT>
+  inline size_t PriorityQueue<T, LT>::size(void) const
+  {
+    return item_count;
+  }
+
   // adds (or modifies) a subscription - only items above the specified priority will
   //  result in callbacks
   template <typename T, typename LT>
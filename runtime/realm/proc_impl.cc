@@ -27,6 +27,8 @@
 
 #include <sys/types.h>
 #include <dirent.h>
+#include <unistd.h>
+#include <errno.h>
 
 GASNETT_THREADKEY_DEFINE(cur_preemptable_thread);
 
@@ -149,6 +151,7 @@ namespace Realm {
                             enclosing.id, enclosing.gen,
                             priority, args, arglen);
 #endif
+      EventGraphRecorder::record(EventGraphRecorder::REC_TASK, e, wait_on);
 
       p->spawn_task(func_id, args, arglen, ProfilingRequestSet(),
 		    wait_on, e, priority);
@@ -174,6 +177,7 @@ namespace Realm {
                             enclosing.id, enclosing.gen,
                             priority, args, arglen);
 #endif
+      EventGraphRecorder::record(EventGraphRecorder::REC_TASK, e, wait_on);
 
       p->spawn_task(func_id, args, arglen, reqs,
 		    wait_on, e, priority);
@@ -198,6 +202,7 @@ namespace Realm {
 
     ProcessorImpl::ProcessorImpl(Processor _me, Processor::Kind _kind)
       : me(_me), kind(_kind)
+      , task_pool(sizeof(Task)), deferred_spawn_pool(sizeof(DeferredTaskSpawn))
     {
     }
 
@@ -211,14 +216,22 @@ namespace Realm {
   // class ProcessorGroup
   //
 
+    /*static*/ ProcessorGroup::DispatchPolicy ProcessorGroup::cfg_dispatch_policy = ProcessorGroup::DISPATCH_ROUND_ROBIN;
+    /*static*/ bool ProcessorGroup::cfg_affinity = false;
+
     ProcessorGroup::ProcessorGroup(void)
       : ProcessorImpl(Processor::NO_PROC, Processor::PROC_GROUP),
-	members_valid(false), members_requested(false), next_free(0)
+	members_valid(false), members_requested(false), next_free(0),
+	next_member(0)
     {
+      for(int i = 0; i < AFFINITY_SLOTS; i++)
+	last_member[i] = -1;
     }
 
     ProcessorGroup::~ProcessorGroup(void)
     {
+      for(size_t i = 0; i < member_queues.size(); i++)
+	delete member_queues[i];
     }
 
     void ProcessorGroup::init(Processor _me, int _owner)
@@ -259,11 +272,74 @@ namespace Realm {
 	member_list.push_back((*it)->me);
     }
 
+    void ProcessorGroup::add_member_scheduler(Processor member,
+					      ThreadedTaskScheduler *sched)
+    {
+      if(cfg_dispatch_policy == DISPATCH_SHARED) {
+	sched->add_task_queue(&task_queue);
+	return;
+      }
+
+      // tasks assigned to this member go in a queue of its own, which the
+      //  members already in the group can steal from (and vice versa)
+      ThreadedTaskScheduler::TaskQueue *queue = new ThreadedTaskScheduler::TaskQueue;
+      sched->add_task_queue(queue);
+      for(size_t i = 0; i < member_scheds.size(); i++) {
+	sched->add_steal_queue(member_queues[i]);
+	member_scheds[i]->add_steal_queue(queue);
+      }
+
+      member_procs.push_back(member);
+      member_scheds.push_back(sched);
+      member_queues.push_back(queue);
+    }
+
     void ProcessorGroup::enqueue_task(Task *task)
     {
-      // put it into the task queue - one of the member procs will eventually grab it
       task->mark_ready();
-      task_queue.put(task, task->priority);
+
+      if(member_queues.empty()) {
+	// put it into the shared task queue - one of the member procs will
+	//  eventually grab it
+	task_queue.put(task, task->priority);
+	return;
+      }
+
+      int n = member_queues.size();
+      int idx = -1;
+      if(cfg_affinity)
+	idx = last_member[task->func_id % AFFINITY_SLOTS];
+
+      if(idx < 0) {
+	// the counter also rotates the starting point of the shortest queue
+	//  search, so that ties don't all go to the first member
+	unsigned start = __sync_fetch_and_add(&next_member, 1);
+	idx = start % n;
+	if(cfg_dispatch_policy == DISPATCH_SHORTEST_QUEUE) {
+	  size_t best = member_queues[idx]->size();
+	  for(int i = 1; (i < n) && (best > 0); i++) {
+	    int j = (start + i) % n;
+	    size_t len = member_queues[j]->size();
+	    if(len < best) {
+	      best = len;
+	      idx = j;
+	    }
+	  }
+	}
+      }
+
+      member_queues[idx]->put(task, task->priority);
+    }
+
+    void ProcessorGroup::task_started(Task *task, Processor p)
+    {
+      // remember which member ran this function last - a stolen task moves its
+      //  function's later tasks to the thief
+      for(size_t i = 0; i < member_procs.size(); i++)
+	if(member_procs[i] == p) {
+	  last_member[task->func_id % AFFINITY_SLOTS] = i;
+	  return;
+	}
     }
 
     void ProcessorGroup::add_to_group(ProcessorGroup *group)
@@ -284,13 +360,14 @@ namespace Realm {
 						int priority)
     {
       // create a task object and insert it into the queue
-      Task *task = new Task(me, func_id, args, arglen, reqs,
-                            finish_event, priority);
+      Task *task = new(task_pool) Task(me, func_id, args, arglen, reqs,
+				       finish_event, priority);
 
       if (start_event.has_triggered())
         enqueue_task(task);
       else
-	EventImpl::add_waiter(start_event, new DeferredTaskSpawn(this, task));
+	EventImpl::add_waiter(start_event,
+			      new(deferred_spawn_pool) DeferredTaskSpawn(this, task));
     }
 
 
@@ -453,7 +530,7 @@ namespace Realm {
     Processor::TaskIDTable::iterator it = 
       get_runtime()->task_table.find(Processor::TASK_ID_PROCESSOR_INIT);
     if(it != get_runtime()->task_table.end()) {
-      Task *t = new Task(me, Processor::TASK_ID_PROCESSOR_INIT,
+      Task *t = new(task_pool) Task(me, Processor::TASK_ID_PROCESSOR_INIT,
 			 0, 0,
 			 Event::NO_EVENT, 0);
       task_queue.put(t, task_queue.PRI_MAX_FINITE);
@@ -468,8 +545,8 @@ namespace Realm {
 
   void LocalTaskProcessor::add_to_group(ProcessorGroup *group)
   {
-    // add the group's task queue to our scheduler too
-    sched->add_task_queue(&group->task_queue);
+    // the group decides which of its queues our scheduler should pull from
+    group->add_member_scheduler(me, sched);
   }
 
   void LocalTaskProcessor::enqueue_task(Task *task)
@@ -487,7 +564,7 @@ namespace Realm {
   {
     assert(func_id != 0);
     // create a task object for this
-    Task *task = new Task(me, func_id, args, arglen, reqs, finish_event, priority);
+    Task *task = new(task_pool) Task(me, func_id, args, arglen, reqs, finish_event, priority);
 
     // if the start event has already triggered, we can enqueue right away
     if(start_event.has_triggered()) {
@@ -499,7 +576,8 @@ namespace Realm {
       log_task.info("deferring spawn: func=%d event=" IDFMT "/%d finish=" IDFMT "/%d",
                func_id, start_event.id, start_event.gen,
                finish_event.id, finish_event.gen);
-      EventImpl::add_waiter(start_event, new DeferredTaskSpawn(this, task));
+      EventImpl::add_waiter(start_event,
+			    new(deferred_spawn_pool) DeferredTaskSpawn(this, task));
     }
   }
 
@@ -512,7 +590,7 @@ namespace Realm {
     Processor::TaskIDTable::iterator it = 
       get_runtime()->task_table.find(Processor::TASK_ID_PROCESSOR_SHUTDOWN);
     if(it != get_runtime()->task_table.end()) {
-      Task *t = new Task(me, Processor::TASK_ID_PROCESSOR_SHUTDOWN,
+      Task *t = new(task_pool) Task(me, Processor::TASK_ID_PROCESSOR_SHUTDOWN,
 			 0, 0,
 			 Event::NO_EVENT, 0);
       task_queue.put(t, task_queue.PRI_MIN_FINITE);
@@ -606,14 +684,187 @@ namespace Realm {
   }
 
 
+  ////////////////////////////////////////////////////////////////////////
+  //
+  // class AsyncIOEngine
+  //
+
+  AsyncIOEngine::AsyncIOEngine(Processor _proc, CoreReservationSet& crs,
+			       int _num_threads, int _max_in_flight)
+    : work_condvar(mutex), space_condvar(mutex)
+    , submissions(_max_in_flight), completions(_max_in_flight)
+    , in_flight(0), max_in_flight(_max_in_flight)
+    , retiring(false), shutdown_flag(false)
+  {
+    assert((_num_threads > 0) && (_max_in_flight > 0));
+
+    // the I/O threads spend nearly all their time in system calls
+    CoreReservationParameters params;
+    params.set_alu_usage(params.CORE_USAGE_SHARED);
+    params.set_fpu_usage(params.CORE_USAGE_MINIMAL);
+    params.set_ldst_usage(params.CORE_USAGE_SHARED);
+
+    std::string name = stringbuilder() << "async IO " << _proc;
+
+    core_rsrv = new CoreReservation(name, crs, params);
+
+    ThreadLaunchParameters tlp;
+    tlp.set_stack_size(64 << 10);
+    for(int i = 0; i < _num_threads; i++)
+      io_threads.push_back(Thread::create_kernel_thread<AsyncIOEngine,
+			                                &AsyncIOEngine::io_thread_loop>(this,
+											tlp,
+											*core_rsrv));
+  }
+
+  AsyncIOEngine::~AsyncIOEngine(void)
+  {
+    assert(io_threads.empty());
+    delete core_rsrv;
+  }
+
+  /*static*/ ssize_t AsyncIOEngine::perform_io(bool is_write, int fd, void *buffer,
+					       size_t bytes, off_t offset)
+  {
+    size_t done = 0;
+    while(done < bytes) {
+      ssize_t amt = (is_write ?
+		       pwrite(fd, ((const char *)buffer) + done, bytes - done, offset + done) :
+		       pread(fd, ((char *)buffer) + done, bytes - done, offset + done));
+      if(amt < 0) {
+	if(errno == EINTR) continue;
+	return -errno;
+      }
+      if(amt == 0) break;  // end of file
+      done += amt;
+    }
+    return done;
+  }
+
+  Event AsyncIOEngine::submit(bool is_write, int fd, void *buffer, size_t bytes,
+			      off_t offset, ssize_t *result)
+  {
+    Request r;
+    r.is_write = is_write;
+    r.fd = fd;
+    r.buffer = buffer;
+    r.bytes = bytes;
+    r.offset = offset;
+    r.result = result;
+    r.retval = 0;
+    r.finish_event = GenEventImpl::create_genevent()->current_event();
+
+    {
+      AutoHSLLock al(mutex);
+      assert(!shutdown_flag);
+      // the depth limit is the only thing that makes a submitter wait, and
+      //  the I/O threads free up space without needing anything from us
+      while(in_flight >= max_in_flight)
+	space_condvar.wait();
+      in_flight++;
+      submissions.push_back(r);
+      work_condvar.signal();
+    }
+
+    log_task.debug() << "async " << (is_write ? "write" : "read") << " queued: fd=" << fd
+		     << " bytes=" << bytes << " offset=" << offset
+		     << " event=" << r.finish_event;
+    return r.finish_event;
+  }
+
+  void AsyncIOEngine::io_thread_loop(void)
+  {
+    while(true) {
+      Request r;
+      {
+	AutoHSLLock al(mutex);
+	while(submissions.empty() && !shutdown_flag)
+	  work_condvar.wait();
+	// queued requests are finished even if we're shutting down
+	if(submissions.empty())
+	  break;
+	r = submissions.front();
+	submissions.pop_front();
+      }
+
+      r.retval = perform_io(r.is_write, r.fd, r.buffer, r.bytes, r.offset);
+
+      bool do_retire = false;
+      {
+	AutoHSLLock al(mutex);
+	completions.push_back(r);
+	if(!retiring)
+	  do_retire = retiring = true;
+      }
+
+      if(do_retire)
+	retire_completions();
+    }
+  }
+
+  void AsyncIOEngine::retire_completions(void)
+  {
+    // take everything that's completed in one go - other I/O threads keep
+    //  adding to the queue while we trigger, and we come back for those
+    std::vector<Request> batch;
+    while(true) {
+      {
+	AutoHSLLock al(mutex);
+	if(!batch.empty()) {
+	  in_flight -= batch.size();
+	  space_condvar.broadcast();
+	  batch.clear();
+	}
+	if(completions.empty()) {
+	  retiring = false;
+	  return;
+	}
+	while(!completions.empty()) {
+	  batch.push_back(completions.front());
+	  completions.pop_front();
+	}
+      }
+
+      for(std::vector<Request>::const_iterator it = batch.begin();
+	  it != batch.end();
+	  it++) {
+	if(it->result)
+	  *(it->result) = it->retval;
+	get_runtime()->get_genevent_impl(it->finish_event)->trigger(it->finish_event.gen,
+								    gasnet_mynode());
+      }
+    }
+  }
+
+  void AsyncIOEngine::shutdown(void)
+  {
+    {
+      AutoHSLLock al(mutex);
+      shutdown_flag = true;
+      work_condvar.broadcast();
+    }
+
+    for(std::vector<Thread *>::iterator it = io_threads.begin();
+	it != io_threads.end();
+	it++) {
+      (*it)->join();
+      delete (*it);
+    }
+    io_threads.clear();
+  }
+
+
   ////////////////////////////////////////////////////////////////////////
   //
   // class LocalIOProcessor
   //
 
   LocalIOProcessor::LocalIOProcessor(Processor _me, CoreReservationSet& crs,
-				     size_t _stack_size, int _concurrent_io_threads)
+				     size_t _stack_size, int _concurrent_io_threads,
+				     int _async_io_threads /*= 0*/,
+				     int _async_io_depth /*= 0*/)
     : LocalTaskProcessor(_me, Processor::IO_PROC)
+    , aio_engine(0)
   {
     CoreReservationParameters params;
     params.set_alu_usage(params.CORE_USAGE_SHARED);
@@ -625,6 +876,20 @@ namespace Realm {
 
     core_rsrv = new CoreReservation(name, crs, params);
 
+    if(_async_io_threads > 0) {
+      // in async mode, tasks wait on events rather than system calls, so user
+      //  threads let a single host thread keep many tasks' I/O in flight
+      aio_engine = new AsyncIOEngine(_me, crs, _async_io_threads, _async_io_depth);
+#ifdef REALM_USE_USER_THREADS
+      UserThreadTaskScheduler *sched = new UserThreadTaskScheduler(me, *core_rsrv);
+#else
+      KernelThreadTaskScheduler *sched = new KernelThreadTaskScheduler(me, *core_rsrv);
+      sched->cfg_max_active_workers = _concurrent_io_threads;
+#endif
+      set_scheduler(sched);
+      return;
+    }
+
     // IO processors always use kernel threads
     ThreadedTaskScheduler *sched = new KernelThreadTaskScheduler(me, *core_rsrv);
 
@@ -636,8 +901,56 @@ namespace Realm {
 
   LocalIOProcessor::~LocalIOProcessor(void)
   {
+    delete aio_engine;
     delete core_rsrv;
   }
 
+  void LocalIOProcessor::shutdown(void)
+  {
+    LocalTaskProcessor::shutdown();
+
+    // no tasks left to submit requests - let the I/O threads drain
+    if(aio_engine)
+      aio_engine->shutdown();
+  }
+
+
+  ////////////////////////////////////////////////////////////////////////
+  //
+  // class AsyncIO
+  //
+
+  static Event submit_async_io(bool is_write, int fd, void *buffer, size_t bytes,
+			       off_t offset, ssize_t *result)
+  {
+    // only tasks running on a local async IO processor get queued requests
+    Processor p = Processor::get_executing_processor();
+    if(p.exists() && (ID(p).node() == gasnet_mynode())) {
+      ProcessorImpl *impl = get_runtime()->get_processor_impl(p);
+      if(impl->kind == Processor::IO_PROC) {
+	AsyncIOEngine *engine = static_cast<LocalIOProcessor *>(impl)->aio_engine;
+	if(engine)
+	  return engine->submit(is_write, fd, buffer, bytes, offset, result);
+      }
+    }
+
+    ssize_t retval = AsyncIOEngine::perform_io(is_write, fd, buffer, bytes, offset);
+    if(result)
+      *result = retval;
+    return Event::NO_EVENT;
+  }
+
+  /*static*/ Event AsyncIO::read(int fd, void *buffer, size_t bytes, off_t offset,
+				 ssize_t *result /*= 0*/)
+  {
+    return submit_async_io(false, fd, buffer, bytes, offset, result);
+  }
+
+  /*static*/ Event AsyncIO::write(int fd, const void *buffer, size_t bytes, off_t offset,
+				  ssize_t *result /*= 0*/)
+  {
+    return submit_async_io(true, fd, const_cast<void *>(buffer), bytes, offset, result);
+  }
+
 
 }; // namespace Realm
@@ -30,6 +30,7 @@
 
 #include "tasks.h"
 #include "threads.h"
+#include "circ_queue.h"
 
 namespace Realm {
 
@@ -54,6 +55,10 @@ namespace Realm {
     public:
       Processor me;
       Processor::Kind kind;
+
+      // recycled storage for the Task and DeferredTaskSpawn objects created by
+      //  spawns on this processor
+      ObjectPool task_pool, deferred_spawn_pool;
     }; 
 
     // generic local task processor - subclasses must create and configure a task
@@ -110,11 +115,67 @@ namespace Realm {
       CoreReservation *core_rsrv;
     };
 
+    // the submission and completion queues behind an IO processor in async
+    //  mode - tasks queue reads and writes without blocking, a few I/O threads
+    //  perform them, and finished requests are retired in batches (results
+    //  stored, events triggered) by whichever I/O thread gets there first
+    class AsyncIOEngine {
+    public:
+      AsyncIOEngine(Processor _proc, CoreReservationSet& crs,
+		    int _num_threads, int _max_in_flight);
+      ~AsyncIOEngine(void);
+
+      // returns an event that triggers when the request is done - only blocks
+      //  the caller if max_in_flight requests are already outstanding
+      Event submit(bool is_write, int fd, void *buffer, size_t bytes, off_t offset,
+		   ssize_t *result);
+
+      // finishes any queued requests and stops the I/O threads
+      void shutdown(void);
+
+      // performs a request on the calling thread - short transfers are
+      //  retried, so the result is only short at end of file (or -errno)
+      static ssize_t perform_io(bool is_write, int fd, void *buffer, size_t bytes,
+				off_t offset);
+
+    protected:
+      struct Request {
+	bool is_write;
+	int fd;
+	void *buffer;
+	size_t bytes;
+	off_t offset;
+	ssize_t *result;
+	ssize_t retval;
+	Event finish_event;
+      };
+
+      void io_thread_loop(void);
+      void retire_completions(void);
+
+      CoreReservation *core_rsrv;
+      std::vector<Thread *> io_threads;
+
+      GASNetHSL mutex;
+      GASNetCondVar work_condvar, space_condvar;
+      CircularQueue<Request> submissions, completions;
+      int in_flight, max_in_flight;
+      bool retiring, shutdown_flag;
+    };
+
     class LocalIOProcessor : public LocalTaskProcessor {
     public:
+      // if _async_io_threads > 0, tasks run on user threads (where available)
+      //  and AsyncIO requests go to an engine with that many I/O threads and up
+      //  to _async_io_depth requests outstanding
       LocalIOProcessor(Processor _me, CoreReservationSet& crs, size_t _stack_size,
-		       int _concurrent_io_threads);
+		       int _concurrent_io_threads,
+		       int _async_io_threads = 0, int _async_io_depth = 0);
       virtual ~LocalIOProcessor(void);
+
+      virtual void shutdown(void);
+
+      AsyncIOEngine *aio_engine;  // 0 unless in async mode
     protected:
       CoreReservation *core_rsrv;
     };
@@ -160,6 +221,29 @@ namespace Realm {
                               int priority);
 
 
+      // called by each local member processor as it joins the group, to hook
+      //  its scheduler up to the right queue(s)
+      void add_member_scheduler(Processor member, ThreadedTaskScheduler *sched);
+
+      // called as a task sent to this group starts running on member 'p'
+      void task_started(Task *task, Processor p);
+
+      // how tasks sent to a group are assigned to its members:
+      //  SHARED - one queue polled by every member
+      //  ROUND_ROBIN/SHORTEST_QUEUE - each member has its own queue, and idle
+      //   members steal from the others' queues
+      enum DispatchPolicy {
+	DISPATCH_SHARED,
+	DISPATCH_ROUND_ROBIN,
+	DISPATCH_SHORTEST_QUEUE,
+      };
+
+      // set from the command line (-ll:group_dispatch, -ll:group_affinity)
+      static DispatchPolicy cfg_dispatch_policy;
+      // if set, a task is sent to whichever member last ran a task with the
+      //  same function ID (if any), to keep its caches warm
+      static bool cfg_affinity;
+
     public: //protected:
       bool members_valid;
       bool members_requested;
@@ -170,6 +254,16 @@ namespace Realm {
       void request_group_members(void);
 
       PriorityQueue<Task *, GASNetHSL> task_queue;      
+
+      // per-member queues (not used with DISPATCH_SHARED)
+      std::vector<Processor> member_procs;
+      std::vector<ThreadedTaskScheduler *> member_scheds;
+      std::vector<ThreadedTaskScheduler::TaskQueue *> member_queues;
+      unsigned next_member;  // for round-robin dispatch
+
+      // the member that last ran each function ID (hashed, so only a hint), or -1
+      static const int AFFINITY_SLOTS = 256;
+      volatile int last_member[AFFINITY_SLOTS];
     };
     
     // this is generally useful to all processor implementations, so put it here
@@ -186,6 +280,21 @@ namespace Realm {
       virtual bool event_triggered(void);
       virtual void print_info(FILE *f);
 
+      // allocated from the processor's pool, and returned to it when the
+      //  event system deletes us
+      static void *operator new(size_t bytes, ObjectPool& pool)
+      {
+	return pool.alloc_block(bytes);
+      }
+      static void operator delete(void *ptr, ObjectPool& pool)
+      {
+	ObjectPool::free_block(ptr);
+      }
+      static void operator delete(void *ptr)
+      {
+	ObjectPool::free_block(ptr);
+      }
+
     protected:
       ProcessorImpl *proc;
       Task *task;
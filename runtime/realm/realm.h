@@ -28,5 +28,6 @@
 #include "realm/machine.h"
 #include "realm/runtime.h"
 #include "realm/indexspace.h"
+#include "realm/async_io.h"
 
 #endif // ifndef REALM_H
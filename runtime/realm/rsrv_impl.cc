@@ -173,6 +173,7 @@ namespace Realm {
 	assert(!impl->in_use);
 
 	impl->in_use = true;
+	impl->enable_fast_path_if_idle();
 
 	log_reservation.info("reservation reused: reservation=" IDFMT "", impl->me.id);
 	return impl->me;
@@ -257,6 +258,7 @@ namespace Realm {
       count = ZERO_COUNT;
       log_reservation.spew("count init " IDFMT "=[%p]=%d", me.id, &count, count);
       mode = 0;
+      fast_state = FAST_SLOW;
       in_use = false;
       remote_waiter_mask = NodeSet(); 
       remote_sharer_mask = NodeSet();
@@ -302,6 +304,9 @@ namespace Realm {
       do {
 	AutoHSLLock a(impl->mutex);
 
+	// local holders may be using the fast path - pull them into count
+	impl->disable_fast_path();
+
 	// case 1: we don't even own the lock any more - pass the request on
 	//  to whoever we think the owner is
 	if(impl->owner != gasnet_mynode()) {
@@ -460,11 +465,117 @@ namespace Realm {
       }
     }
 
+    bool ReservationImpl::try_fast_acquire(unsigned new_mode, bool exclusive)
+    {
+      unsigned cur_state = fast_state;
+      while(true) {
+	if((cur_state & (FAST_SLOW | FAST_EXCL)) != 0)
+	  return false;
+
+	unsigned new_state;
+	if(exclusive || (new_mode == MODE_EXCL)) {
+	  // exclusive requests only succeed if nobody holds the lock
+	  if(cur_state != 0)
+	    return false;
+	  new_state = FAST_EXCL;
+	} else {
+	  // shared requests join any existing holders with the same mode
+	  if(new_mode > FAST_MODE_MASK)
+	    return false;
+	  unsigned holders = cur_state & FAST_COUNT_MASK;
+	  if(holders == 0)
+	    new_state = (new_mode << FAST_MODE_SHIFT) + 1;
+	  else if((((cur_state >> FAST_MODE_SHIFT) & FAST_MODE_MASK) == new_mode) &&
+		  (holders < FAST_COUNT_MASK))
+	    new_state = cur_state + 1;
+	  else
+	    return false;
+	}
+
+	unsigned prev_state = __sync_val_compare_and_swap(&fast_state,
+							  cur_state, new_state);
+	if(prev_state == cur_state)
+	  return true;
+	cur_state = prev_state;
+      }
+    }
+
+    bool ReservationImpl::try_fast_release(void)
+    {
+      unsigned cur_state = fast_state;
+      while(true) {
+	// holders that came in through the slow path always leave that way too
+	if((cur_state & FAST_SLOW) != 0)
+	  return false;
+
+	unsigned new_state;
+	if((cur_state & FAST_EXCL) != 0) {
+	  new_state = 0;
+	} else {
+	  unsigned holders = cur_state & FAST_COUNT_MASK;
+	  assert(holders > 0);
+	  new_state = (holders == 1) ? 0 : (cur_state - 1);
+	}
+
+	unsigned prev_state = __sync_val_compare_and_swap(&fast_state,
+							  cur_state, new_state);
+	if(prev_state == cur_state)
+	  return true;
+	cur_state = prev_state;
+      }
+    }
+
+    void ReservationImpl::disable_fast_path(void)
+    {
+      unsigned prev_state = __sync_fetch_and_or(&fast_state, (unsigned)FAST_SLOW);
+      if((prev_state & FAST_SLOW) != 0)
+	return;
+
+      // once the slow bit is set, nobody else modifies the holder bits, so
+      //  we can transfer them to count/mode without further synchronization
+      assert(count == ZERO_COUNT);
+      if((prev_state & FAST_EXCL) != 0) {
+	mode = MODE_EXCL;
+	count = ZERO_COUNT + 1;
+      } else if((prev_state & FAST_COUNT_MASK) != 0) {
+	mode = (prev_state >> FAST_MODE_SHIFT) & FAST_MODE_MASK;
+	count = ZERO_COUNT + (prev_state & FAST_COUNT_MASK);
+      }
+      log_reservation.spew("fast path disabled: reservation=" IDFMT " count=%d mode=%d",
+			   me.id, count, mode);
+      fast_state = FAST_SLOW;
+    }
+
+    void ReservationImpl::enable_fast_path_if_idle(void)
+    {
+      if((fast_state & FAST_SLOW) == 0)
+	return;
+
+      if((owner == gasnet_mynode()) &&
+	 (count == ZERO_COUNT) &&
+	 !requested &&
+	 local_waiters.empty() &&
+	 remote_waiter_mask.empty() &&
+	 remote_sharer_mask.empty() &&
+	 ((ID(me).node() != gasnet_mynode()) || in_use)) {
+	log_reservation.spew("fast path enabled: reservation=" IDFMT, me.id);
+	__sync_synchronize();
+	fast_state = 0;
+      }
+    }
+
     Event ReservationImpl::acquire(unsigned new_mode, bool exclusive,
 				     GenEventImpl *after_lock /* = 0*/)
     {
       Event after_lock_event = after_lock ? after_lock->current_event() : Event::NO_EVENT;
 
+      // uncontended local case - a single atomic update and we're done
+      if(try_fast_acquire(new_mode, exclusive)) {
+	if(after_lock)
+	  after_lock->trigger(after_lock_event.gen, gasnet_mynode());
+	return after_lock_event;
+      }
+
       log_reservation.debug(		      "local reservation request: reservation=" IDFMT " mode=%d excl=%d event=" IDFMT "/%d count=%d impl=%p",
 		      me.id, new_mode, exclusive, 
 		      after_lock_event.id,
@@ -484,6 +595,10 @@ namespace Realm {
 	assert((ID(me).node() != gasnet_mynode()) ||
 	       in_use);
 
+	// we're going to look at count/mode, so fast path holders have to
+	//  be accounted for there
+	disable_fast_path();
+
 	if(owner == gasnet_mynode()) {
 #ifdef LOCK_TRACING
           {
@@ -626,6 +741,10 @@ namespace Realm {
 
     void ReservationImpl::release(void)
     {
+      // if the lock was taken via the fast path, it can be released that way
+      if(try_fast_release())
+	return;
+
       // make a list of events that we be woken - can't do it while holding the
       //  lock's mutex (because the event we trigger might try to take the lock)
       std::deque<GenEventImpl *> to_wake;
@@ -680,6 +799,9 @@ namespace Realm {
 	  owner = new_owner;
           remote_waiter_mask = NodeSet();
 	}
+
+	// if nobody wanted the lock, future requests can use the fast path
+	enable_fast_path_if_idle();
       } while(0);
 
       if(release_target != -1)
@@ -740,14 +862,14 @@ namespace Realm {
       // checking the owner can be done atomically, so doesn't need mutex
       if(owner != gasnet_mynode()) return false;
 
-      // conservative check on lock count also doesn't need mutex
-      if(count == ZERO_COUNT) return false;
-
       // a careful check of the lock mode and count does require the mutex
       bool held;
       {
 	AutoHSLLock a(mutex);
 
+	// holders on the fast path don't show up in count
+	disable_fast_path();
+
 	held = ((count > ZERO_COUNT) &&
 		((mode == check_mode) || ((mode == 0) && excl_ok)));
       }
@@ -761,6 +883,9 @@ namespace Realm {
       {
 	AutoHSLLock al(mutex);
 
+	// the exclusive lock we hold may have come from the fast path
+	disable_fast_path();
+
 	// should only get here if the current node holds an exclusive lock
 	assert(owner == gasnet_mynode());
 	assert(count == 1 + ZERO_COUNT);
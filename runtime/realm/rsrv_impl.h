@@ -71,6 +71,18 @@ namespace Realm {
 
       enum { MODE_EXCL = 0, ZERO_COUNT = 0x11223344 };
 
+      // state word for the uncontended local fast path - while FAST_SLOW is
+      //  clear, the lock is owned by this node with no waiters and the holders
+      //  (if any) are tracked here rather than in count/mode
+      enum {
+	FAST_SLOW = 0x80000000U, // all requests must go through the mutex
+	FAST_EXCL = 0x40000000U, // held exclusively via the fast path
+	FAST_MODE_SHIFT = 20,    // mode of shared holders
+	FAST_MODE_MASK = 0x3ff,
+	FAST_COUNT_MASK = 0xfffff, // number of shared holders
+      };
+      volatile unsigned fast_state;
+
       GASNetHSL mutex; // controls which local thread has access to internal data (not runtime-visible lock)
 
       // bitmasks of which remote nodes are waiting on a lock (or sharing it)
@@ -94,6 +106,19 @@ namespace Realm {
 
       bool select_local_waiters(std::deque<GenEventImpl *>& to_wake);
 
+      // attempt to take/drop the lock with a single atomic update of
+      //  fast_state - returns false if the slow path must be used instead
+      bool try_fast_acquire(unsigned new_mode, bool exclusive);
+      bool try_fast_release(void);
+
+      // move any fast path holders into count/mode and force all future
+      //  requests through the slow path - NOTE: ASSUMES MUTEX IS HELD!
+      void disable_fast_path(void);
+
+      // re-enable the fast path if the lock is local and idle
+      //  - NOTE: ASSUMES MUTEX IS HELD!
+      void enable_fast_path_if_idle(void);
+
       void release(void);
 
       bool is_locked(unsigned check_mode, bool excl_ok);
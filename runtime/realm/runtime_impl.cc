@@ -23,7 +23,7 @@
 
 #include "activemsg.h"
 
-#ifndef USE_GASNET
+#if !defined(USE_GASNET) && !defined(USE_SHM_AM)
 /*extern*/ void *fake_gasnet_mem_base = 0;
 /*extern*/ size_t fake_gasnet_mem_size = 0;
 #endif
@@ -202,6 +202,12 @@ namespace Realm {
       LegionRuntime::Arrays::Mapping<1,1>::register_mapping<LegionRuntime::Arrays::FortranArrayLinearization<1> >();
       LegionRuntime::Arrays::Mapping<2,1>::register_mapping<LegionRuntime::Arrays::FortranArrayLinearization<2> >();
       LegionRuntime::Arrays::Mapping<3,1>::register_mapping<LegionRuntime::Arrays::FortranArrayLinearization<3> >();
+      LegionRuntime::Arrays::Mapping<1,1>::register_mapping<LegionRuntime::Arrays::TiledLinearization<1> >();
+      LegionRuntime::Arrays::Mapping<2,1>::register_mapping<LegionRuntime::Arrays::TiledLinearization<2> >();
+      LegionRuntime::Arrays::Mapping<3,1>::register_mapping<LegionRuntime::Arrays::TiledLinearization<3> >();
+      LegionRuntime::Arrays::Mapping<1,1>::register_mapping<LegionRuntime::Arrays::MortonLinearization<1> >();
+      LegionRuntime::Arrays::Mapping<2,1>::register_mapping<LegionRuntime::Arrays::MortonLinearization<2> >();
+      LegionRuntime::Arrays::Mapping<3,1>::register_mapping<LegionRuntime::Arrays::MortonLinearization<3> >();
       LegionRuntime::Arrays::Mapping<1,1>::register_mapping<LegionRuntime::Arrays::Translation<1> >();
 
       DetailedTimer::init_timers();
@@ -244,7 +250,7 @@ namespace Realm {
 #endif
 
       // low-level runtime parameters
-#ifdef USE_GASNET
+#if defined(USE_GASNET) || defined(USE_SHM_AM)
       size_t gasnet_mem_size_in_mb = 256;
 #else
       size_t gasnet_mem_size_in_mb = 0;
@@ -259,6 +265,8 @@ namespace Realm {
       unsigned num_util_procs = 1;
       unsigned num_io_procs = 0;
       unsigned concurrent_io_threads = 1; // Legion does not support values > 1 right now
+      unsigned async_io_threads = 0; // > 0 puts IO procs in async mode
+      unsigned async_io_depth = 256;
       //unsigned cpu_worker_threads = 1;
       unsigned dma_worker_threads = 1;
       unsigned active_msg_worker_threads = 1;
@@ -282,6 +290,11 @@ namespace Realm {
       // should local proc threads get dedicated cores?
       bool dummy_reservation_ok = true;
       bool show_reservations = false;
+      // event graph recorder (off unless a history size is given)
+      size_t event_graph_records = 0;
+      int event_graph_timeout = 0;
+      size_t event_graph_path = 20;
+      const char *event_graph_file = 0;
 
       for(int i = 1; i < *argc; i++) {
 #define INT_ARG(argname, varname)                       \
@@ -305,12 +318,27 @@ namespace Realm {
 	INT_ARG("-ll:util", num_util_procs);
         INT_ARG("-ll:io", num_io_procs);
 	INT_ARG("-ll:concurrent_io", concurrent_io_threads);
+	INT_ARG("-ll:async_io", async_io_threads);
+	INT_ARG("-ll:aio_depth", async_io_depth);
 	//INT_ARG("-ll:workers", cpu_worker_threads);
 	INT_ARG("-ll:dma", dma_worker_threads);
 	INT_ARG("-ll:amsg", active_msg_worker_threads);
 	INT_ARG("-ll:ahandlers", active_msg_handler_threads);
 	INT_ARG("-ll:dummy_rsrv_ok", dummy_reservation_ok);
 	INT_ARG("-ll:show_rsrv", show_reservations);
+	INT_ARG("-ll:group_affinity", ProcessorGroup::cfg_affinity);
+	if(!strcmp((*argv)[i], "-ll:group_dispatch")) {
+	  const char *policy = (*argv)[++i];
+	  if(!strcmp(policy, "shared"))
+	    ProcessorGroup::cfg_dispatch_policy = ProcessorGroup::DISPATCH_SHARED;
+	  else if(!strcmp(policy, "rr"))
+	    ProcessorGroup::cfg_dispatch_policy = ProcessorGroup::DISPATCH_ROUND_ROBIN;
+	  else if(!strcmp(policy, "shortest"))
+	    ProcessorGroup::cfg_dispatch_policy = ProcessorGroup::DISPATCH_SHORTEST_QUEUE;
+	  else
+	    fprintf(stderr, "WARNING: unknown group dispatch policy '%s' (expected shared, rr, or shortest)\n", policy);
+	  continue;
+	}
 #ifdef USE_CUDA
 	INT_ARG("-ll:fsize", fb_mem_size_in_mb);
 	INT_ARG("-ll:zsize", zc_mem_size_in_mb);
@@ -320,6 +348,14 @@ namespace Realm {
         INT_ARG("-ll:pin", pin_sysmem_for_gpu);
 #endif
 
+	INT_ARG("-ll:eventgraph", event_graph_records);
+	INT_ARG("-ll:eventgraph_timeout", event_graph_timeout);
+	INT_ARG("-ll:eventgraph_path", event_graph_path);
+	if(!strcmp((*argv)[i], "-ll:eventgraph_file")) {
+	  event_graph_file = (*argv)[++i];
+	  continue;
+	}
+
 	if(!strcmp((*argv)[i], "-ll:eventtrace")) {
 #ifdef EVENT_TRACING
 	  event_trace_file = strdup((*argv)[++i]);
@@ -351,7 +387,9 @@ namespace Realm {
 
         // Skip arguments that parsed in activemsg.cc
         if (!strcmp((*argv)[i], "-ll:numlmbs") || !strcmp((*argv)[i],"-ll:lmbsize") ||
-            !strcmp((*argv)[i], "-ll:forcelong") || !strcmp((*argv)[i],"-ll:sdpsize"))
+            !strcmp((*argv)[i], "-ll:forcelong") || !strcmp((*argv)[i],"-ll:sdpsize") ||
+            !strcmp((*argv)[i], "-ll:shm_nodes") || !strcmp((*argv)[i],"-ll:shm_ring") ||
+            !strcmp((*argv)[i], "-ll:shm_stats"))
         {
           i++;
           continue;
@@ -430,6 +468,10 @@ namespace Realm {
       hcount += MetadataResponseMessage::Message::add_handler_entries(&handlers[hcount], "Metadata Response AM");
       hcount += MetadataInvalidateMessage::Message::add_handler_entries(&handlers[hcount], "Metadata Invalidate AM");
       hcount += MetadataInvalidateAckMessage::Message::add_handler_entries(&handlers[hcount], "Metadata Inval Ack AM");
+      hcount += MetadataBulkRequestMessage::Message::add_handler_entries(&handlers[hcount], "Metadata Bulk Request AM");
+      hcount += MetadataBulkResponseMessage::Message::add_handler_entries(&handlers[hcount], "Metadata Bulk Response AM");
+      hcount += MetadataBulkInvalidateMessage::Message::add_handler_entries(&handlers[hcount], "Metadata Bulk Invalidate AM");
+      hcount += MetadataBulkInvalidateAckMessage::Message::add_handler_entries(&handlers[hcount], "Metadata Bulk Inval Ack AM");
       //hcount += TestMessage::add_handler_entries(&handlers[hcount], "Test AM");
       //hcount += TestMessage2::add_handler_entries(&handlers[hcount], "Test 2 AM");
 
@@ -437,7 +479,7 @@ namespace Realm {
 		     gasnet_mem_size_in_mb, reg_mem_size_in_mb,
 		     core_reservations,
 		     *argc, (const char **)*argv);
-#ifndef USE_GASNET
+#if !defined(USE_GASNET) && !defined(USE_SHM_AM)
       // network initialization is also responsible for setting the "zero_time"
       //  for relative timing - no synchronization necessary in non-gasnet case
       Realm::Clock::set_zero_time();
@@ -459,6 +501,10 @@ namespace Realm {
 	local_proc_group_free_list = new ProcessorGroupTableAllocator::FreeList(n.proc_groups, gasnet_mynode());
       }
 
+      if(event_graph_records > 0)
+	EventGraphRecorder::configure(event_graph_records, event_graph_timeout,
+				      event_graph_path, event_graph_file);
+
 #ifdef DEADLOCK_TRACE
       next_thread = 0;
       signaled_threads = 0;
@@ -536,7 +582,9 @@ namespace Realm {
 			   n->processors.size()).convert<Processor>();
 	  LocalIOProcessor *io = new LocalIOProcessor(p, core_reservations,
 						      stack_size_in_mb << 20,
-						      concurrent_io_threads);
+						      concurrent_io_threads,
+						      async_io_threads,
+						      async_io_depth);
           n->processors.push_back(io);
           local_io_procs.push_back(io);
         }
@@ -1159,6 +1207,15 @@ namespace Realm {
 #endif
 
 
+      // need to kill other threads too so we can actually terminate process -
+      //  do this before tearing down the tables below, since a message handler
+      //  (e.g. for a late event trigger) may still be looking things up
+      LegionRuntime::LowLevel::stop_dma_worker_threads();
+      stop_activemsg_threads();
+
+      // nothing should be recording events any more
+      EventGraphRecorder::shutdown();
+
       // delete processors, memories, nodes, etc.
       {
 	for(gasnet_node_t i = 0; i < gasnet_nodes(); i++) {
@@ -1184,11 +1241,6 @@ namespace Realm {
 	delete local_proc_group_free_list;
       }
 
-      // need to kill other threads too so we can actually terminate process
-      // Exit out of the thread
-      LegionRuntime::LowLevel::stop_dma_worker_threads();
-      stop_activemsg_threads();
-
       // if we are running as a background thread, just terminate this thread
       // if not, do a full process exit - gasnet may have started some threads we don't have handles for,
       //   and if they're left running, the app will hang
@@ -59,32 +59,19 @@ namespace Realm {
 
       typedef GASNetHSL LT;
       typedef int IT;
-      typedef DynamicTableNode<DynamicTableNodeBase<LT, IT> *, 1 << INNER_BITS, LT, IT> INNER_TYPE;
-      typedef DynamicTableNode<ET, 1 << LEAF_BITS, LT, IT> LEAF_TYPE;
+      typedef DynamicTableNode<DynamicTableNodeBase<IT> *, 1 << INNER_BITS, IT> INNER_TYPE;
+      typedef DynamicTableNode<ET, 1 << LEAF_BITS, IT> LEAF_TYPE;
       typedef DynamicTableFreeList<DynamicTableAllocator<ET, _INNER_BITS, _LEAF_BITS> > FreeList;
       
-      static LEAF_TYPE *new_leaf_node(IT first_index, IT last_index, 
-				      int owner, FreeList *free_list)
+      // the table gives the elements of a new leaf to the free list once
+      //  the leaf has been successfully added to the tree
+      static LEAF_TYPE *new_leaf_node(IT first_index, IT last_index, int owner)
       {
 	LEAF_TYPE *leaf = new LEAF_TYPE(0, first_index, last_index);
 	IT last_ofs = (((IT)1) << LEAF_BITS) - 1;
 	for(IT i = 0; i <= last_ofs; i++)
 	  leaf->elems[i].init(ID(ET::ID_TYPE, owner, first_index + i).convert<typeof(leaf->elems[0].me)>(), owner);
 
-	if(free_list) {
-	  // stitch all the new elements into the free list
-	  free_list->lock.lock();
-
-	  for(IT i = 0; i <= last_ofs; i++)
-	    leaf->elems[i].next_free = ((i < last_ofs) ? 
-					  &(leaf->elems[i+1]) :
-					  free_list->first_free);
-
-	  free_list->first_free = &(leaf->elems[first_index ? 0 : 1]);
-
-	  free_list->lock.unlock();
-	}
-
 	return leaf;
       }
     };
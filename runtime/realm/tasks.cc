@@ -24,11 +24,87 @@ namespace Realm {
   Logger log_task("task");
   Logger log_util("util");
 
+  ////////////////////////////////////////////////////////////////////////
+  //
+  // class ObjectPool
+  //
+
+  ObjectPool::ObjectPool(size_t _block_size, size_t _max_cached /*= 1024*/)
+    : block_size(_block_size), max_cached(_max_cached), num_cached(0)
+    , first_free(0)
+  {
+    assert(sizeof(BlockHeader) <= HEADER_BYTES);
+  }
+
+  ObjectPool::~ObjectPool(void)
+  {
+    while(first_free) {
+      BlockHeader *next = first_free->next_free;
+      free(first_free);
+      first_free = next;
+    }
+  }
+
+  void *ObjectPool::alloc_block(size_t bytes)
+  {
+    assert(bytes <= block_size);
+
+    BlockHeader *hdr = 0;
+    {
+      AutoHSLLock al(mutex);
+      if(first_free) {
+	hdr = first_free;
+	first_free = hdr->next_free;
+	num_cached--;
+      }
+    }
+
+    if(!hdr) {
+      hdr = (BlockHeader *)malloc(HEADER_BYTES + block_size);
+      assert(hdr != 0);
+      hdr->pool = this;
+    }
+    return ((char *)hdr) + HEADER_BYTES;
+  }
+
+  /*static*/ void ObjectPool::free_block(void *ptr)
+  {
+    BlockHeader *hdr = (BlockHeader *)(((char *)ptr) - HEADER_BYTES);
+    ObjectPool *pool = hdr->pool;
+    {
+      AutoHSLLock al(pool->mutex);
+      if(pool->num_cached < pool->max_cached) {
+	hdr->next_free = pool->first_free;
+	pool->first_free = hdr;
+	pool->num_cached++;
+	return;
+      }
+    }
+    // cache is full - give it back to malloc
+    free(hdr);
+  }
+
+
   ////////////////////////////////////////////////////////////////////////
   //
   // class Task
   //
 
+  /*static*/ void *Task::operator new(size_t bytes, ObjectPool& pool)
+  {
+    return pool.alloc_block(bytes);
+  }
+
+  /*static*/ void Task::operator delete(void *ptr, ObjectPool& pool)
+  {
+    ObjectPool::free_block(ptr);
+  }
+
+  /*static*/ void Task::operator delete(void *ptr)
+  {
+    ObjectPool::free_block(ptr);
+  }
+
   Task::Task(Processor _proc, Processor::TaskFuncID _func_id,
 	     const void *_args, size_t _arglen,
 	     const ProfilingRequestSet &reqs,
@@ -72,6 +148,11 @@ namespace Realm {
       measurements.add_measurement(opu);
     }
 
+    // a group that places tasks by affinity needs to know which member
+    //  actually ran each one
+    if(ProcessorGroup::cfg_affinity && (ID(proc).type() == ID::ID_PROCGROUP))
+      get_runtime()->get_procgroup_impl(proc)->task_started(this, p);
+
     mark_started();
 
     // make sure the current processor is set during execution of the task
@@ -221,7 +302,8 @@ namespace Realm {
   //
 
   ThreadedTaskScheduler::ThreadedTaskScheduler(void)
-    : shutdown_flag(false)
+    : next_steal_queue(0)
+    , shutdown_flag(false)
     , active_worker_count(0)
     , unassigned_worker_count(0)
     , wcu_task_queues(this)
@@ -253,6 +335,16 @@ namespace Realm {
     queue->add_subscription(&wcu_task_queues);
   }
 
+  void ThreadedTaskScheduler::add_steal_queue(TaskQueue *queue)
+  {
+    AutoHSLLock al(lock);
+
+    steal_queues.push_back(queue);
+
+    // idle workers need to hear about work they could steal too
+    queue->add_subscription(&wcu_task_queues);
+  }
+
   // helper for tracking/sanity-checking worker counts
   inline void ThreadedTaskScheduler::update_worker_count(int active_delta,
 							 int unassigned_delta,
@@ -425,6 +517,24 @@ namespace Realm {
 	  }
 	}
 
+	// nothing of our own to do - try to take something from another
+	//  scheduler's queue, starting with a different victim each time so
+	//  that one queue doesn't get picked clean
+	if(!task && !steal_queues.empty()) {
+	  size_t n = steal_queues.size();
+	  for(size_t i = 0; i < n; i++) {
+	    TaskQueue *victim = steal_queues[(next_steal_queue + i) % n];
+	    if(victim->empty()) continue;
+	    Task *new_task = victim->get(&task_priority);
+	    if(new_task) {
+	      task = new_task;
+	      task_source = victim;
+	      next_steal_queue = (next_steal_queue + i + 1) % n;
+	      break;
+	    }
+	  }
+	}
+
 	// did we find work to do?
 	if(task) {
 	  // we've now got some assigned work, so fire up a new idle worker if we were the last
@@ -892,7 +1002,10 @@ namespace Realm {
     // user threads can never start active
     assert(!make_active);
 
+    // workers run tasks, so they get the processor's stack size
     ThreadLaunchParameters tlp;
+    if(core_rsrv.params.max_stack_size != core_rsrv.params.STACK_SIZE_DEFAULT)
+      tlp.set_stack_size(core_rsrv.params.max_stack_size);
     Thread *t = Thread::create_user_thread<ThreadedTaskScheduler,
 					   &ThreadedTaskScheduler::scheduler_loop>(this,
 										   tlp,
@@ -30,6 +30,34 @@
 
 namespace Realm {
 
+    // a cache of fixed-size blocks for objects that are created and destroyed
+    //  at a high rate (e.g. tasks) - each block remembers which pool it came
+    //  from, so it can be released by any thread, but the pool must outlive
+    //  all of its blocks
+    class ObjectPool {
+    public:
+      ObjectPool(size_t _block_size, size_t _max_cached = 1024);
+      ~ObjectPool(void);
+
+      void *alloc_block(size_t bytes);
+
+      // returns a block to the pool it came from
+      static void free_block(void *ptr);
+
+    protected:
+      // sits in front of each block, padded out to HEADER_BYTES so blocks keep
+      //  malloc's alignment
+      struct BlockHeader {
+	ObjectPool *pool;
+	BlockHeader *next_free;
+      };
+      static const size_t HEADER_BYTES = 16;
+
+      size_t block_size, max_cached, num_cached;
+      BlockHeader *first_free;
+      GASNetHSL mutex;
+    };
+
     // information for a task launch
     class Task : public Operation {
     public:
@@ -41,6 +69,12 @@ namespace Realm {
 
       virtual ~Task(void);
 
+      // tasks are allocated from a processor's pool, and go back to it when
+      //  they delete themselves on completion
+      static void *operator new(size_t bytes, ObjectPool& pool);
+      static void operator delete(void *ptr, ObjectPool& pool);
+      static void operator delete(void *ptr);
+
       void execute_on_processor(Processor p);
 
       Processor proc;
@@ -65,6 +99,11 @@ namespace Realm {
 
       virtual void add_task_queue(TaskQueue *queue);
 
+      // steal queues belong to other schedulers (e.g. the other members of a
+      //  processor group) and are only checked when none of our own task queues
+      //  has anything to run
+      void add_steal_queue(TaskQueue *queue);
+
       virtual void start(void) = 0;
       virtual void shutdown(void) = 0;
 
@@ -90,6 +129,8 @@ namespace Realm {
 
       GASNetHSL lock;
       std::vector<TaskQueue *> task_queues;
+      std::vector<TaskQueue *> steal_queues;
+      size_t next_steal_queue;  // where the next search of steal_queues starts
       std::vector<Thread *> idle_workers;
 
       typedef PriorityQueue<Thread *, DummyLock> ResumableQueue;
@@ -32,6 +32,92 @@
 #endif
 
 #ifdef REALM_USE_USER_THREADS
+// on x86-64 and AArch64 Linux, user threads are switched by a few lines of
+//  assembly that save only the callee-saved state - swapcontext also saves
+//  and restores the signal mask, which is a system call on every switch
+//  (define REALM_USE_UCONTEXT to use swapcontext anyway)
+#if defined(__linux__) && (defined(__x86_64__) || defined(__aarch64__)) && !defined(REALM_USE_UCONTEXT)
+#define REALM_USE_FAST_CONTEXT_SWITCH
+#endif
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#ifdef REALM_USE_FAST_CONTEXT_SWITCH
+// saves the callee-saved registers (and floating point control state) on
+//  the current stack, stores the stack pointer in *save_sp, and then
+//  resumes the context whose stack pointer is restore_sp
+extern "C" void realm_user_context_switch(void **save_sp, void *restore_sp);
+
+#if defined(__x86_64__)
+asm(".text\n"
+    ".globl realm_user_context_switch\n"
+    ".hidden realm_user_context_switch\n"
+    ".type realm_user_context_switch,@function\n"
+    ".align 16\n"
+    "realm_user_context_switch:\n"
+    "  pushq %rbp\n"
+    "  pushq %rbx\n"
+    "  pushq %r12\n"
+    "  pushq %r13\n"
+    "  pushq %r14\n"
+    "  pushq %r15\n"
+    "  subq $8, %rsp\n"
+    "  stmxcsr (%rsp)\n"
+    "  fnstcw 4(%rsp)\n"
+    "  movq %rsp, (%rdi)\n"
+    "  movq %rsi, %rsp\n"
+    "  ldmxcsr (%rsp)\n"
+    "  fldcw 4(%rsp)\n"
+    "  addq $8, %rsp\n"
+    "  popq %r15\n"
+    "  popq %r14\n"
+    "  popq %r13\n"
+    "  popq %r12\n"
+    "  popq %rbx\n"
+    "  popq %rbp\n"
+    "  ret\n"
+    ".size realm_user_context_switch,.-realm_user_context_switch\n");
+#elif defined(__aarch64__)
+asm(".text\n"
+    ".globl realm_user_context_switch\n"
+    ".hidden realm_user_context_switch\n"
+    ".type realm_user_context_switch,%function\n"
+    ".align 4\n"
+    "realm_user_context_switch:\n"
+    "  sub sp, sp, #176\n"
+    "  stp x19, x20, [sp, #0]\n"
+    "  stp x21, x22, [sp, #16]\n"
+    "  stp x23, x24, [sp, #32]\n"
+    "  stp x25, x26, [sp, #48]\n"
+    "  stp x27, x28, [sp, #64]\n"
+    "  stp x29, x30, [sp, #80]\n"
+    "  stp d8, d9, [sp, #96]\n"
+    "  stp d10, d11, [sp, #112]\n"
+    "  stp d12, d13, [sp, #128]\n"
+    "  stp d14, d15, [sp, #144]\n"
+    "  mrs x9, fpcr\n"
+    "  str x9, [sp, #160]\n"
+    "  mov x9, sp\n"
+    "  str x9, [x0]\n"
+    "  mov sp, x1\n"
+    "  ldr x9, [sp, #160]\n"
+    "  msr fpcr, x9\n"
+    "  ldp d14, d15, [sp, #144]\n"
+    "  ldp d12, d13, [sp, #128]\n"
+    "  ldp d10, d11, [sp, #112]\n"
+    "  ldp d8, d9, [sp, #96]\n"
+    "  ldp x29, x30, [sp, #80]\n"
+    "  ldp x27, x28, [sp, #64]\n"
+    "  ldp x25, x26, [sp, #48]\n"
+    "  ldp x23, x24, [sp, #32]\n"
+    "  ldp x21, x22, [sp, #16]\n"
+    "  ldp x19, x20, [sp, #0]\n"
+    "  add sp, sp, #176\n"
+    "  ret\n"
+    ".size realm_user_context_switch,.-realm_user_context_switch\n");
+#endif
+#else
 #include <ucontext.h>
 #ifdef __MACH__
 // MacOS has (loudly) deprecated set/get/make/swapcontext,
@@ -49,11 +135,14 @@ inline void makecontext_wrap(ucontext_t *u, void (*fn)(), int args, ...) { makec
 #define makecontext makecontext_wrap
 #endif
 #endif
+#endif
 
 #include <string.h>
 #include <stdlib.h>
 #include <string>
 #include <map>
+#include <vector>
+#include <errno.h>
 
 #ifdef __linux__
 // needed for scanning Linux's /sys
@@ -669,6 +758,135 @@ namespace Realm {
   // class UserThread
 
 #ifdef REALM_USE_USER_THREADS
+#ifdef REALM_USE_FAST_CONTEXT_SWITCH
+  // a suspended context is just its stack pointer - everything else was
+  //  pushed onto its stack by realm_user_context_switch
+  struct UserContext {
+    void *sp;
+  };
+
+  // builds an initial frame that realm_user_context_switch will "return"
+  //  into, starting 'entry' on the new stack
+  static void make_user_context(UserContext& ctx, void *stack_base, size_t stack_size,
+				void (*entry)(void))
+  {
+    void **frame = (void **)((((size_t)stack_base) + stack_size) & ~(size_t)15);
+#if defined(__x86_64__)
+    *--frame = 0;               // entry's (never used) return address
+    *--frame = (void *)entry;   // popped by the 'ret'
+    for(int i = 0; i < 6; i++)
+      *--frame = 0;             // rbp, rbx, r12-r15
+    // default MXCSR and x87 control word
+    --frame;
+    ((unsigned *)frame)[0] = 0x1f80;
+    ((unsigned *)frame)[1] = 0x037f;
+#elif defined(__aarch64__)
+    frame -= 22;                // 176 bytes: x19-x30, d8-d15, fpcr
+    memset(frame, 0, 22 * sizeof(void *));
+    frame[11] = (void *)entry;  // x30 - where the 'ret' goes
+#endif
+    ctx.sp = frame;
+  }
+
+  static inline int swap_user_context(UserContext *save, UserContext *restore)
+  {
+    realm_user_context_switch(&(save->sp), restore->sp);
+    return 0;
+  }
+#else
+  typedef ucontext_t UserContext;
+
+  static void make_user_context(UserContext& ctx, void *stack_base, size_t stack_size,
+				void (*entry)(void))
+  {
+    getcontext(&ctx);
+
+    ctx.uc_link = 0; // we don't expect it to ever fall through
+    ctx.uc_stack.ss_sp = stack_base;
+    ctx.uc_stack.ss_size = stack_size;
+    ctx.uc_stack.ss_flags = 0;
+
+    // grr...  entry point takes int's, which might not hold a void *
+    // we'll just fish our UserThread * out of TLS
+    makecontext(&ctx, entry, 0);
+  }
+
+  static inline int swap_user_context(UserContext *save, UserContext *restore)
+  {
+    return swapcontext(save, restore);
+  }
+#endif
+
+  // user thread stacks are mmap'd with a guard page below them, so an
+  //  overflow faults instead of scribbling on somebody else's memory, and
+  //  pages are only committed as they're touched - a task that blocks
+  //  usually means a new worker thread, so freed stacks are kept for reuse
+  namespace UserThreadStacks {
+    static const size_t MAX_CACHED_STACKS = 64;
+
+    static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+    static std::map<size_t, std::vector<void *> > *cached = 0;
+
+    static size_t page_size(void)
+    {
+      static size_t size = 0;
+      if(!size)
+	size = sysconf(_SC_PAGESIZE);
+      return size;
+    }
+
+    // returns the lowest usable address - the guard page is just below it
+    static void *alloc_stack(size_t stack_size)
+    {
+      CHECK_PTHREAD( pthread_mutex_lock(&mutex) );
+      if(cached) {
+	std::map<size_t, std::vector<void *> >::iterator it = cached->find(stack_size);
+	if((it != cached->end()) && !it->second.empty()) {
+	  void *base = it->second.back();
+	  it->second.pop_back();
+	  CHECK_PTHREAD( pthread_mutex_unlock(&mutex) );
+	  return base;
+	}
+      }
+      CHECK_PTHREAD( pthread_mutex_unlock(&mutex) );
+
+      int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+#ifdef MAP_NORESERVE
+      flags |= MAP_NORESERVE;
+#endif
+#ifdef MAP_STACK
+      flags |= MAP_STACK;
+#endif
+      void *mapping = mmap(0, stack_size + page_size(), PROT_READ | PROT_WRITE, flags, -1, 0);
+      if(mapping == MAP_FAILED) {
+	log_thread.fatal() << "failed to map user thread stack of " << stack_size
+			   << " bytes: " << strerror(errno);
+	assert(0);
+      }
+      int ret = mprotect(mapping, page_size(), PROT_NONE);
+      assert(ret == 0);
+      return ((char *)mapping) + page_size();
+    }
+
+    static void free_stack(void *base, size_t stack_size)
+    {
+      CHECK_PTHREAD( pthread_mutex_lock(&mutex) );
+      if(!cached)
+	cached = new std::map<size_t, std::vector<void *> >;
+      std::vector<void *>& v = (*cached)[stack_size];
+      if(v.size() < MAX_CACHED_STACKS) {
+	v.push_back(base);
+	base = 0;
+      }
+      CHECK_PTHREAD( pthread_mutex_unlock(&mutex) );
+
+      if(base) {
+	int ret = munmap(((char *)base) - page_size(), stack_size + page_size());
+	assert(ret == 0);
+      }
+    }
+  };
+
   class UserThread : public Thread {
   public:
     UserThread(void *_target, void (*_entry_wrapper)(void *),
@@ -691,7 +909,7 @@ namespace Realm {
     void *target;
     void (*entry_wrapper)(void *);
     int magic;
-    ucontext_t ctx;
+    UserContext ctx;
     void *stack_base;
     size_t stack_size;
     bool ok_to_delete;
@@ -712,11 +930,11 @@ namespace Realm {
     assert(!running);
 
     if(stack_base != 0)
-      free(stack_base);
+      UserThreadStacks::free_stack(stack_base, stack_size);
   }
 
   namespace ThreadLocal {
-    __thread ucontext_t *host_context = 0;
+    __thread UserContext *host_context = 0;
     // current_user_thread is redundant with current_thread, but kept for debugging
     //  purposes for now
     __thread UserThread *current_user_thread = 0;
@@ -766,20 +984,13 @@ namespace Realm {
     } else {
       stack_size = 2 << 20; // pick something - 2MB ?
     }
+    // whole pages, so that stacks of similar sizes can be reused
+    stack_size = ((stack_size + UserThreadStacks::page_size() - 1) &
+		  ~(UserThreadStacks::page_size() - 1));
 
-    stack_base = malloc(stack_size);
-    assert(stack_base != 0);
-
-    getcontext(&ctx);
-
-    ctx.uc_link = 0; // we don't expect it to ever fall through
-    ctx.uc_stack.ss_sp = stack_base;
-    ctx.uc_stack.ss_size = stack_size;
-    ctx.uc_stack.ss_flags = 0;
+    stack_base = UserThreadStacks::alloc_stack(stack_size);
 
-    // grr...  entry point takes int's, which might not hold a void *
-    // we'll just fish our UserThread * out of TLS
-    makecontext(&ctx, uthread_entry, 0);
+    make_user_context(ctx, stack_base, stack_size, uthread_entry);
 
     update_state(STATE_STARTUP);    
   }
@@ -811,14 +1022,14 @@ namespace Realm {
       assert(ThreadLocal::host_context == 0);
 
       // this holds the host's state
-      ucontext_t host_ctx;
+      UserContext host_ctx;
 
       ThreadLocal::host_context = &host_ctx;
       ThreadLocal::current_user_thread = switch_to;
       ThreadLocal::current_host_thread = ThreadLocal::current_thread;
       ThreadLocal::current_thread = switch_to;
 
-      int ret = swapcontext(&host_ctx, &switch_to->ctx);
+      int ret = swap_user_context(&host_ctx, &switch_to->ctx);
 
       // if we return with a value of 0, that means we were (eventually) given control
       //  back, as we hoped
@@ -841,7 +1052,7 @@ namespace Realm {
 	ThreadLocal::current_thread = switch_to;
 
 	// a switch between two user contexts - nice and simple
-	int ret = swapcontext(&switch_from->ctx, &switch_to->ctx);
+	int ret = swap_user_context(&switch_from->ctx, &switch_to->ctx);
 	assert(ret == 0);
 
 	assert(switch_from->running == false);
@@ -853,7 +1064,7 @@ namespace Realm {
 	ThreadLocal::current_thread = ThreadLocal::current_host_thread;
 	ThreadLocal::current_host_thread = 0;
 
-	int ret = swapcontext(&switch_from->ctx, ThreadLocal::host_context);
+	int ret = swap_user_context(&switch_from->ctx, ThreadLocal::host_context);
 	assert(ret == 0);
 
 	// if we get control back
@@ -157,11 +157,12 @@ namespace LegionRuntime {
       else
         new_part = create_node(pid, parent_node, part_color, color_space, 
                                (part_kind == DISJOINT_KIND), mode);
-#ifdef LEGION_SPY
-      bool disjoint = (part_kind == DISJOINT_KIND);
-      LegionSpy::log_index_partition(parent.id, pid.id, disjoint,
-          part_color.get_point());
-#endif
+      if (LegionSpy::spy_logging)
+      {
+        bool disjoint = (part_kind == DISJOINT_KIND);
+        LegionSpy::log_index_partition(parent.id, pid.id, disjoint,
+            part_color.get_point());
+      }
       // Now do all the child nodes
       for (std::map<DomainPoint,Domain>::const_iterator it = 
             coloring.begin(); it != coloring.end(); it++)
@@ -181,9 +182,7 @@ namespace LegionRuntime {
                           pid.get_tree_id());
         create_node(handle, it->second, new_part, ColorPoint(it->first),
                     parent_node->kind, mode);
-#ifdef LEGION_SPY
         LegionSpy::log_index_subspace(pid.id, handle.id, it->first);
-#endif
       } 
       if (part_kind == COMPUTE_KIND)
       {
@@ -223,11 +222,12 @@ namespace LegionRuntime {
       else
         new_part = create_node(pid, parent_node, part_color, color_space, 
                                             (part_kind == DISJOINT_KIND), mode);
-#ifdef LEGION_SPY
-      bool disjoint = (part_kind == DISJOINT_KIND);
-      LegionSpy::log_index_partition(parent.id, pid.id, disjoint,
-          part_color.get_point());
-#endif
+      if (LegionSpy::spy_logging)
+      {
+        bool disjoint = (part_kind == DISJOINT_KIND);
+        LegionSpy::log_index_partition(parent.id, pid.id, disjoint,
+            part_color.get_point());
+      }
       // Now do all the child nodes
       std::map<DomainPoint,std::set<Domain> >::const_iterator comp_it = 
         component_domains.begin();
@@ -251,9 +251,7 @@ namespace LegionRuntime {
                                             new_part, ColorPoint(it->first),
                                             parent_node->kind, mode);
         child->update_component_domains(comp_it->second);
-#ifdef LEGION_SPY
         LegionSpy::log_index_subspace(pid.id, handle.id, it->first);
-#endif
       }
       if (part_kind == COMPUTE_KIND)
       {
@@ -488,11 +486,12 @@ namespace LegionRuntime {
         partition_node = create_node(pid, parent_node, partition_color,
                                      color_space, (part_kind == DISJOINT_KIND),
                                      allocable ? MUTABLE : NO_MEMORY);
-#ifdef LEGION_SPY
-      bool disjoint = (part_kind == DISJOINT_KIND);
-      LegionSpy::log_index_partition(parent.id, pid.id, disjoint,
-          partition_color.get_point());
-#endif
+      if (LegionSpy::spy_logging)
+      {
+        bool disjoint = (part_kind == DISJOINT_KIND);
+        LegionSpy::log_index_partition(parent.id, pid.id, disjoint,
+            partition_color.get_point());
+      }
       // We also need to explicitly instantiate all the children so
       // that they know the domains will be ready at a later time.
       // We instantiate them with an empty domain that will be filled in later
@@ -519,9 +518,7 @@ namespace LegionRuntime {
           create_node(is, handle_ready, domain_ready,
                       partition_node, child_color, parent_node->kind, 
                       allocable ? MUTABLE : NO_MEMORY);
-#ifdef LEGION_SPY
         LegionSpy::log_index_subspace(pid.id, is.id, itr.p);
-#endif
       }
       // If we need to compute the disjointness, only do that
       // after the partition is actually ready
@@ -538,9 +535,7 @@ namespace LegionRuntime {
         runtime->issue_runtime_meta_task(&args, sizeof(args),
                                          HLR_DISJOINTNESS_TASK_ID, NULL,
                                          domain_ready);
-#ifdef LEGION_SPY
         LegionSpy::log_event_dependence(domain_ready, disjointness_event);
-#endif
       }
     }
 
@@ -624,9 +619,7 @@ namespace LegionRuntime {
       // Ask the parent node to make all the subspaces
       Event result = parent_node->create_subspaces_by_field(field_data,
                 subspaces, ((pending_node->mode & MUTABLE) != 0), precondition);
-#ifdef LEGION_SPY
         LegionSpy::log_event_dependence(precondition, result);
-#endif
       // Now update the domains for all the sub-regions
       for (Domain::DomainPointIterator itr(color_space); itr; itr++)
       {
@@ -686,9 +679,7 @@ namespace LegionRuntime {
       // Ask the parent node to make all the subspaces
       Event result = parent_node->create_subspaces_by_image(field_data,
                 subspaces, ((pending_node->mode & MUTABLE) != 0), precondition);
-#ifdef LEGION_SPY
         LegionSpy::log_event_dependence(precondition, result);
-#endif
       // Now update the domains for all the sub-regions
       for (Domain::DomainPointIterator itr(color_space); itr; itr++)
       {
@@ -750,9 +741,7 @@ namespace LegionRuntime {
       // Ask the parent node to make all the subspaces
       Event result = parent_node->create_subspaces_by_preimage(field_data,
                 subspaces, ((pending_node->mode & MUTABLE) != 0), precondition);
-#ifdef LEGION_SPY
         LegionSpy::log_event_dependence(precondition, result);
-#endif
       // Now update the domains for all the sub-regions
       for (Domain::DomainPointIterator itr(color_space); itr; itr++)
       {
@@ -833,9 +822,7 @@ namespace LegionRuntime {
           parent_dom.get_index_space(), precondition);
       // Now set the result and trigger the handle ready event
       child_node->set_domain(Domain(result));
-#ifdef LEGION_SPY
         LegionSpy::log_event_dependence(precondition, ready);
-#endif
       return ready;
     }
 
@@ -878,9 +865,7 @@ namespace LegionRuntime {
           parent_dom.get_index_space(), precondition);
       // Now set the result and trigger the handle ready event
       child_node->set_domain(Domain(result));
-#ifdef LEGION_SPY
         LegionSpy::log_event_dependence(precondition, ready);
-#endif
       return ready;
     }
 
@@ -925,9 +910,7 @@ namespace LegionRuntime {
           parent_dom.get_index_space(), precondition);
       // Now set the result and trigger the handle ready event
       child_node->set_domain(Domain(result));
-#ifdef LEGION_SPY
         LegionSpy::log_event_dependence(precondition, ready);
-#endif
       return ready;
     }
 
@@ -4036,9 +4019,16 @@ namespace LegionRuntime {
 
     //--------------------------------------------------------------------------
     PhysicalInstance RegionTreeForest::create_instance(const Domain &dom,
-                                Memory target, size_t field_size, Operation *op)
+                                Memory target, size_t field_size, 
+                                const InstanceOrder &order, Operation *op)
     //--------------------------------------------------------------------------
     {
+      // Only the multi-field path knows how to ask for a tiled ordering
+      if (order.kind != InstanceOrder::LINEAR)
+      {
+        std::vector<size_t> field_sizes(1, field_size);
+        return create_instance(dom, target, field_sizes, 1/*bf*/, order, op);
+      }
       if (runtime->profiler != NULL)
       {
         Realm::ProfilingRequestSet requests;
@@ -4052,9 +4042,18 @@ namespace LegionRuntime {
     //--------------------------------------------------------------------------
     PhysicalInstance RegionTreeForest::create_instance(const Domain &dom,
                           Memory target, const std::vector<size_t> &field_sizes, 
-                          size_t blocking_factor, Operation *op)
+                          size_t blocking_factor, const InstanceOrder &order,
+                          Operation *op)
     //--------------------------------------------------------------------------
     {
+      if (order.kind != InstanceOrder::LINEAR)
+      {
+        Realm::ProfilingRequestSet reqs;
+        if (runtime->profiler != NULL)
+          runtime->profiler->add_inst_request(reqs, op);
+        return dom.create_instance(target, field_sizes, blocking_factor, 
+                                   order, reqs);
+      }
       if (runtime->profiler != NULL)
       {
         Realm::ProfilingRequestSet reqs;
@@ -4217,11 +4216,12 @@ namespace LegionRuntime {
     //--------------------------------------------------------------------------
     {
       get_node(handle)->attach_semantic_information(tag, source, buffer, size);
-#ifdef LEGION_SPY
-      if (NAME_SEMANTIC_TAG == tag)
-        LegionSpy::log_index_space_name(handle.id,
-            reinterpret_cast<const char*>(buffer));
-#endif
+      if (LegionSpy::spy_logging)
+      {
+        if (NAME_SEMANTIC_TAG == tag)
+          LegionSpy::log_index_space_name(handle.id,
+              reinterpret_cast<const char*>(buffer));
+      }
     }
 
     //--------------------------------------------------------------------------
@@ -4233,11 +4233,12 @@ namespace LegionRuntime {
     //--------------------------------------------------------------------------
     {
       get_node(handle)->attach_semantic_information(tag, source, buffer, size);
-#ifdef LEGION_SPY
-      if (NAME_SEMANTIC_TAG == tag)
-        LegionSpy::log_index_partition_name(handle.id,
-            reinterpret_cast<const char*>(buffer));
-#endif
+      if (LegionSpy::spy_logging)
+      {
+        if (NAME_SEMANTIC_TAG == tag)
+          LegionSpy::log_index_partition_name(handle.id,
+              reinterpret_cast<const char*>(buffer));
+      }
     }
 
     //--------------------------------------------------------------------------
@@ -4249,11 +4250,12 @@ namespace LegionRuntime {
     //--------------------------------------------------------------------------
     {
       get_node(handle)->attach_semantic_information(tag, source, buffer, size);
-#ifdef LEGION_SPY
-      if (NAME_SEMANTIC_TAG == tag)
-        LegionSpy::log_field_space_name(handle.id,
-            reinterpret_cast<const char*>(buffer));
-#endif
+      if (LegionSpy::spy_logging)
+      {
+        if (NAME_SEMANTIC_TAG == tag)
+          LegionSpy::log_field_space_name(handle.id,
+              reinterpret_cast<const char*>(buffer));
+      }
     }
 
     //--------------------------------------------------------------------------
@@ -4266,11 +4268,12 @@ namespace LegionRuntime {
     //--------------------------------------------------------------------------
     {
       get_node(handle)->attach_semantic_information(fid, tag, src, buf, size);
-#ifdef LEGION_SPY
-      if (NAME_SEMANTIC_TAG == tag)
-        LegionSpy::log_field_name(handle.id, fid,
-            reinterpret_cast<const char*>(buf));
-#endif
+      if (LegionSpy::spy_logging)
+      {
+        if (NAME_SEMANTIC_TAG == tag)
+          LegionSpy::log_field_name(handle.id, fid,
+              reinterpret_cast<const char*>(buf));
+      }
     }
 
     //--------------------------------------------------------------------------
@@ -4282,12 +4285,13 @@ namespace LegionRuntime {
     //--------------------------------------------------------------------------
     {
       get_node(handle)->attach_semantic_information(tag, source, buffer, size);
-#ifdef LEGION_SPY
-      if (NAME_SEMANTIC_TAG == tag)
-        LegionSpy::log_logical_region_name(handle.index_space.id,
-            handle.field_space.id, handle.tree_id,
-            reinterpret_cast<const char*>(buffer));
-#endif
+      if (LegionSpy::spy_logging)
+      {
+        if (NAME_SEMANTIC_TAG == tag)
+          LegionSpy::log_logical_region_name(handle.index_space.id,
+              handle.field_space.id, handle.tree_id,
+              reinterpret_cast<const char*>(buffer));
+      }
     }
 
     //--------------------------------------------------------------------------
@@ -4299,12 +4303,13 @@ namespace LegionRuntime {
     //--------------------------------------------------------------------------
     {
       get_node(handle)->attach_semantic_information(tag, source, buffer, size);
-#ifdef LEGION_SPY
-      if (NAME_SEMANTIC_TAG == tag)
-        LegionSpy::log_logical_partition_name(handle.index_partition.id,
-            handle.field_space.id, handle.tree_id,
-            reinterpret_cast<const char*>(buffer));
-#endif
+      if (LegionSpy::spy_logging)
+      {
+        if (NAME_SEMANTIC_TAG == tag)
+          LegionSpy::log_logical_partition_name(handle.index_partition.id,
+              handle.field_space.id, handle.tree_id,
+              reinterpret_cast<const char*>(buffer));
+      }
     }
 
     //--------------------------------------------------------------------------
@@ -5859,6 +5864,25 @@ namespace LegionRuntime {
       return non_empty;
     }
 
+    //--------------------------------------------------------------------------
+    template<unsigned DIM>
+    /*static*/ bool IndexTreeNode::compute_rect_dominates(
+            const std::set<Domain> &left_set, const std::set<Domain> &right_set)
+    //--------------------------------------------------------------------------
+    {
+      RectangleSet<DIM> rectangles;
+      for (std::set<Domain>::const_iterator it = left_set.begin();
+            it != left_set.end(); it++)
+        rectangles.add_rectangle(it->get_rect<DIM>());
+      for (std::set<Domain>::const_iterator it = right_set.begin();
+            it != right_set.end(); it++)
+      {
+        if (!rectangles.covers(it->get_rect<DIM>()))
+          return false;
+      }
+      return true;
+    }
+
     //--------------------------------------------------------------------------
     /*static*/ bool IndexTreeNode::compute_dominates(
             const std::set<Domain> &left_set, const std::set<Domain> &right_set)
@@ -5971,13 +5995,17 @@ namespace LegionRuntime {
               // Construct an interval tree for the left set
               // and then check to see if all the intervals within
               // the right set are dominated by an interval in the tree
-              IntervalTree<int,true/*discrete*/> intervals;
+              std::vector<std::pair<int,int> > left_intervals;
+              left_intervals.reserve(left_set.size());
               for (std::set<Domain>::const_iterator it = left_set.begin();
                     it != left_set.end(); it++)
               {
                 Rect<1> left_rect = it->get_rect<1>();
-                intervals.insert(left_rect.lo[0], left_rect.hi[0]);
+                left_intervals.push_back(
+                    std::pair<int,int>(left_rect.lo[0], left_rect.hi[0]));
               }
+              IntervalTree<int,true/*discrete*/> intervals;
+              intervals.build(left_intervals);
               dominates = true;
               for (std::set<Domain>::const_iterator it = right_set.begin();
                     it != right_set.end(); it++)
@@ -5993,54 +6021,12 @@ namespace LegionRuntime {
             }
           case 2:
             {
-              RectangleSet<int,true/*discrete*/> rectangles;
-              for (std::set<Domain>::const_iterator it = left_set.begin();
-                    it != left_set.end(); it++)
-              {
-                Rect<2> left_rect = it->get_rect<2>();
-                rectangles.add_rectangle(left_rect.lo[0], left_rect.lo[1],
-                                         left_rect.hi[0], left_rect.hi[1]);
-              }
-              dominates = true;
-              for (std::set<Domain>::const_iterator it = right_set.begin();
-                    it != right_set.end(); it++)
-              {
-                Rect<2> right_rect = it->get_rect<2>();
-                if (!rectangles.covers(right_rect.lo[0], right_rect.lo[1],
-                                       right_rect.hi[0], right_rect.hi[1]))
-                {
-                  dominates = false;
-                  break;
-                }
-              }
+              dominates = compute_rect_dominates<2>(left_set, right_set);
               break;
             }
           case 3:
             {
-              // TODO: Improve this terrible approximation
-              dominates = true;
-              for (std::set<Domain>::const_iterator rit = right_set.begin();
-                    (rit != right_set.end()) && dominates; rit++)
-              {
-                Rect<3> right_rect = rit->get_rect<3>();
-                bool has_dominator = false;
-                // See if any of the rectangles on the left dominate it
-                for (std::set<Domain>::const_iterator lit = left_set.begin();
-                      lit != left_set.end(); lit++)
-                {
-                  Rect<3> left_rect = lit->get_rect<3>();
-                  if (right_rect.intersection(left_rect) == right_rect)
-                  {
-                    has_dominator = true;
-                    break;
-                  }
-                }
-                if (!has_dominator)
-                {
-                  dominates = false;
-                  break;
-                }
-              }
+              dominates = compute_rect_dominates<3>(left_set, right_set);
               break;
             }
           default:
@@ -7799,9 +7785,7 @@ namespace LegionRuntime {
         Event result = LowLevel::IndexSpace::compute_index_spaces(operations,
                                                             (mode & ALLOCABLE),
                                                             precondition);
-#ifdef LEGION_SPY
         LegionSpy::log_event_dependence(precondition, result);
-#endif
         // Now set the domains for all the nodes
         idx = 0;
         for (Domain::DomainPointIterator itr(color_space); itr; itr++, idx++)
@@ -7862,9 +7846,7 @@ namespace LegionRuntime {
         Event result = LowLevel::IndexSpace::compute_index_spaces(operations,
                                                             (mode & ALLOCABLE),
                                                             precondition);
-#ifdef LEGION_SPY
         LegionSpy::log_event_dependence(precondition, result);
-#endif
         // Now set the domains for the nodes
         idx = 0;
         for (Domain::DomainPointIterator itr(color_space); itr; itr++, idx++)
@@ -8980,6 +8962,7 @@ namespace LegionRuntime {
                                                      Domain domain,
                                        const std::set<FieldID> &create_fields,
                                                      size_t blocking_factor,
+                                                 const InstanceOrder &order,
                                                      unsigned depth,
                                                      RegionNode *node,
                                                      Operation *op)
@@ -9008,22 +8991,24 @@ namespace LegionRuntime {
           field_index = finder->second.idx;
         }
         // First see if we can recycle a physical instance
+        // (only linear instances are ever put back in the pool)
         Event use_event = Event::NO_EVENT;
+        PhysicalInstance inst = PhysicalInstance::NO_INST;
 #ifndef DISABLE_RECYCLING
-        PhysicalInstance inst = context->runtime->find_physical_instance(
+        if (order.kind == InstanceOrder::LINEAR)
+          inst = context->runtime->find_physical_instance(
                           location, field_size, domain, depth, use_event);
-#else
-        PhysicalInstance inst = PhysicalInstance::NO_INST;
 #endif
         // If we couldn't recycle one, then try making one
         if (!inst.exists())
-          inst = context->create_instance(domain, location, field_size, op);
+          inst = context->create_instance(domain, location, field_size, 
+                                          order, op);
         if (inst.exists())
         {
           FieldMask inst_mask = get_field_mask(create_fields);
           // See if we can find a layout description object
           LayoutDescription *layout = 
-            find_layout_description(inst_mask, domain, blocking_factor);
+            find_layout_description(inst_mask, domain, blocking_factor, order);
           if (layout == NULL)
           {
             // Now we need to make a layout
@@ -9032,7 +9017,7 @@ namespace LegionRuntime {
             field_sizes[0] = field_size;
             indexes[0] = field_index;
             layout = create_layout_description(inst_mask, domain,
-                                               blocking_factor, 
+                                               blocking_factor, order,
                                                create_fields,
                                                field_sizes,
                                                indexes);
@@ -9058,26 +9043,26 @@ namespace LegionRuntime {
         compute_create_offsets(create_fields, field_sizes, indexes);
         // First see if we can recycle a physical instance
         Event use_event = Event::NO_EVENT;
+        PhysicalInstance inst = PhysicalInstance::NO_INST;
 #ifndef DISABLE_RECYCLING
-        PhysicalInstance inst = context->runtime->find_physical_instance(
+        if (order.kind == InstanceOrder::LINEAR)
+          inst = context->runtime->find_physical_instance(
             location, field_sizes, domain, blocking_factor, depth, use_event);
-#else
-        PhysicalInstance inst = PhysicalInstance::NO_INST;
 #endif
         // If that didn't work, try making one
         if (!inst.exists())
           inst = context->create_instance(domain, location, field_sizes, 
-                                          blocking_factor, op);
+                                          blocking_factor, order, op);
         if (inst.exists())
         {
           FieldMask inst_mask = get_field_mask(create_fields);
           LayoutDescription *layout = 
-            find_layout_description(inst_mask, domain, blocking_factor);
+            find_layout_description(inst_mask, domain, blocking_factor, order);
           if (layout == NULL)
           {
             // We couldn't find one so make one
             layout = create_layout_description(inst_mask, domain,
-                                               blocking_factor,
+                                               blocking_factor, order,
                                                create_fields,
                                                field_sizes,
                                                indexes);
@@ -9141,7 +9126,8 @@ namespace LegionRuntime {
         // Don't give the reduction op here since this is a list instance and we
         // don't want to initialize any of the fields
         PhysicalInstance inst = context->create_instance(ptr_space, location,
-                                            element_sizes, 1/*true list*/, op);
+                                            element_sizes, 1/*true list*/,
+                                            InstanceOrder(), op);
         if (inst.exists())
         {
           DistributedID did = context->runtime->get_available_distributed_id();
@@ -9205,10 +9191,11 @@ namespace LegionRuntime {
       size_t blocking_factor = dom.get_volume();
       // Get the layout
       LayoutDescription *layout = 
-        find_layout_description(attach_mask, dom, blocking_factor);
+        find_layout_description(attach_mask, dom, blocking_factor, 
+                                InstanceOrder());
       if (layout == NULL)
         layout = create_layout_description(attach_mask, dom,
-                                           blocking_factor,
+                                           blocking_factor, InstanceOrder(),
                                            create_fields,
                                            field_sizes,
                                            indexes);
@@ -9231,7 +9218,8 @@ namespace LegionRuntime {
 
     //--------------------------------------------------------------------------
     LayoutDescription* FieldSpaceNode::find_layout_description(
-        const FieldMask &mask, const Domain &domain, size_t blocking_factor)
+        const FieldMask &mask, const Domain &domain, size_t blocking_factor,
+        const InstanceOrder &order)
     //--------------------------------------------------------------------------
     {
       uint64_t hash_key = mask.get_hash_key();
@@ -9246,7 +9234,7 @@ namespace LegionRuntime {
       for (std::list<LayoutDescription*>::const_iterator it = 
             finder->second.begin(); it != finder->second.end(); it++)
       {
-        if ((*it)->match_layout(mask, domain, blocking_factor))
+        if ((*it)->match_layout(mask, domain, blocking_factor, order))
           return (*it);
       }
       return NULL;
@@ -9255,6 +9243,7 @@ namespace LegionRuntime {
     //--------------------------------------------------------------------------
     LayoutDescription* FieldSpaceNode::create_layout_description(
         const FieldMask &mask, const Domain &domain, size_t blocking_factor,
+                                     const InstanceOrder &order,
                                      const std::set<FieldID> &create_fields,
                                      const std::vector<size_t> &field_sizes, 
                                      const std::vector<unsigned> &indexes)
@@ -9262,7 +9251,7 @@ namespace LegionRuntime {
     {
       // Make the new field description and then register it
       LayoutDescription *result = new LayoutDescription(mask, domain,
-                                                        blocking_factor, this);
+                                                 blocking_factor, order, this);
       unsigned idx = 0;
       size_t accum_offset = 0;
       for (std::set<FieldID>::const_iterator it = create_fields.begin();
@@ -9649,9 +9638,7 @@ namespace LegionRuntime {
     //--------------------------------------------------------------------------
     LogicalUser::LogicalUser(void)
       : GenericUser(), op(NULL), idx(0), gen(0), timeout(TIMEOUT)
-#if defined(LEGION_LOGGING) || defined(LEGION_SPY)
         , uid(0)
-#endif
     //--------------------------------------------------------------------------
     {
     }
@@ -9661,9 +9648,7 @@ namespace LegionRuntime {
                              const FieldMask &m)
       : GenericUser(u, m), op(o), idx(id), 
         gen(o->get_generation()), timeout(TIMEOUT)
-#if defined(LEGION_LOGGING) || defined(LEGION_SPY)
         , uid(o->get_unique_op_id())
-#endif
     //--------------------------------------------------------------------------
     {
     }
@@ -10699,6 +10684,20 @@ namespace LegionRuntime {
       const size_t blocking_factor = 
         (info.req.blocking_factor <= info.req.max_blocking_factor) ? 
         info.req.blocking_factor : info.req.max_blocking_factor;
+      // Tiled orderings need a tile with the same dimension as the region
+      InstanceOrder order = info.req.instance_order;
+      if ((order.kind != InstanceOrder::LINEAR) &&
+          (order.tile_size.get_dim() != 
+           node->get_domain_blocking().get_dim()))
+      {
+        log_region.warning("WARNING: Mapper specified a tiled instance order "
+                           "with a %d-D tile for %d-D region %d of mappable "
+                           "(ID %lld)!  Using a linear order instead!",
+                           order.tile_size.get_dim(),
+                           node->get_domain_blocking().get_dim(), index,
+                           info.op->get_mappable()->get_unique_mappable_id());
+        order = InstanceOrder();
+      }
       // Filter out any memories that are not visible from 
       // the target processor if there is a processor that 
       // we're targeting (e.g. never do this for premaps)
@@ -10781,9 +10780,11 @@ namespace LegionRuntime {
           }
           MaterializedView *current_view = it->first->as_materialized_view();
           // For right now allow blocking factors that are greater
-          // than or equal to the requested blocking factor
+          // than or equal to the requested blocking factor, but the
+          // instance order has to match exactly
           size_t bf = current_view->get_blocking_factor();
-          if (bf >= blocking_factor)
+          if ((bf >= blocking_factor) && 
+              (current_view->get_instance_order() == order))
           {
             Memory m = current_view->get_location();
             if (valid_memories.find(m) == valid_memories.end())
@@ -10898,7 +10899,7 @@ namespace LegionRuntime {
         }
         // If it didn't find a valid instance, try to make one
         chosen_inst = node->create_instance(*mit, new_fields, 
-                                            blocking_factor,
+                                            blocking_factor, order,
                                           info.op->get_mappable()->get_depth(),
                                             info.op);
         if (chosen_inst != NULL)
@@ -13760,12 +13761,10 @@ namespace LegionRuntime {
               it->uid, it->idx, op->get_unique_op_id(),
               0/*idx*/, TRUE_DEPENDENCE);
 #endif
-#ifdef LEGION_SPY
           LegionSpy::log_mapping_dependence(
               op->get_parent()->get_unique_task_id(),
               it->uid, it->idx, op->get_unique_op_id(),
               0/*idx*/, TRUE_DEPENDENCE);
-#endif
           // Do this after the logging since we 
           // are going to update the iterator
           if (op->register_dependence(it->op, it->gen))
@@ -13796,12 +13795,10 @@ namespace LegionRuntime {
               it->uid, it->idx, op->get_unique_op_id(),
               0/*idx*/, TRUE_DEPENDENCE);
 #endif
-#ifdef LEGION_SPY
           LegionSpy::log_mapping_dependence(
               op->get_parent()->get_unique_task_id(),
               it->uid, it->idx, op->get_unique_op_id(), 0/*idx*/, 
               TRUE_DEPENDENCE);
-#endif
           // Do this after the logging since we are going
           // to update the iterator
           if (op->register_dependence(it->op, it->gen))
@@ -14142,7 +14139,7 @@ namespace LegionRuntime {
           MaterializedView *new_view = 
             create_instance(to_create[idx], 
                             closer.info.req.privilege_fields, 
-                            blocking_factor,
+                            blocking_factor, InstanceOrder(),
                             closer.info.op->get_mappable()->get_depth(),
                             closer.info.op);
           if (new_view != NULL)
@@ -15179,9 +15176,7 @@ namespace LegionRuntime {
             Processor::get_executing_processor(), 
             pre_set.preconditions, copy_pre);
 #endif
-#ifdef LEGION_SPY
         LegionSpy::log_event_dependences(pre_set.preconditions, copy_pre);
-#endif
         std::set<Event> post_events;
         for (std::set<Domain>::const_iterator it = copy_domains.begin();
               it != copy_domains.end(); it++)
@@ -15236,23 +15231,24 @@ namespace LegionRuntime {
                 copy_pre, copy_post, copy_fields, 0/*redop*/);
           }
 #endif
-#ifdef LEGION_SPY
-          RegionNode *manager_node = dst->manager->region_node;
-          char *string_mask = 
-            manager_node->column_source->to_string(it->second);
+          if (LegionSpy::spy_logging)
           {
-            std::set<FieldID> field_set;
-            manager_node->column_source->to_field_set(it->second, field_set);
-            LegionSpy::log_copy_operation(
-                it->first->manager->get_instance().id,
-                dst->manager->get_instance().id,
-                copy_index_space.get_id(),
-                manager_node->column_source->handle.id,
-                manager_node->handle.tree_id, copy_pre, copy_post,
-                0/*redop*/, field_set);
+            RegionNode *manager_node = dst->manager->region_node;
+            char *string_mask = 
+              manager_node->column_source->to_string(it->second);
+            {
+              std::set<FieldID> field_set;
+              manager_node->column_source->to_field_set(it->second, field_set);
+              LegionSpy::log_copy_operation(
+                  it->first->manager->get_instance().id,
+                  dst->manager->get_instance().id,
+                  copy_index_space.get_id(),
+                  manager_node->column_source->handle.id,
+                  manager_node->handle.tree_id, copy_pre, copy_post,
+                  0/*redop*/, field_set);
+            }
+            free(string_mask);
           }
-          free(string_mask);
-#endif
         }
 #endif
       }
@@ -16201,12 +16197,13 @@ namespace LegionRuntime {
                       user.op->get_parent()->get_unique_task_id(),
                       it->uid, it->idx, user.uid, user.idx, dtype);
 #endif
-#ifdef LEGION_SPY
-                if (dtype != PROMOTED_DEPENDENCE)
-                  LegionSpy::log_mapping_dependence(
-                      user.op->get_parent()->get_unique_task_id(),
-                      it->uid, it->idx, user.uid, user.idx, dtype);
-#endif
+                if (LegionSpy::spy_logging)
+                {
+                  if (dtype != PROMOTED_DEPENDENCE)
+                    LegionSpy::log_mapping_dependence(
+                        user.op->get_parent()->get_unique_task_id(),
+                        it->uid, it->idx, user.uid, user.idx, dtype);
+                }
                 if (RECORD)
                   user.op->record_logical_dependence(*it);
                 // Do this after the logging since we might 
@@ -16337,12 +16334,13 @@ namespace LegionRuntime {
               closer.user.op->get_parent()->get_unique_task_id(),
               it->uid, it->idx, closer.user.uid, closer.user.idx, dtype);
 #endif
-#ifdef LEGION_SPY
-        if ((dtype != NO_DEPENDENCE) && (dtype != PROMOTED_DEPENDENCE))
-          LegionSpy::log_mapping_dependence(
-              closer.user.op->get_parent()->get_unique_task_id(),
-              it->uid, it->idx, closer.user.uid, closer.user.idx, dtype);
-#endif
+        if (LegionSpy::spy_logging)
+        {
+          if ((dtype != NO_DEPENDENCE) && (dtype != PROMOTED_DEPENDENCE))
+            LegionSpy::log_mapping_dependence(
+                closer.user.op->get_parent()->get_unique_task_id(),
+                it->uid, it->idx, closer.user.uid, closer.user.idx, dtype);
+        }
         // Register the dependence 
         if (closer.user.op->register_region_dependence(closer.user.idx, 
                                                        it->op, it->gen, 
@@ -16821,13 +16819,15 @@ namespace LegionRuntime {
     MaterializedView* RegionNode::create_instance(Memory target_mem,
                                                 const std::set<FieldID> &fields,
                                                 size_t blocking_factor,
+                                                const InstanceOrder &order,
                                                 unsigned depth,
                                                 Operation *op)
     //--------------------------------------------------------------------------
     {
       InstanceManager *manager = column_source->create_instance(target_mem,
                                       row_source->get_domain_blocking(),
-                                      fields, blocking_factor, depth, this, op);
+                                      fields, blocking_factor, order, 
+                                      depth, this, op);
       // See if we made the instance
       MaterializedView *result = NULL;
       if (manager != NULL)
@@ -16842,14 +16842,15 @@ namespace LegionRuntime {
             manager->get_instance(), manager->memory,
             handle.index_space, handle.field_space, handle.tree_id);
 #endif
-#ifdef LEGION_SPY
-        LegionSpy::log_physical_instance(manager->get_instance().id,
-            manager->memory.id, handle.index_space.id,
-            handle.field_space.id, handle.tree_id);
-        for (std::set<FieldID>::const_iterator it = fields.begin();
-             it != fields.end(); ++it)
-          LegionSpy::log_instance_field(manager->get_instance().id, *it);
-#endif
+        if (LegionSpy::spy_logging)
+        {
+          LegionSpy::log_physical_instance(manager->get_instance().id,
+              manager->memory.id, handle.index_space.id,
+              handle.field_space.id, handle.tree_id);
+          for (std::set<FieldID>::const_iterator it = fields.begin();
+               it != fields.end(); ++it)
+            LegionSpy::log_instance_field(manager->get_instance().id, *it);
+        }
       }
       return result;
     }
@@ -16878,14 +16879,15 @@ namespace LegionRuntime {
             handle.index_space, handle.field_space, handle.tree_id,
             redop, !reduction_list, manager->get_pointer_space());
 #endif
-#ifdef LEGION_SPY
-        Domain ptr_space = manager->get_pointer_space();
-        LegionSpy::log_physical_reduction(manager->get_instance().id,
-            manager->memory.id, handle.index_space.id,
-            handle.field_space.id, handle.tree_id, !reduction_list,
-            ptr_space.exists() ? ptr_space.get_index_space().id : 0);
-        LegionSpy::log_instance_field(manager->get_instance().id, fid);
-#endif
+        if (LegionSpy::spy_logging)
+        {
+          Domain ptr_space = manager->get_pointer_space();
+          LegionSpy::log_physical_reduction(manager->get_instance().id,
+              manager->memory.id, handle.index_space.id,
+              handle.field_space.id, handle.tree_id, !reduction_list,
+              ptr_space.exists() ? ptr_space.get_index_space().id : 0);
+          LegionSpy::log_instance_field(manager->get_instance().id, fid);
+        }
       }
       return result;
     }
@@ -18519,6 +18521,7 @@ namespace LegionRuntime {
     MaterializedView* PartitionNode::create_instance(Memory target_mem,
                                                 const std::set<FieldID> &fields,
                                                 size_t blocking_factor,
+                                                const InstanceOrder &order,
                                                 unsigned depth, Operation *op)
     //--------------------------------------------------------------------------
     {
@@ -18528,7 +18531,7 @@ namespace LegionRuntime {
       MaterializedView *result = parent->create_instance(target_mem, 
                                                          fields, 
                                                          blocking_factor,
-                                                         depth, op);
+                                                         order, depth, op);
       if (result != NULL)
       {
         result = result->get_materialized_subview(row_source->color);
@@ -19291,8 +19294,9 @@ namespace LegionRuntime {
 
     //--------------------------------------------------------------------------
     LayoutDescription::LayoutDescription(const FieldMask &mask, const Domain &d,
-                                         size_t bf, FieldSpaceNode *own)
-      : allocated_fields(mask), blocking_factor(bf), 
+                                         size_t bf, const InstanceOrder &ord,
+                                         FieldSpaceNode *own)
+      : allocated_fields(mask), blocking_factor(bf), order(ord),
         volume(compute_layout_volume(d)), owner(own)
     //--------------------------------------------------------------------------
     {
@@ -19302,7 +19306,7 @@ namespace LegionRuntime {
     //--------------------------------------------------------------------------
     LayoutDescription::LayoutDescription(const LayoutDescription &rhs)
       : allocated_fields(rhs.allocated_fields), 
-        blocking_factor(rhs.blocking_factor), 
+        blocking_factor(rhs.blocking_factor), order(rhs.order),
         volume(rhs.volume), owner(rhs.owner)
     //--------------------------------------------------------------------------
     {
@@ -19536,11 +19540,14 @@ namespace LegionRuntime {
 
     //--------------------------------------------------------------------------
     bool LayoutDescription::match_layout(const FieldMask &mask,
-                                         const size_t vl, const size_t bf) const
+                                         const size_t vl, const size_t bf,
+                                         const InstanceOrder &ord) const
     //--------------------------------------------------------------------------
     {
       if (blocking_factor != bf)
         return false;
+      if (order != ord)
+        return false;
       if (volume != vl)
         return false;
       if (allocated_fields != mask)
@@ -19550,10 +19557,11 @@ namespace LegionRuntime {
 
     //--------------------------------------------------------------------------
     bool LayoutDescription::match_layout(const FieldMask &mask, const Domain &d,
-                                         const size_t bf) const
+                                         const size_t bf,
+                                         const InstanceOrder &ord) const
     //--------------------------------------------------------------------------
     {
-      return match_layout(mask, compute_layout_volume(d), bf);
+      return match_layout(mask, compute_layout_volume(d), bf, ord);
     }
 
     //--------------------------------------------------------------------------
@@ -19561,7 +19569,7 @@ namespace LegionRuntime {
     //--------------------------------------------------------------------------
     {
       return match_layout(rhs->allocated_fields, rhs->volume, 
-                          rhs->blocking_factor);
+                          rhs->blocking_factor, rhs->order);
     }
 
     //--------------------------------------------------------------------------
@@ -19600,12 +19608,16 @@ namespace LegionRuntime {
         // need to the necessary information to identify it
         rez.serialize(allocated_fields);
         rez.serialize(blocking_factor);
+        rez.serialize(order.kind);
+        rez.serialize(order.tile_size);
       }
       else
       {
         rez.serialize<bool>(false);
         rez.serialize(allocated_fields);
         rez.serialize(blocking_factor);
+        rez.serialize(order.kind);
+        rez.serialize(order.tile_size);
         rez.serialize<size_t>(field_infos.size());
 #ifdef DEBUG_HIGH_LEVEL
         assert(field_infos.size() == field_indexes.size());
@@ -19674,12 +19686,15 @@ namespace LegionRuntime {
       field_space_node->transform_field_mask(mask, source);
       size_t blocking_factor;
       derez.deserialize(blocking_factor);
+      InstanceOrder order;
+      derez.deserialize(order.kind);
+      derez.deserialize(order.tile_size);
       if (has_local)
       {
         // If we have a local layout, then we should be able to find it
         result = field_space_node->find_layout_description(mask,  
                                             region_node->get_domain_blocking(),
-                                            blocking_factor);
+                                            blocking_factor, order);
       }
       else
       {
@@ -19687,7 +19702,8 @@ namespace LegionRuntime {
         // unpack it, and then try registering it with
         // the field space node
         result = new LayoutDescription(mask, region_node->get_domain_blocking(),
-                                       blocking_factor, field_space_node);
+                                       blocking_factor, order, 
+                                       field_space_node);
         result->unpack_layout_description(derez);
         result = field_space_node->register_layout_description(result);
       }
@@ -20235,6 +20251,9 @@ namespace LegionRuntime {
       // First check to see if the domains are the same
       if (region_node->get_domain_blocking() != dom)
         return false;
+      // Only linear instances are recycled
+      if (layout->order.kind != InstanceOrder::LINEAR)
+        return false;
       return layout->match_shape(field_size);
     }
 
@@ -20250,6 +20269,9 @@ namespace LegionRuntime {
       // First check to see if the domains are the same
       if (region_node->get_domain_blocking() != dom)
         return false;
+      // Only linear instances are recycled
+      if (layout->order.kind != InstanceOrder::LINEAR)
+        return false;
       return layout->match_shape(field_sizes, bf);
     }
 
@@ -21352,6 +21374,13 @@ namespace LegionRuntime {
       return manager->layout->blocking_factor;
     } 
 
+    //--------------------------------------------------------------------------
+    const InstanceOrder& MaterializedView::get_instance_order(void) const
+    //--------------------------------------------------------------------------
+    {
+      return manager->layout->order;
+    }
+
     //--------------------------------------------------------------------------
     const FieldMask& MaterializedView::get_physical_mask(void) const
     //--------------------------------------------------------------------------
@@ -21676,9 +21705,7 @@ namespace LegionRuntime {
       LegionLogging::log_event_dependences(
           Processor::get_executing_processor(), wait_on_events, ready_event);
 #endif
-#ifdef LEGION_SPY
       LegionSpy::log_event_dependences(wait_on_events, ready_event);
-#endif
       InstanceRef result(ready_event, ViewHandle(this));
       if (IS_ATOMIC(user.usage))
         find_atomic_reservations(result, user.field_mask);
@@ -25820,9 +25847,7 @@ namespace LegionRuntime {
             Processor::get_executing_processor(), 
             pre_set.preconditions, fill_pre);
 #endif
-#ifdef LEGION_SPY
         LegionSpy::log_event_dependences(pre_set.preconditions, fill_pre);
-#endif
         // Issue the fill commands
         Event fill_post;
         if (dst->logical_node->has_component_domains())
@@ -25935,9 +25960,7 @@ namespace LegionRuntime {
             Processor::get_executing_processor(), 
             pre_set.preconditions, fill_pre);
 #endif
-#ifdef LEGION_SPY
         LegionSpy::log_event_dependences(pre_set.preconditions, fill_pre);
-#endif
         // Issue the fill commands
         Event fill_post;
         if (dst->logical_node->has_component_domains())
@@ -26427,15 +26450,13 @@ namespace LegionRuntime {
         new_reduce_pre.trigger();
         reduce_pre = new_reduce_pre;
       }
-      IndexSpace reduce_index_space;
 #endif
+      IndexSpace reduce_index_space;
 #ifdef LEGION_LOGGING
       LegionLogging::log_event_dependences(
           Processor::get_executing_processor(), event_preconds, reduce_pre);
 #endif
-#ifdef LEGION_SPY
       LegionSpy::log_event_dependences(event_preconds, reduce_pre);
-#endif
       Event reduce_post; 
       if (logical_node->has_component_domains())
       {
@@ -26454,9 +26475,7 @@ namespace LegionRuntime {
           post_events.insert(post);
         }
         reduce_post = Event::merge_events(post_events);
-#if defined(LEGION_SPY) || defined(LEGION_LOGGING)
         reduce_index_space = logical_node->as_region_node()->row_source->handle;
-#endif
       }
       else
       {
@@ -26467,9 +26486,7 @@ namespace LegionRuntime {
         reduce_post = manager->issue_reduction(op, src_fields, dst_fields,
                                                domain, reduce_pre, fold,
                                                true/*precise*/);
-#if defined(LEGION_SPY) || defined(LEGION_LOGGING)
         reduce_index_space = logical_node->as_region_node()->row_source->handle;
-#endif
       }
 #if defined(LEGION_SPY) || defined(LEGION_LOGGING)
       if (!reduce_post.exists())
@@ -26500,19 +26517,20 @@ namespace LegionRuntime {
             reduce_pre, reduce_post, reduce_fields, manager->redop);
       }
 #endif
-#ifdef LEGION_SPY
+      if (LegionSpy::spy_logging)
       {
-        std::set<FieldID> field_set;
-        manager->region_node->column_source->to_field_set(reduce_mask,
-            field_set);
-        LegionSpy::log_copy_operation(manager->get_instance().id,
-            target->get_manager()->get_instance().id,
-            reduce_index_space.get_id(),
-            manager->region_node->column_source->handle.id,
-            manager->region_node->handle.tree_id, reduce_pre, reduce_post,
-            manager->redop, field_set);
+        {
+          std::set<FieldID> field_set;
+          manager->region_node->column_source->to_field_set(reduce_mask,
+              field_set);
+          LegionSpy::log_copy_operation(manager->get_instance().id,
+              target->get_manager()->get_instance().id,
+              reduce_index_space.get_id(),
+              manager->region_node->column_source->handle.id,
+              manager->region_node->handle.tree_id, reduce_pre, reduce_post,
+              manager->redop, field_set);
+        }
       }
-#endif
     } 
 
     //--------------------------------------------------------------------------
@@ -26558,9 +26576,7 @@ namespace LegionRuntime {
       LegionLogging::log_event_dependences(
           Processor::get_executing_processor(), preconditions, reduce_pre);
 #endif
-#ifdef LEGION_SPY
       LegionSpy::log_event_dependences(preconditions, reduce_pre);
-#endif
       std::set<Event> post_events;
       for (std::set<Domain>::const_iterator it = reduce_domains.begin();
             it != reduce_domains.end(); it++)
@@ -26575,9 +26591,9 @@ namespace LegionRuntime {
       // be handled by the caller using the reduce post event we return
       add_copy_user(manager->redop, reduce_post,
                     red_mask, true/*reading*/);
-#if defined(LEGION_SPY) || defined(LEGION_LOGGING)
       IndexSpace reduce_index_space =
               target->logical_node->as_region_node()->row_source->handle;
+#if defined(LEGION_SPY) || defined(LEGION_LOGGING)
       if (!reduce_post.exists())
       {
         UserEvent new_reduce_post = UserEvent::create_user_event();
@@ -26600,18 +26616,19 @@ namespace LegionRuntime {
             reduce_pre, reduce_post, reduce_fields, manager->redop);
       }
 #endif
-#ifdef LEGION_SPY
+      if (LegionSpy::spy_logging)
       {
-        std::set<FieldID> field_set;
-        manager->region_node->column_source->to_field_set(red_mask, field_set);
-        LegionSpy::log_copy_operation(manager->get_instance().id,
-            target->get_manager()->get_instance().id,
-            reduce_index_space.get_id(),
-            manager->region_node->column_source->handle.id,
-            manager->region_node->handle.tree_id, reduce_pre, reduce_post,
-            manager->redop, field_set);
+        {
+          std::set<FieldID> field_set;
+          manager->region_node->column_source->to_field_set(red_mask, field_set);
+          LegionSpy::log_copy_operation(manager->get_instance().id,
+              target->get_manager()->get_instance().id,
+              reduce_index_space.get_id(),
+              manager->region_node->column_source->handle.id,
+              manager->region_node->handle.tree_id, reduce_pre, reduce_post,
+              manager->redop, field_set);
+        }
       }
-#endif
       return reduce_post;
     }
 
@@ -26660,9 +26677,7 @@ namespace LegionRuntime {
       LegionLogging::log_event_dependences(
           Processor::get_executing_processor(), preconditions, reduce_pre);
 #endif
-#ifdef LEGION_SPY
       LegionSpy::log_event_dependences(preconditions, reduce_pre);
-#endif
       std::set<Event> post_events;
       for (std::set<Domain>::const_iterator it = reduce_domains.begin();
             it != reduce_domains.end(); it++)
@@ -26677,9 +26692,9 @@ namespace LegionRuntime {
       // be handled by the caller using the reduce post event we return
       add_copy_user(manager->redop, reduce_post,
                     red_mask, true/*reading*/);
-#if defined(LEGION_SPY) || defined(LEGION_LOGGING)
       IndexSpace reduce_index_space =
               target->logical_node->as_region_node()->row_source->handle;
+#if defined(LEGION_SPY) || defined(LEGION_LOGGING)
       if (!reduce_post.exists())
       {
         UserEvent new_reduce_post = UserEvent::create_user_event();
@@ -26702,18 +26717,19 @@ namespace LegionRuntime {
             reduce_pre, reduce_post, reduce_fields, manager->redop);
       }
 #endif
-#ifdef LEGION_SPY
+      if (LegionSpy::spy_logging)
       {
-        std::set<FieldID> field_set;
-        manager->region_node->column_source->to_field_set(red_mask, field_set);
-        LegionSpy::log_copy_operation(manager->get_instance().id,
-            target->get_manager()->get_instance().id,
-            reduce_index_space.get_id(),
-            manager->region_node->column_source->handle.id,
-            manager->region_node->handle.tree_id, reduce_pre, reduce_post,
-            manager->redop, field_set);
+        {
+          std::set<FieldID> field_set;
+          manager->region_node->column_source->to_field_set(red_mask, field_set);
+          LegionSpy::log_copy_operation(manager->get_instance().id,
+              target->get_manager()->get_instance().id,
+              reduce_index_space.get_id(),
+              manager->region_node->column_source->handle.id,
+              manager->region_node->handle.tree_id, reduce_pre, reduce_post,
+              manager->redop, field_set);
+        }
       }
-#endif
       return reduce_post;
     }
 
@@ -26876,9 +26892,7 @@ namespace LegionRuntime {
       LegionLogging::log_event_dependences(
           Processor::get_executing_processor(), wait_on, result);
 #endif
-#ifdef LEGION_SPY
       LegionSpy::log_event_dependences(wait_on, result);
-#endif
       return InstanceRef(result, ViewHandle(this));
     }
  
@@ -539,10 +539,14 @@ namespace LegionRuntime {
                        const std::vector<Domain::CopySrcDstField> &dst_fields,
                        Event precondition = Event::NO_EVENT);
       PhysicalInstance create_instance(const Domain &dom, Memory target, 
-                                       size_t field_size, Operation *op);
+                                       size_t field_size,
+                                       const InstanceOrder &order,
+                                       Operation *op);
       PhysicalInstance create_instance(const Domain &dom, Memory target,
                                        const std::vector<size_t> &field_sizes,
-                                       size_t blocking_factor, Operation *op);
+                                       size_t blocking_factor,
+                                       const InstanceOrder &order,
+                                       Operation *op);
       PhysicalInstance create_instance(const Domain &dom, Memory target,
                                        size_t field_size, ReductionOpID redop,
                                        Operation *op);
@@ -1017,6 +1021,9 @@ namespace LegionRuntime {
                                        Domain &result, bool compute);
       static bool compute_dominates(const std::set<Domain> &left_set,
                                     const std::set<Domain> &right_set);
+      template<unsigned DIM>
+      static bool compute_rect_dominates(const std::set<Domain> &left_set,
+                                         const std::set<Domain> &right_set);
     public:
       const unsigned depth;
       const ColorPoint color;
@@ -1388,7 +1395,9 @@ namespace LegionRuntime {
     public:
       InstanceManager* create_instance(Memory location, Domain dom,
                                        const std::set<FieldID> &fields,
-                                       size_t blocking_factor, unsigned depth,
+                                       size_t blocking_factor,
+                                       const InstanceOrder &order,
+                                       unsigned depth,
                                        RegionNode *node, Operation *op);
       ReductionManager* create_reduction(Memory location, Domain dom,
                                         FieldID fid, bool reduction_list,
@@ -1401,10 +1410,12 @@ namespace LegionRuntime {
     public:
       LayoutDescription* find_layout_description(const FieldMask &mask,
                                                  const Domain &domain,
-                                                 size_t blocking_factor);
+                                                 size_t blocking_factor,
+                                                 const InstanceOrder &order);
       LayoutDescription* create_layout_description(const FieldMask &mask,
                                                    const Domain &domain,
                                                    size_t blocking_factor,
+                                                   const InstanceOrder &order,
                                    const std::set<FieldID> &create_fields,
                                    const std::vector<size_t> &field_sizes,
                                    const std::vector<unsigned> &indexes);
@@ -1498,9 +1509,7 @@ namespace LegionRuntime {
       // test to be performed whenever the timeout
       // reaches zero.
       int timeout;
-#if defined(LEGION_LOGGING) || defined(LEGION_SPY)
       UniqueID uid;
-#endif
     public:
       static const int TIMEOUT = DEFAULT_LOGICAL_USER_TIMEOUT;
     };
@@ -2289,6 +2298,7 @@ namespace LegionRuntime {
       virtual MaterializedView * create_instance(Memory target_mem,
                                                 const std::set<FieldID> &fields,
                                                 size_t blocking_factor,
+                                                const InstanceOrder &order,
                                                 unsigned depth, 
                                                 Operation *op) = 0;
       virtual ReductionView* create_reduction(Memory target_mem,
@@ -2422,6 +2432,7 @@ namespace LegionRuntime {
       virtual MaterializedView* create_instance(Memory target_mem,
                                                 const std::set<FieldID> &fields,
                                                 size_t blocking_factor,
+                                                const InstanceOrder &order,
                                                 unsigned depth,
                                                 Operation *op);
       virtual ReductionView* create_reduction(Memory target_mem,
@@ -2582,6 +2593,7 @@ namespace LegionRuntime {
       virtual MaterializedView* create_instance(Memory target_mem,
                                                 const std::set<FieldID> &fields,
                                                 size_t blocking_factor,
+                                                const InstanceOrder &order,
                                                 unsigned depth,
                                                 Operation *op);
       virtual ReductionView* create_reduction(Memory target_mem,
@@ -3154,6 +3166,7 @@ namespace LegionRuntime {
       LayoutDescription(const FieldMask &mask,
                         const Domain &domain,
                         size_t blocking_factor,
+                        const InstanceOrder &order,
                         FieldSpaceNode *owner);
       LayoutDescription(const LayoutDescription &rhs);
       ~LayoutDescription(void);
@@ -3178,10 +3191,10 @@ namespace LegionRuntime {
       bool match_shape(const std::vector<size_t> &field_sizes, 
                        const size_t bf) const;
     public:
-      bool match_layout(const FieldMask &mask, 
-                        const size_t vol, const size_t bf) const;
-      bool match_layout(const FieldMask &mask,
-                        const Domain &d, const size_t bf) const;
+      bool match_layout(const FieldMask &mask, const size_t vol,
+                        const size_t bf, const InstanceOrder &ord) const;
+      bool match_layout(const FieldMask &mask, const Domain &d,
+                        const size_t bf, const InstanceOrder &ord) const;
       bool match_layout(LayoutDescription *rhs) const;
     public:
       void set_descriptor(FieldDataDescriptor &desc, unsigned fid_idx) const;
@@ -3196,6 +3209,7 @@ namespace LegionRuntime {
     public:
       const FieldMask allocated_fields;
       const size_t blocking_factor;
+      const InstanceOrder order;
       const size_t volume;
       FieldSpaceNode *const owner;
     protected:
@@ -3693,6 +3707,7 @@ namespace LegionRuntime {
     public:
       Memory get_location(void) const;
       size_t get_blocking_factor(void) const;
+      const InstanceOrder& get_instance_order(void) const;
       const FieldMask& get_physical_mask(void) const;
     public:
       virtual bool is_deferred_view(void) const;
@@ -74,6 +74,74 @@ namespace LegionRuntime {
     extern Logger::Category log_variant;
     extern Logger::Category log_allocation;
 
+    //--------------------------------------------------------------------------
+    template<int DIM>
+    static inline bool linearize_rect_point(const Domain &dom,
+                                            const DomainPoint &point,
+                                            size_t &offset)
+    //--------------------------------------------------------------------------
+    {
+      // Use the same order as Domain::DomainPointIterator
+      // so that the first dimension varies fastest
+      Arrays::Rect<DIM> rect = dom.get_rect<DIM>();
+      size_t stride = 1;
+      offset = 0;
+      for (int i = 0; i < DIM; i++)
+      {
+        const int x = point.point_data[i];
+        if ((x < rect.lo.x[i]) || (x > rect.hi.x[i]))
+          return false;
+        offset += size_t(x - rect.lo.x[i]) * stride;
+        stride *= size_t(rect.hi.x[i] - rect.lo.x[i] + 1);
+      }
+      return true;
+    }
+
+    //--------------------------------------------------------------------------
+    static inline bool linearize_dense_point(const Domain &dom,
+                                             const DomainPoint &point,
+                                             size_t &offset)
+    //--------------------------------------------------------------------------
+    {
+      // Only rectangular domains have a dense linearization
+      if ((dom.get_dim() <= 0) || (point.get_dim() != dom.get_dim()))
+        return false;
+      switch (dom.get_dim())
+      {
+        case 1:
+          return linearize_rect_point<1>(dom, point, offset);
+        case 2:
+          return linearize_rect_point<2>(dom, point, offset);
+        case 3:
+          return linearize_rect_point<3>(dom, point, offset);
+        default:
+          assert(false);
+      }
+      return false;
+    }
+
+    //--------------------------------------------------------------------------
+    static inline bool linearize_dense_subrect(const Domain &dom,
+                                               const Domain &sub,
+                                               size_t &first, size_t &last)
+    //--------------------------------------------------------------------------
+    {
+      // Find the offsets of the first and last points of a sub-rectangle
+      if ((dom.get_dim() <= 0) || (sub.get_dim() != dom.get_dim()))
+        return false;
+      DomainPoint lo, hi;
+      lo.dim = sub.get_dim();
+      hi.dim = sub.get_dim();
+      for (int i = 0; i < sub.get_dim(); i++)
+      {
+        lo.point_data[i] = sub.rect_data[i];
+        hi.point_data[i] = sub.rect_data[sub.get_dim() + i];
+      }
+      return (linearize_dense_point(dom, lo, first) &&
+              linearize_dense_point(dom, hi, last));
+    }
+
+
     /////////////////////////////////////////////////////////////
     // Argument Map Impl
     /////////////////////////////////////////////////////////////
@@ -81,7 +149,8 @@ namespace LegionRuntime {
     //--------------------------------------------------------------------------
     ArgumentMap::Impl::Impl(void)
       : Collectable(), next(NULL), 
-        store(legion_new<ArgumentMapStore>()), frozen(false)
+        store(legion_new<ArgumentMapStore>()), frozen(false),
+        dense_offsets(NULL), dense_buffer(NULL)
     //--------------------------------------------------------------------------
     {
       // This is the first impl in the chain so we make the store
@@ -90,7 +159,8 @@ namespace LegionRuntime {
 
     //--------------------------------------------------------------------------
     ArgumentMap::Impl::Impl(ArgumentMapStore *st)
-      : Collectable(), next(NULL), store(st), frozen(false)
+      : Collectable(), next(NULL), store(st), frozen(false),
+        dense_offsets(NULL), dense_buffer(NULL)
     //--------------------------------------------------------------------------
     {
     }
@@ -98,14 +168,16 @@ namespace LegionRuntime {
     //--------------------------------------------------------------------------
     ArgumentMap::Impl::Impl(ArgumentMapStore *st,
                             const std::map<DomainPoint,TaskArgument> &args)
-      : Collectable(), arguments(args), next(NULL), store(st), frozen(false)
+      : Collectable(), arguments(args), next(NULL), store(st), frozen(false),
+        dense_offsets(NULL), dense_buffer(NULL)
     //--------------------------------------------------------------------------
     {
     }
 
     //--------------------------------------------------------------------------
     ArgumentMap::Impl::Impl(const Impl &impl)
-      : Collectable(), next(NULL), store(NULL), frozen(false)
+      : Collectable(), next(NULL), store(NULL), frozen(false),
+        dense_offsets(NULL), dense_buffer(NULL)
     //--------------------------------------------------------------------------
     {
       // This should never ever be called
@@ -116,6 +188,15 @@ namespace LegionRuntime {
     ArgumentMap::Impl::~Impl(void)
     //--------------------------------------------------------------------------
     {
+      if (dense_offsets != NULL)
+      {
+        const size_t num_points = dense_domain.get_volume();
+        if (dense_buffer != NULL)
+          legion_free(STORE_ARGUMENT_ALLOC, dense_buffer, 
+                      dense_offsets[num_points]);
+        legion_free(STORE_ARGUMENT_ALLOC, dense_offsets,
+                    (num_points+1) * sizeof(size_t));
+      }
       if (next != NULL)
       {
         // Remove our reference to the next thing in the list
@@ -146,6 +227,11 @@ namespace LegionRuntime {
     bool ArgumentMap::Impl::has_point(const DomainPoint &point)
     //--------------------------------------------------------------------------
     {
+      // Dense copies only hold non-empty arguments so a
+      // point is present if and only if it has some bytes
+      size_t offset;
+      if (find_dense_point(point, offset))
+        return (dense_offsets[offset+1] > dense_offsets[offset]);
       // Go to the end of the list
       if (next == NULL)
       {
@@ -169,6 +255,10 @@ namespace LegionRuntime {
       // Go to the end of the list
       if (next == NULL)
       {
+#ifdef DEBUG_HIGH_LEVEL
+        // Dense arguments are only made for frozen or unpacked maps
+        assert(frozen || (dense_offsets == NULL));
+#endif
         // Check to see if we're frozen or not, note we don't really need the 
         // lock here since there is only one thread that is traversing the list.  
         // The only multi-threaded part is with the references and we clearly 
@@ -210,6 +300,9 @@ namespace LegionRuntime {
     {
       if (next == NULL)
       {
+#ifdef DEBUG_HIGH_LEVEL
+        assert(frozen || (dense_offsets == NULL));
+#endif
         if (frozen)
         {
           next = clone();
@@ -240,6 +333,14 @@ namespace LegionRuntime {
     TaskArgument ArgumentMap::Impl::get_point(const DomainPoint &point) const
     //--------------------------------------------------------------------------
     {
+      size_t offset;
+      if (find_dense_point(point, offset))
+      {
+        const size_t size = dense_offsets[offset+1] - dense_offsets[offset];
+        if (size == 0)
+          return TaskArgument();
+        return TaskArgument(dense_buffer + dense_offsets[offset], size);
+      }
       if (next == NULL)
       {
         std::map<DomainPoint,TaskArgument>::const_iterator finder = 
@@ -263,6 +364,16 @@ namespace LegionRuntime {
     //--------------------------------------------------------------------------
     {
       RezCheck z(rez);
+      // If we have dense arguments covering the domain then send those
+      size_t first, last;
+      const bool dense = (dense_offsets != NULL) &&
+        linearize_dense_subrect(dense_domain, dom, first, last);
+      rez.serialize(dense);
+      if (dense)
+      {
+        pack_dense_arguments(rez, dom);
+        return;
+      }
       // Count how many points in the domain
       size_t num_points = 0;
       for (Domain::DomainPointIterator itr(dom); itr; itr++)
@@ -288,6 +399,13 @@ namespace LegionRuntime {
     //--------------------------------------------------------------------------
     {
       DerezCheck z(derez);
+      bool dense;
+      derez.deserialize(dense);
+      if (dense)
+      {
+        unpack_dense_arguments(derez);
+        return;
+      }
       size_t num_points;
       derez.deserialize(num_points);
       for (unsigned idx = 0; idx < num_points; idx++)
@@ -306,16 +424,24 @@ namespace LegionRuntime {
     }
 
     //--------------------------------------------------------------------------
-    ArgumentMap::Impl* ArgumentMap::Impl::freeze(void)
+    ArgumentMap::Impl* ArgumentMap::Impl::freeze(const Domain &launch_domain)
     //--------------------------------------------------------------------------
     {
       if (next == NULL)
       {
-        frozen = true;
+        // Only the owner of the argument map can see an impl that
+        // isn't frozen yet, so this is the one time we can safely
+        // build the dense arguments.  Later launches reusing the map
+        // over other domains fall back to the map for their points.
+        if (!frozen)
+        {
+          make_dense(launch_domain);
+          frozen = true;
+        }
         return this;
       }
       else
-        return next->freeze();
+        return next->freeze(launch_domain);
     }
 
     //--------------------------------------------------------------------------
@@ -329,6 +455,141 @@ namespace LegionRuntime {
       return new_impl;
     }
 
+    //--------------------------------------------------------------------------
+    void ArgumentMap::Impl::make_dense(const Domain &dom)
+    //--------------------------------------------------------------------------
+    {
+#ifdef DEBUG_HIGH_LEVEL
+      assert(!frozen);
+      assert(next == NULL);
+      assert(dense_offsets == NULL);
+#endif
+      // Only worth it if most of the points have arguments
+      if ((dom.get_dim() <= 0) || arguments.empty())
+        return;
+      const size_t num_points = dom.get_volume();
+      if ((2 * arguments.size()) < num_points)
+        return;
+      // Record the size of each point's argument, then turn
+      // the sizes into offsets with a prefix sum.  Empty arguments
+      // would look like missing points so we don't handle them.
+      size_t *offsets = (size_t*)legion_malloc(STORE_ARGUMENT_ALLOC,
+                                      (num_points+1) * sizeof(size_t));
+      memset(offsets, 0, (num_points+1) * sizeof(size_t));
+      for (std::map<DomainPoint,TaskArgument>::const_iterator it = 
+            arguments.begin(); it != arguments.end(); it++)
+      {
+        if (it->second.get_size() == 0)
+        {
+          legion_free(STORE_ARGUMENT_ALLOC, offsets,
+                      (num_points+1) * sizeof(size_t));
+          return;
+        }
+        size_t offset;
+        if (linearize_dense_point(dom, it->first, offset))
+          offsets[offset+1] = it->second.get_size();
+      }
+      for (unsigned idx = 0; idx < num_points; idx++)
+        offsets[idx+1] += offsets[idx];
+      char *buffer = NULL;
+      if (offsets[num_points] > 0)
+      {
+        buffer = (char*)legion_malloc(STORE_ARGUMENT_ALLOC, 
+                                      offsets[num_points]);
+        for (std::map<DomainPoint,TaskArgument>::const_iterator it = 
+              arguments.begin(); it != arguments.end(); it++)
+        {
+          size_t offset;
+          if (linearize_dense_point(dom, it->first, offset))
+            memcpy(buffer + offsets[offset], it->second.get_ptr(),
+                   it->second.get_size());
+        }
+      }
+      dense_domain = dom;
+      dense_buffer = buffer;
+      dense_offsets = offsets;
+    }
+
+    //--------------------------------------------------------------------------
+    bool ArgumentMap::Impl::find_dense_point(const DomainPoint &point,
+                                             size_t &offset) const
+    //--------------------------------------------------------------------------
+    {
+      if (dense_offsets == NULL)
+        return false;
+      return linearize_dense_point(dense_domain, point, offset);
+    }
+
+    //--------------------------------------------------------------------------
+    void ArgumentMap::Impl::pack_dense_arguments(Serializer &rez,
+                                                 const Domain &dom)
+    //--------------------------------------------------------------------------
+    {
+      const size_t num_points = dom.get_volume();
+      rez.serialize(dom);
+      rez.serialize(num_points);
+      size_t first, last;
+      linearize_dense_subrect(dense_domain, dom, first, last);
+      if ((last - first + 1) == num_points)
+      {
+        // The points are contiguous in our linearization so we can
+        // send our offsets and buffer directly and let the receiver
+        // rebase the offsets
+        rez.serialize(dense_offsets + first, (num_points+1) * sizeof(size_t));
+        const size_t bytes = dense_offsets[last+1] - dense_offsets[first];
+        rez.serialize(bytes);
+        rez.serialize(dense_buffer + dense_offsets[first], bytes);
+      }
+      else
+      {
+        // Gather the points of the sub-rectangle in its own order
+        std::vector<size_t> offsets(num_points+1);
+        std::vector<size_t> sources(num_points);
+        offsets[0] = 0;
+        unsigned idx = 0;
+        for (Domain::DomainPointIterator itr(dom); itr; itr++, idx++)
+        {
+          find_dense_point(itr.p, sources[idx]);
+          offsets[idx+1] = offsets[idx] + 
+            (dense_offsets[sources[idx]+1] - dense_offsets[sources[idx]]);
+        }
+        rez.serialize(&offsets[0], (num_points+1) * sizeof(size_t));
+        rez.serialize(offsets[num_points]);
+        for (idx = 0; idx < num_points; idx++)
+          rez.serialize(dense_buffer + dense_offsets[sources[idx]],
+                        offsets[idx+1] - offsets[idx]);
+      }
+    }
+
+    //--------------------------------------------------------------------------
+    void ArgumentMap::Impl::unpack_dense_arguments(Deserializer &derez)
+    //--------------------------------------------------------------------------
+    {
+#ifdef DEBUG_HIGH_LEVEL
+      assert(dense_offsets == NULL);
+      assert(arguments.empty());
+#endif
+      derez.deserialize(dense_domain);
+      size_t num_points;
+      derez.deserialize(num_points);
+      dense_offsets = (size_t*)legion_malloc(STORE_ARGUMENT_ALLOC,
+                                      (num_points+1) * sizeof(size_t));
+      derez.deserialize(dense_offsets, (num_points+1) * sizeof(size_t));
+      const size_t base = dense_offsets[0];
+      if (base > 0)
+      {
+        for (unsigned idx = 0; idx <= num_points; idx++)
+          dense_offsets[idx] -= base;
+      }
+      size_t bytes;
+      derez.deserialize(bytes);
+      if (bytes > 0)
+      {
+        dense_buffer = (char*)legion_malloc(STORE_ARGUMENT_ALLOC, bytes);
+        derez.deserialize(dense_buffer, bytes);
+      }
+    }
+
     /////////////////////////////////////////////////////////////
     // Argument Map Store 
     /////////////////////////////////////////////////////////////
@@ -352,7 +613,7 @@ namespace LegionRuntime {
     //--------------------------------------------------------------------------
     {
       // Free up all the values that we had stored
-      for (std::set<TaskArgument>::const_iterator it = values.begin();
+      for (std::vector<TaskArgument>::const_iterator it = values.begin();
             it != values.end(); it++)
       {
         legion_free(STORE_ARGUMENT_ALLOC, it->get_ptr(), it->get_size());
@@ -375,7 +636,7 @@ namespace LegionRuntime {
       void *buffer = legion_malloc(STORE_ARGUMENT_ALLOC, arg.get_size());
       memcpy(buffer, arg.get_ptr(), arg.get_size());
       TaskArgument new_arg(buffer,arg.get_size());
-      values.insert(new_arg);
+      values.push_back(new_arg);
       return new_arg;
     }
 
@@ -419,12 +680,7 @@ namespace LegionRuntime {
       // don't want to leak events
       if (!ready_event.has_triggered())
         ready_event.trigger();
-      if (result != NULL)
-      {
-        free(result);
-        result = NULL;
-        result_size = 0;
-      }
+      free_result();
       if (producer_op != NULL)
         producer_op->remove_mapping_reference(op_gen);
     }
@@ -574,19 +830,22 @@ namespace LegionRuntime {
 #ifdef DEBUG_HIGH_LEVEL
       assert(owner);
 #endif
-      // Clean out any previous results we've save
-      if (result != NULL)
-        free(result);
-      if (own)
+      if (own && (arglen > LEGION_MAX_INLINE_FUTURE_SIZE))
       {
+        // Take ownership of large results instead of copying them
+        free_result();
         result = const_cast<void*>(args);
         result_size = arglen;
       }
       else
       {
-        result_size = arglen;
-        result = malloc(result_size);
-        memcpy(result,args,result_size);
+        // Clean out any previous results and copy the new one
+        void *buffer = allocate_result(arglen);
+        memcpy(buffer,args,arglen);
+        // Small results are always kept inline so we
+        // can release the buffer if we were given it
+        if (own)
+          free(const_cast<void*>(args));
       }
       empty = false; 
     }
@@ -595,22 +854,44 @@ namespace LegionRuntime {
     void Future::Impl::unpack_future(Deserializer &derez)
     //-------------------------------------------------------------------------
     {
-      // Should only happen on the owner
-      // Clean out any previous results we've save
       DerezCheck z(derez);
-      derez.deserialize(result_size);
+      size_t future_size;
+      derez.deserialize(future_size);
       // Handle the case where we get a double send of the
       // result once from another remote node and once
       // from the original owner
-      if (result == NULL)
-        result = malloc(result_size);
       if (!ready_event.has_triggered())
       {
-        derez.deserialize(result,result_size);
+        // Deserialize straight into the result buffer
+        void *buffer = allocate_result(future_size);
+        derez.deserialize(buffer,future_size);
         empty = false;
       }
       else
-        derez.advance_pointer(result_size);
+        derez.advance_pointer(future_size);
+    }
+
+    //--------------------------------------------------------------------------
+    void* Future::Impl::allocate_result(size_t size)
+    //--------------------------------------------------------------------------
+    {
+      free_result();
+      if (size <= LEGION_MAX_INLINE_FUTURE_SIZE)
+        result = inline_result;
+      else
+        result = malloc(size);
+      result_size = size;
+      return result;
+    }
+
+    //--------------------------------------------------------------------------
+    void Future::Impl::free_result(void)
+    //--------------------------------------------------------------------------
+    {
+      if ((result != NULL) && (result != inline_result))
+        free(result);
+      result = NULL;
+      result_size = 0;
     }
 
     //--------------------------------------------------------------------------
@@ -711,19 +992,48 @@ namespace LegionRuntime {
 #ifdef DEBUG_HIGH_LEVEL
       assert(owner);
 #endif
-      Serializer rez;
+      std::vector<AddressSpaceID> targets;
       {
-        rez.serialize(did);
-        RezCheck z(rez);
-        rez.serialize(result_size);
-        rez.serialize(result,result_size);
+        // Need to hold the lock when reading the set of remote spaces
+        AutoLock gc(gc_lock,1,false/*exclusive*/);
+        if (registered_waiters.empty())
+          return;
+        targets.insert(targets.end(), registered_waiters.begin(),
+                       registered_waiters.end());
       }
-      // Need to hold the lock when reading the set of remote spaces
-      AutoLock gc(gc_lock,1,false/*exclusive*/);
-      for (std::set<AddressSpaceID>::const_iterator it = 
-            registered_waiters.begin(); it != registered_waiters.end(); it++)
+      forward_result(targets);
+    }
+
+    //--------------------------------------------------------------------------
+    void Future::Impl::forward_result(
+                                  const std::vector<AddressSpaceID> &targets)
+    //--------------------------------------------------------------------------
+    {
+      // Split the targets into at most radix subtrees and send the
+      // result to the first space in each one along with the list
+      // of the other spaces in the subtree that it has to forward to
+      const size_t num_targets = targets.size();
+      const size_t num_children = 
+        (num_targets < LEGION_FUTURE_BROADCAST_RADIX) ? num_targets :
+          LEGION_FUTURE_BROADCAST_RADIX;
+      size_t start = 0;
+      for (unsigned idx = 0; idx < num_children; idx++)
       {
-        runtime->send_future_result(*it, rez); 
+        const size_t stop = start + (num_targets / num_children) + 
+          ((idx < (num_targets % num_children)) ? 1 : 0);
+        Serializer rez;
+        rez.serialize(did);
+        rez.serialize(owner_space);
+        {
+          RezCheck z(rez);
+          rez.serialize(result_size);
+          rez.serialize(result,result_size);
+        }
+        rez.serialize<size_t>(stop - start - 1);
+        for (size_t sub = start+1; sub < stop; sub++)
+          rez.serialize(targets[sub]);
+        runtime->send_future_result(targets[start], rez);
+        start = stop;
       }
     }
 
@@ -803,16 +1113,7 @@ namespace LegionRuntime {
             send_result = false;
         }
         if (send_result)
-        {
-          Serializer rez;
-          {
-            rez.serialize(did);
-            RezCheck z(rez);
-            rez.serialize(result_size);
-            rez.serialize(result,result_size);
-          }
-          runtime->send_future_result(sid, rez);
-        }
+          forward_result(std::vector<AddressSpaceID>(1, sid));
       }
       else
       {
@@ -861,8 +1162,21 @@ namespace LegionRuntime {
     {
       DistributedID did;
       derez.deserialize(did);
-      Future::Impl *future = runtime->find_future(did);
+      AddressSpaceID own_space;
+      derez.deserialize(own_space);
+      // Results forwarded through the broadcast tree can arrive
+      // before the message from the owner that sends the future
+      Future::Impl *future = runtime->find_or_create_future(did, own_space);
       future->unpack_future(derez);
+      size_t num_forwards;
+      derez.deserialize(num_forwards);
+      std::vector<AddressSpaceID> forward_targets(num_forwards);
+      for (unsigned idx = 0; idx < num_forwards; idx++)
+        derez.deserialize(forward_targets[idx]);
+      // Pass the result on to the rest of our subtree
+      // before we trigger the future locally
+      if (!forward_targets.empty())
+        future->forward_result(forward_targets);
       future->complete_future();
     }
 
@@ -929,6 +1243,21 @@ namespace LegionRuntime {
     {
     }
 
+    //--------------------------------------------------------------------------
+    FutureMap::Impl::Impl(SingleTask *ctx, TaskOp *t, 
+                          const Domain &launch_domain, Runtime *rt)
+      : Collectable(), context(ctx), task(t), task_gen(t->get_generation()),
+        valid(true), runtime(rt), ready_event(t->get_completion_event()),
+        lock(Reservation::create_reservation()) 
+    //--------------------------------------------------------------------------
+    {
+      if (launch_domain.get_dim() > 0)
+      {
+        dense_domain = launch_domain;
+        dense_futures.resize(launch_domain.get_volume());
+      }
+    }
+
     //--------------------------------------------------------------------------
     FutureMap::Impl::Impl(SingleTask *ctx, Event comp_event, Runtime *rt)
       : Collectable(), context(ctx), task(NULL), task_gen(0),
@@ -962,6 +1291,7 @@ namespace LegionRuntime {
     //--------------------------------------------------------------------------
     {
       futures.clear();
+      dense_futures.clear();
       if (lock.exists())
       {
         lock.destroy_reservation();
@@ -1003,6 +1333,17 @@ namespace LegionRuntime {
       {
         Event lock_event = lock.acquire(0, true/*exclusive*/);
         lock_event.wait();
+        size_t offset;
+        if (linearize_dense_point(dense_domain, point, offset))
+        {
+          Future &result = dense_futures[offset];
+          // Make the future for the point the first time it is asked for
+          if (result == Future())
+            result = runtime->help_create_future(task);
+          Future copy = result;
+          lock.release();
+          return copy;
+        }
         // Check to see if we already have a future for the point
         std::map<DomainPoint,Future>::const_iterator finder = 
                                               futures.find(point);
@@ -1072,6 +1413,13 @@ namespace LegionRuntime {
       {
         runtime->help_complete_future(it->second);
       }
+      for (std::vector<Future>::const_iterator it = 
+            dense_futures.begin(); it != dense_futures.end(); it++)
+      {
+        if ((*it) == Future())
+          continue;
+        runtime->help_complete_future(*it);
+      }
     }
 
     //--------------------------------------------------------------------------
@@ -1090,6 +1438,14 @@ namespace LegionRuntime {
         if (restart)
           result = true;
       }
+      for (std::vector<Future>::const_iterator it = 
+            dense_futures.begin(); it != dense_futures.end(); it++)
+      {
+        if ((*it) == Future())
+          continue;
+        if (runtime->help_reset_future(*it))
+          result = true;
+      }
       return result;
     }
 
@@ -4631,7 +4987,7 @@ namespace LegionRuntime {
 
     //--------------------------------------------------------------------------
     GarbageCollectionEpoch::GarbageCollectionEpoch(Runtime *rt)
-      : runtime(rt)
+      : runtime(rt), remaining(0), priority(0), launch_time(0)
     //--------------------------------------------------------------------------
     {
     }
@@ -4681,32 +5037,59 @@ namespace LegionRuntime {
     }
 
     //--------------------------------------------------------------------------
-    Event GarbageCollectionEpoch::launch(int priority)
+    Event GarbageCollectionEpoch::launch(int prio)
     //--------------------------------------------------------------------------
     {
-      // Set remaining to the total number of collections
-      remaining = collections.size();
+      priority = prio;
+      launch_time = Realm::Clock::current_time_in_nanoseconds();
+      if (collections.empty())
+        return Event::NO_EVENT;
+      views.reserve(collections.size());
+      for (std::map<LogicalView*,std::set<Event> >::const_iterator it =
+            collections.begin(); it != collections.end(); it++)
+        views.push_back(
+            std::pair<LogicalView*,const std::set<Event>*>(it->first, 
+                                                           &it->second));
+      const unsigned batch_size = 
+        (Runtime::gc_batch_size > 0) ? Runtime::gc_batch_size : 1;
+      const unsigned total_views = views.size();
+      // Set remaining to the total number of batches
+      remaining = (total_views + batch_size - 1) / batch_size;
       GarbageCollectionArgs args;
       args.hlr_id = HLR_DEFERRED_COLLECT_ID;
       args.epoch = this;
-      std::set<Event> events;
-      for (std::map<LogicalView*,std::set<Event> >::const_iterator it =
-            collections.begin(); it != collections.end(); /*nothing*/)
-      {
-        args.view = it->first;
-        Event precondition = Event::merge_events(it->second);
-        // Avoid the deletion race by testing the condition 
-        // before launching the task
-        it++;
-        bool done = (it == collections.end());
-        Event e = runtime->issue_runtime_meta_task(&args, sizeof(args), 
+      args.start = 0;
+      // Continuations of batches that run out of time are launched later
+      // so keep a separate event that triggers when the epoch is done
+      UserEvent done_event = UserEvent::create_user_event();
+      collected = done_event;
+      for (unsigned first = 0; first < total_views; first += batch_size)
+      {
+        args.first = first;
+        args.next = first;
+        args.last = std::min(first + batch_size, total_views);
+        // Each view's events are merged once and then batched
+        // behind a single precondition
+        std::set<Event> batch_events;
+        for (unsigned idx = args.first; idx < args.last; idx++)
+        {
+          const std::set<Event> &view_events = *(views[idx].second);
+          if (view_events.size() == 1)
+            batch_events.insert(*(view_events.begin()));
+          else
+            batch_events.insert(Event::merge_events(view_events));
+        }
+        Event precondition = Event::merge_events(batch_events);
+        // Avoid the deletion race by not touching any members
+        // after the last batch has been launched
+        const bool done = (args.last == total_views);
+        runtime->issue_runtime_meta_task(&args, sizeof(args), 
                                          HLR_DEFERRED_COLLECT_ID, NULL,
-                                         precondition, priority);
-        events.insert(e);
+                                         precondition, prio);
         if (done)
           break;
       }
-      return Event::merge_events(events);
+      return done_event;
     }
 
     //--------------------------------------------------------------------------
@@ -4714,14 +5097,43 @@ namespace LegionRuntime {
                                               const GarbageCollectionArgs *args)
     //--------------------------------------------------------------------------
     {
-      std::map<LogicalView*,std::set<Event> >::iterator finder = 
-        collections.find(args->view);
-#ifdef DEBUG_HIGH_LEVEL
-      assert(finder != collections.end());
-#endif
-      LogicalView::handle_deferred_collect(args->view, finder->second);
+      const long long start = (args->start > 0) ? (long long)args->start :
+        Realm::Clock::current_time_in_nanoseconds();
+      const long long deadline = 
+        Realm::Clock::current_time_in_nanoseconds() + 
+        1000LL * Runtime::gc_step_budget;
+      unsigned idx = args->next;
+      while (idx < args->last)
+      {
+        LogicalView::handle_deferred_collect(views[idx].first, 
+                                             *(views[idx].second));
+        idx++;
+        if ((idx < args->last) && 
+            (Realm::Clock::current_time_in_nanoseconds() > deadline))
+          break;
+      }
+      if (idx < args->last)
+      {
+        // Out of time, defer the rest of the batch so that
+        // other meta-tasks get a chance to run
+        GarbageCollectionArgs next_args = *args;
+        next_args.next = idx;
+        next_args.start = start;
+        runtime->issue_runtime_meta_task(&next_args, sizeof(next_args),
+                                         HLR_DEFERRED_COLLECT_ID, NULL,
+                                         Event::NO_EVENT, priority);
+        return false;
+      }
+      if (runtime->profiler != NULL)
+        runtime->profiler->record_gc_batch(args->last - args->first, 
+            launch_time, start, Realm::Clock::current_time_in_nanoseconds());
       // See if we are done
-      return (__sync_add_and_fetch(&remaining, -1) == 0);
+      if (__sync_add_and_fetch(&remaining, -1) == 0)
+      {
+        collected.trigger();
+        return true;
+      }
+      return false;
     }
     
     /////////////////////////////////////////////////////////////
@@ -4805,6 +5217,8 @@ namespace LegionRuntime {
         LegionLogging::initialize_legion_logging(unique, all_locals);
       }
 #endif
+      if (Runtime::legion_spy_file != NULL)
+        LegionSpy::initialize_spy_stream(Runtime::legion_spy_file, unique);
       // Construct a local utility processor group
       if (local_utils.empty())
       {
@@ -4969,6 +5383,12 @@ namespace LegionRuntime {
         LegionLogging::finalize_legion_logging(all_procs);
       }
 #endif
+#ifdef LEGION_GC_STATS
+      DistributedCollectable::report_reference_statistics();
+      HierarchicalCollectable::report_reference_statistics();
+#endif
+      if (Runtime::legion_spy_file != NULL)
+        LegionSpy::finalize_spy_stream();
       if (profiler != NULL)
       {
         profiler->finalize();
@@ -5384,12 +5804,13 @@ namespace LegionRuntime {
         LegionLogging::log_top_level_task(Runtime::legion_main_id,
                                           top_task->get_unique_task_id());
 #endif
-#ifdef LEGION_SPY
-        Runtime::log_machine(machine);
-        LegionSpy::log_top_level_task(Runtime::legion_main_id,
-                                      top_task->get_unique_task_id(),
-                                      top_task->variants->name);
-#endif
+        if (LegionSpy::spy_logging)
+        {
+          Runtime::log_machine(machine);
+          LegionSpy::log_top_level_task(Runtime::legion_main_id,
+                                        top_task->get_unique_task_id(),
+                                        top_task->variants->name);
+        }
         // Put the task in the ready queue
         add_to_ready_queue(proc, top_task, false/*prev failure*/);
       }
@@ -5540,9 +5961,7 @@ namespace LegionRuntime {
       LegionLogging::log_top_index_space(ctx->get_executing_processor(),
                                          handle);
 #endif
-#ifdef LEGION_SPY
       LegionSpy::log_top_index_space(handle.id);
-#endif
       LowLevel::IndexSpace space = 
                       LowLevel::IndexSpace::create_index_space(max_num_elmts);
       forest->create_index_space(handle, Domain(space), 
@@ -5583,9 +6002,7 @@ namespace LegionRuntime {
       LegionLogging::log_top_index_space(ctx->get_executing_processor(),
                                          handle);
 #endif
-#ifdef LEGION_SPY
       LegionSpy::log_top_index_space(handle.id);
-#endif
       forest->create_index_space(handle, domain, DENSE_ARRAY_KIND, NO_MEMORY);
       ctx->register_index_space_creation(handle);
       return handle;
@@ -5690,9 +6107,7 @@ namespace LegionRuntime {
       LegionLogging::log_top_index_space(ctx->get_executing_processor(),
                                          handle);
 #endif
-#ifdef LEGION_SPY
       LegionSpy::log_top_index_space(handle.id);
-#endif
       forest->create_index_space(handle, hull, domains,
                                  DENSE_ARRAY_KIND, NO_MEMORY);
       ctx->register_index_space_creation(handle);
@@ -7413,10 +7828,8 @@ namespace LegionRuntime {
       part_op->initialize_index_space_union(ctx, result, handles);
       handle_ready.trigger(part_op->get_handle_ready());
       domain_ready.trigger(part_op->get_completion_event());
-#ifdef LEGION_SPY
       LegionSpy::log_event_dependence(part_op->get_handle_ready(), handle_ready);
       LegionSpy::log_event_dependence(part_op->get_completion_event(), domain_ready);
-#endif
       // Now we can add the operation to the queue
       Processor proc = ctx->get_executing_processor();
       add_to_dependence_queue(proc, part_op);
@@ -7464,10 +7877,8 @@ namespace LegionRuntime {
       part_op->initialize_index_space_union(ctx, result, handle);
       handle_ready.trigger(part_op->get_handle_ready());
       domain_ready.trigger(part_op->get_completion_event());
-#ifdef LEGION_SPY
       LegionSpy::log_event_dependence(part_op->get_handle_ready(), handle_ready);
       LegionSpy::log_event_dependence(part_op->get_completion_event(), domain_ready);
-#endif
       // Now we can add the operation to the queue
       Processor proc = ctx->get_executing_processor();
       add_to_dependence_queue(proc, part_op);
@@ -7517,10 +7928,8 @@ namespace LegionRuntime {
       part_op->initialize_index_space_intersection(ctx, result, handles);
       handle_ready.trigger(part_op->get_handle_ready());
       domain_ready.trigger(part_op->get_completion_event());
-#ifdef LEGION_SPY
       LegionSpy::log_event_dependence(part_op->get_handle_ready(), handle_ready);
       LegionSpy::log_event_dependence(part_op->get_completion_event(), domain_ready);
-#endif
       // Now we can add the operation to the queue
       Processor proc = ctx->get_executing_processor();
       add_to_dependence_queue(proc, part_op);
@@ -7570,10 +7979,8 @@ namespace LegionRuntime {
       part_op->initialize_index_space_intersection(ctx, result, handle);
       handle_ready.trigger(part_op->get_handle_ready());
       domain_ready.trigger(part_op->get_completion_event());
-#ifdef LEGION_SPY
       LegionSpy::log_event_dependence(part_op->get_handle_ready(), handle_ready);
       LegionSpy::log_event_dependence(part_op->get_completion_event(), domain_ready);
-#endif
       // Now we can add the operation to the queue
       Processor proc = ctx->get_executing_processor();
       add_to_dependence_queue(proc, part_op);
@@ -7624,10 +8031,8 @@ namespace LegionRuntime {
       part_op->initialize_index_space_difference(ctx, result, initial, handles);
       handle_ready.trigger(part_op->get_handle_ready());
       domain_ready.trigger(part_op->get_completion_event());
-#ifdef LEGION_SPY
       LegionSpy::log_event_dependence(part_op->get_handle_ready(), handle_ready);
       LegionSpy::log_event_dependence(part_op->get_completion_event(), domain_ready);
-#endif
       // Now we can add the operation to the queue
       Processor proc = ctx->get_executing_processor();
       add_to_dependence_queue(proc, part_op);
@@ -8054,9 +8459,7 @@ namespace LegionRuntime {
         exit(ERROR_LEAF_TASK_VIOLATION);
       }
 #endif
-#ifdef LEGION_SPY
       LegionSpy::log_field_space(space.id);
-#endif
       forest->create_field_space(space);
       ctx->register_field_space_creation(space);
 #ifdef LEGION_LOGGING
@@ -8168,9 +8571,7 @@ namespace LegionRuntime {
         exit(ERROR_LEAF_TASK_VIOLATION);
       }
 #endif
-#ifdef LEGION_SPY
       LegionSpy::log_top_region(index_space.id, field_space.id, tid);
-#endif
 #ifdef LEGION_LOGGING
       LegionLogging::log_top_region(ctx->get_executing_processor(),
                                     index_space, field_space, tid);
@@ -10093,9 +10494,7 @@ namespace LegionRuntime {
                           ctx->variants->name, ctx->get_unique_task_id());
 #endif
       Barrier result = Barrier::create_barrier(arrivals);
-#ifdef LEGION_SPY
       LegionSpy::log_phase_barrier(result);
-#endif
       return PhaseBarrier(result);
     }
 
@@ -10132,9 +10531,7 @@ namespace LegionRuntime {
 #endif
       Barrier bar = pb.phase_barrier;
       Barrier new_bar = bar.advance_barrier();
-#ifdef LEGION_SPY
       LegionSpy::log_event_dependence(bar, new_bar);
-#endif
       return PhaseBarrier(new_bar);
     }
 
@@ -10158,9 +10555,7 @@ namespace LegionRuntime {
 #endif
       Barrier result = Barrier::create_barrier(arrivals, redop, 
                                                init_value, init_size);
-#ifdef LEGION_SPY
       LegionSpy::log_phase_barrier(result);
-#endif
       return DynamicCollective(result, redop);
     }
 
@@ -10274,9 +10669,7 @@ namespace LegionRuntime {
 #endif
       Barrier bar = dc.phase_barrier;
       Barrier new_bar = bar.advance_barrier();
-#ifdef LEGION_SPY
       LegionSpy::log_event_dependence(bar, new_bar);
-#endif
       return DynamicCollective(new_bar, dc.redop);
     }
 
@@ -11059,9 +11452,7 @@ namespace LegionRuntime {
 #endif
       if (fid == AUTO_GENERATE_ID)
         fid = get_unique_field_id();
-#ifdef LEGION_SPY
       LegionSpy::log_field_creation(space.id, fid);
-#endif
 #ifdef LEGION_LOGGING
       LegionLogging::log_field_creation(ctx->get_executing_processor(),
                                         space, fid, local);
@@ -11142,9 +11533,7 @@ namespace LegionRuntime {
       {
         if (resulting_fields[idx] == AUTO_GENERATE_ID)
           resulting_fields[idx] = get_unique_field_id();
-#ifdef LEGION_SPY
         LegionSpy::log_field_creation(space.id, resulting_fields[idx]);
-#endif
 #ifdef LEGION_LOGGING
         LegionLogging::log_field_creation(ctx->get_executing_processor(),
                                           space, resulting_fields[idx], local);
@@ -15130,6 +15519,8 @@ namespace LegionRuntime {
           return "Logical State";
         case PHYSICAL_STATE_ALLOC:
           return "Physical State";
+        case FIELD_TREE_ALLOC:
+          return "Field Tree";
         default:
           assert(false); // should never get here
       }
@@ -15391,6 +15782,10 @@ namespace LegionRuntime {
                                       DEFAULT_MAX_FILTER_SIZE;
     /*static*/ unsigned Runtime::gc_epoch_size = 
                                       DEFAULT_GC_EPOCH_SIZE;
+    /*static*/ unsigned Runtime::gc_batch_size = 
+                                      DEFAULT_GC_BATCH_SIZE;
+    /*static*/ unsigned Runtime::gc_step_budget = 
+                                      DEFAULT_GC_STEP_BUDGET;
     /*static*/ bool Runtime::enable_imprecise_filter = false;
     /*static*/ bool Runtime::separate_runtime_instances = false;
     /*static*/ bool Runtime::record_registration = false;
@@ -15398,6 +15793,7 @@ namespace LegionRuntime {
     /*static*/ bool Runtime::resilient_mode = false;
     /*static*/ bool Runtime::unsafe_launch = false;
     /*static*/ bool Runtime::dynamic_independence_tests = true;
+    /*static*/ const char* Runtime::legion_spy_file = NULL;
     /*static*/ unsigned Runtime::shutdown_counter = 0;
     /*static*/ int Runtime::mpi_rank = -1;
     /*static*/ unsigned Runtime::mpi_rank_table[MAX_NUM_NODES];
@@ -15507,6 +15903,7 @@ namespace LegionRuntime {
         resilient_mode = false;
         unsafe_launch = false;
         dynamic_independence_tests = true;
+        legion_spy_file = NULL;
         initial_task_window_size = DEFAULT_MAX_TASK_WINDOW;
         initial_task_window_hysteresis = DEFAULT_TASK_WINDOW_HYSTERESIS;
         initial_tasks_to_schedule = DEFAULT_MIN_TASKS_TO_SCHEDULE;
@@ -15515,6 +15912,8 @@ namespace LegionRuntime {
         max_message_size = DEFAULT_MAX_MESSAGE_SIZE;
         max_filter_size = DEFAULT_MAX_FILTER_SIZE;
         gc_epoch_size = DEFAULT_GC_EPOCH_SIZE;
+        gc_batch_size = DEFAULT_GC_BATCH_SIZE;
+        gc_step_budget = DEFAULT_GC_STEP_BUDGET;
 #ifdef INORDER_EXECUTION
         program_order_execution = true;
 #endif
@@ -15548,8 +15947,16 @@ namespace LegionRuntime {
           INT_ARG("-hl:message",max_message_size);
           INT_ARG("-hl:filter", max_filter_size);
           INT_ARG("-hl:epoch", gc_epoch_size);
+          INT_ARG("-hl:gc_batch", gc_batch_size);
+          INT_ARG("-hl:gc_budget", gc_step_budget);
           if (!strcmp(argv[i],"-hl:no_dyn"))
             dynamic_independence_tests = false;
+          BOOL_ARG("-hl:spy",LegionSpy::spy_logging);
+          if (!strcmp(argv[i],"-hl:spy_file"))
+          {
+            legion_spy_file = argv[++i];
+            continue;
+          }
 #ifdef DEBUG_HIGH_LEVEL
           BOOL_ARG("-hl:tree",logging_region_tree_state);
           BOOL_ARG("-hl:verbose",verbose_logging);
@@ -16193,7 +16600,6 @@ namespace LegionRuntime {
     /*static*/ void Runtime::log_machine(Machine machine)
     //--------------------------------------------------------------------------
     {
-#ifdef LEGION_SPY
       std::set<Processor> all_procs;
       machine.get_all_processors(all_procs);
       // Log processors
@@ -16238,7 +16644,6 @@ namespace LegionRuntime {
                                           it->bandwidth, it->latency);
         }
       }
-#endif
     }
 
 #ifdef SPECIALIZED_UTIL_PROCS
@@ -92,13 +92,26 @@ namespace LegionRuntime {
       void pack_arguments(Serializer &rez, const Domain &domain);
       void unpack_arguments(Deserializer &derez);
     protected:
-      Impl* freeze(void);
+      // Freezing also linearizes the arguments for the launch domain
+      // the first time, before any launch can see this impl
+      Impl* freeze(const Domain &launch_domain);
       Impl* clone(void);
+    protected:
+      void make_dense(const Domain &domain);
+      bool find_dense_point(const DomainPoint &point, size_t &offset) const;
+      void pack_dense_arguments(Serializer &rez, const Domain &domain);
+      void unpack_dense_arguments(Deserializer &derez);
     private:
       std::map<DomainPoint,TaskArgument> arguments;
       Impl *next;
       ArgumentMapStore *const store;
       bool frozen;
+    private:
+      // The argument for the point at linearized offset i in the
+      // dense domain is dense_buffer[dense_offsets[i]:dense_offsets[i+1]]
+      Domain dense_domain;
+      size_t *dense_offsets;
+      char *dense_buffer;
     };
 
     /**
@@ -121,7 +134,7 @@ namespace LegionRuntime {
     public:
       TaskArgument add_arg(const TaskArgument &arg);
     private:
-      std::set<TaskArgument> values;
+      std::vector<TaskArgument> values;
     };
 
     /**
@@ -163,6 +176,11 @@ namespace LegionRuntime {
       void set_result(const void *args, size_t arglen, bool own);
       // This will save the value of the future locally
       void unpack_future(Deserializer &derez);
+    protected:
+      // Get a buffer for a new result, inline if it is small enough
+      void* allocate_result(size_t size);
+      void free_result(void);
+    public:
       // Cause the future value to complete
       void complete_future(void);
       // Reset the future in case we need to restart the
@@ -182,6 +200,7 @@ namespace LegionRuntime {
     protected:
       void mark_sampled(void);
       void broadcast_result(void);
+      void forward_result(const std::vector<AddressSpaceID> &targets);
       bool send_future(AddressSpaceID sid);
       void register_waiter(AddressSpaceID sid);
     public:
@@ -199,12 +218,15 @@ namespace LegionRuntime {
     private:
       FRIEND_ALL_RUNTIME_CLASSES
       UserEvent ready_event;
+      // Points at inline_result for small results
       void *result; 
       size_t result_size;
       volatile bool empty;
       volatile bool sampled;
       // On the owner node, keep track of the registered waiters
       std::set<AddressSpaceID> registered_waiters;
+      char inline_result[LEGION_MAX_INLINE_FUTURE_SIZE] 
+        __attribute__((aligned(LEGION_MAX_ALIGNMENT)));
     };
 
     /**
@@ -221,6 +243,8 @@ namespace LegionRuntime {
     public:
       Impl(SingleTask *ctx, TaskOp *task, 
            Runtime *rt);
+      Impl(SingleTask *ctx, TaskOp *task,
+           const Domain &launch_domain, Runtime *rt);
       Impl(SingleTask *ctx, Event completion_event,
            Runtime *rt);
       Impl(SingleTask *ctx, Runtime *rt); // empty map
@@ -248,6 +272,10 @@ namespace LegionRuntime {
     private:
       Event ready_event;
       std::map<DomainPoint,Future> futures;
+      // Launches over rectangular domains keep their futures in
+      // a vector indexed by the linearized point instead
+      Domain dense_domain;
+      std::vector<Future> dense_futures;
       // Unlike futures, the future map is never used remotely
       // so it can create and destroy its own lock.
       Reservation lock;
@@ -937,7 +965,14 @@ namespace LegionRuntime {
 
     /**
      * \class GarbageCollectionEpoch
-     * A class for managing the a set of garbage collections
+     * A class for managing the a set of garbage collections.
+     * The termination events for each view are merged once
+     * when the epoch is launched and the views are split into
+     * batches that are each collected by a single meta-task
+     * once all their events have triggered. A batch that runs
+     * over the per-step time budget re-launches itself to
+     * collect the rest of its views so that large epochs
+     * don't monopolize the utility processors.
      */
     class GarbageCollectionEpoch {
     public:
@@ -945,7 +980,10 @@ namespace LegionRuntime {
       public:
         HLRTaskID hlr_id;
         GarbageCollectionEpoch *epoch;
-        LogicalView *view;
+        // Range of views in the batch and the next one to collect
+        unsigned first, last, next;
+        // When the batch first started running
+        unsigned long long start;
       };
     public:
       GarbageCollectionEpoch(Runtime *runtime);
@@ -960,7 +998,11 @@ namespace LegionRuntime {
     private:
       Runtime *const runtime;
       int remaining;
+      int priority;
+      unsigned long long launch_time;
+      UserEvent collected;
       std::map<LogicalView*,std::set<Event> > collections;
+      std::vector<std::pair<LogicalView*,const std::set<Event>*> > views;
     };
 
     /**
@@ -2233,6 +2275,8 @@ namespace LegionRuntime {
       static unsigned max_message_size;
       static unsigned max_filter_size;
       static unsigned gc_epoch_size;
+      static unsigned gc_batch_size;
+      static unsigned gc_step_budget;
       static bool enable_imprecise_filter;
       static bool separate_runtime_instances;
       static bool record_registration;
@@ -2240,6 +2284,7 @@ namespace LegionRuntime {
       static bool resilient_mode;
       static bool unsafe_launch;
       static bool dynamic_independence_tests;
+      static const char *legion_spy_file;
       static unsigned shutdown_counter;
       static int mpi_rank;
       static unsigned mpi_rank_table[MAX_NUM_NODES];
@@ -208,6 +208,13 @@ ifeq ($(strip $(USE_GASNET)),1)
     LD_FLAGS	+= -lgasnet-udp-par -lamudp
   endif
 
+else
+# without GASNet, multiple nodes can still be run as processes on one host
+#  (see shm_activemsg.cc)
+USE_SHM ?= 0
+ifeq ($(strip $(USE_SHM)),1)
+  CC_FLAGS	+= -DUSE_SHM_AM
+endif
 endif
 
 # general low-level doesn't use HDF by default
@@ -263,6 +270,10 @@ LOW_RUNTIME_SRC += $(LG_RT_DIR)/lowlevel_gpu.cc
 endif
 ifeq ($(strip $(USE_GASNET)),1)
 LOW_RUNTIME_SRC += $(LG_RT_DIR)/activemsg.cc
+else
+ifeq ($(strip $(USE_SHM)),1)
+LOW_RUNTIME_SRC += $(LG_RT_DIR)/shm_activemsg.cc
+endif
 endif
 LOW_RUNTIME_SRC += $(LG_RT_DIR)/lowlevel_dma.cc \
 	           $(LG_RT_DIR)/realm/threads.cc \
@@ -48,19 +48,24 @@ using namespace LegionRuntime::Accessor;
 #endif
 
 #define BASE_EVENTS	  1024	
+// Events are allocated in chunks of BASE_EVENTS which never move, so
+// the chunk table bounds the number of events at BASE_EVENTS*MAX_EVENT_CHUNKS
+#define MAX_EVENT_CHUNKS  16384
+// Number of free events each processor thread keeps for itself
+#define EVENT_CACHE_SIZE  64
 #define BASE_RESERVATIONS 64	
 #define BASE_METAS	  64
 #define BASE_ALLOCATORS	  64
 #define BASE_INSTANCES	  64
 
-// The number of threads for this version
+// Default number of threads, overridden with -ll:cpu, -ll:util and -ll:dma
 #define NUM_PROCS	4
 #define NUM_UTIL_PROCS  1
 #define NUM_DMA_THREADS 1
-// Maximum memory in global
+// Default memory in global (-ll:csize) and in each L1 (-ll:l1size)
 #define GLOBAL_MEM      4096   // (MB)	
 #define LOCAL_MEM       16384  // (KB)
-// Default Pthreads stack size
+// Default Pthreads stack size (-ll:stacksize)
 #define STACK_SIZE      2      // (MB) 
 
 #ifdef DEBUG_LOW_LEVEL
@@ -220,6 +225,9 @@ namespace LegionRuntime {
       void free_reservation(ReservationImpl *reservation);
       void free_metadata(IndexSpaceImpl *impl);
       void free_instance(RegionInstanceImpl *impl);
+    protected:
+      // Must be holding the free event lock
+      void add_event_chunk(void);
     public:
       // A nice helper method for debugging events
       void print_event_waiters(void);
@@ -232,7 +240,10 @@ namespace LegionRuntime {
       Processor::TaskIDTable task_table;
       std::map<ReductionOpID, const ReductionOpUntyped *> redop_table;
       std::set<Processor> procs;
-      std::vector<EventImpl*> events;
+      // Chunks of events, indexed by event ID / BASE_EVENTS, only ever
+      // appended to so that lookups don't need a lock
+      EventImpl **event_chunks[MAX_EVENT_CHUNKS];
+      volatile unsigned num_event_chunks;
       std::deque<EventImpl*> free_events; 
       std::vector<ReservationImpl*> reservations;
       std::deque<ReservationImpl*> free_reservations;
@@ -245,7 +256,6 @@ namespace LegionRuntime {
       std::deque<RegionInstanceImpl*> free_instances;
       MachineImpl *machine;
       pthread_t *background_pthread;
-      pthread_rwlock_t event_lock;
       pthread_mutex_t  free_event_lock;
       pthread_rwlock_t reservation_lock;
       pthread_mutex_t  free_reservation_lock;
@@ -501,6 +511,8 @@ namespace LegionRuntime {
 	  generation = 0;
           free_generation = 0;
 	  sources = 0;
+          redop = 0;
+          initial_value = 0;
           mutex = (pthread_mutex_t*)malloc(sizeof(pthread_mutex_t));
           wait_cond = (pthread_cond_t*)malloc(sizeof(pthread_cond_t));
 	  PTHREAD_SAFE_CALL(pthread_mutex_init(mutex,NULL));
@@ -547,6 +559,8 @@ namespace LegionRuntime {
 	void trigger(unsigned count = 1);
 	// Check to see if the event is active, if not activate it (return true), otherwise false
 	bool activate(void);	
+        // Mark a barrier as no longer in use so it can be handed out again
+        void deactivate(void);
 	// Register a dependent event, return true if event had not been triggered and was registered
         void add_waiter(EventGeneration needed_gen, EventWaiter *waiter);
 	// Return an event for this EventImplementation
@@ -572,7 +586,8 @@ namespace LegionRuntime {
 	unsigned sources;
         unsigned arrivals; // for use with barriers
 	const EventIndex index;
-	EventGeneration generation;
+        // Only changed while holding the mutex, but read without it
+	volatile EventGeneration generation;
         EventGeneration free_generation;
 	// The version of the event to hand out (i.e. with generation+1)
 	// so we can detect when the event has triggered with testing
@@ -779,6 +794,8 @@ namespace LegionRuntime {
           }
         public:
           ProcessorImpl *const proc;
+          // Free events only touched by this thread (see get_free_event)
+          std::vector<EventImpl*> free_events;
         protected:
           pthread_t thread;
           pthread_attr_t attr;
@@ -1034,6 +1051,7 @@ namespace Realm {
     {
       DetailedTimer::ScopedPush sp(TIME_LOW_LEVEL);
       EventImpl *impl = RuntimeImpl::get_runtime()->get_event_impl(*this);
+      impl->deactivate();
       RuntimeImpl::get_runtime()->free_event(impl);
     }
 
@@ -1086,11 +1104,8 @@ namespace LegionRuntime {
 
     bool EventImpl::has_triggered(EventGeneration needed_gen)
     {
-	bool result = false;
-	PTHREAD_SAFE_CALL(pthread_mutex_lock(mutex));
-	result = (needed_gen <= generation);
-	PTHREAD_SAFE_CALL(pthread_mutex_unlock(mutex));
-	return result;
+      // generations only move forward, so no need for the lock
+      return (needed_gen <= generation);
     }
 
     void EventImpl::wait(EventGeneration needed_gen)
@@ -1142,6 +1157,9 @@ namespace LegionRuntime {
 #endif
         // Increment the generation so that nobody can register a triggerable
         // with this event, but keep event in_use so no one can use the event
+        // The barrier makes everything done before the trigger visible to
+        // anyone who sees the new generation in has_triggered
+        __sync_synchronize();
         generation++;
 #ifdef DEBUG_LOW_LEVEL
         assert(generation == current.gen);
@@ -1162,7 +1180,7 @@ namespace LegionRuntime {
         // double check that happens_before_sets were correct
         {
           std::map<EventGeneration,std::deque<HappensBeforePair> >::iterator
-            finder = happens_before_sets.find(generation);
+            finder = happens_before_sets.find(EventGeneration(generation));
           if (finder != happens_before_sets.end()) {
             for(std::deque<HappensBeforePair>::iterator it = finder->second.begin();
                 it != finder->second.end();
@@ -1276,6 +1294,28 @@ namespace LegionRuntime {
 	return result;
     }
 
+    void EventImpl::deactivate(void)
+    {
+      // Barriers never finish their last generation, so they stay in
+      // use until they are destroyed
+      PTHREAD_SAFE_CALL(pthread_mutex_lock(mutex));
+#ifdef DEBUG_LOW_LEVEL
+      assert(in_use);
+#endif
+      in_use = false;
+      if (initial_value)
+      {
+        free(initial_value);
+        initial_value = 0;
+      }
+      redop = 0;
+      for (std::map<Event::gen_t, void *>::iterator it = final_values.begin();
+            it != final_values.end(); it++)
+        free(it->second);
+      final_values.clear();
+      PTHREAD_SAFE_CALL(pthread_mutex_unlock(mutex));
+    }
+
     void EventImpl::add_waiter(Event::gen_t gen_needed, EventWaiter *waiter)
     {
       bool trigger_now = false;
@@ -1297,9 +1337,9 @@ namespace LegionRuntime {
 #ifdef DEBUG_LOW_LEVEL
         assert(in_use);
 #endif
-	PTHREAD_SAFE_CALL(pthread_mutex_lock(mutex));
+        // the ID can't change while we're in use and the generation
+        // is a single word, so no need for the lock
 	Event result = current;
-	PTHREAD_SAFE_CALL(pthread_mutex_unlock(mutex));
 	return result;
     }
 
@@ -1308,11 +1348,10 @@ namespace LegionRuntime {
 #ifdef DEBUG_LOW_LEVEL
       assert(in_use);
 #endif
-      PTHREAD_SAFE_CALL(pthread_mutex_lock(mutex));
+      // see get_event for why the lock isn't needed
       UserEvent result; 
       result.id = current.id;
       result.gen = current.gen;
-      PTHREAD_SAFE_CALL(pthread_mutex_unlock(mutex));
       return result;
     }
 
@@ -1962,6 +2001,48 @@ namespace Realm {
       RuntimeImpl::get_runtime()->get_processor_impl(*this)->get_group_members(members);
     }
 
+    ////////////////////////////////////////////////////////
+    // AsyncIO 
+    ////////////////////////////////////////////////////////
+
+    // there are no async IO processors here - every request is performed
+    //  before returning
+    static Event perform_io(bool is_write, int fd, void *buffer, size_t bytes,
+                            off_t offset, ssize_t *result)
+    {
+      size_t done = 0;
+      ssize_t retval = 0;
+      while(done < bytes) {
+        ssize_t amt = (is_write ?
+                         pwrite(fd, ((const char *)buffer) + done, bytes - done, offset + done) :
+                         pread(fd, ((char *)buffer) + done, bytes - done, offset + done));
+        if(amt < 0) {
+          if(errno == EINTR) continue;
+          retval = -errno;
+          break;
+        }
+        if(amt == 0) break;
+        done += amt;
+      }
+      if(retval == 0)
+        retval = done;
+      if(result)
+        *result = retval;
+      return Event::NO_EVENT;
+    }
+
+    /*static*/ Event AsyncIO::read(int fd, void *buffer, size_t bytes, off_t offset,
+                                   ssize_t *result /*= 0*/)
+    {
+      return perform_io(false, fd, buffer, bytes, offset, result);
+    }
+
+    /*static*/ Event AsyncIO::write(int fd, const void *buffer, size_t bytes, off_t offset,
+                                    ssize_t *result /*= 0*/)
+    {
+      return perform_io(true, fd, const_cast<void *>(buffer), bytes, offset, result);
+    }
+
 };
 
 namespace LegionRuntime {
@@ -3657,6 +3738,16 @@ namespace Realm {
       impl->deactivate();
     }
 
+    /*static*/ void RegionInstance::destroy_instances(const std::vector<RegionInstance>& instances,
+						      Event wait_on /*= Event::NO_EVENT*/)
+    {
+      // no remote metadata to invalidate, so just destroy them one at a time
+      for(std::vector<RegionInstance>::const_iterator it = instances.begin();
+	  it != instances.end();
+	  it++)
+	it->destroy(wait_on);
+    }
+
 };
 
 namespace LegionRuntime {
@@ -4676,6 +4767,41 @@ namespace Realm {
 					   size_t block_size,
                                            const Realm::ProfilingRequestSet &reqs,
 					   ReductionOpID redop_id) const
+    {
+      return create_instance(memory, field_sizes, block_size, InstanceOrder(), reqs, redop_id);
+    }
+
+    // builds the linearization for a rectangular instance in the requested
+    //  order and returns the range of indices it uses
+    template <int DIM>
+    static Arrays::Rect<1> linearize_rect(const Arrays::Rect<DIM>& bounds,
+					  const InstanceOrder &order,
+					  DomainLinearization& dl)
+    {
+      Arrays::Mapping<DIM, 1> *mapping;
+      if(order.kind == InstanceOrder::LINEAR) {
+	Arrays::FortranArrayLinearization<DIM> cl(bounds, 0);
+	mapping = Arrays::Mapping<DIM, 1>::new_dynamic_mapping(cl);
+      } else {
+	Arrays::Point<DIM> tile_size = order.tile_size.get_point<DIM>();
+	if(order.kind == InstanceOrder::MORTON) {
+	  Arrays::MortonLinearization<DIM> ml(bounds, tile_size, 0);
+	  mapping = Arrays::Mapping<DIM, 1>::new_dynamic_mapping(ml);
+	} else {
+	  Arrays::TiledLinearization<DIM> tl(bounds, tile_size, false /*!morton*/, 0);
+	  mapping = Arrays::Mapping<DIM, 1>::new_dynamic_mapping(tl);
+	}
+      }
+      dl = DomainLinearization::from_mapping<DIM>(mapping);
+      return mapping->image_convex(bounds);
+    }
+
+    RegionInstance Domain::create_instance(Memory memory,
+					   const std::vector<size_t> &field_sizes,
+					   size_t block_size,
+					   const InstanceOrder &order,
+                                           const Realm::ProfilingRequestSet &reqs,
+					   ReductionOpID redop_id) const
     {
         if (!memory.exists())
         {
@@ -4687,33 +4813,18 @@ namespace Realm {
 	  // we have a rectangle - figure out its volume and create based on that
 	  DomainLinearization dl;
 	  Arrays::Rect<1> inst_extent;
+	  if(order.kind != InstanceOrder::LINEAR)
+	    assert(order.tile_size.get_dim() == get_dim());
 	  switch(get_dim()) {
-	  case 1:
-	    {
-	      Arrays::FortranArrayLinearization<1> cl(get_rect<1>(), 0);
-	      dl = DomainLinearization::from_mapping<1>(Arrays::Mapping<1, 1>::new_dynamic_mapping(cl));
-	      inst_extent = cl.image_convex(get_rect<1>());
-	      break;
-	    }
-
-	  case 2:
-	    {
-	      Arrays::FortranArrayLinearization<2> cl(get_rect<2>(), 0);
-	      dl = DomainLinearization::from_mapping<2>(Arrays::Mapping<2, 1>::new_dynamic_mapping(cl));
-	      inst_extent = cl.image_convex(get_rect<2>());
-	      break;
-	    }
-
-	  case 3:
-	    {
-	      Arrays::FortranArrayLinearization<3> cl(get_rect<3>(), 0);
-	      dl = DomainLinearization::from_mapping<3>(Arrays::Mapping<3, 1>::new_dynamic_mapping(cl));
-	      inst_extent = cl.image_convex(get_rect<3>());
-	      break;
-	    }
-
+	  case 1: inst_extent = linearize_rect<1>(get_rect<1>(), order, dl); break;
+	  case 2: inst_extent = linearize_rect<2>(get_rect<2>(), order, dl); break;
+	  case 3: inst_extent = linearize_rect<3>(get_rect<3>(), order, dl); break;
 	  default: assert(0);
 	  }
+	  // tiled orders pad out to whole tiles, so a block size that covered
+	  //  the domain (i.e. SOA) has to grow to cover the padding too
+	  if((order.kind != InstanceOrder::LINEAR) && (block_size >= get_volume()))
+	    block_size = int(inst_extent.hi) + 1;
 	  return IndexSpaceImpl::create_instance(memory, field_sizes, block_size, dl, 
                                                    int(inst_extent.hi) + 1, reqs, redop_id);
 	} else {
@@ -6622,13 +6733,8 @@ namespace LegionRuntime {
     RuntimeImpl::RuntimeImpl(MachineImpl *m)
       : machine(m), background_pthread(0)
     {
-	for (unsigned i=0; i<BASE_EVENTS; i++)
-        {
-            EventImpl *event = new EventImpl(i);
-            events.push_back(event);
-            if (i != 0) // Don't hand out the NO_EVENT event
-              free_events.push_back(event);
-        }
+        num_event_chunks = 0;
+        add_event_chunk();
 
 	for (unsigned i=0; i<BASE_RESERVATIONS; i++)
         {
@@ -6660,7 +6766,6 @@ namespace LegionRuntime {
                   free_instances.push_back(instances.back());
 	}
 
-	PTHREAD_SAFE_CALL(pthread_rwlock_init(&event_lock,NULL));
         PTHREAD_SAFE_CALL(pthread_mutex_init(&free_event_lock,NULL));
 	PTHREAD_SAFE_CALL(pthread_rwlock_init(&reservation_lock,NULL));
         PTHREAD_SAFE_CALL(pthread_mutex_init(&free_reservation_lock,NULL));
@@ -6706,10 +6811,21 @@ namespace LegionRuntime {
           INT_ARG("-ll:util", num_utility_cpus);
           INT_ARG("-ll:dma", num_dma_threads);
           INT_ARG("-ll:stack",cpu_stack_size);
+          INT_ARG("-ll:stacksize",cpu_stack_size);
 #undef INT_ARG
         }
         cpu_stack_size = cpu_stack_size * (1 << 20);
 
+        if ((num_cpus == 0) || 
+            ((num_cpus + num_utility_cpus) >= ProcessorGroup::FIRST_PROC_GROUP_ID))
+        {
+            fprintf(stderr,"The number of cpus (%d) must be at least 1 and "
+                    "there must be fewer than %d cpus and utility processors\n",
+                    num_cpus, (int)ProcessorGroup::FIRST_PROC_GROUP_ID);
+            fflush(stderr);
+            exit(1);
+        }
+
         if (num_utility_cpus > num_cpus)
         {
             fprintf(stderr,"The number of processor groups (%d) cannot be "
@@ -6954,7 +7070,10 @@ namespace LegionRuntime {
       dma_queue->start();
 
       if(task_id != 0) { // no need to check ONE_TASK_ONLY here, since 1 node
-	for(int id = 1; id <= NUM_PROCS; id++) {
+        // the cpus always come first, followed by any utility processors
+	for(unsigned id = 1; id < processors.size(); id++) {
+          if (processors[id]->get_proc_kind() != Processor::LOC_PROC)
+            break;
 	  Processor p;
           p.id = static_cast<id_t>(id);
 	  p.spawn(task_id,args,arglen);
@@ -7008,18 +7127,61 @@ namespace LegionRuntime {
     EventImpl* RuntimeImpl::get_event_impl(Event e)
     {
         EventImpl::EventIndex i = e.id;
-        PTHREAD_SAFE_CALL(pthread_rwlock_rdlock(&event_lock));
 #ifdef DEBUG_LOW_LEVEL
 	assert(i != 0);
-	assert(i < events.size());
+	assert((i / BASE_EVENTS) < num_event_chunks);
 #endif
-        EventImpl *result = events[i];
-        PTHREAD_SAFE_CALL(pthread_rwlock_unlock(&event_lock));
-	return result;
+        // Chunks are never moved or freed, and anyone holding an event
+        // got it after its chunk was published, so no lock is needed
+	return event_chunks[i / BASE_EVENTS][i % BASE_EVENTS];
+    }
+
+    void RuntimeImpl::add_event_chunk(void)
+    {
+      unsigned chunk_idx = num_event_chunks;
+      if (chunk_idx == MAX_EVENT_CHUNKS)
+      {
+        fprintf(stderr,"Exceeded the maximum of %d events in the shared "
+                "low-level runtime.  Increase MAX_EVENT_CHUNKS in "
+                "shared_lowlevel.cc\n", BASE_EVENTS * MAX_EVENT_CHUNKS);
+        fflush(stderr);
+        exit(1);
+      }
+      EventImpl **chunk = new EventImpl*[BASE_EVENTS];
+      for (unsigned idx = 0; idx < BASE_EVENTS; idx++)
+      {
+        EventImpl::EventIndex index = chunk_idx * BASE_EVENTS + idx;
+        chunk[idx] = new EventImpl(index);
+        if (index != 0) // Don't hand out the NO_EVENT event
+          free_events.push_back(chunk[idx]);
+      }
+      event_chunks[chunk_idx] = chunk;
+      // Make sure the chunk is visible before anyone can see its events
+      __sync_synchronize();
+      num_event_chunks = chunk_idx + 1;
     }
 
     void RuntimeImpl::free_event(EventImpl *e)
     {
+      // Processor threads keep their own cache of free events so they
+      // don't all fight over the free event lock
+      ProcessorImpl::ProcessorThread *thread = 
+        (ProcessorImpl::ProcessorThread*)pthread_getspecific(local_thread_key);
+      if (thread != NULL)
+      {
+        std::vector<EventImpl*> &cache = thread->free_events;
+        cache.push_back(e);
+        if (cache.size() <= EVENT_CACHE_SIZE)
+          return;
+        // Too many, give the oldest half back to everyone else
+        const size_t spill = EVENT_CACHE_SIZE/2;
+        PTHREAD_SAFE_CALL(pthread_mutex_lock(&free_event_lock));
+        free_events.insert(free_events.end(), cache.begin(), 
+                           cache.begin() + spill);
+        PTHREAD_SAFE_CALL(pthread_mutex_unlock(&free_event_lock));
+        cache.erase(cache.begin(), cache.begin() + spill);
+        return;
+      }
       // Put this event back on the list of free events
       PTHREAD_SAFE_CALL(pthread_mutex_lock(&free_event_lock));
       free_events.push_back(e);
@@ -7030,9 +7192,10 @@ namespace LegionRuntime {
     {
       // No need to hold the lock here since we'll only
       // ever call this method from the debugger
-      for (unsigned idx = 0; idx < events.size(); idx++)
+      for (unsigned chunk = 0; chunk < num_event_chunks; chunk++)
       {
-        events[idx]->print_waiters();
+        for (unsigned idx = 0; idx < BASE_EVENTS; idx++)
+          event_chunks[chunk][idx]->print_waiters();
       }
     }
 
@@ -7126,39 +7289,45 @@ namespace LegionRuntime {
 
     EventImpl* RuntimeImpl::get_free_event()
     {
-        PTHREAD_SAFE_CALL(pthread_mutex_lock(&free_event_lock));
-        if (!free_events.empty())
+        EventImpl *result = NULL;
+        ProcessorImpl::ProcessorThread *thread = 
+          (ProcessorImpl::ProcessorThread*)pthread_getspecific(local_thread_key);
+        if (thread != NULL)
         {
-          EventImpl *result = free_events.front();
+          // Processor threads refill their cache half at a time
+          std::vector<EventImpl*> &cache = thread->free_events;
+          if (cache.empty())
+          {
+            const size_t refill = EVENT_CACHE_SIZE/2;
+            PTHREAD_SAFE_CALL(pthread_mutex_lock(&free_event_lock));
+            if (free_events.size() < refill)
+              add_event_chunk();
+            cache.insert(cache.end(), free_events.begin(), 
+                         free_events.begin() + refill);
+            free_events.erase(free_events.begin(), 
+                              free_events.begin() + refill);
+            PTHREAD_SAFE_CALL(pthread_mutex_unlock(&free_event_lock));
+          }
+          result = cache.back();
+          cache.pop_back();
+        }
+        else
+        {
+          PTHREAD_SAFE_CALL(pthread_mutex_lock(&free_event_lock));
+          // If we're out, make a whole bunch more
+          if (free_events.empty())
+            add_event_chunk();
+          result = free_events.front();
           free_events.pop_front();
-          // Release the lock
           PTHREAD_SAFE_CALL(pthread_mutex_unlock(&free_event_lock));
-          // Activate this event
-          bool activated = result->activate();
+        }
+        // Activate this event
+        bool activated = result->activate();
 #ifdef DEBUG_LOW_LEVEL
-          assert(activated);
+        assert(activated);
 #else
-	  (void)activated; // eliminate compiler warning
+        (void)activated; // eliminate compiler warning
 #endif
-          return result;
-        }
-        // We weren't able to get a new event, get the writer lock
-        // for the vector of event implementations and add some more
-        PTHREAD_SAFE_CALL(pthread_rwlock_wrlock(&event_lock));
-        unsigned index = events.size();
-        EventImpl *result = new EventImpl(index,true);
-        events.push_back(result);
-        // Make a whole bunch of other events while we're here
-        for (unsigned idx=1; idx < BASE_EVENTS; idx++)
-        {
-          EventImpl *temp = new EventImpl(index+idx,false);
-          events.push_back(temp);
-          free_events.push_back(temp);
-        }
-        // Release the lock on events
-        PTHREAD_SAFE_CALL(pthread_rwlock_unlock(&event_lock));
-        // Release the lock on free events
-        PTHREAD_SAFE_CALL(pthread_mutex_unlock(&free_event_lock));
         return result;
     }
 
@@ -7556,6 +7725,63 @@ namespace LegionRuntime {
     template void *AccessorType::Generic::Untyped::raw_rect_ptr<2>(const Rect<2>& r, Rect<2>& subrect, ByteOffset *offset);
     template void *AccessorType::Generic::Untyped::raw_rect_ptr<3>(const Rect<3>& r, Rect<3>& subrect, ByteOffset *offset);
 
+    template <unsigned DIM>
+    void AccessorType::Generic::Untyped::read_untyped(const Point<DIM>& p, void *dst, size_t bytes, off_t offset) const
+    {
+      read_untyped(DomainPoint::from_point<DIM>(p), dst, bytes, offset);
+    }
+
+    template <unsigned DIM>
+    void AccessorType::Generic::Untyped::write_untyped(const Point<DIM>& p, const void *src, size_t bytes, off_t offset) const
+    {
+      write_untyped(DomainPoint::from_point<DIM>(p), src, bytes, offset);
+    }
+
+    template <int DIM>
+    bool AccessorType::Generic::Untyped::get_affine_parameters(const Rect<DIM>& bounds, void *&base, ByteOffset *strides) const
+    {
+      Rect<DIM> subrect;
+      return(get_affine_parameters<DIM>(bounds, subrect, base, strides) && (subrect == bounds));
+    }
+
+    template <int DIM>
+    bool AccessorType::Generic::Untyped::get_affine_parameters(const Rect<DIM>& bounds, Rect<DIM>& subrect,
+							       void *&base, ByteOffset *strides) const
+    {
+      RegionInstanceImpl *impl = (RegionInstanceImpl *) internal;
+
+      if(impl->get_linearization().get_dim() != DIM) return false;
+      // reduction lists aren't indexed by point at all
+      if(impl->is_reduction() && impl->is_list_reduction()) return false;
+      // hybrid SOA changes stride at every block boundary, which raw_rect_ptr
+      //  doesn't trim for
+      if((impl->get_block_size() > 1) &&
+	 (impl->get_block_size() != impl->get_num_elmts()))
+	return false;
+
+      char *ptr = (char *)(const_cast<Untyped *>(this)->raw_rect_ptr<DIM>(bounds, subrect, strides));
+      if(!ptr) return false;
+
+      // move the base to where point 0 would be so callers can use points as is
+      for(int i = 0; i < DIM; i++)
+	ptr -= bounds.lo.x[i] * strides[i].offset;
+      base = ptr;
+      return true;
+    }
+
+    template void AccessorType::Generic::Untyped::read_untyped<1>(const Point<1>& p, void *dst, size_t bytes, off_t offset) const;
+    template void AccessorType::Generic::Untyped::read_untyped<2>(const Point<2>& p, void *dst, size_t bytes, off_t offset) const;
+    template void AccessorType::Generic::Untyped::read_untyped<3>(const Point<3>& p, void *dst, size_t bytes, off_t offset) const;
+    template void AccessorType::Generic::Untyped::write_untyped<1>(const Point<1>& p, const void *src, size_t bytes, off_t offset) const;
+    template void AccessorType::Generic::Untyped::write_untyped<2>(const Point<2>& p, const void *src, size_t bytes, off_t offset) const;
+    template void AccessorType::Generic::Untyped::write_untyped<3>(const Point<3>& p, const void *src, size_t bytes, off_t offset) const;
+    template bool AccessorType::Generic::Untyped::get_affine_parameters<1>(const Rect<1>& bounds, void *&base, ByteOffset *strides) const;
+    template bool AccessorType::Generic::Untyped::get_affine_parameters<2>(const Rect<2>& bounds, void *&base, ByteOffset *strides) const;
+    template bool AccessorType::Generic::Untyped::get_affine_parameters<3>(const Rect<3>& bounds, void *&base, ByteOffset *strides) const;
+    template bool AccessorType::Generic::Untyped::get_affine_parameters<1>(const Rect<1>& bounds, Rect<1>& subrect, void *&base, ByteOffset *strides) const;
+    template bool AccessorType::Generic::Untyped::get_affine_parameters<2>(const Rect<2>& bounds, Rect<2>& subrect, void *&base, ByteOffset *strides) const;
+    template bool AccessorType::Generic::Untyped::get_affine_parameters<3>(const Rect<3>& bounds, Rect<3>& subrect, void *&base, ByteOffset *strides) const;
+
     //static const void *(AccessorType::Generic::Untyped::*dummy_ptr)(const Rect<3>&, Rect<3>&, ByteOffset*) = AccessorType::Generic::Untyped::raw_rect_ptr<3>;
 
     bool AccessorType::Generic::Untyped::get_aos_parameters(void *& base, size_t& stride) const
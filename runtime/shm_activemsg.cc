@@ -0,0 +1,983 @@
+/* Copyright 2015 Stanford University, NVIDIA Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// shared memory implementation of the active message interface - runs
+//  several Realm nodes as processes on one host without GASNet
+//
+// gasnet_init() maps one shared region and forks the other nodes, so the
+//  region (and everything else that existed before the fork) is at the same
+//  address in every process.  The region holds:
+//   - a header with per-node doorbells and the barrier state
+//   - a ring for each (sender, receiver) pair - each sender serializes its
+//       own writers with a local lock, and each receiver has one polling
+//       thread that drains all of its rings
+//   - each node's segment, used for the "gasnet" (global) memory and the
+//       registered memory - since every process can see every segment,
+//       gets and puts are just memcpy's, and long messages (the ones with a
+//       destination pointer) are written straight to their destination
+//
+// Messages are copied out of the rings by the polling thread and queued for
+//  the handler threads, so the polling thread never blocks on a full ring
+//  and a cycle of nodes all sending to each other can't deadlock.  Payloads
+//  that are too large for a single ring record are sent as a sequence of
+//  records that the polling thread reassembles.
+
+#include "activemsg.h"
+#include "realm/threads.h"
+#include "realm/timers.h"
+
+#include <cassert>
+#include <climits>
+#include <cstring>
+#include <deque>
+#include <vector>
+
+#include <errno.h>
+#include <sched.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/prctl.h>
+#include <sys/syscall.h>
+#endif
+
+/*extern*/ gasnet_node_t shm_my_node = 0;
+/*extern*/ gasnet_node_t shm_num_nodes = 1;
+
+static const size_t SHM_CACHE_LINE = 64;
+// every record starts on a cache line, which also guarantees that there's
+//  always room for a wrap marker at the end of the ring
+static const size_t SHM_RECORD_ALIGN = 64;
+static const size_t SHM_MAX_ARG_SIZE = 256;
+static const int SHM_MAX_MSGID = 256;
+
+enum {
+  SHM_MSGID_WRAP = -1,      // rest of the ring is unused - go back to the start
+  SHM_MSGID_CONTINUE = -2,  // more payload for the previous message
+};
+
+static size_t shm_round_up(size_t size, size_t align)
+{
+  return ((size + align - 1) / align) * align;
+}
+
+// per-node state in the shared region
+struct ShmNodeState {
+  volatile int doorbell;  // bumped by senders after adding a message
+  volatile int sleeping;  // set by the polling thread before waiting on the doorbell
+  volatile int exited;    // messages to exited nodes are dropped
+  pid_t pid;
+} __attribute__((aligned(64)));
+
+struct ShmHeader {
+  gasnet_node_t num_nodes;
+  size_t ring_size;
+  size_t segment_size;
+  volatile int barrier_count;
+  volatile int barrier_generation;
+};
+
+struct ShmRing {
+  volatile size_t head;  // total bytes written by the sender
+  char pad1[SHM_CACHE_LINE - sizeof(size_t)];
+  volatile size_t tail;  // total bytes consumed by the receiver
+  char pad2[SHM_CACHE_LINE - sizeof(size_t)];
+  // followed by the ring data
+};
+
+struct ShmMessageHeader {
+  int msgid;
+  unsigned arg_size;
+  size_t payload_size;   // total size of the payload
+  size_t chunk_size;     // payload bytes in this record
+  void *dstptr;          // if non-null, the payload has already been written here
+  long long send_time;   // for latency measurements
+  size_t record_size;
+};
+
+struct ShmMessageStats {
+  const char *name;
+  size_t sent_count, sent_bytes;
+  size_t recv_count, recv_bytes;
+  size_t handled_count;
+  long long latency_sum, latency_min, latency_max;  // send to start of handler
+  long long handler_sum;
+  long long first_recv, last_recv;
+};
+
+// configuration (parsed by gasnet_init)
+static size_t shm_ring_size = 1 << 20;
+static size_t shm_gasnet_mem_size = 256 << 20;
+static size_t shm_reg_mem_size = 0;
+static bool shm_stats_enabled = false;
+
+// the shared region
+static char *shm_base = 0;
+static size_t shm_total_size = 0;
+static ShmHeader *shm_header = 0;
+static ShmNodeState *shm_node_states = 0;
+static char *shm_rings_base = 0;
+static char *shm_segments_base = 0;
+
+// local state
+static GASNetHSL *shm_send_locks = 0;  // one per target
+static ShmMessageFactory shm_factories[SHM_MAX_MSGID];
+static ShmMessageStats shm_stats[SHM_MAX_MSGID];
+static std::vector<pid_t> shm_child_pids;  // only on node 0
+static int shm_barrier_generation = 0;
+
+static ShmRing *shm_ring(gasnet_node_t sender, gasnet_node_t receiver)
+{
+  size_t stride = sizeof(ShmRing) + shm_ring_size;
+  return (ShmRing *)(shm_rings_base + (sender * shm_num_nodes + receiver) * stride);
+}
+
+static char *shm_ring_data(ShmRing *ring)
+{
+  return ((char *)ring) + sizeof(ShmRing);
+}
+
+static bool shm_is_shared(const void *ptr)
+{
+  return ((ptr >= shm_base) && (ptr < (shm_base + shm_total_size)));
+}
+
+// the largest payload that goes in a single record
+static size_t shm_max_chunk(void)
+{
+  return shm_ring_size / 4;
+}
+
+static void shm_wait_doorbell(volatile int *doorbell, int oldval)
+{
+#ifdef __linux__
+  // the doorbell is in a shared mapping, so this can't be a private futex,
+  //  and the timeout lets node 0 check on the other processes
+  struct timespec ts;
+  ts.tv_sec = 0;
+  ts.tv_nsec = 10000000;
+  syscall(SYS_futex, (int *)doorbell, FUTEX_WAIT, oldval, &ts, 0, 0);
+#else
+  if(*doorbell == oldval)
+    usleep(100);
+#endif
+}
+
+static void shm_ring_doorbell(gasnet_node_t target)
+{
+  ShmNodeState& state = shm_node_states[target];
+  // this is a full barrier, so the poller either sees our message when it
+  //  rescans or we see that it's sleeping
+  __sync_fetch_and_add(&state.doorbell, 1);
+  if(state.sleeping) {
+#ifdef __linux__
+    syscall(SYS_futex, (int *)&state.doorbell, FUTEX_WAKE, INT_MAX, 0, 0, 0);
+#endif
+  }
+}
+
+static void shm_update_min(volatile long long *loc, long long val)
+{
+  while(true) {
+    long long old = *loc;
+    if((old != 0) && (old <= val)) return;
+    if(__sync_bool_compare_and_swap(loc, old, val)) return;
+  }
+}
+
+static void shm_update_max(volatile long long *loc, long long val)
+{
+  while(true) {
+    long long old = *loc;
+    if(old >= val) return;
+    if(__sync_bool_compare_and_swap(loc, old, val)) return;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+//
+// process startup/teardown
+//
+
+static void shm_parse_args(int argc, char **argv, gasnet_node_t& num_nodes)
+{
+  const char *e = getenv("REALM_SHM_NODES");
+  if(e)
+    num_nodes = atoi(e);
+
+  // like the GASNet conduits, we have to know how big the segments are
+  //  before the runtime gets to look at the command line
+  for(int i = 1; i < argc; i++) {
+    if(!strcmp(argv[i], "-ll:shm_nodes") && (i < (argc - 1))) {
+      num_nodes = atoi(argv[++i]);
+      continue;
+    }
+    if(!strcmp(argv[i], "-ll:shm_ring") && (i < (argc - 1))) {
+      shm_ring_size = ((size_t)atoi(argv[++i])) << 10; // convert KB to bytes
+      continue;
+    }
+    if(!strcmp(argv[i], "-ll:shm_stats") && (i < (argc - 1))) {
+      shm_stats_enabled = (atoi(argv[++i]) != 0);
+      continue;
+    }
+    if(!strcmp(argv[i], "-ll:gsize") && (i < (argc - 1))) {
+      shm_gasnet_mem_size = ((size_t)atoi(argv[++i])) << 20;
+      continue;
+    }
+    if(!strcmp(argv[i], "-ll:rsize") && (i < (argc - 1))) {
+      shm_reg_mem_size = ((size_t)atoi(argv[++i])) << 20;
+      continue;
+    }
+  }
+
+  if(num_nodes < 1) {
+    fprintf(stderr, "ERROR: shm transport needs at least one node\n");
+    exit(1);
+  }
+  shm_ring_size = shm_round_up(shm_ring_size, SHM_RECORD_ALIGN);
+  if(shm_ring_size < (16 * SHM_RECORD_ALIGN + 4 * SHM_MAX_ARG_SIZE)) {
+    fprintf(stderr, "ERROR: shm ring size of %zd bytes is too small\n", shm_ring_size);
+    exit(1);
+  }
+}
+
+void gasnet_init(int *argc, char ***argv)
+{
+  gasnet_node_t num_nodes = 1;
+  shm_parse_args(*argc, *argv, num_nodes);
+
+  size_t page_size = sysconf(_SC_PAGESIZE);
+  size_t header_size = shm_round_up(sizeof(ShmHeader), SHM_CACHE_LINE);
+  size_t states_size = shm_round_up(num_nodes * sizeof(ShmNodeState), page_size);
+  size_t rings_size = shm_round_up(num_nodes * num_nodes * (sizeof(ShmRing) + shm_ring_size),
+				   page_size);
+  size_t segment_size = shm_round_up(shm_gasnet_mem_size + shm_reg_mem_size, page_size);
+  shm_total_size = (shm_round_up(header_size, page_size) + states_size +
+		    rings_size + num_nodes * segment_size);
+
+  // pages are only allocated as they're touched, so large segments are ok
+  void *base = mmap(0, shm_total_size, PROT_READ | PROT_WRITE,
+		    MAP_SHARED | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if(base == MAP_FAILED) {
+    fprintf(stderr, "ERROR: could not map %zd bytes of shared memory: %s\n",
+	    shm_total_size, strerror(errno));
+    exit(1);
+  }
+  shm_base = (char *)base;
+  shm_header = (ShmHeader *)shm_base;
+  shm_node_states = (ShmNodeState *)(shm_base + shm_round_up(header_size, page_size));
+  shm_rings_base = ((char *)shm_node_states) + states_size;
+  shm_segments_base = shm_rings_base + rings_size;
+
+  // anonymous mappings start out zeroed, so the rings and node states are
+  //  already initialized
+  shm_header->num_nodes = num_nodes;
+  shm_header->ring_size = shm_ring_size;
+  shm_header->segment_size = segment_size;
+  shm_header->barrier_count = 0;
+  shm_header->barrier_generation = 0;
+  shm_node_states[0].pid = getpid();
+
+  shm_num_nodes = num_nodes;
+  shm_my_node = 0;
+
+  // anything buffered now would be printed by every process
+  fflush(stdout);
+  fflush(stderr);
+
+  pid_t parent = getpid();
+  for(gasnet_node_t i = 1; i < num_nodes; i++) {
+    pid_t pid = fork();
+    if(pid < 0) {
+      fprintf(stderr, "ERROR: fork failed for node %d: %s\n", i, strerror(errno));
+      for(size_t j = 0; j < shm_child_pids.size(); j++)
+	kill(shm_child_pids[j], SIGKILL);
+      exit(1);
+    }
+    if(pid == 0) {
+      shm_my_node = i;
+      shm_child_pids.clear();
+#ifdef __linux__
+      // don't outlive node 0
+      prctl(PR_SET_PDEATHSIG, SIGKILL);
+#endif
+      if(getppid() != parent)
+	_exit(1);
+      shm_node_states[i].pid = getpid();
+      break;
+    }
+    shm_child_pids.push_back(pid);
+  }
+}
+
+void gasnet_getSegmentInfo(gasnet_seginfo_t *seginfos, gasnet_node_t count)
+{
+  for(gasnet_node_t i = 0; (i < count) && (i < shm_num_nodes); i++) {
+    seginfos[i].addr = shm_segments_base + i * shm_header->segment_size;
+    seginfos[i].size = shm_header->segment_size;
+  }
+}
+
+void gasnet_barrier_notify(int, int)
+{
+  shm_barrier_generation = shm_header->barrier_generation;
+  if(__sync_add_and_fetch(&shm_header->barrier_count, 1) == (int)shm_num_nodes) {
+    shm_header->barrier_count = 0;
+    __sync_fetch_and_add(&shm_header->barrier_generation, 1);
+  }
+}
+
+void gasnet_barrier_wait(int, int)
+{
+  while(shm_header->barrier_generation == shm_barrier_generation)
+    sched_yield();
+}
+
+// node 0 collects the other processes - returns false if any of them
+//  failed (if 'wait' is false, only those that have already exited are
+//  checked)
+static bool shm_reap_children(bool wait)
+{
+  bool ok = true;
+  for(size_t i = 0; i < shm_child_pids.size(); i++) {
+    if(shm_child_pids[i] == 0) continue;
+    int status;
+    pid_t pid = waitpid(shm_child_pids[i], &status, (wait ? 0 : WNOHANG));
+    if(pid == 0) continue;  // still running
+    if(pid < 0) {
+      fprintf(stderr, "ERROR: shm node %zd (pid %d) lost: %s\n",
+	      i + 1, (int)shm_child_pids[i], strerror(errno));
+      ok = false;
+    } else if(WIFSIGNALED(status)) {
+      fprintf(stderr, "ERROR: shm node %zd (pid %d) killed by signal %d\n",
+	      i + 1, (int)shm_child_pids[i], WTERMSIG(status));
+      ok = false;
+    } else if(WEXITSTATUS(status) != 0) {
+      fprintf(stderr, "ERROR: shm node %zd (pid %d) exited with status %d\n",
+	      i + 1, (int)shm_child_pids[i], WEXITSTATUS(status));
+      ok = false;
+    }
+    shm_child_pids[i] = 0;
+  }
+  return ok;
+}
+
+static void shm_abort_all(void)
+{
+  for(size_t i = 0; i < shm_child_pids.size(); i++)
+    if(shm_child_pids[i] != 0)
+      kill(shm_child_pids[i], SIGKILL);
+  _exit(1);
+}
+
+static void shm_mark_exited(void)
+{
+  shm_node_states[shm_my_node].exited = 1;
+  __sync_synchronize();
+}
+
+void gasnet_exit(int code)
+{
+  shm_mark_exited();
+  if(shm_my_node == 0) {
+    if(code != 0)
+      shm_abort_all();
+    if(!shm_reap_children(true))
+      exit(1);
+  }
+  exit(code);
+}
+
+////////////////////////////////////////////////////////////////////////
+//
+// sending
+//
+
+// waits until the ring has room for 'needed' more bytes - returns false if
+//  the receiver has gone away
+static bool shm_wait_for_space(ShmRing *ring, gasnet_node_t target, size_t needed)
+{
+  int spins = 0;
+  while((ring->head + needed - ring->tail) > shm_ring_size) {
+    if(shm_node_states[target].exited)
+      return false;
+    // make sure the receiver is awake to drain the ring
+    if(((++spins) & 63) == 0)
+      shm_ring_doorbell(target);
+    sched_yield();
+  }
+  return true;
+}
+
+// writes one record - caller holds the send lock for the target
+static bool shm_write_record(ShmRing *ring, gasnet_node_t target,
+			     ShmMessageHeader& hdr, const void *args,
+			     const char *chunk)
+{
+  size_t args_padded = shm_round_up(hdr.arg_size, 8);
+  hdr.record_size = shm_round_up(sizeof(ShmMessageHeader) + args_padded + hdr.chunk_size,
+				 SHM_RECORD_ALIGN);
+  assert(hdr.record_size <= (shm_ring_size / 2));
+
+  char *data = shm_ring_data(ring);
+  size_t pos = ring->head % shm_ring_size;
+  if((pos + hdr.record_size) > shm_ring_size) {
+    // doesn't fit before the end - mark the rest of the ring as unused
+    size_t skip = shm_ring_size - pos;
+    if(!shm_wait_for_space(ring, target, skip + hdr.record_size))
+      return false;
+    ShmMessageHeader *wrap = (ShmMessageHeader *)(data + pos);
+    wrap->msgid = SHM_MSGID_WRAP;
+    wrap->record_size = skip;
+    __sync_synchronize();
+    ring->head += skip;
+    pos = 0;
+  } else {
+    if(!shm_wait_for_space(ring, target, hdr.record_size))
+      return false;
+  }
+
+  char *rec = data + pos;
+  memcpy(rec, &hdr, sizeof(ShmMessageHeader));
+  if(hdr.arg_size > 0)
+    memcpy(rec + sizeof(ShmMessageHeader), args, hdr.arg_size);
+  if(hdr.chunk_size > 0)
+    memcpy(rec + sizeof(ShmMessageHeader) + args_padded, chunk, hdr.chunk_size);
+
+  // contents must be visible before the receiver sees the new head
+  __sync_synchronize();
+  ring->head += hdr.record_size;
+  return true;
+}
+
+static void shm_send(gasnet_node_t target, int msgid,
+		     const void *args, size_t arg_size,
+		     const void *payload, size_t payload_size, void *dstptr)
+{
+  assert(target != gasnet_mynode());
+  assert(target < shm_num_nodes);
+  assert((msgid >= 0) && (msgid < SHM_MAX_MSGID));
+  assert(arg_size <= SHM_MAX_ARG_SIZE);
+
+  // messages to a node that has shut down can't matter to anybody
+  if(shm_node_states[target].exited)
+    return;
+
+  // long messages go straight to their destination, which every process
+  //  can see
+  if(dstptr && (payload_size > 0)) {
+    assert(shm_is_shared(dstptr));
+    memcpy(dstptr, payload, payload_size);
+  }
+  size_t ring_bytes = (dstptr ? 0 : payload_size);
+
+  ShmMessageHeader hdr;
+  hdr.msgid = msgid;
+  hdr.arg_size = arg_size;
+  hdr.payload_size = payload_size;
+  hdr.chunk_size = std::min(ring_bytes, shm_max_chunk());
+  hdr.dstptr = dstptr;
+  hdr.send_time = (shm_stats_enabled ?
+		     Realm::Clock::current_time_in_nanoseconds(true/*absolute*/) :
+		     0);
+
+  ShmRing *ring = shm_ring(gasnet_mynode(), target);
+  {
+    // one writer at a time for each ring - the records of a large message
+    //  have to be contiguous
+    AutoHSLLock al(shm_send_locks[target]);
+
+    const char *pos = (const char *)payload;
+    bool ok = shm_write_record(ring, target, hdr, args, pos);
+    size_t sent = hdr.chunk_size;
+    while(ok && (sent < ring_bytes)) {
+      ShmMessageHeader cont;
+      cont.msgid = SHM_MSGID_CONTINUE;
+      cont.arg_size = 0;
+      cont.payload_size = payload_size;
+      cont.chunk_size = std::min(ring_bytes - sent, shm_max_chunk());
+      cont.dstptr = 0;
+      cont.send_time = hdr.send_time;
+      ok = shm_write_record(ring, target, cont, 0, pos + sent);
+      sent += cont.chunk_size;
+      // let the receiver start on the pieces we've already written
+      shm_ring_doorbell(target);
+    }
+  }
+  shm_ring_doorbell(target);
+
+  if(shm_stats_enabled) {
+    __sync_fetch_and_add(&shm_stats[msgid].sent_count, 1);
+    __sync_fetch_and_add(&shm_stats[msgid].sent_bytes, arg_size + payload_size);
+  }
+}
+
+static void shm_release_sent_payload(const void *payload, int payload_mode)
+{
+  // payloads are always copied before we return, so the only thing left to
+  //  do is honor a request to free it
+  if(payload_mode == PAYLOAD_FREE)
+    free((void *)payload);
+}
+
+void enqueue_message(gasnet_node_t target, int msgid,
+		     const void *args, size_t arg_size,
+		     const void *payload, size_t payload_size,
+		     int payload_mode, void *dstptr)
+{
+  if(payload_mode == PAYLOAD_NONE)
+    payload_size = 0;
+  shm_send(target, msgid, args, arg_size, payload, payload_size, dstptr);
+  if(payload_mode != PAYLOAD_NONE)
+    shm_release_sent_payload(payload, payload_mode);
+}
+
+void enqueue_message(gasnet_node_t target, int msgid,
+		     const void *args, size_t arg_size,
+		     const void *payload, size_t line_size,
+		     off_t line_stride, size_t line_count,
+		     int payload_mode, void *dstptr)
+{
+  // gather the lines - the receiver sees a contiguous payload either way
+  size_t payload_size = line_size * line_count;
+  char *buffer = (char *)malloc(payload_size);
+  assert((buffer != 0) || (payload_size == 0));
+  for(size_t i = 0; i < line_count; i++)
+    memcpy(buffer + i * line_size, ((const char *)payload) + i * line_stride, line_size);
+  shm_send(target, msgid, args, arg_size, buffer, payload_size, dstptr);
+  free(buffer);
+  shm_release_sent_payload(payload, payload_mode);
+}
+
+void enqueue_message(gasnet_node_t target, int msgid,
+		     const void *args, size_t arg_size,
+		     const SpanList& spans, size_t payload_size,
+		     int payload_mode, void *dstptr)
+{
+  char *buffer = (char *)malloc(payload_size);
+  assert((buffer != 0) || (payload_size == 0));
+  size_t offset = 0;
+  for(SpanList::const_iterator it = spans.begin(); it != spans.end(); it++) {
+    memcpy(buffer + offset, it->first, it->second);
+    offset += it->second;
+  }
+  assert(offset == payload_size);
+  shm_send(target, msgid, args, arg_size, buffer, payload_size, dstptr);
+  free(buffer);
+  if(payload_mode == PAYLOAD_FREE)
+    for(SpanList::const_iterator it = spans.begin(); it != spans.end(); it++)
+      free((void *)(it->first));
+}
+
+size_t get_lmb_size(int target_node)
+{
+  return shm_max_chunk();
+}
+
+void shm_release_payload(void *payload)
+{
+  if(payload && !shm_is_shared(payload))
+    free(payload);
+}
+
+////////////////////////////////////////////////////////////////////////
+//
+// class ShmMessageManager
+//
+
+// one polling thread copies messages out of this node's rings, and the
+//  handler threads run them in the order they arrived
+class ShmMessageManager {
+public:
+  ShmMessageManager(Realm::CoreReservationSet& crs);
+  ~ShmMessageManager(void);
+
+  void start_polling_thread(void);
+  void start_handler_threads(int count, size_t stack_size);
+  void shutdown(void);
+
+protected:
+  struct QueuedMessage {
+    IncomingMessage *msg;
+    int msgid;
+    long long send_time;
+  };
+
+  // a message whose payload is still arriving
+  struct PendingMessage {
+    bool active;
+    int msgid;
+    char args[SHM_MAX_ARG_SIZE];
+    size_t arg_size;
+    char *payload;
+    size_t payload_size, received;
+    long long send_time;
+  };
+
+  bool poll_ring(gasnet_node_t sender);
+  void deliver(gasnet_node_t sender, int msgid, const void *args, size_t arg_size,
+	       void *payload, size_t payload_size, long long send_time);
+
+  void polling_thread_loop(void);
+  void handler_thread_loop(void);
+
+  std::vector<PendingMessage> pending;
+  GASNetHSL mutex;
+  GASNetCondVar condvar;
+  std::deque<QueuedMessage> queue;
+  volatile bool shutdown_flag;
+  Realm::CoreReservation *poll_rsrv, *handler_rsrv;
+  Realm::Thread *polling_thread;
+  std::vector<Realm::Thread *> handler_threads;
+};
+
+static ShmMessageManager *shm_manager = 0;
+
+ShmMessageManager::ShmMessageManager(Realm::CoreReservationSet& crs)
+  : pending(shm_num_nodes), condvar(mutex), shutdown_flag(false),
+    polling_thread(0)
+{
+  for(gasnet_node_t i = 0; i < shm_num_nodes; i++)
+    pending[i].active = false;
+
+  poll_rsrv = new Realm::CoreReservation("shm AM polling", crs,
+					 Realm::CoreReservationParameters());
+  handler_rsrv = new Realm::CoreReservation("AM handlers", crs,
+					    Realm::CoreReservationParameters());
+}
+
+ShmMessageManager::~ShmMessageManager(void)
+{
+  delete poll_rsrv;
+  delete handler_rsrv;
+}
+
+void ShmMessageManager::start_polling_thread(void)
+{
+  polling_thread = Realm::Thread::create_kernel_thread<ShmMessageManager,
+						       &ShmMessageManager::polling_thread_loop>(this,
+												Realm::ThreadLaunchParameters(),
+												*poll_rsrv);
+}
+
+void ShmMessageManager::start_handler_threads(int count, size_t stack_size)
+{
+  Realm::ThreadLaunchParameters tlp;
+  tlp.set_stack_size(stack_size);
+
+  handler_threads.resize(count);
+  for(int i = 0; i < count; i++)
+    handler_threads[i] = Realm::Thread::create_kernel_thread<ShmMessageManager,
+							     &ShmMessageManager::handler_thread_loop>(this,
+												      tlp,
+												      *handler_rsrv);
+}
+
+void ShmMessageManager::shutdown(void)
+{
+  {
+    AutoHSLLock al(mutex);
+    shutdown_flag = true;
+    condvar.broadcast();
+  }
+  // wake up the polling thread if it's asleep
+  shm_ring_doorbell(gasnet_mynode());
+
+  if(polling_thread) {
+    polling_thread->join();
+    delete polling_thread;
+    polling_thread = 0;
+  }
+  for(std::vector<Realm::Thread *>::iterator it = handler_threads.begin();
+      it != handler_threads.end();
+      it++) {
+    (*it)->join();
+    delete (*it);
+  }
+  handler_threads.clear();
+
+  // anything still queued will never be handled
+  while(!queue.empty()) {
+    delete queue.front().msg;
+    queue.pop_front();
+  }
+}
+
+void ShmMessageManager::deliver(gasnet_node_t sender, int msgid,
+				const void *args, size_t arg_size,
+				void *payload, size_t payload_size, long long send_time)
+{
+  ShmMessageFactory factory = shm_factories[msgid];
+  if(!factory) {
+    fprintf(stderr, "ERROR: node %d received message %d from node %d, which has no handler\n",
+	    gasnet_mynode(), msgid, sender);
+    shm_abort_all();
+  }
+
+  if(shm_stats_enabled) {
+    ShmMessageStats& stats = shm_stats[msgid];
+    long long now = Realm::Clock::current_time_in_nanoseconds(true/*absolute*/);
+    stats.recv_count++;
+    stats.recv_bytes += arg_size + payload_size;
+    if(!stats.first_recv) stats.first_recv = now;
+    stats.last_recv = now;
+  }
+
+  QueuedMessage qm;
+  qm.msg = (*factory)(sender, args, arg_size, payload, payload_size);
+  qm.msgid = msgid;
+  qm.send_time = send_time;
+
+  AutoHSLLock al(mutex);
+  queue.push_back(qm);
+  condvar.signal();
+}
+
+// copies out the messages currently in the ring from 'sender' - returns
+//  true if there were any
+bool ShmMessageManager::poll_ring(gasnet_node_t sender)
+{
+  ShmRing *ring = shm_ring(sender, gasnet_mynode());
+  size_t head = ring->head;
+  size_t tail = ring->tail;
+  if(head == tail)
+    return false;
+
+  // make sure we see the contents of everything up to 'head'
+  __sync_synchronize();
+
+  char *data = shm_ring_data(ring);
+  PendingMessage& pm = pending[sender];
+  while(tail != head) {
+    const ShmMessageHeader *hdr = (const ShmMessageHeader *)(data + (tail % shm_ring_size));
+    if(hdr->msgid == SHM_MSGID_WRAP) {
+      tail += hdr->record_size;
+      continue;
+    }
+
+    const char *args = ((const char *)hdr) + sizeof(ShmMessageHeader);
+    const char *chunk = args + shm_round_up(hdr->arg_size, 8);
+
+    if(hdr->msgid == SHM_MSGID_CONTINUE) {
+      assert(pm.active && (pm.received + hdr->chunk_size <= pm.payload_size));
+      memcpy(pm.payload + pm.received, chunk, hdr->chunk_size);
+      pm.received += hdr->chunk_size;
+    } else {
+      assert(!pm.active);
+      pm.msgid = hdr->msgid;
+      pm.arg_size = hdr->arg_size;
+      memcpy(pm.args, args, hdr->arg_size);
+      pm.payload_size = hdr->payload_size;
+      pm.send_time = hdr->send_time;
+      if(hdr->dstptr) {
+	// already in place
+	pm.payload = (char *)(hdr->dstptr);
+	pm.received = pm.payload_size;
+      } else {
+	pm.payload = (pm.payload_size > 0) ? (char *)malloc(pm.payload_size) : 0;
+	memcpy(pm.payload, chunk, hdr->chunk_size);
+	pm.received = hdr->chunk_size;
+      }
+      pm.active = true;
+    }
+    tail += hdr->record_size;
+
+    if(pm.received == pm.payload_size) {
+      pm.active = false;
+      deliver(sender, pm.msgid, pm.args, pm.arg_size,
+	      pm.payload, pm.payload_size, pm.send_time);
+    }
+  }
+
+  // we've copied everything out, so the sender can reuse the space
+  __sync_synchronize();
+  ring->tail = tail;
+  return true;
+}
+
+void ShmMessageManager::polling_thread_loop(void)
+{
+  ShmNodeState& me = shm_node_states[gasnet_mynode()];
+  int idle = 0;
+  while(!shutdown_flag) {
+    bool found = false;
+    for(gasnet_node_t i = 0; i < shm_num_nodes; i++)
+      if((i != gasnet_mynode()) && poll_ring(i))
+	found = true;
+    if(found) {
+      idle = 0;
+      continue;
+    }
+
+    // spin for a little while before going to sleep
+    if(++idle < 100) {
+      sched_yield();
+      continue;
+    }
+
+    me.sleeping = 1;
+    __sync_synchronize();
+    int doorbell = me.doorbell;
+    // check again in case a sender missed the sleeping flag
+    for(gasnet_node_t i = 0; i < shm_num_nodes; i++)
+      if((i != gasnet_mynode()) && poll_ring(i))
+	found = true;
+    if(!found && !shutdown_flag)
+      shm_wait_doorbell(&me.doorbell, doorbell);
+    me.sleeping = 0;
+
+    // node 0 keeps an eye on the other processes - if one dies, everybody
+    //  else would just hang
+    if((gasnet_mynode() == 0) && !shm_reap_children(false))
+      shm_abort_all();
+  }
+}
+
+void ShmMessageManager::handler_thread_loop(void)
+{
+  while(true) {
+    QueuedMessage qm;
+    {
+      AutoHSLLock al(mutex);
+      while(queue.empty() && !shutdown_flag)
+	condvar.wait();
+      if(queue.empty())
+	break;
+      qm = queue.front();
+      queue.pop_front();
+    }
+
+    long long start = 0;
+    if(shm_stats_enabled)
+      start = Realm::Clock::current_time_in_nanoseconds(true/*absolute*/);
+
+    qm.msg->run_handler();
+    delete qm.msg;
+
+    if(shm_stats_enabled) {
+      ShmMessageStats& stats = shm_stats[qm.msgid];
+      long long end = Realm::Clock::current_time_in_nanoseconds(true/*absolute*/);
+      long long latency = start - qm.send_time;
+      __sync_fetch_and_add(&stats.handled_count, 1);
+      __sync_fetch_and_add(&stats.latency_sum, latency);
+      __sync_fetch_and_add(&stats.handler_sum, end - start);
+      shm_update_min(&stats.latency_min, latency);
+      shm_update_max(&stats.latency_max, latency);
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+//
+// runtime interface
+//
+
+void init_endpoints(gasnet_handlerentry_t *handlers, int hcount,
+		    int gasnet_mem_size_in_mb,
+		    int registered_mem_size_in_mb,
+		    Realm::CoreReservationSet& crs,
+		    int argc, const char *argv[])
+{
+  size_t needed = ((((size_t)gasnet_mem_size_in_mb) << 20) +
+		   (((size_t)registered_mem_size_in_mb) << 20));
+  if(needed > shm_header->segment_size) {
+    fprintf(stderr, "ERROR: node %d needs a %zd MB segment, but only %zd MB were mapped\n",
+	    gasnet_mynode(), needed >> 20, shm_header->segment_size >> 20);
+    exit(1);
+  }
+
+  if(gasnet_mynode() == 0)
+    printf("Shared Memory Usage: nodes=%d, GASNET=%d, RMEM=%d, rings=%zd KB each, total=%zd MB\n",
+	   gasnet_nodes(), gasnet_mem_size_in_mb, registered_mem_size_in_mb,
+	   shm_ring_size >> 10, shm_total_size >> 20);
+
+  for(int i = 0; i < hcount; i++) {
+    assert((handlers[i].index >= 0) && (handlers[i].index < SHM_MAX_MSGID));
+    assert(shm_factories[handlers[i].index] == 0);
+    shm_factories[handlers[i].index] = (ShmMessageFactory)(handlers[i].fnptr);
+    shm_stats[handlers[i].index].name = handlers[i].description;
+  }
+
+  shm_send_locks = new GASNetHSL[gasnet_nodes()];
+  shm_manager = new ShmMessageManager(crs);
+
+  // as with GASNet, synchronize everybody's clocks as well as we can
+  gasnet_barrier_notify(0, GASNET_BARRIERFLAG_ANONYMOUS);
+  gasnet_barrier_wait(0, GASNET_BARRIERFLAG_ANONYMOUS);
+  Realm::Clock::set_zero_time();
+  gasnet_barrier_notify(0, GASNET_BARRIERFLAG_ANONYMOUS);
+  gasnet_barrier_wait(0, GASNET_BARRIERFLAG_ANONYMOUS);
+}
+
+void start_polling_threads(int count)
+{
+  // one thread drains all of this node's rings
+  if(count > 0)
+    shm_manager->start_polling_thread();
+}
+
+void start_handler_threads(int count, Realm::CoreReservationSet& crs, size_t stack_size)
+{
+  shm_manager->start_handler_threads(count, stack_size);
+}
+
+void do_some_polling(void)
+{
+  sched_yield();
+}
+
+void report_activemsg_status(FILE *f)
+{
+  for(int i = 0; i < SHM_MAX_MSGID; i++) {
+    const ShmMessageStats& stats = shm_stats[i];
+    if(!stats.sent_count && !stats.recv_count) continue;
+
+    double avg_latency = (stats.handled_count ?
+			    (double)stats.latency_sum / stats.handled_count : 0);
+    double avg_handler = (stats.handled_count ?
+			    (double)stats.handler_sum / stats.handled_count : 0);
+    long long recv_time = stats.last_recv - stats.first_recv;
+    double bandwidth = ((recv_time > 0) ?
+			  (1e3 * stats.recv_bytes / recv_time) : 0);  // MB/s
+    fprintf(f, "shm AM: node %d, msg %3d %-36s sent=%8zd (%10zd B) recv=%8zd (%10zd B) "
+	    "latency avg=%9.1f min=%8lld max=%9lld ns handler avg=%9.1f ns bw=%8.1f MB/s\n",
+	    gasnet_mynode(), i, (stats.name ? stats.name : "?"),
+	    stats.sent_count, stats.sent_bytes, stats.recv_count, stats.recv_bytes,
+	    avg_latency, stats.latency_min, stats.latency_max, avg_handler, bandwidth);
+  }
+  fflush(f);
+}
+
+void stop_activemsg_threads(void)
+{
+  // stop accepting messages first, so that nobody blocks sending to us
+  shm_mark_exited();
+
+  shm_manager->shutdown();
+  delete shm_manager;
+  shm_manager = 0;
+
+  if(shm_stats_enabled)
+    report_activemsg_status(stdout);
+
+  // node 0 doesn't exit until everybody else has, so that whatever started
+  //  it sees the right exit code
+  if((gasnet_mynode() == 0) && !shm_reap_children(true))
+    exit(1);
+}
@@ -0,0 +1,277 @@
+/* Copyright 2015 Stanford University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <cstdio>
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <list>
+#include <vector>
+#include "legion.h"
+#include "legion_utilities.h"
+#include "field_tree.h"
+using namespace LegionRuntime::HighLevel;
+
+/*
+ * Microbenchmark for the field tree used to find field
+ * interference between users of a region.  A stream of
+ * operations is replayed: each one analyzes the existing
+ * users that share any of its fields, counting those that
+ * it depends on (at least one of the pair writes) and
+ * pruning those whose fields it overwrites completely,
+ * and is then inserted as a user itself.  The same stream
+ * is replayed against a plain list of users to check the
+ * answers and give a baseline.
+ *
+ * Workloads can be read from a file with one operation
+ * per line, a privilege and a list of fields or ranges:
+ *
+ *   w 0-15
+ *   r 3,7,9-11
+ *
+ * Without a file a synthetic workload is generated with a
+ * mix of single field, small group, and whole region
+ * accesses.
+ */
+
+struct BenchUser {
+public:
+  BenchUser(void) : id(0), write(false) { }
+  BenchUser(unsigned i, bool w, const FieldMask &m)
+    : field_mask(m), id(i), write(w) { }
+public:
+  FieldMask field_mask;
+  unsigned id;
+  bool write;
+};
+
+struct BenchOp {
+  FieldMask mask;
+  bool write;
+};
+
+class BenchAnalyzer {
+public:
+  BenchAnalyzer(const BenchOp &o)
+    : op(o), dependences(0), checksum(0), pruned(0) { }
+public:
+  inline void begin_node(FieldTree<BenchUser> *node) { }
+  inline void end_node(FieldTree<BenchUser> *node) { }
+  inline bool analyze(BenchUser &user)
+  {
+    if (op.write || user.write)
+    {
+      dependences++;
+      checksum += user.id;
+    }
+    // A write to all of the user's fields means no later
+    // operation needs to see it
+    if (op.write && !(user.field_mask - op.mask))
+    {
+      pruned++;
+      return false;
+    }
+    return true;
+  }
+public:
+  const BenchOp &op;
+  unsigned long long dependences, checksum, pruned;
+};
+
+static bool parse_op(const char *line, BenchOp &op)
+{
+  if ((line[0] != 'r') && (line[0] != 'w'))
+    return false;
+  op.write = (line[0] == 'w');
+  op.mask = FieldMask();
+  const char *s = line + 1;
+  while (*s)
+  {
+    char *end;
+    long lo = strtol(s, &end, 10);
+    if (end == s)
+    {
+      s++;
+      continue;
+    }
+    long hi = lo;
+    s = end;
+    if (*s == '-')
+    {
+      hi = strtol(s + 1, &end, 10);
+      s = end;
+    }
+    for (long f = lo; (f <= hi) && (f < MAX_FIELDS); f++)
+      op.mask.set_bit(f);
+  }
+  return !!op.mask;
+}
+
+static void generate_ops(LegionVector<BenchOp>::aligned &ops, int num_ops,
+                         int num_fields, unsigned seed)
+{
+  srand48(seed);
+  for (int i = 0; i < num_ops; i++)
+  {
+    BenchOp op;
+    op.write = (drand48() < 0.3);
+    double kind = drand48();
+    int lo, hi;
+    if (kind < 0.5)
+    {
+      // single field
+      lo = hi = lrand48() % num_fields;
+    }
+    else if (kind < 0.9)
+    {
+      // small group of neighbouring fields, e.g. one struct
+      int size = 2 + lrand48() % 7;
+      lo = lrand48() % num_fields;
+      hi = std::min(lo + size - 1, num_fields - 1);
+    }
+    else
+    {
+      // whole region, e.g. a copy or a fill
+      lo = 0;
+      hi = num_fields - 1;
+    }
+    for (int f = lo; f <= hi; f++)
+      op.mask.set_bit(f);
+    ops.push_back(op);
+  }
+}
+
+struct BenchResult {
+  double seconds;
+  unsigned long long dependences, checksum, pruned;
+};
+
+static BenchResult replay_tree(const LegionVector<BenchOp>::aligned &ops,
+                               const FieldMask &all_fields)
+{
+  BenchResult result;
+  result.dependences = result.checksum = result.pruned = 0;
+  FieldTree<BenchUser> *tree = 
+    legion_new<FieldTree<BenchUser> >(all_fields);
+  double t_start = Realm::Clock::current_time();
+  for (unsigned i = 0; i < ops.size(); i++)
+  {
+    BenchAnalyzer analyzer(ops[i]);
+    tree->analyze(ops[i].mask, analyzer);
+    result.dependences += analyzer.dependences;
+    result.checksum += analyzer.checksum;
+    result.pruned += analyzer.pruned;
+    tree->insert(BenchUser(i, ops[i].write, ops[i].mask));
+  }
+  result.seconds = Realm::Clock::current_time() - t_start;
+  legion_delete(tree);
+  return result;
+}
+
+static BenchResult replay_list(const LegionVector<BenchOp>::aligned &ops)
+{
+  BenchResult result;
+  result.dependences = result.checksum = result.pruned = 0;
+  LegionList<BenchUser>::aligned users;
+  double t_start = Realm::Clock::current_time();
+  for (unsigned i = 0; i < ops.size(); i++)
+  {
+    BenchAnalyzer analyzer(ops[i]);
+    for (LegionList<BenchUser>::aligned::iterator it = users.begin();
+          it != users.end(); /*nothing*/)
+    {
+      if ((it->field_mask * ops[i].mask) || analyzer.analyze(*it))
+        it++;
+      else
+        it = users.erase(it);
+    }
+    result.dependences += analyzer.dependences;
+    result.checksum += analyzer.checksum;
+    result.pruned += analyzer.pruned;
+    users.push_back(BenchUser(i, ops[i].write, ops[i].mask));
+  }
+  result.seconds = Realm::Clock::current_time() - t_start;
+  return result;
+}
+
+int main(int argc, char **argv)
+{
+  int num_ops = 100000;
+  int num_fields = (MAX_FIELDS < 256) ? MAX_FIELDS : 256;
+  unsigned seed = 12345;
+  const char *workload = NULL;
+  for (int i = 1; i < argc; i++)
+  {
+    if (!strcmp(argv[i],"-n"))
+      num_ops = atoi(argv[++i]);
+    if (!strcmp(argv[i],"-f"))
+      num_fields = atoi(argv[++i]);
+    if (!strcmp(argv[i],"-seed"))
+      seed = atoi(argv[++i]);
+    if (!strcmp(argv[i],"-w"))
+      workload = argv[++i];
+  }
+  assert((num_fields > 0) && (num_fields <= MAX_FIELDS));
+
+  LegionVector<BenchOp>::aligned ops;
+  if (workload != NULL)
+  {
+    FILE *f = fopen(workload, "r");
+    if (f == NULL)
+    {
+      printf("ERROR: unable to open workload file %s\n", workload);
+      exit(1);
+    }
+    char line[4096];
+    while (fgets(line, sizeof(line), f) != NULL)
+    {
+      BenchOp op;
+      if (parse_op(line, op))
+        ops.push_back(op);
+    }
+    fclose(f);
+    printf("Field tree benchmark - %zd operations from %s\n",
+           ops.size(), workload);
+  }
+  else
+  {
+    generate_ops(ops, num_ops, num_fields, seed);
+    printf("Field tree benchmark - %d synthetic operations on %d fields\n",
+           num_ops, num_fields);
+  }
+
+  FieldMask all_fields;
+  for (unsigned i = 0; i < ops.size(); i++)
+    all_fields |= ops[i].mask;
+
+  BenchResult tree = replay_tree(ops, all_fields);
+  BenchResult list = replay_list(ops);
+  printf("field tree: elapsed=%8.3fms time/op=%6.0fns dependences=%llu "
+         "pruned=%llu\n", tree.seconds * 1e3, 1e9 * tree.seconds / ops.size(),
+         tree.dependences, tree.pruned);
+  printf("user list:  elapsed=%8.3fms time/op=%6.0fns dependences=%llu "
+         "pruned=%llu\n", list.seconds * 1e3, 1e9 * list.seconds / ops.size(),
+         list.dependences, list.pruned);
+
+  if ((tree.dependences != list.dependences) ||
+      (tree.checksum != list.checksum) || (tree.pruned != list.pruned))
+  {
+    printf("ERROR: field tree and user list disagree\n");
+    exit(1);
+  }
+  printf("all done!\n");
+  return 0;
+}
@@ -0,0 +1,226 @@
+/* Copyright 2015 Stanford University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <cstdio>
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include "legion.h"
+#include "runtime.h"
+#include "garbage_collection.h"
+using namespace LegionRuntime::HighLevel;
+using namespace LegionRuntime::Arrays;
+
+/*
+ * Microbenchmark for reference counting on distributed
+ * collectables.  A number of tasks that are guaranteed to
+ * run concurrently (using a must epoch launch) repeatedly
+ * add and remove gc references on the same collectable.
+ * In the "held" pattern the top-level task holds a gc
+ * reference for the duration so every update can take
+ * the atomic fast path.  In the "transition" pattern
+ * nothing else holds a reference, so updates keep moving
+ * the count between zero and non-zero which requires the
+ * gc lock and a run of the state machine.
+ *
+ * Build with CC_FLAGS=-DLEGION_GC_STATS to also have the
+ * runtime report how many updates took each path.
+ */
+
+enum TaskIDs {
+  TOP_LEVEL_TASK_ID,
+  REF_LOOP_TASK_ID,
+};
+
+enum RefPattern {
+  PATTERN_HELD,
+  PATTERN_TRANSITION,
+};
+
+static const char *pattern_names[] = { "held", "transition" };
+
+class BenchCollectable : public DistributedCollectable {
+public:
+  BenchCollectable(Runtime *rt, DistributedID did)
+    : DistributedCollectable(rt, did, rt->address_space, rt->address_space),
+      activations(0), deactivations(0) { }
+public:
+  virtual void notify_activate(void)
+    { __sync_fetch_and_add(&activations, 1); }
+  virtual void garbage_collect(void)
+    { __sync_fetch_and_add(&deactivations, 1); }
+  virtual void notify_valid(void) { }
+  virtual void notify_invalid(void) { }
+  virtual void notify_new_remote(AddressSpaceID sid) { }
+public:
+  volatile int activations;
+  volatile int deactivations;
+};
+
+struct RefLoopArgs {
+  BenchCollectable *target;
+  int iterations;
+  int threads;
+  // Used to start all the tasks at the same time
+  volatile int *arrived;
+};
+
+double ref_loop_task(const Task *task,
+                     const std::vector<PhysicalRegion> &regions,
+                     Context ctx, HighLevelRuntime *runtime)
+{
+  assert(task->arglen == sizeof(RefLoopArgs));
+  const RefLoopArgs &args = *((const RefLoopArgs*)task->args);
+  // The must epoch launch guarantees we all run at the same time
+  __sync_fetch_and_add(args.arrived, 1);
+  while (*args.arrived < args.threads) { }
+  double t_start = 1e6 * Realm::Clock::current_time();
+  for (int i = 0; i < args.iterations; i++)
+  {
+    args.target->add_base_gc_ref(TEMP_VALID_REF);
+    if (args.target->remove_base_gc_ref(TEMP_VALID_REF))
+      assert(false); // we hold a resource reference
+  }
+  double t_end = 1e6 * Realm::Clock::current_time();
+  return (t_end - t_start);
+}
+
+void top_level_task(const Task *task,
+                    const std::vector<PhysicalRegion> &regions,
+                    Context ctx, HighLevelRuntime *runtime)
+{
+  int num_iterations = 100000;
+  int max_threads = 0;
+  {
+    const InputArgs &command_args = HighLevelRuntime::get_input_args();
+    for (int i = 1; i < command_args.argc; i++)
+    {
+      if (!strcmp(command_args.argv[i],"-i"))
+        num_iterations = atoi(command_args.argv[++i]);
+      if (!strcmp(command_args.argv[i],"-threads"))
+        max_threads = atoi(command_args.argv[++i]);
+    }
+  }
+  // Default to one task per CPU processor
+  if (max_threads <= 0)
+  {
+    std::set<Processor> all_procs;
+    Machine::get_machine().get_all_processors(all_procs);
+    for (std::set<Processor>::const_iterator it = all_procs.begin();
+          it != all_procs.end(); it++)
+      if (it->kind() == Processor::LOC_PROC)
+        max_threads++;
+  }
+  printf("Collectable reference benchmark - %d iterations, "
+         "up to %d threads\n", num_iterations, max_threads);
+
+  Runtime *rt = Runtime::get_runtime(task->current_proc);
+  BenchCollectable *target =
+    new BenchCollectable(rt, rt->get_available_distributed_id());
+  // Keep the collectable alive across all the runs
+  target->add_base_resource_ref(TEMP_VALID_REF);
+
+  int errors = 0;
+  for (int pattern = PATTERN_HELD; pattern <= PATTERN_TRANSITION; pattern++)
+  {
+    if (pattern == PATTERN_HELD)
+      target->add_base_gc_ref(TEMP_VALID_REF);
+    for (int threads = 1; threads <= max_threads; threads *= 2)
+    {
+      const int start_activations = target->activations;
+      volatile int arrived = 0;
+      RefLoopArgs args;
+      args.target = target;
+      args.iterations = num_iterations;
+      args.threads = threads;
+      args.arrived = &arrived;
+
+      Rect<1> launch_bounds(Point<1>(0),Point<1>(threads-1));
+      Domain launch_domain = Domain::from_rect<1>(launch_bounds);
+      ArgumentMap arg_map;
+      IndexLauncher loop_launcher(REF_LOOP_TASK_ID, launch_domain,
+                                  TaskArgument(&args, sizeof(args)), arg_map);
+      MustEpochLauncher epoch_launcher;
+      epoch_launcher.add_index_task(loop_launcher);
+      FutureMap fm = runtime->execute_must_epoch(ctx, epoch_launcher);
+      fm.wait_all_results();
+
+      double max_us = 0.0;
+      for (int i = 0; i < threads; i++)
+      {
+        double us = fm.get_result<double>(DomainPoint::from_point<1>(i));
+        if (us > max_us)
+          max_us = us;
+      }
+      printf("%s: threads=%2d elapsed=%8.3fms time/add+remove=%6.0fns "
+             "(per thread) activations=%d\n", pattern_names[pattern], threads,
+             max_us * 1e-3, 1e3 * max_us / num_iterations,
+             target->activations - start_activations);
+
+      if ((pattern == PATTERN_HELD) &&
+          (target->activations != start_activations))
+      {
+        printf("ERROR: collectable re-activated while a reference was held\n");
+        errors++;
+      }
+      if (pattern == PATTERN_TRANSITION)
+      {
+        if (target->activations != target->deactivations)
+        {
+          printf("ERROR: %d activations but %d deactivations\n",
+                 (int)target->activations, (int)target->deactivations);
+          errors++;
+        }
+      }
+    }
+    if (pattern == PATTERN_HELD)
+    {
+      if (target->remove_base_gc_ref(TEMP_VALID_REF))
+        assert(false); // we hold a resource reference
+      if (target->activations != target->deactivations)
+      {
+        printf("ERROR: collectable still active after the last reference\n");
+        errors++;
+      }
+    }
+  }
+  if (target->remove_base_resource_ref(TEMP_VALID_REF))
+    delete target;
+  else
+  {
+    printf("ERROR: collectable not deleted after the last reference\n");
+    errors++;
+  }
+
+  if (errors > 0)
+  {
+    printf("Exiting with errors\n");
+    exit(1);
+  }
+  printf("all done!\n");
+}
+
+int main(int argc, char **argv)
+{
+  HighLevelRuntime::set_top_level_task_id(TOP_LEVEL_TASK_ID);
+  HighLevelRuntime::register_legion_task<top_level_task>(TOP_LEVEL_TASK_ID,
+      Processor::LOC_PROC, true/*single*/, false/*index*/);
+  HighLevelRuntime::register_legion_task<double,ref_loop_task>(
+      REF_LOOP_TASK_ID, Processor::LOC_PROC, true/*single*/, true/*index*/,
+      AUTO_GENERATE_ID, TaskConfigOptions(true/*leaf*/), "ref_loop");
+
+  return HighLevelRuntime::start(argc, argv);
+}
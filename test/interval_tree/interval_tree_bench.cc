@@ -0,0 +1,199 @@
+/* Copyright 2015 Stanford University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <cstdio>
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include "legion.h"
+#include "interval_tree.h"
+using namespace LegionRuntime::HighLevel;
+
+/*
+ * Checks and times the interval tree used for 1D domination
+ * tests.  Random inserts and queries are checked against a
+ * bitmap of the covered elements, trees built from the runs
+ * of an ElementMask are checked against inserting the same
+ * runs one at a time, and the time to build a tree from runs
+ * in sorted order (which is what walking an unstructured
+ * index space produces) is measured for repeated inserts and
+ * for the bulk build along with the time to query it.
+ */
+
+typedef IntervalTree<int,true/*discrete*/> Tree;
+
+static bool check_queries(const Tree &tree, const std::vector<bool> &covered,
+                          int num_queries)
+{
+  const int universe = covered.size();
+  for (int q = 0; q < num_queries; q++)
+  {
+    int left = lrand48() % universe;
+    int right = std::min(universe - 1, left + int(lrand48() % 64));
+    bool any = false, all = true;
+    std::vector<std::pair<int,int> > expected;
+    for (int i = left; i <= right; i++)
+    {
+      if (covered[i])
+      {
+        any = true;
+        if ((i == left) || !covered[i-1])
+          expected.push_back(std::pair<int,int>(i, i));
+        expected.back().second = i;
+      }
+      else
+        all = false;
+    }
+    // Overlapping intervals are reported whole
+    if (!expected.empty())
+    {
+      while ((expected.front().first > 0) &&
+             covered[expected.front().first - 1])
+        expected.front().first--;
+      while ((expected.back().second < (universe - 1)) &&
+             covered[expected.back().second + 1])
+        expected.back().second++;
+    }
+    std::vector<std::pair<int,int> > overlaps;
+    tree.find_overlaps(left, right, overlaps);
+    if ((tree.intersects(left, right) != any) ||
+        (tree.dominates(left, right) != all) ||
+        (tree.contains(left) != covered[left]) || (overlaps != expected))
+    {
+      printf("ERROR: wrong answer for [%d,%d]\n", left, right);
+      return false;
+    }
+  }
+  return true;
+}
+
+static bool random_inserts(int universe, int num_inserts)
+{
+  Tree tree;
+  std::vector<bool> covered(universe, false);
+  for (int i = 0; i < num_inserts; i++)
+  {
+    int left = lrand48() % universe;
+    int right = std::min(universe - 1, left + int(lrand48() % 16));
+    tree.insert(left, right);
+    for (int j = left; j <= right; j++)
+      covered[j] = true;
+    if ((i % 64) == 0)
+    {
+      tree.sanity_check();
+      if (!check_queries(tree, covered, 64))
+        return false;
+    }
+  }
+  tree.sanity_check();
+  return check_queries(tree, covered, 10000);
+}
+
+static bool element_mask_runs(int universe)
+{
+  LegionRuntime::LowLevel::ElementMask mask(universe);
+  std::vector<bool> covered(universe, false);
+  for (int i = 0; i < universe; i++)
+  {
+    if (drand48() < 0.6)
+    {
+      mask.enable(i);
+      covered[i] = true;
+    }
+  }
+  Tree bulk, inserted;
+  LegionRuntime::LowLevel::ElementMask::Enumerator *enumerator =
+    mask.enumerate_enabled();
+  bulk.build_from_runs(enumerator);
+  delete enumerator;
+  int position, length;
+  enumerator = mask.enumerate_enabled();
+  while (enumerator->get_next(position, length))
+    inserted.insert(position, position + length - 1);
+  delete enumerator;
+  bulk.sanity_check();
+  if (bulk.size() != inserted.size())
+  {
+    printf("ERROR: bulk build has %zd intervals instead of %zd\n",
+           bulk.size(), inserted.size());
+    return false;
+  }
+  return check_queries(bulk, covered, 10000) &&
+         check_queries(inserted, covered, 10000);
+}
+
+static void time_sorted_runs(int num_runs, int num_queries)
+{
+  std::vector<std::pair<int,int> > runs;
+  for (int i = 0; i < num_runs; i++)
+    runs.push_back(std::pair<int,int>(4*i, 4*i + 1));
+  std::vector<std::pair<int,int> > queries;
+  for (int i = 0; i < num_queries; i++)
+  {
+    int left = lrand48() % (4 * num_runs);
+    queries.push_back(std::pair<int,int>(left, left + 1));
+  }
+
+  double t_start = Realm::Clock::current_time();
+  Tree inserted;
+  for (unsigned i = 0; i < runs.size(); i++)
+    inserted.insert(runs[i].first, runs[i].second);
+  double t_insert = Realm::Clock::current_time() - t_start;
+
+  t_start = Realm::Clock::current_time();
+  Tree bulk;
+  bulk.build(runs);
+  double t_build = Realm::Clock::current_time() - t_start;
+
+  t_start = Realm::Clock::current_time();
+  unsigned dominated = 0;
+  for (unsigned i = 0; i < queries.size(); i++)
+    if (bulk.dominates(queries[i].first, queries[i].second))
+      dominated++;
+  double t_query = Realm::Clock::current_time() - t_start;
+
+  printf("%8d sorted runs: insert=%9.3fms build=%9.3fms "
+         "query=%6.0fns (%d dominated)\n", num_runs, t_insert * 1e3,
+         t_build * 1e3, 1e9 * t_query / num_queries, dominated);
+}
+
+int main(int argc, char **argv)
+{
+  int max_runs = 1 << 20;
+  unsigned seed = 12345;
+  for (int i = 1; i < argc; i++)
+  {
+    if (!strcmp(argv[i],"-n"))
+      max_runs = atoi(argv[++i]);
+    if (!strcmp(argv[i],"-seed"))
+      seed = atoi(argv[++i]);
+  }
+  srand48(seed);
+
+  bool success = true;
+  success = random_inserts(1000, 2000) && success;
+  success = random_inserts(100000, 20000) && success;
+  success = element_mask_runs(100000) && success;
+  if (!success)
+    exit(1);
+  printf("Interval tree checks passed\n");
+
+  for (int runs = 1024; runs <= max_runs; runs *= 4)
+    time_sorted_runs(runs, 1000000);
+  printf("all done!\n");
+  return 0;
+}
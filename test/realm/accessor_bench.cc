@@ -0,0 +1,262 @@
+#include "realm/realm.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cassert>
+#include <cstring>
+#include <csignal>
+
+#include <time.h>
+#include <unistd.h>
+
+using namespace Realm;
+using namespace LegionRuntime::Arrays;
+using namespace LegionRuntime::Accessor;
+
+// Task IDs, some IDs are reserved so start at first available number
+enum {
+  TOP_LEVEL_TASK = Processor::TASK_ID_FIRST_AVAILABLE+0,
+};
+
+// we're going to use alarm() as a watchdog to detect deadlocks
+void sigalrm_handler(int sig)
+{
+  fprintf(stderr, "HELP!  Alarm triggered - likely deadlock!\n");
+  exit(1);
+}
+
+typedef RegionAccessor<AccessorType::Generic, double> GenericAccessor;
+
+// every version computes dst = 2 * src + 1 over the whole rectangle
+static inline double kernel(double x) { return 2.0 * x + 1.0; }
+
+template <int DIM>
+struct AccessorLoop {
+  Rect<DIM> bounds;
+  bool used_affine;
+
+  template <typename ACC>
+  void run(const ACC& src, const ACC& dst)
+  {
+    for(GenericPointInRectIterator<DIM> pir(bounds); pir; pir++)
+      dst.write(pir.p, kernel(src.read(pir.p)));
+  }
+
+  // called by dispatch_accessor on the source field - the destination field
+  //  is in the same instance, so it gets the same kind of accessor
+  void operator()(const GenericAccessor& src)
+  {
+    used_affine = false;
+    run(src, *dst_generic);
+  }
+
+  void operator()(const RegionAccessor<AccessorType::Affine<DIM>, double>& src)
+  {
+    used_affine = true;
+    run(src, dst_generic->template convert_affine<DIM>(bounds));
+  }
+
+  const GenericAccessor *dst_generic;
+};
+
+// walks the instance with the pointer and strides from raw_rect_ptr - the
+//  fastest a hand-written loop can be
+template <int DIM>
+static bool raw_loop(GenericAccessor src, GenericAccessor dst, const Rect<DIM>& bounds)
+{
+  ByteOffset src_strides[DIM], dst_strides[DIM];
+  Rect<DIM> subrect;
+  double *src_base = src.raw_rect_ptr<DIM>(bounds, subrect, src_strides);
+  if(!src_base || (subrect != bounds)) return false;
+  double *dst_base = dst.raw_rect_ptr<DIM>(bounds, subrect, dst_strides);
+  if(!dst_base || (subrect != bounds)) return false;
+
+  for(GenericPointInRectIterator<DIM> pir(bounds); pir; pir++) {
+    const char *s = (const char *)src_base;
+    char *d = (char *)dst_base;
+    for(int i = 0; i < DIM; i++) {
+      s += (pir.p.x[i] - bounds.lo.x[i]) * src_strides[i].offset;
+      d += (pir.p.x[i] - bounds.lo.x[i]) * dst_strides[i].offset;
+    }
+    *(double *)d = kernel(*(const double *)s);
+  }
+  return true;
+}
+
+static int num_iterations = 10;
+static int elements_per_dim[] = { 0, 1 << 20, 1 << 10, 1 << 7 };
+static int timeout_seconds = 60;
+
+template <int DIM>
+static int run_layout(Memory m, const char *layout, size_t block_size)
+{
+  int errors = 0;
+
+  Point<DIM> lo = Point<DIM>::ZEROES(), hi;
+  for(int i = 0; i < DIM; i++)
+    hi.x[i] = elements_per_dim[DIM] - 1;
+  Rect<DIM> bounds(lo, hi);
+  size_t volume = bounds.volume();
+
+  std::vector<size_t> field_sizes(2, sizeof(double));
+  if(block_size == 0) block_size = volume;
+  RegionInstance inst = Domain::from_rect<DIM>(bounds).create_instance(m, field_sizes,
+								       block_size);
+  assert(inst.exists());
+
+  GenericAccessor src = inst.get_accessor().get_untyped_field_accessor(0, sizeof(double)).typeify<double>();
+  GenericAccessor dst = inst.get_accessor().get_untyped_field_accessor(sizeof(double), sizeof(double)).typeify<double>();
+
+  for(GenericPointInRectIterator<DIM> pir(bounds); pir; pir++) {
+    int v = 0;
+    for(int i = 0; i < DIM; i++)
+      v = v * 7 + pir.p.x[i];
+    src.write(pir.p, (double)v);
+  }
+
+  const char *names[] = { "raw", "generic", "dispatch" };
+  for(int version = 0; version < 3; version++) {
+    // raw_rect_ptr doesn't trim at block boundaries, so the raw loop only
+    //  works for AOS and SOA
+    if((version == 0) && (block_size > 1) && (block_size < volume)) continue;
+
+    // set the watchdog timeout before we do anything that could get stuck
+    alarm(timeout_seconds);
+
+    for(GenericPointInRectIterator<DIM> pir(bounds); pir; pir++)
+      dst.write(pir.p, -1.0);
+
+    bool ok = true;
+    bool used_affine = false;
+    // the generic version is much slower - don't wait for it as long
+    int iterations = (version == 1) ? std::max(1, num_iterations / 10) : num_iterations;
+    double t_start = Clock::current_time();
+    for(int i = 0; i < iterations; i++) {
+      switch(version) {
+      case 0:
+	ok = raw_loop<DIM>(src, dst, bounds);
+	break;
+
+      case 1:
+	{
+	  AccessorLoop<DIM> loop;
+	  loop.bounds = bounds;
+	  loop.run(src, dst);
+	  break;
+	}
+
+      case 2:
+	{
+	  AccessorLoop<DIM> loop;
+	  loop.bounds = bounds;
+	  loop.dst_generic = &dst;
+	  dispatch_accessor(src, bounds, loop);
+	  used_affine = loop.used_affine;
+	  break;
+	}
+      }
+      if(!ok) break;
+    }
+    double elapsed = Clock::current_time() - t_start;
+
+    // turn off the watchdog timer
+    alarm(0);
+
+    if(!ok) {
+      printf("%dD %-6s %-8s: no raw pointer\n", DIM, layout, names[version]);
+      continue;
+    }
+
+    size_t mismatches = 0;
+    for(GenericPointInRectIterator<DIM> pir(bounds); pir; pir++)
+      if(dst.read(pir.p) != kernel(src.read(pir.p)))
+	mismatches++;
+
+    printf("%dD %-6s %-8s: %6.2f ns/elem%s\n", DIM, layout, names[version],
+	   1e9 * elapsed / ((double)iterations * volume),
+	   (version < 2) ? "" : (used_affine ? " (affine)" : " (generic)"));
+
+    if(mismatches > 0) {
+      printf("ERROR: %zd of %zd elements wrong\n", mismatches, volume);
+      errors++;
+    }
+  }
+
+  inst.destroy();
+
+  return errors;
+}
+
+void top_level_task(const void *args, size_t arglen, Processor p)
+{
+  int errors = 0;
+
+  // any system memory on this node
+  Memory m = Memory::NO_MEMORY;
+  {
+    std::set<Memory> all_memories;
+    Machine::get_machine().get_all_memories(all_memories);
+    for(std::set<Memory>::const_iterator it = all_memories.begin();
+	it != all_memories.end();
+	it++)
+      if((it->kind() == Memory::SYSTEM_MEM) &&
+	 (it->address_space() == p.address_space())) {
+	m = *it;
+	break;
+      }
+  }
+  assert(m.exists());
+
+  printf("Realm accessor benchmark - %d iterations\n", num_iterations);
+
+  // AOS is block size 1, SOA is the whole instance (0 here), and hybrid
+  //  layouts fall back to the generic accessor
+  errors += run_layout<1>(m, "aos", 1);
+  errors += run_layout<1>(m, "soa", 0);
+  errors += run_layout<1>(m, "hybrid", 64);
+  errors += run_layout<2>(m, "aos", 1);
+  errors += run_layout<2>(m, "soa", 0);
+  errors += run_layout<3>(m, "aos", 1);
+  errors += run_layout<3>(m, "soa", 0);
+
+  if(errors > 0) {
+    printf("Exiting with errors\n");
+    exit(1);
+  }
+
+  printf("all done!\n");
+
+  Runtime::get_runtime().shutdown();
+}
+
+int main(int argc, char **argv)
+{
+  Runtime rt;
+
+  rt.init(&argc, &argv);
+
+  for(int i = 1; i < argc; i++) {
+    if(!strcmp(argv[i], "-i")) {
+      num_iterations = atoi(argv[++i]);
+      continue;
+    }
+
+    if(!strcmp(argv[i], "-t")) {
+      timeout_seconds = atoi(argv[++i]);
+      continue;
+    }
+  }
+
+  rt.register_task(TOP_LEVEL_TASK, top_level_task);
+
+  signal(SIGALRM, sigalrm_handler);
+
+  // Start the machine running
+  // Control never returns from this call
+  // Note we only run the top level task on one processor
+  // You can also run the top level task on all processors or one processor per node
+  rt.run(TOP_LEVEL_TASK, Runtime::ONE_TASK_ONLY);
+
+  //rt.shutdown();
+  return 0;
+}
@@ -0,0 +1,217 @@
+#include "realm/realm.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cassert>
+#include <cstring>
+#include <csignal>
+
+#include <time.h>
+#include <unistd.h>
+
+using namespace Realm;
+
+// Task IDs, some IDs are reserved so start at first available number
+enum {
+  TOP_LEVEL_TASK = Processor::TASK_ID_FIRST_AVAILABLE+0,
+  ARRIVER_TASK,
+};
+
+enum { REDOP_ADD = 1 };
+
+class ReductionOpIntAdd {
+public:
+  typedef int LHS;
+  typedef int RHS;
+
+  template <bool EXCL>
+  static void apply(LHS& lhs, RHS rhs) { lhs += rhs; }
+
+  static const RHS identity;
+
+  template <bool EXCL>
+  static void fold(RHS& rhs1, RHS rhs2) { rhs1 += rhs2; }
+};
+
+const ReductionOpIntAdd::RHS ReductionOpIntAdd::identity = 0;
+
+static const int BARRIER_INITIAL_VALUE = 42;
+
+// we're going to use alarm() as a watchdog to detect deadlocks
+void sigalrm_handler(int sig)
+{
+  fprintf(stderr, "HELP!  Alarm triggered - likely deadlock!\n");
+  exit(1);
+}
+
+struct ArriverArgs {
+  Barrier b;
+  int generations;
+  int arrivals;
+  int index;
+  bool reduce;
+};
+
+// arrives on every generation without waiting, so fast arrivers can run
+//  well ahead of slow ones (and of the generations that have triggered)
+void arriver_task(const void *args, size_t arglen, Processor p)
+{
+  assert(arglen == sizeof(ArriverArgs));
+  const ArriverArgs& a_args = *(const ArriverArgs *)args;
+
+  Barrier b = a_args.b;
+  int value = a_args.index + 1;
+  for(int g = 0; g < a_args.generations; g++) {
+    for(int i = 0; i < a_args.arrivals; i++)
+      if(a_args.reduce)
+	b.arrive(1, Event::NO_EVENT, &value, sizeof(value));
+      else
+	b.arrive(1);
+    b = b.advance_barrier();
+  }
+}
+
+static int num_generations = 100;
+static int num_arrivals = 100;
+static int tasks_per_proc = 4;
+static int timeout_seconds = 60;
+
+void top_level_task(const void *args, size_t arglen, Processor p)
+{
+  int errors = 0;
+
+  // arrivers go on every CPU in the machine, so on multiple nodes most
+  //  arrivals are remote to the barrier's owner
+  std::vector<Processor> cpus;
+  {
+    std::set<Processor> all_processors;
+    Machine::get_machine().get_all_processors(all_processors);
+    for(std::set<Processor>::const_iterator it = all_processors.begin();
+	it != all_processors.end();
+	it++)
+      if(it->kind() == Processor::LOC_PROC)
+	cpus.push_back(*it);
+  }
+  assert(!cpus.empty());
+
+  int num_tasks = tasks_per_proc * cpus.size();
+  int arrivals_per_gen = num_tasks * num_arrivals;
+
+  printf("Realm barrier benchmark - %d generations, %d arrivals per generation (%zd cpus)\n",
+	 num_generations, arrivals_per_gen, cpus.size());
+
+  const char *names[] = { "count", "reduce" };
+  for(int reduce = 0; reduce < 2; reduce++) {
+    Barrier b = (reduce ?
+		   Barrier::create_barrier(arrivals_per_gen, REDOP_ADD,
+					   &BARRIER_INITIAL_VALUE, sizeof(BARRIER_INITIAL_VALUE)) :
+		   Barrier::create_barrier(arrivals_per_gen));
+
+    // set the watchdog timeout before we do anything that could get stuck
+    alarm(timeout_seconds);
+
+    std::set<Event> finish_events;
+    double t_start = Clock::current_time();
+    for(int i = 0; i < num_tasks; i++) {
+      ArriverArgs a_args;
+      a_args.b = b;
+      a_args.generations = num_generations;
+      a_args.arrivals = num_arrivals;
+      a_args.index = i;
+      a_args.reduce = (reduce != 0);
+      finish_events.insert(cpus[i % cpus.size()].spawn(ARRIVER_TASK, &a_args, sizeof(a_args)));
+    }
+
+    // generations trigger in order, so waiting on the last one covers them all
+    Barrier last = b;
+    for(int g = 1; g < num_generations; g++)
+      last = last.advance_barrier();
+    last.wait();
+    double elapsed = Clock::current_time() - t_start;
+
+    Event::merge_events(finish_events).wait();
+
+    // turn off the watchdog timer
+    alarm(0);
+
+    printf("%-6s: elapsed=%6.3fs arrivals/s=%8.3fM time/generation=%8.2fus\n",
+	   names[reduce], elapsed,
+	   1e-6 * (double)arrivals_per_gen * num_generations / elapsed,
+	   1e6 * elapsed / num_generations);
+
+    if(reduce) {
+      // every task adds (index + 1) once per arrival
+      int exp_result = BARRIER_INITIAL_VALUE + num_arrivals * num_tasks * (num_tasks + 1) / 2;
+      int mismatches = 0;
+      Barrier check = b;
+      for(int g = 0; g < num_generations; g++) {
+	int result;
+	if(!check.get_result(&result, sizeof(result)) || (result != exp_result))
+	  mismatches++;
+	check = check.advance_barrier();
+      }
+      if(mismatches > 0) {
+	printf("ERROR: %d of %d generations had the wrong result\n", mismatches, num_generations);
+	errors++;
+      }
+    }
+
+    b.destroy_barrier();
+  }
+
+  if(errors > 0) {
+    printf("Exiting with errors\n");
+    exit(1);
+  }
+
+  printf("all done!\n");
+
+  Runtime::get_runtime().shutdown();
+}
+
+int main(int argc, char **argv)
+{
+  Runtime rt;
+
+  rt.init(&argc, &argv);
+
+  for(int i = 1; i < argc; i++) {
+    if(!strcmp(argv[i], "-g")) {
+      num_generations = atoi(argv[++i]);
+      continue;
+    }
+
+    if(!strcmp(argv[i], "-a")) {
+      num_arrivals = atoi(argv[++i]);
+      continue;
+    }
+
+    if(!strcmp(argv[i], "-tasks")) {
+      tasks_per_proc = atoi(argv[++i]);
+      continue;
+    }
+
+    if(!strcmp(argv[i], "-t")) {
+      timeout_seconds = atoi(argv[++i]);
+      continue;
+    }
+  }
+  assert((num_generations > 0) && (num_arrivals > 0) && (tasks_per_proc > 0));
+
+  rt.register_task(TOP_LEVEL_TASK, top_level_task);
+  rt.register_task(ARRIVER_TASK, arriver_task);
+
+  rt.register_reduction(REDOP_ADD,
+			ReductionOpUntyped::create_reduction_op<ReductionOpIntAdd>());
+
+  signal(SIGALRM, sigalrm_handler);
+
+  // Start the machine running
+  // Control never returns from this call
+  // Note we only run the top level task on one processor
+  // You can also run the top level task on all processors or one processor per node
+  rt.run(TOP_LEVEL_TASK, Runtime::ONE_TASK_ONLY);
+
+  //rt.shutdown();
+  return 0;
+}
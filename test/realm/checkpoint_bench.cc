@@ -0,0 +1,263 @@
+#include "realm/realm.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cassert>
+#include <cstring>
+#include <csignal>
+
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+using namespace Realm;
+
+// Task IDs, some IDs are reserved so start at first available number
+enum {
+  TOP_LEVEL_TASK = Processor::TASK_ID_FIRST_AVAILABLE+0,
+  WRITER_TASK,
+};
+
+// we're going to use alarm() as a watchdog to detect deadlocks
+void sigalrm_handler(int sig)
+{
+  fprintf(stderr, "HELP!  Alarm triggered - likely deadlock!\n");
+  exit(1);
+}
+
+enum WritePattern {
+  PATTERN_BLOCKING, // one pwrite at a time, blocking the task's thread
+  PATTERN_ASYNC,    // every block queued with AsyncIO, then wait on them all
+};
+
+static const char *pattern_names[] = { "blocking", "async" };
+
+// each writer owns a contiguous slice of the checkpoint file
+struct WriterArgs {
+  int fd;
+  off_t offset;
+  size_t bytes;
+  size_t block_size;
+  int index;
+  WritePattern pattern;
+};
+
+static volatile int errors_seen = 0;
+
+// block contents depend on the file offset, so misplaced blocks are caught
+static void fill_block(char *buffer, size_t bytes, off_t offset)
+{
+  for(size_t i = 0; i < bytes; i += sizeof(long long)) {
+    long long v = offset + i;
+    memcpy(buffer + i, &v, std::min(sizeof(v), bytes - i));
+  }
+}
+
+void writer_task(const void *args, size_t arglen, Processor p)
+{
+  assert(arglen == sizeof(WriterArgs));
+  const WriterArgs& w_args = *(const WriterArgs *)args;
+
+  // all the blocks are staged up front, as they would be for a checkpoint
+  size_t num_blocks = (w_args.bytes + w_args.block_size - 1) / w_args.block_size;
+  std::vector<char> data(w_args.bytes);
+  for(size_t i = 0; i < num_blocks; i++) {
+    size_t start = i * w_args.block_size;
+    fill_block(&data[start], std::min(w_args.block_size, w_args.bytes - start),
+	       w_args.offset + start);
+  }
+
+  std::vector<ssize_t> results(num_blocks, 0);
+  std::set<Event> done;
+  for(size_t i = 0; i < num_blocks; i++) {
+    size_t start = i * w_args.block_size;
+    size_t amt = std::min(w_args.block_size, w_args.bytes - start);
+    if(w_args.pattern == PATTERN_ASYNC) {
+      done.insert(AsyncIO::write(w_args.fd, &data[start], amt, w_args.offset + start,
+				 &results[i]));
+    } else {
+      results[i] = pwrite(w_args.fd, &data[start], amt, w_args.offset + start);
+    }
+  }
+  Event::merge_events(done).wait();
+
+  for(size_t i = 0; i < num_blocks; i++) {
+    size_t start = i * w_args.block_size;
+    if(results[i] != (ssize_t)std::min(w_args.block_size, w_args.bytes - start)) {
+      __sync_fetch_and_add(&errors_seen, 1);
+      break;
+    }
+  }
+}
+
+static int num_iterations = 3;
+static int num_writers = 16;
+static size_t total_mbytes = 64;
+static size_t block_kbytes = 64;
+static const char *directory = "/tmp";
+static int timeout_seconds = 60;
+
+// reads the whole file back with AsyncIO and checks every block
+static int verify_file(int fd, size_t total_bytes)
+{
+  size_t block_size = block_kbytes << 10;
+  std::vector<char> actual(block_size), expected(block_size);
+  for(size_t start = 0; start < total_bytes; start += block_size) {
+    size_t amt = std::min(block_size, total_bytes - start);
+    ssize_t result = -1;
+    AsyncIO::read(fd, &actual[0], amt, start, &result).wait();
+    fill_block(&expected[0], amt, start);
+    if((result != (ssize_t)amt) || memcmp(&actual[0], &expected[0], amt)) {
+      printf("ERROR: mismatch in block at offset %zd\n", start);
+      return 1;
+    }
+  }
+  return 0;
+}
+
+void top_level_task(const void *args, size_t arglen, Processor p)
+{
+  int errors = 0;
+
+  // writers go on this node's IO processor - start with -ll:async_io to get
+  //  the async mode
+  Processor io_proc = Processor::NO_PROC;
+  {
+    std::set<Processor> all_processors;
+    Machine::get_machine().get_all_processors(all_processors);
+    for(std::set<Processor>::const_iterator it = all_processors.begin();
+	it != all_processors.end();
+	it++)
+      if((it->kind() == Processor::IO_PROC) &&
+	 (it->address_space() == p.address_space())) {
+	io_proc = *it;
+	break;
+      }
+  }
+  if(!io_proc.exists()) {
+    printf("no IO processor found - run with -ll:io 1\n");
+    exit(1);
+  }
+
+  size_t total_bytes = total_mbytes << 20;
+  size_t slice = ((total_bytes / num_writers) + 4095) & ~(size_t)4095;
+
+  printf("Realm checkpoint benchmark - %d iterations, %zd MB, %d writers, %zd KB blocks\n",
+	 num_iterations, total_mbytes, num_writers, block_kbytes);
+
+  char filename[256];
+  snprintf(filename, sizeof(filename), "%s/checkpoint_bench.XXXXXX", directory);
+  int fd = mkstemp(filename);
+  if(fd < 0) {
+    printf("could not create checkpoint file in %s\n", directory);
+    exit(1);
+  }
+  unlink(filename);  // goes away when closed
+
+  for(int pattern = PATTERN_BLOCKING; pattern <= PATTERN_ASYNC; pattern++) {
+    // set the watchdog timeout before we do anything that could get stuck
+    alarm(timeout_seconds);
+
+    errors_seen = 0;
+
+    double best = 0;
+    for(int it = 0; it < num_iterations; it++) {
+      int ret = ftruncate(fd, 0);
+      assert(ret == 0);
+
+      std::set<Event> finish_events;
+      double t_start = Clock::current_time();
+      for(int i = 0; i < num_writers; i++) {
+	WriterArgs w_args;
+	w_args.fd = fd;
+	w_args.offset = i * slice;
+	if(w_args.offset >= (off_t)total_bytes) break;
+	w_args.bytes = std::min(slice, total_bytes - w_args.offset);
+	w_args.block_size = block_kbytes << 10;
+	w_args.index = i;
+	w_args.pattern = (WritePattern)pattern;
+	finish_events.insert(io_proc.spawn(WRITER_TASK, &w_args, sizeof(w_args)));
+      }
+      Event::merge_events(finish_events).wait();
+      double elapsed = Clock::current_time() - t_start;
+      double rate = 1e-6 * total_bytes / elapsed;
+      if(rate > best) best = rate;
+    }
+
+    // turn off the watchdog timer
+    alarm(0);
+
+    printf("%-8s: %8.2f MB/s (best of %d)\n", pattern_names[pattern], best, num_iterations);
+
+    if(errors_seen > 0) {
+      printf("ERROR: %d writers saw failed writes\n", (int)errors_seen);
+      errors++;
+    }
+    errors += verify_file(fd, total_bytes);
+  }
+
+  close(fd);
+
+  if(errors > 0) {
+    printf("Exiting with errors\n");
+    exit(1);
+  }
+
+  printf("all done!\n");
+
+  Runtime::get_runtime().shutdown();
+}
+
+int main(int argc, char **argv)
+{
+  Runtime rt;
+
+  rt.init(&argc, &argv);
+
+  for(int i = 1; i < argc; i++) {
+    if(!strcmp(argv[i], "-i")) {
+      num_iterations = atoi(argv[++i]);
+      continue;
+    }
+
+    if(!strcmp(argv[i], "-w")) {
+      num_writers = atoi(argv[++i]);
+      continue;
+    }
+
+    if(!strcmp(argv[i], "-m")) {
+      total_mbytes = atoi(argv[++i]);
+      continue;
+    }
+
+    if(!strcmp(argv[i], "-b")) {
+      block_kbytes = atoi(argv[++i]);
+      continue;
+    }
+
+    if(!strcmp(argv[i], "-d")) {
+      directory = argv[++i];
+      continue;
+    }
+
+    if(!strcmp(argv[i], "-t")) {
+      timeout_seconds = atoi(argv[++i]);
+      continue;
+    }
+  }
+  assert((num_writers > 0) && (total_mbytes > 0) && (block_kbytes > 0));
+
+  rt.register_task(TOP_LEVEL_TASK, top_level_task);
+  rt.register_task(WRITER_TASK, writer_task);
+
+  signal(SIGALRM, sigalrm_handler);
+
+  // Start the machine running
+  // Control never returns from this call
+  // Note we only run the top level task on one processor
+  // You can also run the top level task on all processors or one processor per node
+  rt.run(TOP_LEVEL_TASK, Runtime::ONE_TASK_ONLY);
+
+  //rt.shutdown();
+  return 0;
+}
@@ -17,6 +17,8 @@ enum {
   TOP_LEVEL_TASK = Processor::TASK_ID_FIRST_AVAILABLE+0,
   SWITCH_TEST_TASK,
   SLEEP_TEST_TASK,
+  CHURN_TEST_TASK,
+  CHURN_TRIGGER_TASK,
 };
 
 // we're going to use alarm() as a watchdog to detect deadlocks
@@ -84,11 +86,38 @@ void sleep_task(const void *args, size_t arglen, Processor p)
 #endif
 }
 
+// every churn task blocks on the same event, so each one that runs needs
+//  a new worker thread (and stack) to run the next one
+struct ChurnTestArgs {
+  Event wait_on;
+};
+
+void churn_task(const void *args, size_t arglen, Processor p)
+{
+  assert(arglen == sizeof(ChurnTestArgs));
+  const ChurnTestArgs& c_args = *(const ChurnTestArgs *)args;
+
+  c_args.wait_on.wait();
+}
+
+struct ChurnTriggerArgs {
+  UserEvent to_trigger;
+};
+
+void churn_trigger_task(const void *args, size_t arglen, Processor p)
+{
+  assert(arglen == sizeof(ChurnTriggerArgs));
+  const ChurnTriggerArgs& t_args = *(const ChurnTriggerArgs *)args;
+
+  t_args.to_trigger.trigger();
+}
+
 static int num_children = 4;
 static int num_iterations = 100000;
 static int timeout_seconds = 10;
 static int sleep_useconds = 500000;
 static int concurrent_io = 1;
+static int num_churn_tasks = 1000;
 
 void top_level_task(const void *args, size_t arglen, Processor p)
 {
@@ -154,6 +183,40 @@ void top_level_task(const void *args, size_t arglen, Processor p)
                pp.id, k, elapsed, ns_per_switch);
       }
 
+      // next, the cost of blocking tasks that each need a new thread
+      if(num_churn_tasks > 0) {
+        // set the watchdog timeout before we do anything that could get stuck
+        alarm(timeout_seconds);
+
+	UserEvent go = UserEvent::create_user_event();
+
+	double t_start = Clock::current_time();
+        std::set<Event> finish_events;
+	for(int i = 0; i < num_churn_tasks; i++) {
+	  ChurnTestArgs c_args;
+	  c_args.wait_on = go;
+
+	  finish_events.insert(pp.spawn(CHURN_TEST_TASK, &c_args, sizeof(c_args)));
+        }
+	// tasks start in order, so by the time this one runs, all the others
+	//  are blocked
+	{
+	  ChurnTriggerArgs t_args;
+	  t_args.to_trigger = go;
+	  finish_events.insert(pp.spawn(CHURN_TRIGGER_TASK, &t_args, sizeof(t_args)));
+	}
+	Event e = Event::merge_events(finish_events);
+	e.wait();
+	double t_end = Clock::current_time();
+
+	// turn off the watchdog timer
+	alarm(0);
+
+	double elapsed = t_end - t_start;
+	printf("churn: proc " IDFMT " (kind=%d) finished: tasks=%d elapsed=%5.2fs time/task=%6.0fns\n",
+               pp.id, k, num_churn_tasks, elapsed, 1e9 * elapsed / num_churn_tasks);
+      }
+
       // now the sleep (i.e. kernel-level switching, if possible) test
       if(sleep_useconds > 0) {
         double exp_time = 1e-6 * sleep_useconds;
@@ -231,6 +294,11 @@ int main(int argc, char **argv)
       continue;
     }
 
+    if(!strcmp(argv[i], "-n")) {
+      num_churn_tasks = atoi(argv[++i]);
+      continue;
+    }
+
     if(!strcmp(argv[i], "-s")) {
       sleep_useconds = atoi(argv[++i]);
       continue;
@@ -246,6 +314,8 @@ int main(int argc, char **argv)
   rt.register_task(TOP_LEVEL_TASK, top_level_task);
   rt.register_task(SWITCH_TEST_TASK, switch_task);
   rt.register_task(SLEEP_TEST_TASK, sleep_task);
+  rt.register_task(CHURN_TEST_TASK, churn_task);
+  rt.register_task(CHURN_TRIGGER_TASK, churn_trigger_task);
 
   signal(SIGALRM, sigalrm_handler);
 
@@ -0,0 +1,201 @@
+#include "realm/realm.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cassert>
+#include <cstring>
+#include <csignal>
+
+#include <time.h>
+#include <unistd.h>
+
+using namespace Realm;
+
+// Task IDs, some IDs are reserved so start at first available number
+enum {
+  TOP_LEVEL_TASK = Processor::TASK_ID_FIRST_AVAILABLE+0,
+  EVENT_LOOP_TASK,
+};
+
+// we're going to use alarm() as a watchdog to detect deadlocks
+void sigalrm_handler(int sig)
+{
+  fprintf(stderr, "HELP!  Alarm triggered - likely deadlock!\n");
+  exit(1);
+}
+
+enum EventPattern {
+  PATTERN_CREATE, // create and trigger user events
+  PATTERN_LOOKUP, // query events created by the top level task
+};
+
+static const char *pattern_names[] = { "create", "lookup" };
+
+struct EventLoopArgs {
+  int iterations;
+  int thread_index;
+  EventPattern pattern;
+};
+
+// events shared by all the lookup loops - they're all triggered, so
+//  every query has to find the event in the table
+static std::vector<UserEvent> lookup_events;
+static volatile int errors_seen = 0;
+
+void event_loop_task(const void *args, size_t arglen, Processor p)
+{
+  assert(arglen == sizeof(EventLoopArgs));
+  const EventLoopArgs& e_args = *(const EventLoopArgs *)args;
+
+  switch(e_args.pattern) {
+  case PATTERN_CREATE:
+    {
+      for(int i = 0; i < e_args.iterations; i++) {
+	UserEvent e = UserEvent::create_user_event();
+	e.trigger();
+	if(!e.has_triggered())
+	  __sync_fetch_and_add(&errors_seen, 1);
+      }
+      break;
+    }
+
+  case PATTERN_LOOKUP:
+    {
+      // start each thread at a different spot so they're not all walking
+      //  the same leaves at the same time
+      size_t count = lookup_events.size();
+      size_t idx = (e_args.thread_index * 7919) % count;
+      for(int i = 0; i < e_args.iterations; i++) {
+	if(!lookup_events[idx].has_triggered())
+	  __sync_fetch_and_add(&errors_seen, 1);
+	if(++idx == count) idx = 0;
+      }
+      break;
+    }
+  }
+}
+
+static int max_threads = 64;
+static int num_iterations = 100000;
+static int num_lookup_events = 65536;
+static int timeout_seconds = 60;
+
+void top_level_task(const void *args, size_t arglen, Processor p)
+{
+  int errors = 0;
+
+  // run on this node's CPU processors only - one task per processor (the
+  //  lookup events only exist here)
+  std::vector<Processor> cpus;
+  {
+    std::set<Processor> all_processors;
+    Machine::get_machine().get_all_processors(all_processors);
+    for(std::set<Processor>::const_iterator it = all_processors.begin();
+	it != all_processors.end();
+	it++)
+      if((it->kind() == Processor::LOC_PROC) &&
+	 (it->address_space() == p.address_space()))
+	cpus.push_back(*it);
+  }
+  assert(!cpus.empty());
+
+  printf("Realm event table benchmark - %d iterations, up to %d threads (%zd cpus)\n",
+	 num_iterations, max_threads, cpus.size());
+
+  for(int i = 0; i < num_lookup_events; i++) {
+    UserEvent e = UserEvent::create_user_event();
+    lookup_events.push_back(e);
+  }
+  for(int i = 0; i < num_lookup_events; i++)
+    lookup_events[i].trigger();
+
+  for(int pattern = PATTERN_CREATE; pattern <= PATTERN_LOOKUP; pattern++) {
+    for(int threads = 1;
+	(threads <= max_threads) && (threads <= (int)cpus.size());
+	threads *= 2) {
+      // set the watchdog timeout before we do anything that could get stuck
+      alarm(timeout_seconds);
+
+      errors_seen = 0;
+
+      std::set<Event> finish_events;
+      double t_start = Clock::current_time();
+      for(int i = 0; i < threads; i++) {
+	EventLoopArgs e_args;
+	e_args.iterations = num_iterations;
+	e_args.thread_index = i;
+	e_args.pattern = (EventPattern)pattern;
+	finish_events.insert(cpus[i].spawn(EVENT_LOOP_TASK, &e_args, sizeof(e_args)));
+      }
+      Event::merge_events(finish_events).wait();
+      double t_end = Clock::current_time();
+
+      // turn off the watchdog timer
+      alarm(0);
+
+      double elapsed = t_end - t_start;
+      double rate = (double)threads * num_iterations / elapsed;
+      printf("%s: threads=%2d elapsed=%6.3fs events/s=%8.3fM (total) time/event=%6.0fns (per thread)\n",
+	     pattern_names[pattern], threads, elapsed, rate * 1e-6,
+	     1e9 * elapsed / num_iterations);
+
+      if(errors_seen > 0) {
+	printf("ERROR: %d events not triggered\n", (int)errors_seen);
+	errors++;
+      }
+    }
+  }
+
+  if(errors > 0) {
+    printf("Exiting with errors\n");
+    exit(1);
+  }
+
+  printf("all done!\n");
+
+  Runtime::get_runtime().shutdown();
+}
+
+int main(int argc, char **argv)
+{
+  Runtime rt;
+
+  rt.init(&argc, &argv);
+
+  for(int i = 1; i < argc; i++) {
+    if(!strcmp(argv[i], "-i")) {
+      num_iterations = atoi(argv[++i]);
+      continue;
+    }
+
+    if(!strcmp(argv[i], "-e")) {
+      num_lookup_events = atoi(argv[++i]);
+      continue;
+    }
+
+    if(!strcmp(argv[i], "-t")) {
+      timeout_seconds = atoi(argv[++i]);
+      continue;
+    }
+
+    if(!strcmp(argv[i], "-threads")) {
+      max_threads = atoi(argv[++i]);
+      continue;
+    }
+  }
+  assert(num_lookup_events > 0);
+
+  rt.register_task(TOP_LEVEL_TASK, top_level_task);
+  rt.register_task(EVENT_LOOP_TASK, event_loop_task);
+
+  signal(SIGALRM, sigalrm_handler);
+
+  // Start the machine running
+  // Control never returns from this call
+  // Note we only run the top level task on one processor
+  // You can also run the top level task on all processors or one processor per node
+  rt.run(TOP_LEVEL_TASK, Runtime::ONE_TASK_ONLY);
+
+  //rt.shutdown();
+  return 0;
+}
@@ -0,0 +1,202 @@
+#include "realm/realm.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cassert>
+#include <cstring>
+#include <csignal>
+
+#include <time.h>
+#include <unistd.h>
+
+using namespace Realm;
+using namespace LegionRuntime::Arrays;
+using namespace LegionRuntime::Accessor;
+
+// Task IDs, some IDs are reserved so start at first available number
+enum {
+  TOP_LEVEL_TASK = Processor::TASK_ID_FIRST_AVAILABLE+0,
+};
+
+// we're going to use alarm() as a watchdog to detect deadlocks
+void sigalrm_handler(int sig)
+{
+  fprintf(stderr, "HELP!  Alarm triggered - likely deadlock!\n");
+  exit(1);
+}
+
+static int num_iterations = 5;
+static size_t fill_mbytes = 64;
+static size_t disk_fill_mbytes = 1;
+static int timeout_seconds = 60;
+
+// fills one field of a 3-D instance with a pattern that isn't a single
+//  repeated byte (so it can't just be a memset), and checks every element
+static int run_fill(Memory m, size_t mbytes, const char *layout, size_t field_size,
+		    int num_fields, size_t block_size, InstanceOrder::Kind kind)
+{
+  int errors = 0;
+
+  // a cube with roughly the requested number of bytes in each field
+  int edge = 1;
+  while(((size_t)(edge + 1) * (edge + 1) * (edge + 1) * field_size) <= (mbytes << 20))
+    edge++;
+  Rect<3> bounds(Point<3>::ZEROES(), Point<3>::ZEROES());
+  for(int i = 0; i < 3; i++)
+    bounds.hi.x[i] = edge - 1;
+  size_t volume = bounds.volume();
+
+  Point<3> tile;
+  for(int i = 0; i < 3; i++)
+    tile.x[i] = 16;
+
+  std::vector<size_t> field_sizes(num_fields, field_size);
+  if(block_size == 0) block_size = volume;
+  RegionInstance inst = Domain::from_rect<3>(bounds).create_instance(m, field_sizes, block_size,
+								     InstanceOrder(kind, DomainPoint::from_point<3>(tile)),
+								     ProfilingRequestSet());
+  assert(inst.exists());
+
+  // fill the last field, so that AOS layouts have something on both sides
+  unsigned offset = (num_fields - 1) * field_size;
+  std::vector<Domain::CopySrcDstField> dsts(1);
+  dsts[0] = Domain::CopySrcDstField(inst, offset, field_size);
+
+  std::vector<char> pattern(field_size);
+  for(size_t i = 0; i < field_size; i++)
+    pattern[i] = (char)(0x11 * (i + 1));
+
+  // set the watchdog timeout before we do anything that could get stuck
+  alarm(timeout_seconds);
+
+  // one untimed fill to fault in the instance's pages
+  Domain::from_rect<3>(bounds).fill(dsts, &pattern[0], field_size).wait();
+
+  double t_start = Clock::current_time();
+  for(int i = 0; i < num_iterations; i++)
+    Domain::from_rect<3>(bounds).fill(dsts, &pattern[0], field_size).wait();
+  double elapsed = Clock::current_time() - t_start;
+
+  // turn off the watchdog timer
+  alarm(0);
+
+  RegionAccessor<AccessorType::Generic> acc = inst.get_accessor().get_untyped_field_accessor(offset, field_size);
+  std::vector<char> value(field_size);
+  size_t mismatches = 0;
+  for(GenericPointInRectIterator<3> pir(bounds); pir; pir++) {
+    acc.read_untyped(DomainPoint::from_point<3>(pir.p), &value[0], field_size);
+    if(memcmp(&value[0], &pattern[0], field_size))
+      mismatches++;
+  }
+
+  printf("%-6s %3zdB x %d fields: %8.2f MB/s\n", layout, field_size, num_fields,
+	 1e-6 * num_iterations * volume * field_size / elapsed);
+
+  if(mismatches > 0) {
+    printf("ERROR: %zd of %zd elements wrong\n", mismatches, volume);
+    errors++;
+  }
+
+  inst.destroy();
+
+  return errors;
+}
+
+void top_level_task(const void *args, size_t arglen, Processor p)
+{
+  int errors = 0;
+
+  // any system memory on this node, and a disk memory if there is one (it
+  //  has no direct pointer, so fills to it go through put_bytes instead)
+  Memory m = Memory::NO_MEMORY;
+  Memory disk_mem = Memory::NO_MEMORY;
+  {
+    std::set<Memory> all_memories;
+    Machine::get_machine().get_all_memories(all_memories);
+    for(std::set<Memory>::const_iterator it = all_memories.begin();
+	it != all_memories.end();
+	it++) {
+      if(it->address_space() != p.address_space())
+	continue;
+      if(!m.exists() && (it->kind() == Memory::SYSTEM_MEM))
+	m = *it;
+      if(!disk_mem.exists() && (it->kind() == Memory::DISK_MEM))
+	disk_mem = *it;
+    }
+  }
+  assert(m.exists());
+
+  printf("Realm fill benchmark - %d iterations, %zd MB per field\n",
+	 num_iterations, fill_mbytes);
+
+  // field sizes that divide the vector size, ones that don't, and one
+  //  whose repeat period is too long for the vector stores
+  size_t sizes[] = { 4, 8, 12, 16, 24, 136 };
+  for(size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+    errors += run_fill(m, fill_mbytes, "soa", sizes[i], 1, 0, InstanceOrder::LINEAR);
+  errors += run_fill(m, fill_mbytes, "soa", 8, 2, 0, InstanceOrder::LINEAR);
+  errors += run_fill(m, fill_mbytes, "aos", 8, 2, 1, InstanceOrder::LINEAR);
+  errors += run_fill(m, fill_mbytes, "aos", 12, 2, 1, InstanceOrder::LINEAR);
+  errors += run_fill(m, fill_mbytes, "hybrid", 8, 2, 1000, InstanceOrder::LINEAR);
+  errors += run_fill(m, fill_mbytes, "tiled", 8, 1, 0, InstanceOrder::TILED);
+
+  // the disk fills are kept small because AOS layouts write (and the checks
+  //  read) one element at a time
+  if(disk_mem.exists()) {
+    errors += run_fill(disk_mem, disk_fill_mbytes, "d:soa", 12, 1, 0, InstanceOrder::LINEAR);
+    errors += run_fill(disk_mem, disk_fill_mbytes, "d:aos", 8, 2, 1, InstanceOrder::LINEAR);
+    errors += run_fill(disk_mem, disk_fill_mbytes, "d:hyb", 8, 2, 1000, InstanceOrder::LINEAR);
+  } else
+    printf("no disk memory (use -ll:dsize) - skipping put_bytes fills\n");
+
+  if(errors > 0) {
+    printf("Exiting with errors\n");
+    exit(1);
+  }
+
+  printf("all done!\n");
+
+  Runtime::get_runtime().shutdown();
+}
+
+int main(int argc, char **argv)
+{
+  Runtime rt;
+
+  rt.init(&argc, &argv);
+
+  for(int i = 1; i < argc; i++) {
+    if(!strcmp(argv[i], "-i")) {
+      num_iterations = atoi(argv[++i]);
+      continue;
+    }
+
+    if(!strcmp(argv[i], "-m")) {
+      fill_mbytes = atoi(argv[++i]);
+      continue;
+    }
+
+    if(!strcmp(argv[i], "-dm")) {
+      disk_fill_mbytes = atoi(argv[++i]);
+      continue;
+    }
+
+    if(!strcmp(argv[i], "-t")) {
+      timeout_seconds = atoi(argv[++i]);
+      continue;
+    }
+  }
+
+  rt.register_task(TOP_LEVEL_TASK, top_level_task);
+
+  signal(SIGALRM, sigalrm_handler);
+
+  // Start the machine running
+  // Control never returns from this call
+  // Note we only run the top level task on one processor
+  // You can also run the top level task on all processors or one processor per node
+  rt.run(TOP_LEVEL_TASK, Runtime::ONE_TASK_ONLY);
+
+  //rt.shutdown();
+  return 0;
+}
@@ -0,0 +1,203 @@
+#include "realm/realm.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cassert>
+#include <cstring>
+#include <csignal>
+
+#include <time.h>
+#include <unistd.h>
+
+using namespace Realm;
+
+// Task IDs, some IDs are reserved so start at first available number
+enum {
+  TOP_LEVEL_TASK = Processor::TASK_ID_FIRST_AVAILABLE+0,
+  WORK_TASK_A,
+  WORK_TASK_B,
+};
+
+// we're going to use alarm() as a watchdog to detect deadlocks
+void sigalrm_handler(int sig)
+{
+  fprintf(stderr, "HELP!  Alarm triggered - likely deadlock!\n");
+  exit(1);
+}
+
+enum WorkPattern {
+  PATTERN_UNIFORM,   // every task is (nearly) empty
+  PATTERN_SKEWED,    // every 8th task is much longer than the rest
+  PATTERN_AFFINITY,  // two task functions, alternating
+};
+
+static const char *pattern_names[] = { "uniform", "skewed", "affinity" };
+
+struct WorkArgs {
+  int index;
+  int spin_iters;
+};
+
+static int *task_counts = 0;
+static Processor *task_procs = 0;
+
+void work_task(const void *args, size_t arglen, Processor p)
+{
+  assert(arglen == sizeof(WorkArgs));
+  const WorkArgs& w_args = *(const WorkArgs *)args;
+
+  // burn a little time without sleeping, so the processor stays busy
+  volatile int x = 0;
+  for(int i = 0; i < w_args.spin_iters; i++)
+    x += i;
+
+  __sync_fetch_and_add(&task_counts[w_args.index], 1);
+  task_procs[w_args.index] = p;
+}
+
+static int num_tasks = 10000;
+static int short_spin = 100;
+static int long_spin = 100000;
+static int timeout_seconds = 60;
+
+void top_level_task(const void *args, size_t arglen, Processor p)
+{
+  int errors = 0;
+
+  // a group of every CPU on this node
+  std::vector<Processor> cpus;
+  {
+    std::set<Processor> all_processors;
+    Machine::get_machine().get_all_processors(all_processors);
+    for(std::set<Processor>::const_iterator it = all_processors.begin();
+	it != all_processors.end();
+	it++)
+      if((it->kind() == Processor::LOC_PROC) &&
+	 (it->address_space() == p.address_space()))
+	cpus.push_back(*it);
+  }
+  assert(!cpus.empty());
+  Processor pgrp = Processor::create_group(cpus);
+
+  printf("Realm group benchmark - %d tasks, %zd processors in group\n",
+	 num_tasks, cpus.size());
+
+  task_counts = new int[num_tasks];
+  task_procs = new Processor[num_tasks];
+
+  for(int pattern = PATTERN_UNIFORM; pattern <= PATTERN_AFFINITY; pattern++) {
+    for(int i = 0; i < num_tasks; i++) {
+      task_counts[i] = 0;
+      task_procs[i] = Processor::NO_PROC;
+    }
+
+    // set the watchdog timeout before we do anything that could get stuck
+    alarm(timeout_seconds);
+
+    std::set<Event> finish_events;
+    double t_start = Clock::current_time();
+    for(int i = 0; i < num_tasks; i++) {
+      WorkArgs w_args;
+      w_args.index = i;
+      w_args.spin_iters = (((pattern == PATTERN_SKEWED) && ((i % 8) == 0)) ?
+			     long_spin : short_spin);
+      Processor::TaskFuncID func_id = (((pattern == PATTERN_AFFINITY) && (i & 1)) ?
+				         WORK_TASK_B : WORK_TASK_A);
+      finish_events.insert(pgrp.spawn(func_id, &w_args, sizeof(w_args)));
+    }
+    Event::merge_events(finish_events).wait();
+    double elapsed = Clock::current_time() - t_start;
+
+    // turn off the watchdog timer
+    alarm(0);
+
+    // how evenly was the work spread, and how often did a function's task
+    //  run on the same member as that function's previous task?
+    std::map<Processor, int> proc_counts;
+    int missing = 0, same_member = 0;
+    for(int i = 0; i < num_tasks; i++) {
+      if(task_counts[i] != 1) {
+	missing++;
+	continue;
+      }
+      proc_counts[task_procs[i]]++;
+      if((i >= 2) && (task_procs[i] == task_procs[i - 2]))
+	same_member++;
+    }
+    int min_count = num_tasks, max_count = 0;
+    for(size_t i = 0; i < cpus.size(); i++) {
+      int c = proc_counts.count(cpus[i]) ? proc_counts[cpus[i]] : 0;
+      min_count = std::min(min_count, c);
+      max_count = std::max(max_count, c);
+    }
+
+    printf("%-8s: tasks/s=%8.3fM time/task=%6.0fns tasks/proc=[%d,%d] same-member=%5.1f%%\n",
+	   pattern_names[pattern],
+	   1e-6 * num_tasks / elapsed,
+	   1e9 * elapsed / num_tasks,
+	   min_count, max_count,
+	   100.0 * same_member / std::max(1, num_tasks - 2));
+
+    if(missing > 0) {
+      printf("ERROR: %d tasks did not run exactly once\n", missing);
+      errors++;
+    }
+  }
+
+  delete[] task_counts;
+  delete[] task_procs;
+
+  if(errors > 0) {
+    printf("Exiting with errors\n");
+    exit(1);
+  }
+
+  printf("all done!\n");
+
+  Runtime::get_runtime().shutdown();
+}
+
+int main(int argc, char **argv)
+{
+  Runtime rt;
+
+  rt.init(&argc, &argv);
+
+  for(int i = 1; i < argc; i++) {
+    if(!strcmp(argv[i], "-i")) {
+      num_tasks = atoi(argv[++i]);
+      continue;
+    }
+
+    if(!strcmp(argv[i], "-short")) {
+      short_spin = atoi(argv[++i]);
+      continue;
+    }
+
+    if(!strcmp(argv[i], "-long")) {
+      long_spin = atoi(argv[++i]);
+      continue;
+    }
+
+    if(!strcmp(argv[i], "-t")) {
+      timeout_seconds = atoi(argv[++i]);
+      continue;
+    }
+  }
+  assert(num_tasks > 0);
+
+  rt.register_task(TOP_LEVEL_TASK, top_level_task);
+  rt.register_task(WORK_TASK_A, work_task);
+  rt.register_task(WORK_TASK_B, work_task);
+
+  signal(SIGALRM, sigalrm_handler);
+
+  // Start the machine running
+  // Control never returns from this call
+  // Note we only run the top level task on one processor
+  // You can also run the top level task on all processors or one processor per node
+  rt.run(TOP_LEVEL_TASK, Runtime::ONE_TASK_ONLY);
+
+  //rt.shutdown();
+  return 0;
+}
@@ -0,0 +1,194 @@
+#include "realm/realm.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cassert>
+#include <cstring>
+#include <csignal>
+
+#include <time.h>
+#include <unistd.h>
+
+using namespace Realm;
+using namespace LegionRuntime::Arrays;
+using namespace LegionRuntime::Accessor;
+
+// Task IDs, some IDs are reserved so start at first available number
+enum {
+  TOP_LEVEL_TASK = Processor::TASK_ID_FIRST_AVAILABLE+0,
+};
+
+// we're going to use alarm() as a watchdog to detect deadlocks
+void sigalrm_handler(int sig)
+{
+  fprintf(stderr, "HELP!  Alarm triggered - likely deadlock!\n");
+  exit(1);
+}
+
+static int num_rounds = 4;
+static int batch_size = 64;
+static int num_elements = 1024;
+static int timeout_seconds = 60;
+
+// creates a batch of instances spread over the given memories, gathers them
+//  all with a single copy (which prefetches their metadata in bulk when they
+//  are remote) and then destroys the batch with one call
+static int run_round(int round, const std::vector<Memory>& memories, Memory local_mem)
+{
+  int errors = 0;
+
+  Domain domain = Domain::from_rect<1>(Rect<1>(Point<1>(0), Point<1>(num_elements - 1)));
+
+  std::vector<RegionInstance> batch;
+  std::set<Event> fill_events;
+  for(int i = 0; i < batch_size; i++) {
+    Memory m = memories[i % memories.size()];
+    RegionInstance inst = domain.create_instance(m, sizeof(long long));
+    assert(inst.exists());
+    batch.push_back(inst);
+
+    long long value = round * batch_size + i;
+    std::vector<Domain::CopySrcDstField> dsts(1);
+    dsts[0] = Domain::CopySrcDstField(inst, 0, sizeof(long long));
+    fill_events.insert(domain.fill(dsts, &value, sizeof(value)));
+  }
+
+  // one field per instance in the batch
+  std::vector<size_t> field_sizes(batch_size, sizeof(long long));
+  RegionInstance gather = domain.create_instance(local_mem, field_sizes, num_elements);
+  assert(gather.exists());
+
+  std::vector<Domain::CopySrcDstField> srcs, dsts;
+  for(int i = 0; i < batch_size; i++) {
+    srcs.push_back(Domain::CopySrcDstField(batch[i], 0, sizeof(long long)));
+    dsts.push_back(Domain::CopySrcDstField(gather, i * sizeof(long long), sizeof(long long)));
+  }
+  Event copy_done = domain.copy(srcs, dsts, Event::merge_events(fill_events));
+
+  // odd rounds hand the destruction to the copy's completion event, even
+  //  rounds wait first so the batch is destroyed right away
+  if((round % 2) == 1) {
+    RegionInstance::destroy_instances(batch, copy_done);
+    copy_done.wait();
+  } else {
+    copy_done.wait();
+    RegionInstance::destroy_instances(batch);
+  }
+
+  size_t mismatches = 0;
+  for(int i = 0; i < batch_size; i++) {
+    long long expected = round * batch_size + i;
+    RegionAccessor<AccessorType::Generic> acc =
+      gather.get_accessor().get_untyped_field_accessor(i * sizeof(long long), sizeof(long long));
+    for(int e = 0; e < num_elements; e++) {
+      long long value;
+      acc.read_untyped(DomainPoint::from_point<1>(Point<1>(e)), &value, sizeof(value));
+      if(value != expected)
+	mismatches++;
+    }
+  }
+
+  gather.destroy();
+
+  if(mismatches > 0) {
+    printf("ERROR: round %d: %zd of %d elements wrong\n",
+	   round, mismatches, batch_size * num_elements);
+    errors++;
+  }
+
+  return errors;
+}
+
+void top_level_task(const void *args, size_t arglen, Processor p)
+{
+  int errors = 0;
+
+  // every memory we can put a plain instance in, on any node, and a system
+  //  memory on this node to gather into
+  std::vector<Memory> memories;
+  Memory local_mem = Memory::NO_MEMORY;
+  {
+    std::set<Memory> all_memories;
+    Machine::get_machine().get_all_memories(all_memories);
+    for(std::set<Memory>::const_iterator it = all_memories.begin();
+	it != all_memories.end();
+	it++) {
+      if((it->kind() != Memory::SYSTEM_MEM) &&
+	 (it->kind() != Memory::REGDMA_MEM) &&
+	 (it->kind() != Memory::GLOBAL_MEM))
+	continue;
+      if(it->capacity() == 0)
+	continue;
+      memories.push_back(*it);
+      if(!local_mem.exists() &&
+	 (it->kind() == Memory::SYSTEM_MEM) &&
+	 (it->address_space() == p.address_space()))
+	local_mem = *it;
+    }
+  }
+  assert(local_mem.exists());
+
+  printf("Realm instance batch test - %d rounds of %d instances over %zd memories\n",
+	 num_rounds, batch_size, memories.size());
+
+  // set the watchdog timeout before we do anything that could get stuck
+  alarm(timeout_seconds);
+
+  // later rounds reuse the space freed by earlier ones
+  for(int r = 0; r < num_rounds; r++)
+    errors += run_round(r, memories, local_mem);
+
+  // turn off the watchdog timer
+  alarm(0);
+
+  if(errors > 0) {
+    printf("Exiting with errors\n");
+    exit(1);
+  }
+
+  printf("all done!\n");
+
+  Runtime::get_runtime().shutdown();
+}
+
+int main(int argc, char **argv)
+{
+  Runtime rt;
+
+  rt.init(&argc, &argv);
+
+  for(int i = 1; i < argc; i++) {
+    if(!strcmp(argv[i], "-r")) {
+      num_rounds = atoi(argv[++i]);
+      continue;
+    }
+
+    if(!strcmp(argv[i], "-b")) {
+      batch_size = atoi(argv[++i]);
+      continue;
+    }
+
+    if(!strcmp(argv[i], "-n")) {
+      num_elements = atoi(argv[++i]);
+      continue;
+    }
+
+    if(!strcmp(argv[i], "-t")) {
+      timeout_seconds = atoi(argv[++i]);
+      continue;
+    }
+  }
+
+  rt.register_task(TOP_LEVEL_TASK, top_level_task);
+
+  signal(SIGALRM, sigalrm_handler);
+
+  // Start the machine running
+  // Control never returns from this call
+  // Note we only run the top level task on one processor
+  // You can also run the top level task on all processors or one processor per node
+  rt.run(TOP_LEVEL_TASK, Runtime::ONE_TASK_ONLY);
+
+  //rt.shutdown();
+  return 0;
+}
@@ -0,0 +1,204 @@
+#include "realm/realm.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cassert>
+#include <cstring>
+#include <csignal>
+
+#include <time.h>
+#include <unistd.h>
+
+using namespace Realm;
+
+// Task IDs, some IDs are reserved so start at first available number
+enum {
+  TOP_LEVEL_TASK = Processor::TASK_ID_FIRST_AVAILABLE+0,
+  PING_TASK,
+  TRIGGER_TASK,
+  PAYLOAD_TASK,
+};
+
+// we're going to use alarm() as a watchdog to detect deadlocks
+void sigalrm_handler(int sig)
+{
+  fprintf(stderr, "HELP!  Alarm triggered - likely deadlock!\n");
+  exit(1);
+}
+
+struct TriggerArgs {
+  UserEvent event;
+};
+
+// header at the front of a payload task's arguments - the rest is a
+//  pattern the task checks
+struct PayloadArgs {
+  UserEvent event;
+  unsigned seed;
+};
+
+void ping_task(const void *args, size_t arglen, Processor p)
+{
+  // nothing to do - the round trip is what's measured
+}
+
+void trigger_task(const void *args, size_t arglen, Processor p)
+{
+  assert(arglen == sizeof(TriggerArgs));
+  const TriggerArgs& t_args = *(const TriggerArgs *)args;
+  t_args.event.trigger();
+}
+
+void payload_task(const void *args, size_t arglen, Processor p)
+{
+  assert(arglen >= sizeof(PayloadArgs));
+  const PayloadArgs& p_args = *(const PayloadArgs *)args;
+  const unsigned *data = (const unsigned *)(((const char *)args) + sizeof(PayloadArgs));
+  size_t count = (arglen - sizeof(PayloadArgs)) / sizeof(unsigned);
+  for(size_t i = 0; i < count; i++)
+    if(data[i] != (unsigned)(p_args.seed + i * 2654435761U)) {
+      // leave the event untriggered - the sender's watchdog will catch it
+      fprintf(stderr, "ERROR: payload mismatch at word %zd of %zd on processor " IDFMT "\n",
+	      i, count, p.id);
+      return;
+    }
+  p_args.event.trigger();
+}
+
+static int num_iterations = 1000;
+static size_t max_payload = 4 << 20;
+static int timeout_seconds = 60;
+
+void top_level_task(const void *args, size_t arglen, Processor p)
+{
+  // one CPU processor in each address space - the local one is used only if
+  //  there's nobody else to talk to
+  std::vector<Processor> targets;
+  {
+    std::set<AddressSpace> seen;
+    std::set<Processor> all_processors;
+    Machine::get_machine().get_all_processors(all_processors);
+    for(std::set<Processor>::const_iterator it = all_processors.begin();
+	it != all_processors.end();
+	it++)
+      if((it->kind() == Processor::LOC_PROC) &&
+	 (it->address_space() != p.address_space()) &&
+	 seen.insert(it->address_space()).second)
+	targets.push_back(*it);
+  }
+  if(targets.empty())
+    targets.push_back(p);
+
+  printf("Realm node ping-pong test - %d iterations, %zd target nodes\n",
+	 num_iterations, targets.size());
+
+  for(size_t t = 0; t < targets.size(); t++) {
+    Processor target = targets[t];
+
+    // set the watchdog timeout before we do anything that could get stuck
+    alarm(timeout_seconds);
+
+    // empty task round trips - each spawn waits for the previous one to finish
+    {
+      double t_start = Clock::current_time();
+      for(int i = 0; i < num_iterations; i++)
+	target.spawn(PING_TASK, 0, 0).wait();
+      double elapsed = Clock::current_time() - t_start;
+      printf("node %d: spawn round trip = %7.2f us\n",
+	     target.address_space(), 1e6 * elapsed / num_iterations);
+    }
+
+    // the remote node triggers an event we own, and runs a task that waits
+    //  on an event we trigger
+    {
+      double t_start = Clock::current_time();
+      for(int i = 0; i < num_iterations; i++) {
+	TriggerArgs t_args;
+	t_args.event = UserEvent::create_user_event();
+	target.spawn(TRIGGER_TASK, &t_args, sizeof(t_args));
+	t_args.event.wait();
+      }
+      double elapsed = Clock::current_time() - t_start;
+      printf("node %d: remote trigger = %7.2f us\n",
+	     target.address_space(), 1e6 * elapsed / num_iterations);
+
+      UserEvent start = UserEvent::create_user_event();
+      Event done = target.spawn(PING_TASK, 0, 0, start);
+      assert(!done.has_triggered());
+      start.trigger();
+      done.wait();
+    }
+
+    // payloads from a few bytes up to several ring records
+    for(size_t size = 64; size <= max_payload; size *= 16) {
+      size_t arglen = sizeof(PayloadArgs) + size;
+      char *buffer = (char *)malloc(arglen);
+      PayloadArgs& p_args = *(PayloadArgs *)buffer;
+      unsigned *data = (unsigned *)(buffer + sizeof(PayloadArgs));
+      p_args.seed = size;
+      for(size_t i = 0; i < size / sizeof(unsigned); i++)
+	data[i] = p_args.seed + i * 2654435761U;
+
+      int reps = std::max(1, (int)((16 << 20) / size));
+      if(reps > num_iterations) reps = num_iterations;
+      double t_start = Clock::current_time();
+      for(int i = 0; i < reps; i++) {
+	p_args.event = UserEvent::create_user_event();
+	target.spawn(PAYLOAD_TASK, buffer, arglen);
+	p_args.event.wait();
+      }
+      double elapsed = Clock::current_time() - t_start;
+      free(buffer);
+      printf("node %d: payload %8zd B = %9.2f us, %8.2f MB/s\n",
+	     target.address_space(), size, 1e6 * elapsed / reps,
+	     1e-6 * size * reps / elapsed);
+    }
+
+    // turn off the watchdog timer
+    alarm(0);
+  }
+
+  printf("all done!\n");
+
+  Runtime::get_runtime().shutdown();
+}
+
+int main(int argc, char **argv)
+{
+  Runtime rt;
+
+  rt.init(&argc, &argv);
+
+  for(int i = 1; i < argc; i++) {
+    if(!strcmp(argv[i], "-i")) {
+      num_iterations = atoi(argv[++i]);
+      continue;
+    }
+
+    if(!strcmp(argv[i], "-s")) {
+      max_payload = atoi(argv[++i]);
+      continue;
+    }
+
+    if(!strcmp(argv[i], "-t")) {
+      timeout_seconds = atoi(argv[++i]);
+      continue;
+    }
+  }
+
+  rt.register_task(TOP_LEVEL_TASK, top_level_task);
+  rt.register_task(PING_TASK, ping_task);
+  rt.register_task(TRIGGER_TASK, trigger_task);
+  rt.register_task(PAYLOAD_TASK, payload_task);
+
+  signal(SIGALRM, sigalrm_handler);
+
+  // Start the machine running
+  // Control never returns from this call
+  // Note we only run the top level task on one processor
+  // You can also run the top level task on all processors or one processor per node
+  rt.run(TOP_LEVEL_TASK, Runtime::ONE_TASK_ONLY);
+
+  //rt.shutdown();
+  return 0;
+}
@@ -0,0 +1,205 @@
+#include "realm/realm.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cassert>
+#include <cstring>
+#include <csignal>
+
+#include <time.h>
+#include <unistd.h>
+
+using namespace Realm;
+
+// Task IDs, some IDs are reserved so start at first available number
+enum {
+  TOP_LEVEL_TASK = Processor::TASK_ID_FIRST_AVAILABLE+0,
+  LOCK_LOOP_TASK,
+};
+
+// we're going to use alarm() as a watchdog to detect deadlocks
+void sigalrm_handler(int sig)
+{
+  fprintf(stderr, "HELP!  Alarm triggered - likely deadlock!\n");
+  exit(1);
+}
+
+enum LockPattern {
+  PATTERN_EXCLUSIVE, // every acquire is exclusive
+  PATTERN_SHARED,    // every acquire is shared (mode 1)
+  PATTERN_MIXED,     // one in every 8 acquires is exclusive
+};
+
+static const char *pattern_names[] = { "exclusive", "shared", "mixed" };
+
+struct LockLoopArgs {
+  int iterations;
+  LockPattern pattern;
+  Reservation rsrv;
+};
+
+// state protected by the reservation - used to check mutual exclusion
+static volatile int protected_counter = 0;
+static volatile int active_writers = 0;
+static volatile int errors_seen = 0;
+
+void lock_loop_task(const void *args, size_t arglen, Processor p)
+{
+  assert(arglen == sizeof(LockLoopArgs));
+  const LockLoopArgs& l_args = *(const LockLoopArgs *)args;
+
+  for(int i = 0; i < l_args.iterations; i++) {
+    bool exclusive = ((l_args.pattern == PATTERN_EXCLUSIVE) ||
+		      ((l_args.pattern == PATTERN_MIXED) && ((i & 7) == 0)));
+
+    Event e = l_args.rsrv.acquire(exclusive ? 0 : 1, exclusive);
+    if(!e.has_triggered())
+      e.wait();
+
+    if(exclusive) {
+      if(__sync_fetch_and_add(&active_writers, 1) != 0)
+	__sync_fetch_and_add(&errors_seen, 1);
+      protected_counter = protected_counter + 1;
+      __sync_fetch_and_sub(&active_writers, 1);
+    } else {
+      if(active_writers != 0)
+	__sync_fetch_and_add(&errors_seen, 1);
+    }
+
+    l_args.rsrv.release();
+  }
+}
+
+static int max_threads = 32;
+static int num_iterations = 100000;
+static int timeout_seconds = 60;
+
+void top_level_task(const void *args, size_t arglen, Processor p)
+{
+  int errors = 0;
+
+  // run on CPU processors only - one task per processor
+  std::vector<Processor> cpus;
+  {
+    std::set<Processor> all_processors;
+    Machine::get_machine().get_all_processors(all_processors);
+    for(std::set<Processor>::const_iterator it = all_processors.begin();
+	it != all_processors.end();
+	it++)
+      if(it->kind() == Processor::LOC_PROC)
+	cpus.push_back(*it);
+  }
+  assert(!cpus.empty());
+
+  printf("Realm reservation benchmark - %d iterations, up to %d threads (%zd cpus)\n",
+	 num_iterations, max_threads, cpus.size());
+
+  Reservation rsrv = Reservation::create_reservation();
+
+  for(int pattern = PATTERN_EXCLUSIVE; pattern <= PATTERN_MIXED; pattern++) {
+    for(int threads = 1;
+	(threads <= max_threads) && (threads <= (int)cpus.size());
+	threads *= 2) {
+      // set the watchdog timeout before we do anything that could get stuck
+      alarm(timeout_seconds);
+
+      protected_counter = 0;
+      errors_seen = 0;
+
+      std::set<Event> finish_events;
+      double t_start = Clock::current_time();
+      for(int i = 0; i < threads; i++) {
+	LockLoopArgs l_args;
+	l_args.iterations = num_iterations;
+	l_args.pattern = (LockPattern)pattern;
+	l_args.rsrv = rsrv;
+	finish_events.insert(cpus[i].spawn(LOCK_LOOP_TASK, &l_args, sizeof(l_args)));
+      }
+      Event::merge_events(finish_events).wait();
+      double t_end = Clock::current_time();
+
+      // turn off the watchdog timer
+      alarm(0);
+
+      int exp_writes = 0;
+      switch(pattern) {
+      case PATTERN_EXCLUSIVE: exp_writes = threads * num_iterations; break;
+      case PATTERN_SHARED: exp_writes = 0; break;
+      case PATTERN_MIXED: exp_writes = threads * ((num_iterations + 7) / 8); break;
+      }
+
+      double elapsed = t_end - t_start;
+      double ns_per_pair = 1e9 * elapsed / num_iterations;
+      printf("%s: threads=%2d elapsed=%6.3fs time/acquire+release=%6.0fns (per thread)\n",
+	     pattern_names[pattern], threads, elapsed, ns_per_pair);
+
+      if(errors_seen > 0) {
+	printf("ERROR: %d mutual exclusion violations\n", (int)errors_seen);
+	errors++;
+      }
+      if(protected_counter != exp_writes) {
+	printf("ERROR: counter = %d, expected %d\n", (int)protected_counter, exp_writes);
+	errors++;
+      }
+    }
+  }
+
+  // reservation must be idle (and acquirable immediately) again
+  {
+    Event e = rsrv.acquire();
+    if(e.exists()) {
+      printf("ERROR: idle reservation not granted immediately\n");
+      errors++;
+      e.wait();
+    }
+    rsrv.release();
+  }
+  rsrv.destroy_reservation();
+
+  if(errors > 0) {
+    printf("Exiting with errors\n");
+    exit(1);
+  }
+
+  printf("all done!\n");
+
+  Runtime::get_runtime().shutdown();
+}
+
+int main(int argc, char **argv)
+{
+  Runtime rt;
+
+  rt.init(&argc, &argv);
+
+  for(int i = 1; i < argc; i++) {
+    if(!strcmp(argv[i], "-i")) {
+      num_iterations = atoi(argv[++i]);
+      continue;
+    }
+
+    if(!strcmp(argv[i], "-t")) {
+      timeout_seconds = atoi(argv[++i]);
+      continue;
+    }
+
+    if(!strcmp(argv[i], "-threads")) {
+      max_threads = atoi(argv[++i]);
+      continue;
+    }
+  }
+
+  rt.register_task(TOP_LEVEL_TASK, top_level_task);
+  rt.register_task(LOCK_LOOP_TASK, lock_loop_task);
+
+  signal(SIGALRM, sigalrm_handler);
+
+  // Start the machine running
+  // Control never returns from this call
+  // Note we only run the top level task on one processor
+  // You can also run the top level task on all processors or one processor per node
+  rt.run(TOP_LEVEL_TASK, Runtime::ONE_TASK_ONLY);
+
+  //rt.shutdown();
+  return 0;
+}
@@ -0,0 +1,195 @@
+#include "realm/realm.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cassert>
+#include <cstring>
+#include <csignal>
+
+#include <time.h>
+#include <unistd.h>
+
+using namespace Realm;
+
+// Task IDs, some IDs are reserved so start at first available number
+enum {
+  TOP_LEVEL_TASK = Processor::TASK_ID_FIRST_AVAILABLE+0,
+  DRIVER_TASK,
+  CHECK_ARGS_TASK,
+};
+
+// we're going to use alarm() as a watchdog to detect deadlocks
+void sigalrm_handler(int sig)
+{
+  fprintf(stderr, "HELP!  Alarm triggered - likely deadlock!\n");
+  exit(1);
+}
+
+enum SpawnPattern {
+  PATTERN_READY,    // start events have already triggered
+  PATTERN_DEFERRED, // everything waits on one event triggered at the end
+};
+
+static const char *pattern_names[] = { "ready", "deferred" };
+
+struct DriverArgs {
+  int iterations;
+  size_t arglen;
+  SpawnPattern pattern;
+};
+
+static volatile int errors_seen = 0;
+
+// the args are a byte pattern seeded by their length, so both the size and
+//  the contents get checked
+static void fill_args(char *buffer, size_t arglen)
+{
+  for(size_t i = 0; i < arglen; i++)
+    buffer[i] = (char)(arglen + 3 * i);
+}
+
+void check_args_task(const void *args, size_t arglen, Processor p)
+{
+  const char *bytes = (const char *)args;
+  for(size_t i = 0; i < arglen; i++)
+    if(bytes[i] != (char)(arglen + 3 * i)) {
+      __sync_fetch_and_add(&errors_seen, 1);
+      break;
+    }
+}
+
+// each processor runs one driver which spawns its tasks back onto the same
+//  processor
+void driver_task(const void *args, size_t arglen, Processor p)
+{
+  assert(arglen == sizeof(DriverArgs));
+  const DriverArgs& d_args = *(const DriverArgs *)args;
+
+  std::vector<char> task_args(d_args.arglen + 1);
+  fill_args(&task_args[0], d_args.arglen);
+
+  UserEvent start = UserEvent::NO_USER_EVENT;
+  if(d_args.pattern == PATTERN_DEFERRED)
+    start = UserEvent::create_user_event();
+
+  std::set<Event> done;
+  for(int i = 0; i < d_args.iterations; i++)
+    done.insert(p.spawn(CHECK_ARGS_TASK, &task_args[0], d_args.arglen, start));
+
+  if(d_args.pattern == PATTERN_DEFERRED)
+    start.trigger();
+
+  Event::merge_events(done).wait();
+}
+
+static int max_procs = 64;
+static int num_iterations = 10000;
+static int timeout_seconds = 60;
+
+void top_level_task(const void *args, size_t arglen, Processor p)
+{
+  int errors = 0;
+
+  // this node's CPU processors only - one driver per processor
+  std::vector<Processor> cpus;
+  {
+    std::set<Processor> all_processors;
+    Machine::get_machine().get_all_processors(all_processors);
+    for(std::set<Processor>::const_iterator it = all_processors.begin();
+	it != all_processors.end();
+	it++)
+      if((it->kind() == Processor::LOC_PROC) &&
+	 (it->address_space() == p.address_space()))
+	cpus.push_back(*it);
+  }
+  assert(!cpus.empty());
+  int procs = std::min(max_procs, (int)cpus.size());
+
+  printf("Realm spawn benchmark - %d iterations, %d processors\n",
+	 num_iterations, procs);
+
+  // argument sizes from nothing, through typical meta-task args, to ones
+  //  that are too big to be stored inline
+  size_t arg_sizes[] = { 0, 16, 64, 256 };
+  for(int pattern = PATTERN_READY; pattern <= PATTERN_DEFERRED; pattern++) {
+    for(size_t i = 0; i < sizeof(arg_sizes) / sizeof(arg_sizes[0]); i++) {
+      // set the watchdog timeout before we do anything that could get stuck
+      alarm(timeout_seconds);
+
+      errors_seen = 0;
+
+      std::set<Event> finish_events;
+      double t_start = Clock::current_time();
+      for(int j = 0; j < procs; j++) {
+	DriverArgs d_args;
+	d_args.iterations = num_iterations;
+	d_args.arglen = arg_sizes[i];
+	d_args.pattern = (SpawnPattern)pattern;
+	finish_events.insert(cpus[j].spawn(DRIVER_TASK, &d_args, sizeof(d_args)));
+      }
+      Event::merge_events(finish_events).wait();
+      double elapsed = Clock::current_time() - t_start;
+
+      // turn off the watchdog timer
+      alarm(0);
+
+      printf("%-8s: args=%3zdB procs=%2d tasks/s=%8.3fM (total) time/task=%6.0fns (per proc)\n",
+	     pattern_names[pattern], arg_sizes[i], procs,
+	     1e-6 * procs * num_iterations / elapsed,
+	     1e9 * elapsed / num_iterations);
+
+      if(errors_seen > 0) {
+	printf("ERROR: %d tasks saw the wrong arguments\n", (int)errors_seen);
+	errors++;
+      }
+    }
+  }
+
+  if(errors > 0) {
+    printf("Exiting with errors\n");
+    exit(1);
+  }
+
+  printf("all done!\n");
+
+  Runtime::get_runtime().shutdown();
+}
+
+int main(int argc, char **argv)
+{
+  Runtime rt;
+
+  rt.init(&argc, &argv);
+
+  for(int i = 1; i < argc; i++) {
+    if(!strcmp(argv[i], "-i")) {
+      num_iterations = atoi(argv[++i]);
+      continue;
+    }
+
+    if(!strcmp(argv[i], "-t")) {
+      timeout_seconds = atoi(argv[++i]);
+      continue;
+    }
+
+    if(!strcmp(argv[i], "-procs")) {
+      max_procs = atoi(argv[++i]);
+      continue;
+    }
+  }
+
+  rt.register_task(TOP_LEVEL_TASK, top_level_task);
+  rt.register_task(DRIVER_TASK, driver_task);
+  rt.register_task(CHECK_ARGS_TASK, check_args_task);
+
+  signal(SIGALRM, sigalrm_handler);
+
+  // Start the machine running
+  // Control never returns from this call
+  // Note we only run the top level task on one processor
+  // You can also run the top level task on all processors or one processor per node
+  rt.run(TOP_LEVEL_TASK, Runtime::ONE_TASK_ONLY);
+
+  //rt.shutdown();
+  return 0;
+}
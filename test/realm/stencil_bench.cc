@@ -0,0 +1,303 @@
+#include "realm/realm.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cassert>
+#include <cstring>
+#include <csignal>
+
+#include <time.h>
+#include <unistd.h>
+
+using namespace Realm;
+using namespace LegionRuntime::Arrays;
+using namespace LegionRuntime::Accessor;
+
+// Task IDs, some IDs are reserved so start at first available number
+enum {
+  TOP_LEVEL_TASK = Processor::TASK_ID_FIRST_AVAILABLE+0,
+};
+
+// we're going to use alarm() as a watchdog to detect deadlocks
+void sigalrm_handler(int sig)
+{
+  fprintf(stderr, "HELP!  Alarm triggered - likely deadlock!\n");
+  exit(1);
+}
+
+typedef RegionAccessor<AccessorType::Generic, double> GenericAccessor;
+typedef RegionAccessor<AccessorType::Affine<3>, double> AffineAccessor;
+
+static inline double initial_value(const Point<3>& p)
+{
+  return p.x[0] + 7 * p.x[1] + 49 * p.x[2];
+}
+
+// 7-point stencil - the order of the additions is fixed so that every layout
+//  gets bit-identical answers
+template <typename ACC>
+static inline double stencil(const ACC& in, const Point<3>& p)
+{
+  double sum = in.read(p);
+  for(int i = 0; i < 3; i++) {
+    Point<3> q = p;
+    q.x[i] = p.x[i] - 1;
+    sum += in.read(q);
+    q.x[i] = p.x[i] + 1;
+    sum += in.read(q);
+  }
+  return sum * (1.0 / 7.0);
+}
+
+static double expected_value(const Point<3>& p)
+{
+  double sum = initial_value(p);
+  for(int i = 0; i < 3; i++) {
+    Point<3> q = p;
+    q.x[i] = p.x[i] - 1;
+    sum += initial_value(q);
+    q.x[i] = p.x[i] + 1;
+    sum += initial_value(q);
+  }
+  return sum * (1.0 / 7.0);
+}
+
+// reads points in an affine piece through the affine accessor, and any
+//  others (i.e. neighbors in the next tile) through the generic one
+struct PieceReader {
+  const AffineAccessor& affine;
+  const GenericAccessor& generic;
+  const Rect<3>& piece;
+
+  PieceReader(const AffineAccessor& _affine, const GenericAccessor& _generic,
+	      const Rect<3>& _piece)
+    : affine(_affine), generic(_generic), piece(_piece) {}
+
+  double read(const Point<3>& p) const
+  {
+    return piece.contains(p) ? affine.read(p) : generic.read(p);
+  }
+};
+
+// called by dispatch_accessor_subrects on the output field for each affine
+//  piece (a single piece for a linear instance, a tile for tiled ones) - the
+//  input field is in the same instance, so it's affine over the same piece
+struct StencilLoop {
+  const GenericAccessor *in_generic;
+  int pieces;
+
+  void operator()(const GenericAccessor& out, const Rect<3>& r)
+  {
+    pieces++;
+    for(GenericPointInRectIterator<3> pir(r); pir; pir++)
+      out.write(pir.p, stencil(*in_generic, pir.p));
+  }
+
+  void operator()(const AffineAccessor& out, const Rect<3>& r)
+  {
+    pieces++;
+    AffineAccessor in = in_generic->convert_affine<3>(r);
+    PieceReader reader(in, *in_generic, r);
+    // points whose neighbors are all in the piece use the affine accessor
+    //  directly, the ones on the faces check each neighbor
+    Rect<3> inner = r;
+    for(int i = 0; i < 3; i++) {
+      inner.lo.x[i]++;
+      inner.hi.x[i]--;
+    }
+    for(GenericPointInRectIterator<3> pir(r); pir; pir++)
+      if(inner.contains(pir.p))
+	out.write(pir.p, stencil(in, pir.p));
+      else
+	out.write(pir.p, stencil(reader, pir.p));
+  }
+};
+
+static int num_iterations = 10;
+static int elements_per_dim = 120;
+static int tile_elements = 16;
+static int timeout_seconds = 60;
+
+static void copy_field(const Domain& dom, RegionInstance src, RegionInstance dst, unsigned offset)
+{
+  std::vector<Domain::CopySrcDstField> srcs(1), dsts(1);
+  srcs[0] = Domain::CopySrcDstField(src, offset, sizeof(double));
+  dsts[0] = Domain::CopySrcDstField(dst, offset, sizeof(double));
+  dom.copy(srcs, dsts).wait();
+}
+
+static int run_order(Memory m, RegionInstance staging, InstanceOrder::Kind kind, const char *name)
+{
+  int errors = 0;
+
+  Rect<3> bounds(Point<3>::ZEROES(), Point<3>::ZEROES());
+  for(int i = 0; i < 3; i++)
+    bounds.hi.x[i] = elements_per_dim - 1;
+  Rect<3> interior = bounds;
+  for(int i = 0; i < 3; i++) {
+    interior.lo.x[i]++;
+    interior.hi.x[i]--;
+  }
+  Domain dom = Domain::from_rect<3>(bounds);
+
+  Point<3> tile;
+  for(int i = 0; i < 3; i++)
+    tile.x[i] = tile_elements;
+
+  // two SOA fields: input at offset 0, output after it
+  std::vector<size_t> field_sizes(2, sizeof(double));
+  RegionInstance inst = dom.create_instance(m, field_sizes, bounds.volume(),
+					    InstanceOrder(kind, DomainPoint::from_point<3>(tile)),
+					    ProfilingRequestSet());
+  assert(inst.exists());
+
+  GenericAccessor in = inst.get_accessor().get_untyped_field_accessor(0, sizeof(double)).typeify<double>();
+  GenericAccessor out = inst.get_accessor().get_untyped_field_accessor(sizeof(double), sizeof(double)).typeify<double>();
+
+  // set the watchdog timeout before we do anything that could get stuck
+  alarm(timeout_seconds);
+
+  // the input comes from the linear staging instance, which exercises the
+  //  DMA paths between linear and tiled layouts in both directions
+  copy_field(dom, staging, inst, 0);
+
+  const char *names[] = { "generic", "dispatch" };
+  for(int version = 0; version < 2; version++) {
+    for(GenericPointInRectIterator<3> pir(interior); pir; pir++)
+      out.write(pir.p, -1.0);
+
+    int pieces = 0;
+    // the generic version is much slower - don't wait for it as long
+    int iterations = (version == 0) ? std::max(1, num_iterations / 10) : num_iterations;
+    double t_start = Clock::current_time();
+    for(int i = 0; i < iterations; i++) {
+      StencilLoop loop;
+      loop.in_generic = &in;
+      loop.pieces = 0;
+      if(version == 0)
+	loop(out, interior);
+      else
+	dispatch_accessor_subrects(out, interior, loop);
+      pieces = loop.pieces;
+    }
+    double elapsed = Clock::current_time() - t_start;
+
+    copy_field(dom, inst, staging, sizeof(double));
+    GenericAccessor check = staging.get_accessor().get_untyped_field_accessor(sizeof(double), sizeof(double)).typeify<double>();
+    size_t mismatches = 0;
+    for(GenericPointInRectIterator<3> pir(interior); pir; pir++)
+      if(check.read(pir.p) != expected_value(pir.p))
+	mismatches++;
+
+    printf("%-6s %-8s: %6.2f ns/point (%d pieces)\n", name, names[version],
+	   1e9 * elapsed / ((double)iterations * interior.volume()), pieces);
+
+    if(mismatches > 0) {
+      printf("ERROR: %zd of %zd points wrong\n", mismatches, interior.volume());
+      errors++;
+    }
+  }
+
+  // turn off the watchdog timer
+  alarm(0);
+
+  inst.destroy();
+
+  return errors;
+}
+
+void top_level_task(const void *args, size_t arglen, Processor p)
+{
+  int errors = 0;
+
+  // any system memory on this node
+  Memory m = Memory::NO_MEMORY;
+  {
+    std::set<Memory> all_memories;
+    Machine::get_machine().get_all_memories(all_memories);
+    for(std::set<Memory>::const_iterator it = all_memories.begin();
+	it != all_memories.end();
+	it++)
+      if((it->kind() == Memory::SYSTEM_MEM) &&
+	 (it->address_space() == p.address_space())) {
+	m = *it;
+	break;
+      }
+  }
+  assert(m.exists());
+
+  printf("Realm stencil benchmark - %d iterations, %d^3 points, %d^3 tiles\n",
+	 num_iterations, elements_per_dim, tile_elements);
+
+  // a linear instance holds the initial values and receives each result
+  Rect<3> bounds(Point<3>::ZEROES(), Point<3>::ZEROES());
+  for(int i = 0; i < 3; i++)
+    bounds.hi.x[i] = elements_per_dim - 1;
+  std::vector<size_t> field_sizes(2, sizeof(double));
+  RegionInstance staging = Domain::from_rect<3>(bounds).create_instance(m, field_sizes,
+									  bounds.volume());
+  assert(staging.exists());
+  {
+    GenericAccessor in = staging.get_accessor().get_untyped_field_accessor(0, sizeof(double)).typeify<double>();
+    for(GenericPointInRectIterator<3> pir(bounds); pir; pir++)
+      in.write(pir.p, initial_value(pir.p));
+  }
+
+  errors += run_order(m, staging, InstanceOrder::LINEAR, "linear");
+  errors += run_order(m, staging, InstanceOrder::TILED, "tiled");
+  errors += run_order(m, staging, InstanceOrder::MORTON, "morton");
+
+  staging.destroy();
+
+  if(errors > 0) {
+    printf("Exiting with errors\n");
+    exit(1);
+  }
+
+  printf("all done!\n");
+
+  Runtime::get_runtime().shutdown();
+}
+
+int main(int argc, char **argv)
+{
+  Runtime rt;
+
+  rt.init(&argc, &argv);
+
+  for(int i = 1; i < argc; i++) {
+    if(!strcmp(argv[i], "-i")) {
+      num_iterations = atoi(argv[++i]);
+      continue;
+    }
+
+    if(!strcmp(argv[i], "-n")) {
+      elements_per_dim = atoi(argv[++i]);
+      continue;
+    }
+
+    if(!strcmp(argv[i], "-tile")) {
+      tile_elements = atoi(argv[++i]);
+      continue;
+    }
+
+    if(!strcmp(argv[i], "-t")) {
+      timeout_seconds = atoi(argv[++i]);
+      continue;
+    }
+  }
+  assert((elements_per_dim > 2) && (tile_elements > 0));
+
+  rt.register_task(TOP_LEVEL_TASK, top_level_task);
+
+  signal(SIGALRM, sigalrm_handler);
+
+  // Start the machine running
+  // Control never returns from this call
+  // Note we only run the top level task on one processor
+  // You can also run the top level task on all processors or one processor per node
+  rt.run(TOP_LEVEL_TASK, Runtime::ONE_TASK_ONLY);
+
+  //rt.shutdown();
+  return 0;
+}
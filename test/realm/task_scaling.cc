@@ -0,0 +1,182 @@
+#include "realm/realm.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cassert>
+#include <cstring>
+#include <csignal>
+
+#include <time.h>
+#include <unistd.h>
+
+using namespace Realm;
+
+// Task IDs, some IDs are reserved so start at first available number
+enum {
+  TOP_LEVEL_TASK = Processor::TASK_ID_FIRST_AVAILABLE+0,
+  DRIVER_TASK,
+  EMPTY_TASK,
+};
+
+// we're going to use alarm() as a watchdog to detect deadlocks
+void sigalrm_handler(int sig)
+{
+  fprintf(stderr, "HELP!  Alarm triggered - likely deadlock!\n");
+  exit(1);
+}
+
+enum SpawnPattern {
+  PATTERN_CHAIN,   // each task waits on the one before it
+  PATTERN_FANOUT,  // independent tasks, merged at the end
+  PATTERN_EVENTS,  // no tasks, just create/merge/trigger events
+};
+
+static const char *pattern_names[] = { "chain", "fanout", "events" };
+
+struct DriverArgs {
+  int iterations;
+  SpawnPattern pattern;
+};
+
+void empty_task(const void *args, size_t arglen, Processor p)
+{
+  // nothing to do - the spawn and completion overhead is what's measured
+}
+
+// each processor runs one driver which spawns its tasks back onto the same
+//  processor, so processors only share runtime state, not work
+void driver_task(const void *args, size_t arglen, Processor p)
+{
+  assert(arglen == sizeof(DriverArgs));
+  const DriverArgs& d_args = *(const DriverArgs *)args;
+
+  switch(d_args.pattern) {
+  case PATTERN_CHAIN:
+    {
+      Event prev = Event::NO_EVENT;
+      for(int i = 0; i < d_args.iterations; i++)
+	prev = p.spawn(EMPTY_TASK, 0, 0, prev);
+      prev.wait();
+      break;
+    }
+
+  case PATTERN_FANOUT:
+    {
+      std::set<Event> done;
+      for(int i = 0; i < d_args.iterations; i++)
+	done.insert(p.spawn(EMPTY_TASK, 0, 0));
+      Event::merge_events(done).wait();
+      break;
+    }
+
+  case PATTERN_EVENTS:
+    {
+      for(int i = 0; i < d_args.iterations; i++) {
+	UserEvent e1 = UserEvent::create_user_event();
+	UserEvent e2 = UserEvent::create_user_event();
+	Event merged = Event::merge_events(e1, e2);
+	e1.trigger();
+	e2.trigger();
+	if(!merged.has_triggered())
+	  merged.wait();
+      }
+      break;
+    }
+  }
+}
+
+static int max_procs = 64;
+static int num_iterations = 10000;
+static int timeout_seconds = 60;
+
+void top_level_task(const void *args, size_t arglen, Processor p)
+{
+  // this node's CPU processors only - one driver per processor
+  std::vector<Processor> cpus;
+  {
+    std::set<Processor> all_processors;
+    Machine::get_machine().get_all_processors(all_processors);
+    for(std::set<Processor>::const_iterator it = all_processors.begin();
+	it != all_processors.end();
+	it++)
+      if((it->kind() == Processor::LOC_PROC) &&
+	 (it->address_space() == p.address_space()))
+	cpus.push_back(*it);
+  }
+  assert(!cpus.empty());
+
+  printf("Realm task scaling benchmark - %d iterations, up to %d processors (%zd cpus)\n",
+	 num_iterations, max_procs, cpus.size());
+
+  for(int pattern = PATTERN_CHAIN; pattern <= PATTERN_EVENTS; pattern++) {
+    for(int procs = 1;
+	(procs <= max_procs) && (procs <= (int)cpus.size());
+	procs *= 2) {
+      // set the watchdog timeout before we do anything that could get stuck
+      alarm(timeout_seconds);
+
+      std::set<Event> finish_events;
+      double t_start = Clock::current_time();
+      for(int i = 0; i < procs; i++) {
+	DriverArgs d_args;
+	d_args.iterations = num_iterations;
+	d_args.pattern = (SpawnPattern)pattern;
+	finish_events.insert(cpus[i].spawn(DRIVER_TASK, &d_args, sizeof(d_args)));
+      }
+      Event::merge_events(finish_events).wait();
+      double t_end = Clock::current_time();
+
+      // turn off the watchdog timer
+      alarm(0);
+
+      double elapsed = t_end - t_start;
+      double rate = (double)procs * num_iterations / elapsed;
+      printf("%s: procs=%2d elapsed=%6.3fs ops/s=%8.3fM (total) time/op=%6.0fns (per proc)\n",
+	     pattern_names[pattern], procs, elapsed, rate * 1e-6,
+	     1e9 * elapsed / num_iterations);
+    }
+  }
+
+  printf("all done!\n");
+
+  Runtime::get_runtime().shutdown();
+}
+
+int main(int argc, char **argv)
+{
+  Runtime rt;
+
+  rt.init(&argc, &argv);
+
+  for(int i = 1; i < argc; i++) {
+    if(!strcmp(argv[i], "-i")) {
+      num_iterations = atoi(argv[++i]);
+      continue;
+    }
+
+    if(!strcmp(argv[i], "-t")) {
+      timeout_seconds = atoi(argv[++i]);
+      continue;
+    }
+
+    if(!strcmp(argv[i], "-procs")) {
+      max_procs = atoi(argv[++i]);
+      continue;
+    }
+  }
+
+  rt.register_task(TOP_LEVEL_TASK, top_level_task);
+  rt.register_task(DRIVER_TASK, driver_task);
+  rt.register_task(EMPTY_TASK, empty_task);
+
+  signal(SIGALRM, sigalrm_handler);
+
+  // Start the machine running
+  // Control never returns from this call
+  // Note we only run the top level task on one processor
+  // You can also run the top level task on all processors or one processor per node
+  rt.run(TOP_LEVEL_TASK, Runtime::ONE_TASK_ONLY);
+
+  //rt.shutdown();
+  return 0;
+}
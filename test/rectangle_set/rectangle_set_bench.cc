@@ -0,0 +1,311 @@
+/* Copyright 2015 Stanford University
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <cstdio>
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include "legion.h"
+#include "rectangle_set.h"
+#include "sweep_rectangle_set.h"
+using namespace LegionRuntime::HighLevel;
+using namespace LegionRuntime::Arrays;
+
+/*
+ * Microbenchmark for the rectangle set used to test whether
+ * a set of domains dominates another.  The workloads model
+ * the ghost regions of a blocked stencil code on a grid that
+ * is split into blocks along each dimension:
+ *
+ *   halo:   the blocks must cover each block grown by the
+ *           ghost width (clipped to the grid)
+ *   ghost:  the boundary slabs of the blocks, i.e. the
+ *           shared pieces, must cover the ghost slabs of
+ *           each block's neighbors
+ *   holes:  the halo test with every seventh block missing,
+ *           so many of the queries are not covered
+ *
+ * Every answer is checked against a brute force subtraction
+ * of all the left rectangles, which is also timed as the
+ * baseline.  The 2D workloads are also run through the old
+ * segment sweep set (sweep_rectangle_set.h) that the N-d
+ * index replaced, which only handled two dimensions, as
+ * long as they have at most -sweep left rectangles.
+ */
+
+template<unsigned DIM>
+static Rect<DIM> clip(Rect<DIM> rect, int grid)
+{
+  for (unsigned d = 0; d < DIM; d++)
+  {
+    rect.lo.x[d] = std::max(rect.lo.x[d], 0);
+    rect.hi.x[d] = std::min(rect.hi.x[d], grid - 1);
+  }
+  return rect;
+}
+
+template<unsigned DIM>
+static void make_blocks(std::vector<Rect<DIM> > &blocks, int grid, int nblocks)
+{
+  const int size = (grid + nblocks - 1) / nblocks;
+  int total = 1;
+  for (unsigned d = 0; d < DIM; d++)
+    total *= nblocks;
+  for (int b = 0; b < total; b++)
+  {
+    Rect<DIM> rect;
+    int index = b;
+    for (unsigned d = 0; d < DIM; d++)
+    {
+      const int coord = index % nblocks;
+      index /= nblocks;
+      rect.lo.x[d] = coord * size;
+      rect.hi.x[d] = std::min((coord + 1) * size, grid) - 1;
+    }
+    if (rect.volume() > 0)
+      blocks.push_back(rect);
+  }
+}
+
+// The slabs of width 'ghost' just inside (inside == true) or just
+// outside each face of the block
+template<unsigned DIM>
+static void make_slabs(const Rect<DIM> &block, int ghost, bool inside,
+                       int grid, std::vector<Rect<DIM> > &slabs)
+{
+  for (unsigned d = 0; d < DIM; d++)
+  {
+    Rect<DIM> below = block, above = block;
+    if (inside)
+    {
+      below.hi.x[d] = std::min(block.lo.x[d] + ghost - 1, block.hi.x[d]);
+      above.lo.x[d] = std::max(block.hi.x[d] - ghost + 1, block.lo.x[d]);
+    }
+    else
+    {
+      below.lo.x[d] = block.lo.x[d] - ghost;
+      below.hi.x[d] = block.lo.x[d] - 1;
+      above.lo.x[d] = block.hi.x[d] + 1;
+      above.hi.x[d] = block.hi.x[d] + ghost;
+    }
+    below = clip(below, grid);
+    above = clip(above, grid);
+    if (below.volume() > 0)
+      slabs.push_back(below);
+    if (above.volume() > 0)
+      slabs.push_back(above);
+  }
+}
+
+template<unsigned DIM>
+static bool brute_force_covers(const std::vector<Rect<DIM> > &left,
+                               const Rect<DIM> &rect)
+{
+  std::vector<Rect<DIM> > pieces(1, rect);
+  for (unsigned i = 0; (i < left.size()) && !pieces.empty(); i++)
+  {
+    std::vector<Rect<DIM> > remaining;
+    for (unsigned p = 0; p < pieces.size(); p++)
+    {
+      if (!pieces[p].overlaps(left[i]))
+      {
+        remaining.push_back(pieces[p]);
+        continue;
+      }
+      Rect<DIM> rest = pieces[p];
+      for (unsigned d = 0; d < DIM; d++)
+      {
+        if (rest.lo.x[d] < left[i].lo.x[d])
+        {
+          Rect<DIM> below = rest;
+          below.hi.x[d] = left[i].lo.x[d] - 1;
+          remaining.push_back(below);
+          rest.lo.x[d] = left[i].lo.x[d];
+        }
+        if (left[i].hi.x[d] < rest.hi.x[d])
+        {
+          Rect<DIM> above = rest;
+          above.lo.x[d] = left[i].hi.x[d] + 1;
+          remaining.push_back(above);
+          rest.hi.x[d] = left[i].hi.x[d];
+        }
+      }
+    }
+    pieces.swap(remaining);
+  }
+  return pieces.empty();
+}
+
+// The old sweep is quadratic or worse on some workloads so it
+// is skipped for sets with more than this many left rectangles
+static unsigned max_sweep_rects = 1024;
+
+// Only the 2D workloads can be run through the old sweep
+template<unsigned DIM>
+static bool run_sweep(const std::vector<Rect<DIM> > &left,
+                      const std::vector<Rect<DIM> > &right,
+                      const std::vector<bool> &answers, double &elapsed)
+{
+  return false;
+}
+
+template<>
+bool run_sweep<2>(const std::vector<Rect<2> > &left,
+                  const std::vector<Rect<2> > &right,
+                  const std::vector<bool> &answers, double &elapsed)
+{
+  if (left.size() > max_sweep_rects)
+    return false;
+  double t_start = Realm::Clock::current_time();
+  LegionRuntime::SweepBaseline::RectangleSet<int,true/*discrete*/> 
+    rectangles;
+  for (unsigned i = 0; i < left.size(); i++)
+    rectangles.add_rectangle(left[i].lo.x[0], left[i].lo.x[1],
+                             left[i].hi.x[0], left[i].hi.x[1]);
+  bool agree = true;
+  for (unsigned i = 0; i < right.size(); i++)
+  {
+    if (rectangles.covers(right[i].lo.x[0], right[i].lo.x[1],
+                          right[i].hi.x[0], right[i].hi.x[1]) != answers[i])
+      agree = false;
+  }
+  elapsed = Realm::Clock::current_time() - t_start;
+  if (!agree)
+    printf("\nWARNING: 2D sweep answers disagree with the index");
+  return true;
+}
+
+template<unsigned DIM>
+static bool run_workload(const char *name, const std::vector<Rect<DIM> > &left,
+                         const std::vector<Rect<DIM> > &right, bool baseline)
+{
+  double t_start = Realm::Clock::current_time();
+  RectangleSet<DIM> rectangles;
+  for (unsigned i = 0; i < left.size(); i++)
+    rectangles.add_rectangle(left[i]);
+  std::vector<bool> answers(right.size());
+  unsigned covered = 0;
+  for (unsigned i = 0; i < right.size(); i++)
+  {
+    answers[i] = rectangles.covers(right[i]);
+    if (answers[i])
+      covered++;
+  }
+  double t_index = Realm::Clock::current_time() - t_start;
+  printf("%dD %-6s left=%6zd right=%6zd covered=%6d boxes=%6zd "
+         "index=%9.3fms", DIM, name, left.size(), right.size(), covered,
+         rectangles.size(), t_index * 1e3);
+  if (!baseline)
+  {
+    printf("\n");
+    return true;
+  }
+  double t_sweep;
+  if (run_sweep(left, right, answers, t_sweep))
+    printf(" sweep=%9.3fms (%5.1fx)", t_sweep * 1e3, t_sweep / t_index);
+  t_start = Realm::Clock::current_time();
+  bool agree = true;
+  for (unsigned i = 0; i < right.size(); i++)
+  {
+    if (brute_force_covers(left, right[i]) != answers[i])
+      agree = false;
+  }
+  double t_brute = Realm::Clock::current_time() - t_start;
+  printf(" brute force=%9.3fms\n", t_brute * 1e3);
+  if (!agree)
+    printf("ERROR: %dD %s answers disagree with brute force\n", DIM, name);
+  return agree;
+}
+
+template<unsigned DIM>
+static bool run_ghost_workloads(int grid, int nblocks, int ghost,
+                                bool baseline)
+{
+  std::vector<Rect<DIM> > blocks;
+  make_blocks(blocks, grid, nblocks);
+  bool success = true;
+  // halo
+  {
+    std::vector<Rect<DIM> > halos;
+    for (unsigned i = 0; i < blocks.size(); i++)
+    {
+      Rect<DIM> halo = blocks[i];
+      for (unsigned d = 0; d < DIM; d++)
+      {
+        halo.lo.x[d] -= ghost;
+        halo.hi.x[d] += ghost;
+      }
+      halos.push_back(clip(halo, grid));
+    }
+    success = run_workload("halo", blocks, halos, baseline) && success;
+    // holes
+    std::vector<Rect<DIM> > some_blocks;
+    for (unsigned i = 0; i < blocks.size(); i++)
+      if ((i % 7) != 3)
+        some_blocks.push_back(blocks[i]);
+    success = run_workload("holes", some_blocks, halos, baseline) && success;
+  }
+  // ghost
+  {
+    std::vector<Rect<DIM> > shared, ghosts;
+    for (unsigned i = 0; i < blocks.size(); i++)
+    {
+      make_slabs(blocks[i], ghost, true/*inside*/, grid, shared);
+      make_slabs(blocks[i], ghost, false/*inside*/, grid, ghosts);
+    }
+    success = run_workload("ghost", shared, ghosts, baseline) && success;
+  }
+  return success;
+}
+
+int main(int argc, char **argv)
+{
+  int grid = 1024;
+  int nblocks = 32;
+  int ghost = 2;
+  bool baseline = true;
+  for (int i = 1; i < argc; i++)
+  {
+    if (!strcmp(argv[i],"-g"))
+      grid = atoi(argv[++i]);
+    if (!strcmp(argv[i],"-b"))
+      nblocks = atoi(argv[++i]);
+    if (!strcmp(argv[i],"-ghost"))
+      ghost = atoi(argv[++i]);
+    if (!strcmp(argv[i],"-nobase"))
+      baseline = false;
+    if (!strcmp(argv[i],"-sweep"))
+      max_sweep_rects = atoi(argv[++i]);
+  }
+  assert((nblocks > 0) && (ghost > 0) && (grid >= nblocks));
+
+  printf("Rectangle set benchmark - grid=%d blocks=%d ghost=%d\n",
+         grid, nblocks, ghost);
+  bool success = true;
+  success = run_ghost_workloads<1>(grid * grid, nblocks * nblocks,
+                                   ghost, baseline) && success;
+  success = run_ghost_workloads<2>(grid, nblocks, ghost, baseline) && success;
+  // Keep the number of 3D blocks in the same ballpark
+  int blocks3 = 1;
+  while (((blocks3+1) * (blocks3+1) * (blocks3+1)) <= (nblocks * nblocks))
+    blocks3++;
+  success = run_ghost_workloads<3>(grid, blocks3, ghost, baseline) && success;
+  if (!success)
+    exit(1);
+  printf("all done!\n");
+  return 0;
+}
@@ -13,163 +13,429 @@
  * limitations under the License.
  */
 
+// Offline analysis of Realm event graphs.  Accepts any mix of:
+//  - text dumps of pending events ("PRINTING ALL PENDING EVENTS:" ... "DONE")
+//  - binary event graph histories (<prefix>_<node>.evg) written by a runtime
+//     run with -ll:eventgraph <records> -ll:eventgraph_file <prefix>
+//
+// and reports the stalled events at the root of anything that is still being
+// waited on, any dependence loops, and (for binary histories) the critical
+// path into the most recent trigger.
+//
+// usage: detect_loops [-p <path length>] files...
+//
+// Events are kept in flat arrays indexed through an open-addressing hash of
+// (id, gen), edges in compressed (CSR) form, and all graph walks are
+// iterative, so histories of 10^8 records are fine given the memory.
+
 #include <stdio.h>
 #include <assert.h>
 #include <string.h>
 #include <stdlib.h>
+#include <algorithm>
 #include <map>
-#include <set>
+#include <utility>
 #include <vector>
 
-class Event {
+// must match Realm::EventGraphRecorder::Record (realm/event_impl.h)
+struct GraphRecord {
+  unsigned long long seq;
+  long long time_ns;
+  unsigned long long event_id, other_id;
+  unsigned event_gen, other_gen;
+  unsigned kind, node;
+};
+
+enum RecordKind {
+  REC_TRIGGER = 0,
+  REC_MERGE = 1,
+  REC_TASK = 2,
+  REC_COPY = 3,
+  REC_USER = 4,
+  REC_ARRIVAL = 5,
+  REC_WAITER = 6,
+  REC_UNKNOWN = 7,
+};
+
+static const char *kind_names[] = { "trigger", "merge", "task", "copy",
+                                    "user event", "barrier arrival",
+                                    "waiter", "unknown" };
+
+static const unsigned NO_INDEX = ~0U;
+
+class EventGraph {
  public:
-  static Event *get_event(unsigned long long ev_id, unsigned gen);
-  static void link_events(Event *p, Event *s);
+  EventGraph(void);
+
+  // returns the dense index for an event, creating it if needed
+  unsigned get_event(unsigned long long ev_id, unsigned gen);
+
+  // 'succ' can't trigger until 'pred' has
+  void link_events(unsigned pred, unsigned succ);
 
-  static int count_stalled(void);
-  static void find_loops(void);
+  void set_desc(unsigned e, const char *s);
+  void set_kind(unsigned e, unsigned k);
+  void add_waiter(unsigned e);
 
-  void set_desc(const char *s);
-  void add_waiting_thread(unsigned long long thr_id);
+  // builds the adjacency arrays - call once all events and links are in
+  void finalize(void);
 
-  unsigned long long id;
-  unsigned gen;
-  std::set<Event *> preds, succs;
-  std::vector<unsigned long long> threads;
-  char *desc;
-  bool visited;
+  bool triggered(unsigned e) const { return trigger_time[e] >= 0; }
+  size_t size(void) const { return ids.size(); }
+  size_t num_edges(void) const { return pred_list.size(); }
 
-  static std::map<unsigned long long, std::map<unsigned, Event *> *> events;
+  void print_event(unsigned e) const;
+
+  int count_stalled(void) const;
+  void find_roots(size_t max_print) const;
+  void find_loops(size_t max_print) const;
+  void critical_path(size_t max_steps) const;
+
+  std::vector<unsigned long long> ids;
+  std::vector<unsigned> gens;
+  std::vector<long long> trigger_time;  // -1 if not known to have triggered
+  std::vector<unsigned char> kinds;
+  std::vector<unsigned> waiters;
+  std::map<unsigned, char *> descs;     // only from text dumps
+
+  // CSR adjacency: preds of e are pred_list[pred_start[e]..pred_start[e+1])
+  std::vector<size_t> pred_start, succ_start;
+  std::vector<unsigned> pred_list, succ_list;
 
  protected:
-  Event(unsigned long long _id, unsigned _gen);
+  void grow_table(void);
+
+  std::vector<unsigned> table;   // hash slot -> event index (NO_INDEX == empty)
+  std::vector<std::pair<unsigned, unsigned> > edges;
 };
 
-std::map<unsigned long long, std::map<unsigned, Event *> *> Event::events;
+static inline size_t hash_event(unsigned long long ev_id, unsigned gen)
+{
+  unsigned long long h = (ev_id ^ ((unsigned long long)gen << 40) ^ gen) * 0x9E3779B97F4A7C15ULL;
+  return (size_t)(h ^ (h >> 29));
+}
 
-Event::Event(unsigned long long _id, unsigned _gen)
-  : id(_id), gen(_gen), desc(0) {}
+EventGraph::EventGraph(void)
+  : table(1 << 16, NO_INDEX)
+{}
 
-/*static*/ Event *Event::get_event(unsigned long long ev_id, unsigned gen)
+void EventGraph::grow_table(void)
 {
-  std::map<unsigned, Event *> *gens;
-  std::map<unsigned long long, std::map<unsigned, Event *> *>::iterator it = events.find(ev_id);
-  if(it == events.end()) {
-    gens = new std::map<unsigned, Event *>;
-    events[ev_id] = gens;
-  } else {
-    gens = it->second;
+  std::vector<unsigned> new_table(table.size() * 2, NO_INDEX);
+  size_t mask = new_table.size() - 1;
+  for(unsigned e = 0; e < ids.size(); e++) {
+    size_t slot = hash_event(ids[e], gens[e]) & mask;
+    while(new_table[slot] != NO_INDEX)
+      slot = (slot + 1) & mask;
+    new_table[slot] = e;
   }
+  table.swap(new_table);
+}
 
-  std::map<unsigned, Event *>::iterator it2 = gens->find(gen);
-  if(it2 == gens->end()) {
-    Event *e = new Event(ev_id, gen);
-    (*gens)[gen] = e;
-    return e;
-  } else {
-    return it2->second;
+unsigned EventGraph::get_event(unsigned long long ev_id, unsigned gen)
+{
+  size_t mask = table.size() - 1;
+  size_t slot = hash_event(ev_id, gen) & mask;
+  while(table[slot] != NO_INDEX) {
+    unsigned e = table[slot];
+    if((ids[e] == ev_id) && (gens[e] == gen))
+      return e;
+    slot = (slot + 1) & mask;
   }
+
+  unsigned e = ids.size();
+  assert(e != NO_INDEX);
+  ids.push_back(ev_id);
+  gens.push_back(gen);
+  trigger_time.push_back(-1);
+  kinds.push_back(REC_UNKNOWN);
+  waiters.push_back(0);
+  table[slot] = e;
+  // keep the load factor at or below 1/2
+  if((ids.size() * 2) > table.size())
+    grow_table();
+  return e;
 }
 
-/*static*/ void Event::link_events(Event *p, Event *s)
+void EventGraph::link_events(unsigned pred, unsigned succ)
 {
-  //printf("%x/%d -> %x/%d\n", p->id, p->gen, s->id, s->gen);
-  assert(p->succs.find(s) == p->succs.end());
-  assert(s->preds.find(p) == s->preds.end());
-
-  p->succs.insert(s);
-  s->preds.insert(p);
+  edges.push_back(std::make_pair(pred, succ));
 }
 
-void Event::set_desc(const char *s)
+void EventGraph::set_desc(unsigned e, const char *s)
 {
-  if(desc != 0) {
-    assert(!strcmp(desc, s));
+  if(descs.find(e) != descs.end())
     return;
+  descs[e] = strdup(s);
+}
+
+void EventGraph::set_kind(unsigned e, unsigned k)
+{
+  if(kinds[e] == REC_UNKNOWN)
+    kinds[e] = k;
+}
+
+void EventGraph::add_waiter(unsigned e)
+{
+  waiters[e]++;
+}
+
+void EventGraph::finalize(void)
+{
+  // duplicate links (e.g. a merge listing the same input twice) only count once
+  std::sort(edges.begin(), edges.end());
+  edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+  size_t n = ids.size();
+  pred_start.assign(n + 1, 0);
+  succ_start.assign(n + 1, 0);
+  for(size_t i = 0; i < edges.size(); i++) {
+    pred_start[edges[i].second + 1]++;
+    succ_start[edges[i].first + 1]++;
+  }
+  for(size_t i = 0; i < n; i++) {
+    pred_start[i + 1] += pred_start[i];
+    succ_start[i + 1] += succ_start[i];
+  }
+  pred_list.resize(edges.size());
+  succ_list.resize(edges.size());
+  std::vector<size_t> pred_pos(pred_start.begin(), pred_start.end() - 1);
+  std::vector<size_t> succ_pos(succ_start.begin(), succ_start.end() - 1);
+  for(size_t i = 0; i < edges.size(); i++) {
+    pred_list[pred_pos[edges[i].second]++] = edges[i].first;
+    succ_list[succ_pos[edges[i].first]++] = edges[i].second;
   }
-  desc = strdup(s);
+  std::vector<std::pair<unsigned, unsigned> >().swap(edges);
 }
 
-void Event::add_waiting_thread(unsigned long long thr_id)
+void EventGraph::print_event(unsigned e) const
 {
-  threads.push_back(thr_id);
+  std::map<unsigned, char *>::const_iterator it = descs.find(e);
+  printf("  %llx/%d: (%3zd/%3zd) %s", ids[e], gens[e],
+         pred_start[e + 1] - pred_start[e], succ_start[e + 1] - succ_start[e],
+         kind_names[kinds[e]]);
+  if(waiters[e] > 0)
+    printf(", %d waiter(s)", waiters[e]);
+  if(it != descs.end())
+    printf(": %s", it->second);
+  else
+    printf("\n");
 }
 
-/*static*/ int Event::count_stalled(void)
+// untriggered events that aren't waiting on any other untriggered event
+int EventGraph::count_stalled(void) const
 {
   int count = 0;
-  for(std::map<unsigned long long, std::map<unsigned, Event *> *>::iterator it = events.begin();
-      it != events.end();
-      it++) {
-    for(std::map<unsigned, Event *>::iterator it2 = it->second->begin();
-        it2 != it->second->end();
-        it2++) {
-      Event *e = it2->second;
-      if(e->preds.empty()) {
-        //printf("Event with no preds: %x/%d: %s\n", e->id, e->gen, e->desc);
-        count++;
-      }
-    }
+  for(unsigned e = 0; e < ids.size(); e++) {
+    if(triggered(e)) continue;
+    bool blocked = false;
+    for(size_t i = pred_start[e]; !blocked && (i < pred_start[e + 1]); i++)
+      if(!triggered(pred_list[i]))
+        blocked = true;
+    if(!blocked)
+      count++;
   }
   return count;
 }
 
-static void walk_tree(Event *e, std::vector<Event *>& stack)
+// walks back from everything with waiters to the stalled events holding it up
+void EventGraph::find_roots(size_t max_print) const
 {
-  if(e->visited) return;
-
-  for(std::vector<Event *>::iterator it = stack.begin(); it != stack.end(); it++)
-    if(*it == e) {
-      // LOOP!
-      printf("LOOP DETECTED!\n");
-      std::vector<Event *>::reverse_iterator it = stack.rbegin();
-      do {
-        printf("  %llx/%d: (%3zd/%3zd) %s", 
-               (*it)->id, (*it)->gen, (*it)->preds.size(), (*it)->succs.size(), (*it)->desc);
-        if(*it == e) return;
-        it++;
-      } while(1);
-      e->visited = true;
-      return;
+  std::vector<char> visited(ids.size(), 0);
+  std::vector<unsigned> worklist;
+  for(unsigned e = 0; e < ids.size(); e++)
+    if((waiters[e] > 0) && !triggered(e)) {
+      visited[e] = 1;
+      worklist.push_back(e);
+    }
+  if(worklist.empty()) return;
+
+  printf("%zd waited-on events, root blockers:\n", worklist.size());
+  size_t roots = 0;
+  while(!worklist.empty()) {
+    unsigned e = worklist.back();
+    worklist.pop_back();
+    bool blocked = false;
+    for(size_t i = pred_start[e]; i < pred_start[e + 1]; i++) {
+      unsigned p = pred_list[i];
+      if(triggered(p)) continue;
+      blocked = true;
+      if(!visited[p]) {
+        visited[p] = 1;
+        worklist.push_back(p);
+      }
     }
+    if(!blocked) {
+      if(roots < max_print)
+        print_event(e);
+      roots++;
+    }
+  }
+  if(roots > max_print)
+    printf("  ... and %zd more\n", roots - max_print);
+}
 
-  // if we're here, no loops, so put ourselves on the stack and keep searching
-  stack.push_back(e);
+// Tarjan's strongly connected components over the untriggered events, using
+//  an explicit stack - any component with more than one event is a loop
+void EventGraph::find_loops(size_t max_print) const
+{
+  size_t n = ids.size();
+  std::vector<unsigned> index(n, NO_INDEX), lowlink(n, 0);
+  std::vector<char> on_stack(n, 0);
+  std::vector<unsigned> scc_stack;
+  std::vector<std::pair<unsigned, size_t> > call_stack;  // (event, next pred)
+  unsigned next_index = 0;
+  int loops = 0;
+
+  for(unsigned root = 0; root < n; root++) {
+    if((index[root] != NO_INDEX) || triggered(root)) continue;
+
+    call_stack.push_back(std::make_pair(root, pred_start[root]));
+    index[root] = lowlink[root] = next_index++;
+    scc_stack.push_back(root);
+    on_stack[root] = 1;
+
+    while(!call_stack.empty()) {
+      unsigned e = call_stack.back().first;
+      size_t& pos = call_stack.back().second;
+      if(pos < pred_start[e + 1]) {
+        unsigned p = pred_list[pos++];
+        if(triggered(p)) continue;
+        if(index[p] == NO_INDEX) {
+          index[p] = lowlink[p] = next_index++;
+          scc_stack.push_back(p);
+          on_stack[p] = 1;
+          call_stack.push_back(std::make_pair(p, pred_start[p]));
+        } else if(on_stack[p]) {
+          lowlink[e] = std::min(lowlink[e], index[p]);
+        }
+        continue;
+      }
 
-  for(std::set<Event *>::iterator it = e->preds.begin();
-      it != e->preds.end();
-      it++)
-    walk_tree(*it, stack);
+      // all preds done - pop, and emit a component if this is its root
+      call_stack.pop_back();
+      if(!call_stack.empty()) {
+        unsigned parent = call_stack.back().first;
+        lowlink[parent] = std::min(lowlink[parent], lowlink[e]);
+      }
+      if(lowlink[e] != index[e]) continue;
 
-  // done, now take ourselves off the stack and mark ourselves visited
-  stack.pop_back();
-  e->visited = true;
+      size_t count = 0;
+      size_t first = scc_stack.size();
+      do {
+        first--;
+        count++;
+      } while(scc_stack[first] != e);
+      bool self_loop = false;
+      if(count == 1)
+        for(size_t i = pred_start[e]; i < pred_start[e + 1]; i++)
+          if(pred_list[i] == e) self_loop = true;
+      if((count > 1) || self_loop) {
+        printf("LOOP DETECTED! (%zd events)\n", count);
+        for(size_t i = 0; (i < count) && (i < max_print); i++)
+          print_event(scc_stack[scc_stack.size() - 1 - i]);
+        if(count > max_print)
+          printf("  ... and %zd more\n", count - max_print);
+        loops++;
+      }
+      for(size_t i = first; i < scc_stack.size(); i++)
+        on_stack[scc_stack[i]] = 0;
+      scc_stack.resize(first);
+    }
+  }
+  printf("%d loop(s) found\n", loops);
 }
 
-/*static*/ void Event::find_loops(void)
+// walks back from the most recently triggered event, always through the
+//  precondition that triggered last, and sums up where the time went
+void EventGraph::critical_path(size_t max_steps) const
 {
-  for(std::map<unsigned long long, std::map<unsigned, Event *> *>::iterator it = events.begin();
-      it != events.end();
-      it++) {
-    for(std::map<unsigned, Event *>::iterator it2 = it->second->begin();
-        it2 != it->second->end();
-        it2++) {
-      it2->second->visited = false;
+  unsigned cur = NO_INDEX;
+  for(unsigned e = 0; e < ids.size(); e++)
+    if(triggered(e) && ((cur == NO_INDEX) || (trigger_time[e] > trigger_time[cur])))
+      cur = e;
+  if(cur == NO_INDEX) return;
+
+  printf("CRITICAL PATH (most recent first):\n");
+  long long per_kind[REC_UNKNOWN + 1];
+  for(int k = 0; k <= REC_UNKNOWN; k++) per_kind[k] = 0;
+  long long end_time = trigger_time[cur];
+  long long start_time = end_time;
+  for(size_t step = 0; step < max_steps; step++) {
+    unsigned best = NO_INDEX;
+    for(size_t i = pred_start[cur]; i < pred_start[cur + 1]; i++) {
+      unsigned p = pred_list[i];
+      if(triggered(p) && ((best == NO_INDEX) || (trigger_time[p] > trigger_time[best])))
+        best = p;
     }
+    if(best == NO_INDEX) {
+      printf("  %llx/%d (%s) triggered at %lld ns\n", ids[cur], gens[cur],
+             kind_names[kinds[cur]], trigger_time[cur]);
+      break;
+    }
+    long long gap = trigger_time[cur] - trigger_time[best];
+    per_kind[kinds[cur]] += gap;
+    printf("  %llx/%d (%s) triggered at %lld ns, %lld ns after %llx/%d\n",
+           ids[cur], gens[cur], kind_names[kinds[cur]], trigger_time[cur],
+           gap, ids[best], gens[best]);
+    cur = best;
+    start_time = trigger_time[cur];
+  }
+  printf("  %lld ns on path:", end_time - start_time);
+  for(int k = 0; k <= REC_UNKNOWN; k++)
+    if(per_kind[k] > 0)
+      printf(" %s=%lld", kind_names[k], per_kind[k]);
+  printf("\n");
+}
+
+static const char graph_magic[8] = { 'R','E','V','N','T','G','R','F' };
+
+int read_graph(FILE *f, EventGraph& graph)
+{
+  unsigned header[2];
+  unsigned long long count;
+  if((fread(header, sizeof(header), 1, f) != 1) ||
+     (fread(&count, sizeof(count), 1, f) != 1)) {
+    printf("WARNING: Unexpected EOF\n");
+    return 0;
+  }
+  if(header[0] != 1) {
+    printf("WARNING: unknown event graph version %d\n", header[0]);
+    return 0;
   }
-  for(std::map<unsigned long long, std::map<unsigned, Event *> *>::iterator it = events.begin();
-      it != events.end();
-      it++) {
-    for(std::map<unsigned, Event *>::iterator it2 = it->second->begin();
-        it2 != it->second->end();
-        it2++) {
-      std::vector<Event *> stack;
-      walk_tree(it2->second, stack);
+  printf("node %d: %lld records\n", header[1], count);
+
+  std::vector<GraphRecord> chunk(1 << 20);
+  while(count > 0) {
+    size_t want = std::min((unsigned long long)chunk.size(), count);
+    size_t got = fread(&chunk[0], sizeof(GraphRecord), want, f);
+    for(size_t i = 0; i < got; i++) {
+      const GraphRecord& r = chunk[i];
+      unsigned e = graph.get_event(r.event_id, r.event_gen);
+      switch(r.kind) {
+      case REC_TRIGGER:
+        graph.trigger_time[e] = r.time_ns;
+        break;
+      case REC_WAITER:
+        graph.add_waiter(e);
+        break;
+      default:
+        graph.set_kind(e, (r.kind < REC_UNKNOWN) ? r.kind : REC_UNKNOWN);
+        if(r.other_id != 0)
+          graph.link_events(graph.get_event(r.other_id, r.other_gen), e);
+        break;
+      }
     }
+    if(got < want) {
+      printf("WARNING: Unexpected EOF\n");
+      return 0;
+    }
+    count -= got;
   }
+  return 1;
 }
 
-int read_events(FILE *f)
+int read_events(FILE *f, EventGraph& graph)
 {
   char line[256];
   // skip to beginning of events section
@@ -192,7 +458,7 @@ int read_events(FILE *f)
     // Event 20000003: gen=110 subscr=0 local=1 remote=1
     unsigned long long ev_id;
     unsigned gen, subscr, nlocal, nremote;
-    int ret = sscanf(s, "Barrier %llx: gen=%d subscr=%d", 
+    int ret = sscanf(s, "Barrier %llx: gen=%d subscr=%d",
                      &ev_id, &gen, &subscr);
     if (ret != 3) {
       ret = sscanf(s, "Event %llx: gen=%d subscr=%d local=%d remote=%d",
@@ -216,10 +482,11 @@ int read_events(FILE *f)
         int ret = sscanf(s, "  [%d] L:%*p %nutility thread for processor %x: after=%llx/%d",
                          &wgen, &pos, &proc_id, &ev2_id, &gen2);
         if(ret == 4) {
-          Event *e1 = Event::get_event(ev_id, wgen);
-          Event *e2 = Event::get_event(ev2_id, gen2);
-          Event::link_events(e1, e2);
-          e2->set_desc(s + pos);
+          unsigned e1 = graph.get_event(ev_id, wgen);
+          unsigned e2 = graph.get_event(ev2_id, gen2);
+          graph.link_events(e1, e2);
+          graph.set_kind(e2, REC_TASK);
+          graph.set_desc(e2, s + pos);
           continue;
         }
       }
@@ -230,10 +497,11 @@ int read_events(FILE *f)
         int ret = sscanf(s, "  [%d] L:%*p %nevent merger: %llx/%d",
                          &wgen, &pos, &ev2_id, &gen2);
         if(ret == 3) {
-          Event *e1 = Event::get_event(ev_id, wgen);
-          Event *e2 = Event::get_event(ev2_id, gen2);
-          Event::link_events(e1, e2);
-          e2->set_desc(s + pos);
+          unsigned e1 = graph.get_event(ev_id, wgen);
+          unsigned e2 = graph.get_event(ev2_id, gen2);
+          graph.link_events(e1, e2);
+          graph.set_kind(e2, REC_MERGE);
+          graph.set_desc(e2, s + pos);
           continue;
         }
       }
@@ -244,10 +512,11 @@ int read_events(FILE *f)
         int ret = sscanf(s, "  [%d] L:%*p %ndeferred trigger: after=%llx/%d",
                          &wgen, &pos, &ev2_id, &gen2);
         if(ret == 3) {
-          Event *e1 = Event::get_event(ev_id, wgen);
-          Event *e2 = Event::get_event(ev2_id, gen2);
-          Event::link_events(e1, e2);
-          e2->set_desc(s + pos);
+          unsigned e1 = graph.get_event(ev_id, wgen);
+          unsigned e2 = graph.get_event(ev2_id, gen2);
+          graph.link_events(e1, e2);
+          graph.set_kind(e2, REC_USER);
+          graph.set_desc(e2, s + pos);
           continue;
         }
       }
@@ -258,10 +527,11 @@ int read_events(FILE *f)
         int ret = sscanf(s, "  [%d] L:%*p %nGPU Task: %*p after=%llx/%d",
                          &wgen, &pos, &ev2_id, &gen2);
         if(ret == 3) {
-          Event *e1 = Event::get_event(ev_id, wgen);
-          Event *e2 = Event::get_event(ev2_id, gen2);
-          Event::link_events(e1, e2);
-          e2->set_desc(s + pos);
+          unsigned e1 = graph.get_event(ev_id, wgen);
+          unsigned e2 = graph.get_event(ev2_id, gen2);
+          graph.link_events(e1, e2);
+          graph.set_kind(e2, REC_TASK);
+          graph.set_desc(e2, s + pos);
           continue;
         }
       }
@@ -272,10 +542,11 @@ int read_events(FILE *f)
         int ret = sscanf(s, "  [%d] L:%*p %ndma request %*p: after %llx/%d",
                          &wgen, &pos, &ev2_id, &gen2);
         if(ret == 3) {
-          Event *e1 = Event::get_event(ev_id, wgen);
-          Event *e2 = Event::get_event(ev2_id, gen2);
-          Event::link_events(e1, e2);
-          e2->set_desc(s + pos);
+          unsigned e1 = graph.get_event(ev_id, wgen);
+          unsigned e2 = graph.get_event(ev2_id, gen2);
+          graph.link_events(e1, e2);
+          graph.set_kind(e2, REC_COPY);
+          graph.set_desc(e2, s + pos);
           continue;
         }
       }
@@ -286,10 +557,11 @@ int read_events(FILE *f)
         int ret = sscanf(s, "  [%d] L:%*p %ndeferred task: func=%*d proc=%*x finish=%llx/%d",
                          &wgen, &pos, &ev2_id, &gen2);
         if(ret == 3) {
-          Event *e1 = Event::get_event(ev_id, wgen);
-          Event *e2 = Event::get_event(ev2_id, gen2);
-          Event::link_events(e1, e2);
-          e2->set_desc(s + pos);
+          unsigned e1 = graph.get_event(ev_id, wgen);
+          unsigned e2 = graph.get_event(ev2_id, gen2);
+          graph.link_events(e1, e2);
+          graph.set_kind(e2, REC_TASK);
+          graph.set_desc(e2, s + pos);
           continue;
         }
       }
@@ -301,10 +573,11 @@ int read_events(FILE *f)
         int ret = sscanf(s, "  [%d] L:%*p %ndeferred arrival: barrier=%llx/%d (%d), delta=%d",
                          &wgen, &pos, &ev2_id, &gen2, &ts, &delta);
         if(ret == 5) {
-          Event *e1 = Event::get_event(ev_id, wgen);
-          Event *e2 = Event::get_event(ev2_id, gen2);
-          Event::link_events(e1, e2);
-          e2->set_desc(s + pos);
+          unsigned e1 = graph.get_event(ev_id, wgen);
+          unsigned e2 = graph.get_event(ev2_id, gen2);
+          graph.link_events(e1, e2);
+          graph.set_kind(e2, REC_ARRIVAL);
+          graph.set_desc(e2, s + pos);
           continue;
         }
       }
@@ -316,8 +589,7 @@ int read_events(FILE *f)
         int ret = sscanf(s, "  [%d] L:%*p thread %llx waiting on %llx/%d",
                          &wgen, &thr_id, &ev2_id, &gen2);
         if(ret == 4) {
-          Event *e1 = Event::get_event(ev_id, wgen);
-          e1->add_waiting_thread(thr_id);
+          graph.add_waiter(graph.get_event(ev_id, wgen));
           continue;
         }
       }
@@ -328,6 +600,7 @@ int read_events(FILE *f)
         int ret = sscanf(s, "  [%d] L:%*p Waiting greenlet %llx of processor local worker",
                          &wgen, &thr_id);
         if(ret == 2) {
+          graph.add_waiter(graph.get_event(ev_id, wgen));
           continue;
         }
       }
@@ -338,8 +611,7 @@ int read_events(FILE *f)
         int ret = sscanf(s, "  [%d] L:%*p external waiter%c",
                          &wgen, &dummy);
         if(ret == 2) {
-          Event *e1 = Event::get_event(ev_id, wgen);
-          e1->add_waiting_thread(0);
+          graph.add_waiter(graph.get_event(ev_id, wgen));
           continue;
         }
       }
@@ -359,21 +631,42 @@ int read_events(FILE *f)
       exit(1);
     }
   }
+  return 1;
 }
 
 int main(int argc, const char *argv[])
 {
+  assert(sizeof(GraphRecord) == 48);
+
+  size_t path_length = 20;
+  size_t max_print = 20;
+  EventGraph graph;
   for(int i = 1; i < argc; i++) {
+    if(!strcmp(argv[i], "-p")) {
+      path_length = atoi(argv[++i]);
+      continue;
+    }
     printf("%s\n", argv[i]);
-    FILE *f = fopen(argv[i], "r");
+    FILE *f = fopen(argv[i], "rb");
     assert(f);
-    read_events(f);
+    char magic[8];
+    if((fread(magic, sizeof(magic), 1, f) == 1) &&
+       !memcmp(magic, graph_magic, sizeof(magic))) {
+      read_graph(f, graph);
+    } else {
+      rewind(f);
+      read_events(f, graph);
+    }
     fclose(f);
   }
 
-  int stalled = Event::count_stalled();
+  graph.finalize();
+  printf("%zd events, %zd dependences\n", graph.size(), graph.num_edges());
+
+  int stalled = graph.count_stalled();
   printf("%d stalled events\n", stalled);
 
-  Event::find_loops();
+  graph.find_roots(max_print);
+  graph.find_loops(max_print);
+  graph.critical_path(path_length);
 }
-
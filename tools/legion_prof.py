@@ -34,6 +34,7 @@ meta_desc_pat = re.compile(prefix + r'Prof Meta Desc (?P<hlr>[0-9]+) (?P<kind>[a
 op_desc_pat = re.compile(prefix + r'Prof Op Desc (?P<opkind>[0-9]+) (?P<kind>[a-zA-Z0-9_ ]+)')
 proc_desc_pat = re.compile(prefix + r'Prof Proc Desc (?P<pid>[a-f0-9]+) (?P<kind>[0-9]+)')
 mem_desc_pat = re.compile(prefix + r'Prof Mem Desc (?P<mid>[a-f0-9]+) (?P<kind>[0-9]+) (?P<size>[0-9]+)')
+gc_info_pat = re.compile(prefix + r'Prof GC Info (?P<pid>[a-f0-9]+) (?P<views>[0-9]+) (?P<create>[0-9]+) (?P<start>[0-9]+) (?P<stop>[0-9]+)')
 
 # Make sure this is up to date with lowlevel.h
 processor_kinds = {
@@ -861,6 +862,7 @@ class State(object):
         self.op_kinds = {}
         self.operations = {}
         self.multi_tasks = {}
+        self.gc_batches = []
         self.first_times = {}
         self.last_times = {}
         self.last_time = 0L
@@ -966,6 +968,14 @@ class State(object):
                                       memory_kinds[kind],
                                       long(m.group('size')))
                     continue
+                m = gc_info_pat.match(line)
+                if m is not None:
+                    self.log_gc_info(int(m.group('pid'),16),
+                                     int(m.group('views')),
+                                     read_time(m.group('create')),
+                                     read_time(m.group('start')),
+                                     read_time(m.group('stop')))
+                    continue
                 # If we made it here then we failed to match
                 matches -= 1 
                 print 'Skipping line: %s' % line.strip()
@@ -1051,6 +1061,11 @@ class State(object):
             self.last_time = destroy 
         mem.add_instance(inst)
 
+    def log_gc_info(self, proc_id, views, create, start, stop):
+        assert create <= start
+        assert start <= stop
+        self.gc_batches.append((proc_id, views, create, start, stop))
+
     def log_kind(self, task_id, name):
         if task_id not in self.task_kinds:
             self.task_kinds[task_id] = TaskKind(task_id, name)
@@ -1204,12 +1219,31 @@ class State(object):
         stat.print_stats()
         print
 
+    def print_gc_stats(self):
+        print '****************************************************'
+        print '   GARBAGE COLLECTION STATS'
+        print '****************************************************'
+        total_views = sum(b[1] for b in self.gc_batches)
+        latencies = [b[4] - b[2] for b in self.gc_batches]
+        durations = [b[4] - b[3] for b in self.gc_batches]
+        print '    Total Batches: %d' % len(self.gc_batches)
+        print '    Total Views Collected: %d' % total_views
+        print '    Average Latency: %.2f us' % \
+            (float(sum(latencies)) / len(latencies))
+        print '    Maximum Latency: %d us' % max(latencies)
+        print '    Average Collection Time: %.2f us' % \
+            (float(sum(durations)) / len(durations))
+        print '    Maximum Collection Time: %d us' % max(durations)
+        print
+
     def print_stats(self, verbose):
         if verbose:
             self.print_processor_stats()
             self.print_memory_stats()
             self.print_channel_stats()
         self.print_task_stats()
+        if self.gc_batches:
+            self.print_gc_stats()
 
     def emit_visualization(self, output_prefix, show_procs,
                            show_channels, show_instances):
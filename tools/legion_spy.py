@@ -37,6 +37,7 @@ def usage():
     print "  -D : make dataflow graphs"
     print "  -i : make instance graphs"
     print "  -Q : dump event paths between every two operations in the event graph"
+    print "<file_name> is a log file or a binary stream written with -hl:spy_file"
     sys.exit(1)
 
 def main():
@@ -17,7 +17,7 @@
 
 #from spy_state import *
 from spy_analysis import *
-import sys, re
+import sys, re, struct
 
 # All of these calls are based on the print statements in legion_logging.h
 
@@ -295,7 +295,141 @@ def parse_log_line(line, state):
             return True
     return False
 
+# Binary streams written by the same calls when Legion Spy is enabled
+# with -hl:spy_file.  The file starts with a magic string, a version and
+# the address space.  Each record is a one byte kind followed by packed
+# little-endian fields in the order they are logged.  Names are a two
+# byte length followed by the characters.  Kinds are numbered from one in
+# the order of SpyRecordKind in legion_spy.h.
+binary_magic            = "LGNSPYBN"
+binary_header           = struct.Struct("<8sII")
+binary_kind             = struct.Struct("<B")
+binary_name_len         = struct.Struct("<H")
+
+# (fields, has name, state method, indexes of fields that are booleans)
+binary_records = [
+    # Machine shapes
+    ("Q",           False, "add_utility",               ()),
+    ("QI",          False, "add_processor",             ()),
+    ("QQ",          False, "add_memory",                ()),
+    ("QQII",        False, "set_proc_mem",              ()),
+    ("QQII",        False, "set_mem_mem",               ()),
+    # Region tree shapes
+    ("Q",           False, "add_index_space",           ()),
+    ("Q",           True,  "add_index_space_name",      ()),
+    ("QQBiiii",     False, "add_index_partition",       (2,)),
+    ("Q",           True,  "add_index_partition_name",  ()),
+    ("QQiiii",      False, "add_index_subspace",        ()),
+    ("I",           False, "add_field_space",           ()),
+    ("I",           True,  "add_field_space_name",      ()),
+    ("II",          False, "add_field",                 ()),
+    ("II",          True,  "add_field_name",            ()),
+    ("QII",         False, "add_region",                ()),
+    ("QII",         True,  "add_region_name",           ()),
+    ("QII",         True,  "add_partition_name",        ()),
+    # Operations
+    ("Iq",          True,  "add_top_task",              ()),
+    ("qIq",         True,  "add_single_task",           ()),
+    ("qIq",         True,  "add_index_task",            ()),
+    ("qq",          False, "add_mapping",               ()),
+    ("qqI",         False, "add_close",                 (2,)),
+    ("qq",          False, "add_fence",                 ()),
+    ("qq",          False, "add_copy_op",               ()),
+    ("qq",          False, "add_acquire_op",            ()),
+    ("qq",          False, "add_release_op",            ()),
+    ("qq",          False, "add_deletion",              ()),
+    ("qqQi",        False, "add_dependent_partition_op", ()),
+    ("qq",          False, "add_pending_partition_op",  ()),
+    ("qQi",         False, "set_pending_partition_target", ()),
+    ("qq",          False, "add_index_slice",           ()),
+    ("qq",          False, "add_slice_slice",           ()),
+    ("qqiiii",      False, "add_slice_point",           ()),
+    ("qq",          False, "add_point_point",           ()),
+    # Mapping dependence analysis
+    ("qIBQIIIII",   False, "add_requirement",           (2,)),
+    ("qII",         False, "add_req_field",             ()),
+    ("qqIqII",      False, "add_mapping_dependence",    ()),
+    # Physical dependence analysis
+    ("qII",         False, "add_instance_requirement",  ()),
+    # Physical analysis
+    ("QIQI",        False, "add_event_dependence",      ()),
+    ("QIQI",        False, "add_implicit_dependence",   ()),
+    ("qQIQI",       False, "add_op_events",             ()),
+    ("QQQIIQIQII",  False, "add_copy_events",           ()),
+    ("QIQII",       False, "add_copy_field_to_copy_event", ()),
+    # Physical instance usage
+    ("QQQII",       False, "add_physical_instance",     ()),
+    ("QQQIIBI",     False, "add_reduction_instance",    (5,)),
+    ("QI",          False, "add_instance_field",        ()),
+    ("qIQ",         False, "add_op_user",               ()),
+    # Phase barriers
+    ("Q",           False, "add_phase_barrier",         ()),
+    ("qQ",          False, "add_op_proc_user",          ()),
+]
+binary_records = [(struct.Struct("<"+fields), name, method, bools) 
+                    for fields, name, method, bools in binary_records]
+
+def is_binary_file(file_name):
+    log = open(file_name, 'rb')
+    magic = log.read(len(binary_magic))
+    log.close()
+    return magic == binary_magic
+
+def parse_binary_file(file_name, state):
+    log = open(file_name, 'rb')
+    data = log.read()
+    log.close()
+    magic, version, address_space = binary_header.unpack_from(data, 0)
+    assert magic == binary_magic
+    assert version == 1
+    offset = binary_header.size
+    # Decode all the records first, then apply them to the state
+    records = list()
+    while offset < len(data):
+        kind = binary_kind.unpack_from(data, offset)[0]
+        offset += binary_kind.size
+        if kind < 1 or kind > len(binary_records):
+            print "ERROR: Unknown Legion Spy record kind "+str(kind)+ \
+                  " at offset "+str(offset-1)+" in "+file_name
+            assert False
+        fields, has_name, method, bools = binary_records[kind-1]
+        args = list(fields.unpack_from(data, offset))
+        offset += fields.size
+        for idx in bools:
+            args[idx] = True if args[idx] == 1 else False
+        if has_name:
+            length = binary_name_len.unpack_from(data, offset)[0]
+            offset += binary_name_len.size
+            args.append(data[offset:offset+length])
+            offset += length
+        records.append((method, args))
+    matches = 0
+    # Records from different threads are buffered separately so they
+    # can be out of order just like lines in the log files
+    replay_records = list()
+    for method, args in records:
+        if getattr(state, method)(*args):
+            matches += 1
+        else:
+            replay_records.append((method, args))
+    while len(replay_records) > 0:
+        remaining = list()
+        for method, args in replay_records:
+            if not getattr(state, method)(*args):
+                remaining.append((method, args))
+        # Check to make sure we actually did something
+        if len(remaining) == len(replay_records):
+            print "ERROR: NO PROGRESS PARSING! BUG IN LEGION SPY LOGGING ASSUMPTIONS!"
+            for method, args in remaining:
+                print method, args
+            assert False
+        matches += len(replay_records) - len(remaining)
+        replay_records = remaining
+    return matches
+
 def parse_log_file(file_name, state):
+    if is_binary_file(file_name):
+        return parse_binary_file(file_name, state)
     log = open(file_name, 'r')
     matches = 0
     # Since some lines might match, but are out of order due to things getting